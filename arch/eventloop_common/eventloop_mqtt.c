@@ -13,6 +13,7 @@
 #ifdef UA_ENABLE_MQTT
 
 #include "../../deps/open62541_queue.h"
+#include "../../deps/ziptree.h"
 #include <limits.h>
 
 #if defined(_MSC_VER)
@@ -31,6 +32,9 @@ typedef struct MQTTBrokerConnection MQTTBrokerConnection;
 struct MQTTTopicConnection;
 typedef struct MQTTTopicConnection MQTTTopicConnection;
 
+struct MQTTTopicNode;
+typedef struct MQTTTopicNode MQTTTopicNode;
+
 /* Prevent the inclusion of "mqtt_pal.h". We make the definitions inline here to remain
  * architecture and OS-agnostic. */
 #define __MQTT_PAL_H__
@@ -71,7 +75,12 @@ static ssize_t mqtt_pal_recvall(mqtt_pal_socket_handle fd, void* buf, size_t buf
 #include "../../deps/mqtt-c/src/mqtt.c"
 
 #define MQTT_MESSAGE_MAXLEN (1u << 20) /* 1MB */
-#define MQTT_PARAMETERSSIZE 8
+#define MQTT_SENDQUEUE_SIZE (1u << 16) /* 64kB for the packets queued in the
+                                        * client until they are sent out (and
+                                        * acknowledged for QoS 1/2) */
+#define MQTT_SENDBATCH_MINSIZE 1024 /* Smallest network buffer for a batch */
+#define MQTT_MAXINFLIGHT_DEFAULT 16
+#define MQTT_PARAMETERSSIZE 10
 #define MQTT_BROKERPARAMETERSSIZE 5 /* Parameters shared by topic connections
                                      * connected to the same broker */
 
@@ -87,9 +96,30 @@ static const struct {
     {{0, UA_STRING_STATIC("password")}, &UA_TYPES[UA_TYPES_STRING], false},
     {{0, UA_STRING_STATIC("validate")}, &UA_TYPES[UA_TYPES_BOOLEAN], false},
     {{0, UA_STRING_STATIC("subscribe")}, &UA_TYPES[UA_TYPES_BOOLEAN], false},
-    {{0, UA_STRING_STATIC("topic")}, &UA_TYPES[UA_TYPES_STRING], true}
+    {{0, UA_STRING_STATIC("topic")}, &UA_TYPES[UA_TYPES_STRING], true},
+    {{0, UA_STRING_STATIC("qos")}, &UA_TYPES[UA_TYPES_BYTE], false},
+    {{0, UA_STRING_STATIC("max-inflight")}, &UA_TYPES[UA_TYPES_UINT16], false}
+};
+
+/* The subscriptions of a BrokerConnection are stored in a trie over the topic
+ * levels (separated by '/'). The children of a node are kept in a ZIP tree
+ * ordered by the hash of the level name. So a received message is dispatched
+ * with O(topic depth) lookups, independent of the number of subscriptions. The
+ * wildcards "+" and "#" are regular levels in the trie. They are looked up in
+ * addition to the exact level name during the dispatch. */
+typedef ZIP_HEAD(MQTTTopicTree, MQTTTopicNode) MQTTTopicTree;
+
+struct MQTTTopicNode {
+    ZIP_ENTRY(MQTTTopicNode) treeEntry;
+    UA_UInt32 levelHash;
+    UA_String level;
+    MQTTTopicNode *parent; /* NULL for the root */
+    MQTTTopicTree children;
+    LIST_HEAD(, MQTTTopicConnection) subscribers;
 };
 
+typedef ZIP_HEAD(MQTTTopicConnectionTree, MQTTTopicConnection) MQTTTopicConnectionTree;
+
 /* The BrokerConnection is a stateful connection to the broker that aggregates
  * subscriptions to topics. The BrokerConnection is not directly exposed via the
  * public interface. Only TopicConnections are. */
@@ -108,9 +138,20 @@ struct MQTTBrokerConnection {
     UA_UInt16 keepalive;      /* Seconds between keepalives */
     UA_UInt64 keepAliveCallbackId; /* Registered callback to send the keepalive */
 
+    /* The packets queued in the MQTT client are sent out together at the end
+     * of the EventLoop iteration. They are written into a single network
+     * buffer of the TCP connection. An unused buffer is kept for the next
+     * batch. */
+    UA_Boolean flushScheduled;
+    UA_DelayedCallback flushDc;
+    UA_ByteString sendBuffer;
+    size_t sendBufferPos;
+
     /* Topic connections sharing the same connection to a broker */
     LIST_HEAD(, MQTTTopicConnection) topicConnections;
-    uintptr_t lastTopicConnectionId;
+
+    /* Trie of the subscribed topic filters */
+    MQTTTopicNode topicRoot;
 
     /* Store the connection parameters. To reconnect when necessary and to check
      * if a matching connection to the broker already exists. */
@@ -122,12 +163,22 @@ struct MQTTBrokerConnection {
 struct MQTTTopicConnection {
     LIST_ENTRY(MQTTTopicConnection) next;
 
-    /* (Broker Connection Id * 1000) + connection Id */
-    uintptr_t topicConnectionId; 
+    /* Unique in the ConnectionManager */
+    uintptr_t topicConnectionId;
+    ZIP_ENTRY(MQTTTopicConnection) idTreeEntry;
     UA_ConnectionState topicConnectionState;
 
-    UA_String topic;      /* Name of the topic */
+    UA_String topic;      /* Name of the topic (the filter for subscriptions) */
     UA_Boolean subscribe; /* Subscribe or publish? */
+    UA_Byte qos;          /* MQTT QoS level 0-2 */
+    UA_UInt16 maxInflight; /* Drop QoS 1/2 publishing if that many PUBLISH
+                            * packets of the broker connection are not yet
+                            * acknowledged */
+
+    /* Position in the topic trie of the broker connection (only for
+     * subscriptions) */
+    MQTTTopicNode *topicNode;
+    LIST_ENTRY(MQTTTopicConnection) subscriberEntry;
 
     /* Backpointer to the connection to the broker (is always set) */
     MQTTBrokerConnection *brokerConnection;
@@ -147,30 +198,250 @@ struct MQTTConnectionManager {
     UA_ConnectionManager *tcpCM; /* The TCP ConnectionManager to use. Set during
                                   * the start of this CM. */
     LIST_HEAD(, MQTTBrokerConnection) connections;
+
+    /* All topic connections by their id */
+    MQTTTopicConnectionTree topicConnections;
+    uintptr_t lastTopicConnectionId;
 };
 
-/* Send via the underlying TCP connection */
+static enum ZIP_CMP
+cmpTopicNode(const void *a, const void *b) {
+    const MQTTTopicNode *aa = (const MQTTTopicNode*)a;
+    const MQTTTopicNode *bb = (const MQTTTopicNode*)b;
+    if(aa->levelHash != bb->levelHash)
+        return (aa->levelHash < bb->levelHash) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+    if(aa->level.length != bb->level.length)
+        return (aa->level.length < bb->level.length) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+    if(aa->level.length == 0)
+        return ZIP_CMP_EQ;
+    int cmp = memcmp(aa->level.data, bb->level.data, aa->level.length);
+    if(cmp == 0)
+        return ZIP_CMP_EQ;
+    return (cmp < 0) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+}
+
+ZIP_FUNCTIONS(MQTTTopicTree, MQTTTopicNode, treeEntry,
+              MQTTTopicNode, treeEntry, cmpTopicNode)
+
+static enum ZIP_CMP
+cmpTopicConnectionId(const void *a, const void *b) {
+    const uintptr_t *aa = (const uintptr_t*)a;
+    const uintptr_t *bb = (const uintptr_t*)b;
+    if(*aa == *bb)
+        return ZIP_CMP_EQ;
+    return (*aa < *bb) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+}
+
+ZIP_FUNCTIONS(MQTTTopicConnectionTree, MQTTTopicConnection, idTreeEntry,
+              uintptr_t, topicConnectionId, cmpTopicConnectionId)
+
+static const UA_String topicSingleLevelWildcard = UA_STRING_STATIC("+");
+static const UA_String topicMultiLevelWildcard = UA_STRING_STATIC("#");
+
+/* Returns the level starting at pos. The pos of the next level is written into
+ * *next. After the last level, *next is larger than the topic length. */
+static UA_String
+topicLevel(const UA_String *topic, size_t pos, size_t *next) {
+    size_t end = pos;
+    while(end < topic->length && topic->data[end] != '/')
+        end++;
+    *next = end + 1;
+    UA_String level = {end - pos, &topic->data[pos]};
+    return level;
+}
+
+/* Wildcards are only allowed in topic filters for subscriptions. They have to
+ * occupy an entire level. The multi-level wildcard must be the last level. */
+static UA_Boolean
+validTopic(const UA_String *topic, UA_Boolean subscribe) {
+    if(topic->length == 0)
+        return false;
+    size_t pos = 0;
+    while(pos <= topic->length) {
+        UA_String level = topicLevel(topic, pos, &pos);
+        for(size_t i = 0; i < level.length; i++) {
+            if(level.data[i] != '+' && level.data[i] != '#')
+                continue;
+            if(!subscribe || level.length != 1)
+                return false;
+            if(level.data[i] == '#' && pos <= topic->length)
+                return false;
+        }
+    }
+    return true;
+}
+
+static MQTTTopicNode *
+findTopicChild(MQTTTopicNode *node, const UA_String *level) {
+    MQTTTopicNode key;
+    key.levelHash = UA_ByteString_hash(0, level->data, level->length);
+    key.level = *level;
+    return ZIP_FIND(MQTTTopicTree, &node->children, &key);
+}
+
+/* Remove nodes without subscribers and children towards the root */
+static void
+pruneTopicNode(MQTTTopicNode *node) {
+    while(node->parent && LIST_EMPTY(&node->subscribers) &&
+          !ZIP_ROOT(&node->children)) {
+        MQTTTopicNode *parent = node->parent;
+        ZIP_REMOVE(MQTTTopicTree, &parent->children, node);
+        UA_String_clear(&node->level);
+        UA_free(node);
+        node = parent;
+    }
+}
+
+/* Add the subscription to the trie. The nodes along the path of the topic filter
+ * are created as needed. */
+static UA_StatusCode
+addTopicSubscriber(MQTTBrokerConnection *bc, MQTTTopicConnection *tc) {
+    MQTTTopicNode *node = &bc->topicRoot;
+    size_t pos = 0;
+    while(pos <= tc->topic.length) {
+        UA_String level = topicLevel(&tc->topic, pos, &pos);
+        MQTTTopicNode *child = findTopicChild(node, &level);
+        if(!child) {
+            child = (MQTTTopicNode*)UA_calloc(1, sizeof(MQTTTopicNode));
+            if(!child) {
+                pruneTopicNode(node);
+                return UA_STATUSCODE_BADOUTOFMEMORY;
+            }
+            /* The topic string is owned by the TopicConnection. The level gets
+             * its own copy as the node can outlive the TopicConnection. */
+            UA_StatusCode res = UA_String_copy(&level, &child->level);
+            if(res != UA_STATUSCODE_GOOD) {
+                UA_free(child);
+                pruneTopicNode(node);
+                return res;
+            }
+            child->levelHash = UA_ByteString_hash(0, level.data, level.length);
+            child->parent = node;
+            ZIP_INSERT(MQTTTopicTree, &node->children, child);
+        }
+        node = child;
+    }
+    LIST_INSERT_HEAD(&node->subscribers, tc, subscriberEntry);
+    tc->topicNode = node;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+removeTopicSubscriber(MQTTTopicConnection *tc) {
+    MQTTTopicNode *node = tc->topicNode;
+    if(!node)
+        return;
+    LIST_REMOVE(tc, subscriberEntry);
+    tc->topicNode = NULL;
+    pruneTopicNode(node);
+}
+
+/* Send the current batch via the underlying TCP connection */
+static UA_StatusCode
+sendBatch(MQTTBrokerConnection *bc) {
+    if(bc->sendBufferPos == 0)
+        return UA_STATUSCODE_GOOD;
+    UA_ConnectionManager *tcpCM = bc->mcm->tcpCM;
+    bc->sendBuffer.length = bc->sendBufferPos;
+    bc->sendBufferPos = 0;
+    UA_StatusCode res = tcpCM->sendWithConnection(tcpCM, bc->tcpConnectionId,
+                                                  &UA_KEYVALUEMAP_NULL, &bc->sendBuffer);
+    bc->sendBuffer = UA_BYTESTRING_NULL;
+    bc->lastSendTime = UA_DateTime_nowMonotonic();
+    return res;
+}
+
+/* Ensure the (empty) network buffer has at least the size */
+static UA_StatusCode
+reserveSendBuffer(MQTTBrokerConnection *bc, size_t size) {
+    UA_assert(bc->sendBufferPos == 0);
+    if(bc->sendBuffer.length >= size)
+        return UA_STATUSCODE_GOOD;
+    UA_ConnectionManager *tcpCM = bc->mcm->tcpCM;
+    if(bc->sendBuffer.length > 0)
+        tcpCM->freeNetworkBuffer(tcpCM, bc->tcpConnectionId, &bc->sendBuffer);
+    if(size < MQTT_SENDBATCH_MINSIZE)
+        size = MQTT_SENDBATCH_MINSIZE;
+    return tcpCM->allocNetworkBuffer(tcpCM, bc->tcpConnectionId, &bc->sendBuffer, size);
+}
+
+/* Append to the current batch. The batch is sent out when the network buffer
+ * is full and at the end of flushBrokerConnection. */
 ssize_t
 mqtt_pal_sendall(MQTTBrokerConnection *bc, const void* buf, size_t len, int flags) {
     if(bc->tcpConnectionState != UA_CONNECTIONSTATE_ESTABLISHED)
         return MQTT_ERROR_SOCKET_ERROR;
 
-    UA_ByteString msg = UA_BYTESTRING_NULL;
-    UA_ConnectionManager *tcpCM = bc->mcm->tcpCM;
-    UA_StatusCode res = tcpCM->allocNetworkBuffer(tcpCM, bc->tcpConnectionId, &msg, len);
-    if(res != UA_STATUSCODE_GOOD)
-        return MQTT_ERROR_SOCKET_ERROR;
-        
-    memcpy(msg.data, buf, len);
-    res = tcpCM->sendWithConnection(tcpCM, bc->tcpConnectionId,
-                                    &UA_KEYVALUEMAP_NULL, &msg);
-    if(res != UA_STATUSCODE_GOOD)
-        return MQTT_ERROR_SOCKET_ERROR;
+    if(bc->sendBuffer.length - bc->sendBufferPos < len) {
+        if(sendBatch(bc) != UA_STATUSCODE_GOOD ||
+           reserveSendBuffer(bc, len) != UA_STATUSCODE_GOOD)
+            return MQTT_ERROR_SOCKET_ERROR;
+    }
 
-    bc->lastSendTime = UA_DateTime_nowMonotonic();
+    memcpy(&bc->sendBuffer.data[bc->sendBufferPos], buf, len);
+    bc->sendBufferPos += len;
     return (ssize_t)len;
 }
 
+/* Send out all packets queued in the MQTT client. The network buffer is
+ * allocated for all unsent packets. Packets that are sent again after a timeout
+ * can lead to additional sends. */
+static void
+flushBrokerConnection(MQTTBrokerConnection *bc) {
+    if(bc->tcpConnectionState == UA_CONNECTIONSTATE_ESTABLISHED) {
+        size_t pending = 0;
+        ssize_t len = mqtt_mq_length(&bc->client.mq);
+        for(ssize_t i = 0; i < len; i++) {
+            struct mqtt_queued_message *msg = mqtt_mq_get(&bc->client.mq, i);
+            if(msg->state == MQTT_QUEUED_UNSENT)
+                pending += msg->size;
+        }
+        if(pending == 0)
+            return;
+        reserveSendBuffer(bc, pending);
+    }
+    __mqtt_send(&bc->client);
+    if(bc->tcpConnectionState == UA_CONNECTIONSTATE_ESTABLISHED)
+        sendBatch(bc);
+}
+
+static void
+flushBrokerConnectionDelayed(void *application, void *context) {
+    MQTTBrokerConnection *bc = (MQTTBrokerConnection*)context;
+    bc->flushScheduled = false;
+    flushBrokerConnection(bc);
+}
+
+/* Flush at the end of the EventLoop iteration. Packets queued until then are
+ * sent out together. */
+static void
+scheduleFlush(MQTTBrokerConnection *bc) {
+    if(bc->flushScheduled)
+        return;
+    UA_EventLoop *el = bc->mcm->cm.eventSource.eventLoop;
+    bc->flushScheduled = true;
+    bc->flushDc.callback = flushBrokerConnectionDelayed;
+    bc->flushDc.application = NULL;
+    bc->flushDc.context = bc;
+    el->addDelayedCallback(el, &bc->flushDc);
+}
+
+/* Number of QoS 1/2 PUBLISH packets in the send queue that are not yet
+ * acknowledged */
+static size_t
+countInflight(MQTTBrokerConnection *bc) {
+    size_t inflight = 0;
+    ssize_t len = mqtt_mq_length(&bc->client.mq);
+    for(ssize_t i = 0; i < len; i++) {
+        struct mqtt_queued_message *msg = mqtt_mq_get(&bc->client.mq, i);
+        if(msg->control_type == MQTT_CONTROL_PUBLISH &&
+           msg->state != MQTT_QUEUED_COMPLETE &&
+           (msg->start[0] & MQTT_PUBLISH_QOS_MASK) != 0)
+            inflight++;
+    }
+    return inflight;
+}
+
 /* Always return zero. The received messages are "manually" added to the buffer.
  * So we don't block in the EventLoop model. */
 ssize_t
@@ -228,7 +499,7 @@ shutdownBrokerConnection(MQTTBrokerConnection *bc) {
     /* Send the DISCONNECT packet */
     if(bc->tcpConnectionState == UA_CONNECTIONSTATE_ESTABLISHED) {
         mqtt_disconnect(&bc->client);
-        __mqtt_send(&bc->client);
+        flushBrokerConnection(bc);
     }
 
     /* Close the TCP connection -> callback in the next el iteration */
@@ -287,17 +558,23 @@ removeTopicConnection(MQTTTopicConnection *tc) {
                 UA_LOGCATEGORY_NETWORK, "MQTT %u\t| Closing the connection",
                 (unsigned)tc->topicConnectionId);
 
-    /* Send the UNSUBSCRIBE packet */
+    /* Send the UNSUBSCRIBE packet. Unless other topic connections are
+     * subscribed with the same topic filter. The SUBSCRIBE packet was sent if
+     * the broker connection is established. The state of the topic connection
+     * is already set to closing at this point. */
     MQTTBrokerConnection *bc = tc->brokerConnection;
-    if(tc->subscribe &&
-       tc->topicConnectionState == UA_CONNECTIONSTATE_ESTABLISHED &&
+    if(tc->subscribe && tc->topicNode &&
+       LIST_FIRST(&tc->topicNode->subscribers) == tc &&
+       !LIST_NEXT(tc, subscriberEntry) &&
        bc->tcpConnectionState == UA_CONNECTIONSTATE_ESTABLISHED) {
         mqtt_unsubscribe(&bc->client, (const char*)tc->topic.data);
-        __mqtt_send(&bc->client);
+        flushBrokerConnection(bc);
     }
 
-    /* Remove from linked list */
+    /* Remove from linked list, the id tree and the topic trie */
     LIST_REMOVE(tc, next);
+    ZIP_REMOVE(MQTTTopicConnectionTree, &bc->mcm->topicConnections, tc);
+    removeTopicSubscriber(tc);
 
     /* Signal the closed connection to the application */
     UA_KeyValuePair kvp[2];
@@ -338,7 +615,11 @@ removeBrokerConnection(MQTTBrokerConnection *bc) {
     /* Remove the keepalive callback */
     if(bc->keepAliveCallbackId > 0)
         el->removeCyclicCallback(el, bc->keepAliveCallbackId);
-    
+
+    /* Remove the pending flush */
+    if(bc->flushScheduled)
+        el->removeDelayedCallback(el, &bc->flushDc);
+
     /* Remove from linked list */
     LIST_REMOVE(bc, next);
 
@@ -348,6 +629,8 @@ removeBrokerConnection(MQTTBrokerConnection *bc) {
         removeTopicConnection(tc);
     }
 
+    if(bc->sendBuffer.length > 0)
+        mcm->tcpCM->freeNetworkBuffer(mcm->tcpCM, bc->tcpConnectionId, &bc->sendBuffer);
     UA_KeyValueMap_clear(&bc->params);
     UA_free(bc->client.recv_buffer.mem_start);
     UA_free(bc->client.mq.mem_start);
@@ -383,28 +666,9 @@ findIdenticalBrokerConnection(MQTTConnectionManager *mcm, const UA_KeyValueMap *
     return NULL;
 }
 
-static MQTTBrokerConnection *
-findBrokerConnection(MQTTConnectionManager *mcm, uintptr_t id) {
-    uintptr_t brokerId = id / 1000;
-    MQTTBrokerConnection *bc;
-    LIST_FOREACH(bc, &mcm->connections, next) {
-        if(bc->tcpConnectionId == brokerId)
-            return bc;
-    }
-    return NULL;
-}
-
 static MQTTTopicConnection *
 findTopicConnection(MQTTConnectionManager *mcm, uintptr_t id) {
-    MQTTBrokerConnection *bc = findBrokerConnection(mcm, id);
-    if(!bc)
-        return NULL;
-    MQTTTopicConnection *tc;
-    LIST_FOREACH(tc, &bc->topicConnections, next) {
-        if(tc->topicConnectionId == id)
-            return tc;
-    }
-    return NULL;
+    return ZIP_FIND(MQTTTopicConnectionTree, &mcm->topicConnections, &id);
 }
 
 static void
@@ -413,7 +677,69 @@ MQTTKeepAliveCallback(void *app, MQTTBrokerConnection *bc) {
     if(bc->lastSendTime + (bc->keepalive * UA_DATETIME_SEC) > UA_DateTime_nowMonotonic())
         return;
     mqtt_ping(&bc->client);
-    __mqtt_send(&bc->client);
+    flushBrokerConnection(bc);
+}
+
+/* Notify the subscribers of a topic filter that matches the received topic */
+static void
+notifyTopicSubscribers(MQTTBrokerConnection *bc, MQTTTopicNode *node,
+                       const UA_KeyValueMap *kvm, const UA_ByteString msg) {
+    MQTTTopicConnection *tc;
+    LIST_FOREACH(tc, &node->subscribers, subscriberEntry) {
+        UA_LOG_DEBUG(bc->mcm->cm.eventSource.eventLoop->logger,
+                     UA_LOGCATEGORY_NETWORK, "MQTT %u\t| Received a message of "
+                     "%u bytes", (unsigned)tc->topicConnectionId, (unsigned)msg.length);
+
+        /* Notify the appliation that the connection is now established. The
+         * only way to know about this is to receive the first message for the
+         * topic (MQTT-C recieves a SUBACK message but does not forward that
+         * information). */
+        if(tc->topicConnectionState != UA_CONNECTIONSTATE_ESTABLISHED) {
+            tc->topicConnectionState = UA_CONNECTIONSTATE_ESTABLISHED;
+            tc->callback(&bc->mcm->cm, tc->topicConnectionId,
+                         tc->application, &tc->context,
+                         UA_CONNECTIONSTATE_ESTABLISHED, kvm,
+                         UA_BYTESTRING_NULL);
+        }
+
+        /* Forward the received message */
+        tc->callback(&bc->mcm->cm, tc->topicConnectionId, tc->application,
+                     &tc->context, UA_CONNECTIONSTATE_ESTABLISHED, kvm, msg);
+    }
+}
+
+/* Walk the trie along the levels of the received topic starting at pos. Every
+ * topic filter is reached at most once. Topics starting with '$' are not
+ * matched by wildcards on the first level. */
+static void
+dispatchTopic(MQTTBrokerConnection *bc, MQTTTopicNode *node, const UA_String *topic,
+              size_t pos, const UA_KeyValueMap *kvm, const UA_ByteString msg) {
+    UA_Boolean wildcards = (node != &bc->topicRoot || topic->data[0] != '$');
+
+    /* The multi-level wildcard also matches the parent level */
+    MQTTTopicNode *child;
+    if(wildcards) {
+        child = findTopicChild(node, &topicMultiLevelWildcard);
+        if(child)
+            notifyTopicSubscribers(bc, child, kvm, msg);
+    }
+
+    /* All levels consumed */
+    if(pos > topic->length) {
+        notifyTopicSubscribers(bc, node, kvm, msg);
+        return;
+    }
+
+    size_t next;
+    UA_String level = topicLevel(topic, pos, &next);
+    child = findTopicChild(node, &level);
+    if(child)
+        dispatchTopic(bc, child, topic, next, kvm, msg);
+    if(wildcards) {
+        child = findTopicChild(node, &topicSingleLevelWildcard);
+        if(child)
+            dispatchTopic(bc, child, topic, next, kvm, msg);
+    }
 }
 
 static void
@@ -436,31 +762,8 @@ MQTTPublishResponseCallback(void** state, struct mqtt_response_publish *publish)
     UA_KeyValueMap kvm = {2, kvp};
 
     /* Notify all matching topic connections */
-    MQTTTopicConnection *tc;
-    LIST_FOREACH(tc, &bc->topicConnections, next) {
-        if(!tc->subscribe || !UA_String_equal(&topic, &tc->topic))
-            continue;
-
-        UA_LOG_DEBUG(tc->brokerConnection->mcm->cm.eventSource.eventLoop->logger,
-                     UA_LOGCATEGORY_NETWORK, "MQTT %u\t| Received a message of "
-                     "%u bytes", (unsigned)tc->topicConnectionId, (unsigned)msg.length);
-
-        /* Notify the appliation that the connection is now established. The
-         * only way to know about this is to receive the first message for the
-         * topic (MQTT-C recieves a SUBACK message but does not forward that
-         * information). */
-        if(tc->topicConnectionState != UA_CONNECTIONSTATE_ESTABLISHED) {
-            tc->topicConnectionState = UA_CONNECTIONSTATE_ESTABLISHED;
-            tc->callback(&bc->mcm->cm, tc->topicConnectionId,
-                         tc->application, &tc->context,
-                         UA_CONNECTIONSTATE_ESTABLISHED, &kvm,
-                         UA_BYTESTRING_NULL);
-        }
-
-        /* Forward the received message */
-        tc->callback(&bc->mcm->cm, tc->topicConnectionId, tc->application,
-                     &tc->context, UA_CONNECTIONSTATE_ESTABLISHED, &kvm, msg);
-    }
+    if(topic.length > 0)
+        dispatchTopic(bc, &bc->topicRoot, &topic, 0, &kvm, msg);
 }
 
 static void
@@ -501,7 +804,7 @@ MQTTNetworkCallback(UA_ConnectionManager *tcpCM, uintptr_t connectionId,
         /* Initialize the MQTT client. We have to call mqtt_connect right afterward.
          * Otherwise the client lock is not released. */
         mqtt_init(&bc->client, bc,
-                  (uint8_t*)UA_calloc(1,1024), 1024,
+                  (uint8_t*)UA_calloc(1,MQTT_SENDQUEUE_SIZE), MQTT_SENDQUEUE_SIZE,
                   (uint8_t*)UA_calloc(1,1024), 1024,
                   MQTTPublishResponseCallback);
 
@@ -515,18 +818,19 @@ MQTTNetworkCallback(UA_ConnectionManager *tcpCM, uintptr_t connectionId,
         }
 
         /* Handle topic connections already registered on the opening broker
-         * connection */
-        MQTTTopicConnection *tc;
-        LIST_FOREACH(tc, &bc->topicConnections, next) {
+         * connection. The SUBSCRIBE packets are sent out together with the
+         * CONNECT packet. */
+        MQTTTopicConnection *tc, *tc_tmp;
+        LIST_FOREACH_SAFE(tc, &bc->topicConnections, next, tc_tmp) {
             if(tc->subscribe) {
                 /* Subscribe-connections call mqtt_subscribe but wait until the
                  * first received message to signal that they successfully
                  * opened */
-                err = mqtt_subscribe(&bc->client, (const char*)tc->topic.data, 0);
-                if(err == MQTT_OK)
-                    err = (enum MQTTErrors)__mqtt_send(&bc->client);
-                if(err != MQTT_OK)
+                err = mqtt_subscribe(&bc->client, (const char*)tc->topic.data, tc->qos);
+                if(err != MQTT_OK) {
                     removeTopicConnection(tc);
+                    continue;
+                }
                 UA_LOG_INFO(bc->mcm->cm.eventSource.eventLoop->logger,
                             UA_LOGCATEGORY_NETWORK, "MQTT %u\t| Created connection "
                             "subscribed on topic \"%s\"",
@@ -544,6 +848,7 @@ MQTTNetworkCallback(UA_ConnectionManager *tcpCM, uintptr_t connectionId,
                              UA_BYTESTRING_NULL);
             }
         }
+        flushBrokerConnection(bc);
     }
 
     /* No message to process? */
@@ -572,8 +877,9 @@ MQTTNetworkCallback(UA_ConnectionManager *tcpCM, uintptr_t connectionId,
 
     /* Process the message. The internal mqtt_pal_recvall does nothing (as we
      * already have added the message to the buffer. But then the entire buffer
-     * is processed. */
+     * is processed. Then send out the acknowledgements for QoS 1/2. */
     __mqtt_recv(&bc->client);
+    flushBrokerConnection(bc);
 }
 
 static MQTTBrokerConnection *
@@ -672,8 +978,26 @@ createTopicConnection(MQTTConnectionManager *mcm, MQTTBrokerConnection *bc,
     const UA_String *topic = (const UA_String*)
         UA_KeyValueMap_getScalar(params, UA_QUALIFIEDNAME(0, "topic"),
                                  &UA_TYPES[UA_TYPES_STRING]);
-    if(topic->length == 0)
+    UA_Byte qos = 0;
+    const UA_Byte *_qos = (const UA_Byte*)
+        UA_KeyValueMap_getScalar(params, UA_QUALIFIEDNAME(0, "qos"),
+                                 &UA_TYPES[UA_TYPES_BYTE]);
+    if(_qos)
+        qos = *_qos;
+    if(qos > 2)
         return NULL;
+    UA_UInt16 maxInflight = MQTT_MAXINFLIGHT_DEFAULT;
+    const UA_UInt16 *_maxInflight = (const UA_UInt16*)
+        UA_KeyValueMap_getScalar(params, UA_QUALIFIEDNAME(0, "max-inflight"),
+                                 &UA_TYPES[UA_TYPES_UINT16]);
+    if(_maxInflight && *_maxInflight > 0)
+        maxInflight = *_maxInflight;
+    if(!validTopic(topic, subscribe)) {
+        UA_LOG_ERROR(mcm->cm.eventSource.eventLoop->logger, UA_LOGCATEGORY_NETWORK,
+                     "MQTT\t| Invalid topic \"%.*s\"",
+                     (int)topic->length, (char*)topic->data);
+        return NULL;
+    }
 
     MQTTTopicConnection *tc = (MQTTTopicConnection*)
         UA_calloc(1, sizeof(MQTTTopicConnection));
@@ -683,8 +1007,10 @@ createTopicConnection(MQTTConnectionManager *mcm, MQTTBrokerConnection *bc,
     tc->context = context;
     tc->callback = connectionCallback;
     tc->brokerConnection = bc;
-    tc->topicConnectionId = (bc->tcpConnectionId * 1000) + (++bc->lastTopicConnectionId);
+    tc->topicConnectionId = ++mcm->lastTopicConnectionId;
     tc->subscribe = subscribe;
+    tc->qos = qos;
+    tc->maxInflight = maxInflight;
 
     /* Make a null-terminated copy of the topic string to forward to the MQTT client. */
     tc->topic.data = (UA_Byte*)UA_malloc(topic->length + 1);
@@ -696,18 +1022,29 @@ createTopicConnection(MQTTConnectionManager *mcm, MQTTBrokerConnection *bc,
     tc->topic.data[topic->length] = 0;
     tc->topic.length = topic->length;
 
+    /* Add to the topic trie. Before the SUBSCRIBE packet is queued, so that no
+     * message of the broker for the new subscription is missed. */
+    if(subscribe && addTopicSubscriber(bc, tc) != UA_STATUSCODE_GOOD) {
+        UA_String_clear(&tc->topic);
+        UA_free(tc);
+        return NULL;
+    }
+
     /* Subscribe the MQTT client if the client is already connected. Otherwise
      * defer mqtt_subscribe until the TCP socket is fully opened and we
      * connect. */
     if(bc->tcpConnectionState == UA_CONNECTIONSTATE_ESTABLISHED) {
         tc->topicConnectionState = UA_CONNECTIONSTATE_ESTABLISHED;
         if(subscribe) {
-            enum MQTTErrors err = mqtt_subscribe(&bc->client, (const char*)topic->data, 0);
+            enum MQTTErrors err =
+                mqtt_subscribe(&bc->client, (const char*)tc->topic.data, qos);
             if(err != MQTT_OK) {
+                removeTopicSubscriber(tc);
                 UA_String_clear(&tc->topic);
                 UA_free(tc);
                 return NULL;
             }
+            scheduleFlush(bc);
             UA_LOG_INFO(bc->mcm->cm.eventSource.eventLoop->logger,
                         UA_LOGCATEGORY_NETWORK, "MQTT %u\t| Created connection "
                         "subscribed on topic \"%s\"",
@@ -722,8 +1059,9 @@ createTopicConnection(MQTTConnectionManager *mcm, MQTTBrokerConnection *bc,
         tc->topicConnectionState = UA_CONNECTIONSTATE_OPENING;
     }
 
-    /* Add to the linked list */
+    /* Add to the linked list and the id tree */
     LIST_INSERT_HEAD(&bc->topicConnections, tc, next);
+    ZIP_INSERT(MQTTTopicConnectionTree, &mcm->topicConnections, tc);
 
     /* Signal the connection state. If the broker connection is not yet
      * established, then the state will be signaled again when the broker
@@ -802,12 +1140,38 @@ MQTT_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                  "a message with %u bytes", (unsigned)tc->topicConnectionId,
                  (char*)tc->topic.data, (unsigned)buf->length);
 
+    /* QoS 1/2 packets remain in the send queue until they are acknowledged.
+     * Limit the number of packets in flight. QoS 0 publishing is not affected
+     * by the window. The message is dropped if the window is full. This is a
+     * transient condition, the connection remains open. */
+    if(tc->qos > 0 && countInflight(bc) >= tc->maxInflight) {
+        UA_LOG_WARNING(bc->mcm->cm.eventSource.eventLoop->logger,
+                       UA_LOGCATEGORY_NETWORK, "MQTT %u\t| Message dropped, %u "
+                       "messages are not yet acknowledged",
+                       (unsigned)tc->topicConnectionId, (unsigned)tc->maxInflight);
+        UA_ByteString_clear(buf);
+        return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+    }
+
+    /* Not enough space in the send queue. Send out the queued packets first.
+     * The space of completed packets is reclaimed by the MQTT client. The upper
+     * bound for the packet size includes the fixed header (5 bytes), the topic
+     * (length + 2 bytes) and the packet id (2 bytes). */
+    size_t packetSize = 9 + tc->topic.length + buf->length +
+        sizeof(struct mqtt_queued_message);
+    if(bc->client.mq.curr_sz < packetSize)
+        flushBrokerConnection(bc);
+
+    /* Queue the packet and send it out at the end of the EventLoop
+     * iteration */
     enum MQTTErrors res = mqtt_publish(&bc->client, (const char*)tc->topic.data,
-                                       buf->data, buf->length, 0);
-    if(UA_LIKELY(res == MQTT_OK))
-        res = (enum MQTTErrors)__mqtt_send(&bc->client);
+                                       buf->data, buf->length,
+                                       (uint8_t)(tc->qos << 1) & MQTT_PUBLISH_QOS_MASK);
     UA_ByteString_clear(buf);
-    return (res == MQTT_OK) ? UA_STATUSCODE_GOOD : UA_STATUSCODE_BADINTERNALERROR;
+    if(res != MQTT_OK)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    scheduleFlush(bc);
+    return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
@@ -556,6 +556,23 @@ UA_EventLoopPOSIX_freeNetworkBuffer(UA_ConnectionManager *cm,
         UA_ByteString_clear(buf);
 }
 
+static const UA_QualifiedName keepBufferParam =
+    {0, UA_STRING_STATIC("keep-buffer")};
+
+UA_Boolean
+UA_EventLoopPOSIX_keepNetworkBuffer(UA_ConnectionManager *cm,
+                                    const UA_KeyValueMap *params) {
+    /* The static send buffer is shared between all connections and cannot be
+     * handed back to the caller */
+    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
+    if(pcm->txBuffer.length > 0)
+        return false;
+    const UA_Boolean *keep = (const UA_Boolean*)
+        UA_KeyValueMap_getScalar(params, keepBufferParam,
+                                 &UA_TYPES[UA_TYPES_BOOLEAN]);
+    return (keep && *keep);
+}
+
 UA_StatusCode
 UA_EventLoopPOSIX_allocateStaticBuffers(UA_POSIXConnectionManager *pcm) {
     UA_StatusCode res = UA_STATUSCODE_GOOD;
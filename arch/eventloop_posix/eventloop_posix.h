@@ -296,6 +296,12 @@ UA_EventLoopPOSIX_freeNetworkBuffer(UA_ConnectionManager *cm,
                                     uintptr_t connectionId,
                                     UA_ByteString *buf);
 
+/* Returns true if the "keep-buffer" send parameter is set and the buffer
+ * remains with the caller after sending */
+UA_Boolean
+UA_EventLoopPOSIX_keepNetworkBuffer(UA_ConnectionManager *cm,
+                                    const UA_KeyValueMap *params);
+
 /* Set the socket non-blocking. If the listen-socket is nonblocking, incoming
  * connections inherit this state. */
 UA_StatusCode
@@ -16,6 +16,18 @@
 #include <net/ethernet.h> /* ETH_P_*/
 #include <linux/if_packet.h>
 #include <linux/net_tstamp.h> /* txtime */
+#include <linux/version.h>
+#include <sys/mman.h>
+
+/* The AF_XDP backend uses BPF links for attaching the XDP program to the
+ * interface. These are available since Linux 5.9. */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5,9,0)
+# define UA_ETH_XDP 1
+# include <linux/if_xdp.h>
+# include <linux/if_link.h> /* XDP_FLAGS_* */
+# include <linux/bpf.h>
+# include <sys/syscall.h>
+#endif
 
 /* Configuration parameters */
 
@@ -26,7 +38,7 @@ static UA_KeyValueRestriction ethManagerParams[ETH_MANAGERPARAMS] = {
     {{0, UA_STRING_STATIC("send-bufsize")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false}
 };
 
-#define ETH_PARAMETERSSIZE 15
+#define ETH_PARAMETERSSIZE 22
 #define ETH_PARAMINDEX_ADDR 0
 #define ETH_PARAMINDEX_LISTEN 1
 #define ETH_PARAMINDEX_IFACE 2
@@ -42,6 +54,13 @@ static UA_KeyValueRestriction ethManagerParams[ETH_MANAGERPARAMS] = {
 #define ETH_PARAMINDEX_TXTIME_PICO 12
 #define ETH_PARAMINDEX_TXTIME_DROP 13
 #define ETH_PARAMINDEX_VALIDATE 14
+#define ETH_PARAMINDEX_XDP_ENABLE 15
+#define ETH_PARAMINDEX_XDP_FLAGS 16
+#define ETH_PARAMINDEX_XDP_QUEUE 17
+#define ETH_PARAMINDEX_XDP_BINDFLAGS 18
+#define ETH_PARAMINDEX_RING 19
+#define ETH_PARAMINDEX_RING_SIZE 20
+#define ETH_PARAMINDEX_RING_TIMEOUT 21
 
 static UA_KeyValueRestriction ethConnectionParams[ETH_PARAMETERSSIZE+1] = {
     {{0, UA_STRING_STATIC("address")}, &UA_TYPES[UA_TYPES_STRING], false, true, false},
@@ -59,12 +78,24 @@ static UA_KeyValueRestriction ethConnectionParams[ETH_PARAMETERSSIZE+1] = {
     {{0, UA_STRING_STATIC("txtime-pico")}, &UA_TYPES[UA_TYPES_UINT16], false, true, false},
     {{0, UA_STRING_STATIC("txtime-drop-late")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false},
     {{0, UA_STRING_STATIC("validate")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false},
+    {{0, UA_STRING_STATIC("xdp-enable")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false},
+    {{0, UA_STRING_STATIC("xdp-flags")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false},
+    {{0, UA_STRING_STATIC("xdp-queue")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false},
+    {{0, UA_STRING_STATIC("xdp-bindflags")}, &UA_TYPES[UA_TYPES_UINT16], false, true, false},
+    {{0, UA_STRING_STATIC("packet-ring")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false},
+    {{0, UA_STRING_STATIC("packet-ring-size")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false},
+    {{0, UA_STRING_STATIC("packet-ring-timeout")}, &UA_TYPES[UA_TYPES_UINT32], false, true, false},
     /* Duplicated address parameter with a scalar value required. For the send-socket case. */
     {{0, UA_STRING_STATIC("address")}, &UA_TYPES[UA_TYPES_STRING], true, true, false},
 };
 
 #define UA_ETH_MAXHEADERLENGTH (2*ETHER_ADDR_LEN)+4+2+2
 
+#ifdef UA_ETH_XDP
+struct ETH_XDPSocket;
+typedef struct ETH_XDPSocket ETH_XDPSocket;
+#endif
+
 typedef struct {
     UA_RegisteredFD rfd;
 
@@ -84,6 +115,24 @@ typedef struct {
     unsigned char lengthOffset; /* No length field if zero */
 
     UA_Boolean txtimeEnabled;
+
+    /* PACKET_MMAP ring (TPACKET_V3). The rx ring for listen connections
+     * consists of blocks with several frames each. The tx ring for send
+     * connections consists of fixed-size frames. */
+    UA_Byte *ring;
+    size_t ringSize;
+    UA_UInt32 ringEntrySize;
+    UA_UInt32 ringEntries;
+    UA_UInt32 ringIndex;
+
+#ifdef UA_ETH_XDP
+    /* The AF_XDP socket is shared between the connections for the same
+     * interface and queue. Then rfd.fd is a duplicate of the AF_XDP socket.
+     * The PF_PACKET socket is kept open for the multicast membership and the
+     * promiscuous mode. */
+    ETH_XDPSocket *xdp;
+    UA_FD packetFd;
+#endif
 } ETH_FD;
 
 /* The format of a Ethernet address is six groups of hexadecimal digits,
@@ -206,23 +255,21 @@ setETHHeader(unsigned char *buf,
     return (unsigned char)pos;
 }
 
+/* The buffers are allocated with the space for the longest possible Ethernet
+ * header hidden in front. So they can be freed independent of the connection
+ * (which might be closed in the meantime). The header of the connection is set
+ * just before the payload when sending. */
+#define ETH_HEADERRESERVE (UA_ETH_MAXHEADERLENGTH)
+
 static UA_StatusCode
 ETH_allocNetworkBuffer(UA_ConnectionManager *cm, uintptr_t connectionId,
                        UA_ByteString *buf, size_t bufSize) {
-    /* Get the ETH_FD */
-    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
-    UA_FD fd = (UA_FD)connectionId;
-    ETH_FD *erfd = (ETH_FD*)ZIP_FIND(UA_FDTree, &pcm->fds, &fd);
-    if(!erfd)
-        return UA_STATUSCODE_BADCONNECTIONREJECTED;
-
-    /* Allocate the buffer with the hidden Ethernet header in front */
     UA_StatusCode res =
         UA_EventLoopPOSIX_allocNetworkBuffer(cm, connectionId, buf,
-                                             bufSize + erfd->headerSize);
+                                             bufSize + ETH_HEADERRESERVE);
     if(UA_LIKELY(res == UA_STATUSCODE_GOOD)) {
-        buf->data   += erfd->headerSize;
-        buf->length -= erfd->headerSize;
+        buf->data   += ETH_HEADERRESERVE;
+        buf->length -= ETH_HEADERRESERVE;
     }
     return res;
 }
@@ -230,19 +277,649 @@ ETH_allocNetworkBuffer(UA_ConnectionManager *cm, uintptr_t connectionId,
 static void
 ETH_freeNetworkBuffer(UA_ConnectionManager *cm, uintptr_t connectionId,
                       UA_ByteString *buf) {
-    /* Get the ETH_FD */
-    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
-    UA_FD fd = (UA_FD)connectionId;
-    ETH_FD *erfd = (ETH_FD*)ZIP_FIND(UA_FDTree, &pcm->fds, &fd);
-    if(!erfd)
+    if(!buf->data)
         return;
-
     /* Unhide the Ethernet header and free */
-    buf->data   -= erfd->headerSize;
-    buf->length += erfd->headerSize;
+    buf->data   -= ETH_HEADERRESERVE;
+    buf->length += ETH_HEADERRESERVE;
     UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
 }
 
+#ifdef UA_ETH_XDP
+
+/* AF_XDP Backend
+ * --------------
+ * Frames are received and sent through rings that are shared between the
+ * AF_XDP socket and the kernel. The frame buffers are located in the "UMEM"
+ * memory region that is registered with the socket. Received frames are handed
+ * to the application directly from the UMEM. If the driver supports the
+ * XDP_ZEROCOPY bind mode, then the NIC transfers the frames from/to the UMEM
+ * via DMA. Otherwise the kernel copies the frames (XDP_COPY). Together with the
+ * SKB attach mode (generic XDP) this also works for veth and loopback
+ * interfaces.
+ *
+ * The first half of the UMEM frames is used for receiving. These are handed to
+ * the kernel via the fill ring and come back via the rx ring. The second half
+ * is used for sending. The free transmit frames are kept in a stack. Sent
+ * frames come back via the completion ring.
+ *
+ * A small XDP program is attached to the interface. It redirects the frames
+ * with the configured EtherType (also with a VLAN tag) to the AF_XDP socket
+ * registered for the receive queue in an XSKMAP. All other frames pass to the
+ * normal network stack. */
+
+#define ETH_XDP_FRAMESIZE 2048
+#define ETH_XDP_RINGSIZE 512 /* Must be a power of two */
+#define ETH_XDP_RINGMASK (ETH_XDP_RINGSIZE - 1)
+#define ETH_XDP_UMEMSIZE (2 * ETH_XDP_RINGSIZE * ETH_XDP_FRAMESIZE)
+#define ETH_XDP_BATCHSIZE 64
+#define ETH_XDP_MAXQUEUES 64 /* Number of entries in the XSKMAP */
+
+typedef struct {
+    UA_UInt32 *producer;
+    UA_UInt32 *consumer;
+    void *descs;
+    void *map;
+    size_t mapSize;
+} ETH_XDPRing;
+
+/* The XDP program and the XSKMAP are shared for all sockets on an interface */
+typedef struct {
+    size_t refCount;
+    int ifindex;
+    UA_UInt16 etherType;
+    int mapFd;
+    int progFd;
+    int linkFd; /* The program is detached when the link is closed */
+} ETH_XDPProgram;
+
+struct ETH_XDPSocket {
+    size_t refCount;
+    UA_FD fd;
+    int ifindex;
+    UA_UInt32 queue;
+    UA_Byte *umem;
+    ETH_XDPRing fill;
+    ETH_XDPRing comp;
+    ETH_XDPRing rx;
+    ETH_XDPRing tx;
+    ETH_XDPProgram *prog; /* Set while a listen connection uses the socket */
+    size_t txFreeSize;
+    UA_UInt64 txFree[ETH_XDP_RINGSIZE];
+};
+
+static UA_UInt32
+ETH_XDP_loadIndex(UA_UInt32 *index) {
+    return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+static void
+ETH_XDP_storeIndex(UA_UInt32 *index, UA_UInt32 value) {
+    __atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+
+static int
+ETH_bpf(int cmd, union bpf_attr *attr) {
+    return (int)syscall(__NR_bpf, cmd, attr, sizeof(union bpf_attr));
+}
+
+static void
+ETH_XDP_freeProgram(ETH_XDPProgram *prog) {
+    if(prog->linkFd >= 0)
+        UA_close(prog->linkFd);
+    if(prog->progFd >= 0)
+        UA_close(prog->progFd);
+    if(prog->mapFd >= 0)
+        UA_close(prog->mapFd);
+    UA_free(prog);
+}
+
+static UA_StatusCode
+ETH_XDP_createProgram(UA_EventLoopPOSIX *el, int ifindex, UA_UInt16 etherType,
+                      const UA_UInt32 *xdpFlags, ETH_XDPProgram **outProg) {
+    ETH_XDPProgram *prog = (ETH_XDPProgram*)UA_calloc(1, sizeof(ETH_XDPProgram));
+    if(!prog)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    prog->ifindex = ifindex;
+    prog->etherType = etherType;
+    prog->progFd = -1;
+    prog->linkFd = -1;
+
+    /* Create the map from the receive queue index to the AF_XDP socket */
+    union bpf_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.map_type = BPF_MAP_TYPE_XSKMAP;
+    attr.key_size = sizeof(UA_UInt32);
+    attr.value_size = sizeof(int);
+    attr.max_entries = ETH_XDP_MAXQUEUES;
+    prog->mapFd = ETH_bpf(BPF_MAP_CREATE, &attr);
+    if(prog->mapFd < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                        "ETH\t| Could not create the XSKMAP (%s)", errno_str));
+        ETH_XDP_freeProgram(prog);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* The XDP program. Jump offsets are relative to the next instruction. The
+     * frame is passed on if the queue has no entry in the XSKMAP. */
+    UA_Int32 et = htons(etherType);
+    struct bpf_insn insns[] = {
+        /* r2 = ctx->data; r3 = ctx->data_end */
+        {BPF_LDX | BPF_MEM | BPF_W, 2, 1, offsetof(struct xdp_md, data), 0},
+        {BPF_LDX | BPF_MEM | BPF_W, 3, 1, offsetof(struct xdp_md, data_end), 0},
+        /* if(data + 14 > data_end) goto pass */
+        {BPF_ALU64 | BPF_MOV | BPF_X, 4, 2, 0, 0},
+        {BPF_ALU64 | BPF_ADD | BPF_K, 4, 0, 0, 14},
+        {BPF_JMP | BPF_JGT | BPF_X, 4, 3, 13, 0},
+        /* if(ethertype == et) goto redirect */
+        {BPF_LDX | BPF_MEM | BPF_H, 5, 2, 12, 0},
+        {BPF_JMP | BPF_JEQ | BPF_K, 5, 0, 5, et},
+        /* if(ethertype != VLAN) goto pass */
+        {BPF_JMP | BPF_JNE | BPF_K, 5, 0, 10, htons(0x8100)},
+        /* if(data + 18 > data_end) goto pass */
+        {BPF_ALU64 | BPF_ADD | BPF_K, 4, 0, 0, 4},
+        {BPF_JMP | BPF_JGT | BPF_X, 4, 3, 8, 0},
+        /* if(vlan ethertype != et) goto pass */
+        {BPF_LDX | BPF_MEM | BPF_H, 5, 2, 16, 0},
+        {BPF_JMP | BPF_JNE | BPF_K, 5, 0, 6, et},
+        /* redirect: return bpf_redirect_map(map, ctx->rx_queue_index, XDP_PASS) */
+        {BPF_LDX | BPF_MEM | BPF_W, 2, 1, offsetof(struct xdp_md, rx_queue_index), 0},
+        {BPF_LD | BPF_DW | BPF_IMM, 1, BPF_PSEUDO_MAP_FD, 0, prog->mapFd},
+        {0, 0, 0, 0, 0},
+        {BPF_ALU64 | BPF_MOV | BPF_K, 3, 0, 0, XDP_PASS},
+        {BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map},
+        {BPF_JMP | BPF_EXIT, 0, 0, 0, 0},
+        /* pass: return XDP_PASS */
+        {BPF_ALU64 | BPF_MOV | BPF_K, 0, 0, 0, XDP_PASS},
+        {BPF_JMP | BPF_EXIT, 0, 0, 0, 0}
+    };
+
+    /* Skip the EtherType filter to redirect all frames */
+    size_t skip = (etherType == ETH_P_ALL) ? 12 : 0;
+    memset(&attr, 0, sizeof(attr));
+    attr.prog_type = BPF_PROG_TYPE_XDP;
+    attr.insns = (UA_UInt64)(uintptr_t)&insns[skip];
+    attr.insn_cnt = (UA_UInt32)((sizeof(insns) / sizeof(struct bpf_insn)) - skip);
+    attr.license = (UA_UInt64)(uintptr_t)"Dual MPL/GPL";
+    prog->progFd = ETH_bpf(BPF_PROG_LOAD, &attr);
+    if(prog->progFd < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                        "ETH\t| Could not load the XDP program (%s)", errno_str));
+        ETH_XDP_freeProgram(prog);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Attach to the interface. Without explicit flags, fall back to the SKB
+     * mode if the driver has no native XDP support. */
+    memset(&attr, 0, sizeof(attr));
+    attr.link_create.prog_fd = (UA_UInt32)prog->progFd;
+    attr.link_create.target_ifindex = (UA_UInt32)ifindex;
+    attr.link_create.attach_type = BPF_XDP;
+    attr.link_create.flags = (xdpFlags) ? *xdpFlags : 0;
+    prog->linkFd = ETH_bpf(BPF_LINK_CREATE, &attr);
+    if(prog->linkFd < 0 && !xdpFlags) {
+        UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                    "ETH\t| Native XDP not available, falling back to the SKB mode");
+        attr.link_create.flags = XDP_FLAGS_SKB_MODE;
+        prog->linkFd = ETH_bpf(BPF_LINK_CREATE, &attr);
+    }
+    if(prog->linkFd < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                        "ETH\t| Could not attach the XDP program (%s)", errno_str));
+        ETH_XDP_freeProgram(prog);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    *outProg = prog;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+ETH_XDP_unmapRing(ETH_XDPRing *ring) {
+    if(ring->map)
+        munmap(ring->map, ring->mapSize);
+}
+
+static void
+ETH_XDP_freeSocket(ETH_XDPSocket *xs) {
+    ETH_XDP_unmapRing(&xs->fill);
+    ETH_XDP_unmapRing(&xs->comp);
+    ETH_XDP_unmapRing(&xs->rx);
+    ETH_XDP_unmapRing(&xs->tx);
+    if(xs->fd != UA_INVALID_FD)
+        UA_close(xs->fd);
+    if(xs->umem)
+        munmap(xs->umem, ETH_XDP_UMEMSIZE);
+    UA_free(xs);
+}
+
+static UA_StatusCode
+ETH_XDP_mapRing(ETH_XDPSocket *xs, ETH_XDPRing *ring,
+                const struct xdp_ring_offset *off, size_t descSize, off_t pgoff) {
+    ring->mapSize = off->desc + (ETH_XDP_RINGSIZE * descSize);
+    ring->map = mmap(NULL, ring->mapSize, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, xs->fd, pgoff);
+    if(ring->map == MAP_FAILED) {
+        ring->map = NULL;
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    UA_Byte *base = (UA_Byte*)ring->map;
+    ring->producer = (UA_UInt32*)(uintptr_t)(base + off->producer);
+    ring->consumer = (UA_UInt32*)(uintptr_t)(base + off->consumer);
+    ring->descs = base + off->desc;
+    return UA_STATUSCODE_GOOD;
+}
+
+static int
+ETH_XDP_bind(ETH_XDPSocket *xs, UA_UInt16 flags) {
+    struct sockaddr_xdp sxdp;
+    memset(&sxdp, 0, sizeof(sxdp));
+    sxdp.sxdp_family = AF_XDP;
+    sxdp.sxdp_flags = flags;
+    sxdp.sxdp_ifindex = (UA_UInt32)xs->ifindex;
+    sxdp.sxdp_queue_id = xs->queue;
+    return bind(xs->fd, (struct sockaddr*)&sxdp, sizeof(sxdp));
+}
+
+static UA_StatusCode
+ETH_XDP_createSocket(UA_EventLoopPOSIX *el, int ifindex, UA_UInt32 queue,
+                     const UA_UInt16 *bindFlags, ETH_XDPSocket **outSocket) {
+    ETH_XDPSocket *xs = (ETH_XDPSocket*)UA_calloc(1, sizeof(ETH_XDPSocket));
+    if(!xs)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    xs->ifindex = ifindex;
+    xs->queue = queue;
+
+    xs->fd = socket(AF_XDP, SOCK_RAW, 0);
+    if(xs->fd == UA_INVALID_FD) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                        "ETH\t| Could not create an AF_XDP socket (%s)", errno_str));
+        UA_free(xs);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    UA_StatusCode res = UA_EventLoopPOSIX_setNonBlocking(xs->fd);
+    if(res != UA_STATUSCODE_GOOD)
+        goto error;
+
+    /* Allocate and register the UMEM */
+    xs->umem = (UA_Byte*)mmap(NULL, ETH_XDP_UMEMSIZE, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(xs->umem == MAP_FAILED) {
+        xs->umem = NULL;
+        res = UA_STATUSCODE_BADOUTOFMEMORY;
+        goto error;
+    }
+
+    struct xdp_umem_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.addr = (UA_UInt64)(uintptr_t)xs->umem;
+    reg.len = ETH_XDP_UMEMSIZE;
+    reg.chunk_size = ETH_XDP_FRAMESIZE;
+    int ringSize = ETH_XDP_RINGSIZE;
+    if(setsockopt(xs->fd, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) < 0 ||
+       setsockopt(xs->fd, SOL_XDP, XDP_UMEM_FILL_RING, &ringSize, sizeof(int)) < 0 ||
+       setsockopt(xs->fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &ringSize, sizeof(int)) < 0 ||
+       setsockopt(xs->fd, SOL_XDP, XDP_RX_RING, &ringSize, sizeof(int)) < 0 ||
+       setsockopt(xs->fd, SOL_XDP, XDP_TX_RING, &ringSize, sizeof(int)) < 0) {
+        res = UA_STATUSCODE_BADINTERNALERROR;
+        goto error;
+    }
+
+    /* Map the rings into userspace */
+    struct xdp_mmap_offsets off;
+    socklen_t optlen = sizeof(off);
+    if(getsockopt(xs->fd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optlen) < 0) {
+        res = UA_STATUSCODE_BADINTERNALERROR;
+        goto error;
+    }
+    res |= ETH_XDP_mapRing(xs, &xs->fill, &off.fr, sizeof(UA_UInt64),
+                           XDP_UMEM_PGOFF_FILL_RING);
+    res |= ETH_XDP_mapRing(xs, &xs->comp, &off.cr, sizeof(UA_UInt64),
+                           XDP_UMEM_PGOFF_COMPLETION_RING);
+    res |= ETH_XDP_mapRing(xs, &xs->rx, &off.rx, sizeof(struct xdp_desc),
+                           XDP_PGOFF_RX_RING);
+    res |= ETH_XDP_mapRing(xs, &xs->tx, &off.tx, sizeof(struct xdp_desc),
+                           XDP_PGOFF_TX_RING);
+    if(res != UA_STATUSCODE_GOOD)
+        goto error;
+
+    /* Bind to the interface queue. Without explicit bind flags try zero-copy
+     * first and fall back to copy mode. */
+    int ret;
+    if(bindFlags) {
+        ret = ETH_XDP_bind(xs, *bindFlags);
+    } else {
+        ret = ETH_XDP_bind(xs, XDP_ZEROCOPY);
+        if(ret < 0) {
+            UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                        "ETH\t| XDP zero-copy not available, "
+                        "falling back to the copy mode");
+            ret = ETH_XDP_bind(xs, XDP_COPY);
+        }
+    }
+    if(ret < 0) {
+        res = UA_STATUSCODE_BADINTERNALERROR;
+        goto error;
+    }
+
+    /* Hand the receive frames to the kernel */
+    UA_UInt64 *fill = (UA_UInt64*)xs->fill.descs;
+    for(size_t i = 0; i < ETH_XDP_RINGSIZE; i++)
+        fill[i] = i * ETH_XDP_FRAMESIZE;
+    ETH_XDP_storeIndex(xs->fill.producer, ETH_XDP_RINGSIZE);
+
+    /* The transmit frames are kept in userspace until they are sent */
+    for(size_t i = 0; i < ETH_XDP_RINGSIZE; i++)
+        xs->txFree[i] = (ETH_XDP_RINGSIZE + i) * ETH_XDP_FRAMESIZE;
+    xs->txFreeSize = ETH_XDP_RINGSIZE;
+
+    UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                "ETH %u\t| Opened an AF_XDP socket for queue %u",
+                (unsigned)xs->fd, (unsigned)queue);
+    *outSocket = xs;
+    return UA_STATUSCODE_GOOD;
+
+ error:
+    UA_LOG_SOCKET_ERRNO_WRAP(
+       UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                    "ETH %u\t| Could not set up the AF_XDP socket (%s)",
+                    (unsigned)xs->fd, errno_str));
+    ETH_XDP_freeSocket(xs);
+    return res;
+}
+
+typedef struct {
+    int ifindex;
+    UA_UInt32 queue;
+} ETH_XDPSearch;
+
+static void *
+ETH_XDP_findSocketCB(void *context, UA_RegisteredFD *rfd) {
+    ETH_XDPSearch *search = (ETH_XDPSearch*)context;
+    ETH_FD *conn = (ETH_FD*)rfd;
+    if(conn->xdp && conn->xdp->ifindex == search->ifindex &&
+       conn->xdp->queue == search->queue)
+        return conn->xdp;
+    return NULL;
+}
+
+static void *
+ETH_XDP_findProgramCB(void *context, UA_RegisteredFD *rfd) {
+    ETH_FD *conn = (ETH_FD*)rfd;
+    if(conn->xdp && conn->xdp->prog &&
+       conn->xdp->prog->ifindex == *(int*)context)
+        return conn->xdp->prog;
+    return NULL;
+}
+
+/* Release the XDP resources of the connection. The PF_PACKET socket is closed
+ * as well. The (duplicated) rfd.fd is closed by the caller. */
+static void
+ETH_XDP_release(ETH_FD *conn) {
+    ETH_XDPSocket *xs = conn->xdp;
+    conn->xdp = NULL;
+
+    /* Detach the socket from the XSKMAP if this is the listen connection */
+    ETH_XDPProgram *prog = xs->prog;
+    if(prog && (conn->rfd.listenEvents & UA_FDEVENT_IN)) {
+        union bpf_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.map_fd = (UA_UInt32)prog->mapFd;
+        attr.key = (UA_UInt64)(uintptr_t)&xs->queue;
+        ETH_bpf(BPF_MAP_DELETE_ELEM, &attr);
+        xs->prog = NULL;
+        prog->refCount--;
+        if(prog->refCount == 0)
+            ETH_XDP_freeProgram(prog);
+    }
+
+    xs->refCount--;
+    if(xs->refCount == 0)
+        ETH_XDP_freeSocket(xs);
+
+    UA_close(conn->packetFd);
+}
+
+static UA_StatusCode
+ETH_XDP_attachListener(UA_EventLoopPOSIX *el, ETH_XDPSocket *xs,
+                       ETH_XDPProgram *prog, UA_UInt16 etherType,
+                       const UA_UInt32 *xdpFlags) {
+    if(xs->prog) {
+        UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                     "ETH\t| The XDP queue %u already has a listen connection",
+                     (unsigned)xs->queue);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Reuse the program of the interface or create a new one */
+    if(prog && prog->etherType != etherType) {
+        UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                     "ETH\t| The XDP program of the interface "
+                     "uses a different EtherType");
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    if(!prog) {
+        UA_StatusCode res =
+            ETH_XDP_createProgram(el, xs->ifindex, etherType, xdpFlags, &prog);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+
+    /* Register the socket for the queue in the XSKMAP */
+    union bpf_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.map_fd = (UA_UInt32)prog->mapFd;
+    attr.key = (UA_UInt64)(uintptr_t)&xs->queue;
+    attr.value = (UA_UInt64)(uintptr_t)&xs->fd;
+    attr.flags = BPF_ANY;
+    if(ETH_bpf(BPF_MAP_UPDATE_ELEM, &attr) < 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                        "ETH\t| Could not register the AF_XDP socket "
+                        "in the XSKMAP (%s)", errno_str));
+        if(prog->refCount == 0)
+            ETH_XDP_freeProgram(prog);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    prog->refCount++;
+    xs->prog = prog;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Replace the PF_PACKET socket of the connection with (a duplicate of) the
+ * AF_XDP socket for the interface queue */
+static UA_StatusCode
+ETH_XDP_open(UA_POSIXConnectionManager *pcm, ETH_FD *conn,
+             const UA_KeyValueMap *params, int ifindex,
+             UA_UInt16 etherType, UA_Boolean listen) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    UA_LOCK_ASSERT(&el->elMutex, 1);
+
+    if(conn->txtimeEnabled) {
+        UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                     "ETH\t| txtime sending is not supported with XDP");
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    }
+
+    const UA_UInt32 *xdpFlags = (const UA_UInt32*)
+        UA_KeyValueMap_getScalar(params, ethConnectionParams[ETH_PARAMINDEX_XDP_FLAGS].name,
+                                 &UA_TYPES[UA_TYPES_UINT32]);
+    const UA_UInt16 *bindFlags = (const UA_UInt16*)
+        UA_KeyValueMap_getScalar(params, ethConnectionParams[ETH_PARAMINDEX_XDP_BINDFLAGS].name,
+                                 &UA_TYPES[UA_TYPES_UINT16]);
+    const UA_UInt32 *queueParam = (const UA_UInt32*)
+        UA_KeyValueMap_getScalar(params, ethConnectionParams[ETH_PARAMINDEX_XDP_QUEUE].name,
+                                 &UA_TYPES[UA_TYPES_UINT32]);
+    UA_UInt32 queue = (queueParam) ? *queueParam : 0;
+    if(queue >= ETH_XDP_MAXQUEUES) {
+        UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                     "ETH\t| XDP queue %u out of range", (unsigned)queue);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Reuse the AF_XDP socket for the queue or create a new one */
+    ETH_XDPSearch search = {ifindex, queue};
+    ETH_XDPSocket *xs = (ETH_XDPSocket*)
+        ZIP_ITER(UA_FDTree, &pcm->fds, ETH_XDP_findSocketCB, &search);
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(!xs) {
+        res = ETH_XDP_createSocket(el, ifindex, queue, bindFlags, &xs);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+
+    /* Use a duplicate of the AF_XDP socket as the connection identifier */
+    UA_FD fd = dup(xs->fd);
+    if(fd == UA_INVALID_FD) {
+        res = UA_STATUSCODE_BADINTERNALERROR;
+        goto error;
+    }
+
+    /* Redirect the received frames for the queue to the socket */
+    if(listen) {
+        ETH_XDPProgram *prog = (ETH_XDPProgram*)
+            ZIP_ITER(UA_FDTree, &pcm->fds, ETH_XDP_findProgramCB, &ifindex);
+        res = ETH_XDP_attachListener(el, xs, prog, etherType, xdpFlags);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_close(fd);
+            goto error;
+        }
+    }
+
+    xs->refCount++;
+    conn->xdp = xs;
+    conn->packetFd = conn->rfd.fd;
+    conn->rfd.fd = fd;
+    return UA_STATUSCODE_GOOD;
+
+ error:
+    if(xs->refCount == 0)
+        ETH_XDP_freeSocket(xs);
+    return res;
+}
+
+#endif /* UA_ETH_XDP */
+
+/* PACKET_MMAP Rings
+ * -----------------
+ * With the TPACKET_V3 rx ring, the kernel writes the received frames into
+ * blocks of a ring buffer that is shared with userspace. A block is handed to
+ * userspace once it is full or when the block timeout expires. All frames of
+ * the available blocks are then processed without further system calls. The
+ * tx ring consists of fixed-size frame slots. The frames are written into the
+ * slots directly. The kernel is notified with a single send call at the end of
+ * the EventLoop iteration (or when the ring is full). */
+
+#define ETH_RING_BLOCKSIZE (1u << 16) /* Multiple of the page size */
+#define ETH_RING_FRAMESIZE 2048
+#define ETH_RING_DEFAULTSIZE (1u << 20)
+#define ETH_RING_DEFAULTTIMEOUT 1 /* ms */
+#define ETH_RING_TXOFFSET TPACKET_ALIGN(sizeof(struct tpacket3_hdr))
+
+static UA_StatusCode
+ETH_setupRing(UA_EventLoopPOSIX *el, ETH_FD *conn,
+              const UA_KeyValueMap *params, UA_Boolean listen) {
+    const UA_Boolean *txtime = (const UA_Boolean*)
+        UA_KeyValueMap_getScalar(params,
+                                 ethConnectionParams[ETH_PARAMINDEX_TXTIME_ENABLE].name,
+                                 &UA_TYPES[UA_TYPES_BOOLEAN]);
+    if(txtime && *txtime) {
+        UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                     "ETH %u\t| txtime sending is not supported with a packet ring",
+                     (unsigned)conn->rfd.fd);
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    }
+
+    int version = TPACKET_V3;
+    if(setsockopt(conn->rfd.fd, SOL_PACKET, PACKET_VERSION,
+                  &version, sizeof(version)) < 0)
+        goto error;
+
+    /* Skip malformed frames in the tx ring instead of stalling */
+    int one = 1;
+    if(!listen && setsockopt(conn->rfd.fd, SOL_PACKET, PACKET_LOSS,
+                             &one, sizeof(one)) < 0)
+        goto error;
+
+    UA_UInt32 size = ETH_RING_DEFAULTSIZE;
+    const UA_UInt32 *sizeParam = (const UA_UInt32*)
+        UA_KeyValueMap_getScalar(params, ethConnectionParams[ETH_PARAMINDEX_RING_SIZE].name,
+                                 &UA_TYPES[UA_TYPES_UINT32]);
+    if(sizeParam)
+        size = *sizeParam;
+    UA_UInt32 timeout = ETH_RING_DEFAULTTIMEOUT;
+    const UA_UInt32 *timeoutParam = (const UA_UInt32*)
+        UA_KeyValueMap_getScalar(params, ethConnectionParams[ETH_PARAMINDEX_RING_TIMEOUT].name,
+                                 &UA_TYPES[UA_TYPES_UINT32]);
+    if(timeoutParam)
+        timeout = *timeoutParam;
+
+    struct tpacket_req3 req;
+    memset(&req, 0, sizeof(req));
+    req.tp_block_size = ETH_RING_BLOCKSIZE;
+    req.tp_block_nr = size / ETH_RING_BLOCKSIZE;
+    if(req.tp_block_nr == 0)
+        req.tp_block_nr = 1;
+    req.tp_frame_size = ETH_RING_FRAMESIZE;
+    req.tp_frame_nr = (ETH_RING_BLOCKSIZE / ETH_RING_FRAMESIZE) * req.tp_block_nr;
+    if(listen) {
+        req.tp_retire_blk_tov = timeout;
+        if(setsockopt(conn->rfd.fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0)
+            goto error;
+        conn->ringEntrySize = req.tp_block_size;
+        conn->ringEntries = req.tp_block_nr;
+    } else {
+        if(setsockopt(conn->rfd.fd, SOL_PACKET, PACKET_TX_RING, &req, sizeof(req)) < 0)
+            goto error;
+        conn->ringEntrySize = req.tp_frame_size;
+        conn->ringEntries = req.tp_frame_nr;
+    }
+
+    conn->ringSize = (size_t)req.tp_block_size * req.tp_block_nr;
+    void *ring = mmap(NULL, conn->ringSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, conn->rfd.fd, 0);
+    if(ring == MAP_FAILED)
+        goto error;
+    conn->ring = (UA_Byte*)ring;
+
+    UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                "ETH %u\t| Mapped a packet %s ring of %u bytes",
+                (unsigned)conn->rfd.fd, (listen) ? "rx" : "tx",
+                (unsigned)conn->ringSize);
+    return UA_STATUSCODE_GOOD;
+
+ error:
+    UA_LOG_SOCKET_ERRNO_WRAP(
+       UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                    "ETH %u\t| Could not set up the packet ring (%s)",
+                    (unsigned)conn->rfd.fd, errno_str));
+    return UA_STATUSCODE_BADINTERNALERROR;
+}
+
+/* Notify the kernel to send out the frames in the tx ring */
+static void
+ETH_kickRing(ETH_FD *conn, int flags) {
+    sendto(conn->rfd.fd, NULL, 0, flags,
+           (struct sockaddr*)&conn->sll, sizeof(conn->sll));
+}
+
+static void
+ETH_delayedKickRing(void *application, void *context) {
+    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)application;
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    ETH_FD *conn = (ETH_FD*)context;
+    UA_LOCK(&el->elMutex);
+    conn->rfd.dc.callback = NULL; /* Can be scheduled again */
+    ETH_kickRing(conn, MSG_DONTWAIT);
+    UA_UNLOCK(&el->elMutex);
+}
+
 /* Test if the ConnectionManager can be stopped */
 static void
 ETH_checkStopped(UA_POSIXConnectionManager *pcm) {
@@ -268,6 +945,10 @@ ETH_close(UA_POSIXConnectionManager *pcm, ETH_FD *conn) {
                  "ETH %u\t| Closing connection",
                  (unsigned)conn->rfd.fd);
 
+    /* Send out the remaining frames from the tx ring */
+    if(conn->ring && conn->rfd.listenEvents == 0)
+        ETH_kickRing(conn, MSG_DONTWAIT);
+
     /* Deregister from the EventLoop */
     UA_EventLoopPOSIX_deregisterFD(el, &conn->rfd);
 
@@ -296,6 +977,15 @@ ETH_close(UA_POSIXConnectionManager *pcm, ETH_FD *conn) {
                           (unsigned)conn->rfd.fd, errno_str));
     }
 
+    if(conn->ring)
+        munmap(conn->ring, conn->ringSize);
+
+#ifdef UA_ETH_XDP
+    /* Release the AF_XDP socket and close the PF_PACKET socket */
+    if(conn->xdp)
+        ETH_XDP_release(conn);
+#endif
+
     /* Don't call free here. This might be done automatically via the delayed
      * callback that calls ETH_close. */
     /* UA_free(rfd); */
@@ -318,6 +1008,253 @@ ETH_delayedClose(void *application, void *context) {
     UA_free(conn);
 }
 
+/* Parse the Ethernet header and forward the frame to the application */
+static void
+ETH_processFrame(UA_POSIXConnectionManager *pcm, ETH_FD *conn,
+                 UA_ByteString response) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    UA_LOCK_ASSERT(&el->elMutex, 1);
+
+    /* Parse the Ethernet header */
+    unsigned char destAddr[ETHER_ADDR_LEN];
+    unsigned char sourceAddr[ETHER_ADDR_LEN];
+    UA_UInt16 etherType = 0;
+    UA_UInt16 vid = 0;
+    UA_Byte pcp = 0;
+    UA_Boolean dei = 0;
+    size_t headerSize = parseETHHeader(&response, destAddr, sourceAddr,
+                                       &etherType, &vid, &pcp, &dei);
+    if(headerSize == 0)
+        return;
+
+    /* Set up the parameter arguments passed to the application */
+    unsigned char destAddrBytes[18];
+    unsigned char sourceAddrBytes[18];
+    setAddrString(destAddrBytes, destAddr);
+    setAddrString(sourceAddrBytes, sourceAddr);
+    UA_String destAddrStr = {17, destAddrBytes};
+    UA_String sourceAddrStr = {17, sourceAddrBytes};
+
+    size_t paramsSize = 2;
+    UA_KeyValuePair params[6];
+    params[0].key = UA_QUALIFIEDNAME(0, "destination-address");
+    UA_Variant_setScalar(&params[0].value, &destAddrStr, &UA_TYPES[UA_TYPES_STRING]);
+    params[1].key = UA_QUALIFIEDNAME(0, "source-address");
+    UA_Variant_setScalar(&params[1].value, &sourceAddrStr, &UA_TYPES[UA_TYPES_STRING]);
+
+    if(etherType > 0) {
+        params[2].key = UA_QUALIFIEDNAME(0, "ethertype");
+        UA_Variant_setScalar(&params[2].value, &etherType, &UA_TYPES[UA_TYPES_UINT16]);
+        paramsSize++;
+    }
+
+    if(vid > 0) {
+        params[paramsSize].key = UA_QUALIFIEDNAME(0, "vid");
+        UA_Variant_setScalar(&params[paramsSize].value, &vid, &UA_TYPES[UA_TYPES_UINT16]);
+        params[paramsSize+1].key = UA_QUALIFIEDNAME(0, "pcp");
+        UA_Variant_setScalar(&params[paramsSize+1].value, &pcp, &UA_TYPES[UA_TYPES_BYTE]);
+        params[paramsSize+2].key = UA_QUALIFIEDNAME(0, "dei");
+        UA_Variant_setScalar(&params[paramsSize+2].value, &dei, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        paramsSize += 3;
+    }
+
+    /* Callback to the application layer with the Ethernet header hidden */
+    UA_KeyValueMap map = {paramsSize, params};
+    response.data += headerSize;
+    response.length -= headerSize;
+    UA_UNLOCK(&el->elMutex);
+    conn->applicationCB(&pcm->cm, (uintptr_t)conn->rfd.fd, conn->application,
+                        &conn->context, UA_CONNECTIONSTATE_ESTABLISHED, &map, response);
+    UA_LOCK(&el->elMutex);
+}
+
+/* Process the frames of all blocks that were handed to userspace */
+static void
+ETH_receiveRing(UA_POSIXConnectionManager *pcm, ETH_FD *conn) {
+    for(UA_UInt32 i = 0; i < conn->ringEntries; i++) {
+        struct tpacket_block_desc *block = (struct tpacket_block_desc*)(uintptr_t)
+            (conn->ring + ((size_t)conn->ringIndex * conn->ringEntrySize));
+        UA_UInt32 status =
+            __atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE);
+        if(!(status & TP_STATUS_USER))
+            return;
+
+        UA_Byte *pos = (UA_Byte*)block + block->hdr.bh1.offset_to_first_pkt;
+        for(UA_UInt32 j = 0; j < block->hdr.bh1.num_pkts; j++) {
+            struct tpacket3_hdr *hdr = (struct tpacket3_hdr*)(uintptr_t)pos;
+            UA_ByteString frame = {hdr->tp_snaplen, pos + hdr->tp_mac};
+            ETH_processFrame(pcm, conn, frame);
+            pos += hdr->tp_next_offset;
+        }
+
+        /* Return the block to the kernel */
+        __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL,
+                         __ATOMIC_RELEASE);
+        conn->ringIndex = (conn->ringIndex + 1) % conn->ringEntries;
+    }
+}
+
+/* Write the frame into the next slot of the tx ring. The kernel is notified
+ * at the end of the EventLoop iteration.
+ *
+ * The frame is copied into the slot. The network buffers are not handed out
+ * from the ring (also not from the AF_XDP UMEM). Buffers can be allocated ahead
+ * and kept over several sends (keep-buffer). A slot that is held by the
+ * application stalls the ring, as the kernel stops at the first slot not
+ * marked for sending. And buffers can be freed after the connection is closed
+ * and the ring is unmapped. The copy is bounded by the slot size. */
+static UA_StatusCode
+ETH_sendRing(UA_POSIXConnectionManager *pcm, ETH_FD *conn,
+             const UA_Byte *frame, size_t frameLength) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop;
+    if(frameLength > conn->ringEntrySize - ETH_RING_TXOFFSET) {
+        UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                     "ETH %u\t| The frame exceeds the slot size of the tx ring",
+                     (unsigned)conn->rfd.fd);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* The ring is full. Send out the pending frames (blocking). */
+    struct tpacket3_hdr *hdr = (struct tpacket3_hdr*)(uintptr_t)
+        (conn->ring + ((size_t)conn->ringIndex * conn->ringEntrySize));
+    if(__atomic_load_n(&hdr->tp_status, __ATOMIC_ACQUIRE) != TP_STATUS_AVAILABLE) {
+        ETH_kickRing(conn, 0);
+        if(__atomic_load_n(&hdr->tp_status, __ATOMIC_ACQUIRE) != TP_STATUS_AVAILABLE) {
+            UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                           "ETH %u\t| No free slot in the tx ring",
+                           (unsigned)conn->rfd.fd);
+            return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+        }
+    }
+
+    memcpy((UA_Byte*)hdr + ETH_RING_TXOFFSET, frame, frameLength);
+    hdr->tp_len = (UA_UInt32)frameLength;
+    hdr->tp_snaplen = (UA_UInt32)frameLength;
+    hdr->tp_next_offset = 0;
+    __atomic_store_n(&hdr->tp_status, TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+    conn->ringIndex = (conn->ringIndex + 1) % conn->ringEntries;
+
+    /* Schedule the notification of the kernel. The delayed callback of the
+     * rfd is also used for closing. If closing is pending, notify now. */
+    UA_DelayedCallback *dc = &conn->rfd.dc;
+    if(dc->callback == ETH_delayedKickRing)
+        return UA_STATUSCODE_GOOD;
+    if(dc->callback) {
+        ETH_kickRing(conn, MSG_DONTWAIT);
+        return UA_STATUSCODE_GOOD;
+    }
+    dc->callback = ETH_delayedKickRing;
+    dc->application = pcm;
+    dc->context = conn;
+    dc->next = el->delayedCallbacks;
+    el->delayedCallbacks = dc;
+    return UA_STATUSCODE_GOOD;
+}
+
+#ifdef UA_ETH_XDP
+
+/* Forward the frames from the rx ring to the application and hand the UMEM
+ * frames back to the kernel via the fill ring. The frames are not copied. */
+static void
+ETH_XDP_receive(UA_POSIXConnectionManager *pcm, ETH_FD *conn) {
+    ETH_XDPSocket *xs = conn->xdp;
+    UA_UInt32 cons = *xs->rx.consumer;
+    UA_UInt32 avail = ETH_XDP_loadIndex(xs->rx.producer) - cons;
+    if(avail > ETH_XDP_BATCHSIZE)
+        avail = ETH_XDP_BATCHSIZE;
+
+    UA_UInt64 addrs[ETH_XDP_BATCHSIZE];
+    struct xdp_desc *descs = (struct xdp_desc*)xs->rx.descs;
+    for(UA_UInt32 i = 0; i < avail; i++) {
+        struct xdp_desc *desc = &descs[(cons + i) & ETH_XDP_RINGMASK];
+        addrs[i] = desc->addr;
+        UA_ByteString frame = {desc->len, xs->umem + desc->addr};
+        ETH_processFrame(pcm, conn, frame);
+    }
+    ETH_XDP_storeIndex(xs->rx.consumer, cons + avail);
+
+    /* The fill ring has room for all receive frames */
+    UA_UInt32 prod = *xs->fill.producer;
+    UA_UInt64 *fill = (UA_UInt64*)xs->fill.descs;
+    for(UA_UInt32 i = 0; i < avail; i++)
+        fill[(prod + i) & ETH_XDP_RINGMASK] =
+            addrs[i] & ~(UA_UInt64)(ETH_XDP_FRAMESIZE - 1);
+    ETH_XDP_storeIndex(xs->fill.producer, prod + avail);
+}
+
+/* Take back the sent frames from the completion ring */
+static void
+ETH_XDP_reclaim(ETH_XDPSocket *xs) {
+    UA_UInt32 cons = *xs->comp.consumer;
+    UA_UInt32 prod = ETH_XDP_loadIndex(xs->comp.producer);
+    UA_UInt64 *comp = (UA_UInt64*)xs->comp.descs;
+    for(; cons != prod; cons++)
+        xs->txFree[xs->txFreeSize++] = comp[cons & ETH_XDP_RINGMASK];
+    ETH_XDP_storeIndex(xs->comp.consumer, cons);
+}
+
+/* Wake up the kernel to process the tx ring */
+static UA_StatusCode
+ETH_XDP_kick(ETH_XDPSocket *xs) {
+    if(sendto(xs->fd, NULL, 0, MSG_DONTWAIT, NULL, 0) >= 0 ||
+       UA_ERRNO == EAGAIN || UA_ERRNO == EBUSY ||
+       UA_ERRNO == ENOBUFS || UA_ERRNO == UA_INTERRUPTED)
+        return UA_STATUSCODE_GOOD;
+    return UA_STATUSCODE_BADCONNECTIONCLOSED;
+}
+
+/* Copy the frame into a free UMEM frame and enqueue it in the tx ring. The
+ * sending does not block. If all transmit frames are in flight, the frame is
+ * dropped. */
+static UA_StatusCode
+ETH_XDP_send(UA_EventLoopPOSIX *el, ETH_FD *conn,
+             const UA_Byte *frame, size_t frameLength) {
+    ETH_XDPSocket *xs = conn->xdp;
+    if(frameLength > ETH_XDP_FRAMESIZE) {
+        UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                     "ETH %u\t| The frame exceeds the XDP frame size",
+                     (unsigned)conn->rfd.fd);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    ETH_XDP_reclaim(xs);
+    if(xs->txFreeSize == 0) {
+        ETH_XDP_kick(xs);
+        ETH_XDP_reclaim(xs);
+        if(xs->txFreeSize == 0) {
+            UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                           "ETH %u\t| No free XDP frame for sending",
+                           (unsigned)conn->rfd.fd);
+            return UA_STATUSCODE_BADRESOURCEUNAVAILABLE;
+        }
+    }
+
+    /* The tx ring has room for all transmit frames */
+    UA_UInt64 addr = xs->txFree[--xs->txFreeSize];
+    memcpy(xs->umem + addr, frame, frameLength);
+    UA_UInt32 prod = *xs->tx.producer;
+    struct xdp_desc *desc =
+        &((struct xdp_desc*)xs->tx.descs)[prod & ETH_XDP_RINGMASK];
+    desc->addr = addr;
+    desc->len = (UA_UInt32)frameLength;
+    desc->options = 0;
+    ETH_XDP_storeIndex(xs->tx.producer, prod + 1);
+
+    UA_StatusCode res = ETH_XDP_kick(xs);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                        "ETH %u\t| Send failed with error %s",
+                        (unsigned)conn->rfd.fd, errno_str));
+    }
+    return res;
+}
+
+#endif /* UA_ETH_XDP */
+
+static void
+ETH_shutdown(UA_POSIXConnectionManager *pcm, ETH_FD *conn);
+
 /* Gets called when a socket receives data or closes */
 static void
 ETH_connectionSocketCallback(UA_ConnectionManager *cm, UA_RegisteredFD *rfd,
@@ -332,13 +1269,30 @@ ETH_connectionSocketCallback(UA_ConnectionManager *cm, UA_RegisteredFD *rfd,
            UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
                         "ETH %u\t| recv signaled the socket was shutdown (%s)",
                         (unsigned)rfd->fd, errno_str));
+        /* The delayed callback is pending. Close from there. */
+        if(rfd->dc.callback) {
+            ETH_shutdown(pcm, conn);
+            return;
+        }
         ETH_close(pcm, conn);
         UA_free(rfd);
         return;
     }
 
+    if(conn->ring) {
+        ETH_receiveRing(pcm, conn);
+        return;
+    }
+
+#ifdef UA_ETH_XDP
+    if(conn->xdp) {
+        ETH_XDP_receive(pcm, conn);
+        return;
+    }
+#endif
+
     /* Use the already allocated receive-buffer */
-    UA_ByteString response = pcm->rxBuffer;;
+    UA_ByteString response = pcm->rxBuffer;
 
     /* Receive */
 #ifndef _WIN32
@@ -371,76 +1325,25 @@ ETH_connectionSocketCallback(UA_ConnectionManager *cm, UA_RegisteredFD *rfd,
                  (unsigned)rfd->fd, (unsigned)ret);
 
     response.length = (size_t)ret;
-
-    /* Parse the Ethernet header */
-    unsigned char destAddr[ETHER_ADDR_LEN];
-    unsigned char sourceAddr[ETHER_ADDR_LEN];
-    UA_UInt16 etherType = 0;
-    UA_UInt16 vid = 0;
-    UA_Byte pcp = 0;
-    UA_Boolean dei = 0;
-    size_t headerSize = parseETHHeader(&response, destAddr, sourceAddr,
-                                       &etherType, &vid, &pcp, &dei);
-    if(headerSize == 0)
-        return;
-
-    /* Set up the parameter arguments passed to the application */
-    unsigned char destAddrBytes[18];
-    unsigned char sourceAddrBytes[18];
-    setAddrString(destAddrBytes, destAddr);
-    setAddrString(sourceAddrBytes, sourceAddr);
-    UA_String destAddrStr = {17, destAddrBytes};
-    UA_String sourceAddrStr = {17, sourceAddrBytes};
-
-    size_t paramsSize = 2;
-    UA_KeyValuePair params[6];
-    params[0].key = UA_QUALIFIEDNAME(0, "destination-address");
-    UA_Variant_setScalar(&params[0].value, &destAddrStr, &UA_TYPES[UA_TYPES_STRING]);
-    params[1].key = UA_QUALIFIEDNAME(0, "source-address");
-    UA_Variant_setScalar(&params[1].value, &sourceAddrStr, &UA_TYPES[UA_TYPES_STRING]);
-
-    if(etherType > 0) {
-        params[2].key = UA_QUALIFIEDNAME(0, "ethertype");
-        UA_Variant_setScalar(&params[1].value, &etherType, &UA_TYPES[UA_TYPES_UINT16]);
-        paramsSize++;
-    }
-
-    if(vid > 0) {
-        params[paramsSize].key = UA_QUALIFIEDNAME(0, "vid");
-        UA_Variant_setScalar(&params[paramsSize].value, &vid, &UA_TYPES[UA_TYPES_UINT16]);
-        params[paramsSize+1].key = UA_QUALIFIEDNAME(0, "pcp");
-        UA_Variant_setScalar(&params[paramsSize+1].value, &pcp, &UA_TYPES[UA_TYPES_BYTE]);
-        params[paramsSize+2].key = UA_QUALIFIEDNAME(0, "dei");
-        UA_Variant_setScalar(&params[paramsSize+2].value, &dei, &UA_TYPES[UA_TYPES_BOOLEAN]);
-        paramsSize += 3;
-    }
-
-    /* Callback to the application layer with the Ethernet header hidden */
-    UA_KeyValueMap map = {paramsSize, params};
-    response.data += headerSize;
-    response.length -= headerSize;
-    UA_UNLOCK(&el->elMutex);
-    conn->applicationCB(cm, (uintptr_t)rfd->fd, conn->application, &conn->context,
-                        UA_CONNECTIONSTATE_ESTABLISHED, &map, response);
-    UA_LOCK(&el->elMutex);
-    response.data -= headerSize;
-    response.length += headerSize;
+    ETH_processFrame(pcm, conn, response);
 }
 
 static UA_StatusCode
 ETH_openListenConnection(UA_EventLoopPOSIX *el, ETH_FD *conn,
                          const UA_KeyValueMap *params,
                          int ifindex, UA_UInt16 etherType,
-                         UA_Boolean validate) {
+                         UA_Boolean validate, UA_Boolean xdp) {
     UA_LOCK_ASSERT(&el->elMutex, 1);
 
-    /* Bind the socket to interface and EtherType. Don't receive anything else. */
+    /* Bind the socket to interface and EtherType. Don't receive anything else.
+     * With XDP the frames are received via the AF_XDP socket instead. */
     struct sockaddr_ll sll;
     memset(&sll, 0, sizeof(struct sockaddr_ll));
     sll.sll_family = AF_PACKET;
     sll.sll_protocol = htons(etherType);
     sll.sll_ifindex = ifindex;
-    if(!validate && bind(conn->rfd.fd, (struct sockaddr*)&sll, sizeof(sll)) < 0)
+    if(!validate && !xdp &&
+       bind(conn->rfd.fd, (struct sockaddr*)&sll, sizeof(sll)) < 0)
         return UA_STATUSCODE_BADINTERNALERROR;
 
     /* Immediately register for listen events. Don't have to wait for a
@@ -655,6 +1558,38 @@ ETH_openConnection(UA_ConnectionManager *cm, const UA_KeyValueMap *params,
     if(validateParam)
         validate = *validateParam;
 
+    /* Use the AF_XDP backend? */
+    UA_Boolean xdp = false;
+    const UA_Boolean *xdpParam = (const UA_Boolean*)
+        UA_KeyValueMap_getScalar(params,
+                                 ethConnectionParams[ETH_PARAMINDEX_XDP_ENABLE].name,
+                                 &UA_TYPES[UA_TYPES_BOOLEAN]);
+    if(xdpParam)
+        xdp = *xdpParam;
+    /* Use the PACKET_MMAP rings? */
+    UA_Boolean ring = false;
+    const UA_Boolean *ringParam = (const UA_Boolean*)
+        UA_KeyValueMap_getScalar(params,
+                                 ethConnectionParams[ETH_PARAMINDEX_RING].name,
+                                 &UA_TYPES[UA_TYPES_BOOLEAN]);
+    if(ringParam)
+        ring = *ringParam;
+    if(ring && xdp) {
+        UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                     "ETH\t| The packet ring cannot be combined with XDP");
+        UA_UNLOCK(&el->elMutex);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+#ifndef UA_ETH_XDP
+    if(xdp) {
+        UA_LOG_ERROR(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                     "ETH\t| XDP is not supported on the current system");
+        UA_UNLOCK(&el->elMutex);
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    }
+#endif
+
     /* Get the EtherType parameter */
     UA_UInt16 etherType = ETH_P_ALL;
     const UA_UInt16 *etParam =  (const UA_UInt16*)
@@ -687,7 +1622,7 @@ ETH_openConnection(UA_ConnectionManager *cm, const UA_KeyValueMap *params,
     /* Create the socket and add the basic configuration */
     ETH_FD *conn = NULL;
     UA_FD sockfd;
-    if(listen && *listen)
+    if(listen && *listen && !xdp && !ring)
         sockfd = socket(PF_PACKET, SOCK_RAW, htons(etherType));
     else
         sockfd = socket(PF_PACKET, SOCK_RAW, 0); /* Don't receive */
@@ -697,7 +1632,7 @@ ETH_openConnection(UA_ConnectionManager *cm, const UA_KeyValueMap *params,
         UA_UNLOCK(&el->elMutex);
         return UA_STATUSCODE_BADINTERNALERROR;
     }
-    res |= UA_EventLoopPOSIX_setReusable(sockfd);
+    /* No SO_REUSEPORT. Recent kernels reject it for packet sockets. */
     res |= UA_EventLoopPOSIX_setNonBlocking(sockfd);
     res |= UA_EventLoopPOSIX_setNoSigPipe(sockfd);
     if(res != UA_STATUSCODE_GOOD)
@@ -717,6 +1652,14 @@ ETH_openConnection(UA_ConnectionManager *cm, const UA_KeyValueMap *params,
     conn->application = application;
     conn->applicationCB = connectionCallback;
 
+    /* Map the rx or tx ring. Before binding the socket, so that no frames are
+     * queued outside of the ring. */
+    if(ring && !validate) {
+        res = ETH_setupRing(el, conn, params, (listen && *listen));
+        if(res != UA_STATUSCODE_GOOD)
+            goto cleanup;
+    }
+
     /* Configure a listen or a send connection */
     if(!listen || !*listen) {
         /* Get the source address for the interface */
@@ -736,13 +1679,24 @@ ETH_openConnection(UA_ConnectionManager *cm, const UA_KeyValueMap *params,
                                      (unsigned char*)ifr.ifr_hwaddr.sa_data,
                                      ifindex, etherType);
     } else {
-        res = ETH_openListenConnection(el, conn, params, ifindex, etherType, validate);
+        res = ETH_openListenConnection(el, conn, params, ifindex, etherType,
+                                       validate, xdp);
     }
 
     /* Don't actually open or shut down */
     if(validate || res != UA_STATUSCODE_GOOD)
         goto cleanup;
 
+#ifdef UA_ETH_XDP
+    /* Switch to the AF_XDP socket */
+    if(xdp) {
+        res = ETH_XDP_open(pcm, conn, params, ifindex, etherType,
+                           (listen && *listen));
+        if(res != UA_STATUSCODE_GOOD)
+            goto cleanup;
+    }
+#endif
+
     /* Register in the EventLoop */
     res = UA_EventLoopPOSIX_registerFD(el, &conn->rfd);
     if(res != UA_STATUSCODE_GOOD)
@@ -754,12 +1708,20 @@ ETH_openConnection(UA_ConnectionManager *cm, const UA_KeyValueMap *params,
 
     /* Register the listen socket in the application */
     UA_UNLOCK(&el->elMutex);
-    connectionCallback(cm, (uintptr_t)sockfd, application, &conn->context,
+    connectionCallback(cm, (uintptr_t)conn->rfd.fd, application, &conn->context,
                        UA_CONNECTIONSTATE_ESTABLISHED, &UA_KEYVALUEMAP_NULL,
                        UA_BYTESTRING_NULL);
     return UA_STATUSCODE_GOOD;
 
  cleanup:
+    if(conn && conn->ring)
+        munmap(conn->ring, conn->ringSize);
+#ifdef UA_ETH_XDP
+    if(conn && conn->xdp) {
+        UA_close(conn->rfd.fd);
+        ETH_XDP_release(conn); /* Closes sockfd */
+    } else
+#endif
     UA_close(sockfd);
     UA_free(conn);
     UA_UNLOCK(&el->elMutex);
@@ -772,7 +1734,7 @@ ETH_shutdown(UA_POSIXConnectionManager *pcm, ETH_FD *conn) {
     UA_LOCK_ASSERT(&((UA_EventLoopPOSIX*)pcm->cm.eventSource.eventLoop)->elMutex, 1);
 
     UA_DelayedCallback *dc = &conn->rfd.dc;
-    if(dc->callback) {
+    if(dc->callback == ETH_delayedClose) {
         UA_LOG_INFO(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
                     "ETH %u\t| Cannot close - already closing",
                     (unsigned)conn->rfd.fd);
@@ -785,9 +1747,14 @@ ETH_shutdown(UA_POSIXConnectionManager *pcm, ETH_FD *conn) {
     UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
                  "ETH %u\t| Shutdown called", (unsigned)conn->rfd.fd);
 
+    /* A pending notification for the tx ring is replaced. The delayed
+     * callback is already enqueued then. ETH_close flushes the tx ring. */
+    UA_Boolean enqueued = (dc->callback != NULL);
     dc->callback = ETH_delayedClose;
     dc->application = pcm;
     dc->context = conn;
+    if(enqueued)
+        return;
 
     /* Don't use the "public" el->addDelayedCallback. It takes a lock. */
     dc->next = el->delayedCallbacks;
@@ -897,17 +1864,18 @@ ETH_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
     ETH_FD *conn = (ETH_FD*)ZIP_FIND(UA_FDTree, &pcm->fds, &fd);
     if(!conn) {
         UA_UNLOCK(&el->elMutex);
-        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+        ETH_freeNetworkBuffer(cm, connectionId, buf);
         return UA_STATUSCODE_BADCONNECTIONREJECTED;
     }
 
-    /* Uncover and set the Ethernet header */
-    buf->data -= conn->headerSize;
-    buf->length += conn->headerSize;
-    memcpy(buf->data, conn->header, conn->headerSize);
+    /* Set the Ethernet header in the reserved space in front of the payload.
+     * The buffer itself is not modified and can be kept by the caller. */
+    UA_Byte *frame = buf->data - conn->headerSize;
+    size_t frameLength = buf->length + conn->headerSize;
+    memcpy(frame, conn->header, conn->headerSize);
     if(conn->lengthOffset) {
-        UA_UInt16 *ethLength =  (UA_UInt16*)&buf->data[conn->lengthOffset];
-        *ethLength = htons((UA_UInt16)(buf->length - conn->headerSize));
+        UA_UInt16 *ethLength =  (UA_UInt16*)&frame[conn->lengthOffset];
+        *ethLength = htons((UA_UInt16)buf->length);
     }
 
     /* Was a txtime configured? */
@@ -919,10 +1887,34 @@ ETH_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                      "ETH %u\t| txtime was not configured for the connection",
                      (unsigned)connectionId);
         UA_UNLOCK(&el->elMutex);
-        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+        ETH_freeNetworkBuffer(cm, connectionId, buf);
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
+    /* Write the frame into the tx ring */
+    if(conn->ring) {
+        UA_StatusCode res = ETH_sendRing(pcm, conn, frame, frameLength);
+        UA_UNLOCK(&el->elMutex);
+        if(res != UA_STATUSCODE_GOOD ||
+           !UA_EventLoopPOSIX_keepNetworkBuffer(cm, params))
+            ETH_freeNetworkBuffer(cm, connectionId, buf);
+        return res;
+    }
+
+#ifdef UA_ETH_XDP
+    /* Enqueue the frame in the tx ring of the AF_XDP socket */
+    if(conn->xdp) {
+        UA_StatusCode res = ETH_XDP_send(el, conn, frame, frameLength);
+        if(res == UA_STATUSCODE_BADCONNECTIONCLOSED)
+            ETH_shutdown(pcm, conn);
+        UA_UNLOCK(&el->elMutex);
+        if(res != UA_STATUSCODE_GOOD ||
+           !UA_EventLoopPOSIX_keepNetworkBuffer(cm, params))
+            ETH_freeNetworkBuffer(cm, connectionId, buf);
+        return res;
+    }
+#endif
+
     /* Prevent OS signals when sending to a closed socket */
     int flags = MSG_NOSIGNAL;
 
@@ -937,16 +1929,16 @@ ETH_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
         do {
             UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
                          "ETH %u\t| Attempting to send", (unsigned)connectionId);
-            size_t bytes_to_send = buf->length - nWritten;
+            size_t bytes_to_send = frameLength - nWritten;
 #ifdef SO_TXTIME
             if(txtime) {
                 n = send_txtime(el, conn, params, *txtime,
-                                (const char*)buf->data + nWritten, bytes_to_send);
+                                (const char*)frame + nWritten, bytes_to_send);
             } else
 #endif
             {
                 n = UA_sendto(conn->rfd.fd,
-                              (const char*)buf->data + nWritten, bytes_to_send,
+                              (const char*)frame + nWritten, bytes_to_send,
                               flags, (struct sockaddr*)&conn->sll, sizeof(conn->sll));
             }
             if(n < 0) {
@@ -960,7 +1952,7 @@ ETH_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                                     (unsigned)connectionId, errno_str));
                     ETH_shutdown(pcm, conn);
                     UA_UNLOCK(&el->elMutex);
-                    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+                    ETH_freeNetworkBuffer(cm, connectionId, buf);
                     return UA_STATUSCODE_BADCONNECTIONCLOSED;
                 }
 
@@ -976,18 +1968,20 @@ ETH_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                                         (unsigned)connectionId, errno_str));
                         ETH_shutdown(pcm, conn);
                         UA_UNLOCK(&el->elMutex);
-                        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+                        ETH_freeNetworkBuffer(cm, connectionId, buf);
                         return UA_STATUSCODE_BADCONNECTIONCLOSED;
                     }
                 } while(poll_ret <= 0);
             }
         } while(n < 0);
         nWritten += (size_t)n;
-    } while(nWritten < buf->length);
+    } while(nWritten < frameLength);
 
-    /* Free the buffer */
+    /* Free the buffer unless the caller keeps it for the next send. Errors
+     * above always free the buffer. */
     UA_UNLOCK(&el->elMutex);
-    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+    if(!UA_EventLoopPOSIX_keepNetworkBuffer(cm, params))
+        ETH_freeNetworkBuffer(cm, connectionId, buf);
     return UA_STATUSCODE_GOOD;
 }
 
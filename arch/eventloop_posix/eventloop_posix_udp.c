@@ -917,9 +917,11 @@ UDP_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
         nWritten += (size_t)n;
     } while(nWritten < buf->length);
 
-    /* Free the buffer */
+    /* Free the buffer unless the caller keeps it for the next send. Errors
+     * above always free the buffer. */
     UA_UNLOCK(&el->elMutex);
-    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+    if(!UA_EventLoopPOSIX_keepNetworkBuffer(cm, params))
+        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -725,6 +725,8 @@ addWriterGroup(UA_Server *server) {
     writerGroupConfig.encodingMimeType                     = UA_PUBSUB_ENCODING_UADP;
     writerGroupConfig.writerGroupId                        = WRITER_GROUP_ID;
     writerGroupConfig.rtLevel                              = UA_PUBSUB_RT_FIXED_SIZE;
+    /* The publish thread does not wait for the server lock */
+    writerGroupConfig.rtThread                             = UA_TRUE;
     writerGroupConfig.pubsubManagerCallback.addCustomCallback = addPubSubApplicationCallback;
     writerGroupConfig.pubsubManagerCallback.changeCustomCallback = changePubSubApplicationCallback;
     writerGroupConfig.pubsubManagerCallback.removeCustomCallback = removePubSubApplicationCallback;
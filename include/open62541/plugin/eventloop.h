@@ -347,7 +347,13 @@ struct UA_ConnectionManager {
      * sending fails).
      *
      * Some ConnectionManagers can accept additional parameters for sending. For
-     * example a tx-time for sending in time-synchronized TSN settings. */
+     * example a tx-time for sending in time-synchronized TSN settings.
+     *
+     * With the "keep-buffer" send parameter (where supported), the buffer is
+     * not released after successful sending and can be reused for the next
+     * message. If the buffer is released nevertheless (after an error or if
+     * the parameter is not supported), it is cleared and the data pointer is
+     * set to NULL. */
     UA_StatusCode
     (*sendWithConnection)(UA_ConnectionManager *cm, uintptr_t connectionId,
                           const UA_KeyValueMap *params, UA_ByteString *buf);
@@ -577,7 +583,9 @@ UA_ConnectionManager_new_POSIX_TCP(const UA_String eventSourceName);
  *
  * **Send Parameters:**
  *
- * No additional parameters for sending over an UDP connection defined. */
+ * 0:keep-buffer [bool]
+ *    Keep the buffer after successful sending for reuse (default: false).
+ *    Not possible if a static send buffer is configured with send-bufsize. */
 UA_EXPORT UA_ConnectionManager *
 UA_ConnectionManager_new_POSIX_UDP(const UA_String eventSourceName);
 
@@ -651,6 +659,53 @@ UA_ConnectionManager_new_POSIX_UDP(const UA_String eventSourceName);
  * 0:txtime-flags [uint32]
  *    txtime flags set for the socket (default: SOF_TXTIME_REPORT_ERRORS).
  *
+ * On Linux (5.9 and newer) frames can be sent and received with an AF_XDP
+ * socket instead. Received frames are handed to the application directly from
+ * the memory region shared with the kernel. Listen and send connections for
+ * the same interface queue share the AF_XDP socket. Only one listen connection
+ * is possible per queue and all listen connections on an interface must use
+ * the same EtherType. An XDP program is attached to the interface that
+ * redirects matching frames for the queue to the socket. All other frames pass
+ * to the network stack. Sending with a txtime is not possible with XDP.
+ *
+ * 0:xdp-enable [bool]
+ *    Use an AF_XDP socket for the connection (default: false).
+ *
+ * 0:xdp-queue [uint32]
+ *    Hardware queue of the interface that the socket is bound to
+ *    (default: 0).
+ *
+ * 0:xdp-flags [uint32]
+ *    Flags for attaching the XDP program, e.g. XDP_FLAGS_SKB_MODE or
+ *    XDP_FLAGS_DRV_MODE (default: native mode with fallback to the SKB mode).
+ *
+ * 0:xdp-bindflags [uint16]
+ *    Flags for binding the socket, XDP_COPY or XDP_ZEROCOPY (default:
+ *    zero-copy with fallback to copy mode).
+ *
+ * On Linux the packet socket can use memory-mapped TPACKET_V3 rings. Received
+ * frames are consumed in batches from the rx ring. Sent frames are written
+ * into the slots of the tx ring and handed to the kernel together at the end
+ * of the EventLoop iteration. Frames are delivered when a ring block is full
+ * or after the block timeout. Packet rings cannot be combined with XDP or
+ * sending with a txtime.
+ *
+ * 0:packet-ring [bool]
+ *    Use a memory-mapped packet ring for the connection (default: false).
+ *
+ * 0:packet-ring-size [uint32]
+ *    Size of the ring in bytes (default: 1MB).
+ *
+ * 0:packet-ring-timeout [uint32]
+ *    Timeout in milliseconds after which a partially filled block of the rx
+ *    ring is handed to the application (default: 1).
+ *
+ * **Send Parameters:**
+ *
+ * 0:keep-buffer [bool]
+ *    Keep the buffer after successful sending for reuse (default: false).
+ *    Not possible if a static send buffer is configured with send-bufsize.
+ *
  * **Send Parameters (only with txtime enabled for the connection)**
  *
  * 0:txtime [datetime]
@@ -700,12 +755,24 @@ UA_ConnectionManager_new_POSIX_Ethernet(const UA_String eventSourceName);
  *    (default: false)
  *
  * 0:topic [string]
- *    Topic to which the connection is associated (required).
+ *    Topic to which the connection is associated (required). Subscriptions can
+ *    use the wildcards "+" (single level) and "#" (multiple levels).
  *
  * 0:subscribe [bool]
  *    Subscribe to the topic (default: false). Otherwise it is only possible to
  *    publish on the topic. Subscribed topics can also be published to.
  *
+ * 0:qos [byte]
+ *    MQTT QoS level 0-2 for publishing and subscribing (default: 0).
+ *
+ * 0:max-inflight [uint16]
+ *    Publishing with QoS 1/2 drops the message and returns
+ *    BadResourceUnavailable while that many messages to the broker are not yet
+ *    acknowledged (default: 16). The connection remains open.
+ *
+ * Messages sent during an EventLoop iteration are sent out together at the
+ * end of the iteration with a single send on the TCP connection.
+ *
  * **Connection Callback Parameters:**
  *
  * 0:topic [string]
@@ -141,7 +141,10 @@ typedef struct {
     /* The algorithm used to sign and verify certificates. */
     UA_SecurityPolicySignatureAlgorithm signatureAlgorithm;
 
-    /* The algorithm used to encrypt and decrypt messages. */
+    /* The algorithm used to encrypt and decrypt messages. For the asymmetric
+     * module, encrypt and decrypt are NULL if the policy does not encrypt with
+     * the certificate keys (ECC). Then the OpenSecureChannel messages are only
+     * signed. */
     UA_SecurityPolicyEncryptionAlgorithm encryptionAlgorithm;
 
 } UA_SecurityPolicyCryptoModule;
@@ -203,6 +206,54 @@ typedef struct {
     size_t secureChannelNonceLength;
 
     UA_SecurityPolicyCryptoModule cryptoModule;
+
+    /* Optional fused sign-and-encrypt of an outgoing symmetric chunk (for
+     * SignAndEncrypt mode). If NULL, the sign and encrypt methods of the
+     * cryptoModule are called one after the other.
+     *
+     * The signature is computed over chunk[0, signatureOffset) and written
+     * to chunk[signatureOffset, signatureOffset + signatureSize). Then
+     * chunk[encryptOffset, chunk->length) is encrypted in place, including
+     * the signature. Implementations can interleave both operations to make
+     * a single pass over the data.
+     *
+     * @param channelContext the channel context with the local keys.
+     * @param chunk the complete chunk including headers, padding and space
+     *              for the signature.
+     * @param encryptOffset the start of the encrypted part of the chunk.
+     * @param signatureOffset the position of the signature in the chunk. */
+    UA_StatusCode (*signAndEncrypt)(void *channelContext, UA_ByteString *chunk,
+                                    size_t encryptOffset, size_t signatureOffset)
+    UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
+    /* Optional nonce generation for the SecureChannel that has access to the
+     * channel context. This is used by the ECC policies where the nonces are
+     * ephemeral public keys (Part 6, 6.8.1). The private part of the fresh
+     * ephemeral key pair remains in the channel context. If NULL,
+     * generateNonce is used.
+     *
+     * @param channelContext the channel context to store the private key in.
+     * @param out pointer to a buffer of length secureChannelNonceLength. */
+    UA_StatusCode (*generateChannelNonce)(void *channelContext, UA_ByteString *out)
+    UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
+    /* Optional key derivation for the SecureChannel that has access to the
+     * channel context. The ECC policies derive the key material from the
+     * shared secret between the local ephemeral private key and the remote
+     * nonce. If NULL, generateKey is used.
+     *
+     * @param channelContext the channel context with the local ephemeral key.
+     * @param clientNonce the nonce sent by the client.
+     * @param serverNonce the nonce sent by the server.
+     * @param clientKeys derive the keys that secure the messages sent by the
+     *                   client. Otherwise for the messages sent by the server.
+     * @param out an output to write the data to. The length defines the maximum
+     *            number of output bytes that are produced. */
+    UA_StatusCode (*generateChannelKey)(void *channelContext,
+                                        const UA_ByteString *clientNonce,
+                                        const UA_ByteString *serverNonce,
+                                        UA_Boolean clientKeys, UA_ByteString *out)
+    UA_FUNC_ATTR_WARN_UNUSED_RESULT;
 } UA_SecurityPolicySymmetricModule;
 
 typedef struct {
@@ -370,6 +421,27 @@ struct UA_PubSubSecurityPolicy {
                        const UA_ByteString *nonce)
     UA_FUNC_ATTR_WARN_UNUSED_RESULT;
 
+    /* Optional authenticated encryption (AEAD) of a NetworkMessage in a
+     * single pass. If set, they replace the separate encrypt and sign (resp.
+     * verify and decrypt) steps. The MessageNonce is set before. For such
+     * policies the WriterGroup generates a twelve-byte MessageNonce:
+     * SenderId(4) | WriterGroupId(2) | Counter(6). It does not repeat under
+     * the same key.
+     *
+     * message[0, encryptOffset) is only authenticated (the headers).
+     * message[encryptOffset, signatureOffset) is en-/decrypted in place. The
+     * authentication tag is at message[signatureOffset, message->length).
+     * Without encryption (Sign mode) encryptOffset equals signatureOffset. */
+    UA_StatusCode
+    (*encryptAndSign)(void *wgContext, UA_ByteString *message,
+                      size_t encryptOffset, size_t signatureOffset)
+    UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
+    UA_StatusCode
+    (*verifyAndDecrypt)(void *wgContext, UA_ByteString *message,
+                        size_t encryptOffset, size_t signatureOffset)
+    UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
     const UA_Logger *logger;
 
     /* Deletes the dynamic content of the policy */
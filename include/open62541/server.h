@@ -267,6 +267,9 @@ struct UA_ServerConfig {
     size_t maxAsyncOperationQueueSize; /* 0 => unlimited */
     /* Notify workers when an async operation was enqueued */
     UA_Server_AsyncOperationNotifyCallback asyncOperationNotifyCallback;
+    /* Offload the asymmetric cryptography of the OpenSecureChannel handshake
+     * to the workers. See UA_Server_runAsyncCryptoJob. */
+    UA_Boolean asyncSecureChannelCrypto;
 #endif
 
     /**
@@ -1988,6 +1991,23 @@ UA_Server_setAsyncOperationResult(UA_Server *server,
                                   const UA_AsyncOperationResponse *response,
                                   void *context);
 
+/* With the asyncSecureChannelCrypto config option, the private-key operations
+ * of the OpenSecureChannel handshake for new SecureChannels (decryption and
+ * verification of the request, signing and encryption of the response) are
+ * done by the workers. This keeps the server responsive when many clients
+ * connect at once. The workers are notified via the
+ * asyncOperationNotifyCallback. The processing of the SecureChannel continues
+ * in the server thread once the job is done. Renewals of open SecureChannels
+ * are always processed in the server thread.
+ *
+ * The crypto library used by the SecurityPolicies must be safe to use from
+ * several threads (e.g. OpenSSL, or mbedTLS with MBEDTLS_THREADING_C).
+ *
+ * @param server The server object
+ * @return false if no job was pending, true if a job was run */
+UA_Boolean UA_EXPORT
+UA_Server_runAsyncCryptoJob(UA_Server *server);
+
 #endif /* !UA_MULTITHREADING >= 100 */
 
 /**
@@ -356,6 +356,86 @@ UA_Server_getPublishedDataSetMetaData(UA_Server *server, const UA_NodeId pdsId,
 UA_StatusCode UA_EXPORT UA_THREADSAFE
 UA_Server_removePublishedDataSet(UA_Server *server, const UA_NodeId pdsId);
 
+/**
+ * Value Buffers
+ * -------------
+ * The RT levels access the values of the application directly via the
+ * ``UA_DataValue**`` pointers of external value backends. There is no
+ * synchronization between the application and the PubSub cycle. So a value can
+ * be read by the publisher (or written by the subscriber) while the
+ * application modifies it.
+ *
+ * The value buffer exchanges fixed-size values between a single producer and a
+ * single consumer without locking. The producer writes into a private slot and
+ * commits it. The consumer takes the latest committed slot and copies it into
+ * the ``value`` snapshot. Neither side ever waits for the other. Values
+ * committed between two syncs of the consumer are overwritten. Only the
+ * latest value is seen.
+ *
+ * - For DataSetWriters the application is the producer and the publisher is
+ *   the consumer. Set ``rtValueSource.valueBuffer`` in the DataSetField
+ *   configuration. The snapshot is taken before every publish cycle.
+ * - For DataSetReaders the subscriber is the producer and the application is
+ *   the consumer. Set ``valueBuffer`` in the ``UA_FieldTargetVariable``. The
+ *   application takes the snapshot with ``UA_PubSubValueBuffer_read``.
+ *
+ * An information model node with an external value backend can point to
+ * ``&vb->valuePtr`` to show the snapshot of the consumer. This is only valid
+ * if the consumer takes the snapshot with the server lock held, as the Read
+ * service reads the snapshot under the server lock. That is the case for
+ * WriterGroups that publish from the server event loop and for applications
+ * that call ``UA_PubSubValueBuffer_read`` from server callbacks. It is not
+ * the case for WriterGroups with the ``rtThread`` option, where the snapshot
+ * is taken without the server lock. Do not point nodes at the snapshot of
+ * such WriterGroups, the value and its timestamps can be torn. Use a separate
+ * node that the application updates instead. The value buffer must not be
+ * moved in memory after the initialization.
+ *
+ * The slots are exchanged with atomic operations only if the library is built
+ * with ``UA_MULTITHREADING >= 100``. Otherwise the exchange is a plain swap.
+ * Then the producer and the consumer must run in the same thread (e.g. both
+ * from callbacks of the server event loop). */
+
+typedef struct {
+    UA_DataValue value;     /* Snapshot of the consumer */
+    UA_DataValue *valuePtr; /* Points to the snapshot for UA_DataValue** APIs */
+
+    /* Internal. The three slots rotate between the producer (back), the
+     * consumer (front) and the exchange in between (middle). The middle
+     * pointer is tagged if it contains a value that was not yet taken. */
+    UA_DataValue slots[3];
+    UA_DataValue *back;
+    UA_DataValue *front;
+    void * volatile middle;
+} UA_PubSubValueBuffer;
+
+/* Initialize the slots and the snapshot with deep copies of the initial value.
+ * Only scalars of fixed-size (pointer-free) types are supported. */
+UA_StatusCode UA_EXPORT
+UA_PubSubValueBuffer_init(UA_PubSubValueBuffer *vb, const UA_DataValue *initial);
+
+void UA_EXPORT
+UA_PubSubValueBuffer_clear(UA_PubSubValueBuffer *vb);
+
+/* Producer side. Returns the private slot of the producer. Its content is
+ * outdated. The data, status and timestamps have to be written completely
+ * before the commit. The type must not be changed. */
+UA_DataValue UA_EXPORT *
+UA_PubSubValueBuffer_beginWrite(UA_PubSubValueBuffer *vb);
+
+/* Producer side. Publish the slot from _beginWrite to the consumer */
+void UA_EXPORT
+UA_PubSubValueBuffer_commit(UA_PubSubValueBuffer *vb);
+
+/* Consumer side. Copy the latest committed value into the snapshot. Returns
+ * true if a new value was taken. */
+UA_Boolean UA_EXPORT
+UA_PubSubValueBuffer_sync(UA_PubSubValueBuffer *vb);
+
+/* Consumer side. Sync and return the snapshot */
+const UA_DataValue UA_EXPORT *
+UA_PubSubValueBuffer_read(UA_PubSubValueBuffer *vb);
+
 /**
  * DataSetFields
  * -------------
@@ -379,6 +459,10 @@ typedef struct{
         UA_Boolean rtInformationModelNode;
         //TODO -> decide if suppress C++ warnings and use 'UA_DataValue * * const staticValueSource;'
         UA_DataValue ** staticValueSource;
+        /* If the valueBuffer is set, the publisher takes a consistent snapshot
+         * of the value buffer in every cycle. Without rtInformationModelNode,
+         * the staticValueSource is set to the snapshot of the buffer. */
+        UA_PubSubValueBuffer *valueBuffer;
     } rtValueSource;
     UA_UInt32 maxStringLength;
 
@@ -444,6 +528,56 @@ typedef struct {
 
 } UA_PubSub_CallbackLifecycle;
 
+/**
+ * Timing Statistics
+ * -----------------
+ * WriterGroups and ReaderGroups record timing statistics if the
+ * ``timingStatistics`` option is set in their configuration. This allows to
+ * validate the timing of RT deployments without external tooling. The
+ * statistics are also shown in the information model as the
+ * ``TimingStatistics`` object of the group.
+ *
+ * Durations are taken from the monotonic clock of the EventLoop and recorded
+ * in histograms with logarithmic buckets. The first bucket counts durations
+ * below one microsecond. Every following bucket doubles the upper limit. The
+ * last bucket counts all remaining durations. Groups that are processed
+ * without the server lock (see the ``rtThread`` option) update the statistics
+ * concurrently. So a read of the statistics is not necessarily consistent. */
+
+#define UA_PUBSUB_HISTOGRAM_BUCKETS 24
+
+typedef struct {
+    UA_UInt64 count;
+    UA_DateTime min;
+    UA_DateTime max;
+    UA_DateTime sum; /* To compute the mean */
+    UA_UInt64 buckets[UA_PUBSUB_HISTOGRAM_BUCKETS];
+} UA_PubSubHistogram;
+
+/* Upper limit of the histogram bucket (exclusive). Returns UA_INT64_MAX for
+ * the last bucket. */
+UA_EXPORT UA_DateTime
+UA_PubSubHistogram_bucketLimit(size_t bucket);
+
+typedef struct {
+    /* Deviation of the publish callback start from the scheduled time. Early
+     * and late starts are both recorded as positive durations. */
+    UA_PubSubHistogram publishJitter;
+    UA_PubSubHistogram encodeDuration;  /* Encoding or patching the message */
+    UA_PubSubHistogram encryptDuration; /* Signing and encryption */
+    UA_PubSubHistogram sendDuration;    /* Handover to the ConnectionManager */
+} UA_WriterGroupTimingStatistics;
+
+typedef struct {
+    /* From the reception of a NetworkMessage until the values are written to
+     * the target variables of the DataSetReaders */
+    UA_PubSubHistogram receiveLatency;
+    UA_UInt64 receivedDataSetMessages;
+    /* Missing DataSetMessages detected from gaps in the sequence numbers.
+     * Requires the DataSetMessage SequenceNumber in the content mask. */
+    UA_UInt64 lostDataSetMessages;
+} UA_ReaderGroupTimingStatistics;
+
 /**
  * WriterGroup
  * -----------
@@ -513,6 +647,17 @@ typedef struct {
     UA_UInt16 maxEncapsulatedDataSetMessageCount;
     /* non std. field */
     UA_PubSubRTLevel rtLevel;
+    /* non std. field. Publish a frozen UA_PUBSUB_RT_FIXED_SIZE WriterGroup
+     * without taking the server lock. Run the publish callback in a dedicated
+     * (real-time) thread, either with the pubsubManagerCallback or with the
+     * EventLoop of the PubSubConnection (see UA_PubSubConnectionConfig). Then
+     * publishing is not delayed by the server. The value sources must not
+     * call the server API. Information model nodes must not point to the
+     * snapshots of its value buffers (see above). Encrypted WriterGroups always
+     * take the lock. */
+    UA_Boolean rtThread;
+    /* non std. field. Record the timing statistics (see above) */
+    UA_Boolean timingStatistics;
 
     /* Message are encrypted if a SecurityPolicy is configured and the
      * securityMode set accordingly. The symmetric key is a runtime information
@@ -553,6 +698,15 @@ UA_EXPORT UA_StatusCode UA_THREADSAFE
 UA_WriterGroup_lastPublishTimestamp(UA_Server *server, const UA_NodeId wgId,
                                     UA_DateTime *timestamp);
 
+/* Returns UA_STATUSCODE_BADNOTSUPPORTED if the timingStatistics option is not
+ * set for the WriterGroup */
+UA_EXPORT UA_StatusCode UA_THREADSAFE
+UA_Server_getWriterGroupTimingStatistics(UA_Server *server, const UA_NodeId wgId,
+                                         UA_WriterGroupTimingStatistics *stats);
+
+UA_EXPORT UA_StatusCode UA_THREADSAFE
+UA_Server_resetWriterGroupTimingStatistics(UA_Server *server, const UA_NodeId wgId);
+
 UA_EXPORT UA_StatusCode UA_THREADSAFE
 UA_Server_removeWriterGroup(UA_Server *server, const UA_NodeId wgId);
 
@@ -672,6 +826,10 @@ typedef struct {
      * If the afterWrite method pointer is set, it will be called after a memcpy update
      * to the value. */
     UA_DataValue **externalDataValue;
+    /* If the valueBuffer is set, the received value is committed to the value
+     * buffer instead of the memcpy to externalDataValue. The application reads
+     * consistent snapshots from the buffer. */
+    UA_PubSubValueBuffer *valueBuffer;
     void *targetVariableContext; /* user-defined pointer */
     void (*beforeWrite)(UA_Server *server,
                         const UA_NodeId *readerIdentifier,
@@ -816,6 +974,15 @@ typedef struct {
 
     /* non std. field */
     UA_PubSubRTLevel rtLevel;
+    /* non std. field. Process received messages without taking the server
+     * lock. Only used if all ReaderGroups of the PubSubConnection are frozen
+     * UA_PUBSUB_RT_FIXED_SIZE ReaderGroups with this option and all their
+     * DataSetReaders are operational without a MessageReceiveTimeout. Run the
+     * EventLoop of the PubSubConnection in a dedicated (real-time) thread. The
+     * target variable callbacks must not call the server API. */
+    UA_Boolean rtThread;
+    /* non std. field. Record the timing statistics (see above) */
+    UA_Boolean timingStatistics;
     UA_KeyValueMap groupProperties;
     UA_PubSubEncodingType encodingMimeType;
     UA_ExtensionObject transportSettings;
@@ -858,6 +1025,15 @@ UA_EXPORT UA_StatusCode UA_THREADSAFE
 UA_Server_ReaderGroup_getState(UA_Server *server, const UA_NodeId rgId,
                                UA_PubSubState *state);
 
+/* Returns UA_STATUSCODE_BADNOTSUPPORTED if the timingStatistics option is not
+ * set for the ReaderGroup */
+UA_EXPORT UA_StatusCode UA_THREADSAFE
+UA_Server_getReaderGroupTimingStatistics(UA_Server *server, const UA_NodeId rgId,
+                                         UA_ReaderGroupTimingStatistics *stats);
+
+UA_EXPORT UA_StatusCode UA_THREADSAFE
+UA_Server_resetReaderGroupTimingStatistics(UA_Server *server, const UA_NodeId rgId);
+
 UA_EXPORT UA_StatusCode UA_THREADSAFE
 UA_Server_addReaderGroup(UA_Server *server, const UA_NodeId connectionId,
                          const UA_ReaderGroupConfig *readerGroupConfig,
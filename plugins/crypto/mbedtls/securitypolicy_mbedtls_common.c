@@ -38,6 +38,9 @@ mbedtls_hmac(mbedtls_md_context_t *context, const UA_ByteString *key,
     return UA_STATUSCODE_GOOD;
 }
 
+/* P_HASH (RFC 5246, Section 5). HMAC_HASH(secret, A(n) + seed) is computed
+ * incrementally, so A(n) + seed does not need to be concatenated. All
+ * intermediate values are on the stack. */
 UA_StatusCode
 mbedtls_generateKey(mbedtls_md_context_t *context,
                     const UA_ByteString *secret, const UA_ByteString *seed,
@@ -48,76 +51,46 @@ mbedtls_generateKey(mbedtls_md_context_t *context,
     size_t hashLen = (size_t)mbedtls_md_get_size(context->private_md_info);
 #endif
 
-    UA_ByteString A_and_seed;
-    UA_ByteString_allocBuffer(&A_and_seed, hashLen + seed->length);
-    memcpy(A_and_seed.data + hashLen, seed->data, seed->length);
+    unsigned char A[MBEDTLS_MD_MAX_SIZE];
+    unsigned char lastBlock[MBEDTLS_MD_MAX_SIZE];
+    UA_ByteString ABuf = {hashLen, A};
+    UA_ByteString lastBuf = {sizeof(lastBlock), lastBlock};
 
-    UA_ByteString ANext_and_seed;
-    UA_ByteString_allocBuffer(&ANext_and_seed, hashLen + seed->length);
-    memcpy(ANext_and_seed.data + hashLen, seed->data, seed->length);
-
-    UA_ByteString A = {
-        hashLen,
-        A_and_seed.data
-    };
-
-    UA_ByteString ANext = {
-        hashLen,
-        ANext_and_seed.data
-    };
-
-    UA_StatusCode retval = mbedtls_hmac(context, secret, seed, A.data);
-
-    if(retval != UA_STATUSCODE_GOOD){
-        UA_ByteString_clear(&A_and_seed);
-        UA_ByteString_clear(&ANext_and_seed);
-        return retval;
-    }
+    /* A(1) = HMAC_HASH(secret, seed) */
+    UA_StatusCode retval = mbedtls_hmac(context, secret, seed, A);
+    if(retval != UA_STATUSCODE_GOOD)
+        goto cleanup;
 
     for(size_t offset = 0; offset < out->length; offset += hashLen) {
-        UA_ByteString outSegment = {
-            hashLen,
-            out->data + offset
-        };
-        UA_Boolean bufferAllocated = UA_FALSE;
-        // Not enough room in out buffer to write the hash.
-        if(offset + hashLen > out->length) {
-            outSegment.data = NULL;
-            outSegment.length = 0;
-            retval = UA_ByteString_allocBuffer(&outSegment, hashLen);
-            if(retval != UA_STATUSCODE_GOOD) {
-                UA_ByteString_clear(&A_and_seed);
-                UA_ByteString_clear(&ANext_and_seed);
-                return retval;
-            }
-            bufferAllocated = UA_TRUE;
+        /* Not enough room in out buffer to write the hash */
+        unsigned char *target = out->data + offset;
+        if(offset + hashLen > out->length)
+            target = lastBlock;
+
+        if(mbedtls_md_hmac_starts(context, secret->data, secret->length) != 0 ||
+           mbedtls_md_hmac_update(context, A, hashLen) != 0 ||
+           mbedtls_md_hmac_update(context, seed->data, seed->length) != 0 ||
+           mbedtls_md_hmac_finish(context, target) != 0) {
+            retval = UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+            goto cleanup;
         }
 
-        retval = mbedtls_hmac(context, secret, &A_and_seed, outSegment.data);
-        if(retval != UA_STATUSCODE_GOOD){
-            UA_ByteString_clear(&A_and_seed);
-            UA_ByteString_clear(&ANext_and_seed);
-            return retval;
-        }
-        retval = mbedtls_hmac(context, secret, &A, ANext.data);
-        if(retval != UA_STATUSCODE_GOOD){
-            UA_ByteString_clear(&A_and_seed);
-            UA_ByteString_clear(&ANext_and_seed);
-            return retval;
+        if(target == lastBlock) {
+            memcpy(out->data + offset, lastBlock, out->length - offset);
+            break;
         }
 
-        if(bufferAllocated) {
-            memcpy(out->data + offset, outSegment.data, out->length - offset);
-            UA_ByteString_clear(&outSegment);
-        }
-
-        swapBuffers(&ANext_and_seed, &A_and_seed);
-        swapBuffers(&ANext, &A);
+        /* A(n+1) = HMAC_HASH(secret, A(n)). The input is fully consumed
+         * before the output is written. */
+        retval = mbedtls_hmac(context, secret, &ABuf, A);
+        if(retval != UA_STATUSCODE_GOOD)
+            goto cleanup;
     }
 
-    UA_ByteString_clear(&A_and_seed);
-    UA_ByteString_clear(&ANext_and_seed);
-    return UA_STATUSCODE_GOOD;
+ cleanup:
+    UA_ByteString_memZero(&ABuf);
+    UA_ByteString_memZero(&lastBuf);
+    return retval;
 }
 
 UA_StatusCode
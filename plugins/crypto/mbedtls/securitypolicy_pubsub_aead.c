@@ -0,0 +1,500 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/securitypolicy_default.h>
+#include <open62541/util.h>
+#include "securitypolicy_mbedtls_common.h"
+
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/gcm.h>
+#include <mbedtls/version.h>
+
+#ifdef MBEDTLS_CHACHAPOLY_C
+#include <mbedtls/chachapoly.h>
+#endif
+
+/* Authenticated encryption (AEAD) for PubSub. The NetworkMessage headers are
+ * the additional authenticated data, the payload is encrypted in place and the
+ * authentication tag takes the place of the signature. So the message is
+ * processed in a single pass.
+ *
+ * The key material from the SKS has no signing key. It consists of the
+ * encrypting key followed by a four-byte KeyNonce. The twelve-byte
+ * MessageNonce is SenderId(4) | WriterGroupId(2) | Counter(6) and must never
+ * repeat for the same key. The 12-byte IV is (KeyNonce XOR SenderId) |
+ * WriterGroupId | Counter. So it is unique whenever the MessageNonce is. */
+
+#define UA_AEAD_TAG_LENGTH 16
+#define UA_AEAD_KEYNONCE_LENGTH 4
+#define UA_AEAD_MESSAGENONCE_LENGTH 12
+#define UA_AEAD_IV_LENGTH 12
+#define UA_AEAD_MAX_KEY_LENGTH 32
+
+typedef enum {
+    UA_AEADCIPHER_AES_GCM,
+    UA_AEADCIPHER_CHACHA20_POLY1305
+} UA_AeadCipher;
+
+typedef struct {
+    const UA_PubSubSecurityPolicy *securityPolicy;
+    UA_AeadCipher cipher;
+    size_t keyLength;
+    mbedtls_ctr_drbg_context drbgContext;
+    mbedtls_entropy_context entropyContext;
+} PUBSUB_AEAD_PolicyContext;
+
+/* The cipher context is keyed once in setSecurityKeys and reused for every
+ * message */
+typedef struct {
+    PUBSUB_AEAD_PolicyContext *policyContext;
+    UA_Boolean keySet;
+    UA_Byte keyNonce[UA_AEAD_KEYNONCE_LENGTH];
+    UA_Byte iv[UA_AEAD_IV_LENGTH];
+    mbedtls_gcm_context gcm;
+#ifdef MBEDTLS_CHACHAPOLY_C
+    mbedtls_chachapoly_context chachapoly;
+#endif
+} PUBSUB_AEAD_ChannelContext;
+
+/*******************/
+/* SymmetricModule */
+/*******************/
+
+static UA_StatusCode
+aead_encryptAndSign(PUBSUB_AEAD_ChannelContext *cc, UA_ByteString *message,
+                    size_t encryptOffset, size_t signatureOffset) {
+    if(cc == NULL || message == NULL || !cc->keySet ||
+       encryptOffset > signatureOffset ||
+       signatureOffset + UA_AEAD_TAG_LENGTH != message->length)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    UA_Byte *data = &message->data[encryptOffset];
+    size_t dataLength = signatureOffset - encryptOffset;
+    UA_Byte *tag = &message->data[signatureOffset];
+
+    int mbedErr;
+    if(cc->policyContext->cipher == UA_AEADCIPHER_AES_GCM) {
+        mbedErr = mbedtls_gcm_crypt_and_tag(&cc->gcm, MBEDTLS_GCM_ENCRYPT, dataLength,
+                                            cc->iv, UA_AEAD_IV_LENGTH,
+                                            message->data, encryptOffset,
+                                            data, data, UA_AEAD_TAG_LENGTH, tag);
+    } else {
+#ifdef MBEDTLS_CHACHAPOLY_C
+        mbedErr = mbedtls_chachapoly_encrypt_and_tag(&cc->chachapoly, dataLength, cc->iv,
+                                                     message->data, encryptOffset,
+                                                     data, data, tag);
+#else
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+#endif
+    }
+    if(mbedErr)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+aead_verifyAndDecrypt(PUBSUB_AEAD_ChannelContext *cc, UA_ByteString *message,
+                      size_t encryptOffset, size_t signatureOffset) {
+    if(cc == NULL || message == NULL || !cc->keySet)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    if(encryptOffset > signatureOffset ||
+       signatureOffset + UA_AEAD_TAG_LENGTH != message->length)
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+
+    UA_Byte *data = &message->data[encryptOffset];
+    size_t dataLength = signatureOffset - encryptOffset;
+    const UA_Byte *tag = &message->data[signatureOffset];
+
+    int mbedErr;
+    if(cc->policyContext->cipher == UA_AEADCIPHER_AES_GCM) {
+        mbedErr = mbedtls_gcm_auth_decrypt(&cc->gcm, dataLength,
+                                           cc->iv, UA_AEAD_IV_LENGTH,
+                                           message->data, encryptOffset,
+                                           tag, UA_AEAD_TAG_LENGTH, data, data);
+    } else {
+#ifdef MBEDTLS_CHACHAPOLY_C
+        mbedErr = mbedtls_chachapoly_auth_decrypt(&cc->chachapoly, dataLength, cc->iv,
+                                                  message->data, encryptOffset,
+                                                  tag, data, data);
+#else
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+#endif
+    }
+
+    /* The decrypted plaintext is only valid if the tag matches */
+    if(mbedErr)
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The separate signature is the tag over the message without encrypted
+ * content (GMAC resp. Poly1305). This equals aead_encryptAndSign in the Sign
+ * mode. */
+static UA_StatusCode
+sign_sp_pubsub_aead(PUBSUB_AEAD_ChannelContext *cc,
+                    const UA_ByteString *message, UA_ByteString *signature) {
+    if(cc == NULL || message == NULL || signature == NULL ||
+       signature->length != UA_AEAD_TAG_LENGTH || !cc->keySet)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    int mbedErr;
+    if(cc->policyContext->cipher == UA_AEADCIPHER_AES_GCM) {
+        mbedErr = mbedtls_gcm_crypt_and_tag(&cc->gcm, MBEDTLS_GCM_ENCRYPT, 0,
+                                            cc->iv, UA_AEAD_IV_LENGTH,
+                                            message->data, message->length,
+                                            NULL, NULL, UA_AEAD_TAG_LENGTH,
+                                            signature->data);
+    } else {
+#ifdef MBEDTLS_CHACHAPOLY_C
+        mbedErr = mbedtls_chachapoly_encrypt_and_tag(&cc->chachapoly, 0, cc->iv,
+                                                     message->data, message->length,
+                                                     NULL, NULL, signature->data);
+#else
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+#endif
+    }
+    if(mbedErr)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+verify_sp_pubsub_aead(PUBSUB_AEAD_ChannelContext *cc,
+                      const UA_ByteString *message, const UA_ByteString *signature) {
+    if(cc == NULL || message == NULL || signature == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    if(signature->length != UA_AEAD_TAG_LENGTH)
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+
+    UA_Byte tag[UA_AEAD_TAG_LENGTH];
+    UA_ByteString tagBuf = {UA_AEAD_TAG_LENGTH, tag};
+    UA_StatusCode res = sign_sp_pubsub_aead(cc, message, &tagBuf);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    if(!UA_constantTimeEqual(signature->data, tag, UA_AEAD_TAG_LENGTH))
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The payload cannot be encrypted without computing the tag. Use the
+ * encryptAndSign / verifyAndDecrypt methods of the policy instead. */
+static UA_StatusCode
+encrypt_sp_pubsub_aead(PUBSUB_AEAD_ChannelContext *cc, UA_ByteString *data) {
+    return UA_STATUSCODE_BADNOTSUPPORTED;
+}
+
+static size_t
+getSignatureSize_sp_pubsub_aead(const void *channelContext) {
+    return UA_AEAD_TAG_LENGTH;
+}
+
+/* No separate signing key */
+static size_t
+getSigningKeyLength_sp_pubsub_aead(const void *channelContext) {
+    return 0;
+}
+
+static size_t
+getAes128KeyLength_sp_pubsub_aead(const void *channelContext) {
+    return 16;
+}
+
+static size_t
+getAes256KeyLength_sp_pubsub_aead(const void *channelContext) {
+    return 32;
+}
+
+/* Stream ciphers, no padding */
+static size_t
+getBlockSize_sp_pubsub_aead(const void *channelContext) {
+    return 1;
+}
+
+static UA_StatusCode
+generateKey_sp_pubsub_aead(void *policyContext, const UA_ByteString *secret,
+                           const UA_ByteString *seed, UA_ByteString *out) {
+    return UA_STATUSCODE_BADNOTIMPLEMENTED;
+}
+
+static UA_StatusCode
+generateNonce_sp_pubsub_aead(void *policyContext, UA_ByteString *out) {
+    if(policyContext == NULL || out == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    PUBSUB_AEAD_PolicyContext *pc = (PUBSUB_AEAD_PolicyContext *)policyContext;
+    int mbedErr = mbedtls_ctr_drbg_random(&pc->drbgContext, out->data, out->length);
+    if(mbedErr)
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+/*****************/
+/* ChannelModule */
+/*****************/
+
+static void
+channelContext_deleteContext_sp_pubsub_aead(PUBSUB_AEAD_ChannelContext *cc) {
+    mbedtls_gcm_free(&cc->gcm);
+#ifdef MBEDTLS_CHACHAPOLY_C
+    mbedtls_chachapoly_free(&cc->chachapoly);
+#endif
+    UA_free(cc);
+}
+
+static UA_StatusCode
+channelContext_setKeys_sp_pubsub_aead(PUBSUB_AEAD_ChannelContext *cc,
+                                      const UA_ByteString *signingKey,
+                                      const UA_ByteString *encryptingKey,
+                                      const UA_ByteString *keyNonce) {
+    if(!cc)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    PUBSUB_AEAD_PolicyContext *pc = cc->policyContext;
+    if((signingKey && signingKey->length != 0) ||
+       !encryptingKey || encryptingKey->length != pc->keyLength ||
+       !keyNonce || keyNonce->length != UA_AEAD_KEYNONCE_LENGTH)
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+
+    int mbedErr;
+    if(pc->cipher == UA_AEADCIPHER_AES_GCM) {
+        mbedErr = mbedtls_gcm_setkey(&cc->gcm, MBEDTLS_CIPHER_ID_AES, encryptingKey->data,
+                                     (unsigned int)(encryptingKey->length * 8));
+    } else {
+#ifdef MBEDTLS_CHACHAPOLY_C
+        mbedErr = mbedtls_chachapoly_setkey(&cc->chachapoly, encryptingKey->data);
+#else
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+#endif
+    }
+    if(mbedErr)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    memcpy(cc->keyNonce, keyNonce->data, UA_AEAD_KEYNONCE_LENGTH);
+    cc->keySet = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+channelContext_newContext_sp_pubsub_aead(void *policyContext,
+                                         const UA_ByteString *signingKey,
+                                         const UA_ByteString *encryptingKey,
+                                         const UA_ByteString *keyNonce,
+                                         void **wgContext) {
+    PUBSUB_AEAD_PolicyContext *pc = (PUBSUB_AEAD_PolicyContext *)policyContext;
+    if((signingKey && signingKey->length != 0) ||
+       (encryptingKey && encryptingKey->length != pc->keyLength) ||
+       (keyNonce && keyNonce->length != UA_AEAD_KEYNONCE_LENGTH))
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+
+    /* Allocate the channel context */
+    PUBSUB_AEAD_ChannelContext *cc = (PUBSUB_AEAD_ChannelContext *)
+        UA_calloc(1, sizeof(PUBSUB_AEAD_ChannelContext));
+    if(cc == NULL)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* Initialize the channel context */
+    cc->policyContext = pc;
+    mbedtls_gcm_init(&cc->gcm);
+#ifdef MBEDTLS_CHACHAPOLY_C
+    mbedtls_chachapoly_init(&cc->chachapoly);
+#endif
+
+    if(encryptingKey && keyNonce) {
+        UA_StatusCode res =
+            channelContext_setKeys_sp_pubsub_aead(cc, signingKey, encryptingKey, keyNonce);
+        if(res != UA_STATUSCODE_GOOD) {
+            channelContext_deleteContext_sp_pubsub_aead(cc);
+            return res;
+        }
+    }
+
+    *wgContext = cc;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+channelContext_setMessageNonce_sp_pubsub_aead(PUBSUB_AEAD_ChannelContext *cc,
+                                              const UA_ByteString *nonce) {
+    if(nonce->length != UA_AEAD_MESSAGENONCE_LENGTH)
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+    for(size_t i = 0; i < UA_AEAD_KEYNONCE_LENGTH; i++)
+        cc->iv[i] = cc->keyNonce[i] ^ nonce->data[i];
+    memcpy(&cc->iv[UA_AEAD_KEYNONCE_LENGTH], &nonce->data[UA_AEAD_KEYNONCE_LENGTH],
+           UA_AEAD_IV_LENGTH - UA_AEAD_KEYNONCE_LENGTH);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+deleteMembers_sp_pubsub_aead(UA_PubSubSecurityPolicy *securityPolicy) {
+    if(securityPolicy == NULL)
+        return;
+
+    if(securityPolicy->policyContext == NULL)
+        return;
+
+    /* delete all allocated members in the context */
+    PUBSUB_AEAD_PolicyContext *pc =
+        (PUBSUB_AEAD_PolicyContext *)securityPolicy->policyContext;
+
+    mbedtls_ctr_drbg_free(&pc->drbgContext);
+    mbedtls_entropy_free(&pc->entropyContext);
+    UA_LOG_DEBUG(securityPolicy->logger, UA_LOGCATEGORY_SECURITYPOLICY,
+                 "Deleted members of EndpointContext for sp_PUBSUB_AEAD");
+    UA_free(pc);
+    securityPolicy->policyContext = NULL;
+}
+
+static UA_StatusCode
+policyContext_newContext_sp_pubsub_aead(UA_PubSubSecurityPolicy *securityPolicy,
+                                        UA_AeadCipher cipher, size_t keyLength) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if(securityPolicy == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    PUBSUB_AEAD_PolicyContext *pc = (PUBSUB_AEAD_PolicyContext *)
+        UA_calloc(1, sizeof(PUBSUB_AEAD_PolicyContext));
+    securityPolicy->policyContext = (void *)pc;
+    if(!pc) {
+        retval = UA_STATUSCODE_BADOUTOFMEMORY;
+        goto error;
+    }
+
+    /* Initialize the PolicyContext */
+    mbedtls_ctr_drbg_init(&pc->drbgContext);
+    mbedtls_entropy_init(&pc->entropyContext);
+    pc->securityPolicy = securityPolicy;
+    pc->cipher = cipher;
+    pc->keyLength = keyLength;
+
+    /* Seed the RNG */
+    char *personalization = "open62541-drbg";
+    int mbedErr = mbedtls_ctr_drbg_seed(&pc->drbgContext, mbedtls_entropy_func,
+                                        &pc->entropyContext,
+                                        (const unsigned char *)personalization, 14);
+    if(mbedErr) {
+        retval = UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+        goto error;
+    }
+
+    return retval;
+
+error:
+    UA_LOG_ERROR(securityPolicy->logger, UA_LOGCATEGORY_SECURITYPOLICY,
+                 "Could not create securityContext");
+    if(securityPolicy->policyContext != NULL)
+        deleteMembers_sp_pubsub_aead(securityPolicy);
+    return retval;
+}
+
+static UA_StatusCode
+UA_PubSubSecurityPolicy_Aead(UA_PubSubSecurityPolicy *policy, const UA_Logger *logger,
+                             UA_AeadCipher cipher, size_t keyLength) {
+    memset(policy, 0, sizeof(UA_PubSubSecurityPolicy));
+    policy->logger = logger;
+
+    UA_SecurityPolicySymmetricModule *symmetricModule = &policy->symmetricModule;
+
+    /* SymmetricModule */
+    symmetricModule->generateKey = generateKey_sp_pubsub_aead;
+    symmetricModule->generateNonce = generateNonce_sp_pubsub_aead;
+
+    UA_SecurityPolicySignatureAlgorithm *signatureAlgorithm =
+        &symmetricModule->cryptoModule.signatureAlgorithm;
+    signatureAlgorithm->verify =
+        (UA_StatusCode(*)(void *, const UA_ByteString *,
+                          const UA_ByteString *))verify_sp_pubsub_aead;
+    signatureAlgorithm->sign =
+        (UA_StatusCode(*)(void *, const UA_ByteString *, UA_ByteString *))sign_sp_pubsub_aead;
+    signatureAlgorithm->getLocalSignatureSize = getSignatureSize_sp_pubsub_aead;
+    signatureAlgorithm->getRemoteSignatureSize = getSignatureSize_sp_pubsub_aead;
+    signatureAlgorithm->getLocalKeyLength = getSigningKeyLength_sp_pubsub_aead;
+    signatureAlgorithm->getRemoteKeyLength = getSigningKeyLength_sp_pubsub_aead;
+
+    UA_SecurityPolicyEncryptionAlgorithm *encryptionAlgorithm =
+        &symmetricModule->cryptoModule.encryptionAlgorithm;
+    encryptionAlgorithm->encrypt =
+        (UA_StatusCode(*)(void *, UA_ByteString *))encrypt_sp_pubsub_aead;
+    encryptionAlgorithm->decrypt =
+        (UA_StatusCode(*)(void *, UA_ByteString *))encrypt_sp_pubsub_aead;
+    encryptionAlgorithm->getLocalKeyLength = (keyLength == 16) ?
+        getAes128KeyLength_sp_pubsub_aead : getAes256KeyLength_sp_pubsub_aead;
+    encryptionAlgorithm->getRemoteKeyLength = encryptionAlgorithm->getLocalKeyLength;
+    encryptionAlgorithm->getRemoteBlockSize = getBlockSize_sp_pubsub_aead;
+    encryptionAlgorithm->getRemotePlainTextBlockSize = getBlockSize_sp_pubsub_aead;
+    symmetricModule->secureChannelNonceLength = keyLength + UA_AEAD_KEYNONCE_LENGTH;
+
+    /* ChannelModule */
+    policy->newContext = channelContext_newContext_sp_pubsub_aead;
+    policy->deleteContext = (void (*)(void *))
+        channelContext_deleteContext_sp_pubsub_aead;
+
+    policy->setSecurityKeys = (UA_StatusCode(*)(void *, const UA_ByteString *,
+                                                const UA_ByteString *,
+                                                const UA_ByteString *))
+            channelContext_setKeys_sp_pubsub_aead;
+    policy->setMessageNonce = (UA_StatusCode(*)(void *, const UA_ByteString *))
+        channelContext_setMessageNonce_sp_pubsub_aead;
+    policy->encryptAndSign = (UA_StatusCode(*)(void *, UA_ByteString *, size_t, size_t))
+        aead_encryptAndSign;
+    policy->verifyAndDecrypt = (UA_StatusCode(*)(void *, UA_ByteString *, size_t, size_t))
+        aead_verifyAndDecrypt;
+    policy->clear = deleteMembers_sp_pubsub_aead;
+    policy->policyContext = NULL;
+
+    /* Initialize the policyContext */
+    return policyContext_newContext_sp_pubsub_aead(policy, cipher, keyLength);
+}
+
+UA_StatusCode
+UA_PubSubSecurityPolicy_Aes128Gcm(UA_PubSubSecurityPolicy *policy,
+                                  const UA_Logger *logger) {
+    UA_StatusCode res =
+        UA_PubSubSecurityPolicy_Aead(policy, logger, UA_AEADCIPHER_AES_GCM, 16);
+    policy->policyUri =
+        UA_STRING("http://open62541.org/UA/SecurityPolicy#PubSub-Aes128-GCM");
+    policy->symmetricModule.cryptoModule.signatureAlgorithm.uri =
+        UA_STRING("http://www.w3.org/2010/xmlsec11#aes128-gcm");
+    policy->symmetricModule.cryptoModule.encryptionAlgorithm.uri =
+        UA_STRING("http://www.w3.org/2010/xmlsec11#aes128-gcm");
+    return res;
+}
+
+UA_StatusCode
+UA_PubSubSecurityPolicy_Aes256Gcm(UA_PubSubSecurityPolicy *policy,
+                                  const UA_Logger *logger) {
+    UA_StatusCode res =
+        UA_PubSubSecurityPolicy_Aead(policy, logger, UA_AEADCIPHER_AES_GCM, 32);
+    policy->policyUri =
+        UA_STRING("http://open62541.org/UA/SecurityPolicy#PubSub-Aes256-GCM");
+    policy->symmetricModule.cryptoModule.signatureAlgorithm.uri =
+        UA_STRING("http://www.w3.org/2010/xmlsec11#aes256-gcm");
+    policy->symmetricModule.cryptoModule.encryptionAlgorithm.uri =
+        UA_STRING("http://www.w3.org/2010/xmlsec11#aes256-gcm");
+    return res;
+}
+
+UA_StatusCode
+UA_PubSubSecurityPolicy_ChaCha20Poly1305(UA_PubSubSecurityPolicy *policy,
+                                         const UA_Logger *logger) {
+#ifdef MBEDTLS_CHACHAPOLY_C
+    UA_StatusCode res =
+        UA_PubSubSecurityPolicy_Aead(policy, logger, UA_AEADCIPHER_CHACHA20_POLY1305, 32);
+    policy->policyUri =
+        UA_STRING("http://open62541.org/UA/SecurityPolicy#PubSub-ChaCha20-Poly1305");
+    policy->symmetricModule.cryptoModule.signatureAlgorithm.uri =
+        UA_STRING("https://tools.ietf.org/html/rfc8439");
+    policy->symmetricModule.cryptoModule.encryptionAlgorithm.uri =
+        UA_STRING("https://tools.ietf.org/html/rfc8439");
+    return res;
+#else
+    UA_LOG_ERROR(logger, UA_LOGCATEGORY_SECURITYPOLICY,
+                 "ChaCha20-Poly1305 is not enabled in mbedTLS (MBEDTLS_CHACHAPOLY_C)");
+    return UA_STATUSCODE_BADNOTSUPPORTED;
+#endif
+}
+
+#endif
@@ -88,6 +88,19 @@ static UA_ByteString copyDataFormatAware(const UA_ByteString *data)
     return result;
 }
 
+/* Number of cached verification results per certificate group */
+#define UA_CERTIFICATE_VERIFY_CACHE_SIZE 64
+
+/* Default maximum age of a cached verification result (ms). The cache is
+ * disabled by default. */
+#define UA_CERTIFICATE_VERIFY_CACHE_MAXAGE 0.0
+
+typedef struct {
+    UA_Byte thumbprint[UA_SHA1_LENGTH];
+    UA_UInt32 generation;
+    UA_DateTime expiry; /* Wall-clock time, zero for unused entries */
+} CertVerifyCacheEntry;
+
 typedef struct {
     /* If the folders are defined, we use them to reload the certificates during
      * runtime */
@@ -99,12 +112,152 @@ typedef struct {
     mbedtls_x509_crt certificateTrustList;
     mbedtls_x509_crt certificateIssuerList;
     mbedtls_x509_crl certificateRevocationList;
+
+    /* Change detection for the folders. The parsed lists are only reloaded
+     * when the stamp of a folder differs from the last load. The folders are
+     * checked at most once per reloadCheckInterval. */
+    UA_UInt32 trustListStamp;
+    UA_UInt32 issuerListStamp;
+    UA_UInt32 revocationListStamp;
+    UA_Boolean folderLoaded;
+    UA_DateTime reloadCheckInterval;
+    UA_DateTime lastReloadCheck;
+
+    /* Cache of verification results. The generation is incremented whenever
+     * the trust, issuer or revocation list is reloaded. Cached entries from
+     * an older generation are ignored. */
+    UA_UInt32 generation;
+    UA_DateTime crlNextUpdate; /* Earliest next_update of the CRLs */
+    UA_DateTime cacheMaxAge;
+    size_t cacheNext;
+    CertVerifyCacheEntry cache[UA_CERTIFICATE_VERIFY_CACHE_SIZE];
 } CertInfo;
 
+static UA_DateTime
+mbedtlsTimeToDateTime(const mbedtls_x509_time *t) {
+    if(t->year == 0)
+        return 0;
+    UA_DateTimeStruct ts;
+    memset(&ts, 0, sizeof(UA_DateTimeStruct));
+    ts.year = (UA_Int16)t->year;
+    ts.month = (UA_UInt16)t->mon;
+    ts.day = (UA_UInt16)t->day;
+    ts.hour = (UA_UInt16)t->hour;
+    ts.min = (UA_UInt16)t->min;
+    ts.sec = (UA_UInt16)t->sec;
+    return UA_DateTime_fromStruct(ts);
+}
+
+/* The trust store has changed. Invalidate the cached verification results and
+ * update the earliest time at which a CRL needs to be refreshed. */
+static void
+newGeneration(CertInfo *ci) {
+    ci->generation++;
+    ci->crlNextUpdate = 0;
+    for(mbedtls_x509_crl *crl = &ci->certificateRevocationList;
+        crl != NULL; crl = crl->next) {
+        if(crl->version == 0)
+            continue;
+        UA_DateTime nextUpdate = mbedtlsTimeToDateTime(&crl->next_update);
+        if(nextUpdate != 0 &&
+           (ci->crlNextUpdate == 0 || nextUpdate < ci->crlNextUpdate))
+            ci->crlNextUpdate = nextUpdate;
+    }
+}
+
+static const CertVerifyCacheEntry *
+cacheLookup(const CertInfo *ci, const UA_Byte *thumbprint) {
+    UA_DateTime now = UA_DateTime_now();
+    for(size_t i = 0; i < UA_CERTIFICATE_VERIFY_CACHE_SIZE; i++) {
+        const CertVerifyCacheEntry *entry = &ci->cache[i];
+        if(entry->expiry > now && entry->generation == ci->generation &&
+           memcmp(entry->thumbprint, thumbprint, UA_SHA1_LENGTH) == 0)
+            return entry;
+    }
+    return NULL;
+}
+
+/* Cache a successful verification until the certificate or a CRL expires, or
+ * for at most cacheMaxAge. The oldest entry is replaced. Failed verifications
+ * are not cached. */
+static void
+cacheStore(CertInfo *ci, const UA_Byte *thumbprint, const mbedtls_x509_crt *cert) {
+    if(ci->cacheMaxAge <= 0)
+        return;
+    UA_DateTime now = UA_DateTime_now();
+    UA_DateTime expiry = now + ci->cacheMaxAge;
+    UA_DateTime validTo = mbedtlsTimeToDateTime(&cert->valid_to);
+    if(validTo != 0 && validTo < expiry)
+        expiry = validTo;
+    if(ci->crlNextUpdate != 0 && ci->crlNextUpdate < expiry)
+        expiry = ci->crlNextUpdate;
+    if(expiry <= now)
+        return;
+
+    CertVerifyCacheEntry *entry = &ci->cache[ci->cacheNext];
+    ci->cacheNext = (ci->cacheNext + 1) % UA_CERTIFICATE_VERIFY_CACHE_SIZE;
+    memcpy(entry->thumbprint, thumbprint, UA_SHA1_LENGTH);
+    entry->generation = ci->generation;
+    entry->expiry = expiry;
+}
+
 #ifdef __linux__ /* Linux only so far */
 
 #include <dirent.h>
 #include <limits.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+/* Compute a stamp from the names and the metadata of the regular files in the
+ * folder. The stamp changes when files are added, removed, renamed or
+ * rewritten. This is much cheaper than reading and parsing the files. */
+static UA_UInt32
+folderStamp(const UA_String *folder) {
+    char buf[PATH_MAX + 1];
+    if(folder->length > PATH_MAX)
+        return 0;
+    memcpy(buf, folder->data, folder->length);
+    buf[folder->length] = 0;
+
+    DIR *dir = opendir(buf);
+    if(!dir)
+        return 0;
+
+    UA_UInt32 stamp = 0;
+    UA_UInt32 files = 0;
+    struct dirent *ent;
+    struct stat st;
+    char path[PATH_MAX + 1];
+    while((ent = readdir(dir)) != NULL) {
+        /* Not all filesystems fill in d_type. Then stat decides. */
+        if(ent->d_type != DT_REG && ent->d_type != DT_UNKNOWN)
+            continue;
+        int len = snprintf(path, sizeof(path), "%s/%s", buf, ent->d_name);
+        if(len < 0 || (size_t)len >= sizeof(path) || stat(path, &st) != 0 ||
+           !S_ISREG(st.st_mode))
+            continue;
+        /* Combine with xor, readdir does not guarantee an order */
+        UA_UInt32 h = UA_ByteString_hash(0, (const UA_Byte*)path, (size_t)len);
+        h = UA_ByteString_hash(h, (const UA_Byte*)&st.st_ino, sizeof(st.st_ino));
+        h = UA_ByteString_hash(h, (const UA_Byte*)&st.st_size, sizeof(st.st_size));
+        h = UA_ByteString_hash(h, (const UA_Byte*)&st.st_mtim, sizeof(st.st_mtim));
+        stamp ^= h;
+        files++;
+    }
+    closedir(dir);
+
+    /* Distinguish an empty folder from a folder that was never loaded */
+    return stamp + files + 1;
+}
+
+/* Returns true if the folder has changed since the last successful load. The
+ * new stamp is returned, but only stored once the folder has been loaded. */
+static UA_Boolean
+folderChanged(const CertInfo *ci, const UA_String *folder,
+              UA_UInt32 stamp, UA_UInt32 *newStamp) {
+    *newStamp = folderStamp(folder);
+    return (!ci->folderLoaded || *newStamp != stamp);
+}
 
 static UA_StatusCode
 fileNamesFromFolder(const UA_String *folder, size_t *pathsSize, UA_String **paths) {
@@ -135,11 +288,15 @@ fileNamesFromFolder(const UA_String *folder, size_t *pathsSize, UA_String **path
     size_t pathlen = strlen(buf2);
     *pathsSize = 0;
     while((ent = readdir (dir)) != NULL && *pathsSize < 256) {
-        if(ent->d_type != DT_REG)
+        if(ent->d_type != DT_REG && ent->d_type != DT_UNKNOWN)
             continue;
         buf2[pathlen] = '/';
         buf2[pathlen+1] = 0;
         strcat(buf2, ent->d_name);
+        struct stat st;
+        if(ent->d_type == DT_UNKNOWN &&
+           (stat(buf2, &st) != 0 || !S_ISREG(st.st_mode)))
+            continue;
         (*paths)[*pathsSize] = UA_STRING_ALLOC(buf2);
         *pathsSize += 1;
     }
@@ -152,126 +309,146 @@ fileNamesFromFolder(const UA_String *folder, size_t *pathsSize, UA_String **path
     return UA_STATUSCODE_GOOD;
 }
 
+/* Parse the certificates of a folder into a new list. The current list is only
+ * replaced if all certificates could be parsed. So a failed reload leaves the
+ * previous list in place. */
 static UA_StatusCode
-reloadCertificates(const UA_CertificateGroup *certGroup, CertInfo *ci) {
-    UA_StatusCode retval = UA_STATUSCODE_GOOD;
-    int err = 0;
-    int internalErrorFlag = 0;
+reloadCrtFolder(const UA_CertificateGroup *certGroup, CertInfo *ci,
+                const UA_String *folder, UA_UInt32 *stamp,
+                mbedtls_x509_crt *list) {
+    UA_UInt32 newStamp;
+    if(!folderChanged(ci, folder, *stamp, &newStamp))
+        return UA_STATUSCODE_GOOD;
+
+    char f[PATH_MAX];
+    if(folder->length >= PATH_MAX)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    memcpy(f, folder->data, folder->length);
+    f[folder->length] = 0;
+    UA_LOG_INFO(certGroup->logging, UA_LOGCATEGORY_SERVER,
+                "Reloading the certificates from %s", f);
+
+    mbedtls_x509_crt newList;
+    mbedtls_x509_crt_init(&newList);
+    int err = mbedtls_x509_crt_parse_path(&newList, f);
+    if(err != 0) {
+        char errBuff[300];
+        mbedtls_strerror(err, errBuff, 300);
+        UA_LOG_INFO(certGroup->logging, UA_LOGCATEGORY_SERVER,
+                    "Failed to load certificate from %s, mbedTLS error: %s (error code: %d)",
+                    f, errBuff, err);
+        mbedtls_x509_crt_free(&newList);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
 
-    /* Load the trustlists */
-    if(ci->trustListFolder.length > 0) {
-        UA_LOG_INFO(certGroup->logging, UA_LOGCATEGORY_SERVER, "Reloading the trust-list");
-        mbedtls_x509_crt_free(&ci->certificateTrustList);
-        mbedtls_x509_crt_init(&ci->certificateTrustList);
+    /* The list head is a plain struct pointing to heap memory */
+    mbedtls_x509_crt_free(list);
+    *list = newList;
+    *stamp = newStamp;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Same as reloadCrtFolder for the revocation lists */
+static UA_StatusCode
+reloadCrlFolder(const UA_CertificateGroup *certGroup, CertInfo *ci) {
+    UA_UInt32 newStamp;
+    if(!folderChanged(ci, &ci->revocationListFolder,
+                      ci->revocationListStamp, &newStamp))
+        return UA_STATUSCODE_GOOD;
 
+    UA_LOG_INFO(certGroup->logging, UA_LOGCATEGORY_SERVER, "Reloading the revocation-list");
+    size_t pathsSize = 0;
+    UA_String *paths = NULL;
+    UA_StatusCode retval = fileNamesFromFolder(&ci->revocationListFolder, &pathsSize, &paths);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    mbedtls_x509_crl newList;
+    mbedtls_x509_crl_init(&newList);
+    for(size_t i = 0; i < pathsSize; i++) {
         char f[PATH_MAX];
-        memcpy(f, ci->trustListFolder.data, ci->trustListFolder.length);
-        f[ci->trustListFolder.length] = 0;
-        err = mbedtls_x509_crt_parse_path(&ci->certificateTrustList, f);
+        memcpy(f, paths[i].data, paths[i].length);
+        f[paths[i].length] = 0;
+        int err = mbedtls_x509_crl_parse_file(&newList, f);
         if(err == 0) {
             UA_LOG_INFO(certGroup->logging, UA_LOGCATEGORY_SERVER,
-                        "Loaded certificate from %s", f);
+                        "Loaded certificate from %.*s",
+                        (int)paths[i].length, paths[i].data);
         } else {
             char errBuff[300];
             mbedtls_strerror(err, errBuff, 300);
             UA_LOG_INFO(certGroup->logging, UA_LOGCATEGORY_SERVER,
-                        "Failed to load certificate from %s, mbedTLS error: %s (error code: %d)", f, errBuff, err);
-            internalErrorFlag = 1;
+                        "Failed to load certificate from %.*s, mbedTLS error: %s (error code: %d)",
+                        (int)paths[i].length, paths[i].data, errBuff, err);
+            retval = UA_STATUSCODE_BADINTERNALERROR;
+            break;
         }
     }
+    UA_Array_delete(paths, pathsSize, &UA_TYPES[UA_TYPES_STRING]);
 
-    /* Load the revocationlists */
-    if(ci->revocationListFolder.length > 0) {
-        UA_LOG_INFO(certGroup->logging, UA_LOGCATEGORY_SERVER, "Reloading the revocation-list");
-        size_t pathsSize = 0;
-        UA_String *paths = NULL;
-        retval = fileNamesFromFolder(&ci->revocationListFolder, &pathsSize, &paths);
-        if(retval != UA_STATUSCODE_GOOD)
-            return retval;
-        mbedtls_x509_crl_free(&ci->certificateRevocationList);
-        mbedtls_x509_crl_init(&ci->certificateRevocationList);
-        for(size_t i = 0; i < pathsSize; i++) {
-            char f[PATH_MAX];
-            memcpy(f, paths[i].data, paths[i].length);
-            f[paths[i].length] = 0;
-            err = mbedtls_x509_crl_parse_file(&ci->certificateRevocationList, f);
-            if(err == 0) {
-                UA_LOG_INFO(certGroup->logging, UA_LOGCATEGORY_SERVER,
-                            "Loaded certificate from %.*s",
-                            (int)paths[i].length, paths[i].data);
-            } else {
-                char errBuff[300];
-                mbedtls_strerror(err, errBuff, 300);
-                UA_LOG_INFO(certGroup->logging, UA_LOGCATEGORY_SERVER,
-                            "Failed to load certificate from %.*s, mbedTLS error: %s (error code: %d)",
-                            (int)paths[i].length, paths[i].data, errBuff, err);
-                internalErrorFlag = 1;
-            }
-        }
-        UA_Array_delete(paths, pathsSize, &UA_TYPES[UA_TYPES_STRING]);
-        paths = NULL;
-        pathsSize = 0;
+    if(retval != UA_STATUSCODE_GOOD) {
+        mbedtls_x509_crl_free(&newList);
+        return retval;
     }
 
-    /* Load the issuerlists */
-    if(ci->issuerListFolder.length > 0) {
-        UA_LOG_INFO(certGroup->logging, UA_LOGCATEGORY_SERVER, "Reloading the issuer-list");
-        mbedtls_x509_crt_free(&ci->certificateIssuerList);
-        mbedtls_x509_crt_init(&ci->certificateIssuerList);
-        char f[PATH_MAX];
-        memcpy(f, ci->issuerListFolder.data, ci->issuerListFolder.length);
-        f[ci->issuerListFolder.length] = 0;
-        err = mbedtls_x509_crt_parse_path(&ci->certificateIssuerList, f);
-        if(err == 0) {
-            UA_LOG_INFO(certGroup->logging, UA_LOGCATEGORY_SERVER,
-                        "Loaded certificate from %s", f);
-        } else {
-            char errBuff[300];
-            mbedtls_strerror(err, errBuff, 300);
-            UA_LOG_INFO(certGroup->logging, UA_LOGCATEGORY_SERVER,
-                        "Failed to load certificate from %s, mbedTLS error: %s (error code: %d)",
-                        f, errBuff, err);
-            internalErrorFlag = 1;
-        }
-    }
+    mbedtls_x509_crl_free(&ci->certificateRevocationList);
+    ci->certificateRevocationList = newList;
+    ci->revocationListStamp = newStamp;
+    return UA_STATUSCODE_GOOD;
+}
 
-    if(internalErrorFlag) {
+static UA_StatusCode
+reloadCertificates(const UA_CertificateGroup *certGroup, CertInfo *ci) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    UA_UInt32 trustListStamp = ci->trustListStamp;
+    UA_UInt32 issuerListStamp = ci->issuerListStamp;
+    UA_UInt32 revocationListStamp = ci->revocationListStamp;
+
+    if(ci->trustListFolder.length > 0)
+        retval |= reloadCrtFolder(certGroup, ci, &ci->trustListFolder,
+                                  &ci->trustListStamp, &ci->certificateTrustList);
+    if(ci->revocationListFolder.length > 0)
+        retval |= reloadCrlFolder(certGroup, ci);
+    if(ci->issuerListFolder.length > 0)
+        retval |= reloadCrtFolder(certGroup, ci, &ci->issuerListFolder,
+                                  &ci->issuerListStamp, &ci->certificateIssuerList);
+
+    if(!ci->folderLoaded ||
+       trustListStamp != ci->trustListStamp ||
+       issuerListStamp != ci->issuerListStamp ||
+       revocationListStamp != ci->revocationListStamp)
+        newGeneration(ci);
+
+    /* Retry with the next verification. The previous lists are kept until
+     * then. */
+    ci->folderLoaded = (retval == UA_STATUSCODE_GOOD);
+    if(retval != UA_STATUSCODE_GOOD)
         retval = UA_STATUSCODE_BADINTERNALERROR;
-    }
     return retval;
 }
 
-#endif
-
+/* Reload the folders if they have changed. The check is rate-limited by the
+ * configured reloadCheckInterval. */
 static UA_StatusCode
-certificateGroup_verify(UA_CertificateGroup *certGroup,
-                        const UA_ByteString *certificate) {
-    CertInfo *ci;
-    if(!certGroup)
-        return UA_STATUSCODE_BADINTERNALERROR;
-    ci = (CertInfo*)certGroup->context;
-    if(!ci)
-        return UA_STATUSCODE_BADINTERNALERROR;
-
-#ifdef __linux__ /* Reload certificates if folder paths are specified */
-    UA_StatusCode certFlag = reloadCertificates(certGroup, ci);
-    if(certFlag != UA_STATUSCODE_GOOD) {
-        return certFlag;
-    }
-#endif
-
+reloadCertificatesIfChanged(const UA_CertificateGroup *certGroup, CertInfo *ci) {
     if(ci->trustListFolder.length == 0 &&
        ci->issuerListFolder.length == 0 &&
-       ci->revocationListFolder.length == 0 &&
-       ci->rejectedListFolder.length == 0 &&
-       ci->certificateTrustList.raw.len == 0 &&
-       ci->certificateIssuerList.raw.len == 0 &&
-       ci->certificateRevocationList.raw.len == 0) {
-        UA_LOG_WARNING(certGroup->logging, UA_LOGCATEGORY_USERLAND,
-                       "No certificate store configured. Accepting the certificate.");
+       ci->revocationListFolder.length == 0)
         return UA_STATUSCODE_GOOD;
-    }
 
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    if(ci->folderLoaded && ci->reloadCheckInterval > 0 &&
+       now - ci->lastReloadCheck < ci->reloadCheckInterval)
+        return UA_STATUSCODE_GOOD;
+    ci->lastReloadCheck = now;
+    return reloadCertificates(certGroup, ci);
+}
+
+#endif
+
+static UA_StatusCode
+verifyCertificateChain(UA_CertificateGroup *certGroup, CertInfo *ci,
+                       const UA_ByteString *certificate) {
     /* Parse the certificate */
     mbedtls_x509_crt remoteCertificate;
 
@@ -515,6 +692,61 @@ certificateGroup_verify(UA_CertificateGroup *certGroup,
     return retval;
 }
 
+static UA_StatusCode
+certificateGroup_verify(UA_CertificateGroup *certGroup,
+                        const UA_ByteString *certificate) {
+    CertInfo *ci;
+    if(!certGroup)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    ci = (CertInfo*)certGroup->context;
+    if(!ci)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+#ifdef __linux__ /* Reload certificates if folder paths are specified */
+    UA_StatusCode certFlag = reloadCertificatesIfChanged(certGroup, ci);
+    if(certFlag != UA_STATUSCODE_GOOD) {
+        return certFlag;
+    }
+#endif
+
+    if(ci->trustListFolder.length == 0 &&
+       ci->issuerListFolder.length == 0 &&
+       ci->revocationListFolder.length == 0 &&
+       ci->rejectedListFolder.length == 0 &&
+       ci->certificateTrustList.raw.len == 0 &&
+       ci->certificateIssuerList.raw.len == 0 &&
+       ci->certificateRevocationList.raw.len == 0) {
+        UA_LOG_WARNING(certGroup->logging, UA_LOGCATEGORY_USERLAND,
+                       "No certificate store configured. Accepting the certificate.");
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Use the cached result if the certificate was verified before with the
+     * current trust store */
+    UA_Byte thumbprintData[UA_SHA1_LENGTH];
+    UA_ByteString thumbprint = {UA_SHA1_LENGTH, thumbprintData};
+    UA_StatusCode res = mbedtls_thumbprint_sha1(certificate, &thumbprint);
+    if(res != UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_BADCERTIFICATEINVALID;
+    if(cacheLookup(ci, thumbprintData)) {
+        UA_LOG_DEBUG(certGroup->logging, UA_LOGCATEGORY_SECURITYPOLICY,
+                     "Using the cached certificate verification result");
+        return UA_STATUSCODE_GOOD;
+    }
+
+    res = verifyCertificateChain(certGroup, ci, certificate);
+
+    /* Cache a successful verification */
+    if(res == UA_STATUSCODE_GOOD && ci->cacheMaxAge > 0) {
+        mbedtls_x509_crt cert;
+        mbedtls_x509_crt_init(&cert);
+        if(mbedtls_x509_crt_parse(&cert, certificate->data, certificate->length) == 0)
+            cacheStore(ci, thumbprintData, &cert);
+        mbedtls_x509_crt_free(&cert);
+    }
+    return res;
+}
+
 static void
 certificateGroup_clear(UA_CertificateGroup *certGroup) {
     CertInfo *ci = (CertInfo*)certGroup->context;
@@ -557,6 +789,7 @@ UA_CertificateVerification_Trustlist(UA_CertificateGroup *certGroup,
     mbedtls_x509_crt_init(&ci->certificateTrustList);
     mbedtls_x509_crl_init(&ci->certificateRevocationList);
     mbedtls_x509_crt_init(&ci->certificateIssuerList);
+    ci->cacheMaxAge = (UA_DateTime)(UA_CERTIFICATE_VERIFY_CACHE_MAXAGE * UA_DATETIME_MSEC);
 
     certGroup->context = (void*)ci;
     certGroup->verifyCertificate = certificateGroup_verify;
@@ -598,12 +831,28 @@ UA_CertificateVerification_Trustlist(UA_CertificateGroup *certGroup,
             goto error;
     }
 
+    newGeneration(ci);
     return UA_STATUSCODE_GOOD;
 error:
     certificateGroup_clear(certGroup);
     return UA_STATUSCODE_BADINTERNALERROR;
 }
 
+UA_StatusCode
+UA_CertificateVerification_setVerificationCacheMaxAge(UA_CertificateGroup *certGroup,
+                                                      UA_Double maxAge) {
+    if(!certGroup || !certGroup->context ||
+       certGroup->verifyCertificate != certificateGroup_verify)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    if(maxAge < 0.0)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    CertInfo *ci = (CertInfo*)certGroup->context;
+    ci->cacheMaxAge = (UA_DateTime)(maxAge * UA_DATETIME_MSEC);
+    /* Drop the cached results */
+    ci->generation++;
+    return UA_STATUSCODE_GOOD;
+}
+
 #ifdef __linux__ /* Linux only so far */
 
 #ifdef UA_ENABLE_CERT_REJECTED_DIR
@@ -638,9 +887,10 @@ UA_CertificateVerification_CertFolders(UA_CertificateGroup *certGroup,
     mbedtls_x509_crt_init(&ci->certificateTrustList);
     mbedtls_x509_crl_init(&ci->certificateRevocationList);
     mbedtls_x509_crt_init(&ci->certificateIssuerList);
+    ci->cacheMaxAge = (UA_DateTime)(UA_CERTIFICATE_VERIFY_CACHE_MAXAGE * UA_DATETIME_MSEC);
 
-    /* Only set the folder paths. They will be reloaded during runtime.
-     * TODO: Add a more efficient reloading of only the changes */
+    /* Only set the folder paths. They will be reloaded during runtime when
+     * their content changes. */
     ci->trustListFolder = UA_STRING_ALLOC(trustListFolder);
     ci->issuerListFolder = UA_STRING_ALLOC(issuerListFolder);
     ci->revocationListFolder = UA_STRING_ALLOC(revocationListFolder);
@@ -659,6 +909,19 @@ UA_CertificateVerification_CertFolders(UA_CertificateGroup *certGroup,
     return reloadCertificates(certGroup, ci);
 }
 
+UA_StatusCode
+UA_CertificateVerification_setFolderCheckInterval(UA_CertificateGroup *certGroup,
+                                                  UA_Double interval) {
+    if(!certGroup || !certGroup->context ||
+       certGroup->verifyCertificate != certificateGroup_verify)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    if(interval < 0.0)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    CertInfo *ci = (CertInfo*)certGroup->context;
+    ci->reloadCheckInterval = (UA_DateTime)(interval * UA_DATETIME_MSEC);
+    return UA_STATUSCODE_GOOD;
+}
+
 #endif
 
 
@@ -27,6 +27,12 @@ modification history
 #include <openssl/hmac.h>
 #include <openssl/aes.h>
 #include <openssl/pem.h>
+#include <openssl/crypto.h>
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/ecdsa.h>
+#include <openssl/kdf.h>
+#include <openssl/objects.h>
 
 #include "securitypolicy_openssl_common.h"
 #include "ua_openssl_version_abstraction.h"
@@ -38,31 +44,9 @@ modification history
 #define SHA256EVP() ((EVP_MD *)(uintptr_t)EVP_sha256())
 
 
-/** P_SHA256 Context */
-typedef struct UA_Openssl_P_SHA256_Ctx_ {
-    size_t  seedLen;
-    size_t  secretLen;
-    UA_Byte   A[32]; /* 32 bytes of SHA256 output */
-    /*
-    char seed[seedLen];
-    char secret[secretLen]; */
-} UA_Openssl_P_SHA256_Ctx;
-
-#define UA_Openssl_P_SHA256_SEED(ctx)   ((ctx)->A+32)
-#define UA_Openssl_P_SHA256_SECRET(ctx) ((ctx)->A+32+(ctx)->seedLen)
-
-/** P_SHA1 Context */
-typedef struct UA_Openssl_P_SHA1_Ctx_ {
-    size_t  seedLen;
-    size_t  secretLen;
-    UA_Byte A[SHA1_DIGEST_LENGTH];  /* 20 bytes of SHA1 output */
-    /*
-    char seed[seedLen];
-    char secret[secretLen]; */
-} UA_Openssl_P_SHA1_Ctx;
-
-#define UA_Openssl_P_SHA1_SEED(ctx)   ((ctx)->A + SHA1_DIGEST_LENGTH)
-#define UA_Openssl_P_SHA1_SECRET(ctx) ((ctx)->A + SHA1_DIGEST_LENGTH +(ctx)->seedLen)
+/* Scratch space on the stack for A(n)+seed in the P_SHA derivation. The
+ * seeds are the SecureChannel nonces (32 bytes for the current policies). */
+#define UA_OPENSSL_PHASH_STACKBUF 160
 
 void
 UA_Openssl_Init (void) {
@@ -451,83 +435,82 @@ UA_Openssl_RSA_OAEP_SHA2_Encrypt (UA_ByteString * data,
     return ret;
 }
 
-static UA_Openssl_P_SHA256_Ctx *
-P_SHA256_Ctx_Create (const UA_ByteString *  secret,
-                     const UA_ByteString *  seed) {
-    size_t size = (UA_Int32)sizeof (UA_Openssl_P_SHA256_Ctx) + secret->length +
-                    seed->length;
-    UA_Openssl_P_SHA256_Ctx * ctx = (UA_Openssl_P_SHA256_Ctx *) UA_malloc (size);
-    if (ctx == NULL) {
-        return NULL;
+/* P_HASH as defined in RFC 5246 (TLS 1.2), Section 5:
+ *   A(0) = seed
+ *   A(n) = HMAC_HASH(secret, A(n-1))
+ *   P_HASH(secret, seed) = HMAC_HASH(secret, A(1) + seed) +
+ *                          HMAC_HASH(secret, A(2) + seed) + ...
+ * The output is written directly into the key buffer. A(n)+seed lives in a
+ * stack buffer. The heap is only used for unusually long seeds. */
+static UA_StatusCode
+UA_Openssl_P_Hash_Derive (const EVP_MD *          md,
+                          const UA_ByteString *   secret,
+                          const UA_ByteString *   seed,
+                          UA_ByteString *         out) {
+    size_t hashLen = (size_t) EVP_MD_size (md);
+    UA_Byte stackBuf[UA_OPENSSL_PHASH_STACKBUF];
+    UA_Byte lastBlock[EVP_MAX_MD_SIZE];
+    UA_Byte * aSeed = stackBuf;
+    size_t aSeedLen = hashLen + seed->length;
+    if (aSeedLen > UA_OPENSSL_PHASH_STACKBUF) {
+        aSeed = (UA_Byte *) UA_malloc (aSeedLen);
+        if (aSeed == NULL) {
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
     }
-    ctx->secretLen = secret->length;
-    ctx->seedLen = seed->length;
-    (void) memcpy (UA_Openssl_P_SHA256_SEED(ctx), seed->data, seed->length);
-    (void) memcpy (UA_Openssl_P_SHA256_SECRET(ctx), secret->data, secret->length);
-    /* A(0) = seed
-       A(n) = HMAC_HASH(secret, A(n-1)) */
 
-    if (HMAC (EVP_sha256(), secret->data, (int) secret->length, seed->data,
-        seed->length, ctx->A, NULL) == NULL) {
-        UA_free (ctx);
-        return NULL;
+    /* A(1) */
+    UA_StatusCode st = UA_STATUSCODE_GOOD;
+    UA_ByteString scratch = {aSeedLen, aSeed};
+    UA_ByteString last = {sizeof (lastBlock), lastBlock};
+    memcpy (aSeed + hashLen, seed->data, seed->length);
+    if (HMAC (md, secret->data, (int) secret->length, seed->data,
+              seed->length, aSeed, NULL) == NULL) {
+        st = UA_STATUSCODE_BADINTERNALERROR;
+        goto cleanup;
     }
 
-    return ctx;
-}
+    for (size_t pos = 0; pos < out->length; pos += hashLen) {
+        /* The last block is truncated. Write it to a temporary buffer. */
+        UA_Byte * target = out->data + pos;
+        if (pos + hashLen > out->length) {
+            target = lastBlock;
+        }
 
-static UA_StatusCode
-P_SHA256_Hash_Generate (UA_Openssl_P_SHA256_Ctx * ctx,
-                        UA_Byte *                 pHas
-                        ) {
-    /* Calculate P_SHA256(n) = HMAC_SHA256(secret, A(n)+seed) */
-    if (HMAC (EVP_sha256(),UA_Openssl_P_SHA256_SECRET(ctx), (int) ctx->secretLen,
-        ctx->A, sizeof (ctx->A) + ctx->seedLen, pHas, NULL) == NULL) {
-            return UA_STATUSCODE_BADINTERNALERROR;
+        /* HMAC_HASH(secret, A(n) + seed) */
+        if (HMAC (md, secret->data, (int) secret->length, aSeed,
+                  aSeedLen, target, NULL) == NULL) {
+            st = UA_STATUSCODE_BADINTERNALERROR;
+            goto cleanup;
         }
 
-    /* Calculate A(n) = HMAC_SHA256(secret, A(n-1)) */
-   if (HMAC (EVP_sha256(),UA_Openssl_P_SHA256_SECRET(ctx), (int) ctx->secretLen,
-        ctx->A, sizeof (ctx->A), ctx->A, NULL) == NULL) {
-            return UA_STATUSCODE_BADINTERNALERROR;
+        if (target == lastBlock) {
+            memcpy (out->data + pos, lastBlock, out->length - pos);
+            break;
         }
-    return UA_STATUSCODE_GOOD;
+
+        /* A(n+1) = HMAC_HASH(secret, A(n)) */
+        if (HMAC (md, secret->data, (int) secret->length, aSeed,
+                  hashLen, aSeed, NULL) == NULL) {
+            st = UA_STATUSCODE_BADINTERNALERROR;
+            goto cleanup;
+        }
+    }
+
+ cleanup:
+    UA_ByteString_memZero (&scratch);
+    UA_ByteString_memZero (&last);
+    if (aSeed != stackBuf) {
+        UA_free (aSeed);
+    }
+    return st;
 }
 
 UA_StatusCode
 UA_Openssl_Random_Key_PSHA256_Derive (const UA_ByteString *     secret,
                                       const UA_ByteString *     seed,
                                       UA_ByteString *           out) {
-    size_t keyLen = out->length;
-    size_t iter   = keyLen/32 + ((keyLen%32)?1:0);
-    size_t bufferLen = iter * 32;
-    size_t i;
-    UA_StatusCode st;
-
-    UA_Byte * pBuffer = (UA_Byte *) UA_malloc (bufferLen);
-    if (pBuffer == NULL) {
-        return UA_STATUSCODE_BADOUTOFMEMORY;
-    }
-
-    UA_Openssl_P_SHA256_Ctx * ctx = P_SHA256_Ctx_Create (secret, seed);
-    if (ctx == NULL) {
-        UA_free (pBuffer);
-        return UA_STATUSCODE_BADOUTOFMEMORY;
-    }
-
-    for (i = 0; i < iter; i++) {
-        st = P_SHA256_Hash_Generate (ctx, pBuffer + (i * 32));
-        if (st != UA_STATUSCODE_GOOD) {
-            UA_free (pBuffer);
-            UA_free (ctx);
-            return st;
-        }
-    }
-
-    (void) memcpy (out->data, pBuffer, keyLen);
-    UA_free (pBuffer);
-    UA_free (ctx);
-    return UA_STATUSCODE_GOOD;
+    return UA_Openssl_P_Hash_Derive (EVP_sha256 (), secret, seed, out);
 }
 
 /* return the key bytes */
@@ -662,69 +645,73 @@ UA_OpenSSL_HMAC_SHA256_Sign (const UA_ByteString *     message,
     return UA_STATUSCODE_GOOD;
 }
 
+/* Reset the IV and en-/decrypt the data in place. The key was already set in
+ * the cipher context. Padding is done in the stack before calling encryption.
+ * So we disable the OpenSSL padding and require a multiple of the block
+ * size. */
 static UA_StatusCode
-UA_OpenSSL_Decrypt (const UA_ByteString * iv,
-                    const UA_ByteString * key,
-                    const EVP_CIPHER *    cipherAlg,
-                    UA_ByteString *       data  /* [in/out]*/) {
-    UA_ByteString    ivCopy    = {0, NULL};
-    UA_ByteString    cipherTxt = {0, NULL};
-    EVP_CIPHER_CTX * ctx       = NULL;
-    UA_StatusCode    ret;
-    int              opensslRet;
-    int              outLen;
-    int              tmpLen;
-
-    /* copy the IV because the AES_cbc_encrypt function overwrites it. */
-
-    ret = UA_ByteString_copy (iv, &ivCopy);
-    if (ret != UA_STATUSCODE_GOOD) {
-        goto errout;
+UA_OpenSSL_Cipher_Update (EVP_CIPHER_CTX *      ctx,
+                          const UA_ByteString * iv,
+                          UA_ByteString *       data, /* [in/out]*/
+                          int                   enc) {
+    int outLen = 0;
+    int tmpLen = 0;
+
+    if (ctx == NULL ||
+        iv->length < (size_t) EVP_CIPHER_CTX_iv_length (ctx) ||
+        data->length % (size_t) EVP_CIPHER_CTX_block_size (ctx) != 0) {
+        return UA_STATUSCODE_BADINTERNALERROR;
     }
 
-    ret = UA_ByteString_copy (data, &cipherTxt);
-    if (ret != UA_STATUSCODE_GOOD) {
-        goto errout;
+    /* Keeps the key schedule and only resets the IV */
+    if (EVP_CipherInit_ex (ctx, NULL, NULL, NULL, iv->data, enc) != 1 ||
+        EVP_CIPHER_CTX_set_padding (ctx, 0) != 1) {
+        return UA_STATUSCODE_BADINTERNALERROR;
     }
 
-    ctx = EVP_CIPHER_CTX_new ();
-    if (ctx == NULL) {
-        ret = UA_STATUSCODE_BADOUTOFMEMORY;
-        goto errout;
+    /* In-place operation is allowed for the CBC mode */
+    if (EVP_CipherUpdate (ctx, data->data, &outLen, data->data,
+                          (int) data->length) != 1) {
+        return UA_STATUSCODE_BADINTERNALERROR;
     }
 
-    /* call EVP_* to decrypt */
+    /* Final does nothing as padding is disabled */
+    if (EVP_CipherFinal_ex (ctx, data->data + outLen, &tmpLen) != 1) {
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    data->length = (size_t) (outLen + tmpLen);
+    return UA_STATUSCODE_GOOD;
+}
 
-    opensslRet = EVP_DecryptInit_ex (ctx, cipherAlg, NULL, key->data, ivCopy.data);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
+static EVP_CIPHER_CTX *
+UA_OpenSSL_Cipher_New (const EVP_CIPHER *    cipherAlg,
+                       const UA_ByteString * key,
+                       int                   enc) {
+    if ((size_t) EVP_CIPHER_key_length (cipherAlg) != key->length) {
+        return NULL;
     }
-    /* EVP_DecryptFinal() will return an error code if padding is enabled
-     * and the final block is not correctly formatted.
-     */
-    EVP_CIPHER_CTX_set_padding (ctx, 0);
-    opensslRet = EVP_DecryptUpdate (ctx, data->data, &outLen,
-                                    cipherTxt.data, (int) cipherTxt.length);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
+    EVP_CIPHER_CTX * ctx = EVP_CIPHER_CTX_new ();
+    if (ctx == NULL) {
+        return NULL;
     }
-    opensslRet = EVP_DecryptFinal_ex (ctx, data->data + outLen, &tmpLen);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
+    if (EVP_CipherInit_ex (ctx, cipherAlg, NULL, key->data, NULL, enc) != 1) {
+        EVP_CIPHER_CTX_free (ctx);
+        return NULL;
     }
-    outLen += tmpLen;
-    data->length = (size_t) outLen;
-    ret = UA_STATUSCODE_GOOD;
+    return ctx;
+}
 
-errout:
-    UA_ByteString_clear (&ivCopy);
-    UA_ByteString_clear (&cipherTxt);
-    if (ctx != NULL) {
-        EVP_CIPHER_CTX_free(ctx);
+static UA_StatusCode
+UA_OpenSSL_Decrypt (const UA_ByteString * iv,
+                    const UA_ByteString * key,
+                    const EVP_CIPHER *    cipherAlg,
+                    UA_ByteString *       data  /* [in/out]*/) {
+    EVP_CIPHER_CTX * ctx = UA_OpenSSL_Cipher_New (cipherAlg, key, 0);
+    if (ctx == NULL) {
+        return UA_STATUSCODE_BADINTERNALERROR;
     }
+    UA_StatusCode ret = UA_OpenSSL_Cipher_Update (ctx, iv, data, 0);
+    EVP_CIPHER_CTX_free (ctx);
     return ret;
 }
 
@@ -734,77 +721,12 @@ UA_OpenSSL_Encrypt (const UA_ByteString * iv,
                     const EVP_CIPHER *    cipherAlg,
                     UA_ByteString *       data  /* [in/out]*/
                     ) {
-
-    UA_ByteString    ivCopy   = {0, NULL};
-    UA_ByteString    plainTxt = {0, NULL};
-    EVP_CIPHER_CTX * ctx      = NULL;
-    UA_StatusCode    ret;
-    int              opensslRet;
-    int              outLen;
-    int              tmpLen;
-
-    /* copy the IV because the AES_cbc_encrypt function overwrites it. */
-
-    ret = UA_ByteString_copy (iv, &ivCopy);
-    if (ret != UA_STATUSCODE_GOOD) {
-        goto errout;
-    }
-
-    ret = UA_ByteString_copy (data, &plainTxt);
-    if (ret != UA_STATUSCODE_GOOD) {
-        goto errout;
-    }
-
-    ctx = EVP_CIPHER_CTX_new ();
+    EVP_CIPHER_CTX * ctx = UA_OpenSSL_Cipher_New (cipherAlg, key, 1);
     if (ctx == NULL) {
-        ret = UA_STATUSCODE_BADOUTOFMEMORY;
-        goto errout;
-    }
-
-    /* call EVP_* to encrypt */
-
-    opensslRet = EVP_EncryptInit_ex (ctx, cipherAlg, NULL, key->data, ivCopy.data);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-
-    /* Disable padding. Padding is done in the stack before calling encryption.
-     * Ensure that we have a multiple of the block size */
-    if(data->length % (size_t)EVP_CIPHER_CTX_block_size(ctx)) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-    opensslRet = EVP_CIPHER_CTX_set_padding(ctx, 0);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-
-    /* Encrypt the data */
-    opensslRet = EVP_EncryptUpdate (ctx, data->data, &outLen,
-                                    plainTxt.data, (int) plainTxt.length);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-
-    /* Encrypt-final does nothing as padding is disabled */
-    opensslRet = EVP_EncryptFinal_ex(ctx, data->data + outLen, &tmpLen);
-    if (opensslRet != 1) {
-        ret = UA_STATUSCODE_BADINTERNALERROR;
-        goto errout;
-    }
-    outLen += tmpLen;
-    data->length = (size_t) outLen;
-    ret = UA_STATUSCODE_GOOD;
-
-errout:
-    UA_ByteString_clear (&ivCopy);
-    UA_ByteString_clear (&plainTxt);
-    if (ctx != NULL) {
-        EVP_CIPHER_CTX_free(ctx);
+        return UA_STATUSCODE_BADINTERNALERROR;
     }
+    UA_StatusCode ret = UA_OpenSSL_Cipher_Update (ctx, iv, data, 1);
+    EVP_CIPHER_CTX_free (ctx);
     return ret;
 }
 
@@ -855,85 +777,11 @@ UA_Openssl_RSA_PKCS1_V15_SHA1_Sign (const UA_ByteString * message,
                                        RSA_PKCS1_PADDING, outSignature);
 }
 
-static UA_Openssl_P_SHA1_Ctx *
-P_SHA1_Ctx_Create (const UA_ByteString *  secret,
-                   const UA_ByteString *  seed) {
-    size_t size = (UA_Int32)sizeof (UA_Openssl_P_SHA1_Ctx) + secret->length +
-                    seed->length;
-    UA_Openssl_P_SHA1_Ctx * ctx = (UA_Openssl_P_SHA1_Ctx *) UA_malloc (size);
-    if (ctx == NULL) {
-        return NULL;
-    }
-
-    ctx->secretLen = secret->length;
-    ctx->seedLen = seed->length;
-    (void) memcpy (UA_Openssl_P_SHA1_SEED(ctx), seed->data, seed->length);
-    (void) memcpy (UA_Openssl_P_SHA1_SECRET(ctx), secret->data, secret->length);
-    /* A(0) = seed
-       A(n) = HMAC_HASH(secret, A(n-1)) */
-
-    if (HMAC (EVP_sha1(), secret->data, (int) secret->length, seed->data,
-        seed->length, ctx->A, NULL) == NULL) {
-        UA_free (ctx);
-        return NULL;
-    }
-
-    return ctx;
-}
-
-static UA_StatusCode
-P_SHA1_Hash_Generate (UA_Openssl_P_SHA1_Ctx * ctx,
-                      UA_Byte *               pHas
-                      ) {
-    /* Calculate P_SHA1(n) = HMAC_SHA1(secret, A(n)+seed) */
-    if (HMAC (EVP_sha1 (), UA_Openssl_P_SHA1_SECRET(ctx), (int) ctx->secretLen,
-        ctx->A, sizeof (ctx->A) + ctx->seedLen, pHas, NULL) == NULL) {
-            return UA_STATUSCODE_BADINTERNALERROR;
-        }
-
-    /* Calculate A(n) = HMAC_SHA1(secret, A(n-1)) */
-   if (HMAC (EVP_sha1(), UA_Openssl_P_SHA1_SECRET(ctx), (int) ctx->secretLen,
-        ctx->A, sizeof (ctx->A), ctx->A, NULL) == NULL) {
-            return UA_STATUSCODE_BADINTERNALERROR;
-        }
-    return UA_STATUSCODE_GOOD;
-}
-
 UA_StatusCode
 UA_Openssl_Random_Key_PSHA1_Derive (const UA_ByteString *     secret,
                                    const UA_ByteString *     seed,
                                    UA_ByteString *           out) {
-    size_t keyLen     = out->length;
-    size_t iter       = keyLen / SHA1_DIGEST_LENGTH + ((keyLen % SHA1_DIGEST_LENGTH)?1:0);
-    size_t bufferLen  = iter * SHA1_DIGEST_LENGTH;
-    UA_Byte * pBuffer = (UA_Byte *) UA_malloc (bufferLen);
-    if (pBuffer == NULL) {
-        return UA_STATUSCODE_BADOUTOFMEMORY;
-    }
-
-    UA_Openssl_P_SHA1_Ctx * ctx = P_SHA1_Ctx_Create (secret, seed);
-    if (ctx == NULL) {
-        UA_free (pBuffer);
-        return UA_STATUSCODE_BADOUTOFMEMORY;
-    }
-
-    size_t i;
-    UA_StatusCode st;
-
-    for (i = 0; i < iter; i++) {
-        st = P_SHA1_Hash_Generate (ctx, pBuffer + (i * SHA1_DIGEST_LENGTH));
-        if (st != UA_STATUSCODE_GOOD) {
-            UA_free (pBuffer);
-            UA_free (ctx);
-            return st;
-        }
-    }
-
-    (void) memcpy (out->data, pBuffer, keyLen);
-    UA_free (pBuffer);
-    UA_free (ctx);
-
-    return UA_STATUSCODE_GOOD;
+    return UA_Openssl_P_Hash_Derive (EVP_sha1 (), secret, seed, out);
 }
 
 UA_StatusCode
@@ -1009,6 +857,334 @@ UA_OpenSSL_AES_128_CBC_Encrypt (const UA_ByteString * iv,
     return UA_OpenSSL_Encrypt (iv, key, EVP_aes_128_cbc (), data);
 }
 
+/* Keyed HMAC context */
+
+static void
+UA_OpenSSL_HMAC_Ctx_clear (UA_OpenSSL_HMAC_Ctx * hc) {
+#if defined(UA_OPENSSL_EVP_MAC)
+    EVP_MAC_CTX_free (hc->ctx);
+#elif OPENSSL_VERSION_NUMBER >= 0x10100000L || defined(LIBRESSL_VERSION_NUMBER)
+    HMAC_CTX_free (hc->ctx);
+#else
+    UA_ByteString_clear (&hc->key);
+#endif
+    memset (hc, 0, sizeof (UA_OpenSSL_HMAC_Ctx));
+}
+
+static UA_StatusCode
+UA_OpenSSL_HMAC_Ctx_setKey (UA_OpenSSL_HMAC_Ctx * hc,
+                            const EVP_MD *        md,
+                            const UA_ByteString * key) {
+    UA_OpenSSL_HMAC_Ctx_clear (hc);
+    hc->md = md;
+#if defined(UA_OPENSSL_EVP_MAC)
+    EVP_MAC * mac = EVP_MAC_fetch (NULL, "HMAC", NULL);
+    if (mac == NULL) {
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    hc->ctx = EVP_MAC_CTX_new (mac);
+    EVP_MAC_free (mac);
+    if (hc->ctx == NULL) {
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    OSSL_PARAM params[2];
+    params[0] = OSSL_PARAM_construct_utf8_string (OSSL_MAC_PARAM_DIGEST,
+                                                  (char *) (uintptr_t) EVP_MD_get0_name (md), 0);
+    params[1] = OSSL_PARAM_construct_end ();
+    if (EVP_MAC_init (hc->ctx, key->data, key->length, params) != 1) {
+        UA_OpenSSL_HMAC_Ctx_clear (hc);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    return UA_STATUSCODE_GOOD;
+#elif OPENSSL_VERSION_NUMBER >= 0x10100000L || defined(LIBRESSL_VERSION_NUMBER)
+    hc->ctx = HMAC_CTX_new ();
+    if (hc->ctx == NULL) {
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    if (HMAC_Init_ex (hc->ctx, key->data, (int) key->length, md, NULL) != 1) {
+        UA_OpenSSL_HMAC_Ctx_clear (hc);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    return UA_STATUSCODE_GOOD;
+#else
+    return UA_ByteString_copy (key, &hc->key);
+#endif
+}
+
+/* The output buffer must have space for EVP_MAX_MD_SIZE bytes */
+static UA_StatusCode
+UA_OpenSSL_HMAC_Ctx_compute (UA_OpenSSL_HMAC_Ctx * hc,
+                             const UA_ByteString * message,
+                             UA_Byte *             out,
+                             size_t *              outLen) {
+    if (hc->md == NULL) {
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+#if defined(UA_OPENSSL_EVP_MAC)
+    /* Reinitialize with the stored key */
+    if (EVP_MAC_init (hc->ctx, NULL, 0, NULL) != 1 ||
+        EVP_MAC_update (hc->ctx, message->data, message->length) != 1 ||
+        EVP_MAC_final (hc->ctx, out, outLen, EVP_MAX_MD_SIZE) != 1) {
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+#elif OPENSSL_VERSION_NUMBER >= 0x10100000L || defined(LIBRESSL_VERSION_NUMBER)
+    unsigned int len = 0;
+    /* Reinitialize with the stored key */
+    if (HMAC_Init_ex (hc->ctx, NULL, 0, NULL, NULL) != 1 ||
+        HMAC_Update (hc->ctx, message->data, message->length) != 1 ||
+        HMAC_Final (hc->ctx, out, &len) != 1) {
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    *outLen = len;
+#else
+    unsigned int len = 0;
+    if (HMAC (hc->md, hc->key.data, (int) hc->key.length, message->data,
+              message->length, out, &len) == NULL) {
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    *outLen = len;
+#endif
+    return UA_STATUSCODE_GOOD;
+}
+
+#if defined(UA_OPENSSL_EVP_MAC) || \
+    OPENSSL_VERSION_NUMBER >= 0x10100000L || defined(LIBRESSL_VERSION_NUMBER)
+#define UA_OPENSSL_HMAC_STREAMING 1
+
+/* Streaming HMAC for the fused sign-and-encrypt */
+
+static UA_StatusCode
+UA_OpenSSL_HMAC_Ctx_begin (UA_OpenSSL_HMAC_Ctx * hc) {
+#if defined(UA_OPENSSL_EVP_MAC)
+    if (EVP_MAC_init (hc->ctx, NULL, 0, NULL) != 1)
+#else
+    if (HMAC_Init_ex (hc->ctx, NULL, 0, NULL, NULL) != 1)
+#endif
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+UA_OpenSSL_HMAC_Ctx_update (UA_OpenSSL_HMAC_Ctx * hc,
+                            const UA_Byte *       data,
+                            size_t                length) {
+#if defined(UA_OPENSSL_EVP_MAC)
+    if (EVP_MAC_update (hc->ctx, data, length) != 1)
+#else
+    if (HMAC_Update (hc->ctx, data, length) != 1)
+#endif
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+UA_OpenSSL_HMAC_Ctx_final (UA_OpenSSL_HMAC_Ctx * hc,
+                           UA_Byte *             out,
+                           size_t *              outLen) {
+#if defined(UA_OPENSSL_EVP_MAC)
+    if (EVP_MAC_final (hc->ctx, out, outLen, EVP_MAX_MD_SIZE) != 1)
+        return UA_STATUSCODE_BADINTERNALERROR;
+#else
+    unsigned int len = 0;
+    if (HMAC_Final (hc->ctx, out, &len) != 1)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    *outLen = len;
+#endif
+    return UA_STATUSCODE_GOOD;
+}
+
+#endif
+
+/* Symmetric channel context */
+
+void
+UA_OpenSSL_SymmetricContext_init (UA_OpenSSL_SymmetricContext * sc) {
+    memset (sc, 0, sizeof (UA_OpenSSL_SymmetricContext));
+}
+
+void
+UA_OpenSSL_SymmetricContext_clear (UA_OpenSSL_SymmetricContext * sc) {
+    EVP_CIPHER_CTX_free (sc->encryptCtx);
+    EVP_CIPHER_CTX_free (sc->decryptCtx);
+    UA_OpenSSL_HMAC_Ctx_clear (&sc->signCtx);
+    UA_OpenSSL_HMAC_Ctx_clear (&sc->verifyCtx);
+    memset (sc, 0, sizeof (UA_OpenSSL_SymmetricContext));
+}
+
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_setEncryptingKey (UA_OpenSSL_SymmetricContext * sc,
+                                              const EVP_CIPHER *            cipherAlg,
+                                              const UA_ByteString *         key) {
+    EVP_CIPHER_CTX_free (sc->encryptCtx);
+    sc->encryptCtx = UA_OpenSSL_Cipher_New (cipherAlg, key, 1);
+    return (sc->encryptCtx != NULL) ? UA_STATUSCODE_GOOD : UA_STATUSCODE_BADINTERNALERROR;
+}
+
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_setDecryptingKey (UA_OpenSSL_SymmetricContext * sc,
+                                              const EVP_CIPHER *            cipherAlg,
+                                              const UA_ByteString *         key) {
+    EVP_CIPHER_CTX_free (sc->decryptCtx);
+    sc->decryptCtx = UA_OpenSSL_Cipher_New (cipherAlg, key, 0);
+    return (sc->decryptCtx != NULL) ? UA_STATUSCODE_GOOD : UA_STATUSCODE_BADINTERNALERROR;
+}
+
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_setSigningKey (UA_OpenSSL_SymmetricContext * sc,
+                                           const EVP_MD *                md,
+                                           const UA_ByteString *         key) {
+    return UA_OpenSSL_HMAC_Ctx_setKey (&sc->signCtx, md, key);
+}
+
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_setVerifyingKey (UA_OpenSSL_SymmetricContext * sc,
+                                             const EVP_MD *                md,
+                                             const UA_ByteString *         key) {
+    return UA_OpenSSL_HMAC_Ctx_setKey (&sc->verifyCtx, md, key);
+}
+
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_encrypt (UA_OpenSSL_SymmetricContext * sc,
+                                     const UA_ByteString *         iv,
+                                     UA_ByteString *               data  /* [in/out]*/) {
+    return UA_OpenSSL_Cipher_Update (sc->encryptCtx, iv, data, 1);
+}
+
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_decrypt (UA_OpenSSL_SymmetricContext * sc,
+                                     const UA_ByteString *         iv,
+                                     UA_ByteString *               data  /* [in/out]*/) {
+    return UA_OpenSSL_Cipher_Update (sc->decryptCtx, iv, data, 0);
+}
+
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_sign (UA_OpenSSL_SymmetricContext * sc,
+                                  const UA_ByteString *         message,
+                                  UA_ByteString *               signature) {
+    UA_Byte buf[EVP_MAX_MD_SIZE];
+    size_t len = 0;
+    UA_StatusCode ret = UA_OpenSSL_HMAC_Ctx_compute (&sc->signCtx, message, buf, &len);
+    if (ret != UA_STATUSCODE_GOOD) {
+        return ret;
+    }
+    if (signature->length < len) {
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    memcpy (signature->data, buf, len);
+    signature->length = len;
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_verify (UA_OpenSSL_SymmetricContext * sc,
+                                    const UA_ByteString *         message,
+                                    const UA_ByteString *         signature) {
+    UA_Byte buf[EVP_MAX_MD_SIZE];
+    size_t len = 0;
+    UA_StatusCode ret = UA_OpenSSL_HMAC_Ctx_compute (&sc->verifyCtx, message, buf, &len);
+    if (ret != UA_STATUSCODE_GOOD) {
+        return ret;
+    }
+    if (signature->length != len ||
+        CRYPTO_memcmp (signature->data, buf, len) != 0) {
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Segment size for the fused sign-and-encrypt. Each segment is signed and then
+ * encrypted while it is still in the L1 cache. */
+#define UA_OPENSSL_SIGNENCRYPT_SEGMENT 4096
+
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_signAndEncrypt (UA_OpenSSL_SymmetricContext * sc,
+                                            const UA_ByteString *         iv,
+                                            UA_ByteString *               chunk,
+                                            size_t                        encryptOffset,
+                                            size_t                        signatureOffset) {
+    if (sc->encryptCtx == NULL || sc->signCtx.md == NULL ||
+        encryptOffset > signatureOffset || signatureOffset > chunk->length) {
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+#if defined(UA_OPENSSL_HMAC_STREAMING)
+    EVP_CIPHER_CTX * ctx = sc->encryptCtx;
+    size_t blockSize = (size_t) EVP_CIPHER_CTX_block_size (ctx);
+    size_t sigSize = (size_t) EVP_MD_size (sc->signCtx.md);
+    if (signatureOffset + sigSize != chunk->length ||
+        (chunk->length - encryptOffset) % blockSize != 0 ||
+        iv->length < (size_t) EVP_CIPHER_CTX_iv_length (ctx)) {
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    UA_StatusCode ret = UA_OpenSSL_HMAC_Ctx_begin (&sc->signCtx);
+    if (ret != UA_STATUSCODE_GOOD) {
+        return ret;
+    }
+    if (EVP_CipherInit_ex (ctx, NULL, NULL, NULL, iv->data, 1) != 1 ||
+        EVP_CIPHER_CTX_set_padding (ctx, 0) != 1) {
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Sign a segment, then encrypt the complete cipher blocks that are
+     * already signed. The encryption lags behind by less than a block. */
+    UA_Byte * data = chunk->data;
+    size_t signedPos = 0;
+    size_t encPos = encryptOffset;
+    int outLen = 0;
+    while (signedPos < signatureOffset) {
+        size_t segment = signatureOffset - signedPos;
+        if (segment > UA_OPENSSL_SIGNENCRYPT_SEGMENT) {
+            segment = UA_OPENSSL_SIGNENCRYPT_SEGMENT;
+        }
+        ret = UA_OpenSSL_HMAC_Ctx_update (&sc->signCtx, &data[signedPos], segment);
+        if (ret != UA_STATUSCODE_GOOD) {
+            return ret;
+        }
+        signedPos += segment;
+        if (signedPos <= encPos) {
+            continue;
+        }
+        size_t encLen = signedPos - encPos;
+        encLen -= encLen % blockSize;
+        if (encLen == 0) {
+            continue;
+        }
+        if (EVP_CipherUpdate (ctx, &data[encPos], &outLen, &data[encPos],
+                              (int) encLen) != 1 || (size_t) outLen != encLen) {
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+        encPos += encLen;
+    }
+
+    /* Write the signature and encrypt the remaining blocks */
+    size_t sigLen = 0;
+    ret = UA_OpenSSL_HMAC_Ctx_final (&sc->signCtx, &data[signatureOffset], &sigLen);
+    if (ret != UA_STATUSCODE_GOOD || sigLen != sigSize) {
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    int tmpLen = 0;
+    if (EVP_CipherUpdate (ctx, &data[encPos], &outLen, &data[encPos],
+                          (int) (chunk->length - encPos)) != 1 ||
+        EVP_CipherFinal_ex (ctx, &data[encPos] + outLen, &tmpLen) != 1) {
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    return UA_STATUSCODE_GOOD;
+#else
+    /* No streaming HMAC context. Sign and encrypt one after the other. */
+    UA_ByteString message = {signatureOffset, chunk->data};
+    UA_ByteString signature = {chunk->length - signatureOffset,
+                               &chunk->data[signatureOffset]};
+    UA_StatusCode ret = UA_OpenSSL_SymmetricContext_sign (sc, &message, &signature);
+    if (ret != UA_STATUSCODE_GOOD) {
+        return ret;
+    }
+    UA_ByteString encrypted = {chunk->length - encryptOffset,
+                               &chunk->data[encryptOffset]};
+    return UA_OpenSSL_SymmetricContext_encrypt (sc, iv, &encrypted);
+#endif
+}
+
 EVP_PKEY *
 UA_OpenSSL_LoadPrivateKey(const UA_ByteString *privateKey) {
     const unsigned char * pkData = privateKey->data;
@@ -1021,6 +1197,9 @@ UA_OpenSSL_LoadPrivateKey(const UA_ByteString *privateKey) {
     if (len > 1 && pkData[0] == 0x30 && pkData[1] == 0x82) { // Magic number for DER encoded keys
         result = d2i_PrivateKey(EVP_PKEY_RSA, NULL,
                                           &pkData, len);
+    } else if (len > 1 && pkData[0] == 0x30) {
+        /* Short DER encoded keys (ECC) */
+        result = d2i_AutoPrivateKey(NULL, &pkData, len);
     } else {
         BIO *bio = NULL;
         bio = BIO_new_mem_buf((void *) privateKey->data, (int) privateKey->length);
@@ -1090,4 +1269,215 @@ UA_OpenSSL_LoadLocalCertificate(const UA_ByteString *certificate, UA_ByteString
     return UA_STATUSCODE_BADINVALIDARGUMENT;
 }
 
+#ifdef UA_OPENSSL_ECC
+
+UA_Boolean
+UA_OpenSSL_ECC_isCurve(EVP_PKEY *key, int curveNid) {
+    if(!key || EVP_PKEY_get_base_id(key) != EVP_PKEY_EC)
+        return false;
+    char name[64];
+    size_t nameLen = 0;
+    if(EVP_PKEY_get_group_name(key, name, sizeof(name), &nameLen) != 1)
+        return false;
+    int nid = OBJ_sn2nid(name);
+    if(nid == NID_undef)
+        nid = EC_curve_nist2nid(name);
+    return (nid == curveNid);
+}
+
+/* Largest uncompressed point (P-521) */
+#define UA_OPENSSL_ECC_MAXPOINTLENGTH 133
+
+UA_StatusCode
+UA_OpenSSL_ECC_generateKey(const char *groupName, EVP_PKEY **outKeyPair,
+                           UA_ByteString *outPublicKey) {
+    EVP_PKEY *key = EVP_EC_gen(groupName);
+    if(!key)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    /* Export the uncompressed point and strip the 0x04 prefix */
+    unsigned char point[UA_OPENSSL_ECC_MAXPOINTLENGTH];
+    size_t pointLen = 0;
+    if(EVP_PKEY_get_octet_string_param(key, OSSL_PKEY_PARAM_PUB_KEY, point,
+                                       sizeof(point), &pointLen) != 1 ||
+       pointLen != outPublicKey->length + 1 || point[0] != 0x04) {
+        EVP_PKEY_free(key);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    memcpy(outPublicKey->data, &point[1], outPublicKey->length);
+
+    EVP_PKEY_free(*outKeyPair);
+    *outKeyPair = key;
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_OpenSSL_ECC_deriveSharedSecret(const char *groupName, EVP_PKEY *localKeyPair,
+                                  const UA_ByteString *remotePublicKey,
+                                  UA_ByteString *outSecret) {
+    if(!localKeyPair || remotePublicKey->length + 1 > UA_OPENSSL_ECC_MAXPOINTLENGTH)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    /* Import the remote public key as an uncompressed point */
+    unsigned char point[UA_OPENSSL_ECC_MAXPOINTLENGTH];
+    point[0] = 0x04;
+    memcpy(&point[1], remotePublicKey->data, remotePublicKey->length);
+    OSSL_PARAM params[3];
+    params[0] = OSSL_PARAM_construct_utf8_string(OSSL_PKEY_PARAM_GROUP_NAME,
+                                                 (char*)(uintptr_t)groupName, 0);
+    params[1] = OSSL_PARAM_construct_octet_string(OSSL_PKEY_PARAM_PUB_KEY, point,
+                                                  remotePublicKey->length + 1);
+    params[2] = OSSL_PARAM_construct_end();
+
+    UA_StatusCode ret = UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+    EVP_PKEY *remoteKey = NULL;
+    EVP_PKEY_CTX *deriveCtx = NULL;
+    size_t secretLen = 0;
+    EVP_PKEY_CTX *importCtx = EVP_PKEY_CTX_new_from_name(NULL, "EC", NULL);
+    if(!importCtx)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    if(EVP_PKEY_fromdata_init(importCtx) != 1 ||
+       EVP_PKEY_fromdata(importCtx, &remoteKey, EVP_PKEY_PUBLIC_KEY, params) != 1)
+        goto errout;
+
+    /* Setting the peer also validates that the point is on the curve */
+    deriveCtx = EVP_PKEY_CTX_new(localKeyPair, NULL);
+    if(!deriveCtx) {
+        ret = UA_STATUSCODE_BADOUTOFMEMORY;
+        goto errout;
+    }
+    if(EVP_PKEY_derive_init(deriveCtx) != 1 ||
+       EVP_PKEY_derive_set_peer(deriveCtx, remoteKey) != 1 ||
+       EVP_PKEY_derive(deriveCtx, NULL, &secretLen) != 1)
+        goto errout;
+
+    ret = UA_ByteString_allocBuffer(outSecret, secretLen);
+    if(ret != UA_STATUSCODE_GOOD)
+        goto errout;
+    if(EVP_PKEY_derive(deriveCtx, outSecret->data, &outSecret->length) != 1) {
+        UA_ByteString_clear(outSecret);
+        ret = UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+    }
+
+errout:
+    EVP_PKEY_CTX_free(deriveCtx);
+    EVP_PKEY_free(remoteKey);
+    EVP_PKEY_CTX_free(importCtx);
+    return ret;
+}
+
+UA_StatusCode
+UA_OpenSSL_HKDF_Derive(const EVP_MD *md, const UA_ByteString *salt,
+                       const UA_ByteString *ikm, const UA_ByteString *info,
+                       UA_ByteString *out) {
+    EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_HKDF, NULL);
+    if(!ctx)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    UA_StatusCode ret = UA_STATUSCODE_GOOD;
+    size_t outLen = out->length;
+    if(EVP_PKEY_derive_init(ctx) != 1 ||
+       EVP_PKEY_CTX_set_hkdf_md(ctx, md) != 1 ||
+       EVP_PKEY_CTX_set1_hkdf_salt(ctx, salt->data, (int)salt->length) != 1 ||
+       EVP_PKEY_CTX_set1_hkdf_key(ctx, ikm->data, (int)ikm->length) != 1 ||
+       EVP_PKEY_CTX_add1_hkdf_info(ctx, info->data, (int)info->length) != 1 ||
+       EVP_PKEY_derive(ctx, out->data, &outLen) != 1 ||
+       outLen != out->length)
+        ret = UA_STATUSCODE_BADINTERNALERROR;
+
+    EVP_PKEY_CTX_free(ctx);
+    return ret;
+}
+
+/* Largest DER encoded ECDSA signature (P-521) */
+#define UA_OPENSSL_ECDSA_MAXDERLENGTH 141
+
+UA_StatusCode
+UA_OpenSSL_ECDSA_Sign(const UA_ByteString *message, const EVP_MD *md,
+                      EVP_PKEY *privateKey, UA_ByteString *outSignature) {
+    if(!privateKey)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    EVP_MD_CTX *mdctx = EVP_MD_CTX_create();
+    if(!mdctx)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* Sign with the DER encoding */
+    UA_StatusCode ret = UA_STATUSCODE_BADINTERNALERROR;
+    ECDSA_SIG *sig = NULL;
+    const BIGNUM *r = NULL;
+    const BIGNUM *s = NULL;
+    int half = (int)(outSignature->length / 2);
+    unsigned char der[UA_OPENSSL_ECDSA_MAXDERLENGTH];
+    const unsigned char *pos = der;
+    size_t derLen = sizeof(der);
+    if(EVP_DigestSignInit(mdctx, NULL, md, NULL, privateKey) != 1 ||
+       EVP_DigestSignUpdate(mdctx, message->data, message->length) != 1 ||
+       EVP_DigestSignFinal(mdctx, der, &derLen) != 1)
+        goto errout;
+
+    /* Convert to the fixed-length R | S encoding */
+    sig = d2i_ECDSA_SIG(NULL, &pos, (long)derLen);
+    if(!sig)
+        goto errout;
+    ECDSA_SIG_get0(sig, &r, &s);
+    if(BN_bn2binpad(r, outSignature->data, half) != half ||
+       BN_bn2binpad(s, &outSignature->data[half], half) != half)
+        goto errout;
+    ret = UA_STATUSCODE_GOOD;
+
+errout:
+    ECDSA_SIG_free(sig);
+    EVP_MD_CTX_destroy(mdctx);
+    return ret;
+}
+
+UA_StatusCode
+UA_OpenSSL_ECDSA_Verify(const UA_ByteString *message, const EVP_MD *md,
+                        X509 *publicKeyX509, const UA_ByteString *signature) {
+    if(signature->length == 0 || signature->length % 2 != 0)
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+
+    /* Convert the R | S encoding to DER */
+    int half = (int)(signature->length / 2);
+    BIGNUM *r = BN_bin2bn(signature->data, half, NULL);
+    BIGNUM *s = BN_bin2bn(&signature->data[half], half, NULL);
+    ECDSA_SIG *sig = ECDSA_SIG_new();
+    if(!r || !s || !sig) {
+        BN_free(r);
+        BN_free(s);
+        ECDSA_SIG_free(sig);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    ECDSA_SIG_set0(sig, r, s); /* Takes ownership of r and s */
+
+    UA_StatusCode ret = UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+    EVP_MD_CTX *mdctx = NULL;
+    unsigned char *der = NULL;
+    int derLen = i2d_ECDSA_SIG(sig, &der);
+    EVP_PKEY *publicKey = X509_get_pubkey(publicKeyX509);
+    if(derLen <= 0 || !publicKey)
+        goto errout;
+
+    mdctx = EVP_MD_CTX_create();
+    if(!mdctx) {
+        ret = UA_STATUSCODE_BADOUTOFMEMORY;
+        goto errout;
+    }
+    if(EVP_DigestVerifyInit(mdctx, NULL, md, NULL, publicKey) == 1 &&
+       EVP_DigestVerifyUpdate(mdctx, message->data, message->length) == 1 &&
+       EVP_DigestVerifyFinal(mdctx, der, (size_t)derLen) == 1)
+        ret = UA_STATUSCODE_GOOD;
+
+errout:
+    if(mdctx)
+        EVP_MD_CTX_destroy(mdctx);
+    EVP_PKEY_free(publicKey);
+    OPENSSL_free(der);
+    ECDSA_SIG_free(sig);
+    return ret;
+}
+
+#endif /* UA_OPENSSL_ECC */
+
 #endif
@@ -17,9 +17,98 @@
 
 #include <openssl/x509.h>
 #include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L && !defined(LIBRESSL_VERSION_NUMBER)
+#define UA_OPENSSL_EVP_MAC 1
+/* The ECC policies use the key import/export of the OpenSSL 3 providers */
+#define UA_OPENSSL_ECC 1
+#include <openssl/core_names.h>
+#endif
 
 _UA_BEGIN_DECLS
 
+/* Keyed HMAC context. The key schedule is computed once when the key is set
+ * and reused for every message. */
+typedef struct {
+    const EVP_MD *md;
+#if defined(UA_OPENSSL_EVP_MAC)
+    EVP_MAC_CTX *ctx;
+#elif OPENSSL_VERSION_NUMBER >= 0x10100000L || defined(LIBRESSL_VERSION_NUMBER)
+    HMAC_CTX *ctx;
+#else
+    UA_ByteString key; /* No reusable context before OpenSSL 1.1 */
+#endif
+} UA_OpenSSL_HMAC_Ctx;
+
+/* Symmetric crypto contexts of a SecureChannel. They are keyed when the
+ * symmetric keys are set (after the channel was opened or the security token
+ * renewed). Afterwards only the IV is reset for every chunk. */
+typedef struct {
+    EVP_CIPHER_CTX *encryptCtx; /* Local encrypting key */
+    EVP_CIPHER_CTX *decryptCtx; /* Remote encrypting key */
+    UA_OpenSSL_HMAC_Ctx signCtx;   /* Local signing key */
+    UA_OpenSSL_HMAC_Ctx verifyCtx; /* Remote signing key */
+} UA_OpenSSL_SymmetricContext;
+
+void
+UA_OpenSSL_SymmetricContext_init(UA_OpenSSL_SymmetricContext *sc);
+
+void
+UA_OpenSSL_SymmetricContext_clear(UA_OpenSSL_SymmetricContext *sc);
+
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_setEncryptingKey(UA_OpenSSL_SymmetricContext *sc,
+                                             const EVP_CIPHER *cipherAlg,
+                                             const UA_ByteString *key);
+
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_setDecryptingKey(UA_OpenSSL_SymmetricContext *sc,
+                                             const EVP_CIPHER *cipherAlg,
+                                             const UA_ByteString *key);
+
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_setSigningKey(UA_OpenSSL_SymmetricContext *sc,
+                                          const EVP_MD *md,
+                                          const UA_ByteString *key);
+
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_setVerifyingKey(UA_OpenSSL_SymmetricContext *sc,
+                                            const EVP_MD *md,
+                                            const UA_ByteString *key);
+
+/* Encrypt/decrypt in place */
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_encrypt(UA_OpenSSL_SymmetricContext *sc,
+                                    const UA_ByteString *iv,
+                                    UA_ByteString *data  /* [in/out]*/);
+
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_decrypt(UA_OpenSSL_SymmetricContext *sc,
+                                    const UA_ByteString *iv,
+                                    UA_ByteString *data  /* [in/out]*/);
+
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_sign(UA_OpenSSL_SymmetricContext *sc,
+                                 const UA_ByteString *message,
+                                 UA_ByteString *signature);
+
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_verify(UA_OpenSSL_SymmetricContext *sc,
+                                   const UA_ByteString *message,
+                                   const UA_ByteString *signature);
+
+/* Sign chunk[0, signatureOffset), write the signature at signatureOffset and
+ * encrypt chunk[encryptOffset, chunk->length) in place. Signing and encryption
+ * are interleaved segment by segment, so every byte is loaded only once from
+ * memory. */
+UA_StatusCode
+UA_OpenSSL_SymmetricContext_signAndEncrypt(UA_OpenSSL_SymmetricContext *sc,
+                                           const UA_ByteString *iv,
+                                           UA_ByteString *chunk,
+                                           size_t encryptOffset,
+                                           size_t signatureOffset);
+
 void saveDataToFile(const char *fileName, const UA_ByteString *str);
 void UA_Openssl_Init(void);
 
@@ -146,6 +235,46 @@ UA_OpenSSL_AES_128_CBC_Encrypt(const UA_ByteString *iv,
                                const UA_ByteString *key,
                                UA_ByteString *data  /* [in/out]*/);
 
+#ifdef UA_OPENSSL_ECC
+
+/* Is the key on the elliptic curve with the given NID? */
+UA_Boolean
+UA_OpenSSL_ECC_isCurve(EVP_PKEY *key, int curveNid);
+
+/* Generate an ephemeral key pair. The public key is written to outPublicKey
+ * as the concatenated X and Y coordinates (without the leading 0x04 of the
+ * uncompressed point encoding). The buffer has to be allocated with twice the
+ * coordinate length. */
+UA_StatusCode
+UA_OpenSSL_ECC_generateKey(const char *groupName, EVP_PKEY **outKeyPair,
+                           UA_ByteString *outPublicKey);
+
+/* ECDH shared secret between the local private key and the remote public key
+ * (X and Y coordinates). The secret is allocated. */
+UA_StatusCode
+UA_OpenSSL_ECC_deriveSharedSecret(const char *groupName, EVP_PKEY *localKeyPair,
+                                  const UA_ByteString *remotePublicKey,
+                                  UA_ByteString *outSecret);
+
+/* HKDF (RFC 5869) extract and expand. The length of out defines the number of
+ * produced bytes. */
+UA_StatusCode
+UA_OpenSSL_HKDF_Derive(const EVP_MD *md, const UA_ByteString *salt,
+                       const UA_ByteString *ikm, const UA_ByteString *info,
+                       UA_ByteString *out);
+
+/* ECDSA signatures are encoded as the concatenated R and S values of half the
+ * signature length each (not ASN.1 DER) */
+UA_StatusCode
+UA_OpenSSL_ECDSA_Sign(const UA_ByteString *message, const EVP_MD *md,
+                      EVP_PKEY *privateKey, UA_ByteString *outSignature);
+
+UA_StatusCode
+UA_OpenSSL_ECDSA_Verify(const UA_ByteString *message, const EVP_MD *md,
+                        X509 *publicKeyX509, const UA_ByteString *signature);
+
+#endif
+
 EVP_PKEY *
 UA_OpenSSL_LoadPrivateKey(const UA_ByteString *privateKey);
 
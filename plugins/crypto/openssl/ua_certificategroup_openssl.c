@@ -17,6 +17,7 @@
 #include <openssl/x509_vfy.h>
 #include <openssl/x509v3.h>
 #include <openssl/pem.h>
+#include <openssl/sha.h>
 
 #include "ua_openssl_version_abstraction.h"
 #include "libc_time.h"
@@ -62,6 +63,19 @@ UA_Bstrstr(const unsigned char *s1, size_t l1, const unsigned char *s2, size_t l
     return NULL;
 }
 
+/* Number of cached verification results per certificate group */
+#define UA_CERTIFICATE_VERIFY_CACHE_SIZE 64
+
+/* Default maximum age of a cached verification result (ms). The cache is
+ * disabled by default. */
+#define UA_CERTIFICATE_VERIFY_CACHE_MAXAGE 0.0
+
+typedef struct {
+    UA_Byte       thumbprint[SHA_DIGEST_LENGTH];
+    UA_UInt32     generation;
+    UA_DateTime   expiry; /* Wall-clock time, zero for unused entries */
+} CertVerifyCacheEntry;
+
 typedef struct {
     /*
      * If the folders are defined, we use them to reload the certificates during
@@ -78,6 +92,29 @@ typedef struct {
     STACK_OF(X509) *      skTrusted;
     STACK_OF(X509_CRL) *  skCrls; /* Revocation list*/
 
+    /* The store is kept for the lifetime of the context and shared across
+     * verifications */
+    X509_STORE *          store;
+
+    /* Change detection for the folders. The parsed lists are only reloaded
+     * when the stamp of a folder differs from the last load. The folders are
+     * checked at most once per reloadCheckInterval. */
+    UA_UInt32             trustListStamp;
+    UA_UInt32             issuerListStamp;
+    UA_UInt32             revocationListStamp;
+    UA_Boolean            folderLoaded;
+    UA_DateTime           reloadCheckInterval;
+    UA_DateTime           lastReloadCheck;
+
+    /* Cache of verification results. The generation is incremented whenever
+     * the trust, issuer or revocation list is reloaded. Cached entries from
+     * an older generation are ignored. */
+    UA_UInt32             generation;
+    UA_DateTime           crlNextUpdate; /* Earliest nextUpdate of the CRLs */
+    UA_DateTime           cacheMaxAge;
+    size_t                cacheNext;
+    CertVerifyCacheEntry  cache[UA_CERTIFICATE_VERIFY_CACHE_SIZE];
+
     UA_CertificateGroup *certGroup;
 } CertContext;
 
@@ -86,8 +123,9 @@ UA_CertContext_sk_Init (CertContext * context) {
     context->skTrusted = sk_X509_new_null();
     context->skIssue = sk_X509_new_null();
     context->skCrls = sk_X509_CRL_new_null();
+    context->store = X509_STORE_new();
     if (context->skTrusted == NULL || context->skIssue == NULL ||
-        context->skCrls == NULL) {
+        context->skCrls == NULL || context->store == NULL) {
         return UA_STATUSCODE_BADOUTOFMEMORY;
     }
     return UA_STATUSCODE_GOOD;
@@ -98,6 +136,9 @@ UA_CertContext_sk_free (CertContext * context) {
     sk_X509_pop_free (context->skTrusted, X509_free);
     sk_X509_pop_free (context->skIssue, X509_free);
     sk_X509_CRL_pop_free (context->skCrls, X509_CRL_free);
+    if (context->store != NULL)
+        X509_STORE_free (context->store);
+    context->store = NULL;
 }
 
 static UA_StatusCode
@@ -109,6 +150,10 @@ UA_CertContext_Init (CertContext * context, UA_CertificateGroup *certGroup) {
     UA_ByteString_init (&context->rejectedListFolder);
 
     context->certGroup = certGroup;
+    context->folderLoaded = false;
+    context->reloadCheckInterval = 0;
+    context->lastReloadCheck = 0;
+    context->cacheMaxAge = (UA_DateTime) (UA_CERTIFICATE_VERIFY_CACHE_MAXAGE * UA_DATETIME_MSEC);
 
     return UA_CertContext_sk_Init (context);
 }
@@ -136,6 +181,78 @@ UA_CertificateGroup_clear (UA_CertificateGroup *certGroup) {
     return;
 }
 
+static UA_DateTime
+UA_ASN1_TIME_toDateTime (const ASN1_TIME * asn1Time) {
+    struct tm dtTime;
+    if (asn1Time == NULL || ASN1_TIME_to_tm(asn1Time, &dtTime) != 1)
+        return 0;
+
+    struct mytm dateTime;
+    memset(&dateTime, 0, sizeof(struct mytm));
+    dateTime.tm_year = dtTime.tm_year;
+    dateTime.tm_mon = dtTime.tm_mon;
+    dateTime.tm_mday = dtTime.tm_mday;
+    dateTime.tm_hour = dtTime.tm_hour;
+    dateTime.tm_min = dtTime.tm_min;
+    dateTime.tm_sec = dtTime.tm_sec;
+
+    long long sec_epoch = __tm_to_secs(&dateTime);
+    return UA_DATETIME_UNIX_EPOCH + (sec_epoch * UA_DATETIME_SEC);
+}
+
+/* The trust store has changed. Invalidate the cached verification results and
+ * update the earliest time at which a CRL needs to be refreshed. */
+static void
+UA_CertContext_newGeneration (CertContext * ctx) {
+    ctx->generation++;
+    ctx->crlNextUpdate = 0;
+    for (int i = 0; i < sk_X509_CRL_num (ctx->skCrls); i++) {
+        X509_CRL * crl = sk_X509_CRL_value (ctx->skCrls, i);
+        UA_DateTime nextUpdate = UA_ASN1_TIME_toDateTime (X509_CRL_get0_nextUpdate (crl));
+        if (nextUpdate != 0 && (ctx->crlNextUpdate == 0 || nextUpdate < ctx->crlNextUpdate))
+            ctx->crlNextUpdate = nextUpdate;
+    }
+}
+
+static const CertVerifyCacheEntry *
+UA_CertCache_lookup (const CertContext * ctx,
+                     const UA_Byte *     thumbprint) {
+    UA_DateTime now = UA_DateTime_now();
+    for (size_t i = 0; i < UA_CERTIFICATE_VERIFY_CACHE_SIZE; i++) {
+        const CertVerifyCacheEntry * entry = &ctx->cache[i];
+        if (entry->expiry > now && entry->generation == ctx->generation &&
+            memcmp (entry->thumbprint, thumbprint, SHA_DIGEST_LENGTH) == 0)
+            return entry;
+    }
+    return NULL;
+}
+
+/* Cache a successful verification until the certificate or a CRL expires, or
+ * for at most cacheMaxAge. The oldest entry is replaced. Failed verifications
+ * are not cached. */
+static void
+UA_CertCache_store (CertContext *   ctx,
+                    const UA_Byte * thumbprint,
+                    X509 *          certificateX509) {
+    if (ctx->cacheMaxAge <= 0)
+        return;
+    UA_DateTime now = UA_DateTime_now();
+    UA_DateTime expiry = now + ctx->cacheMaxAge;
+    UA_DateTime notAfter = UA_ASN1_TIME_toDateTime (X509_get0_notAfter (certificateX509));
+    if (notAfter != 0 && notAfter < expiry)
+        expiry = notAfter;
+    if (ctx->crlNextUpdate != 0 && ctx->crlNextUpdate < expiry)
+        expiry = ctx->crlNextUpdate;
+    if (expiry <= now)
+        return;
+
+    CertVerifyCacheEntry * entry = &ctx->cache[ctx->cacheNext];
+    ctx->cacheNext = (ctx->cacheNext + 1) % UA_CERTIFICATE_VERIFY_CACHE_SIZE;
+    memcpy (entry->thumbprint, thumbprint, SHA_DIGEST_LENGTH);
+    entry->generation = ctx->generation;
+    entry->expiry = expiry;
+}
+
 static UA_StatusCode
 UA_skTrusted_Cert2X509 (const UA_ByteString *   certificateTrustList,
                         size_t                  certificateTrustListSize,
@@ -196,7 +313,10 @@ UA_skCrls_Cert2X509 (const UA_ByteString *   certificateRevocationList,
         if (crl == NULL) {
             return UA_STATUSCODE_BADINTERNALERROR;
         }
-        sk_X509_CRL_push (ctx->skCrls, crl);
+        if (sk_X509_CRL_push (ctx->skCrls, crl) <= 0) {
+            X509_CRL_free (crl);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
     }
 
     return UA_STATUSCODE_GOOD;
@@ -204,6 +324,7 @@ UA_skCrls_Cert2X509 (const UA_ByteString *   certificateRevocationList,
 
 #ifdef __linux__
 #include <dirent.h>
+#include <sys/stat.h>
 
 static int UA_Certificate_Filter_der_pem (const struct dirent * entry) {
     /* ignore hidden files */
@@ -253,6 +374,15 @@ UA_BuildFullPath (const char * path,
     return UA_STATUSCODE_GOOD;
 }
 
+static void
+UA_FreeDirList (struct dirent ** dirlist, int num) {
+    if (dirlist == NULL)
+        return;
+    for (int i = 0; i < num; i++)
+        free (dirlist[i]);
+    free (dirlist);
+}
+
 static UA_StatusCode
 UA_loadCertFromFile (const char *     fileName,
                      UA_ByteString *  cert) {
@@ -281,128 +411,235 @@ UA_loadCertFromFile (const char *     fileName,
     return UA_STATUSCODE_GOOD;
 }
 
-static UA_StatusCode
-UA_ReloadCertFromFolder (CertContext * ctx) {
-    UA_StatusCode    ret;
+/* Compute a stamp from the names and the metadata of the files in the folder.
+ * The stamp changes when files are added, removed, renamed or rewritten. This
+ * is much cheaper than reading and parsing the files. */
+static UA_UInt32
+UA_FolderStamp (const char * folderPath,
+                int (*filter)(const struct dirent *)) {
     struct dirent ** dirlist = NULL;
-    int              i;
-    int              numCertificates;
-    char             certFile[PATH_MAX];
-    UA_ByteString    strCert;
-    char             folderPath[PATH_MAX];
+    char             file[PATH_MAX];
+    struct stat      st;
+    UA_UInt32        stamp = 0;
 
-    UA_ByteString_init (&strCert);
+    int numFiles = scandir(folderPath, &dirlist, filter, alphasort);
+    if (numFiles < 0)
+        return 0;
+    for (int i = 0; i < numFiles; i++) {
+        if (UA_BuildFullPath (folderPath, dirlist[i]->d_name,
+                              PATH_MAX, file) != UA_STATUSCODE_GOOD ||
+            stat (file, &st) != 0) {
+            continue;
+        }
+        stamp = UA_ByteString_hash (stamp, (const UA_Byte *) file, strlen (file));
+        stamp = UA_ByteString_hash (stamp, (const UA_Byte *) &st.st_ino, sizeof (st.st_ino));
+        stamp = UA_ByteString_hash (stamp, (const UA_Byte *) &st.st_size, sizeof (st.st_size));
+        stamp = UA_ByteString_hash (stamp, (const UA_Byte *) &st.st_mtim, sizeof (st.st_mtim));
+    }
+    UA_FreeDirList (dirlist, numFiles);
 
-    if (ctx->trustListFolder.length > 0) {
-        UA_LOG_INFO(ctx->certGroup->logging, UA_LOGCATEGORY_SERVER, "Reloading the trust-list");
+    /* Distinguish an empty folder from a folder that was never loaded */
+    return stamp + (UA_UInt32) numFiles + 1;
+}
 
-        sk_X509_pop_free (ctx->skTrusted, X509_free);
-        ctx->skTrusted = sk_X509_new_null();
-        if (ctx->skTrusted == NULL) {
-            return UA_STATUSCODE_BADOUTOFMEMORY;
-        }
+/* Returns true if the folder has changed since the last successful load. The
+ * new stamp is returned, but only stored once the folder has been loaded. */
+static UA_Boolean
+UA_FolderChanged (const CertContext * ctx,
+                  const UA_String *   folder,
+                  int (*filter)(const struct dirent *),
+                  UA_UInt32           stamp,
+                  UA_UInt32 *         newStamp) {
+    char folderPath[PATH_MAX];
+    if (folder->length >= PATH_MAX)
+        return false;
+    (void) memcpy (folderPath, folder->data, folder->length);
+    folderPath[folder->length] = 0;
+    *newStamp = UA_FolderStamp (folderPath, filter);
+    return (!ctx->folderLoaded || *newStamp != stamp);
+}
+
+/* Load the certificates of a folder into a new stack. The current stack is only
+ * replaced once the new stack is fully built. So a failed reload leaves the
+ * previous list in place. */
+static UA_StatusCode
+UA_ReloadCertStack (CertContext *     ctx,
+                    const UA_String * folder,
+                    UA_UInt32 *       stamp,
+                    STACK_OF(X509) ** sk) {
+    UA_UInt32 newStamp;
+    if (!UA_FolderChanged (ctx, folder, UA_Certificate_Filter_der_pem,
+                           *stamp, &newStamp))
+        return UA_STATUSCODE_GOOD;
+
+    STACK_OF(X509) * newSk = sk_X509_new_null();
+    if (newSk == NULL)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    char folderPath[PATH_MAX];
+    (void) memcpy (folderPath, folder->data, folder->length);
+    folderPath[folder->length] = 0;
 
-        (void) memcpy (folderPath, ctx->trustListFolder.data,
-                       ctx->trustListFolder.length);
-        folderPath[ctx->trustListFolder.length] = 0;
-        numCertificates = scandir(folderPath, &dirlist,
+    struct dirent ** dirlist = NULL;
+    char             certFile[PATH_MAX];
+    UA_ByteString    strCert;
+    UA_StatusCode    ret = UA_STATUSCODE_GOOD;
+    UA_ByteString_init (&strCert);
+    int numCertificates = scandir(folderPath, &dirlist,
                                   UA_Certificate_Filter_der_pem,
                                   alphasort);
-        for (i = 0; i < numCertificates; i++) {
-            if (UA_BuildFullPath (folderPath, dirlist[i]->d_name,
-                                  PATH_MAX, certFile) != UA_STATUSCODE_GOOD) {
-                continue;
-            }
-            ret = UA_loadCertFromFile (certFile, &strCert);
-            if (ret != UA_STATUSCODE_GOOD) {
-                UA_LOG_INFO(ctx->certGroup->logging, UA_LOGCATEGORY_SERVER,
-                            "Failed to load the certificate file %s", certFile);
-                continue;  /* continue or return ? */
-            }
-            if (UA_skTrusted_Cert2X509 (&strCert, 1, ctx) != UA_STATUSCODE_GOOD) {
-                UA_LOG_INFO (ctx->certGroup->logging, UA_LOGCATEGORY_SERVER,
-                            "Failed to decode the certificate file %s", certFile);
-                UA_ByteString_clear (&strCert);
-                continue;  /* continue or return ? */
-            }
-            UA_ByteString_clear (&strCert);
+    if (numCertificates < 0)
+        ret = UA_STATUSCODE_BADINTERNALERROR;
+    for (int i = 0; i < numCertificates; i++) {
+        if (UA_BuildFullPath (folderPath, dirlist[i]->d_name,
+                              PATH_MAX, certFile) != UA_STATUSCODE_GOOD) {
+            continue;
+        }
+        if (UA_loadCertFromFile (certFile, &strCert) != UA_STATUSCODE_GOOD) {
+            UA_LOG_INFO(ctx->certGroup->logging, UA_LOGCATEGORY_SERVER,
+                        "Failed to load the certificate file %s", certFile);
+            continue;
+        }
+        X509 * x509 = UA_OpenSSL_LoadCertificate (&strCert);
+        UA_ByteString_clear (&strCert);
+        if (x509 == NULL) {
+            UA_LOG_INFO (ctx->certGroup->logging, UA_LOGCATEGORY_SERVER,
+                         "Failed to decode the certificate file %s", certFile);
+            continue;
+        }
+        if (sk_X509_push (newSk, x509) <= 0) {
+            X509_free (x509);
+            ret = UA_STATUSCODE_BADOUTOFMEMORY;
+            break;
         }
     }
+    UA_FreeDirList (dirlist, numCertificates);
 
-    if (ctx->issuerListFolder.length > 0) {
-        UA_LOG_INFO(ctx->certGroup->logging, UA_LOGCATEGORY_SERVER, "Reloading the issuer-list");
+    if (ret != UA_STATUSCODE_GOOD) {
+        sk_X509_pop_free (newSk, X509_free);
+        return ret;
+    }
 
-        sk_X509_pop_free (ctx->skIssue, X509_free);
-        ctx->skIssue = sk_X509_new_null();
-        if (ctx->skIssue == NULL) {
-            return UA_STATUSCODE_BADOUTOFMEMORY;
-        }
+    sk_X509_pop_free (*sk, X509_free);
+    *sk = newSk;
+    *stamp = newStamp;
+    return UA_STATUSCODE_GOOD;
+}
 
-        memcpy (folderPath, ctx->issuerListFolder.data, ctx->issuerListFolder.length);
-        folderPath[ctx->issuerListFolder.length] = 0;
-        numCertificates = scandir(folderPath, &dirlist,
-                                  UA_Certificate_Filter_der_pem,
-                                  alphasort);
-        for (i = 0; i < numCertificates; i++) {
-            if (UA_BuildFullPath (folderPath, dirlist[i]->d_name,
-                                  PATH_MAX, certFile) != UA_STATUSCODE_GOOD) {
-                continue;
-            }
-            ret = UA_loadCertFromFile (certFile, &strCert);
-            if (ret != UA_STATUSCODE_GOOD) {
-                UA_LOG_INFO (ctx->certGroup->logging, UA_LOGCATEGORY_SERVER,
-                            "Failed to load the certificate file %s", certFile);
-                continue;  /* continue or return ? */
-            }
-            if (UA_skIssuer_Cert2X509 (&strCert, 1, ctx) != UA_STATUSCODE_GOOD) {
-                UA_LOG_INFO (ctx->certGroup->logging, UA_LOGCATEGORY_SERVER,
-                            "Failed to decode the certificate file %s", certFile);
-                UA_ByteString_clear (&strCert);
-                continue;  /* continue or return ? */
-            }
-            UA_ByteString_clear (&strCert);
-        }
+/* Same as UA_ReloadCertStack for the revocation lists */
+static UA_StatusCode
+UA_ReloadCrlStack (CertContext * ctx) {
+    UA_UInt32 newStamp;
+    if (!UA_FolderChanged (ctx, &ctx->revocationListFolder, UA_Certificate_Filter_crl,
+                           ctx->revocationListStamp, &newStamp))
+        return UA_STATUSCODE_GOOD;
+
+    STACK_OF(X509_CRL) * oldCrls = ctx->skCrls;
+    ctx->skCrls = sk_X509_CRL_new_null();
+    if (ctx->skCrls == NULL) {
+        ctx->skCrls = oldCrls;
+        return UA_STATUSCODE_BADOUTOFMEMORY;
     }
 
-    if (ctx->revocationListFolder.length > 0) {
-        UA_LOG_INFO(ctx->certGroup->logging, UA_LOGCATEGORY_SERVER, "Reloading the revocation-list");
-
-        sk_X509_CRL_pop_free (ctx->skCrls, X509_CRL_free);
-        ctx->skCrls = sk_X509_CRL_new_null();
-        if (ctx->skCrls == NULL) {
-            return UA_STATUSCODE_BADOUTOFMEMORY;
-        }
+    char folderPath[PATH_MAX];
+    (void) memcpy (folderPath, ctx->revocationListFolder.data,
+                   ctx->revocationListFolder.length);
+    folderPath[ctx->revocationListFolder.length] = 0;
 
-        memcpy (folderPath, ctx->revocationListFolder.data, ctx->revocationListFolder.length);
-        folderPath[ctx->revocationListFolder.length] = 0;
-        numCertificates = scandir(folderPath, &dirlist,
+    struct dirent ** dirlist = NULL;
+    char             certFile[PATH_MAX];
+    UA_ByteString    strCert;
+    UA_StatusCode    ret = UA_STATUSCODE_GOOD;
+    UA_ByteString_init (&strCert);
+    int numCertificates = scandir(folderPath, &dirlist,
                                   UA_Certificate_Filter_crl,
                                   alphasort);
-        for (i = 0; i < numCertificates; i++) {
-            if (UA_BuildFullPath (folderPath, dirlist[i]->d_name,
-                                  PATH_MAX, certFile) != UA_STATUSCODE_GOOD) {
-                continue;
-            }
-            ret = UA_loadCertFromFile (certFile, &strCert);
-            if (ret != UA_STATUSCODE_GOOD) {
-                UA_LOG_INFO (ctx->certGroup->logging, UA_LOGCATEGORY_SERVER,
-                            "Failed to load the revocation file %s", certFile);
-                continue;  /* continue or return ? */
-            }
-            if (UA_skCrls_Cert2X509 (&strCert, 1, ctx) != UA_STATUSCODE_GOOD) {
-                UA_LOG_INFO (ctx->certGroup->logging, UA_LOGCATEGORY_SERVER,
-                            "Failed to decode the revocation file %s", certFile);
-                UA_ByteString_clear (&strCert);
-                continue;  /* continue or return ? */
-            }
-            UA_ByteString_clear (&strCert);
+    if (numCertificates < 0)
+        ret = UA_STATUSCODE_BADINTERNALERROR;
+    for (int i = 0; i < numCertificates; i++) {
+        if (UA_BuildFullPath (folderPath, dirlist[i]->d_name,
+                              PATH_MAX, certFile) != UA_STATUSCODE_GOOD) {
+            continue;
+        }
+        if (UA_loadCertFromFile (certFile, &strCert) != UA_STATUSCODE_GOOD) {
+            UA_LOG_INFO (ctx->certGroup->logging, UA_LOGCATEGORY_SERVER,
+                         "Failed to load the revocation file %s", certFile);
+            continue;
+        }
+        UA_StatusCode decodeRet = UA_skCrls_Cert2X509 (&strCert, 1, ctx);
+        UA_ByteString_clear (&strCert);
+        if (decodeRet == UA_STATUSCODE_BADOUTOFMEMORY) {
+            ret = decodeRet;
+            break;
+        }
+        if (decodeRet != UA_STATUSCODE_GOOD) {
+            UA_LOG_INFO (ctx->certGroup->logging, UA_LOGCATEGORY_SERVER,
+                         "Failed to decode the revocation file %s", certFile);
         }
     }
+    UA_FreeDirList (dirlist, numCertificates);
 
-    ret = UA_STATUSCODE_GOOD;
+    if (ret != UA_STATUSCODE_GOOD) {
+        sk_X509_CRL_pop_free (ctx->skCrls, X509_CRL_free);
+        ctx->skCrls = oldCrls;
+        return ret;
+    }
+
+    sk_X509_CRL_pop_free (oldCrls, X509_CRL_free);
+    ctx->revocationListStamp = newStamp;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+UA_ReloadCertFromFolder (CertContext * ctx) {
+    UA_StatusCode ret = UA_STATUSCODE_GOOD;
+    UA_UInt32 trustListStamp = ctx->trustListStamp;
+    UA_UInt32 issuerListStamp = ctx->issuerListStamp;
+    UA_UInt32 revocationListStamp = ctx->revocationListStamp;
+
+    if (ctx->trustListFolder.length > 0)
+        ret |= UA_ReloadCertStack (ctx, &ctx->trustListFolder,
+                                   &ctx->trustListStamp, &ctx->skTrusted);
+    if (ctx->issuerListFolder.length > 0)
+        ret |= UA_ReloadCertStack (ctx, &ctx->issuerListFolder,
+                                   &ctx->issuerListStamp, &ctx->skIssue);
+    if (ctx->revocationListFolder.length > 0)
+        ret |= UA_ReloadCrlStack (ctx);
+
+    if (!ctx->folderLoaded ||
+        trustListStamp != ctx->trustListStamp ||
+        issuerListStamp != ctx->issuerListStamp ||
+        revocationListStamp != ctx->revocationListStamp)
+        UA_CertContext_newGeneration (ctx);
+
+    /* Retry with the next verification. The previous lists are kept until
+     * then. */
+    ctx->folderLoaded = (ret == UA_STATUSCODE_GOOD);
+    if (ret != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING (ctx->certGroup->logging, UA_LOGCATEGORY_SERVER,
+                        "Reloading the PKI folders failed. "
+                        "Keeping the previous lists.");
+    }
     return ret;
 }
 
+/* Reload the folders if they have changed. The check is rate-limited by the
+ * configured reloadCheckInterval. */
+static UA_StatusCode
+UA_ReloadCertFromFolderIfChanged (CertContext * ctx) {
+    if (ctx->trustListFolder.length == 0 &&
+        ctx->issuerListFolder.length == 0 &&
+        ctx->revocationListFolder.length == 0)
+        return UA_STATUSCODE_GOOD;
+
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    if (ctx->folderLoaded && ctx->reloadCheckInterval > 0 &&
+        now - ctx->lastReloadCheck < ctx->reloadCheckInterval)
+        return UA_STATUSCODE_GOOD;
+    ctx->lastReloadCheck = now;
+    return UA_ReloadCertFromFolder (ctx);
+}
+
 #endif  /* end of __linux__ */
 
 static UA_StatusCode
@@ -447,26 +684,21 @@ UA_CertificateGroup_Verify(UA_CertificateGroup *certGroup,
                            const UA_ByteString *certificate) {
     X509_STORE_CTX *storeCtx = NULL;
     X509_STORE *store = NULL;
+    X509 *certificateX509 = NULL;
     CertContext *ctx = NULL;
     UA_StatusCode ret = UA_STATUSCODE_GOOD;
+    UA_Byte thumbprint[SHA_DIGEST_LENGTH];
 
     if ((certGroup == NULL) || (certGroup->context == NULL)) {
         return UA_STATUSCODE_BADINTERNALERROR;
     }
     ctx = (CertContext *) certGroup->context;
 
-    /* Parse the certificate */
-    X509 *certificateX509 = UA_OpenSSL_LoadCertificate(certificate);
-    if(!certificateX509) {
-        ret = UA_STATUSCODE_BADCERTIFICATEINVALID;
-        goto cleanup;
-    }
-
-    /* Reload PKI folder */
+    /* Reload PKI folder if its content has changed */
 #ifdef __linux__
-    ret = UA_ReloadCertFromFolder (ctx);
+    ret = UA_ReloadCertFromFolderIfChanged (ctx);
     if(ret != UA_STATUSCODE_GOOD)
-        goto cleanup;
+        return ret;
 #endif
 
     /* Accept the certificate without verification of no trust and issuer list
@@ -476,12 +708,28 @@ UA_CertificateGroup_Verify(UA_CertificateGroup *certGroup,
        sk_X509_num(ctx->skTrusted) == 0) {
         UA_LOG_WARNING(certGroup->logging, UA_LOGCATEGORY_USERLAND,
                        "No certificate store configured. Accepting the certificate.");
-        goto cleanup;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Use the cached result if the certificate was verified before with the
+     * current trust store */
+    SHA1(certificate->data, certificate->length, thumbprint);
+    if(UA_CertCache_lookup(ctx, thumbprint)) {
+        UA_LOG_DEBUG(certGroup->logging, UA_LOGCATEGORY_SECURITYPOLICY,
+                     "Using the cached certificate verification result");
+        return UA_STATUSCODE_GOOD;
     }
 
-    store = X509_STORE_new();
+    /* Parse the certificate */
+    certificateX509 = UA_OpenSSL_LoadCertificate(certificate);
+    if(!certificateX509)
+        return UA_STATUSCODE_BADCERTIFICATEINVALID;
+
+    /* The store is persistent in the context. The trusted certificates, the
+     * issuers and the crls are set for each verification. */
+    store = ctx->store;
     storeCtx = X509_STORE_CTX_new();
-    if(store == NULL || storeCtx == NULL) {
+    if(storeCtx == NULL) {
         ret = UA_STATUSCODE_BADOUTOFMEMORY;
         goto cleanup;
     }
@@ -517,7 +765,8 @@ UA_CertificateGroup_Verify(UA_CertificateGroup *certGroup,
      * CTT/Security/Security Certificate Validation/029.js for more details */
      /** \todo Can the ca-parameter of X509_check_purpose can be used? */
     if(X509_check_purpose(certificateX509, X509_PURPOSE_CRL_SIGN, 0) && X509_check_ca(certificateX509)) {
-        return UA_STATUSCODE_BADCERTIFICATEUSENOTALLOWED;
+        ret = UA_STATUSCODE_BADCERTIFICATEUSENOTALLOWED;
+        goto cleanup;
     }
 
     opensslRet = X509_verify_cert (storeCtx);
@@ -592,12 +841,11 @@ UA_CertificateGroup_Verify(UA_CertificateGroup *certGroup,
     }
 
 cleanup:
-    if(store)
-        X509_STORE_free(store);
+    if(ret == UA_STATUSCODE_GOOD)
+        UA_CertCache_store(ctx, thumbprint, certificateX509);
     if(storeCtx)
         X509_STORE_CTX_free(storeCtx);
-    if(certificateX509)
-        X509_free(certificateX509);
+    X509_free(certificateX509);
     return ret;
 }
 
@@ -667,6 +915,7 @@ UA_CertificateVerification_Trustlist(UA_CertificateGroup *certGroup,
         }
     }
 
+    UA_CertContext_newGeneration (context);
     return UA_STATUSCODE_GOOD;
 
 errout:
@@ -674,6 +923,23 @@ errout:
     return ret;
 }
 
+UA_StatusCode
+UA_CertificateVerification_setVerificationCacheMaxAge(UA_CertificateGroup *certGroup,
+                                                      UA_Double maxAge) {
+    if (certGroup == NULL || certGroup->context == NULL ||
+        certGroup->verifyCertificate != UA_CertificateGroup_Verify) {
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    if (maxAge < 0.0) {
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    }
+    CertContext * context = (CertContext *) certGroup->context;
+    context->cacheMaxAge = (UA_DateTime) (maxAge * UA_DATETIME_MSEC);
+    /* Drop the cached results */
+    context->generation++;
+    return UA_STATUSCODE_GOOD;
+}
+
 #ifdef __linux__ /* Linux only so far */
 UA_StatusCode
 UA_CertificateVerification_CertFolders(UA_CertificateGroup *certGroup,
@@ -718,6 +984,21 @@ UA_CertificateVerification_CertFolders(UA_CertificateGroup *certGroup,
 
     return UA_STATUSCODE_GOOD;
 }
+
+UA_StatusCode
+UA_CertificateVerification_setFolderCheckInterval(UA_CertificateGroup *certGroup,
+                                                  UA_Double interval) {
+    if (certGroup == NULL || certGroup->context == NULL ||
+        certGroup->verifyCertificate != UA_CertificateGroup_Verify) {
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    if (interval < 0.0) {
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    }
+    CertContext * context = (CertContext *) certGroup->context;
+    context->reloadCheckInterval = (UA_DateTime) (interval * UA_DATETIME_MSEC);
+    return UA_STATUSCODE_GOOD;
+}
 #endif
 
 static int
@@ -804,24 +1085,8 @@ UA_CertificateUtils_getExpirationDate(UA_ByteString *certificate,
     }
 
     /* Get the certificate Expiry date */
-    ASN1_TIME *not_after = X509_get_notAfter(x509);
-
-    struct tm dtTime;
-    ASN1_TIME_to_tm(not_after, &dtTime);
+    *expiryDateTime = UA_ASN1_TIME_toDateTime(X509_get_notAfter(x509));
     X509_free(x509);
-
-    struct mytm dateTime;
-    memset(&dateTime, 0, sizeof(struct mytm));
-    dateTime.tm_year = dtTime.tm_year;
-    dateTime.tm_mon = dtTime.tm_mon;
-    dateTime.tm_mday = dtTime.tm_mday;
-    dateTime.tm_hour = dtTime.tm_hour;
-    dateTime.tm_min = dtTime.tm_min;
-    dateTime.tm_sec = dtTime.tm_sec;
-
-    long long sec_epoch = __tm_to_secs(&dateTime);
-    *expiryDateTime = UA_DATETIME_UNIX_EPOCH;
-    *expiryDateTime += sec_epoch * UA_DATETIME_SEC;
     return UA_STATUSCODE_GOOD;
 }
 
@@ -851,8 +1116,9 @@ UA_CertificateUtils_decryptPrivateKey(const UA_ByteString privateKey,
         return UA_STATUSCODE_BADINVALIDARGUMENT;
     }
 
-    /* Already in DER format -> return verbatim */
-    if(privateKey.length > 1 && privateKey.data[0] == 0x30 && privateKey.data[1] == 0x82)
+    /* Already in DER format -> return verbatim. The short length form is used
+     * for ECC keys. PEM starts with a dash. */
+    if(privateKey.length > 1 && privateKey.data[0] == 0x30)
         return UA_ByteString_copy(&privateKey, outDerKey);
 
     /* Decrypt */
@@ -35,11 +35,8 @@ typedef struct {
 } Policy_Context_Aes128Sha256RsaOaep;
 
 typedef struct {
-    UA_ByteString localSymSigningKey;
-    UA_ByteString localSymEncryptingKey;
+    UA_OpenSSL_SymmetricContext symCtx; /* Keyed cipher and HMAC contexts */
     UA_ByteString localSymIv;
-    UA_ByteString remoteSymSigningKey;
-    UA_ByteString remoteSymEncryptingKey;
     UA_ByteString remoteSymIv;
 
     Policy_Context_Aes128Sha256RsaOaep *policyContext;
@@ -169,11 +166,8 @@ UA_ChannelModule_Aes128Sha256RsaOaep_New_Context(const UA_SecurityPolicy *securi
         return UA_STATUSCODE_BADOUTOFMEMORY;
     }
 
-    UA_ByteString_init(&context->localSymSigningKey);
-    UA_ByteString_init(&context->localSymEncryptingKey);
+    UA_OpenSSL_SymmetricContext_init(&context->symCtx);
     UA_ByteString_init(&context->localSymIv);
-    UA_ByteString_init(&context->remoteSymSigningKey);
-    UA_ByteString_init(&context->remoteSymEncryptingKey);
     UA_ByteString_init(&context->remoteSymIv);
 
     UA_StatusCode retval =
@@ -212,11 +206,8 @@ UA_ChannelModule_Aes128Sha256RsaOaep_Delete_Context(void *channelContext) {
             (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
         X509_free(cc->remoteCertificateX509);
         UA_ByteString_clear(&cc->remoteCertificate);
-        UA_ByteString_clear(&cc->localSymSigningKey);
-        UA_ByteString_clear(&cc->localSymEncryptingKey);
+        UA_OpenSSL_SymmetricContext_clear(&cc->symCtx);
         UA_ByteString_clear(&cc->localSymIv);
-        UA_ByteString_clear(&cc->remoteSymSigningKey);
-        UA_ByteString_clear(&cc->remoteSymEncryptingKey);
         UA_ByteString_clear(&cc->remoteSymIv);
 
         UA_LOG_INFO(
@@ -376,8 +367,7 @@ UA_ChannelModule_Aes128Sha256RsaOaep_setLocalSymSigningKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
-    UA_ByteString_clear(&cc->localSymSigningKey);
-    return UA_ByteString_copy(key, &cc->localSymSigningKey);
+    return UA_OpenSSL_SymmetricContext_setSigningKey(&cc->symCtx, EVP_sha256(), key);
 }
 
 static UA_StatusCode
@@ -387,8 +377,7 @@ UA_ChannelM_Aes128Sha256RsaOaep_setLocalSymEncryptingKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
-    UA_ByteString_clear(&cc->localSymEncryptingKey);
-    return UA_ByteString_copy(key, &cc->localSymEncryptingKey);
+    return UA_OpenSSL_SymmetricContext_setEncryptingKey(&cc->symCtx, EVP_aes_128_cbc(), key);
 }
 
 static UA_StatusCode
@@ -426,8 +415,7 @@ UA_ChannelM_Aes128Sha256RsaOaep_setRemoteSymSigningKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
-    UA_ByteString_clear(&cc->remoteSymSigningKey);
-    return UA_ByteString_copy(key, &cc->remoteSymSigningKey);
+    return UA_OpenSSL_SymmetricContext_setVerifyingKey(&cc->symCtx, EVP_sha256(), key);
 }
 
 static UA_StatusCode
@@ -437,8 +425,7 @@ UA_ChannelM_Aes128Sha256RsaOaep_setRemoteSymEncryptingKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
-    UA_ByteString_clear(&cc->remoteSymEncryptingKey);
-    return UA_ByteString_copy(key, &cc->remoteSymEncryptingKey);
+    return UA_OpenSSL_SymmetricContext_setDecryptingKey(&cc->symCtx, EVP_aes_128_cbc(), key);
 }
 
 static UA_StatusCode
@@ -487,7 +474,7 @@ UA_SymSig_Aes128Sha256RsaOaep_verify(void *channelContext, const UA_ByteString *
 
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Verify(message, &cc->remoteSymSigningKey, signature);
+    return UA_OpenSSL_SymmetricContext_verify(&cc->symCtx, message, signature);
 }
 
 static UA_StatusCode
@@ -499,7 +486,7 @@ UA_SymSig_Aes128Sha256RsaOaep_sign(void *channelContext, const UA_ByteString *me
 
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Sign(message, &cc->localSymSigningKey, signature);
+    return UA_OpenSSL_SymmetricContext_sign(&cc->symCtx, message, signature);
 }
 
 static size_t
@@ -513,8 +500,7 @@ UA_SymEn_Aes128Sha256RsaOaep_decrypt(void *channelContext, UA_ByteString *data)
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
-    return UA_OpenSSL_AES_128_CBC_Decrypt(&cc->remoteSymIv, &cc->remoteSymEncryptingKey,
-                                          data);
+    return UA_OpenSSL_SymmetricContext_decrypt(&cc->symCtx, &cc->remoteSymIv, data);
 }
 
 static UA_StatusCode
@@ -524,8 +510,18 @@ UA_SymEn_Aes128Sha256RsaOaep_encrypt(void *channelContext, UA_ByteString *data)
 
     Channel_Context_Aes128Sha256RsaOaep *cc =
         (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
-    return UA_OpenSSL_AES_128_CBC_Encrypt(&cc->localSymIv, &cc->localSymEncryptingKey,
-                                          data);
+    return UA_OpenSSL_SymmetricContext_encrypt(&cc->symCtx, &cc->localSymIv, data);
+}
+
+static UA_StatusCode
+UA_SymSigEn_Aes128Sha256RsaOaep_signAndEncrypt(void *channelContext, UA_ByteString *chunk,
+                                               size_t encryptOffset, size_t signatureOffset) {
+    if(channelContext == NULL || chunk == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    Channel_Context_Aes128Sha256RsaOaep *cc = (Channel_Context_Aes128Sha256RsaOaep *)channelContext;
+    return UA_OpenSSL_SymmetricContext_signAndEncrypt(&cc->symCtx, &cc->localSymIv, chunk,
+                                                      encryptOffset, signatureOffset);
 }
 
 static UA_StatusCode
@@ -636,6 +632,7 @@ UA_SecurityPolicy_Aes128Sha256RsaOaep(UA_SecurityPolicy *policy,
     symmetricModule->secureChannelNonceLength = 32;
     symmetricModule->generateNonce = UA_Sym_Aes128Sha256RsaOaep_generateNonce;
     symmetricModule->generateKey = UA_Sym_Aes128Sha256RsaOaep_generateKey;
+    symmetricModule->signAndEncrypt = UA_SymSigEn_Aes128Sha256RsaOaep_signAndEncrypt;
 
     /* Symmetric encryption Algorithm */
 
@@ -35,11 +35,8 @@ typedef struct {
 } Policy_Context_Aes256Sha256RsaPss;
 
 typedef struct {
-    UA_ByteString localSymSigningKey;
-    UA_ByteString localSymEncryptingKey;
+    UA_OpenSSL_SymmetricContext symCtx; /* Keyed cipher and HMAC contexts */
     UA_ByteString localSymIv;
-    UA_ByteString remoteSymSigningKey;
-    UA_ByteString remoteSymEncryptingKey;
     UA_ByteString remoteSymIv;
 
     Policy_Context_Aes256Sha256RsaPss *policyContext;
@@ -120,11 +117,8 @@ UA_ChannelModule_Aes256Sha256RsaPss_New_Context(const UA_SecurityPolicy *securit
         return UA_STATUSCODE_BADOUTOFMEMORY;
     }
 
-    UA_ByteString_init(&context->localSymSigningKey);
-    UA_ByteString_init(&context->localSymEncryptingKey);
+    UA_OpenSSL_SymmetricContext_init(&context->symCtx);
     UA_ByteString_init(&context->localSymIv);
-    UA_ByteString_init(&context->remoteSymSigningKey);
-    UA_ByteString_init(&context->remoteSymEncryptingKey);
     UA_ByteString_init(&context->remoteSymIv);
 
     UA_StatusCode retval =
@@ -163,11 +157,8 @@ UA_ChannelModule_Aes256Sha256RsaPss_Delete_Context(void *channelContext) {
             (Channel_Context_Aes256Sha256RsaPss *)channelContext;
         X509_free(cc->remoteCertificateX509);
         UA_ByteString_clear(&cc->remoteCertificate);
-        UA_ByteString_clear(&cc->localSymSigningKey);
-        UA_ByteString_clear(&cc->localSymEncryptingKey);
+        UA_OpenSSL_SymmetricContext_clear(&cc->symCtx);
         UA_ByteString_clear(&cc->localSymIv);
-        UA_ByteString_clear(&cc->remoteSymSigningKey);
-        UA_ByteString_clear(&cc->remoteSymEncryptingKey);
         UA_ByteString_clear(&cc->remoteSymIv);
 
         UA_LOG_INFO(
@@ -376,8 +367,7 @@ UA_ChannelModule_Aes256Sha256RsaPss_setLocalSymSigningKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
-    UA_ByteString_clear(&cc->localSymSigningKey);
-    return UA_ByteString_copy(key, &cc->localSymSigningKey);
+    return UA_OpenSSL_SymmetricContext_setSigningKey(&cc->symCtx, EVP_sha256(), key);
 }
 
 static UA_StatusCode
@@ -387,8 +377,7 @@ UA_ChannelM_Aes256Sha256RsaPss_setLocalSymEncryptingKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
-    UA_ByteString_clear(&cc->localSymEncryptingKey);
-    return UA_ByteString_copy(key, &cc->localSymEncryptingKey);
+    return UA_OpenSSL_SymmetricContext_setEncryptingKey(&cc->symCtx, EVP_aes_256_cbc(), key);
 }
 
 static UA_StatusCode
@@ -426,8 +415,7 @@ UA_ChannelM_Aes256Sha256RsaPss_setRemoteSymSigningKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
-    UA_ByteString_clear(&cc->remoteSymSigningKey);
-    return UA_ByteString_copy(key, &cc->remoteSymSigningKey);
+    return UA_OpenSSL_SymmetricContext_setVerifyingKey(&cc->symCtx, EVP_sha256(), key);
 }
 
 static UA_StatusCode
@@ -437,8 +425,7 @@ UA_ChannelM_Aes256Sha256RsaPss_setRemoteSymEncryptingKey(void *channelContext,
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
-    UA_ByteString_clear(&cc->remoteSymEncryptingKey);
-    return UA_ByteString_copy(key, &cc->remoteSymEncryptingKey);
+    return UA_OpenSSL_SymmetricContext_setDecryptingKey(&cc->symCtx, EVP_aes_256_cbc(), key);
 }
 
 static UA_StatusCode
@@ -489,7 +476,7 @@ UA_SymSig_Aes256Sha256RsaPss_verify(void *channelContext, const UA_ByteString *m
 
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Verify(message, &cc->remoteSymSigningKey, signature);
+    return UA_OpenSSL_SymmetricContext_verify(&cc->symCtx, message, signature);
 }
 
 static UA_StatusCode
@@ -501,7 +488,7 @@ UA_SymSig_Aes256Sha256RsaPss_sign(void *channelContext, const UA_ByteString *mes
 
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Sign(message, &cc->localSymSigningKey, signature);
+    return UA_OpenSSL_SymmetricContext_sign(&cc->symCtx, message, signature);
 }
 
 static size_t
@@ -515,8 +502,7 @@ UA_SymEn_Aes256Sha256RsaPss_decrypt(void *channelContext, UA_ByteString *data) {
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
-    return UA_OpenSSL_AES_256_CBC_Decrypt(&cc->remoteSymIv, &cc->remoteSymEncryptingKey,
-                                          data);
+    return UA_OpenSSL_SymmetricContext_decrypt(&cc->symCtx, &cc->remoteSymIv, data);
 }
 
 static UA_StatusCode
@@ -526,8 +512,18 @@ UA_SymEn_Aes256Sha256RsaPss_encrypt(void *channelContext, UA_ByteString *data) {
 
     Channel_Context_Aes256Sha256RsaPss *cc =
         (Channel_Context_Aes256Sha256RsaPss *)channelContext;
-    return UA_OpenSSL_AES_256_CBC_Encrypt(&cc->localSymIv, &cc->localSymEncryptingKey,
-                                          data);
+    return UA_OpenSSL_SymmetricContext_encrypt(&cc->symCtx, &cc->localSymIv, data);
+}
+
+static UA_StatusCode
+UA_SymSigEn_Aes256Sha256RsaPss_signAndEncrypt(void *channelContext, UA_ByteString *chunk,
+                                              size_t encryptOffset, size_t signatureOffset) {
+    if(channelContext == NULL || chunk == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    Channel_Context_Aes256Sha256RsaPss *cc = (Channel_Context_Aes256Sha256RsaPss *)channelContext;
+    return UA_OpenSSL_SymmetricContext_signAndEncrypt(&cc->symCtx, &cc->localSymIv, chunk,
+                                                      encryptOffset, signatureOffset);
 }
 
 static UA_StatusCode
@@ -640,6 +636,7 @@ UA_SecurityPolicy_Aes256Sha256RsaPss(UA_SecurityPolicy *policy,
     symmetricModule->secureChannelNonceLength = 32;
     symmetricModule->generateNonce = UA_Sym_Aes256Sha256RsaPss_generateNonce;
     symmetricModule->generateKey = UA_Sym_Aes256Sha256RsaPss_generateKey;
+    symmetricModule->signAndEncrypt = UA_SymSigEn_Aes256Sha256RsaPss_signAndEncrypt;
 
     /* Symmetric encryption Algorithm */
 
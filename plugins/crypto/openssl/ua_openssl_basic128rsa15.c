@@ -31,11 +31,8 @@ typedef struct {
 } Policy_Context_Basic128Rsa15;
 
 typedef struct {
-    UA_ByteString             localSymSigningKey;
-    UA_ByteString             localSymEncryptingKey;
+    UA_OpenSSL_SymmetricContext symCtx; /* Keyed cipher and HMAC contexts */
     UA_ByteString             localSymIv;
-    UA_ByteString             remoteSymSigningKey;
-    UA_ByteString             remoteSymEncryptingKey;
     UA_ByteString             remoteSymIv;
 
     Policy_Context_Basic128Rsa15 * policyContext;
@@ -162,11 +159,8 @@ UA_ChannelModule_Basic128Rsa15_New_Context (const UA_SecurityPolicy * securityPo
         return UA_STATUSCODE_BADOUTOFMEMORY;
     }
 
-    UA_ByteString_init(&context->localSymSigningKey);
-    UA_ByteString_init(&context->localSymEncryptingKey);
+    UA_OpenSSL_SymmetricContext_init(&context->symCtx);
     UA_ByteString_init(&context->localSymIv);
-    UA_ByteString_init(&context->remoteSymSigningKey);
-    UA_ByteString_init(&context->remoteSymEncryptingKey);
     UA_ByteString_init(&context->remoteSymIv);
 
     UA_StatusCode retval = UA_copyCertificate (&context->remoteCertificate,
@@ -205,11 +199,8 @@ UA_ChannelModule_Basic128Rsa15_Delete_Context (void * channelContext) {
                                               channelContext;
         X509_free (cc->remoteCertificateX509);
         UA_ByteString_clear (&cc->remoteCertificate);
-        UA_ByteString_clear (&cc->localSymSigningKey);
-        UA_ByteString_clear (&cc->localSymEncryptingKey);
+        UA_OpenSSL_SymmetricContext_clear (&cc->symCtx);
         UA_ByteString_clear (&cc->localSymIv);
-        UA_ByteString_clear (&cc->remoteSymSigningKey);
-        UA_ByteString_clear (&cc->remoteSymEncryptingKey);
         UA_ByteString_clear (&cc->remoteSymIv);
         UA_LOG_INFO (cc->policyContext->logger,
                  UA_LOGCATEGORY_SECURITYPOLICY,
@@ -227,8 +218,7 @@ UA_ChannelModule_Basic128Rsa15_setLocalSymSigningKey (void *                chan
     }
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
-    UA_ByteString_clear(&cc->localSymSigningKey);
-    return UA_ByteString_copy(key, &cc->localSymSigningKey);
+    return UA_OpenSSL_SymmetricContext_setSigningKey(&cc->symCtx, EVP_sha1(), key);
 }
 
 static UA_StatusCode
@@ -239,8 +229,7 @@ UA_ChannelModule_Basic128Rsa15_setLocalSymEncryptingKey (void *                c
     }
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
-    UA_ByteString_clear(&cc->localSymEncryptingKey);
-    return UA_ByteString_copy(key, &cc->localSymEncryptingKey);
+    return UA_OpenSSL_SymmetricContext_setEncryptingKey(&cc->symCtx, EVP_aes_128_cbc(), key);
 }
 
 static UA_StatusCode
@@ -263,8 +252,7 @@ UA_ChannelModule_Basic128Rsa15_setRemoteSymSigningKey (void *                cha
     }
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
-    UA_ByteString_clear(&cc->remoteSymSigningKey);
-    return UA_ByteString_copy(key, &cc->remoteSymSigningKey);
+    return UA_OpenSSL_SymmetricContext_setVerifyingKey(&cc->symCtx, EVP_sha1(), key);
 }
 
 static UA_StatusCode
@@ -275,8 +263,7 @@ UA_ChannelModule_Basic128Rsa15_setRemoteSymEncryptingKey (void *
     }
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
-    UA_ByteString_clear(&cc->remoteSymEncryptingKey);
-    return UA_ByteString_copy(key, &cc->remoteSymEncryptingKey);
+    return UA_OpenSSL_SymmetricContext_setDecryptingKey(&cc->symCtx, EVP_aes_128_cbc(), key);
 }
 
 static UA_StatusCode
@@ -495,7 +482,18 @@ UA_SymEn_Basic128Rsa15_Encrypt (void *channelContext,
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
-    return UA_OpenSSL_AES_128_CBC_Encrypt (&cc->localSymIv, &cc->localSymEncryptingKey, data);
+    return UA_OpenSSL_SymmetricContext_encrypt(&cc->symCtx, &cc->localSymIv, data);
+}
+
+static UA_StatusCode
+UA_SymSigEn_Basic128Rsa15_signAndEncrypt(void *channelContext, UA_ByteString *chunk,
+                                         size_t encryptOffset, size_t signatureOffset) {
+    if(channelContext == NULL || chunk == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    Channel_Context_Basic128Rsa15 *cc = (Channel_Context_Basic128Rsa15 *)channelContext;
+    return UA_OpenSSL_SymmetricContext_signAndEncrypt(&cc->symCtx, &cc->localSymIv, chunk,
+                                                      encryptOffset, signatureOffset);
 }
 
 static UA_StatusCode
@@ -504,7 +502,7 @@ UA_SymEn_Basic128Rsa15_Decrypt (void *                    channelContext,
     if(channelContext == NULL || data == NULL)
         return UA_STATUSCODE_BADINVALIDARGUMENT;
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
-    return UA_OpenSSL_AES_128_CBC_Decrypt (&cc->remoteSymIv, &cc->remoteSymEncryptingKey, data);
+    return UA_OpenSSL_SymmetricContext_decrypt(&cc->symCtx, &cc->remoteSymIv, data);
 }
 
 static size_t
@@ -525,9 +523,7 @@ UA_SymSig_Basic128Rsa15_Verify (void *                    channelContext,
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
-    return UA_OpenSSL_HMAC_SHA1_Verify (message,
-                                        &cc->remoteSymSigningKey,
-                                        signature);
+    return UA_OpenSSL_SymmetricContext_verify(&cc->symCtx, message, signature);
 }
 
 static UA_StatusCode
@@ -538,7 +534,7 @@ UA_SymSig_Basic128Rsa15_Sign (void *                    channelContext,
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
     Channel_Context_Basic128Rsa15 * cc = (Channel_Context_Basic128Rsa15 *) channelContext;
-    return UA_OpenSSL_HMAC_SHA1_Sign (message, &cc->localSymSigningKey, signature);
+    return UA_OpenSSL_SymmetricContext_sign(&cc->symCtx, message, signature);
 }
 
 /* the main entry of Basic128Rsa15 */
@@ -615,6 +611,7 @@ UA_SecurityPolicy_Basic128Rsa15 (UA_SecurityPolicy * policy,
     symmetricModule->secureChannelNonceLength = 16;  /* 128 bits*/
     symmetricModule->generateNonce = UA_Sym_Basic128Rsa15_generateNonce;
     symmetricModule->generateKey = UA_Sym_Basic128Rsa15_generateKey;
+    symmetricModule->signAndEncrypt = UA_SymSigEn_Basic128Rsa15_signAndEncrypt;
 
     /* Symmetric encryption Algorithm */
 
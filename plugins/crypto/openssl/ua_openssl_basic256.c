@@ -29,11 +29,8 @@ typedef struct {
 } Policy_Context_Basic256;
 
 typedef struct {
-    UA_ByteString             localSymSigningKey;
-    UA_ByteString             localSymEncryptingKey;
+    UA_OpenSSL_SymmetricContext symCtx; /* Keyed cipher and HMAC contexts */
     UA_ByteString             localSymIv;
-    UA_ByteString             remoteSymSigningKey;
-    UA_ByteString             remoteSymEncryptingKey;
     UA_ByteString             remoteSymIv;
 
     Policy_Context_Basic256 * policyContext;
@@ -160,11 +157,8 @@ UA_ChannelModule_Basic256_New_Context (const UA_SecurityPolicy * securityPolicy,
         return UA_STATUSCODE_BADOUTOFMEMORY;
     }
 
-    UA_ByteString_init(&context->localSymSigningKey);
-    UA_ByteString_init(&context->localSymEncryptingKey);
+    UA_OpenSSL_SymmetricContext_init(&context->symCtx);
     UA_ByteString_init(&context->localSymIv);
-    UA_ByteString_init(&context->remoteSymSigningKey);
-    UA_ByteString_init(&context->remoteSymEncryptingKey);
     UA_ByteString_init(&context->remoteSymIv);
 
     UA_StatusCode retval = UA_copyCertificate (&context->remoteCertificate,
@@ -203,11 +197,8 @@ UA_ChannelModule_Basic256_Delete_Context (void * channelContext) {
                                            channelContext;
         X509_free (cc->remoteCertificateX509);
         UA_ByteString_clear (&cc->remoteCertificate);
-        UA_ByteString_clear (&cc->localSymSigningKey);
-        UA_ByteString_clear (&cc->localSymEncryptingKey);
+        UA_OpenSSL_SymmetricContext_clear (&cc->symCtx);
         UA_ByteString_clear (&cc->localSymIv);
-        UA_ByteString_clear (&cc->remoteSymSigningKey);
-        UA_ByteString_clear (&cc->remoteSymEncryptingKey);
         UA_ByteString_clear (&cc->remoteSymIv);
         UA_LOG_INFO (cc->policyContext->logger,
                  UA_LOGCATEGORY_SECURITYPOLICY,
@@ -253,8 +244,7 @@ UA_ChannelModule_Basic256_setLocalSymSigningKey (void *                channelCo
     }
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
-    UA_ByteString_clear(&cc->localSymSigningKey);
-    return UA_ByteString_copy(key, &cc->localSymSigningKey);
+    return UA_OpenSSL_SymmetricContext_setSigningKey(&cc->symCtx, EVP_sha1(), key);
 }
 
 static UA_StatusCode
@@ -265,8 +255,7 @@ UA_ChannelModule_Basic256_setLocalSymEncryptingKey (void *                channe
     }
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
-    UA_ByteString_clear(&cc->localSymEncryptingKey);
-    return UA_ByteString_copy(key, &cc->localSymEncryptingKey);
+    return UA_OpenSSL_SymmetricContext_setEncryptingKey(&cc->symCtx, EVP_aes_256_cbc(), key);
 }
 
 static UA_StatusCode
@@ -289,8 +278,7 @@ UA_ChannelModule_Basic256_setRemoteSymSigningKey (void *                channelC
     }
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
-    UA_ByteString_clear(&cc->remoteSymSigningKey);
-    return UA_ByteString_copy(key, &cc->remoteSymSigningKey);
+    return UA_OpenSSL_SymmetricContext_setVerifyingKey(&cc->symCtx, EVP_sha1(), key);
 }
 
 static UA_StatusCode
@@ -301,8 +289,7 @@ UA_ChannelModule_Basic256_setRemoteSymEncryptingKey (void *                chann
     }
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
-    UA_ByteString_clear(&cc->remoteSymEncryptingKey);
-    return UA_ByteString_copy(key, &cc->remoteSymEncryptingKey);
+    return UA_OpenSSL_SymmetricContext_setDecryptingKey(&cc->symCtx, EVP_aes_256_cbc(), key);
 }
 
 static UA_StatusCode
@@ -496,7 +483,18 @@ UA_SymEn_Basic256_Encrypt (void *                    channelContext,
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
-    return UA_OpenSSL_AES_256_CBC_Encrypt (&cc->localSymIv, &cc->localSymEncryptingKey, data);
+    return UA_OpenSSL_SymmetricContext_encrypt(&cc->symCtx, &cc->localSymIv, data);
+}
+
+static UA_StatusCode
+UA_SymSigEn_Basic256_signAndEncrypt(void *channelContext, UA_ByteString *chunk,
+                                    size_t encryptOffset, size_t signatureOffset) {
+    if(channelContext == NULL || chunk == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    Channel_Context_Basic256 *cc = (Channel_Context_Basic256 *)channelContext;
+    return UA_OpenSSL_SymmetricContext_signAndEncrypt(&cc->symCtx, &cc->localSymIv, chunk,
+                                                      encryptOffset, signatureOffset);
 }
 
 static UA_StatusCode
@@ -505,7 +503,7 @@ UA_SymEn_Basic256_Decrypt (void *                    channelContext,
     if(channelContext == NULL || data == NULL)
         return UA_STATUSCODE_BADINVALIDARGUMENT;
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
-    return UA_OpenSSL_AES_256_CBC_Decrypt (&cc->remoteSymIv, &cc->remoteSymEncryptingKey, data);
+    return UA_OpenSSL_SymmetricContext_decrypt(&cc->symCtx, &cc->remoteSymIv, data);
 }
 
 static size_t
@@ -527,9 +525,7 @@ UA_SymSig_Basic256_Verify (void *                    channelContext,
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
-    return UA_OpenSSL_HMAC_SHA1_Verify (message,
-                                        &cc->remoteSymSigningKey,
-                                        signature);
+    return UA_OpenSSL_SymmetricContext_verify(&cc->symCtx, message, signature);
 }
 
 static UA_StatusCode
@@ -540,7 +536,7 @@ UA_SymSig_Basic256_Sign (void *                    channelContext,
         return UA_STATUSCODE_BADINVALIDARGUMENT;
 
     Channel_Context_Basic256 * cc = (Channel_Context_Basic256 *) channelContext;
-    return UA_OpenSSL_HMAC_SHA1_Sign (message, &cc->localSymSigningKey, signature);
+    return UA_OpenSSL_SymmetricContext_sign(&cc->symCtx, message, signature);
 }
 
 /* the main entry of Basic256 */
@@ -616,6 +612,7 @@ UA_SecurityPolicy_Basic256 (UA_SecurityPolicy * policy,
     symmetricModule->secureChannelNonceLength = 32;
     symmetricModule->generateNonce = UA_Sym_Basic256_generateNonce;
     symmetricModule->generateKey = UA_Sym_Basic256_generateKey;
+    symmetricModule->signAndEncrypt = UA_SymSigEn_Basic256_signAndEncrypt;
 
     /* Symmetric encryption Algorithm */
 
@@ -36,11 +36,8 @@ typedef struct {
 } Policy_Context_Basic256Sha256;
 
 typedef struct {
-    UA_ByteString localSymSigningKey;
-    UA_ByteString localSymEncryptingKey;
+    UA_OpenSSL_SymmetricContext symCtx; /* Keyed cipher and HMAC contexts */
     UA_ByteString localSymIv;
-    UA_ByteString remoteSymSigningKey;
-    UA_ByteString remoteSymEncryptingKey;
     UA_ByteString remoteSymIv;
 
     Policy_Context_Basic256Sha256 *policyContext;
@@ -159,11 +156,8 @@ UA_ChannelModule_New_Context(const UA_SecurityPolicy * securityPolicy,
     if(context == NULL)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
-    UA_ByteString_init(&context->localSymSigningKey);
-    UA_ByteString_init(&context->localSymEncryptingKey);
+    UA_OpenSSL_SymmetricContext_init(&context->symCtx);
     UA_ByteString_init(&context->localSymIv);
-    UA_ByteString_init(&context->remoteSymSigningKey);
-    UA_ByteString_init(&context->remoteSymEncryptingKey);
     UA_ByteString_init(&context->remoteSymIv);
 
     UA_StatusCode retval =
@@ -201,11 +195,8 @@ UA_ChannelModule_Delete_Context(void * channelContext) {
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *)channelContext;
     X509_free(cc->remoteCertificateX509);
     UA_ByteString_clear(&cc->remoteCertificate);
-    UA_ByteString_clear(&cc->localSymSigningKey);
-    UA_ByteString_clear(&cc->localSymEncryptingKey);
+    UA_OpenSSL_SymmetricContext_clear(&cc->symCtx);
     UA_ByteString_clear(&cc->localSymIv);
-    UA_ByteString_clear(&cc->remoteSymSigningKey);
-    UA_ByteString_clear(&cc->remoteSymEncryptingKey);
     UA_ByteString_clear(&cc->remoteSymIv);
 
     UA_LOG_INFO(cc->policyContext->logger, UA_LOGCATEGORY_SECURITYPOLICY,
@@ -359,8 +350,7 @@ UA_ChannelModule_Basic256Sha256_setLocalSymSigningKey(void * channelContext,
     if(key == NULL || channelContext == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
-    UA_ByteString_clear(&cc->localSymSigningKey);
-    return UA_ByteString_copy(key, &cc->localSymSigningKey);
+    return UA_OpenSSL_SymmetricContext_setSigningKey(&cc->symCtx, EVP_sha256(), key);
 }
 
 static UA_StatusCode
@@ -369,8 +359,7 @@ UA_ChannelM_Basic256Sha256_setLocalSymEncryptingKey(void * channelContext,
     if(key == NULL || channelContext == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
-    UA_ByteString_clear(&cc->localSymEncryptingKey);
-    return UA_ByteString_copy(key, &cc->localSymEncryptingKey);
+    return UA_OpenSSL_SymmetricContext_setEncryptingKey(&cc->symCtx, EVP_aes_256_cbc(), key);
 }
 
 static UA_StatusCode
@@ -406,8 +395,7 @@ UA_ChannelM_Basic256Sha256_setRemoteSymSigningKey(void *channelContext,
     if(key == NULL || channelContext == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
-    UA_ByteString_clear(&cc->remoteSymSigningKey);
-    return UA_ByteString_copy(key, &cc->remoteSymSigningKey);
+    return UA_OpenSSL_SymmetricContext_setVerifyingKey(&cc->symCtx, EVP_sha256(), key);
 }
 
 static UA_StatusCode
@@ -416,8 +404,7 @@ UA_ChannelM_Basic256Sha256_setRemoteSymEncryptingKey(void *channelContext,
     if(key == NULL || channelContext == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
-    UA_ByteString_clear(&cc->remoteSymEncryptingKey);
-    return UA_ByteString_copy(key, &cc->remoteSymEncryptingKey);
+    return UA_OpenSSL_SymmetricContext_setDecryptingKey(&cc->symCtx, EVP_aes_256_cbc(), key);
 }
 
 static UA_StatusCode
@@ -462,7 +449,7 @@ UA_SymSig_Basic256Sha256_verify(void *channelContext, const UA_ByteString *messa
         return UA_STATUSCODE_BADINTERNALERROR;
 
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Verify(message, &cc->remoteSymSigningKey, signature);
+    return UA_OpenSSL_SymmetricContext_verify(&cc->symCtx, message, signature);
 }
 
 static UA_StatusCode
@@ -472,7 +459,7 @@ UA_SymSig_Basic256Sha256_sign(void *channelContext, const UA_ByteString *message
         return UA_STATUSCODE_BADINTERNALERROR;
 
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
-    return UA_OpenSSL_HMAC_SHA256_Sign(message, &cc->localSymSigningKey, signature);
+    return UA_OpenSSL_SymmetricContext_sign(&cc->symCtx, message, signature);
 }
 
 static size_t
@@ -485,8 +472,7 @@ UA_SymEn_Basic256Sha256_decrypt(void *channelContext, UA_ByteString *data) {
     if(channelContext == NULL || data == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
-    return UA_OpenSSL_AES_256_CBC_Decrypt(&cc->remoteSymIv,
-                                          &cc->remoteSymEncryptingKey, data);
+    return UA_OpenSSL_SymmetricContext_decrypt(&cc->symCtx, &cc->remoteSymIv, data);
 }
 
 static UA_StatusCode
@@ -495,7 +481,18 @@ UA_SymEn_Basic256Sha256_encrypt(void *channelContext, UA_ByteString *data) {
         return UA_STATUSCODE_BADINTERNALERROR;
 
     Channel_Context_Basic256Sha256 * cc = (Channel_Context_Basic256Sha256 *) channelContext;
-    return UA_OpenSSL_AES_256_CBC_Encrypt(&cc->localSymIv, &cc->localSymEncryptingKey, data);
+    return UA_OpenSSL_SymmetricContext_encrypt(&cc->symCtx, &cc->localSymIv, data);
+}
+
+static UA_StatusCode
+UA_SymSigEn_Basic256Sha256_signAndEncrypt(void *channelContext, UA_ByteString *chunk,
+                                          size_t encryptOffset, size_t signatureOffset) {
+    if(channelContext == NULL || chunk == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    Channel_Context_Basic256Sha256 *cc = (Channel_Context_Basic256Sha256 *)channelContext;
+    return UA_OpenSSL_SymmetricContext_signAndEncrypt(&cc->symCtx, &cc->localSymIv, chunk,
+                                                      encryptOffset, signatureOffset);
 }
 
 static UA_StatusCode
@@ -592,6 +589,7 @@ UA_SecurityPolicy_Basic256Sha256(UA_SecurityPolicy *policy,
     symmetricModule->secureChannelNonceLength = 32;
     symmetricModule->generateNonce = UA_Sym_Basic256Sha256_generateNonce;
     symmetricModule->generateKey = UA_Sym_Basic256Sha256_generateKey;
+    symmetricModule->signAndEncrypt = UA_SymSigEn_Basic256Sha256_signAndEncrypt;
 
     /* Symmetric encryption Algorithm */
     UA_SecurityPolicyEncryptionAlgorithm *symEncryptionAlgorithm =
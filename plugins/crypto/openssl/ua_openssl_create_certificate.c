@@ -104,6 +104,12 @@ static EVP_PKEY * UA_RSA_Generate_Key (size_t keySizeBits){
     return EVP_RSA_gen(keySizeBits);
 }
 
+/* generate the EC key on the NIST P-256 curve */
+
+static EVP_PKEY * UA_ECC_Generate_Key (void){
+    return EVP_EC_gen("P-256");
+}
+
 #endif
 
 UA_StatusCode
@@ -121,6 +127,8 @@ UA_CreateCertificate(const UA_Logger *logger, const UA_String *subject,
     UA_UInt16 keySizeBits = 4096;
     /* Default to 1 year */
     UA_UInt16 expiresInDays = 365;
+    /* Default to RSA keys */
+    UA_Boolean eccKey = false;
 
     if(params) {
         const UA_UInt16 *keySizeBitsValue = (const UA_UInt16 *)UA_KeyValueMap_getScalar(
@@ -132,6 +140,20 @@ UA_CreateCertificate(const UA_Logger *logger, const UA_String *subject,
             params, UA_QUALIFIEDNAME(0, "expires-in-days"), &UA_TYPES[UA_TYPES_UINT16]);
         if(expiresInDaysValue)
             expiresInDays = *expiresInDaysValue;
+
+        const UA_String *keyTypeValue = (const UA_String *)UA_KeyValueMap_getScalar(
+            params, UA_QUALIFIEDNAME(0, "key-type"), &UA_TYPES[UA_TYPES_STRING]);
+        if(keyTypeValue) {
+            UA_String eccNistP256 = UA_STRING("ecc-nistp256");
+            UA_String rsa = UA_STRING("rsa");
+            if(UA_String_equal(keyTypeValue, &eccNistP256)) {
+                eccKey = true;
+            } else if(!UA_String_equal(keyTypeValue, &rsa)) {
+                UA_LOG_ERROR(logger, UA_LOGCATEGORY_SECURECHANNEL,
+                             "Create Certificate: Unknown key type.");
+                return UA_STATUSCODE_BADINVALIDARGUMENT;
+            }
+        }
     }
 
     UA_ByteString_init(outPrivateKey);
@@ -150,7 +172,7 @@ UA_CreateCertificate(const UA_Logger *logger, const UA_String *subject,
     X509 *x509 = X509_new();
 
 #if (OPENSSL_VERSION_NUMBER >= 0x30000000L)
-    EVP_PKEY *pkey = UA_RSA_Generate_Key(keySizeBits);
+    EVP_PKEY *pkey = (eccKey) ? UA_ECC_Generate_Key() : UA_RSA_Generate_Key(keySizeBits);
     if((pkey == NULL) || (x509 == NULL)) {
         errRet = UA_STATUSCODE_BADOUTOFMEMORY;
         goto cleanup;
@@ -164,6 +186,13 @@ UA_CreateCertificate(const UA_Logger *logger, const UA_String *subject,
         goto cleanup;
     }
 
+    if(eccKey) {
+        UA_LOG_ERROR(logger, UA_LOGCATEGORY_SECURECHANNEL,
+                     "Create Certificate: ECC keys require OpenSSL 3.");
+        errRet = UA_STATUSCODE_BADNOTSUPPORTED;
+        goto cleanup;
+    }
+
     UA_LOG_INFO(logger, UA_LOGCATEGORY_SECURECHANNEL,
                 "Create Certificate: Generating RSA key. This may take a while.");
 
@@ -280,7 +309,8 @@ UA_CreateCertificate(const UA_Logger *logger, const UA_String *subject,
 
     /* See https://datatracker.ietf.org/doc/html/rfc5280#section-4.2.1.3 for
      * possible values */
-    errRet = add_x509V3ext(logger, x509, NID_key_usage,
+    errRet = add_x509V3ext(logger, x509, NID_key_usage, (eccKey) ?
+                           "digitalSignature,nonRepudiation,keyAgreement,keyCertSign" :
                            "digitalSignature,nonRepudiation,keyEncipherment,dataEncipherment,keyCertSign");
     if(errRet != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR(logger, UA_LOGCATEGORY_SECURECHANNEL,
@@ -0,0 +1,630 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/securitypolicy_default.h>
+#include <open62541/util.h>
+
+#if defined(UA_ENABLE_ENCRYPTION_OPENSSL) || defined(UA_ENABLE_ENCRYPTION_LIBRESSL)
+
+#include "securitypolicy_openssl_common.h"
+
+#ifdef UA_OPENSSL_ECC
+
+#include <openssl/obj_mac.h>
+#include <openssl/rand.h>
+#include <openssl/x509.h>
+
+#define UA_SHA256_LENGTH 32 /* 256 bit */
+#define UA_SECURITYPOLICY_ECCNISTP256_CURVE "prime256v1"
+#define UA_SECURITYPOLICY_ECCNISTP256_COORDINATE_LENGTH 32
+#define UA_SECURITYPOLICY_ECCNISTP256_NONCE_LENGTH 64 /* X | Y */
+#define UA_SECURITYPOLICY_ECCNISTP256_SIGNATURE_LENGTH 64 /* R | S */
+#define UA_SECURITYPOLICY_ECCNISTP256_SYM_SIGNING_KEY_LENGTH 32
+#define UA_SECURITYPOLICY_ECCNISTP256_SYM_ENCRYPTION_KEY_LENGTH 16
+#define UA_SECURITYPOLICY_ECCNISTP256_SYM_ENCRYPTION_BLOCK_SIZE 16
+
+typedef struct {
+    EVP_PKEY *localPrivateKey;
+    UA_ByteString localCertThumbprint;
+    const UA_Logger *logger;
+} Policy_Context_EccNistP256;
+
+typedef struct {
+    UA_OpenSSL_SymmetricContext symCtx; /* Keyed cipher and HMAC contexts */
+    UA_ByteString localSymIv;
+    UA_ByteString remoteSymIv;
+
+    Policy_Context_EccNistP256 *policyContext;
+    UA_ByteString remoteCertificate;
+    X509 *remoteCertificateX509; /* X509 */
+
+    /* The ephemeral key pair of the last local nonce. The private key is kept
+     * until the next nonce is generated, as the local and remote keys are
+     * derived at different times. */
+    EVP_PKEY *localEphemeralKey;
+    UA_Byte localEphemeralPublicKey[UA_SECURITYPOLICY_ECCNISTP256_NONCE_LENGTH];
+} Channel_Context_EccNistP256;
+
+/* create the policy context */
+
+static UA_StatusCode
+UA_Policy_EccNistP256_New_Context(UA_SecurityPolicy *securityPolicy,
+                                  const UA_ByteString localPrivateKey,
+                                  const UA_Logger *logger) {
+    Policy_Context_EccNistP256 *context = (Policy_Context_EccNistP256 *)
+        UA_malloc(sizeof(Policy_Context_EccNistP256));
+    if(context == NULL)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    context->localPrivateKey = UA_OpenSSL_LoadPrivateKey(&localPrivateKey);
+    if(!context->localPrivateKey) {
+        UA_free(context);
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    }
+
+    /* The policy requires a certificate with a key on the NIST P-256 curve */
+    if(!UA_OpenSSL_ECC_isCurve(context->localPrivateKey, NID_X9_62_prime256v1)) {
+        EVP_PKEY_free(context->localPrivateKey);
+        UA_free(context);
+        return UA_STATUSCODE_BADCERTIFICATEINVALID;
+    }
+
+    UA_StatusCode retval = UA_Openssl_X509_GetCertificateThumbprint(
+        &securityPolicy->localCertificate, &context->localCertThumbprint, true);
+    if(retval != UA_STATUSCODE_GOOD) {
+        EVP_PKEY_free(context->localPrivateKey);
+        UA_free(context);
+        return retval;
+    }
+
+    context->logger = logger;
+    securityPolicy->policyContext = context;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* clear the policy context */
+
+static void
+UA_Policy_EccNistP256_Clear_Context(UA_SecurityPolicy *policy) {
+    if(policy == NULL)
+        return;
+
+    UA_ByteString_clear(&policy->localCertificate);
+
+    Policy_Context_EccNistP256 *pc =
+        (Policy_Context_EccNistP256 *)policy->policyContext;
+    if(pc == NULL)
+        return;
+
+    EVP_PKEY_free(pc->localPrivateKey);
+    UA_ByteString_clear(&pc->localCertThumbprint);
+    UA_free(pc);
+    policy->policyContext = NULL;
+}
+
+static UA_StatusCode
+updateCertificateAndPrivateKey_sp_eccnistp256(UA_SecurityPolicy *securityPolicy,
+                                              const UA_ByteString newCertificate,
+                                              const UA_ByteString newPrivateKey) {
+    if(securityPolicy == NULL || securityPolicy->policyContext == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    Policy_Context_EccNistP256 *pc =
+        (Policy_Context_EccNistP256 *)securityPolicy->policyContext;
+
+    /* Check the new key before replacing the current one */
+    EVP_PKEY *newKey = UA_OpenSSL_LoadPrivateKey(&newPrivateKey);
+    if(!newKey || !UA_OpenSSL_ECC_isCurve(newKey, NID_X9_62_prime256v1)) {
+        EVP_PKEY_free(newKey);
+        UA_LOG_ERROR(securityPolicy->logger, UA_LOGCATEGORY_SECURITYPOLICY,
+                     "The new private key is not on the NIST P-256 curve");
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+    }
+
+    UA_ByteString_clear(&securityPolicy->localCertificate);
+    UA_StatusCode retval =
+        UA_OpenSSL_LoadLocalCertificate(&newCertificate, &securityPolicy->localCertificate);
+    if(retval != UA_STATUSCODE_GOOD) {
+        EVP_PKEY_free(newKey);
+        return retval;
+    }
+
+    EVP_PKEY_free(pc->localPrivateKey);
+    pc->localPrivateKey = newKey;
+
+    UA_ByteString_clear(&pc->localCertThumbprint);
+    retval = UA_Openssl_X509_GetCertificateThumbprint(&securityPolicy->localCertificate,
+                                                      &pc->localCertThumbprint, true);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(securityPolicy->logger, UA_LOGCATEGORY_SECURITYPOLICY,
+                     "Could not update certificate and private key");
+        UA_Policy_EccNistP256_Clear_Context(securityPolicy);
+    }
+    return retval;
+}
+
+/* create the channel context */
+
+static UA_StatusCode
+UA_ChannelModule_EccNistP256_New_Context(const UA_SecurityPolicy *securityPolicy,
+                                         const UA_ByteString *remoteCertificate,
+                                         void **channelContext) {
+    if(securityPolicy == NULL || remoteCertificate == NULL || channelContext == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    Channel_Context_EccNistP256 *context = (Channel_Context_EccNistP256 *)
+        UA_calloc(1, sizeof(Channel_Context_EccNistP256));
+    if(context == NULL)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    UA_OpenSSL_SymmetricContext_init(&context->symCtx);
+
+    UA_StatusCode retval =
+        UA_copyCertificate(&context->remoteCertificate, remoteCertificate);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_free(context);
+        return retval;
+    }
+
+    /* decode to X509 */
+    context->remoteCertificateX509 = UA_OpenSSL_LoadCertificate(&context->remoteCertificate);
+    if(context->remoteCertificateX509 == NULL) {
+        UA_ByteString_clear(&context->remoteCertificate);
+        UA_free(context);
+        return UA_STATUSCODE_BADCERTIFICATECHAININCOMPLETE;
+    }
+
+    /* The remote certificate needs a key on the same curve */
+    EVP_PKEY *remoteKey = X509_get0_pubkey(context->remoteCertificateX509);
+    if(!UA_OpenSSL_ECC_isCurve(remoteKey, NID_X9_62_prime256v1)) {
+        X509_free(context->remoteCertificateX509);
+        UA_ByteString_clear(&context->remoteCertificate);
+        UA_free(context);
+        return UA_STATUSCODE_BADCERTIFICATEINVALID;
+    }
+
+    context->policyContext =
+        (Policy_Context_EccNistP256 *)(securityPolicy->policyContext);
+
+    *channelContext = context;
+
+    UA_LOG_INFO(securityPolicy->logger, UA_LOGCATEGORY_SECURITYPOLICY,
+                "The EccNistP256 security policy channel with openssl is created.");
+    return UA_STATUSCODE_GOOD;
+}
+
+/* delete the channel context */
+
+static void
+UA_ChannelModule_EccNistP256_Delete_Context(void *channelContext) {
+    if(channelContext == NULL)
+        return;
+
+    Channel_Context_EccNistP256 *cc = (Channel_Context_EccNistP256 *)channelContext;
+    X509_free(cc->remoteCertificateX509);
+    UA_ByteString_clear(&cc->remoteCertificate);
+    UA_OpenSSL_SymmetricContext_clear(&cc->symCtx);
+    UA_ByteString_clear(&cc->localSymIv);
+    UA_ByteString_clear(&cc->remoteSymIv);
+    EVP_PKEY_free(cc->localEphemeralKey);
+
+    UA_LOG_INFO(cc->policyContext->logger, UA_LOGCATEGORY_SECURITYPOLICY,
+                "The EccNistP256 security policy channel with openssl is deleted.");
+    UA_free(cc);
+}
+
+/* AsymmetricSignatureAlgorithm_ECDSA-SHA2-256 */
+
+static UA_StatusCode
+UA_AsySig_EccNistP256_Verify(void *channelContext, const UA_ByteString *message,
+                             const UA_ByteString *signature) {
+    if(message == NULL || signature == NULL || channelContext == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    Channel_Context_EccNistP256 *cc = (Channel_Context_EccNistP256 *)channelContext;
+    if(signature->length != UA_SECURITYPOLICY_ECCNISTP256_SIGNATURE_LENGTH)
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+    return UA_OpenSSL_ECDSA_Verify(message, EVP_sha256(),
+                                   cc->remoteCertificateX509, signature);
+}
+
+static UA_StatusCode
+UA_AsySig_EccNistP256_Sign(void *channelContext, const UA_ByteString *message,
+                           UA_ByteString *signature) {
+    if(channelContext == NULL || message == NULL || signature == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    Channel_Context_EccNistP256 *cc = (Channel_Context_EccNistP256 *)channelContext;
+    if(signature->length != UA_SECURITYPOLICY_ECCNISTP256_SIGNATURE_LENGTH)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_OpenSSL_ECDSA_Sign(message, EVP_sha256(),
+                                 cc->policyContext->localPrivateKey, signature);
+}
+
+static size_t
+UA_AsySig_EccNistP256_getSignatureSize(const void *channelContext) {
+    return UA_SECURITYPOLICY_ECCNISTP256_SIGNATURE_LENGTH;
+}
+
+/* The OPN messages are only signed. There is no asymmetric encryption. */
+
+static size_t
+UA_AsymEn_EccNistP256_getKeyLength(const void *channelContext) {
+    return 0;
+}
+
+/* Compares the supplied certificate with the certificate
+ * in the endpoint context */
+
+static UA_StatusCode
+UA_compareCertificateThumbprint_EccNistP256(const UA_SecurityPolicy *securityPolicy,
+                                            const UA_ByteString *certificateThumbprint) {
+    if(securityPolicy == NULL || certificateThumbprint == NULL)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    Policy_Context_EccNistP256 *pc =
+        (Policy_Context_EccNistP256 *)securityPolicy->policyContext;
+    if(!UA_ByteString_equal(certificateThumbprint, &pc->localCertThumbprint))
+        return UA_STATUSCODE_BADCERTIFICATEINVALID;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Generates a thumbprint for the specified certificate */
+
+static UA_StatusCode
+UA_makeCertificateThumbprint_EccNistP256(const UA_SecurityPolicy *securityPolicy,
+                                         const UA_ByteString *certificate,
+                                         UA_ByteString *thumbprint) {
+    return UA_Openssl_X509_GetCertificateThumbprint(certificate, thumbprint, false);
+}
+
+/* Random nonces for the Session. The SecureChannel nonces are ephemeral keys. */
+
+static UA_StatusCode
+UA_Sym_EccNistP256_generateNonce(void *policyContext, UA_ByteString *out) {
+    UA_Int32 rc = RAND_bytes(out->data, (int)out->length);
+    if(rc != 1)
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+UA_Sym_EccNistP256_generateChannelNonce(void *channelContext, UA_ByteString *out) {
+    if(channelContext == NULL || out == NULL ||
+       out->length != UA_SECURITYPOLICY_ECCNISTP256_NONCE_LENGTH)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    Channel_Context_EccNistP256 *cc = (Channel_Context_EccNistP256 *)channelContext;
+    UA_StatusCode res =
+        UA_OpenSSL_ECC_generateKey(UA_SECURITYPOLICY_ECCNISTP256_CURVE,
+                                   &cc->localEphemeralKey, out);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    memcpy(cc->localEphemeralPublicKey, out->data, out->length);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Part 6, 6.8.1: The keys are derived with HKDF from the ECDH shared secret.
+ *
+ * ClientSalt = L | "opcua-client" | ClientNonce | ServerNonce
+ * ServerSalt = L | "opcua-server" | ServerNonce | ClientNonce
+ * ClientKeys = HKDF(ClientSalt, SharedSecret, ClientSalt, L)
+ * ServerKeys = HKDF(ServerSalt, SharedSecret, ServerSalt, L)
+ *
+ * L is the length of the key material encoded as a little-endian UInt16. */
+
+static UA_StatusCode
+UA_Sym_EccNistP256_generateChannelKey(void *channelContext,
+                                      const UA_ByteString *clientNonce,
+                                      const UA_ByteString *serverNonce,
+                                      UA_Boolean clientKeys, UA_ByteString *out) {
+    if(channelContext == NULL || clientNonce == NULL ||
+       serverNonce == NULL || out == NULL || out->length > UA_UINT16_MAX)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    if(clientNonce->length != UA_SECURITYPOLICY_ECCNISTP256_NONCE_LENGTH ||
+       serverNonce->length != UA_SECURITYPOLICY_ECCNISTP256_NONCE_LENGTH)
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+
+    /* The remote nonce is the one that was not generated locally */
+    Channel_Context_EccNistP256 *cc = (Channel_Context_EccNistP256 *)channelContext;
+    const UA_ByteString localNonce =
+        {UA_SECURITYPOLICY_ECCNISTP256_NONCE_LENGTH, cc->localEphemeralPublicKey};
+    const UA_ByteString *remoteNonce;
+    if(UA_ByteString_equal(&localNonce, clientNonce))
+        remoteNonce = serverNonce;
+    else if(UA_ByteString_equal(&localNonce, serverNonce))
+        remoteNonce = clientNonce;
+    else
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    UA_ByteString secret = UA_BYTESTRING_NULL;
+    UA_StatusCode res =
+        UA_OpenSSL_ECC_deriveSharedSecret(UA_SECURITYPOLICY_ECCNISTP256_CURVE,
+                                          cc->localEphemeralKey, remoteNonce, &secret);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    /* Assemble the salt */
+    const char *label = (clientKeys) ? "opcua-client" : "opcua-server";
+    const UA_ByteString *first = (clientKeys) ? clientNonce : serverNonce;
+    const UA_ByteString *second = (clientKeys) ? serverNonce : clientNonce;
+    UA_Byte saltBuf[2 + 12 + 2 * UA_SECURITYPOLICY_ECCNISTP256_NONCE_LENGTH];
+    UA_ByteString salt = {sizeof(saltBuf), saltBuf};
+    saltBuf[0] = (UA_Byte)(out->length & 0xff);
+    saltBuf[1] = (UA_Byte)(out->length >> 8);
+    memcpy(&saltBuf[2], label, 12);
+    memcpy(&saltBuf[14], first->data, first->length);
+    memcpy(&saltBuf[14 + first->length], second->data, second->length);
+
+    res = UA_OpenSSL_HKDF_Derive(EVP_sha256(), &salt, &secret, &salt, out);
+    UA_ByteString_memZero(&secret);
+    UA_ByteString_clear(&secret);
+    return res;
+}
+
+static size_t
+UA_SymEn_EccNistP256_getKeyLength(const void *channelContext) {
+    return UA_SECURITYPOLICY_ECCNISTP256_SYM_ENCRYPTION_KEY_LENGTH;
+}
+
+static size_t
+UA_SymEn_EccNistP256_getBlockSize(const void *channelContext) {
+    return UA_SECURITYPOLICY_ECCNISTP256_SYM_ENCRYPTION_BLOCK_SIZE;
+}
+
+static size_t
+UA_SymSig_EccNistP256_getKeyLength(const void *channelContext) {
+    return UA_SECURITYPOLICY_ECCNISTP256_SYM_SIGNING_KEY_LENGTH;
+}
+
+static size_t
+UA_SymSig_EccNistP256_getSignatureSize(const void *channelContext) {
+    return UA_SHA256_LENGTH;
+}
+
+static UA_StatusCode
+UA_ChannelM_EccNistP256_setLocalSymSigningKey(void *channelContext,
+                                              const UA_ByteString *key) {
+    if(key == NULL || channelContext == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    Channel_Context_EccNistP256 *cc = (Channel_Context_EccNistP256 *)channelContext;
+    return UA_OpenSSL_SymmetricContext_setSigningKey(&cc->symCtx, EVP_sha256(), key);
+}
+
+static UA_StatusCode
+UA_ChannelM_EccNistP256_setLocalSymEncryptingKey(void *channelContext,
+                                                 const UA_ByteString *key) {
+    if(key == NULL || channelContext == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    Channel_Context_EccNistP256 *cc = (Channel_Context_EccNistP256 *)channelContext;
+    return UA_OpenSSL_SymmetricContext_setEncryptingKey(&cc->symCtx, EVP_aes_128_cbc(), key);
+}
+
+static UA_StatusCode
+UA_ChannelM_EccNistP256_setLocalSymIv(void *channelContext,
+                                      const UA_ByteString *iv) {
+    if(iv == NULL || channelContext == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    Channel_Context_EccNistP256 *cc = (Channel_Context_EccNistP256 *)channelContext;
+    UA_ByteString_clear(&cc->localSymIv);
+    return UA_ByteString_copy(iv, &cc->localSymIv);
+}
+
+static UA_StatusCode
+UA_ChannelM_EccNistP256_setRemoteSymSigningKey(void *channelContext,
+                                               const UA_ByteString *key) {
+    if(key == NULL || channelContext == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    Channel_Context_EccNistP256 *cc = (Channel_Context_EccNistP256 *)channelContext;
+    return UA_OpenSSL_SymmetricContext_setVerifyingKey(&cc->symCtx, EVP_sha256(), key);
+}
+
+static UA_StatusCode
+UA_ChannelM_EccNistP256_setRemoteSymEncryptingKey(void *channelContext,
+                                                  const UA_ByteString *key) {
+    if(key == NULL || channelContext == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    Channel_Context_EccNistP256 *cc = (Channel_Context_EccNistP256 *)channelContext;
+    return UA_OpenSSL_SymmetricContext_setDecryptingKey(&cc->symCtx, EVP_aes_128_cbc(), key);
+}
+
+static UA_StatusCode
+UA_ChannelM_EccNistP256_setRemoteSymIv(void *channelContext,
+                                       const UA_ByteString *iv) {
+    if(iv == NULL || channelContext == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    Channel_Context_EccNistP256 *cc = (Channel_Context_EccNistP256 *)channelContext;
+    UA_ByteString_clear(&cc->remoteSymIv);
+    return UA_ByteString_copy(iv, &cc->remoteSymIv);
+}
+
+static UA_StatusCode
+UA_SymSig_EccNistP256_verify(void *channelContext, const UA_ByteString *message,
+                             const UA_ByteString *signature) {
+    if(channelContext == NULL || message == NULL || signature == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    Channel_Context_EccNistP256 *cc = (Channel_Context_EccNistP256 *)channelContext;
+    return UA_OpenSSL_SymmetricContext_verify(&cc->symCtx, message, signature);
+}
+
+static UA_StatusCode
+UA_SymSig_EccNistP256_sign(void *channelContext, const UA_ByteString *message,
+                           UA_ByteString *signature) {
+    if(channelContext == NULL || message == NULL || signature == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    Channel_Context_EccNistP256 *cc = (Channel_Context_EccNistP256 *)channelContext;
+    return UA_OpenSSL_SymmetricContext_sign(&cc->symCtx, message, signature);
+}
+
+static UA_StatusCode
+UA_SymEn_EccNistP256_decrypt(void *channelContext, UA_ByteString *data) {
+    if(channelContext == NULL || data == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    Channel_Context_EccNistP256 *cc = (Channel_Context_EccNistP256 *)channelContext;
+    return UA_OpenSSL_SymmetricContext_decrypt(&cc->symCtx, &cc->remoteSymIv, data);
+}
+
+static UA_StatusCode
+UA_SymEn_EccNistP256_encrypt(void *channelContext, UA_ByteString *data) {
+    if(channelContext == NULL || data == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    Channel_Context_EccNistP256 *cc = (Channel_Context_EccNistP256 *)channelContext;
+    return UA_OpenSSL_SymmetricContext_encrypt(&cc->symCtx, &cc->localSymIv, data);
+}
+
+static UA_StatusCode
+UA_SymSigEn_EccNistP256_signAndEncrypt(void *channelContext, UA_ByteString *chunk,
+                                       size_t encryptOffset, size_t signatureOffset) {
+    if(channelContext == NULL || chunk == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    Channel_Context_EccNistP256 *cc = (Channel_Context_EccNistP256 *)channelContext;
+    return UA_OpenSSL_SymmetricContext_signAndEncrypt(&cc->symCtx, &cc->localSymIv, chunk,
+                                                      encryptOffset, signatureOffset);
+}
+
+static UA_StatusCode
+UA_ChannelM_EccNistP256_compareCertificate(const void *channelContext,
+                                           const UA_ByteString *certificate) {
+    if(channelContext == NULL || certificate == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    const Channel_Context_EccNistP256 *cc =
+        (const Channel_Context_EccNistP256 *)channelContext;
+    return UA_OpenSSL_X509_compare(certificate, cc->remoteCertificateX509);
+}
+
+/* the main entry of EccNistP256 */
+
+UA_StatusCode
+UA_SecurityPolicy_EccNistP256(UA_SecurityPolicy *policy,
+                              const UA_ByteString localCertificate,
+                              const UA_ByteString localPrivateKey,
+                              const UA_Logger *logger) {
+    UA_SecurityPolicyAsymmetricModule *const asymmetricModule = &policy->asymmetricModule;
+    UA_SecurityPolicySymmetricModule *const symmetricModule = &policy->symmetricModule;
+    UA_SecurityPolicyChannelModule *const channelModule = &policy->channelModule;
+    UA_StatusCode retval;
+
+    UA_Openssl_Init();
+    memset(policy, 0, sizeof(UA_SecurityPolicy));
+    policy->logger = logger;
+    policy->policyUri =
+        UA_STRING("http://opcfoundation.org/UA/SecurityPolicy#ECC_nistP256\0");
+    policy->securityLevel = 40;
+
+    /* set ChannelModule context  */
+
+    channelModule->newContext = UA_ChannelModule_EccNistP256_New_Context;
+    channelModule->deleteContext = UA_ChannelModule_EccNistP256_Delete_Context;
+    channelModule->setLocalSymSigningKey = UA_ChannelM_EccNistP256_setLocalSymSigningKey;
+    channelModule->setLocalSymEncryptingKey = UA_ChannelM_EccNistP256_setLocalSymEncryptingKey;
+    channelModule->setLocalSymIv = UA_ChannelM_EccNistP256_setLocalSymIv;
+    channelModule->setRemoteSymSigningKey = UA_ChannelM_EccNistP256_setRemoteSymSigningKey;
+    channelModule->setRemoteSymEncryptingKey = UA_ChannelM_EccNistP256_setRemoteSymEncryptingKey;
+    channelModule->setRemoteSymIv = UA_ChannelM_EccNistP256_setRemoteSymIv;
+    channelModule->compareCertificate = UA_ChannelM_EccNistP256_compareCertificate;
+
+    /* Copy the certificate and add a NULL to the end */
+
+    retval = UA_copyCertificate(&policy->localCertificate, &localCertificate);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    /* AsymmetricModule - signature algorithm */
+
+    UA_SecurityPolicySignatureAlgorithm *asySigAlgorithm =
+        &asymmetricModule->cryptoModule.signatureAlgorithm;
+    asySigAlgorithm->uri =
+        UA_STRING("http://www.w3.org/2001/04/xmldsig-more#ecdsa-sha256\0");
+    asySigAlgorithm->verify = UA_AsySig_EccNistP256_Verify;
+    asySigAlgorithm->sign = UA_AsySig_EccNistP256_Sign;
+    asySigAlgorithm->getLocalSignatureSize = UA_AsySig_EccNistP256_getSignatureSize;
+    asySigAlgorithm->getRemoteSignatureSize = UA_AsySig_EccNistP256_getSignatureSize;
+    asySigAlgorithm->getLocalKeyLength = NULL;
+    asySigAlgorithm->getRemoteKeyLength = NULL;
+
+    /* AsymmetricModule encryption algorithm. Not available, encrypt and
+     * decrypt remain NULL. */
+
+    UA_SecurityPolicyEncryptionAlgorithm *asymEncryAlg =
+        &asymmetricModule->cryptoModule.encryptionAlgorithm;
+    asymEncryAlg->uri = UA_STRING_NULL;
+    asymEncryAlg->getLocalKeyLength = UA_AsymEn_EccNistP256_getKeyLength;
+    asymEncryAlg->getRemoteKeyLength = UA_AsymEn_EccNistP256_getKeyLength;
+    asymEncryAlg->getRemoteBlockSize = UA_AsymEn_EccNistP256_getKeyLength;
+    asymEncryAlg->getRemotePlainTextBlockSize = UA_AsymEn_EccNistP256_getKeyLength;
+
+    /* asymmetricModule */
+
+    asymmetricModule->compareCertificateThumbprint =
+        UA_compareCertificateThumbprint_EccNistP256;
+    asymmetricModule->makeCertificateThumbprint =
+        UA_makeCertificateThumbprint_EccNistP256;
+
+    /* SymmetricModule. The SecureChannel nonces are ephemeral public keys and
+     * the keys are derived from the shared secret. */
+
+    symmetricModule->secureChannelNonceLength = UA_SECURITYPOLICY_ECCNISTP256_NONCE_LENGTH;
+    symmetricModule->generateNonce = UA_Sym_EccNistP256_generateNonce;
+    symmetricModule->generateChannelNonce = UA_Sym_EccNistP256_generateChannelNonce;
+    symmetricModule->generateChannelKey = UA_Sym_EccNistP256_generateChannelKey;
+    symmetricModule->signAndEncrypt = UA_SymSigEn_EccNistP256_signAndEncrypt;
+
+    /* Symmetric encryption Algorithm */
+
+    UA_SecurityPolicyEncryptionAlgorithm *symEncryptionAlgorithm =
+        &symmetricModule->cryptoModule.encryptionAlgorithm;
+    symEncryptionAlgorithm->uri =
+        UA_STRING("http://www.w3.org/2001/04/xmlenc#aes128-cbc\0");
+    symEncryptionAlgorithm->getLocalKeyLength = UA_SymEn_EccNistP256_getKeyLength;
+    symEncryptionAlgorithm->getRemoteKeyLength = UA_SymEn_EccNistP256_getKeyLength;
+    symEncryptionAlgorithm->getRemoteBlockSize = UA_SymEn_EccNistP256_getBlockSize;
+    symEncryptionAlgorithm->getRemotePlainTextBlockSize = UA_SymEn_EccNistP256_getBlockSize;
+    symEncryptionAlgorithm->decrypt = UA_SymEn_EccNistP256_decrypt;
+    symEncryptionAlgorithm->encrypt = UA_SymEn_EccNistP256_encrypt;
+
+    /* Symmetric signature Algorithm */
+
+    UA_SecurityPolicySignatureAlgorithm *symSignatureAlgorithm =
+        &symmetricModule->cryptoModule.signatureAlgorithm;
+    symSignatureAlgorithm->uri = UA_STRING("http://www.w3.org/2000/09/xmldsig#hmac-sha2-256\0");
+    symSignatureAlgorithm->getLocalKeyLength = UA_SymSig_EccNistP256_getKeyLength;
+    symSignatureAlgorithm->getRemoteKeyLength = UA_SymSig_EccNistP256_getKeyLength;
+    symSignatureAlgorithm->getLocalSignatureSize = UA_SymSig_EccNistP256_getSignatureSize;
+    symSignatureAlgorithm->getRemoteSignatureSize = UA_SymSig_EccNistP256_getSignatureSize;
+    symSignatureAlgorithm->verify = UA_SymSig_EccNistP256_verify;
+    symSignatureAlgorithm->sign = UA_SymSig_EccNistP256_sign;
+
+    retval = UA_Policy_EccNistP256_New_Context(policy, localPrivateKey, logger);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_ByteString_clear(&policy->localCertificate);
+        return retval;
+    }
+    policy->updateCertificateAndPrivateKey = updateCertificateAndPrivateKey_sp_eccnistp256;
+    policy->clear = UA_Policy_EccNistP256_Clear_Context;
+
+    /* Use the same signature algorithm as the asymmetric component for
+       certificate signing (see standard) */
+
+    policy->certificateSigningAlgorithm =
+        policy->asymmetricModule.cryptoModule.signatureAlgorithm;
+
+    UA_LOG_INFO(logger, UA_LOGCATEGORY_SECURITYPOLICY,
+                "The EccNistP256 security policy with openssl is added.");
+    return UA_STATUSCODE_GOOD;
+}
+
+#else /* UA_OPENSSL_ECC */
+
+UA_StatusCode
+UA_SecurityPolicy_EccNistP256(UA_SecurityPolicy *policy,
+                              const UA_ByteString localCertificate,
+                              const UA_ByteString localPrivateKey,
+                              const UA_Logger *logger) {
+    /* The EccNistP256 security policy requires OpenSSL 3 */
+    return UA_STATUSCODE_BADNOTSUPPORTED;
+}
+
+#endif /* UA_OPENSSL_ECC */
+
+#endif
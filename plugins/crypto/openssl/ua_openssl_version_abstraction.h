@@ -35,6 +35,11 @@
 #define X509_get0_subject_key_id(PX509_CERT) (const ASN1_OCTET_STRING *)X509_get_ext_d2i(PX509_CERT, NID_subject_key_identifier, NULL, NULL);
 #endif
 
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+#define X509_get0_notAfter(PX509_CERT) X509_get_notAfter(PX509_CERT)
+#define X509_CRL_get0_nextUpdate(PX509_CRL) X509_CRL_get_nextUpdate(PX509_CRL)
+#endif
+
 #if OPENSSL_VERSION_NUMBER < 0x2000000fL || defined(LIBRESSL_VERSION_NUMBER)
 #define get_error_line_data(pFile, pLine, pData, pFlags) ERR_get_error_line_data(pFile, pLine, pData, pFlags)
 #else
@@ -163,6 +163,9 @@ UA_SecurityPolicy_None(UA_SecurityPolicy *policy, const UA_ByteString localCerti
     sym_encryptionAlgorithm->getRemoteBlockSize = length_none;
     sym_encryptionAlgorithm->getRemotePlainTextBlockSize = length_none;
     policy->symmetricModule.secureChannelNonceLength = 0;
+    policy->symmetricModule.signAndEncrypt = NULL;
+    policy->symmetricModule.generateChannelNonce = NULL;
+    policy->symmetricModule.generateChannelKey = NULL;
 
     policy->asymmetricModule.makeCertificateThumbprint = makeThumbprint_none;
     policy->asymmetricModule.compareCertificateThumbprint = compareThumbprint_none;
@@ -25,6 +25,9 @@ UA_ClientConfig_setAuthenticationCert(UA_ClientConfig *config,
 #endif
 
 #ifdef UA_ENABLE_ENCRYPTION
+/* If the certificate has an ECC key, only ``SecurityPolicy#ECC_nistP256`` is
+ * added and a warning is logged. Servers that only support the RSA policies
+ * then require a client with an RSA certificate. */
 UA_StatusCode UA_EXPORT
 UA_ClientConfig_setDefaultEncryption(UA_ClientConfig *config,
                                      UA_ByteString localCertificate, UA_ByteString privateKey,
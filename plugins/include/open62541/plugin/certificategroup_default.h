@@ -30,6 +30,17 @@ UA_CertificateVerification_Trustlist(UA_CertificateGroup *certGroup,
                                      const UA_ByteString *certificateRevocationList,
                                      size_t certificateRevocationListSize);
 
+/* Successful certificate verifications can be cached by the certificate
+ * thumbprint. A cached result is used until the trust-list is reloaded, the
+ * certificate or a CRL expires, or the maximum age (in ms) is reached. Failed
+ * verifications are not cached. Note that changes of the trust-list folders
+ * are only detected with the next folder check (see
+ * UA_CertificateVerification_setFolderCheckInterval). A maximum age of zero
+ * disables the cache. The cache is disabled by default. */
+UA_EXPORT UA_StatusCode
+UA_CertificateVerification_setVerificationCacheMaxAge(UA_CertificateGroup *certGroup,
+                                                      UA_Double maxAge);
+
 #ifdef __linux__ /* Linux only so far */
 
 #ifdef UA_ENABLE_CERT_REJECTED_DIR
@@ -46,6 +57,15 @@ UA_CertificateVerification_CertFolders(UA_CertificateGroup *certGroup,
                                        const char *issuerListFolder,
                                        const char *revocationListFolder);
 #endif
+
+/* The certificate folders are checked for changes before a verification. The
+ * parsed certificates are kept and only reloaded when the content of a folder
+ * has changed. The interval (in ms) limits how often the folders are checked.
+ * With the default interval of zero the folders are checked before every
+ * verification. */
+UA_EXPORT UA_StatusCode
+UA_CertificateVerification_setFolderCheckInterval(UA_CertificateGroup *certGroup,
+                                                  UA_Double interval);
 #endif
 
 #endif
@@ -34,6 +34,9 @@ typedef enum {
  *                  - expires-in-days after these the cert expires default: 365
  *                  - key-size-bits Size of the generated key in bits. Possible values are:
  *                    [0, 1024 (deprecated), 2048, 4096] default: 4096
+ *                  - key-type String with the type of the generated key. Possible
+ *                    values are: ["rsa", "ecc-nistp256"] default: "rsa". ECC keys
+ *                    require OpenSSL 3 and ignore key-size-bits.
  */
 UA_StatusCode UA_EXPORT
 UA_CreateCertificate(const UA_Logger *logger, const UA_String *subject,
@@ -50,6 +50,18 @@ UA_SecurityPolicy_Aes256Sha256RsaPss(UA_SecurityPolicy *policy,
                                      const UA_ByteString localPrivateKey,
                                      const UA_Logger *logger);
 
+#if defined(UA_ENABLE_ENCRYPTION_OPENSSL) || defined(UA_ENABLE_ENCRYPTION_LIBRESSL)
+
+/* Requires a certificate with a key on the NIST P-256 curve and OpenSSL 3.
+ * Returns UA_STATUSCODE_BADCERTIFICATEINVALID for other (e.g. RSA) keys. */
+UA_EXPORT UA_StatusCode
+UA_SecurityPolicy_EccNistP256(UA_SecurityPolicy *policy,
+                              const UA_ByteString localCertificate,
+                              const UA_ByteString localPrivateKey,
+                              const UA_Logger *logger);
+
+#endif
+
 #endif
 
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
@@ -61,6 +73,21 @@ UA_EXPORT UA_StatusCode
 UA_PubSubSecurityPolicy_Aes256Ctr(UA_PubSubSecurityPolicy *policy,
                                   const UA_Logger *logger);
 
+/* Authenticated encryption in a single pass. The payload is encrypted and the
+ * headers are authenticated. The authentication tag replaces the signature.
+ * The MessageNonce is derived from the PublisherId, the WriterGroupId and a
+ * counter based on the wall clock. So the PublisherIds that share a key must
+ * fit into 32 bit and be unique. */
+UA_EXPORT UA_StatusCode
+UA_PubSubSecurityPolicy_Aes128Gcm(UA_PubSubSecurityPolicy *policy,
+                                  const UA_Logger *logger);
+UA_EXPORT UA_StatusCode
+UA_PubSubSecurityPolicy_Aes256Gcm(UA_PubSubSecurityPolicy *policy,
+                                  const UA_Logger *logger);
+UA_EXPORT UA_StatusCode
+UA_PubSubSecurityPolicy_ChaCha20Poly1305(UA_PubSubSecurityPolicy *policy,
+                                         const UA_Logger *logger);
+
 #endif
 
 #ifdef UA_ENABLE_TPM2_SECURITY
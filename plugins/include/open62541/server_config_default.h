@@ -208,12 +208,34 @@ UA_ServerConfig_addSecurityPolicyAes256Sha256RsaPss(UA_ServerConfig *config,
                                                     const UA_ByteString *certificate,
                                                     const UA_ByteString *privateKey);
 
+#if defined(UA_ENABLE_ENCRYPTION_OPENSSL) || defined(UA_ENABLE_ENCRYPTION_LIBRESSL)
+/* Adds the security policy ``SecurityPolicy#ECC_nistP256`` to the server. The
+ * certificate must have a key on the NIST P-256 curve. The OPN messages are
+ * only signed (ECDSA) and the channel keys are derived with ECDH/HKDF.
+ * UserName and IssuedIdentity tokens cannot be encrypted on such channels.
+ *
+ * @param config The configuration to manipulate
+ * @param certificate The server certificate.
+ * @param privateKey The private key that corresponds to the certificate.
+ */
+UA_EXPORT UA_StatusCode
+UA_ServerConfig_addSecurityPolicyEccNistP256(UA_ServerConfig *config,
+                                             const UA_ByteString *certificate,
+                                             const UA_ByteString *privateKey);
+#endif
+
 /* Adds all supported security policies and sets up certificate
  * validation procedures.
  *
  * Certificate verification should be configured before calling this
  * function. See PKI plugin.
  *
+ * If the certificate has an ECC key, only ``SecurityPolicy#ECC_nistP256`` (and
+ * None) is added and a warning is logged. The RSA policies need an RSA
+ * certificate. They can be added alongside with the individual
+ * ``UA_ServerConfig_addSecurityPolicy*`` functions and their endpoints with
+ * ``UA_ServerConfig_addEndpoint``.
+ *
  * @param config The configuration to manipulate
  * @param certificate The server certificate.
  * @param privateKey The private key that corresponds to the certificate.
@@ -210,7 +210,7 @@ const UA_ConnectionConfig UA_ConnectionConfig_default = {
 #define APPLICATION_URI "urn:unconfigured:application"
 #define APPLICATION_URI_SERVER "urn:open62541.server.application"
 
-#define SECURITY_POLICY_SIZE 6
+#define SECURITY_POLICY_SIZE 7
 
 #define STRINGIFY(arg) #arg
 #define VERSION(MAJOR, MINOR, PATCH, LABEL) \
@@ -832,6 +832,42 @@ UA_ServerConfig_addSecurityPolicyAes256Sha256RsaPss(UA_ServerConfig *config,
     return UA_STATUSCODE_GOOD;
 }
 
+#if defined(UA_ENABLE_ENCRYPTION_OPENSSL) || defined(UA_ENABLE_ENCRYPTION_LIBRESSL)
+UA_EXPORT UA_StatusCode
+UA_ServerConfig_addSecurityPolicyEccNistP256(UA_ServerConfig *config,
+                                             const UA_ByteString *certificate,
+                                             const UA_ByteString *privateKey) {
+    /* Allocate the SecurityPolicies */
+    UA_SecurityPolicy *tmp = (UA_SecurityPolicy *)
+        UA_realloc(config->securityPolicies,
+                   sizeof(UA_SecurityPolicy) * (1 + config->securityPoliciesSize));
+    if(!tmp)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    config->securityPolicies = tmp;
+
+    /* Populate the SecurityPolicies */
+    UA_ByteString localCertificate = UA_BYTESTRING_NULL;
+    UA_ByteString localPrivateKey  = UA_BYTESTRING_NULL;
+    if(certificate)
+        localCertificate = *certificate;
+    if(privateKey)
+        localPrivateKey = *privateKey;
+    UA_StatusCode retval =
+        UA_SecurityPolicy_EccNistP256(&config->securityPolicies[config->securityPoliciesSize],
+                                      localCertificate, localPrivateKey, config->logging);
+    if(retval != UA_STATUSCODE_GOOD) {
+        if(config->securityPoliciesSize == 0) {
+            UA_free(config->securityPolicies);
+            config->securityPolicies = NULL;
+        }
+        return retval;
+    }
+
+    config->securityPoliciesSize++;
+    return UA_STATUSCODE_GOOD;
+}
+#endif
+
 /* Always returns UA_STATUSCODE_GOOD. Logs a warning if policies could not be added. */
 static UA_StatusCode
 addAllSecurityPolicies(UA_ServerConfig *config, const UA_ByteString *certificate,
@@ -872,31 +908,56 @@ addAllSecurityPolicies(UA_ServerConfig *config, const UA_ByteString *certificate
     if(keySuccess != UA_STATUSCODE_GOOD)
         return keySuccess;
 
-    /* Basic256Sha256 */
-    retval = UA_ServerConfig_addSecurityPolicyBasic256Sha256(config, &localCertificate,
-                                                             &decryptedPrivateKey);
-    if(retval != UA_STATUSCODE_GOOD) {
+    /* The RSA policies are skipped if the certificate has an ECC key */
+    UA_Boolean eccKey = false;
+
+#if defined(UA_ENABLE_ENCRYPTION_OPENSSL) || defined(UA_ENABLE_ENCRYPTION_LIBRESSL)
+    /* EccNistP256. Fails with BadCertificateInvalid for non-ECC keys. */
+    retval = UA_ServerConfig_addSecurityPolicyEccNistP256(config, &localCertificate,
+                                                          &decryptedPrivateKey);
+    if(retval == UA_STATUSCODE_GOOD) {
+        eccKey = true;
         UA_LOG_WARNING(config->logging, UA_LOGCATEGORY_USERLAND,
-                       "Could not add SecurityPolicy#Basic256Sha256 with error code %s",
+                       "The certificate has an ECC key. The RSA SecurityPolicies "
+                       "are not added and peers that only support RSA cannot "
+                       "connect securely. Add them with an RSA certificate "
+                       "to keep them.");
+    } else if(retval != UA_STATUSCODE_BADCERTIFICATEINVALID &&
+              retval != UA_STATUSCODE_BADINVALIDARGUMENT &&
+              retval != UA_STATUSCODE_BADNOTSUPPORTED) {
+        UA_LOG_WARNING(config->logging, UA_LOGCATEGORY_USERLAND,
+                       "Could not add SecurityPolicy#ECC_nistP256 with error code %s",
                        UA_StatusCode_name(retval));
     }
+#endif
 
-    /* Aes256Sha256RsaPss */
-    retval = UA_ServerConfig_addSecurityPolicyAes256Sha256RsaPss(config, &localCertificate,
+    if(!eccKey) {
+        /* Basic256Sha256 */
+        retval = UA_ServerConfig_addSecurityPolicyBasic256Sha256(config, &localCertificate,
                                                                  &decryptedPrivateKey);
-    if(retval != UA_STATUSCODE_GOOD) {
-        UA_LOG_WARNING(config->logging, UA_LOGCATEGORY_USERLAND,
-                       "Could not add SecurityPolicy#Aes256Sha256RsaPss with error code %s",
-                       UA_StatusCode_name(retval));
-    }
+        if(retval != UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING(config->logging, UA_LOGCATEGORY_USERLAND,
+                           "Could not add SecurityPolicy#Basic256Sha256 with error code %s",
+                           UA_StatusCode_name(retval));
+        }
 
-    /* Aes128Sha256RsaOaep */
-    retval = UA_ServerConfig_addSecurityPolicyAes128Sha256RsaOaep(config, &localCertificate,
-                                                                  &decryptedPrivateKey);
-    if(retval != UA_STATUSCODE_GOOD) {
-        UA_LOG_WARNING(config->logging, UA_LOGCATEGORY_USERLAND,
-                       "Could not add SecurityPolicy#Aes128Sha256RsaOaep with error code %s",
-                       UA_StatusCode_name(retval));
+        /* Aes256Sha256RsaPss */
+        retval = UA_ServerConfig_addSecurityPolicyAes256Sha256RsaPss(config, &localCertificate,
+                                                                     &decryptedPrivateKey);
+        if(retval != UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING(config->logging, UA_LOGCATEGORY_USERLAND,
+                           "Could not add SecurityPolicy#Aes256Sha256RsaPss with error code %s",
+                           UA_StatusCode_name(retval));
+        }
+
+        /* Aes128Sha256RsaOaep */
+        retval = UA_ServerConfig_addSecurityPolicyAes128Sha256RsaOaep(config, &localCertificate,
+                                                                      &decryptedPrivateKey);
+        if(retval != UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING(config->logging, UA_LOGCATEGORY_USERLAND,
+                           "Could not add SecurityPolicy#Aes128Sha256RsaOaep with error code %s",
+                           UA_StatusCode_name(retval));
+        }
     }
 
     if(onlySecure) {
@@ -913,22 +974,24 @@ addAllSecurityPolicies(UA_ServerConfig *config, const UA_ByteString *certificate
                        UA_StatusCode_name(retval));
     }
 
-    /* Basic128Rsa15 */
-    retval = UA_ServerConfig_addSecurityPolicyBasic128Rsa15(config, &localCertificate,
-                                                            &decryptedPrivateKey);
-    if(retval != UA_STATUSCODE_GOOD) {
-        UA_LOG_WARNING(config->logging, UA_LOGCATEGORY_USERLAND,
-                       "Could not add SecurityPolicy#Basic128Rsa15 with error code %s",
-                       UA_StatusCode_name(retval));
-    }
+    if(!eccKey) {
+        /* Basic128Rsa15 */
+        retval = UA_ServerConfig_addSecurityPolicyBasic128Rsa15(config, &localCertificate,
+                                                                &decryptedPrivateKey);
+        if(retval != UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING(config->logging, UA_LOGCATEGORY_USERLAND,
+                           "Could not add SecurityPolicy#Basic128Rsa15 with error code %s",
+                           UA_StatusCode_name(retval));
+        }
 
-    /* Basic256 */
-    retval = UA_ServerConfig_addSecurityPolicyBasic256(config, &localCertificate,
-                                                       &decryptedPrivateKey);
-    if(retval != UA_STATUSCODE_GOOD) {
-        UA_LOG_WARNING(config->logging, UA_LOGCATEGORY_USERLAND,
-                       "Could not add SecurityPolicy#Basic256 with error code %s",
-                       UA_StatusCode_name(retval));
+        /* Basic256 */
+        retval = UA_ServerConfig_addSecurityPolicyBasic256(config, &localCertificate,
+                                                           &decryptedPrivateKey);
+        if(retval != UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING(config->logging, UA_LOGCATEGORY_USERLAND,
+                           "Could not add SecurityPolicy#Basic256 with error code %s",
+                           UA_StatusCode_name(retval));
+        }
     }
 
     UA_ByteString_memZero(&decryptedPrivateKey);
@@ -1207,6 +1270,29 @@ UA_ClientConfig_setDefaultEncryption(UA_ClientConfig *config,
     if(keySuccess != UA_STATUSCODE_GOOD)
         return keySuccess;
 
+#if defined(UA_ENABLE_ENCRYPTION_OPENSSL) || defined(UA_ENABLE_ENCRYPTION_LIBRESSL)
+    /* With an ECC certificate only the ECC policy can be used */
+    retval = UA_SecurityPolicy_EccNistP256(&config->securityPolicies[config->securityPoliciesSize],
+                                           localCertificate, decryptedPrivateKey, config->logging);
+    if(retval == UA_STATUSCODE_GOOD) {
+        ++config->securityPoliciesSize;
+        UA_LOG_WARNING(config->logging, UA_LOGCATEGORY_USERLAND,
+                       "The certificate has an ECC key. Only the SecurityPolicy "
+                       "ECC_nistP256 is added and servers that only support RSA "
+                       "cannot be connected securely.");
+        UA_ByteString_memZero(&decryptedPrivateKey);
+        UA_ByteString_clear(&decryptedPrivateKey);
+        return UA_STATUSCODE_GOOD;
+    }
+    if(retval != UA_STATUSCODE_BADCERTIFICATEINVALID &&
+       retval != UA_STATUSCODE_BADINVALIDARGUMENT &&
+       retval != UA_STATUSCODE_BADNOTSUPPORTED) {
+        UA_LOG_WARNING(config->logging, UA_LOGCATEGORY_USERLAND,
+                       "Could not add SecurityPolicy#ECC_nistP256 with error code %s",
+                       UA_StatusCode_name(retval));
+    }
+#endif
+
     retval = UA_SecurityPolicy_Basic128Rsa15(&config->securityPolicies[config->securityPoliciesSize],
                                              localCertificate, decryptedPrivateKey, config->logging);
     if(retval == UA_STATUSCODE_GOOD) {
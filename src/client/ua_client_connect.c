@@ -278,6 +278,14 @@ encryptUserIdentityToken(UA_Client *client, const UA_String *userTokenSecurityPo
         return UA_STATUSCODE_BADSECURITYPOLICYREJECTED;
     }
 
+    /* The ECC policies cannot encrypt with the server certificate. Never send
+     * the secret unencrypted. */
+    if(!sp->asymmetricModule.cryptoModule.encryptionAlgorithm.encrypt) {
+        UA_LOG_WARNING(client->config.logging, UA_LOGCATEGORY_NETWORK,
+                       "The SecurityPolicy for the UserToken cannot encrypt the secret");
+        return UA_STATUSCODE_BADSECURITYPOLICYREJECTED;
+    }
+
     /* Create a temp channel context */
 
     void *channelContext;
@@ -572,11 +580,14 @@ processOPNResponse(UA_Client *client, const UA_ByteString *message) {
 
     /* Response.securityToken.revisedLifetime is UInt32 we need to cast it to
      * DateTime=Int64 we take 75% of lifetime to start renewing as described in
-     * standard */
+     * standard. The renewal is moved forward by a random 0-5% of the lifetime.
+     * So the renewals of many channels opened at the same time (e.g. after a
+     * server restart) spread out instead of arriving in synchronized bursts. */
     UA_EventLoop *el = client->config.eventLoop;
+    UA_Double renewFactor = 0.75 - 0.05 * ((UA_Double)UA_UInt32_random() / UA_UINT32_MAX);
     client->nextChannelRenewal = el->dateTime_nowMonotonic(el)
             + (UA_DateTime) (response.securityToken.revisedLifetime
-                    * (UA_Double) UA_DATETIME_MSEC * 0.75);
+                    * (UA_Double) UA_DATETIME_MSEC * renewFactor);
 
     /* Move the nonce out of the response */
     UA_ByteString_clear(&client->channel.remoteNonce);
@@ -28,6 +28,10 @@
 #include <ua_pubsub_keystorage.h>
 #endif
 
+#ifdef UA_ENABLE_PUBSUB_BUFMALLOC
+#include "ua_pubsub_bufmalloc.h"
+#endif
+
 /**
  * PubSub State Machine
  * --------------------
@@ -108,12 +112,84 @@ typedef struct UA_SecurityGroup UA_SecurityGroup;
 const char *
 UA_PubSubState_name(UA_PubSubState state);
 
+/**********************************************/
+/*              Component Index               */
+/**********************************************/
+
+/* All PubSub components are indexed by their NodeId identifier in the
+ * PubSubManager. So that they can be found without walking the nested lists.
+ * The index entry is embedded in the component. It points to the identifier
+ * of the component, which must not change while the component is indexed. */
+
+typedef enum {
+    UA_PUBSUBINDEX_CONNECTION = 0,
+    UA_PUBSUBINDEX_WRITERGROUP,
+    UA_PUBSUBINDEX_DATASETWRITER,
+    UA_PUBSUBINDEX_READERGROUP,
+    UA_PUBSUBINDEX_DATASETREADER,
+    UA_PUBSUBINDEX_PUBLISHEDDATASET,
+    UA_PUBSUBINDEX_DATASETFIELD,
+    UA_PUBSUBINDEX_SUBSCRIBEDDATASET,
+    UA_PUBSUBINDEX_SECURITYGROUP
+} UA_PubSubIndexType;
+
+typedef struct UA_PubSubIndexEntry {
+    ZIP_ENTRY(UA_PubSubIndexEntry) treeEntry;
+    UA_UInt32 idHash;
+    UA_PubSubIndexType type;
+    const UA_NodeId *identifier;
+    void *component; /* NULL if not indexed */
+} UA_PubSubIndexEntry;
+
+typedef ZIP_HEAD(UA_PubSubIndex, UA_PubSubIndexEntry) UA_PubSubIndex;
+
+/**********************************************/
+/*           Unlocked RT Processing           */
+/**********************************************/
+
+/* Frozen RT WriterGroups and ReaderGroups with the rtThread option are
+ * processed without taking the server lock. The handshake uses an atomic
+ * pointer that is either NULL (stopped), enabled or running. The (locked)
+ * server stops the unlocked processing before it changes the state or the
+ * configuration and waits for a running callback to leave. The locked
+ * callbacks re-enable the unlocked processing once it is possible again. */
+typedef void * volatile UA_PubSubRTLock;
+
+/* Returns true if the unlocked processing can be done. Then _leave has to be
+ * called afterwards. */
+UA_Boolean
+UA_PubSubRTLock_enter(UA_PubSubRTLock *lock);
+
+/* Stay enabled or stop the unlocked processing (e.g. after an error that has
+ * to be handled with the server lock) */
+void
+UA_PubSubRTLock_leave(UA_PubSubRTLock *lock, UA_Boolean keepEnabled);
+
+/* Returns true inside the unlocked processing */
+UA_Boolean
+UA_PubSubRTLock_isRunning(UA_PubSubRTLock *lock);
+
+/* The following are called with the server lock */
+void
+UA_PubSubRTLock_enable(UA_PubSubRTLock *lock);
+
+void
+UA_PubSubRTLock_stop(UA_PubSubRTLock *lock);
+
+/**********************************************/
+/*             Timing Statistics              */
+/**********************************************/
+
+void
+UA_PubSubHistogram_add(UA_PubSubHistogram *h, UA_DateTime duration);
+
 /**********************************************/
 /*            PublishedDataSet                */
 /**********************************************/
 
 typedef struct UA_PublishedDataSet {
     TAILQ_ENTRY(UA_PublishedDataSet) listEntry;
+    UA_PubSubIndexEntry indexEntry;
     TAILQ_HEAD(, UA_DataSetField) fields;
     UA_NodeId identifier;
     UA_String logIdString;
@@ -122,6 +198,10 @@ typedef struct UA_PublishedDataSet {
     UA_UInt16 fieldSize;
     UA_UInt16 promotedFieldsCount;
     UA_UInt16 configurationFreezeCounter;
+
+    /* The source nodes of the fields are resolved before the first sample and
+     * again after the fields have changed */
+    UA_Boolean sourcesResolved;
 } UA_PublishedDataSet;
 
 UA_StatusCode
@@ -153,6 +233,7 @@ getPublishedDataSetConfig(UA_Server *server, const UA_NodeId pds,
 typedef struct UA_StandaloneSubscribedDataSet{
     UA_StandaloneSubscribedDataSetConfig config;
     UA_NodeId identifier;
+    UA_PubSubIndexEntry indexEntry;
     TAILQ_ENTRY(UA_StandaloneSubscribedDataSet) listEntry;
     UA_NodeId connectedReader;
 } UA_StandaloneSubscribedDataSet;
@@ -197,6 +278,7 @@ typedef struct UA_PubSubConnection {
 
     TAILQ_ENTRY(UA_PubSubConnection) listEntry;
     UA_NodeId identifier;
+    UA_PubSubIndexEntry indexEntry;
     UA_String logIdString;
 
     /* The send/recv connections are only opened if the state is operational */
@@ -225,6 +307,10 @@ typedef struct UA_PubSubConnection {
 
     UA_UInt16 configurationFreezeCounter;
 
+    /* Received messages are processed without the server lock if all
+     * ReaderGroups are frozen RT ReaderGroups with the rtThread option */
+    UA_PubSubRTLock rtReadLock;
+
     UA_Boolean deleteFlag; /* To be deleted - in addition to the PubSubState */
     UA_DelayedCallback dc; /* For delayed freeing */
 } UA_PubSubConnection;
@@ -256,6 +342,16 @@ void
 UA_PubSubConnection_process(UA_Server *server, UA_PubSubConnection *c,
                             UA_ByteString msg);
 
+/* Process a received message without the server lock. Returns false if that
+ * is not possible and the message has to be processed with the lock. */
+UA_Boolean
+UA_PubSubConnection_processRT(UA_Server *server, UA_PubSubConnection *c,
+                              UA_ByteString msg);
+
+/* Re-enable the unlocked processing if all ReaderGroups support it. Call with
+ * the server lock after a message was processed. */
+void
+UA_PubSubConnection_enableRT(UA_Server *server, UA_PubSubConnection *c);
 
 void
 UA_PubSubConnection_disconnect(UA_PubSubConnection *c);
@@ -304,9 +400,12 @@ typedef struct UA_DataSetWriter {
     UA_DataSetWriterConfig config;
     LIST_ENTRY(UA_DataSetWriter) listEntry;
     UA_NodeId identifier;
+    UA_PubSubIndexEntry indexEntry;
     UA_String logIdString;
     UA_WriterGroup *linkedWriterGroup;
     UA_NodeId connectedDataSet;
+    UA_PublishedDataSet *connectedPDS; /* NULL for heartbeat writers. The
+                                        * writer is removed with the PDS. */
     UA_ConfigurationVersionDataType connectedDataSetVersion;
     UA_PubSubState state;
 
@@ -314,6 +413,8 @@ typedef struct UA_DataSetWriter {
     UA_UInt16 deltaFrameCounter; /* count of sent deltaFrames */
     size_t lastSamplesCount;
     UA_DataSetWriterSample *lastSamples;
+    UA_DataValue *deltaSamples; /* Sampled values of the next DeltaFrame.
+                                 * Same size as lastSamples. */
 
     UA_UInt16 actualDataSetMessageSequenceCount;
     UA_Boolean configurationFrozen;
@@ -382,11 +483,17 @@ UA_DataSetWriter_remove(UA_Server *server, UA_DataSetWriter *dataSetWriter);
 /*               WriterGroup                  */
 /**********************************************/
 
+/* Number of network buffers that are kept for the (unencrypted) RT publishing.
+ * The fixed-size message is patched directly in the network buffer and sent
+ * without copying. Round-robin to not touch the buffer sent last. */
+#define UA_PUBSUB_RT_SENDBUFFERS 2
+
 struct UA_WriterGroup {
     UA_PubSubComponentEnumType componentType;
     UA_WriterGroupConfig config;
     LIST_ENTRY(UA_WriterGroup) listEntry;
     UA_NodeId identifier;
+    UA_PubSubIndexEntry indexEntry;
     UA_String logIdString;
 
     LIST_HEAD(, UA_DataSetWriter) writers;
@@ -396,9 +503,32 @@ struct UA_WriterGroup {
     UA_PubSubState state;
     UA_NetworkMessageOffsetBuffer bufferedMessage;
     UA_UInt16 sequenceNumber; /* Increased after every succressuly sent message */
+
+    /* Network buffers owned by the ConnectionManager with a copy of the
+     * bufferedMessage for zero-copy RT publishing. Allocated for the send
+     * channel on first use. Zero-copy is disabled if the ConnectionManager
+     * cannot keep the buffers (e.g. with a static send buffer). */
+    UA_ByteString rtSendBuffers[UA_PUBSUB_RT_SENDBUFFERS];
+    uintptr_t rtSendChannel;
+    size_t rtSendBufferIndex;
+    UA_Boolean rtZeroCopyDisabled;
+
+    /* Value buffers of the fields in the bufferedMessage. Synced before every
+     * RT publish cycle. */
+    UA_PubSubValueBuffer **rtValueBuffers;
+    size_t rtValueBuffersSize;
+
     UA_Boolean configurationFrozen;
     UA_DateTime lastPublishTimeStamp;
 
+    /* Recorded with the timingStatistics option. The scheduled time of the
+     * next publish callback follows the cycle-miss policy of the timer. */
+    UA_WriterGroupTimingStatistics timing;
+    UA_DateTime nextPublishTime;
+
+    /* Publish without the server lock (frozen RT with the rtThread option) */
+    UA_PubSubRTLock rtLock;
+
     /* The ConnectionManager pointer is stored in the Connection. The channels
      * are either stored here or in the Connection, but never both. */
     UA_PubSubConnection *linkedConnection;
@@ -408,6 +538,7 @@ struct UA_WriterGroup {
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
     UA_UInt32 securityTokenId;
     UA_UInt32 nonceSequenceNumber; /* To be part of the MessageNonce */
+    UA_UInt64 nonceCounter; /* MessageNonce of the AEAD policies */
     void *securityPolicyContext;
 #ifdef UA_ENABLE_PUBSUB_SKS
     UA_PubSubKeyStorage *keyStorage; /* non-owning pointer to keyStorage*/
@@ -500,11 +631,17 @@ typedef struct UA_DataSetField {
     UA_DataSetFieldConfig config;
     TAILQ_ENTRY(UA_DataSetField) listEntry;
     UA_NodeId identifier;
+    UA_PubSubIndexEntry indexEntry;
     UA_NodeId publishedDataSet;     /* parent pds */
     UA_FieldMetaData fieldMetaData; /* contains the dataSetFieldId */
     UA_UInt64 sampleCallbackId;
     UA_Boolean sampleCallbackIsRegistered;
     UA_Boolean configurationFrozen;
+
+    /* Pre-resolved source node for sampling without the Read service. The node
+     * is retrieved from the Nodestore when the sources are resolved and only
+     * released when they are cleared (or the node is deleted). */
+    const UA_Node *sourceNode; /* NULL -> sample via the Read service */
 } UA_DataSetField;
 
 UA_StatusCode
@@ -526,15 +663,35 @@ void
 UA_PubSubDataSetField_sampleValue(UA_Server *server, UA_DataSetField *field,
                                   UA_DataValue *value);
 
+/* Sample all fields of the PublishedDataSet in one pass. The values array has
+ * the length fieldSize. */
+void
+UA_PublishedDataSet_sampleValues(UA_Server *server, UA_PublishedDataSet *pds,
+                                 UA_DataValue *values);
+
+/* Release the pre-resolved source node before the node is deleted */
+void
+UA_PublishedDataSet_releaseSourceNode(UA_Server *server, const UA_NodeId *nodeId);
+
 /**********************************************/
 /*               DataSetReader                */
 /**********************************************/
 
+/* Pre-resolved TargetVariable for the direct write path of non-RT readers.
+ * The node is retrieved from the Nodestore when the targets are resolved and
+ * only released when they are cleared (or the node is deleted). */
+typedef struct {
+    const UA_VariableNode *node; /* NULL -> write via the Write service */
+    const UA_DataType *type;     /* Field type from the DataSetMetaData */
+    UA_NumericRange range;       /* Parsed receiverIndexRange */
+} UA_DataSetReaderTarget;
+
 /* DataSetReader Type definition */
 typedef struct UA_DataSetReader {
     UA_PubSubComponentEnumType componentType;
     UA_DataSetReaderConfig config;
     UA_NodeId identifier;
+    UA_PubSubIndexEntry indexEntry;
     UA_String logIdString;
     UA_ReaderGroup *linkedReaderGroup;
     LIST_ENTRY(UA_DataSetReader) listEntry;
@@ -543,6 +700,17 @@ typedef struct UA_DataSetReader {
     UA_Boolean configurationFrozen;
     UA_NetworkMessageOffsetBuffer bufferedMessage;
 
+    /* Entry in the dispatch index of the ReaderGroup */
+    UA_Boolean indexed;
+    UA_UInt32 indexHash;
+    struct UA_DataSetReader *indexNext;
+
+    /* Resolved TargetVariables. Set up when the reader is enabled. Cleared
+     * when it is disabled or the TargetVariables change. */
+    UA_Boolean targetsResolved;
+    size_t targetsSize;
+    UA_DataSetReaderTarget *targets;
+
 #ifdef UA_ENABLE_PUBSUB_MONITORING
     /* MessageReceiveTimeout handling */
     UA_ServerCallback msgRcvTimeoutTimerCallback;
@@ -550,6 +718,10 @@ typedef struct UA_DataSetReader {
     UA_Boolean msgRcvTimeoutTimerRunning;
 #endif
     UA_DateTime lastHeartbeatReceived;
+
+    /* Last received DataSetMessage SequenceNumber to detect message loss */
+    UA_Boolean hasSequenceNumber;
+    UA_UInt16 lastSequenceNumber;
 } UA_DataSetReader;
 
 /* Process Network Message using DataSetReader */
@@ -563,6 +735,13 @@ UA_DataSetReader_checkIdentifier(UA_Server *server, UA_NetworkMessage *msg,
                                  UA_DataSetReader *reader,
                                  UA_ReaderGroupConfig readerGroupConfig);
 
+/* Does the reader match the PublisherId and WriterGroupId of the message and
+ * the DataSetWriterId? Used for the candidates from the dispatch index. */
+UA_Boolean
+UA_DataSetReader_matchesKey(const UA_DataSetReader *reader,
+                            const UA_NetworkMessage *msg,
+                            UA_UInt16 dataSetWriterId);
+
 UA_StatusCode
 UA_DataSetReader_create(UA_Server *server, UA_NodeId readerGroupIdentifier,
                         const UA_DataSetReaderConfig *dataSetReaderConfig,
@@ -579,6 +758,11 @@ UA_DataSetReader_decodeAndProcessRT(UA_Server *server, UA_DataSetReader *dsr,
 UA_StatusCode
 UA_DataSetReader_remove(UA_Server *server, UA_DataSetReader *dsr);
 
+/* Release the target node from the resolved TargetVariables of all readers.
+ * Called before the node is deleted. */
+void
+UA_DataSetReader_releaseTargetNode(UA_Server *server, const UA_NodeId *nodeId);
+
 /* Copy the configuration of Target Variables */
 UA_StatusCode UA_TargetVariables_copy(const UA_TargetVariables *src,
                                       UA_TargetVariables *dst);
@@ -629,16 +813,26 @@ struct UA_ReaderGroup {
     UA_PubSubComponentEnumType componentType;
     UA_ReaderGroupConfig config;
     UA_NodeId identifier;
+    UA_PubSubIndexEntry indexEntry;
     UA_String logIdString;
     LIST_ENTRY(UA_ReaderGroup) listEntry;
 
     LIST_HEAD(, UA_DataSetReader) readers;
     UA_UInt32 readersCount;
 
+    /* Hash index of the readers by (PublisherId, WriterGroupId,
+     * DataSetWriterId). Readers are dispatched in O(1) per DataSetMessage.
+     * If the index could not be allocated (NULL), all readers are checked. */
+    UA_DataSetReader **readersIndex;
+    size_t readersIndexSize; /* Number of buckets (power of two) */
+
     UA_PubSubState state;
     UA_Boolean configurationFrozen;
     UA_Boolean hasReceived; /* Received a message since the last _connect */
 
+    /* Recorded with the timingStatistics option */
+    UA_ReaderGroupTimingStatistics timing;
+
     /* The ConnectionManager pointer is stored in the Connection. The channels 
      * are either stored here or in the Connection, but never both. */
     UA_PubSubConnection *linkedConnection;
@@ -646,6 +840,12 @@ struct UA_ReaderGroup {
     size_t recvChannelsSize;
     UA_Boolean deleteFlag;
 
+#ifdef UA_ENABLE_PUBSUB_BUFMALLOC
+    /* Received messages are decoded into the arena. Reused for every
+     * message. */
+    UA_PubSubBufArena decodeArena;
+#endif
+
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
     UA_UInt32 securityTokenId;
     UA_UInt32 nonceSequenceNumber; /* To be part of the MessageNonce */
@@ -664,6 +864,34 @@ UA_ReaderGroup_create(UA_Server *server, UA_NodeId connectionId,
 UA_StatusCode
 UA_ReaderGroup_remove(UA_Server *server, UA_ReaderGroup *rg);
 
+/* Maintain the dispatch index. Called when a reader is added/removed or the
+ * identifiers in its configuration change. */
+void
+UA_ReaderGroup_indexReader(UA_ReaderGroup *rg, UA_DataSetReader *dsr);
+
+void
+UA_ReaderGroup_unindexReader(UA_ReaderGroup *rg, UA_DataSetReader *dsr);
+
+void
+UA_ReaderGroup_clearReaderIndex(UA_ReaderGroup *rg);
+
+/* Can the index be used to dispatch the message? This requires the
+ * PublisherId, WriterGroupId and the DataSetWriterIds in the headers. */
+UA_Boolean
+UA_ReaderGroup_useReaderIndex(const UA_ReaderGroup *rg, const UA_NetworkMessage *nm);
+
+/* Returns the first candidate reader in the index bucket for the
+ * DataSetMessage with the given DataSetWriterId. The candidates are chained
+ * with indexNext and must be checked with UA_DataSetReader_matchesKey. */
+UA_DataSetReader *
+UA_ReaderGroup_lookupReaders(const UA_ReaderGroup *rg, const UA_NetworkMessage *nm,
+                             UA_UInt16 dataSetWriterId);
+
+/* Is there a reader in the group for the message? */
+UA_Boolean
+UA_ReaderGroup_hasReaderForMessage(UA_Server *server, UA_ReaderGroup *rg,
+                                   UA_NetworkMessage *nm);
+
 UA_StatusCode
 UA_ReaderGroup_connect(UA_Server *server, UA_ReaderGroup *rg, UA_Boolean validate);
 
@@ -703,10 +931,35 @@ UA_Boolean
 UA_ReaderGroup_decodeAndProcessRT(UA_Server *server, UA_ReaderGroup *readerGroup,
                                     UA_ByteString *buf);
 
+/* Record the receive latency of a processed message with the timing
+ * statistics. The receive time is taken before decoding with
+ * UA_ReaderGroup_timingNow. */
+UA_DateTime
+UA_ReaderGroup_timingNow(UA_Server *server, UA_ReaderGroup *rg);
+
+void
+UA_ReaderGroup_recordReceiveLatency(UA_Server *server, UA_ReaderGroup *rg,
+                                    UA_DateTime receiveTime);
+
+/* Can received messages be processed without the server lock? */
+UA_Boolean
+UA_ReaderGroup_canProcessRT(UA_ReaderGroup *rg);
+
 UA_Boolean
 UA_ReaderGroup_process(UA_Server *server, UA_ReaderGroup *readerGroup,
                        UA_NetworkMessage *nm);
 
+/* Decode a received message for the non-RT processing. With
+ * UA_ENABLE_PUBSUB_BUFMALLOC the message is decoded into the arena of the
+ * ReaderGroup. The message must be released with
+ * UA_ReaderGroup_releaseNetworkMessage before the next message is decoded. */
+UA_StatusCode
+UA_ReaderGroup_decodeNetworkMessage(UA_Server *server, UA_ReaderGroup *rg,
+                                    UA_ByteString *buf, UA_NetworkMessage *nm);
+
+void
+UA_ReaderGroup_releaseNetworkMessage(UA_ReaderGroup *rg, UA_NetworkMessage *nm);
+
 #define UA_LOG_READERGROUP_INTERNAL(LOGGER, LEVEL, RG, MSG, ...)        \
     if(UA_LOGLEVEL <= UA_LOGLEVEL_##LEVEL) {                            \
         UA_LOG_##LEVEL(LOGGER, UA_LOGCATEGORY_PUBSUB, "%.*s" MSG "%.0s", \
@@ -760,6 +1013,7 @@ struct UA_SecurityGroup {
     UA_SecurityGroupConfig config;
     UA_PubSubKeyStorage *keyStorage;
     UA_NodeId securityGroupNodeId;
+    UA_PubSubIndexEntry indexEntry;
     UA_UInt64 callbackId;
     UA_DateTime baseTime;
 #ifdef UA_ENABLE_PUBSUB_INFORMATIONMODEL
@@ -832,6 +1086,22 @@ typedef struct UA_PubSubManager {
     size_t reserveIdsSize;
     UA_ReserveIdTree reserveIds;
 
+    /* Index of all components by their identifier */
+    UA_PubSubIndex componentIndex;
+
+    /* Number of target nodes held by the resolved TargetVariables of the
+     * DataSetReaders */
+    size_t boundTargetsSize;
+
+    /* Number of source nodes held by the resolved DataSetFields */
+    size_t boundSourcesSize;
+
+    /* Set while a configuration is applied in bulk. New groups do not trigger
+     * their connection and new components only reserve the NodeId of their
+     * information model representation. Both are done once for all components
+     * at the end of the bulk apply. */
+    UA_Boolean bulkApply;
+
 #ifdef UA_ENABLE_PUBSUB_SKS
     LIST_HEAD(, UA_PubSubKeyStorage) pubSubKeyList;
 
@@ -856,6 +1126,20 @@ UA_PubSubManager_reserveIds(UA_Server *server, UA_NodeId sessionId, UA_UInt16 nu
 void
 UA_PubSubManager_freeIds(UA_Server *server);
 
+/* Add the component to the index. The identifier has to be set. */
+void
+UA_PubSubManager_addIndex(UA_PubSubManager *psm, UA_PubSubIndexEntry *entry,
+                          UA_PubSubIndexType type, const UA_NodeId *identifier,
+                          void *component);
+
+/* Remove from the index. Does nothing if the component is not indexed. */
+void
+UA_PubSubManager_removeIndex(UA_PubSubManager *psm, UA_PubSubIndexEntry *entry);
+
+void *
+UA_PubSubManager_findIndex(UA_PubSubManager *psm, UA_PubSubIndexType type,
+                           const UA_NodeId *identifier);
+
 void
 UA_PubSubManager_init(UA_Server *server, UA_PubSubManager *pubSubManager);
 
@@ -868,6 +1152,11 @@ UA_PubSubManager_delete(UA_Server *server, UA_PubSubManager *pubSubManager);
 #ifndef UA_ENABLE_PUBSUB_INFORMATIONMODEL
 void
 UA_PubSubManager_generateUniqueNodeId(UA_PubSubManager *psm, UA_NodeId *nodeId);
+#else
+/* Reserve the NodeId for a representation that is added later on. The NodeId
+ * is neither used by a node nor by another component. */
+UA_StatusCode
+UA_PubSubManager_reserveNodeId(UA_Server *server, UA_NodeId *nodeId);
 #endif
 
 #ifdef UA_ENABLE_PUBSUB_FILE_CONFIG
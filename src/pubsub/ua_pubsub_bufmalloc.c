@@ -8,68 +8,134 @@
 #include "ua_pubsub_bufmalloc.h"
 #include <stdlib.h> /* for malloc, ...*/
 
-#define MALLOCMEMBUFSIZE 16384
+/* Every element has the memory layout [length (size_t) | buf ... ]. The header
+ * is padded to keep the returned pointers aligned. The pointer to buf is
+ * returned. */
+#define ARENA_ALIGN 8
+#define ARENA_HEADER ((sizeof(size_t) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
 
-/* If there are multiple PubSub threads the UA_MULTITHREADING build option needs to be set > 100
-    so that every thread has it's own thread-local memory buffer */
-static UA_THREAD_LOCAL char membuf[MALLOCMEMBUFSIZE];
-static UA_THREAD_LOCAL size_t pos;
+/* If there are multiple PubSub threads the UA_MULTITHREADING build option needs
+ * to be set > 100 so that every thread switches its own allocator */
+static UA_THREAD_LOCAL UA_PubSubBufArena *arena;
+static UA_THREAD_LOCAL void * (*prevMalloc)(size_t size);
+static UA_THREAD_LOCAL void (*prevFree)(void *ptr);
+static UA_THREAD_LOCAL void * (*prevCalloc)(size_t nelem, size_t elsize);
+static UA_THREAD_LOCAL void * (*prevRealloc)(void *ptr, size_t size);
 
-/* Every element has the memory layout [length (size_t) | buf (length * sizeof(char)) ... ].
- * The pointer to buf is returned. */
-static void * membufMalloc(size_t size) {
-    if(pos + size + sizeof(size_t) > MALLOCMEMBUFSIZE)
+static UA_Boolean
+inArena(const void *ptr) {
+    return ((const UA_Byte*)ptr >= arena->mem &&
+            (const UA_Byte*)ptr < &arena->mem[arena->size]);
+}
+
+static void *
+arenaAlloc(size_t size) {
+    /* Overflow of the padding or the total size */
+    if(size > SIZE_MAX - ARENA_HEADER - ARENA_ALIGN)
         return NULL;
-    char *begin = &membuf[pos];
+    size_t total = ARENA_HEADER +
+        ((size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1));
+    if(arena->required > SIZE_MAX - total)
+        arena->required = SIZE_MAX;
+    else
+        arena->required += total;
+    if(total > arena->size - arena->pos)
+        return NULL;
+    UA_Byte *begin = &arena->mem[arena->pos];
     *((size_t*)begin) = size;
-    pos += size + sizeof(size_t);
-    return &begin[sizeof(size_t)];
+    arena->pos += total;
+    return &begin[ARENA_HEADER];
+}
+
+static void *
+arenaMalloc(size_t size) {
+    void *mem = arenaAlloc(size);
+    if(!mem)
+        mem = prevMalloc(size);
+    return mem;
 }
 
-static void membufFree(void *ptr) {
-    /* Don't do anyting */
+static void
+arenaFree(void *ptr) {
+    /* Arena memory is released with the reset */
+    if(ptr && !inArena(ptr))
+        prevFree(ptr);
 }
 
-static void * membufCalloc(size_t nelem, size_t elsize) {
+static void *
+arenaCalloc(size_t nelem, size_t elsize) {
+    /* Overflow of nelem * elsize. The previous calloc reports the error. */
+    if(elsize > 0 && nelem > SIZE_MAX / elsize)
+        return prevCalloc(nelem, elsize);
     size_t total = nelem * elsize;
-    void *mem = membufMalloc(total);
+    void *mem = arenaAlloc(total);
     if(!mem)
-        return NULL;
+        return prevCalloc(nelem, elsize);
     memset(mem, 0, total);
     return mem;
 }
 
-static void * (membufRealloc)(void *ptr, size_t size) {
+static void *
+arenaRealloc(void *ptr, size_t size) {
+    if(ptr && !inArena(ptr))
+        return prevRealloc(ptr, size);
     size_t orig_size = 0;
-    if(ptr) {
-       orig_size = ((size_t*)ptr)[-1];
-    }
+    if(ptr)
+        orig_size = *(size_t*)((UA_Byte*)ptr - ARENA_HEADER);
     if(size <= orig_size)
         return ptr;
-    void *mem = membufMalloc(size);
-    if(!mem)
-        return NULL;
-    memcpy(mem, ptr, orig_size);
+    void *mem = arenaMalloc(size);
+    if(mem && ptr)
+        memcpy(mem, ptr, orig_size);
     return mem;
 }
 
-void resetMembuf(void) {
-    pos = 0;
+void
+UA_PubSubBufArena_clear(UA_PubSubBufArena *a) {
+    free(a->mem);
+    memset(a, 0, sizeof(UA_PubSubBufArena));
+}
+
+void
+UA_PubSubBufArena_reset(UA_PubSubBufArena *a) {
+    /* Grow to the size of the last use. Use the system malloc directly. The
+     * arena can be released from any allocator context. */
+    if(a->required > a->size) {
+        UA_Byte *mem = (UA_Byte*)malloc(a->required);
+        if(mem) {
+            free(a->mem);
+            a->mem = mem;
+            a->size = a->required;
+        }
+    }
+    a->pos = 0;
+    a->required = 0;
 }
 
-/* Switch to memory allocation with static array */
-void useMembufAlloc(void) {
-    pos = 0;
-    UA_mallocSingleton = membufMalloc;
-    UA_freeSingleton = membufFree;
-    UA_callocSingleton = membufCalloc;
-    UA_reallocSingleton = membufRealloc;
+void
+useArenaAlloc(UA_PubSubBufArena *a) {
+    if(!arena) {
+        prevMalloc = UA_mallocSingleton;
+        prevFree = UA_freeSingleton;
+        prevCalloc = UA_callocSingleton;
+        prevRealloc = UA_reallocSingleton;
+    }
+    arena = a;
+    UA_mallocSingleton = arenaMalloc;
+    UA_freeSingleton = arenaFree;
+    UA_callocSingleton = arenaCalloc;
+    UA_reallocSingleton = arenaRealloc;
 }
 
-/* Switch to normal memory allocation on heap */
-void useNormalAlloc(void) {
-    UA_mallocSingleton = malloc;
-    UA_freeSingleton = free;
-    UA_callocSingleton = calloc;
-    UA_reallocSingleton = realloc;
+UA_PubSubBufArena *
+useNormalAlloc(void) {
+    UA_PubSubBufArena *a = arena;
+    if(!a)
+        return NULL;
+    UA_mallocSingleton = prevMalloc;
+    UA_freeSingleton = prevFree;
+    UA_callocSingleton = prevCalloc;
+    UA_reallocSingleton = prevRealloc;
+    arena = NULL;
+    return a;
 }
@@ -9,6 +9,7 @@
 #define UA_PUBSUB_BUFMALLOC_H_
 
 #include <open62541/config.h>
+#include <open62541/types.h>
 
 _UA_BEGIN_DECLS
 
@@ -16,10 +17,33 @@ _UA_BEGIN_DECLS
     This module provides a switch for memory allocation on heap or static array
     for faster memory operations */
 
-void resetMembuf(void);
-void useMembufAlloc(void);
-void useNormalAlloc(void);
+/* Arena for decoding received messages. Every ReaderGroup owns an arena. So
+ * the arena is used by one thread at a time. The allocations are released
+ * together with _reset. Allocations that don't fit into the arena fall back to
+ * the previous allocator. The arena then grows during the next _reset to the
+ * size used by the last message. So that messages of the same layout are
+ * decoded without heap allocations. */
+typedef struct {
+    UA_Byte *mem;
+    size_t size;
+    size_t pos;
+    size_t required; /* Size required for all allocations since the last reset */
+} UA_PubSubBufArena;
+
+void UA_PubSubBufArena_clear(UA_PubSubBufArena *arena);
+
+/* Release all allocations. Grow the arena if the allocations did not fit.
+ * Must be called while the arena is not in use. */
+void UA_PubSubBufArena_reset(UA_PubSubBufArena *arena);
+
+/* Switch the memory allocation of the current thread to the arena. Frees of
+ * arena memory are ignored. Frees of other memory are forwarded. */
+void useArenaAlloc(UA_PubSubBufArena *arena);
+
+/* Switch back to the allocator before useArenaAlloc. Returns the arena that
+ * was in use (or NULL). */
+UA_PubSubBufArena * useNormalAlloc(void);
 
 _UA_END_DECLS
 
-#endif /* UA_PUBSUB_BUFMALLOC_H_ */
\ No newline at end of file
+#endif /* UA_PUBSUB_BUFMALLOC_H_ */
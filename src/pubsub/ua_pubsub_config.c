@@ -10,24 +10,32 @@
 
 #if defined(UA_ENABLE_PUBSUB) && defined(UA_ENABLE_PUBSUB_FILE_CONFIG)
 #include "pubsub/ua_pubsub.h"
+#include "pubsub/ua_pubsub_ns0.h"
 #include "server/ua_server_internal.h"
 
+/* The PublishedDataSets of the configuration sorted by their name. The
+ * DataSetWriters reference their PublishedDataSet by name. */
+typedef struct {
+    const UA_String *name;
+    const UA_NodeId *ident;
+} PdsEntry;
+
 static UA_StatusCode
 createPubSubConnection(UA_Server *server,
                        const UA_PubSubConnectionDataType *connection,
-                       UA_UInt32 pdsCount, UA_NodeId *pdsIdent);
+                       UA_UInt32 pdsCount, const PdsEntry *pds);
 
 static UA_StatusCode
 createWriterGroup(UA_Server *server,
                   const UA_WriterGroupDataType *writerGroupParameters,
                   UA_NodeId connectionIdent, UA_UInt32 pdsCount,
-                  const UA_NodeId *pdsIdent);
+                  const PdsEntry *pds);
 
 static UA_StatusCode
 createDataSetWriter(UA_Server *server,
                     const UA_DataSetWriterDataType *dataSetWriterParameters,
                     UA_NodeId writerGroupIdent, UA_UInt32 pdsCount,
-                    const UA_NodeId *pdsIdent);
+                    const PdsEntry *pds);
 
 static UA_StatusCode
 createReaderGroup(UA_Server *server,
@@ -86,7 +94,155 @@ extractPubSubConfigFromExtensionObject(UA_Server *server,
     return UA_STATUSCODE_GOOD;
 }
 
-/* Configures a PubSub Server with given PubSubConfigurationDataType object */
+static int
+cmpPdsEntry(const void *a, const void *b) {
+    const PdsEntry *ea = (const PdsEntry*)a;
+    const PdsEntry *eb = (const PdsEntry*)b;
+    return (int)UA_order(ea->name, eb->name, &UA_TYPES[UA_TYPES_STRING]);
+}
+
+/* Binary search for the PublishedDataSet with the name */
+static const PdsEntry *
+findPdsEntry(const UA_String *name, UA_UInt32 pdsCount, const PdsEntry *pds) {
+    size_t lo = 0, hi = pdsCount;
+    while(lo < hi) {
+        size_t mid = lo + ((hi - lo) / 2);
+        if(UA_order(pds[mid].name, name, &UA_TYPES[UA_TYPES_STRING]) == UA_ORDER_LESS)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if(lo < pdsCount && UA_String_equal(pds[lo].name, name))
+        return &pds[lo];
+    return NULL;
+}
+
+/* Ends the bulk apply of the configuration. The information model
+ * representation of all components is added in one pass. Then the connections
+ * and groups are enabled in a single step, now that all their DataSetWriters
+ * and DataSetReaders are configured.
+ *
+ * During the bulk apply only the NodeIds of the components were reserved. A
+ * component whose representation cannot be added is removed again (together
+ * with its children). Otherwise it keeps a NodeId without a node behind it. */
+static UA_StatusCode
+finishBulkApply(UA_Server *server) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+
+    UA_PubSubManager *psm = &server->pubSubManager;
+    psm->bulkApply = false;
+
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    UA_PubSubConnection *c;
+    UA_WriterGroup *wg;
+    UA_ReaderGroup *rg;
+
+#ifdef UA_ENABLE_PUBSUB_INFORMATIONMODEL
+    /* Parents before children. The DataSetWriters reference the nodes of their
+     * PublishedDataSets. Removing a PublishedDataSet also removes the
+     * DataSetWriters connected to it. */
+    UA_StatusCode rv;
+    UA_PublishedDataSet *pds, *pds_tmp;
+    TAILQ_FOREACH_SAFE(pds, &psm->publishedDataSets, listEntry, pds_tmp) {
+        rv = addPublishedDataItemsRepresentation(server, pds);
+        if(rv != UA_STATUSCODE_GOOD) {
+            UA_LOG_ERROR_DATASET(server->config.logging, pds,
+                                 "Adding the information model representation "
+                                 "failed with %s. Removing the PublishedDataSet.",
+                                 UA_StatusCode_name(rv));
+            UA_PublishedDataSet_remove(server, pds);
+            res |= rv;
+        }
+    }
+
+    UA_PubSubConnection *c_tmp;
+    UA_WriterGroup *wg_tmp;
+    UA_ReaderGroup *rg_tmp;
+    UA_DataSetWriter *dsw, *dsw_tmp;
+    UA_DataSetReader *dsr, *dsr_tmp;
+    TAILQ_FOREACH_SAFE(c, &psm->connections, listEntry, c_tmp) {
+        rv = addPubSubConnectionRepresentation(server, c);
+        if(rv != UA_STATUSCODE_GOOD) {
+            UA_LOG_ERROR_CONNECTION(server->config.logging, c,
+                                    "Adding the information model representation "
+                                    "failed with %s. Removing the PubSubConnection.",
+                                    UA_StatusCode_name(rv));
+            UA_PubSubConnection_delete(server, c);
+            res |= rv;
+            continue;
+        }
+
+        LIST_FOREACH_SAFE(wg, &c->writerGroups, listEntry, wg_tmp) {
+            rv = addWriterGroupRepresentation(server, wg);
+            if(rv != UA_STATUSCODE_GOOD) {
+                UA_LOG_ERROR_WRITERGROUP(server->config.logging, wg,
+                                         "Adding the information model representation "
+                                         "failed with %s. Removing the WriterGroup.",
+                                         UA_StatusCode_name(rv));
+                UA_WriterGroup_remove(server, wg);
+                res |= rv;
+                continue;
+            }
+            LIST_FOREACH_SAFE(dsw, &wg->writers, listEntry, dsw_tmp) {
+                rv = addDataSetWriterRepresentation(server, dsw);
+                if(rv != UA_STATUSCODE_GOOD) {
+                    UA_LOG_ERROR_WRITER(server->config.logging, dsw,
+                                        "Adding the information model representation "
+                                        "failed with %s. Removing the DataSetWriter.",
+                                        UA_StatusCode_name(rv));
+                    UA_DataSetWriter_remove(server, dsw);
+                    res |= rv;
+                }
+            }
+        }
+
+        LIST_FOREACH_SAFE(rg, &c->readerGroups, listEntry, rg_tmp) {
+            rv = addReaderGroupRepresentation(server, rg);
+            if(rv != UA_STATUSCODE_GOOD) {
+                UA_LOG_ERROR_READERGROUP(server->config.logging, rg,
+                                         "Adding the information model representation "
+                                         "failed with %s. Removing the ReaderGroup.",
+                                         UA_StatusCode_name(rv));
+                UA_ReaderGroup_remove(server, rg);
+                res |= rv;
+                continue;
+            }
+            LIST_FOREACH_SAFE(dsr, &rg->readers, listEntry, dsr_tmp) {
+                rv = addDataSetReaderRepresentation(server, dsr);
+                if(rv != UA_STATUSCODE_GOOD) {
+                    UA_LOG_ERROR_READER(server->config.logging, dsr,
+                                        "Adding the information model representation "
+                                        "failed with %s. Removing the DataSetReader.",
+                                        UA_StatusCode_name(rv));
+                    UA_DataSetReader_remove(server, dsr);
+                    res |= rv;
+                }
+            }
+        }
+    }
+#endif
+
+    /* Trigger the connections once for all groups and enable the groups. Skip
+     * the components whose removal above is still pending. */
+    TAILQ_FOREACH(c, &psm->connections, listEntry) {
+        if(c->deleteFlag)
+            continue;
+        UA_PubSubConnection_setPubSubState(server, c, c->state);
+        LIST_FOREACH(wg, &c->writerGroups, listEntry) {
+            if(!wg->deleteFlag)
+                UA_WriterGroup_setPubSubState(server, wg, UA_PUBSUBSTATE_OPERATIONAL);
+        }
+        LIST_FOREACH(rg, &c->readerGroups, listEntry) {
+            if(!rg->deleteFlag)
+                UA_ReaderGroup_setPubSubState(server, rg, UA_PUBSUBSTATE_OPERATIONAL);
+        }
+    }
+    return res;
+}
+
+/* Configures a PubSub Server with given PubSubConfigurationDataType object.
+ * The components are created in bulk. See finishBulkApply for the deferred
+ * steps. */
 static UA_StatusCode
 updatePubSubConfig(UA_Server *server,
                    const UA_PubSubConfigurationDataType *configurationParameters) {
@@ -100,23 +256,46 @@ updatePubSubConfig(UA_Server *server,
 
     UA_PubSubManager_delete(server, &server->pubSubManager);
 
-    /* Configuration of Published DataSets: */
     UA_UInt32 pdsCount = (UA_UInt32)configurationParameters->publishedDataSetsSize;
-    UA_NodeId *publishedDataSetIdent = (UA_NodeId*)UA_calloc(pdsCount, sizeof(UA_NodeId));
-    if(!publishedDataSetIdent)
+    PdsEntry *pds = (PdsEntry*)UA_calloc(pdsCount, sizeof(PdsEntry));
+    UA_NodeId *pdsIdent = (UA_NodeId*)UA_calloc(pdsCount, sizeof(UA_NodeId));
+    if((!pds || !pdsIdent) && pdsCount > 0) {
+        UA_free(pds);
+        UA_free(pdsIdent);
         return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    server->pubSubManager.bulkApply = true;
 
+    /* Sort the PublishedDataSets by name for the lookup from the
+     * DataSetWriters. This also checks that the names are unique. */
     UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(UA_UInt32 i = 0; i < pdsCount; i++) {
+        pds[i].name = &configurationParameters->publishedDataSets[i].name;
+        pds[i].ident = &pdsIdent[i];
+    }
+    if(pdsCount > 1)
+        qsort(pds, pdsCount, sizeof(PdsEntry), cmpPdsEntry);
+    for(UA_UInt32 i = 1; i < pdsCount; i++) {
+        if(UA_String_equal(pds[i-1].name, pds[i].name)) {
+            UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_SERVER,
+                         "[UA_PubSubManager_updatePubSubConfig] "
+                         "PublishedDataSet name %.*s is not unique",
+                         (int)pds[i].name->length, pds[i].name->data);
+            res = UA_STATUSCODE_BADBROWSENAMEDUPLICATED;
+            goto finish;
+        }
+    }
 
+    /* Configuration of Published DataSets: */
     for(UA_UInt32 i = 0; i < pdsCount; i++) {
         res = createPublishedDataSet(server,
                                      &configurationParameters->publishedDataSets[i],
-                                     &publishedDataSetIdent[i]);
+                                     &pdsIdent[i]);
         if(res != UA_STATUSCODE_GOOD) {
             UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_SERVER,
                          "[UA_PubSubManager_updatePubSubConfig] PDS creation failed");
-            UA_free(publishedDataSetIdent);
-            return res;
+            goto finish;
         }
     }
 
@@ -125,21 +304,22 @@ updatePubSubConfig(UA_Server *server,
         UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
                        "[UA_PubSubManager_updatePubSubConfig] no connection in "
                        "UA_PubSubConfigurationDataType");
-        UA_free(publishedDataSetIdent);
-        return UA_STATUSCODE_GOOD;
+        goto finish;
     }
 
     for(size_t i = 0; i < configurationParameters->connectionsSize; i++) {
         res = createPubSubConnection(server,
                                      &configurationParameters->connections[i],
-                                     pdsCount, publishedDataSetIdent);
+                                     pdsCount, pds);
         if(res != UA_STATUSCODE_GOOD)
             break;
     }
 
-    UA_free(publishedDataSetIdent);
-
-    return res;
+ finish:
+    UA_free(pds);
+    UA_free(pdsIdent);
+    UA_StatusCode finishRes = finishBulkApply(server);
+    return (res != UA_STATUSCODE_GOOD) ? res : finishRes;
 }
 
 /* Function called by UA_PubSubManager_createPubSubConnection to set the
@@ -177,14 +357,14 @@ static UA_StatusCode
 createComponentsForConnection(UA_Server *server,
                               const UA_PubSubConnectionDataType *connParams,
                               UA_NodeId connectionIdent, UA_UInt32 pdsCount,
-                              const UA_NodeId *pdsIdent) {
+                              const PdsEntry *pds) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
     /* WriterGroups configuration */
     UA_StatusCode res = UA_STATUSCODE_GOOD;
     for(size_t i = 0; i < connParams->writerGroupsSize; i++) {
         res = createWriterGroup(server, &connParams->writerGroups[i],
-                                connectionIdent, pdsCount, pdsIdent);
+                                connectionIdent, pdsCount, pds);
         if(res != UA_STATUSCODE_GOOD) {
             UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_SERVER,
                          "[UA_PubSubManager_createComponentsForConnection] "
@@ -212,10 +392,10 @@ createComponentsForConnection(UA_Server *server,
  * @param server Server object that shall be configured
  * @param connParams PubSub connection configuration
  * @param pdsCount Number of published DataSets
- * @param pdsIdent Array of NodeIds of the published DataSets */
+ * @param pds Published DataSets sorted by name */
 static UA_StatusCode
 createPubSubConnection(UA_Server *server, const UA_PubSubConnectionDataType *connParams,
-                       UA_UInt32 pdsCount, UA_NodeId *pdsIdent) {
+                       UA_UInt32 pdsCount, const PdsEntry *pds) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
     UA_PubSubConnectionConfig config;
@@ -262,7 +442,7 @@ createPubSubConnection(UA_Server *server, const UA_PubSubConnectionDataType *con
     if(res == UA_STATUSCODE_GOOD) {
         /* Configuration of all Components that belong to this connection: */
         res = createComponentsForConnection(server, connParams, connectionIdent,
-                                            pdsCount, pdsIdent);
+                                            pdsCount, pds);
     } else {
         UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_SERVER,
                      "[UA_PubSubManager_createPubSubConnection] "
@@ -310,12 +490,12 @@ setWriterGroupEncodingType(UA_Server *server,
  * @param writerGroupParameters WriterGroup configuration
  * @param connectionIdent NodeId of the PubSub connection, the WriterGroup belongs to
  * @param pdsCount Number of published DataSets
- * @param pdsIdent Array of NodeIds of the published DataSets */
+ * @param pds Published DataSets sorted by name */
 static UA_StatusCode
 createWriterGroup(UA_Server *server,
                   const UA_WriterGroupDataType *writerGroupParameters,
                   UA_NodeId connectionIdent, UA_UInt32 pdsCount,
-                  const UA_NodeId *pdsIdent) {
+                  const PdsEntry *pds) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
     UA_WriterGroupConfig config;
@@ -341,12 +521,10 @@ createWriterGroup(UA_Server *server,
         return res;
     }
 
-    /* Load config into server: */
+    /* Load config into server. The WriterGroup is enabled at the end of the
+     * bulk apply. */
     UA_NodeId writerGroupIdent;
     res = UA_WriterGroup_create(server, connectionIdent, &config, &writerGroupIdent);
-    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupIdent);
-    if(wg)
-        UA_WriterGroup_setPubSubState(server, wg, UA_PUBSUBSTATE_OPERATIONAL);
     if(res != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_SERVER,
                      "[UA_PubSubManager_createWriterGroup] "
@@ -357,7 +535,7 @@ createWriterGroup(UA_Server *server,
     /* Configuration of all DataSetWriters that belong to this WriterGroup */
     for(size_t dsw = 0; dsw < writerGroupParameters->dataSetWritersSize; dsw++) {
         res = createDataSetWriter(server, &writerGroupParameters->dataSetWriters[dsw],
-                                  writerGroupIdent, pdsCount, pdsIdent);
+                                  writerGroupIdent, pdsCount, pds);
         if(res != UA_STATUSCODE_GOOD) {
             UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_SERVER,
                          "[UA_PubSubManager_createWriterGroup] "
@@ -376,53 +554,29 @@ createWriterGroup(UA_Server *server,
  * @param writerGroupIdent NodeId of writerGroup, the DataSetWriter belongs to
  * @param dsWriterConfig WriterGroup configuration
  * @param pdsCount Number of published DataSets
- * @param pdsIdent Array of NodeIds of the published DataSets */
+ * @param pds Published DataSets sorted by name */
 static UA_StatusCode
 addDataSetWriterWithPdsReference(UA_Server *server, UA_NodeId writerGroupIdent,
                                  const UA_DataSetWriterConfig *dsWriterConfig,
-                                 UA_UInt32 pdsCount, const UA_NodeId *pdsIdent) {
+                                 UA_UInt32 pdsCount, const PdsEntry *pds) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
-    UA_NodeId dataSetWriterIdent;
-    UA_PublishedDataSetConfig pdsConfig;
-    UA_Boolean pdsFound = false;
-
-    UA_StatusCode res = UA_STATUSCODE_GOOD;
-    for(size_t pds = 0; pds < pdsCount && res == UA_STATUSCODE_GOOD; pds++) {
-        res = getPublishedDataSetConfig(server, pdsIdent[pds], &pdsConfig);
-        /* members of pdsConfig must be deleted manually */
-        if(res != UA_STATUSCODE_GOOD) {
-            UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_SERVER,
-                         "[UA_PubSubManager_addDataSetWriterWithPdsReference] "
-                         "Getting pdsConfig from NodeId failed.");
-            return res;
-        }
-
-        if(dsWriterConfig->dataSetName.length == pdsConfig.name.length &&
-           0 == strncmp((const char *)dsWriterConfig->dataSetName.data,
-                        (const char *)pdsConfig.name.data,
-                        dsWriterConfig->dataSetName.length)) {
-            /* DSWriter will only be created, if a matching PDS is found: */
-            res = UA_DataSetWriter_create(server, writerGroupIdent, pdsIdent[pds],
-                                          dsWriterConfig, &dataSetWriterIdent);
-            if(res != UA_STATUSCODE_GOOD) {
-                UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_SERVER,
-                             "[UA_PubSubManager_addDataSetWriterWithPdsReference] "
-                             "Adding DataSetWriter failed");
-            } else {
-                pdsFound = true;
-            }
-
-            UA_PublishedDataSetConfig_clear(&pdsConfig);
-            if(pdsFound)
-                break; /* break loop if corresponding publishedDataSet was found */
-        }
+    /* DSWriter will only be created, if a matching PDS is found: */
+    const PdsEntry *entry = findPdsEntry(&dsWriterConfig->dataSetName, pdsCount, pds);
+    if(!entry) {
+        UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_SERVER,
+                     "[UA_PubSubManager_addDataSetWriterWithPdsReference] "
+                     "No matching DataSet found; no DataSetWriter created");
+        return UA_STATUSCODE_GOOD;
     }
 
-    if(!pdsFound) {
+    UA_NodeId dataSetWriterIdent;
+    UA_StatusCode res = UA_DataSetWriter_create(server, writerGroupIdent, *entry->ident,
+                                                dsWriterConfig, &dataSetWriterIdent);
+    if(res != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_SERVER,
                      "[UA_PubSubManager_addDataSetWriterWithPdsReference] "
-                     "No matching DataSet found; no DataSetWriter created");
+                     "Adding DataSetWriter failed");
     }
 
     return res;
@@ -434,12 +588,12 @@ addDataSetWriterWithPdsReference(UA_Server *server, UA_NodeId writerGroupIdent,
  * @param dataSetWriterParameters DataSetWriter Configuration
  * @param writerGroupIdent NodeId of writerGroup, the DataSetWriter belongs to
  * @param pdsCount Number of published DataSets
- * @param pdsIdent Array of NodeIds of the published DataSets */
+ * @param pds Published DataSets sorted by name */
 static UA_StatusCode
 createDataSetWriter(UA_Server *server,
                     const UA_DataSetWriterDataType *dataSetWriterParameters,
                     UA_NodeId writerGroupIdent, UA_UInt32 pdsCount,
-                    const UA_NodeId *pdsIdent) {
+                    const PdsEntry *pds) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
     UA_DataSetWriterConfig config;
@@ -454,7 +608,7 @@ createDataSetWriter(UA_Server *server,
     config.dataSetWriterProperties.map = dataSetWriterParameters->dataSetWriterProperties;
 
     UA_StatusCode res = addDataSetWriterWithPdsReference(server, writerGroupIdent,
-                                                         &config, pdsCount, pdsIdent);
+                                                         &config, pdsCount, pds);
     if(res != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_SERVER,
                      "[UA_PubSubManager_createDataSetWriter] "
@@ -503,10 +657,7 @@ createReaderGroup(UA_Server *server,
         }
     }
 
-    UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, readerGroupIdent);
-    if(res == UA_STATUSCODE_GOOD && rg)
-        UA_ReaderGroup_setPubSubState(server, rg, UA_PUBSUBSTATE_OPERATIONAL);
-
+    /* The ReaderGroup is enabled at the end of the bulk apply */
     return res;
 }
 
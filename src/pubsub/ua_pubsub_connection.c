@@ -37,33 +37,35 @@ decodeNetworkMessage(UA_Server *server, UA_ByteString *buffer, size_t *pos,
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
     UA_Boolean processed = false;
     UA_ReaderGroup *readerGroup;
-    UA_DataSetReader *reader;
 
     /* Choose a correct readergroup for decrypt/verify this message
      * (there could be multiple) */
     LIST_FOREACH(readerGroup, &connection->readerGroups, listEntry) {
-        LIST_FOREACH(reader, &readerGroup->readers, listEntry) {
-            UA_StatusCode retval =
-                UA_DataSetReader_checkIdentifier(server, nm, reader, readerGroup->config);
-            if(retval != UA_STATUSCODE_GOOD)
-                continue;
-            processed = true;
-            rv = verifyAndDecryptNetworkMessage(server->config.logging, buffer, pos,
-                                                nm, readerGroup);
-            if(rv != UA_STATUSCODE_GOOD) {
-                UA_LOG_WARNING_CONNECTION(server->config.logging, connection,
-                                          "Subscribe failed, verify and decrypt "
-                                          "network message failed.");
-                UA_NetworkMessage_clear(nm);
-                return rv;
-            }
-
-            /* break out of all loops when first verify & decrypt was successful */
-            goto loops_exit;
+        if(!UA_ReaderGroup_hasReaderForMessage(server, readerGroup, nm))
+            continue;
+        processed = true;
+#ifdef UA_ENABLE_PUBSUB_BUFMALLOC
+        /* The SecurityPolicy may keep memory beyond the decoding */
+        UA_PubSubBufArena *arena = useNormalAlloc();
+#endif
+        rv = verifyAndDecryptNetworkMessage(server->config.logging, buffer, pos,
+                                            nm, readerGroup);
+#ifdef UA_ENABLE_PUBSUB_BUFMALLOC
+        if(arena)
+            useArenaAlloc(arena);
+#endif
+        if(rv != UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING_CONNECTION(server->config.logging, connection,
+                                      "Subscribe failed, verify and decrypt "
+                                      "network message failed.");
+            UA_NetworkMessage_clear(nm);
+            return rv;
         }
+
+        /* break out of the loop when first verify & decrypt was successful */
+        break;
     }
 
-loops_exit:
     if(!processed) {
         UA_LOG_INFO_CONNECTION(server->config.logging, connection,
                                "Dataset reader not found. Check PublisherId, "
@@ -131,12 +133,9 @@ UA_Server_getPubSubConnectionConfig(UA_Server *server, const UA_NodeId connectio
 
 UA_PubSubConnection *
 UA_PubSubConnection_findConnectionbyId(UA_Server *server, UA_NodeId connectionIdentifier) {
-    UA_PubSubConnection *pubSubConnection;
-    TAILQ_FOREACH(pubSubConnection, &server->pubSubManager.connections, listEntry){
-        if(UA_NodeId_equal(&connectionIdentifier, &pubSubConnection->identifier))
-            break;
-    }
-    return pubSubConnection;
+    return (UA_PubSubConnection*)
+        UA_PubSubManager_findIndex(&server->pubSubManager, UA_PUBSUBINDEX_CONNECTION,
+                                   &connectionIdentifier);
 }
 
 void
@@ -182,6 +181,8 @@ UA_PubSubConnection_create(UA_Server *server, const UA_PubSubConnectionConfig *c
     UA_PubSubManager *pubSubManager = &server->pubSubManager;
     TAILQ_INSERT_HEAD(&pubSubManager->connections, c, listEntry);
     pubSubManager->connectionsSize++;
+    UA_PubSubManager_addIndex(pubSubManager, &c->indexEntry, UA_PUBSUBINDEX_CONNECTION,
+                              &c->identifier, c);
 
     /* Cache the log string */
     UA_String idStr = UA_STRING_NULL;
@@ -296,6 +297,7 @@ UA_PubSubConnection_delete(UA_Server *server, UA_PubSubConnection *c) {
     /* Unlink from the server */
     TAILQ_REMOVE(&server->pubSubManager.connections, c, listEntry);
     server->pubSubManager.connectionsSize--;
+    UA_PubSubManager_removeIndex(&server->pubSubManager, &c->indexEntry);
 
     UA_LOG_INFO_CONNECTION(server->config.logging, c, "Connection deleted");
 
@@ -320,9 +322,25 @@ UA_Server_removePubSubConnection(UA_Server *server, const UA_NodeId connection)
     return UA_STATUSCODE_GOOD;
 }
 
+/* Receive time for the timing statistics. Zero if no ReaderGroup records
+ * them. */
+static UA_DateTime
+receiveTime(UA_Server *server, UA_PubSubConnection *c) {
+    UA_ReaderGroup *rg;
+    LIST_FOREACH(rg, &c->readerGroups, listEntry) {
+        if(rg->config.timingStatistics) {
+            UA_EventLoop *el = UA_PubSubConnection_getEL(server, c);
+            return el->dateTime_nowMonotonic(el);
+        }
+    }
+    return 0;
+}
+
 void
 UA_PubSubConnection_process(UA_Server *server, UA_PubSubConnection *c,
                             UA_ByteString msg) {
+    UA_DateTime recvTime = receiveTime(server, c);
+
     /* Process RT ReaderGroups */
     UA_ReaderGroup *rg;
     UA_Boolean processed = false;
@@ -335,7 +353,10 @@ UA_PubSubConnection_process(UA_Server *server, UA_PubSubConnection *c,
             nonRtRg = rg;
             continue;
         } 
-        processed |= UA_ReaderGroup_decodeAndProcessRT(server, rg, &msg);
+        if(UA_ReaderGroup_decodeAndProcessRT(server, rg, &msg)) {
+            UA_ReaderGroup_recordReceiveLatency(server, rg, recvTime);
+            processed = true;
+        }
     }
 
     /* Any non-RT ReaderGroups? */
@@ -343,19 +364,9 @@ UA_PubSubConnection_process(UA_Server *server, UA_PubSubConnection *c,
         goto finish;
 
     /* Decode the received message for the non-RT ReaderGroups */
-    UA_StatusCode res;
     UA_NetworkMessage nm;
-    memset(&nm, 0, sizeof(UA_NetworkMessage));
-    if(nonRtRg->config.encodingMimeType == UA_PUBSUB_ENCODING_UADP) {
-        size_t currentPosition = 0;
-        res = decodeNetworkMessage(server, &msg, &currentPosition, &nm, c);
-    } else { /* if(writerGroup->config.encodingMimeType == UA_PUBSUB_ENCODING_JSON) */
-#ifdef UA_ENABLE_JSON_ENCODING
-        res = UA_NetworkMessage_decodeJson(&nm, &msg);
-#else
-        res = UA_STATUSCODE_BADNOTSUPPORTED;
-#endif
-    }
+    UA_StatusCode res =
+        UA_ReaderGroup_decodeNetworkMessage(server, nonRtRg, &msg, &nm);
     if(res != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING_CONNECTION(server->config.logging, c,
                                   "Verify, decrypt and decode network message failed");
@@ -369,9 +380,12 @@ UA_PubSubConnection_process(UA_Server *server, UA_PubSubConnection *c,
             continue;
         if(rg->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE)
             continue;
-        processed |= UA_ReaderGroup_process(server, rg, &nm);
+        if(UA_ReaderGroup_process(server, rg, &nm)) {
+            UA_ReaderGroup_recordReceiveLatency(server, rg, recvTime);
+            processed = true;
+        }
     }
-    UA_NetworkMessage_clear(&nm);
+    UA_ReaderGroup_releaseNetworkMessage(nonRtRg, &nm);
 
  finish:
     if(!processed) {
@@ -381,6 +395,49 @@ UA_PubSubConnection_process(UA_Server *server, UA_PubSubConnection *c,
     }
 }
 
+UA_Boolean
+UA_PubSubConnection_processRT(UA_Server *server, UA_PubSubConnection *c,
+                              UA_ByteString msg) {
+    if(!UA_PubSubRTLock_enter(&c->rtReadLock))
+        return false;
+
+    /* All ReaderGroups are frozen RT ReaderGroups */
+    UA_DateTime recvTime = receiveTime(server, c);
+    UA_ReaderGroup *rg;
+    UA_Boolean processed = false;
+    LIST_FOREACH(rg, &c->readerGroups, listEntry) {
+        if(UA_ReaderGroup_decodeAndProcessRT(server, rg, &msg)) {
+            UA_ReaderGroup_recordReceiveLatency(server, rg, recvTime);
+            processed = true;
+        }
+    }
+
+    UA_PubSubRTLock_leave(&c->rtReadLock, true);
+
+    if(!processed) {
+        UA_LOG_WARNING_CONNECTION(server->config.logging, c,
+                                  "Message received that could not be processed. "
+                                  "Check PublisherID, WriterGroupID and DatasetWriterID.");
+    }
+    return true;
+}
+
+void
+UA_PubSubConnection_enableRT(UA_Server *server, UA_PubSubConnection *c) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+
+    if(c->state != UA_PUBSUBSTATE_OPERATIONAL || LIST_EMPTY(&c->readerGroups))
+        return;
+
+    UA_ReaderGroup *rg;
+    LIST_FOREACH(rg, &c->readerGroups, listEntry) {
+        if(!UA_ReaderGroup_canProcessRT(rg))
+            return;
+    }
+
+    UA_PubSubRTLock_enable(&c->rtReadLock);
+}
+
 UA_StatusCode
 UA_PubSubConnection_setPubSubState(UA_Server *server, UA_PubSubConnection *c,
                                    UA_PubSubState targetState) {
@@ -25,6 +25,19 @@ UA_DataSetField_clear(UA_DataSetField *field) {
     UA_FieldMetaData_clear(&field->fieldMetaData);
 }
 
+static void
+PublishedDataSet_clearSources(UA_Server *server, UA_PublishedDataSet *pds) {
+    UA_DataSetField *dsf;
+    TAILQ_FOREACH(dsf, &pds->fields, listEntry) {
+        if(!dsf->sourceNode)
+            continue;
+        UA_NODESTORE_RELEASE(server, dsf->sourceNode);
+        dsf->sourceNode = NULL;
+        server->pubSubManager.boundSourcesSize--;
+    }
+    pds->sourcesResolved = false;
+}
+
 UA_StatusCode
 UA_PublishedDataSetConfig_copy(const UA_PublishedDataSetConfig *src,
                                UA_PublishedDataSetConfig *dst) {
@@ -104,12 +117,9 @@ UA_Server_getPublishedDataSetMetaData(UA_Server *server, const UA_NodeId pds,
 
 UA_PublishedDataSet *
 UA_PublishedDataSet_findPDSbyId(UA_Server *server, UA_NodeId identifier) {
-    UA_PublishedDataSet *tmpPDS = NULL;
-    TAILQ_FOREACH(tmpPDS, &server->pubSubManager.publishedDataSets, listEntry) {
-        if(UA_NodeId_equal(&tmpPDS->identifier, &identifier))
-            break;
-    }
-    return tmpPDS;
+    return (UA_PublishedDataSet*)
+        UA_PubSubManager_findIndex(&server->pubSubManager,
+                                   UA_PUBSUBINDEX_PUBLISHEDDATASET, &identifier);
 }
 
 UA_PublishedDataSet *
@@ -147,6 +157,7 @@ UA_PublishedDataSetConfig_clear(UA_PublishedDataSetConfig *pdsConfig) {
 
 void
 UA_PublishedDataSet_clear(UA_Server *server, UA_PublishedDataSet *publishedDataSet) {
+    PublishedDataSet_clearSources(server, publishedDataSet);
     UA_DataSetField *field, *tmpField;
     TAILQ_FOREACH_SAFE(field, &publishedDataSet->fields, listEntry, tmpField) {
         /* Code in this block is a duplication of similar code in UA_DataSetField_remove, but
@@ -162,6 +173,7 @@ UA_PublishedDataSet_clear(UA_Server *server, UA_PublishedDataSet *publishedDataS
         field->fieldMetaData.name = UA_STRING_NULL;
         field->fieldMetaData.description.locale = UA_STRING_NULL;
         field->fieldMetaData.description.text = UA_STRING_NULL;
+        UA_PubSubManager_removeIndex(&server->pubSubManager, &field->indexEntry);
         UA_DataSetField_clear(field);
         TAILQ_REMOVE(&publishedDataSet->fields, field, listEntry);
         UA_free(field);
@@ -354,6 +366,13 @@ UA_DataSetField_create(UA_Server *server, const UA_NodeId publishedDataSet,
         return result;
     }
 
+    /* Publish the snapshot of the value buffer */
+    UA_DataSetVariableConfig *var = &newField->config.field.variable;
+    if(var->rtValueSource.valueBuffer && !var->rtValueSource.rtInformationModelNode) {
+        var->rtValueSource.rtFieldSourceEnabled = true;
+        var->rtValueSource.staticValueSource = &var->rtValueSource.valueBuffer->valuePtr;
+    }
+
     /* Initialize the field metadata. Also generates a FieldId */
     UA_FieldMetaData fmd;
     UA_FieldMetaData_init(&fmd);
@@ -387,8 +406,12 @@ UA_DataSetField_create(UA_Server *server, const UA_NodeId publishedDataSet,
     /* Register the field. The order of DataSetFields should be the same in both
      * creating and publishing. So adding DataSetFields at the the end of the
      * DataSets using the TAILQ structure. */
+    PublishedDataSet_clearSources(server, currDS);
     TAILQ_INSERT_TAIL(&currDS->fields, newField, listEntry);
     currDS->fieldSize++;
+    UA_PubSubManager_addIndex(&server->pubSubManager, &newField->indexEntry,
+                              UA_PUBSUBINDEX_DATASETFIELD, &newField->identifier,
+                              newField);
 
     if(newField->config.field.variable.promotedField)
         currDS->promotedFieldsCount++;
@@ -450,6 +473,9 @@ UA_DataSetField_remove(UA_Server *server, UA_DataSetField *currentField) {
         return result;
     }
 
+    /* Release the source nodes. They are resolved again for the next sample. */
+    PublishedDataSet_clearSources(server, pds);
+
     /* Reduce the counters before the config is cleaned up */
     if(currentField->config.field.variable.promotedField)
         pds->promotedFieldsCount--;
@@ -466,6 +492,7 @@ UA_DataSetField_remove(UA_Server *server, UA_DataSetField *currentField) {
     currentField->fieldMetaData.name = UA_STRING_NULL;
     currentField->fieldMetaData.description.locale = UA_STRING_NULL;
     currentField->fieldMetaData.description.text = UA_STRING_NULL;
+    UA_PubSubManager_removeIndex(&server->pubSubManager, &currentField->indexEntry);
     UA_DataSetField_clear(currentField);
 
     /* Remove */
@@ -560,15 +587,9 @@ UA_Server_getDataSetFieldConfig(UA_Server *server, const UA_NodeId dsf,
 
 UA_DataSetField *
 UA_DataSetField_findDSFbyId(UA_Server *server, UA_NodeId identifier) {
-    UA_PublishedDataSet *tmpPDS;
-    TAILQ_FOREACH(tmpPDS, &server->pubSubManager.publishedDataSets, listEntry) {
-        UA_DataSetField *tmpField;
-        TAILQ_FOREACH(tmpField, &tmpPDS->fields, listEntry) {
-            if(UA_NodeId_equal(&tmpField->identifier, &identifier))
-                return tmpField;
-        }
-    }
-    return NULL;
+    return (UA_DataSetField*)
+        UA_PubSubManager_findIndex(&server->pubSubManager, UA_PUBSUBINDEX_DATASETFIELD,
+                                   &identifier);
 }
 
 void
@@ -586,6 +607,10 @@ UA_PubSubDataSetField_sampleValue(UA_Server *server, UA_DataSetField *field,
                                   UA_DataValue *value) {
     UA_PublishedVariableDataType *params = &field->config.field.variable.publishParameters;
 
+    /* Take the latest snapshot from the value buffer */
+    if(field->config.field.variable.rtValueSource.valueBuffer)
+        UA_PubSubValueBuffer_sync(field->config.field.variable.rtValueSource.valueBuffer);
+
     /* Read the value */
     if(field->config.field.variable.rtValueSource.rtInformationModelNode) {
         const UA_VariableNode *rtNode = (const UA_VariableNode *)
@@ -599,14 +624,74 @@ UA_PubSubDataSetField_sampleValue(UA_Server *server, UA_DataSetField *field,
         rvid.nodeId = params->publishedVariable;
         rvid.attributeId = params->attributeId;
         rvid.indexRange = params->indexRange;
-        *value = readWithSession(server, &server->adminSession,
-                                 &rvid, UA_TIMESTAMPSTORETURN_BOTH);
+        if(field->sourceNode) {
+            /* Read from the pre-resolved node without the Nodestore lookup */
+            UA_DataValue_init(value);
+            ReadWithNode(field->sourceNode, server, &server->adminSession,
+                         UA_TIMESTAMPSTORETURN_BOTH, &rvid, value);
+        } else {
+            *value = readWithSession(server, &server->adminSession,
+                                     &rvid, UA_TIMESTAMPSTORETURN_BOTH);
+        }
     } else {
         *value = **field->config.field.variable.rtValueSource.staticValueSource;
         value->value.storageType = UA_VARIANT_DATA_NODELETE;
     }
 }
 
+/* Resolve the source nodes once instead of looking them up for every sample.
+ * Fields with an RT value source are not read from the information model. */
+static void
+PublishedDataSet_resolveSources(UA_Server *server, UA_PublishedDataSet *pds) {
+    PublishedDataSet_clearSources(server, pds);
+    pds->sourcesResolved = true;
+
+#ifndef UA_ENABLE_IMMUTABLE_NODES
+    UA_DataSetField *dsf;
+    TAILQ_FOREACH(dsf, &pds->fields, listEntry) {
+        UA_DataSetVariableConfig *var = &dsf->config.field.variable;
+        if(dsf->config.dataSetFieldType != UA_PUBSUB_DATASETFIELD_VARIABLE ||
+           var->rtValueSource.rtInformationModelNode ||
+           var->rtValueSource.rtFieldSourceEnabled)
+            continue;
+        dsf->sourceNode =
+            UA_NODESTORE_GET(server, &var->publishParameters.publishedVariable);
+        if(dsf->sourceNode)
+            server->pubSubManager.boundSourcesSize++;
+    }
+#endif
+}
+
+void
+UA_PublishedDataSet_sampleValues(UA_Server *server, UA_PublishedDataSet *pds,
+                                 UA_DataValue *values) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    if(!pds->sourcesResolved)
+        PublishedDataSet_resolveSources(server, pds);
+    size_t i = 0;
+    UA_DataSetField *dsf;
+    TAILQ_FOREACH(dsf, &pds->fields, listEntry) {
+        UA_PubSubDataSetField_sampleValue(server, dsf, &values[i]);
+        i++;
+    }
+}
+
+void
+UA_PublishedDataSet_releaseSourceNode(UA_Server *server, const UA_NodeId *nodeId) {
+    UA_PublishedDataSet *pds;
+    UA_DataSetField *dsf;
+    TAILQ_FOREACH(pds, &server->pubSubManager.publishedDataSets, listEntry) {
+        TAILQ_FOREACH(dsf, &pds->fields, listEntry) {
+            if(!dsf->sourceNode ||
+               !UA_NodeId_equal(&dsf->sourceNode->head.nodeId, nodeId))
+                continue;
+            UA_NODESTORE_RELEASE(server, dsf->sourceNode);
+            dsf->sourceNode = NULL;
+            server->pubSubManager.boundSourcesSize--;
+        }
+    }
+}
+
 UA_AddPublishedDataSetResult
 UA_PublishedDataSet_create(UA_Server *server,
                            const UA_PublishedDataSetConfig *publishedDataSetConfig,
@@ -633,7 +718,9 @@ UA_PublishedDataSet_create(UA_Server *server,
         return result;
     }
 
-    if(UA_PublishedDataSet_findPDSbyName(server, publishedDataSetConfig->name)) {
+    /* The names are checked upfront for all PDS during a bulk apply */
+    if(!server->pubSubManager.bulkApply &&
+       UA_PublishedDataSet_findPDSbyName(server, publishedDataSetConfig->name)) {
         // DataSet name has to be unique in the publisher
         UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_SERVER,
                      "PublishedDataSet creation failed. DataSet with the same name already exists.");
@@ -717,6 +804,8 @@ UA_PublishedDataSet_create(UA_Server *server,
     /* Generate unique nodeId */
     UA_PubSubManager_generateUniqueNodeId(&server->pubSubManager, &newPDS->identifier);
 #endif
+    UA_PubSubManager_addIndex(&server->pubSubManager, &newPDS->indexEntry,
+                              UA_PUBSUBINDEX_PUBLISHEDDATASET, &newPDS->identifier, newPDS);
 
     /* Cache the log string */
     UA_String idStr = UA_STRING_NULL;
@@ -774,6 +863,7 @@ UA_PublishedDataSet_remove(UA_Server *server, UA_PublishedDataSet *publishedData
 
     UA_LOG_INFO_DATASET(server->config.logging, publishedDataSet, "DataSet deleted");
 
+    UA_PubSubManager_removeIndex(&server->pubSubManager, &publishedDataSet->indexEntry);
     UA_PublishedDataSet_clear(server, publishedDataSet);
     server->pubSubManager.publishedDataSetsSize--;
 
@@ -798,13 +888,9 @@ UA_Server_removePublishedDataSet(UA_Server *server, const UA_NodeId pds) {
 
 UA_StandaloneSubscribedDataSet *
 UA_StandaloneSubscribedDataSet_findSDSbyId(UA_Server *server, UA_NodeId identifier) {
-    UA_StandaloneSubscribedDataSet *subscribedDataSet;
-    TAILQ_FOREACH(subscribedDataSet, &server->pubSubManager.subscribedDataSets,
-                  listEntry) {
-        if(UA_NodeId_equal(&identifier, &subscribedDataSet->identifier))
-            return subscribedDataSet;
-    }
-    return NULL;
+    return (UA_StandaloneSubscribedDataSet*)
+        UA_PubSubManager_findIndex(&server->pubSubManager,
+                                   UA_PUBSUBINDEX_SUBSCRIBEDDATASET, &identifier);
 }
 
 UA_StandaloneSubscribedDataSet *
@@ -850,4 +936,94 @@ UA_StandaloneSubscribedDataSet_clear(UA_Server *server,
     UA_NodeId_clear(&subscribedDataSet->connectedReader);
 }
 
+
+/*****************/
+/* Value Buffers */
+/*****************/
+
+/* The slots are aligned. The lowest bit of the middle pointer marks a value
+ * that was committed but not yet taken by the consumer. */
+#define UA_VALUEBUFFER_FRESH ((uintptr_t)0x01)
+
+/* The exchange of the middle slot publishes the slot content of the producer
+ * and acquires the slot content for the consumer. UA_atomic_xchg is only an
+ * acquire barrier with GCC/Clang (__sync_lock_test_and_set). The Interlocked
+ * functions on Windows are full barriers. */
+static void *
+valueBufferXchg(void * volatile *addr, void *newptr) {
+#if UA_MULTITHREADING >= 100 && defined(__GNUC__) && !defined(_WIN32)
+    return __atomic_exchange_n(addr, newptr, __ATOMIC_ACQ_REL);
+#else
+    return UA_atomic_xchg(addr, newptr);
+#endif
+}
+
+UA_StatusCode
+UA_PubSubValueBuffer_init(UA_PubSubValueBuffer *vb, const UA_DataValue *initial) {
+    memset(vb, 0, sizeof(UA_PubSubValueBuffer));
+    const UA_DataType *type = initial->value.type;
+    if(!type || !type->pointerFree || !UA_Variant_isScalar(&initial->value))
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    UA_StatusCode res = UA_DataValue_copy(initial, &vb->value);
+    for(size_t i = 0; i < 3; i++)
+        res |= UA_DataValue_copy(initial, &vb->slots[i]);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_PubSubValueBuffer_clear(vb);
+        return res;
+    }
+
+    vb->valuePtr = &vb->value;
+    vb->back = &vb->slots[0];
+    vb->middle = &vb->slots[1];
+    vb->front = &vb->slots[2];
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_PubSubValueBuffer_clear(UA_PubSubValueBuffer *vb) {
+    UA_DataValue_clear(&vb->value);
+    for(size_t i = 0; i < 3; i++)
+        UA_DataValue_clear(&vb->slots[i]);
+    memset(vb, 0, sizeof(UA_PubSubValueBuffer));
+}
+
+UA_DataValue *
+UA_PubSubValueBuffer_beginWrite(UA_PubSubValueBuffer *vb) {
+    return vb->back;
+}
+
+void
+UA_PubSubValueBuffer_commit(UA_PubSubValueBuffer *vb) {
+    /* Swap the written slot into the middle. Continue with the previous
+     * middle slot. It is either outdated or was released by the consumer. */
+    void *fresh = (void*)((uintptr_t)vb->back | UA_VALUEBUFFER_FRESH);
+    void *old = valueBufferXchg(&vb->middle, fresh);
+    vb->back = (UA_DataValue*)((uintptr_t)old & ~UA_VALUEBUFFER_FRESH);
+}
+
+UA_Boolean
+UA_PubSubValueBuffer_sync(UA_PubSubValueBuffer *vb) {
+    if(!((uintptr_t)vb->middle & UA_VALUEBUFFER_FRESH))
+        return false;
+
+    /* Take the fresh slot and release the previous front slot */
+    void *old = valueBufferXchg(&vb->middle, vb->front);
+    vb->front = (UA_DataValue*)((uintptr_t)old & ~UA_VALUEBUFFER_FRESH);
+
+    /* Copy into the snapshot. The data pointer of the snapshot is stable. */
+    const UA_DataValue *src = vb->front;
+    UA_Variant v = vb->value.value;
+    vb->value = *src;
+    vb->value.value = v;
+    memcpy(v.data, src->value.data, v.type->memSize);
+    return true;
+}
+
+const UA_DataValue *
+UA_PubSubValueBuffer_read(UA_PubSubValueBuffer *vb) {
+    UA_PubSubValueBuffer_sync(vb);
+    return &vb->value;
+}
+
 #endif /* UA_ENABLE_PUBSUB */
@@ -151,6 +151,11 @@ PubSubChannelCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
     UA_Server *server = (UA_Server*)application;
     UA_PubSubConnection *psc = (UA_PubSubConnection*)*connectionContext;
 
+    /* Process frozen RT ReaderGroups without the lock */
+    if(recv && msg.length > 0 && state == UA_CONNECTIONSTATE_ESTABLISHED &&
+       UA_PubSubConnection_processRT(server, psc, msg))
+        return;
+
     UA_LOCK(&server->serviceMutex);
 
     /* The connection is closing in the EventLoop. This is the last callback
@@ -194,9 +199,11 @@ PubSubChannelCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
     UA_PubSubConnection_setPubSubState(server, psc, psc->state);
 
     /* Message received */
-    if(UA_LIKELY(recv && msg.length > 0))
+    if(UA_LIKELY(recv && msg.length > 0)) {
         UA_PubSubConnection_process(server, psc, msg);
-    
+        UA_PubSubConnection_enableRT(server, psc);
+    }
+
     UA_UNLOCK(&server->serviceMutex);
 }
 
@@ -354,7 +361,7 @@ UA_PubSubConnection_connectETH(UA_Server *server, UA_PubSubConnection *c,
     /* Set up the connection parameters.
      * TDOD: Complete the considered parameters. VID, PCP, etc. */
     UA_Boolean listen = true;
-    UA_KeyValuePair kvp[4];
+    UA_KeyValuePair kvp[8];
     UA_KeyValueMap kvm = {4, kvp};
     kvp[0].key = UA_QUALIFIEDNAME(0, "address");
     UA_Variant_setScalar(&kvp[0].value, &address, &UA_TYPES[UA_TYPES_STRING]);
@@ -366,6 +373,45 @@ UA_PubSubConnection_connectETH(UA_Server *server, UA_PubSubConnection *c,
     kvp[3].key = UA_QUALIFIEDNAME(0, "validate");
     UA_Variant_setScalar(&kvp[3].value, &validate, &UA_TYPES[UA_TYPES_BOOLEAN]);
 
+    /* Forward the XDP connection properties to the EventLoop */
+    const UA_KeyValueMap *props = &c->config.connectionProperties;
+    const UA_Boolean *enableXdp = (const UA_Boolean*)
+        UA_KeyValueMap_getScalar(props, UA_QUALIFIEDNAME(0, "enableXdpSocket"),
+                                 &UA_TYPES[UA_TYPES_BOOLEAN]);
+    if(enableXdp && *enableXdp) {
+        kvp[kvm.mapSize].key = UA_QUALIFIEDNAME(0, "xdp-enable");
+        UA_Variant_setScalar(&kvp[kvm.mapSize].value, (void*)(uintptr_t)enableXdp,
+                             &UA_TYPES[UA_TYPES_BOOLEAN]);
+        kvm.mapSize++;
+        const void *xdpFlags =
+            UA_KeyValueMap_getScalar(props, UA_QUALIFIEDNAME(0, "xdpflag"),
+                                     &UA_TYPES[UA_TYPES_UINT32]);
+        if(xdpFlags) {
+            kvp[kvm.mapSize].key = UA_QUALIFIEDNAME(0, "xdp-flags");
+            UA_Variant_setScalar(&kvp[kvm.mapSize].value,
+                                 (void*)(uintptr_t)xdpFlags, &UA_TYPES[UA_TYPES_UINT32]);
+            kvm.mapSize++;
+        }
+        const void *queue =
+            UA_KeyValueMap_getScalar(props, UA_QUALIFIEDNAME(0, "hwreceivequeue"),
+                                     &UA_TYPES[UA_TYPES_UINT32]);
+        if(queue) {
+            kvp[kvm.mapSize].key = UA_QUALIFIEDNAME(0, "xdp-queue");
+            UA_Variant_setScalar(&kvp[kvm.mapSize].value,
+                                 (void*)(uintptr_t)queue, &UA_TYPES[UA_TYPES_UINT32]);
+            kvm.mapSize++;
+        }
+        const void *bindFlags =
+            UA_KeyValueMap_getScalar(props, UA_QUALIFIEDNAME(0, "xdpbindflag"),
+                                     &UA_TYPES[UA_TYPES_UINT16]);
+        if(bindFlags) {
+            kvp[kvm.mapSize].key = UA_QUALIFIEDNAME(0, "xdp-bindflags");
+            UA_Variant_setScalar(&kvp[kvm.mapSize].value,
+                                 (void*)(uintptr_t)bindFlags, &UA_TYPES[UA_TYPES_UINT16]);
+            kvm.mapSize++;
+        }
+    }
+
     /* Open recv channels */
     if(c->recvChannelsSize == 0) {
         UA_UNLOCK(&server->serviceMutex);
@@ -593,6 +639,19 @@ UA_WriterGroup_connectUDPUnicast(UA_Server *server, UA_WriterGroup *wg,
     return res;
 }
 
+/* The MQTT QoS level for the requested delivery guarantee */
+static UA_Byte
+brokerQoS(UA_BrokerTransportQualityOfService qos) {
+    switch(qos) {
+    case UA_BROKERTRANSPORTQUALITYOFSERVICE_ATLEASTONCE:
+        return 1;
+    case UA_BROKERTRANSPORTQUALITYOFSERVICE_EXACTLYONCE:
+        return 2;
+    default:
+        return 0;
+    }
+}
+
 static UA_StatusCode
 UA_WriterGroup_connectMQTT(UA_Server *server, UA_WriterGroup *wg,
                            UA_Boolean validate) {
@@ -628,8 +687,9 @@ UA_WriterGroup_connectMQTT(UA_Server *server, UA_WriterGroup *wg,
     /* Set up the connection parameters.
      * TODO: Complete the MQTT parameters. */
     UA_Boolean listen = false;
-    UA_KeyValuePair kvp[5];
-    UA_KeyValueMap kvm = {5, kvp};
+    UA_Byte qos = brokerQoS(transportSettings->requestedDeliveryGuarantee);
+    UA_KeyValuePair kvp[6];
+    UA_KeyValueMap kvm = {6, kvp};
     kvp[0].key = UA_QUALIFIEDNAME(0, "address");
     UA_Variant_setScalar(&kvp[0].value, &address, &UA_TYPES[UA_TYPES_STRING]);
     kvp[1].key = UA_QUALIFIEDNAME(0, "subscribe");
@@ -641,6 +701,8 @@ UA_WriterGroup_connectMQTT(UA_Server *server, UA_WriterGroup *wg,
                          &UA_TYPES[UA_TYPES_STRING]);
     kvp[4].key = UA_QUALIFIEDNAME(0, "validate");
     UA_Variant_setScalar(&kvp[4].value, &validate, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    kvp[5].key = UA_QUALIFIEDNAME(0, "qos");
+    UA_Variant_setScalar(&kvp[5].value, &qos, &UA_TYPES[UA_TYPES_BYTE]);
 
     /* Connect */
     UA_UNLOCK(&server->serviceMutex);
@@ -803,26 +865,17 @@ ReaderGroupChannelCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
     }
 
     /* ReaderGroup with realtime processing */
+    UA_DateTime recvTime = UA_ReaderGroup_timingNow(server, rg);
     if(rg->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
-        UA_ReaderGroup_decodeAndProcessRT(server, rg, &msg);
+        if(UA_ReaderGroup_decodeAndProcessRT(server, rg, &msg))
+            UA_ReaderGroup_recordReceiveLatency(server, rg, recvTime);
         UA_UNLOCK(&server->serviceMutex);
         return;
     }
 
     /* Decode message */
     UA_NetworkMessage nm;
-    memset(&nm, 0, sizeof(UA_NetworkMessage));
-    if(rg->config.encodingMimeType == UA_PUBSUB_ENCODING_UADP) {
-        size_t currentPosition = 0;
-        res = decodeNetworkMessage(server, &msg, &currentPosition,
-                                   &nm, rg->linkedConnection);
-    } else { /* if(writerGroup->config.encodingMimeType == UA_PUBSUB_ENCODING_JSON) */
-#ifdef UA_ENABLE_JSON_ENCODING
-        res = UA_NetworkMessage_decodeJson(&nm, &msg);
-#else
-        res = UA_STATUSCODE_BADNOTSUPPORTED;
-#endif
-    }
+    res = UA_ReaderGroup_decodeNetworkMessage(server, rg, &msg, &nm);
     if(res != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING_READERGROUP(server->config.logging, rg,
                                   "Verify, decrypt and decode network message failed");
@@ -831,8 +884,9 @@ ReaderGroupChannelCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
     }
 
     /* Process the decoded message */
-    UA_ReaderGroup_process(server, rg, &nm);
-    UA_NetworkMessage_clear(&nm);
+    if(UA_ReaderGroup_process(server, rg, &nm))
+        UA_ReaderGroup_recordReceiveLatency(server, rg, recvTime);
+    UA_ReaderGroup_releaseNetworkMessage(rg, &nm);
     UA_UNLOCK(&server->serviceMutex);
 }
 
@@ -871,8 +925,9 @@ UA_ReaderGroup_connectMQTT(UA_Server *server, UA_ReaderGroup *rg,
     /* Set up the connection parameters.
      * TODO: Complete the MQTT parameters. */
     UA_Boolean listen = true;
-    UA_KeyValuePair kvp[5];
-    UA_KeyValueMap kvm = {5, kvp};
+    UA_Byte qos = brokerQoS(transportSettings->requestedDeliveryGuarantee);
+    UA_KeyValuePair kvp[6];
+    UA_KeyValueMap kvm = {6, kvp};
     kvp[0].key = UA_QUALIFIEDNAME(0, "address");
     UA_Variant_setScalar(&kvp[0].value, &address, &UA_TYPES[UA_TYPES_STRING]);
     kvp[1].key = UA_QUALIFIEDNAME(0, "subscribe");
@@ -884,6 +939,8 @@ UA_ReaderGroup_connectMQTT(UA_Server *server, UA_ReaderGroup *rg,
                          &UA_TYPES[UA_TYPES_STRING]);
     kvp[4].key = UA_QUALIFIEDNAME(0, "validate");
     UA_Variant_setScalar(&kvp[4].value, &validate, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    kvp[5].key = UA_QUALIFIEDNAME(0, "qos");
+    UA_Variant_setScalar(&kvp[5].value, &qos, &UA_TYPES[UA_TYPES_BYTE]);
 
     /* Connect */
     UA_UNLOCK(&server->serviceMutex);
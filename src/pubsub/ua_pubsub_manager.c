@@ -20,6 +20,17 @@
 #include "ua_pubsub_keystorage.h"
 #endif
 
+#if UA_MULTITHREADING >= 100
+# ifdef _WIN32
+#  define UA_RTLOCK_YIELD() SwitchToThread()
+# else
+#  include <sched.h>
+#  define UA_RTLOCK_YIELD() sched_yield()
+# endif
+#else
+# define UA_RTLOCK_YIELD()
+#endif
+
 #define UA_DATETIMESTAMP_2000 125911584000000000
 #define UA_RESERVEID_FIRST_ID 0x8000
 
@@ -34,6 +45,77 @@ UA_PubSubState_name(UA_PubSubState state) {
     return pubSubStateNames[state];
 }
 
+/* Markers of the RT lock. NULL is stopped. */
+static char rtLockEnabledMarker;
+static char rtLockRunningMarker;
+#define UA_PUBSUB_RTLOCK_ENABLED ((void*)&rtLockEnabledMarker)
+#define UA_PUBSUB_RTLOCK_RUNNING ((void*)&rtLockRunningMarker)
+
+UA_Boolean
+UA_PubSubRTLock_enter(UA_PubSubRTLock *lock) {
+    return (UA_atomic_cmpxchg(lock, UA_PUBSUB_RTLOCK_ENABLED,
+                              UA_PUBSUB_RTLOCK_RUNNING) == UA_PUBSUB_RTLOCK_ENABLED);
+}
+
+/* Release store. The writes of the unlocked processing become visible before
+ * the lock can be taken again. */
+void
+UA_PubSubRTLock_leave(UA_PubSubRTLock *lock, UA_Boolean keepEnabled) {
+    void *state = (keepEnabled) ? UA_PUBSUB_RTLOCK_ENABLED : NULL;
+#if UA_MULTITHREADING >= 100 && defined(__GNUC__)
+    __atomic_store_n(lock, state, __ATOMIC_RELEASE);
+#else
+    UA_atomic_xchg(lock, state); /* Full barrier on Windows */
+#endif
+}
+
+UA_Boolean
+UA_PubSubRTLock_isRunning(UA_PubSubRTLock *lock) {
+    return (*lock == UA_PUBSUB_RTLOCK_RUNNING);
+}
+
+void
+UA_PubSubRTLock_enable(UA_PubSubRTLock *lock) {
+    UA_atomic_cmpxchg(lock, NULL, UA_PUBSUB_RTLOCK_ENABLED);
+}
+
+void
+UA_PubSubRTLock_stop(UA_PubSubRTLock *lock) {
+    /* Wait until a running callback has left. The unlocked processing of a
+     * fixed-size message is short and does not take the server lock. Yield
+     * between the attempts, so that the RT thread is not starved if it runs on
+     * the same core. */
+    while(UA_atomic_cmpxchg(lock, UA_PUBSUB_RTLOCK_ENABLED, NULL) ==
+          UA_PUBSUB_RTLOCK_RUNNING)
+        UA_RTLOCK_YIELD();
+}
+
+UA_DateTime
+UA_PubSubHistogram_bucketLimit(size_t bucket) {
+    if(bucket >= UA_PUBSUB_HISTOGRAM_BUCKETS - 1)
+        return UA_INT64_MAX;
+    return (UA_DateTime)UA_DATETIME_USEC << bucket;
+}
+
+void
+UA_PubSubHistogram_add(UA_PubSubHistogram *h, UA_DateTime duration) {
+    if(duration < 0)
+        duration = -duration;
+    if(h->count == 0 || duration < h->min)
+        h->min = duration;
+    if(duration > h->max)
+        h->max = duration;
+    h->count++;
+    h->sum += duration;
+
+    /* Find the bucket by halving until below one microsecond */
+    size_t bucket = 0;
+    for(UA_DateTime d = duration / UA_DATETIME_USEC;
+        d > 0 && bucket < UA_PUBSUB_HISTOGRAM_BUCKETS - 1; d >>= 1)
+        bucket++;
+    h->buckets[bucket]++;
+}
+
 static void
 UA_PubSubManager_addTopic(UA_PubSubManager *pubSubManager, UA_TopicAssign *topicAssign) {
     TAILQ_INSERT_TAIL(&pubSubManager->topicAssign, topicAssign, listEntry);
@@ -43,7 +125,7 @@ UA_PubSubManager_addTopic(UA_PubSubManager *pubSubManager, UA_TopicAssign *topic
 static UA_TopicAssign *
 UA_TopicAssign_new(UA_ReaderGroup *readerGroup,
                    UA_String topic, const UA_Logger *logger) {
-    UA_TopicAssign *topicAssign = (UA_TopicAssign *) calloc(1, sizeof(UA_TopicAssign));
+    UA_TopicAssign *topicAssign = (UA_TopicAssign *) UA_calloc(1, sizeof(UA_TopicAssign));
     if(!topicAssign) {
         UA_LOG_ERROR(logger, UA_LOGCATEGORY_SERVER,
                      "PubSub TopicAssign creation failed. Out of Memory.");
@@ -79,7 +161,7 @@ ZIP_FUNCTIONS(UA_ReserveIdTree, UA_ReserveId, treeEntry, UA_ReserveId, id, cmpRe
 static UA_ReserveId *
 UA_ReserveId_new(UA_Server *server, UA_UInt16 id, UA_String transportProfileUri,
                  UA_ReserveIdType reserveIdType, UA_NodeId sessionId) {
-    UA_ReserveId *reserveId = (UA_ReserveId *) calloc(1, sizeof(UA_ReserveId));
+    UA_ReserveId *reserveId = (UA_ReserveId *) UA_calloc(1, sizeof(UA_ReserveId));
     if(!reserveId) {
         UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_SERVER,
                      "PubSub ReserveId creation failed. Out of Memory.");
@@ -175,6 +257,54 @@ UA_ReserveId_createId(UA_Server *server,  UA_NodeId sessionId,
     return next_id;
 }
 
+/* Order by the hash first. The type is part of the key in case components of
+ * different types use the same identifier. */
+static enum ZIP_CMP
+cmpIndexEntry(const void *a, const void *b) {
+    const UA_PubSubIndexEntry *aa = (const UA_PubSubIndexEntry*)a;
+    const UA_PubSubIndexEntry *bb = (const UA_PubSubIndexEntry*)b;
+    if(aa->idHash != bb->idHash)
+        return (aa->idHash < bb->idHash) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+    if(aa->type != bb->type)
+        return (aa->type < bb->type) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+    return (enum ZIP_CMP)UA_NodeId_order(aa->identifier, bb->identifier);
+}
+
+ZIP_FUNCTIONS(UA_PubSubIndex, UA_PubSubIndexEntry, treeEntry,
+              UA_PubSubIndexEntry, treeEntry, cmpIndexEntry)
+
+void
+UA_PubSubManager_addIndex(UA_PubSubManager *psm, UA_PubSubIndexEntry *entry,
+                          UA_PubSubIndexType type, const UA_NodeId *identifier,
+                          void *component) {
+    UA_assert(!entry->component);
+    entry->idHash = UA_NodeId_hash(identifier);
+    entry->type = type;
+    entry->identifier = identifier;
+    entry->component = component;
+    ZIP_INSERT(UA_PubSubIndex, &psm->componentIndex, entry);
+}
+
+void
+UA_PubSubManager_removeIndex(UA_PubSubManager *psm, UA_PubSubIndexEntry *entry) {
+    if(!entry->component)
+        return;
+    ZIP_REMOVE(UA_PubSubIndex, &psm->componentIndex, entry);
+    entry->component = NULL;
+}
+
+void *
+UA_PubSubManager_findIndex(UA_PubSubManager *psm, UA_PubSubIndexType type,
+                           const UA_NodeId *identifier) {
+    UA_PubSubIndexEntry key;
+    key.idHash = UA_NodeId_hash(identifier);
+    key.type = type;
+    key.identifier = identifier;
+    UA_PubSubIndexEntry *entry =
+        ZIP_FIND(UA_PubSubIndex, &psm->componentIndex, &key);
+    return (entry) ? entry->component : NULL;
+}
+
 static void *
 removeReserveId(void *context, UA_ReserveId *elem) {
     UA_String_clear(&elem->transportProfileUri);
@@ -301,6 +431,9 @@ addStandaloneSubscribedDataSet(UA_Server *server,
 #else
     UA_PubSubManager_generateUniqueNodeId(&server->pubSubManager, &newSubscribedDataSet->identifier);
 #endif
+    UA_PubSubManager_addIndex(&server->pubSubManager, &newSubscribedDataSet->indexEntry,
+                              UA_PUBSUBINDEX_SUBSCRIBEDDATASET,
+                              &newSubscribedDataSet->identifier, newSubscribedDataSet);
 
     if(sdsIdentifier)
         UA_NodeId_copy(&newSubscribedDataSet->identifier, sdsIdentifier);
@@ -349,6 +482,7 @@ removeStandaloneSubscribedDataSet(UA_Server *server, const UA_NodeId sds) {
     deleteNode(server, subscribedDataSet->identifier, true);
 #endif
 
+    UA_PubSubManager_removeIndex(&server->pubSubManager, &subscribedDataSet->indexEntry);
     UA_StandaloneSubscribedDataSet_clear(server, subscribedDataSet);
     server->pubSubManager.subscribedDataSetsSize--;
 
@@ -372,6 +506,35 @@ void
 UA_PubSubManager_generateUniqueNodeId(UA_PubSubManager *psm, UA_NodeId *nodeId) {
     *nodeId = UA_NODEID_NUMERIC(1, ++psm->uniqueIdCount);
 }
+#else
+UA_StatusCode
+UA_PubSubManager_reserveNodeId(UA_Server *server, UA_NodeId *nodeId) {
+    UA_PubSubManager *psm = &server->pubSubManager;
+    while(true) {
+        UA_NodeId testId = UA_NODEID_NUMERIC(1, UA_UInt32_random());
+        if(testId.identifier.numeric == 0)
+            continue;
+
+        /* Used by a node? */
+        const UA_Node *testNode = UA_NODESTORE_GET(server, &testId);
+        if(testNode) {
+            UA_NODESTORE_RELEASE(server, testNode);
+            continue;
+        }
+
+        /* Reserved by another component? */
+        UA_Boolean reserved = false;
+        for(int type = UA_PUBSUBINDEX_CONNECTION;
+            type <= UA_PUBSUBINDEX_SECURITYGROUP && !reserved; type++)
+            reserved = (UA_PubSubManager_findIndex(psm, (UA_PubSubIndexType)type,
+                                                   &testId) != NULL);
+        if(reserved)
+            continue;
+
+        *nodeId = testId;
+        return UA_STATUSCODE_GOOD;
+    }
+}
 #endif
 
 UA_Guid
@@ -407,6 +570,7 @@ UA_PubSubManager_init(UA_Server *server, UA_PubSubManager *pubSubManager) {
     TAILQ_INIT(&pubSubManager->publishedDataSets);
     TAILQ_INIT(&pubSubManager->subscribedDataSets);
     TAILQ_INIT(&pubSubManager->topicAssign);
+    ZIP_INIT(&pubSubManager->componentIndex);
 
 #ifdef UA_ENABLE_PUBSUB_SKS
     TAILQ_INIT(&pubSubManager->securityGroups);
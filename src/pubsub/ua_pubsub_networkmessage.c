@@ -58,11 +58,163 @@ static UA_Boolean UA_NetworkMessage_ExtendedFlags1Enabled(const UA_NetworkMessag
 static UA_Boolean UA_NetworkMessage_ExtendedFlags2Enabled(const UA_NetworkMessage* src);
 static UA_Boolean UA_DataSetMessageHeader_DataSetFlags2Enabled(const UA_DataSetMessageHeader* src);
 
+/* Byte-swapping is only done for platforms that are known to be big-endian.
+ * Otherwise the non-overlayable fields are encoded for every message. */
+#if !UA_LITTLE_ENDIAN && defined(__BYTE_ORDER__) && \
+    (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+# define UA_PATCH_BYTESWAP 1
+#endif
+
+static UA_Boolean
+compilePatch(const UA_NetworkMessageOffset *nmo, UA_NetworkMessagePatch *p) {
+    const UA_DataValue *dv = &nmo->content.value;
+    const UA_DataType *type = dv->value.type;
+    if(!type || !UA_Variant_isScalar(&dv->value))
+        return false;
+
+    /* Number of bytes in the encoding before the value */
+    size_t skip = 0;
+    switch(nmo->contentType) {
+    case UA_PUBSUB_OFFSETTYPE_PAYLOAD_RAW:
+        break;
+    case UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT:
+        /* Non-builtin types are wrapped in an ExtensionObject */
+        if(type->typeKind > UA_DATATYPEKIND_DIAGNOSTICINFO)
+            return false;
+        skip = 1; /* Variant encoding mask */
+        break;
+    case UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE:
+        if(!dv->hasValue || type->typeKind > UA_DATATYPEKIND_DIAGNOSTICINFO)
+            return false;
+        skip = 2; /* DataValue and Variant encoding mask. The value is encoded
+                   * first. The status and timestamps do not change. */
+        break;
+    default:
+        return false;
+    }
+
+    /* The encoding is identical to the memory layout. Otherwise byte-swap the
+     * numerical types. */
+    UA_Byte swapSize = 0;
+    if(!type->overlayable) {
+#ifdef UA_PATCH_BYTESWAP
+        switch(type->typeKind) {
+        case UA_DATATYPEKIND_INT16:
+        case UA_DATATYPEKIND_UINT16:
+        case UA_DATATYPEKIND_INT32:
+        case UA_DATATYPEKIND_UINT32:
+        case UA_DATATYPEKIND_INT64:
+        case UA_DATATYPEKIND_UINT64:
+        case UA_DATATYPEKIND_DATETIME:
+        case UA_DATATYPEKIND_STATUSCODE:
+            swapSize = (UA_Byte)type->memSize;
+            break;
+#if UA_FLOAT_IEEE754 && !UA_FLOAT_LITTLE_ENDIAN
+        case UA_DATATYPEKIND_FLOAT:
+        case UA_DATATYPEKIND_DOUBLE:
+            swapSize = (UA_Byte)type->memSize;
+            break;
+#endif
+        default:
+            return false;
+        }
+#else
+        return false;
+#endif
+    }
+
+    p->offset = nmo->offset + skip;
+    p->length = type->memSize;
+    p->source = (const UA_Byte*)dv->value.data;
+    p->swapSize = swapSize;
+    return true;
+}
+
+UA_StatusCode
+UA_NetworkMessageOffsetBuffer_compilePatches(UA_NetworkMessageOffsetBuffer *nmob) {
+    UA_free(nmob->patches);
+    nmob->patches = NULL;
+    nmob->patchesSize = 0;
+    nmob->dynamicOffsetsSize = nmob->offsetsSize;
+    if(nmob->offsetsSize == 0)
+        return UA_STATUSCODE_GOOD;
+
+    UA_NetworkMessagePatch *patches = (UA_NetworkMessagePatch*)
+        UA_malloc(sizeof(UA_NetworkMessagePatch) * nmob->offsetsSize);
+    if(!patches)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    size_t patchesSize = 0;
+    size_t dynamic = 0;
+    for(size_t i = 0; i < nmob->offsetsSize; i++) {
+        UA_NetworkMessagePatch *p = &patches[patchesSize];
+        if(!compilePatch(&nmob->offsets[i], p) ||
+           p->offset + p->length > nmob->buffer.length) {
+            /* Encoded per message. Move to the front. */
+            UA_NetworkMessageOffset tmp = nmob->offsets[dynamic];
+            nmob->offsets[dynamic] = nmob->offsets[i];
+            nmob->offsets[i] = tmp;
+            dynamic++;
+            continue;
+        }
+
+        /* Merge with the previous patch if both the message position and the
+         * source memory are contiguous */
+        if(patchesSize > 0) {
+            UA_NetworkMessagePatch *prev = &patches[patchesSize - 1];
+            if(prev->swapSize == 0 && p->swapSize == 0 &&
+               prev->offset + prev->length == p->offset &&
+               prev->source + prev->length == p->source) {
+                prev->length += p->length;
+                continue;
+            }
+        }
+        patchesSize++;
+    }
+
+    if(patchesSize == 0) {
+        UA_free(patches);
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Shrink to the used size */
+    UA_NetworkMessagePatch *shrunk = (UA_NetworkMessagePatch*)
+        UA_realloc(patches, sizeof(UA_NetworkMessagePatch) * patchesSize);
+    if(shrunk)
+        patches = shrunk;
+    nmob->patches = patches;
+    nmob->patchesSize = patchesSize;
+    nmob->dynamicOffsetsSize = dynamic;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+applySwappedPatch(UA_Byte *dst, const UA_NetworkMessagePatch *p) {
+    for(size_t i = 0; i < p->length; i += p->swapSize) {
+        for(size_t j = 0; j < p->swapSize; j++)
+            dst[i + j] = p->source[i + p->swapSize - 1 - j];
+    }
+}
+
 UA_StatusCode
 UA_NetworkMessage_updateBufferedMessage(UA_NetworkMessageOffsetBuffer *buffer) {
+    /* Copy the fixed-size fields */
+    for(size_t i = 0; i < buffer->patchesSize; i++) {
+        const UA_NetworkMessagePatch *p = &buffer->patches[i];
+        UA_Byte *dst = &buffer->buffer.data[p->offset];
+        if(UA_LIKELY(p->swapSize == 0))
+            memcpy(dst, p->source, p->length);
+        else
+            applySwappedPatch(dst, p);
+    }
+
+    /* Encode the remaining fields */
+    size_t offsetsSize = buffer->offsetsSize;
+    if(buffer->patchesSize > 0)
+        offsetsSize = buffer->dynamicOffsetsSize;
     UA_StatusCode rv = UA_STATUSCODE_GOOD;
     const UA_Byte *bufEnd = &buffer->buffer.data[buffer->buffer.length];
-    for(size_t i = 0; i < buffer->offsetsSize; ++i) {
+    for(size_t i = 0; i < offsetsSize; ++i) {
         UA_NetworkMessageOffset *nmo = &buffer->offsets[i];
         UA_Byte *bufPos = &buffer->buffer.data[nmo->offset];
         switch(nmo->contentType) {
@@ -105,8 +257,9 @@ UA_NetworkMessage_updateBufferedNwMessage(UA_NetworkMessageOffsetBuffer *buffer,
     /* If this remains at UA_UINT32_MAX, then no raw fields are contained */
     size_t smallestRawOffset = UA_UINT32_MAX;
 
-    /* Considering one DSM in RT TODO: Clarify multiple DSM */
-    UA_DataSetMessage* dsm = nm->payload.dataSetPayload.dataSetMessages;
+    /* The offsets contain only the DataSetMessage selected for the reader */
+    UA_DataSetMessage* dsm =
+        &nm->payload.dataSetPayload.dataSetMessages[buffer->dataSetMessageIndex];
 
     size_t pos = 0;
     size_t payloadCounter = 0;
@@ -141,10 +294,13 @@ UA_NetworkMessage_updateBufferedNwMessage(UA_NetworkMessageOffsetBuffer *buffer,
         case UA_PUBSUB_OFFSETTYPE_WRITERGROUPID:
             rv = UA_UInt16_decodeBinary(src, &pos, &nm->groupHeader.writerGroupId);
             break;
-        case UA_PUBSUB_OFFSETTYPE_DATASETWRITERID:
-            rv = UA_UInt16_decodeBinary(src, &pos,
-                                        &nm->payloadHeader.dataSetPayloadHeader.dataSetWriterIds[0]); /* TODO */
+        case UA_PUBSUB_OFFSETTYPE_DATASETWRITERID: {
+            /* The DataSetWriterIds of all DataSetMessages follow each other */
+            UA_DataSetPayloadHeader *ph = &nm->payloadHeader.dataSetPayloadHeader;
+            for(UA_Byte j = 0; j < ph->count && rv == UA_STATUSCODE_GOOD; j++)
+                rv = UA_UInt16_decodeBinary(src, &pos, &ph->dataSetWriterIds[j]);
             break;
+        }
         case UA_PUBSUB_OFFSETTYPE_NETWORKMESSAGE_SEQUENCENUMBER:
             rv = UA_UInt16_decodeBinary(src, &pos, &nm->groupHeader.sequenceNumber);
             break;
@@ -1028,8 +1184,16 @@ UA_NetworkMessage_calcSizeBinary(UA_NetworkMessage *p,
             size += (size_t)(2LU * count); /* uint16 */
     }
     for(size_t i = 0; i < count; i++) {
+        /* Use the DataSetMessage sizes from the header if they are given. A
+         * decoded DataSetMessage can be padded to a configured size. */
+        size_t dsmStart = size;
         UA_DataSetMessage *dsm = &p->payload.dataSetPayload.dataSetMessages[i];
         size = UA_DataSetMessage_calcSizeBinary(dsm, offsetBuffer, size);
+        if(size == 0)
+            return 0;
+        if(count > 1 && p->payload.dataSetPayload.sizes &&
+           p->payload.dataSetPayload.sizes[i] > 0)
+            size = dsmStart + p->payload.dataSetPayload.sizes[i];
     }
 
     if(p->securityEnabled && p->securityHeader.securityFooterEnabled)
@@ -1191,6 +1355,26 @@ UA_NetworkMessage_signEncrypt(UA_NetworkMessage *nm, UA_MessageSecurityMode secu
                               UA_Byte *sigStart) {
     UA_StatusCode res = UA_STATUSCODE_GOOD;
 
+    /* Authenticated encryption in a single pass */
+    if(policy->encryptAndSign &&
+       (securityMode == UA_MESSAGESECURITYMODE_SIGN ||
+        securityMode == UA_MESSAGESECURITYMODE_SIGNANDENCRYPT)) {
+        const UA_ByteString nonce = {
+            (size_t)nm->securityHeader.messageNonceSize,
+            nm->securityHeader.messageNonce
+        };
+        res = policy->setMessageNonce(policyContext, &nonce);
+        UA_CHECK_STATUS(res, return res);
+
+        size_t sigSize = policy->symmetricModule.cryptoModule.
+            signatureAlgorithm.getLocalSignatureSize(policyContext);
+        size_t sigOffset = (uintptr_t)sigStart - (uintptr_t)messageStart;
+        size_t encOffset = (securityMode == UA_MESSAGESECURITYMODE_SIGNANDENCRYPT) ?
+            (uintptr_t)encryptStart - (uintptr_t)messageStart : sigOffset;
+        UA_ByteString message = {sigOffset + sigSize, messageStart};
+        return policy->encryptAndSign(policyContext, &message, encOffset, sigOffset);
+    }
+
     /* Encrypt the payload */
     if(securityMode == UA_MESSAGESECURITYMODE_SIGNANDENCRYPT) {
         /* Set the temporary MessageNonce in the SecurityPolicy */
@@ -1491,7 +1675,14 @@ UA_DataSetMessage_keyFrame_decodeBinary(const UA_ByteString *src, size_t *offset
         kfd->rawFields.data = &src->data[*offset];
         kfd->rawFields.length = dsmSize;
         if(dsmSize != 0) {
-            *offset += (dsmSize - (*offset - initialOffset));
+            /* The size includes the DataSetMessage header */
+            if(dsmSize < *offset - initialOffset ||
+               initialOffset + dsmSize > src->length)
+                return UA_STATUSCODE_BADDECODINGERROR;
+            kfd->rawFields.length = dsmSize - (*offset - initialOffset);
+            *offset += kfd->rawFields.length;
+            if(dsm)
+                kfd->fieldCount = (UA_UInt16)dsm->fieldsSize;
             break;
         }
 
@@ -1803,6 +1994,61 @@ UA_DataSetMessage_clear(UA_DataSetMessage* p) {
     memset(p, 0, sizeof(UA_DataSetMessage));
 }
 
+static void
+UA_NetworkMessageOffset_clear(UA_NetworkMessageOffset *offset) {
+    if(offset->contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT ||
+       offset->contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE ||
+       offset->contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_RAW) {
+        UA_DataValue_clear(&offset->content.value);
+        return;
+    }
+
+    if(offset->contentType == UA_PUBSUB_OFFSETTYPE_NETWORKMESSAGE_FIELDENCDODING) {
+        offset->content.value.value.data = NULL;
+        UA_DataValue_clear(&offset->content.value);
+    }
+}
+
+UA_StatusCode
+UA_NetworkMessageOffsetBuffer_selectDataSetMessage(UA_NetworkMessageOffsetBuffer *nmob,
+                                                   size_t dsmIndex) {
+    UA_NetworkMessage *nm = nmob->nm;
+    if(!nm)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    size_t count = 1;
+    if(nm->payloadHeaderEnabled)
+        count = nm->payloadHeader.dataSetPayloadHeader.count;
+    if(dsmIndex >= count)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    /* Every DataSetMessage begins with the FieldEncoding offset. The offsets
+     * before the first DataSetMessage belong to the NetworkMessage headers. */
+    size_t current = 0;
+    UA_Boolean inPayload = false;
+    size_t kept = 0;
+    for(size_t i = 0; i < nmob->offsetsSize; i++) {
+        UA_NetworkMessageOffset *offset = &nmob->offsets[i];
+        if(offset->contentType == UA_PUBSUB_OFFSETTYPE_NETWORKMESSAGE_FIELDENCDODING) {
+            if(inPayload)
+                current++;
+            inPayload = true;
+        }
+        if(inPayload && current != dsmIndex) {
+            UA_NetworkMessageOffset_clear(offset);
+            continue;
+        }
+        nmob->offsets[kept++] = *offset;
+    }
+    nmob->offsetsSize = kept;
+    nmob->dataSetMessageIndex = dsmIndex;
+
+    /* The raw length was computed for the last DataSetMessage */
+    UA_DataSetMessage *dsm = &nm->payload.dataSetPayload.dataSetMessages[dsmIndex];
+    if(dsm->header.fieldEncoding == UA_FIELDENCODING_RAWDATA)
+        nmob->rawMessageLength = dsm->data.keyFrameData.rawFields.length;
+    return UA_STATUSCODE_GOOD;
+}
+
 void
 UA_NetworkMessageOffsetBuffer_clear(UA_NetworkMessageOffsetBuffer *nmob) {
     UA_ByteString_clear(&nmob->buffer);
@@ -1812,27 +2058,13 @@ UA_NetworkMessageOffsetBuffer_clear(UA_NetworkMessageOffsetBuffer *nmob) {
         UA_free(nmob->nm);
     }
 
-#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
-    UA_ByteString_clear(&nmob->encryptBuffer);
-#endif
+    UA_free(nmob->patches);
 
     if(nmob->offsetsSize == 0)
         return;
 
-    for(size_t i = 0; i < nmob->offsetsSize; i++) {
-        UA_NetworkMessageOffset *offset = &nmob->offsets[i];
-        if(offset->contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT ||
-           offset->contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE ||
-           offset->contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_RAW) {
-            UA_DataValue_clear(&offset->content.value);
-            continue;
-        }
-
-        if(offset->contentType == UA_PUBSUB_OFFSETTYPE_NETWORKMESSAGE_FIELDENCDODING) {
-            offset->content.value.value.data = NULL;
-            UA_DataValue_clear(&offset->content.value);
-        }
-    }
+    for(size_t i = 0; i < nmob->offsetsSize; i++)
+        UA_NetworkMessageOffset_clear(&nmob->offsets[i]);
 
     UA_free(nmob->offsets);
 
@@ -205,23 +205,45 @@ typedef struct {
     size_t offset;
 } UA_NetworkMessageOffset;
 
+/* Fixed-size field that is patched into the message buffer with a plain copy
+ * from the memory of the value source */
+typedef struct {
+    size_t offset;         /* Position in the message buffer */
+    size_t length;         /* Number of bytes to copy */
+    const UA_Byte *source; /* Memory of the value */
+    UA_Byte swapSize;      /* Element size for byte-swapping (0: plain copy) */
+} UA_NetworkMessagePatch;
+
 typedef struct {
     UA_ByteString buffer; /* The precomputed message buffer */
     UA_NetworkMessageOffset *offsets; /* Offsets for changes in the message buffer */
     size_t offsetsSize;
+    /* Patch program for the publisher. If patches are defined, then only the
+     * first dynamicOffsetsSize offsets are encoded for every message. The
+     * offsets of the patched fields are moved to the end. */
+    UA_NetworkMessagePatch *patches;
+    size_t patchesSize;
+    size_t dynamicOffsetsSize;
     UA_NetworkMessage *nm; /* The precomputed NetworkMessage for subscriber */
     size_t rawMessageLength;
+    size_t dataSetMessageIndex; /* The DataSetMessage of the subscriber in nm */
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
-    UA_ByteString encryptBuffer; /* The precomputed message buffer is copied
-                                  * into the encrypt buffer for encryption and
-                                  * signing*/
-    UA_Byte *payloadPosition; /* Payload Position of the message to encrypt*/
+    UA_Byte *payloadPosition; /* Payload Position of the message to encrypt.
+                               * The buffer is copied into the network buffer
+                               * and encrypted/signed in place there. */
 #endif
 } UA_NetworkMessageOffsetBuffer;
 
 void
 UA_NetworkMessageOffsetBuffer_clear(UA_NetworkMessageOffsetBuffer *nmob);
 
+/* Compile the fixed-size payload fields of a publisher into a patch program.
+ * Adjacent fields with adjacent memory are merged into a single copy. Fields
+ * that cannot be patched (e.g. strings or sequence numbers) remain in the
+ * offsets and are encoded for every message. */
+UA_StatusCode
+UA_NetworkMessageOffsetBuffer_compilePatches(UA_NetworkMessageOffsetBuffer *nmob);
+
 UA_StatusCode
 UA_NetworkMessage_updateBufferedMessage(UA_NetworkMessageOffsetBuffer *buffer);
 
@@ -229,6 +251,13 @@ UA_StatusCode
 UA_NetworkMessage_updateBufferedNwMessage(UA_NetworkMessageOffsetBuffer *buffer,
                                           const UA_ByteString *src, size_t *bufferPosition);
 
+/* Reduce the offsets of a subscriber to the NetworkMessage headers and the
+ * DataSetMessage at the given index. The other DataSetMessages are skipped
+ * during the RT decoding. */
+UA_StatusCode
+UA_NetworkMessageOffsetBuffer_selectDataSetMessage(UA_NetworkMessageOffsetBuffer *nmob,
+                                                   size_t dsmIndex);
+
 /**
  * DataSetMessage
  * ^^^^^^^^^^^^^^ */
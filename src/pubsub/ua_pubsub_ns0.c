@@ -29,6 +29,15 @@ writePubSubNs0VariableArray(UA_Server *server, const UA_NodeId id, void *v,
     return writeValueAttribute(server, id, &var);
 }
 
+/* Components that are created during a bulk apply already carry a reserved
+ * NodeId when their representation is added */
+static UA_NodeId
+representationNodeId(const UA_NodeId *identifier) {
+    if(UA_NodeId_isNull(identifier))
+        return UA_NODEID_NUMERIC(1, 0); /* Generate a new id */
+    return *identifier;
+}
+
 static UA_NodeId
 findSingleChildNode(UA_Server *server, UA_QualifiedName targetName,
                     UA_NodeId referenceTypeId, UA_NodeId startingNode){
@@ -632,10 +641,13 @@ addPubSubConnectionRepresentation(UA_Server *server, UA_PubSubConnection *connec
     memcpy(connectionName, connection->config.name.data, connection->config.name.length);
     connectionName[connection->config.name.length] = '\0';
 
+    if(server->pubSubManager.bulkApply)
+        return UA_PubSubManager_reserveNodeId(server, &connection->identifier);
+
     UA_ObjectAttributes attr = UA_ObjectAttributes_default;
     attr.displayName = UA_LOCALIZEDTEXT("", connectionName);
     retVal |= addNode_begin(server, UA_NODECLASS_OBJECT,
-                            UA_NODEID_NUMERIC(1, 0), /* Generate a new id */
+                            representationNodeId(&connection->identifier),
                             UA_NODEID_NUMERIC(0, UA_NS0ID_PUBLISHSUBSCRIBE),
                             UA_NODEID_NUMERIC(0, UA_NS0ID_HASPUBSUBCONNECTION),
                             UA_QUALIFIEDNAME(0, connectionName),
@@ -874,9 +886,13 @@ addDataSetReaderRepresentation(UA_Server *server, UA_DataSetReader *dataSetReade
     UA_StatusCode retVal = UA_STATUSCODE_GOOD;
     UA_NodeId publisherIdNode, writerGroupIdNode, dataSetwriterIdNode, statusIdNode, stateIdNode;
 
+    if(server->pubSubManager.bulkApply)
+        return UA_PubSubManager_reserveNodeId(server, &dataSetReader->identifier);
+
     UA_ObjectAttributes object_attr = UA_ObjectAttributes_default;
     object_attr.displayName = UA_LOCALIZEDTEXT("", dsrName);
-    retVal = addNode(server, UA_NODECLASS_OBJECT, UA_NODEID_NUMERIC(1, 0), /* create an id */
+    retVal = addNode(server, UA_NODECLASS_OBJECT,
+                     representationNodeId(&dataSetReader->identifier),
                      dataSetReader->linkedReaderGroup->identifier,
                      UA_NODEID_NUMERIC(0, UA_NS0ID_HASDATASETREADER),
                      UA_QUALIFIEDNAME(0, dsrName),
@@ -1068,9 +1084,13 @@ addPublishedDataItemsRepresentation(UA_Server *server,
     memcpy(pdsName, publishedDataSet->config.name.data, publishedDataSet->config.name.length);
     pdsName[publishedDataSet->config.name.length] = '\0';
 
+    if(server->pubSubManager.bulkApply)
+        return UA_PubSubManager_reserveNodeId(server, &publishedDataSet->identifier);
+
     UA_ObjectAttributes object_attr = UA_ObjectAttributes_default;
     object_attr.displayName = UA_LOCALIZEDTEXT("", pdsName);
-    retVal = addNode(server, UA_NODECLASS_OBJECT, UA_NODEID_NUMERIC(1, 0), /* Create a new id */
+    retVal = addNode(server, UA_NODECLASS_OBJECT,
+                     representationNodeId(&publishedDataSet->identifier),
                      UA_NODEID_NUMERIC(0, UA_NS0ID_PUBLISHSUBSCRIBE_PUBLISHEDDATASETS),
                      UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
                      UA_QUALIFIEDNAME(0, pdsName),
@@ -1314,6 +1334,121 @@ addStandaloneSubscribedDataSetRepresentation(UA_Server *server,
     return ret;
 }
 
+/**********************************************/
+/*             Timing Statistics              */
+/**********************************************/
+
+/* The node context points to the histogram in the group */
+static UA_StatusCode
+readHistogram(UA_Server *server, const UA_NodeId *sessionId,
+              void *sessionContext, const UA_NodeId *nodeId,
+              void *nodeContext, UA_Boolean includeSourceTimeStamp,
+              const UA_NumericRange *range, UA_DataValue *value) {
+    const UA_PubSubHistogram *h = (const UA_PubSubHistogram*)nodeContext;
+    UA_StatusCode res =
+        UA_Variant_setArrayCopy(&value->value, h->buckets,
+                                UA_PUBSUB_HISTOGRAM_BUCKETS, &UA_TYPES[UA_TYPES_UINT64]);
+    value->hasValue = (res == UA_STATUSCODE_GOOD);
+    return res;
+}
+
+/* The node context points to the counter in the group */
+static UA_StatusCode
+readCounter(UA_Server *server, const UA_NodeId *sessionId,
+            void *sessionContext, const UA_NodeId *nodeId,
+            void *nodeContext, UA_Boolean includeSourceTimeStamp,
+            const UA_NumericRange *range, UA_DataValue *value) {
+    UA_StatusCode res =
+        UA_Variant_setScalarCopy(&value->value, nodeContext, &UA_TYPES[UA_TYPES_UINT64]);
+    value->hasValue = (res == UA_STATUSCODE_GOOD);
+    return res;
+}
+
+static UA_StatusCode
+addTimingVariable(UA_Server *server, const UA_NodeId parent, char *name,
+                  void *context, UA_Boolean histogram) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.displayName = UA_LOCALIZEDTEXT("", name);
+    attr.dataType = UA_TYPES[UA_TYPES_UINT64].typeId;
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ;
+    UA_UInt32 arrayDimensions[1] = {UA_PUBSUB_HISTOGRAM_BUCKETS};
+    if(histogram) {
+        attr.description =
+            UA_LOCALIZEDTEXT("", "Histogram with logarithmic buckets. The first "
+                             "bucket counts durations below one microsecond. "
+                             "Every following bucket doubles the upper limit.");
+        attr.valueRank = UA_VALUERANK_ONE_DIMENSION;
+        attr.arrayDimensionsSize = 1;
+        attr.arrayDimensions = arrayDimensions;
+    } else {
+        attr.valueRank = UA_VALUERANK_SCALAR;
+    }
+
+    UA_NodeId varId;
+    UA_StatusCode res =
+        addNode(server, UA_NODECLASS_VARIABLE, UA_NODEID_NUMERIC(1, 0), parent,
+                UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                UA_QUALIFIEDNAME(0, name),
+                UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                &attr, &UA_TYPES[UA_TYPES_VARIABLEATTRIBUTES], context, &varId);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    UA_DataSource ds;
+    ds.read = (histogram) ? readHistogram : readCounter;
+    ds.write = NULL;
+    res = setVariableNode_dataSource(server, varId, ds);
+    UA_NodeId_clear(&varId);
+    return res;
+}
+
+/* The TimingStatistics object is removed together with the group */
+static UA_StatusCode
+addTimingStatisticsObject(UA_Server *server, const UA_NodeId group,
+                          UA_NodeId *objectId) {
+    UA_ObjectAttributes attr = UA_ObjectAttributes_default;
+    attr.displayName = UA_LOCALIZEDTEXT("", "TimingStatistics");
+    return addNode(server, UA_NODECLASS_OBJECT, UA_NODEID_NUMERIC(1, 0), group,
+                   UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                   UA_QUALIFIEDNAME(0, "TimingStatistics"),
+                   UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                   &attr, &UA_TYPES[UA_TYPES_OBJECTATTRIBUTES], NULL, objectId);
+}
+
+static UA_StatusCode
+addWriterGroupTimingStatistics(UA_Server *server, UA_WriterGroup *wg) {
+    UA_NodeId objectId;
+    UA_StatusCode res = addTimingStatisticsObject(server, wg->identifier, &objectId);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    res |= addTimingVariable(server, objectId, "PublishJitter",
+                             &wg->timing.publishJitter, true);
+    res |= addTimingVariable(server, objectId, "EncodeDuration",
+                             &wg->timing.encodeDuration, true);
+    res |= addTimingVariable(server, objectId, "EncryptDuration",
+                             &wg->timing.encryptDuration, true);
+    res |= addTimingVariable(server, objectId, "SendDuration",
+                             &wg->timing.sendDuration, true);
+    UA_NodeId_clear(&objectId);
+    return res;
+}
+
+static UA_StatusCode
+addReaderGroupTimingStatistics(UA_Server *server, UA_ReaderGroup *rg) {
+    UA_NodeId objectId;
+    UA_StatusCode res = addTimingStatisticsObject(server, rg->identifier, &objectId);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    res |= addTimingVariable(server, objectId, "ReceiveLatency",
+                             &rg->timing.receiveLatency, true);
+    res |= addTimingVariable(server, objectId, "ReceivedDataSetMessages",
+                             &rg->timing.receivedDataSetMessages, false);
+    res |= addTimingVariable(server, objectId, "LostDataSetMessages",
+                             &rg->timing.lostDataSetMessages, false);
+    UA_NodeId_clear(&objectId);
+    return res;
+}
+
 /**********************************************/
 /*               WriterGroup                  */
 /**********************************************/
@@ -1377,10 +1512,13 @@ addWriterGroupRepresentation(UA_Server *server, UA_WriterGroup *writerGroup) {
     memcpy(wgName, writerGroup->config.name.data, writerGroup->config.name.length);
     wgName[writerGroup->config.name.length] = '\0';
 
+    if(server->pubSubManager.bulkApply)
+        return UA_PubSubManager_reserveNodeId(server, &writerGroup->identifier);
+
     UA_ObjectAttributes object_attr = UA_ObjectAttributes_default;
     object_attr.displayName = UA_LOCALIZEDTEXT("", wgName);
     retVal = addNode(server, UA_NODECLASS_OBJECT,
-                     UA_NODEID_NUMERIC(1, 0), /* create a new id */
+                     representationNodeId(&writerGroup->identifier),
                      writerGroup->linkedConnection->identifier,
                      UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
                      UA_QUALIFIEDNAME(0, wgName),
@@ -1502,6 +1640,9 @@ addWriterGroupRepresentation(UA_Server *server, UA_WriterGroup *writerGroup) {
                          UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
                          UA_NODEID_NUMERIC(0, UA_NS0ID_WRITERGROUPTYPE_REMOVEDATASETWRITER), true);
     }
+
+    if(writerGroup->config.timingStatistics)
+        retVal |= addWriterGroupTimingStatistics(server, writerGroup);
     return retVal;
 }
 
@@ -1635,10 +1776,14 @@ addReaderGroupRepresentation(UA_Server *server, UA_ReaderGroup *readerGroup) {
     memcpy(rgName, readerGroup->config.name.data, readerGroup->config.name.length);
     rgName[readerGroup->config.name.length] = '\0';
 
+    if(server->pubSubManager.bulkApply)
+        return UA_PubSubManager_reserveNodeId(server, &readerGroup->identifier);
+
     UA_ObjectAttributes object_attr = UA_ObjectAttributes_default;
     object_attr.displayName = UA_LOCALIZEDTEXT("", rgName);
     UA_StatusCode retVal =
-        addNode(server, UA_NODECLASS_OBJECT, UA_NODEID_NUMERIC(1, 0), /* create an id */
+        addNode(server, UA_NODECLASS_OBJECT,
+                representationNodeId(&readerGroup->identifier),
                 readerGroup->linkedConnection->identifier,
                 UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
                 UA_QUALIFIEDNAME(0, rgName), UA_NODEID_NUMERIC(0, UA_NS0ID_READERGROUPTYPE),
@@ -1681,6 +1826,9 @@ addReaderGroupRepresentation(UA_Server *server, UA_ReaderGroup *readerGroup) {
                          UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
                          UA_NODEID_NUMERIC(0, UA_NS0ID_READERGROUPTYPE_REMOVEDATASETREADER), true);
     }
+
+    if(readerGroup->config.timingStatistics)
+        retVal |= addReaderGroupTimingStatistics(server, readerGroup);
     return retVal;
 }
 
@@ -1837,9 +1985,13 @@ addDataSetWriterRepresentation(UA_Server *server, UA_DataSetWriter *dataSetWrite
     memcpy(dswName, dataSetWriter->config.name.data, dataSetWriter->config.name.length);
     dswName[dataSetWriter->config.name.length] = '\0';
 
+    if(server->pubSubManager.bulkApply)
+        return UA_PubSubManager_reserveNodeId(server, &dataSetWriter->identifier);
+
     UA_ObjectAttributes object_attr = UA_ObjectAttributes_default;
     object_attr.displayName = UA_LOCALIZEDTEXT("", dswName);
-    retVal = addNode(server, UA_NODECLASS_OBJECT, UA_NODEID_NUMERIC(1, 0), /* create an id */
+    retVal = addNode(server, UA_NODECLASS_OBJECT,
+                     representationNodeId(&dataSetWriter->identifier),
                      dataSetWriter->linkedWriterGroup->identifier,
                      UA_NODEID_NUMERIC(0, UA_NS0ID_HASDATASETWRITER),
                      UA_QUALIFIEDNAME(0, dswName),
@@ -103,6 +103,144 @@ UA_DataSetReader_checkIdentifier(UA_Server *server, UA_NetworkMessage *msg,
     return UA_STATUSCODE_BADNOTFOUND;
 }
 
+UA_Boolean
+UA_DataSetReader_matchesKey(const UA_DataSetReader *reader,
+                            const UA_NetworkMessage *msg,
+                            UA_UInt16 dataSetWriterId) {
+    if(reader->config.dataSetWriterId != dataSetWriterId)
+        return false;
+    if(msg->groupHeaderEnabled && msg->groupHeader.writerGroupIdEnabled &&
+       reader->config.writerGroupId != msg->groupHeader.writerGroupId)
+        return false;
+    return publisherIdIsMatching((UA_NetworkMessage*)(uintptr_t)msg,
+                                 reader->config.publisherId);
+}
+
+/* Resolve a TargetVariable for the direct write path. The target keeps the
+ * node pointer only if the value can be written in-situ. That is, a
+ * VariableNode with the value stored in the node and a compatible DataType. */
+static void
+DataSetReader_resolveTarget(UA_Server *server, const UA_FieldTargetDataType *ftdt,
+                            const UA_FieldMetaData *field, UA_DataSetReaderTarget *t) {
+    if(ftdt->attributeId != UA_ATTRIBUTEID_VALUE)
+        return;
+
+    const UA_DataType *type =
+        UA_findDataTypeWithCustom(&field->dataType, server->config.customDataTypes);
+    if(!type)
+        return;
+
+    const UA_Node *node = UA_NODESTORE_GET(server, &ftdt->targetNodeId);
+    if(!node)
+        return;
+
+    const UA_VariableNode *vn = &node->variableNode;
+    if(node->head.nodeClass != UA_NODECLASS_VARIABLE ||
+       vn->valueSource != UA_VALUESOURCE_DATA ||
+       vn->valueBackend.backendType != UA_VALUEBACKENDTYPE_NONE ||
+       vn->arrayDimensionsSize > 0 ||
+       (vn->valueRank != UA_VALUERANK_SCALAR && vn->valueRank != UA_VALUERANK_ANY &&
+        vn->valueRank != UA_VALUERANK_SCALAR_OR_ONE_DIMENSION &&
+        vn->valueRank != UA_VALUERANK_ONE_DIMENSION) ||
+       !compatibleValueDataType(server, type, &vn->dataType))
+        goto release;
+
+    if(ftdt->receiverIndexRange.length > 0 &&
+       UA_NumericRange_parse(&t->range, ftdt->receiverIndexRange) != UA_STATUSCODE_GOOD)
+        goto release;
+
+    t->node = vn;
+    t->type = type;
+    server->pubSubManager.boundTargetsSize++;
+    return;
+
+ release:
+    UA_NODESTORE_RELEASE(server, node);
+}
+
+static void
+DataSetReader_clearTargets(UA_Server *server, UA_DataSetReader *dsr) {
+    for(size_t i = 0; i < dsr->targetsSize; i++) {
+        UA_DataSetReaderTarget *t = &dsr->targets[i];
+        if(!t->node)
+            continue;
+        UA_NODESTORE_RELEASE(server, (const UA_Node*)t->node);
+        UA_free(t->range.dimensions);
+        server->pubSubManager.boundTargetsSize--;
+    }
+    UA_free(dsr->targets);
+    dsr->targets = NULL;
+    dsr->targetsSize = 0;
+    dsr->targetsResolved = false;
+}
+
+/* Resolve the TargetVariables once instead of for every received field. If a
+ * target cannot be resolved, it is written via the Write service. */
+static void
+DataSetReader_resolveTargets(UA_Server *server, UA_DataSetReader *dsr) {
+    DataSetReader_clearTargets(server, dsr);
+    dsr->targetsResolved = true;
+
+#ifndef UA_ENABLE_IMMUTABLE_NODES
+    /* Fixed-size readers write into the external data values */
+    if(dsr->linkedReaderGroup->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE)
+        return;
+
+#ifdef UA_ENABLE_HISTORIZING
+    /* Every write must also reach the historical data backend */
+    if(server->config.historyDatabase.setValue)
+        return;
+#endif
+
+    const UA_TargetVariables *tvs = &dsr->config.subscribedDataSet.subscribedDataSetTarget;
+    size_t size = tvs->targetVariablesSize;
+    if(size > dsr->config.dataSetMetaData.fieldsSize)
+        size = dsr->config.dataSetMetaData.fieldsSize;
+    if(size == 0)
+        return;
+
+    dsr->targets = (UA_DataSetReaderTarget*)
+        UA_calloc(size, sizeof(UA_DataSetReaderTarget));
+    if(!dsr->targets)
+        return; /* Use the Write service */
+    dsr->targetsSize = size;
+
+    size_t resolved = 0;
+    for(size_t i = 0; i < size; i++) {
+        DataSetReader_resolveTarget(server, &tvs->targetVariables[i].targetVariable,
+                                    &dsr->config.dataSetMetaData.fields[i],
+                                    &dsr->targets[i]);
+        if(dsr->targets[i].node)
+            resolved++;
+    }
+    UA_LOG_DEBUG_READER(server->config.logging, dsr,
+                        "Resolved %u of %u TargetVariables for direct writing",
+                        (unsigned)resolved, (unsigned)size);
+#endif
+}
+
+void
+UA_DataSetReader_releaseTargetNode(UA_Server *server, const UA_NodeId *nodeId) {
+    UA_PubSubConnection *psc;
+    UA_ReaderGroup *rg;
+    UA_DataSetReader *dsr;
+    TAILQ_FOREACH(psc, &server->pubSubManager.connections, listEntry) {
+        LIST_FOREACH(rg, &psc->readerGroups, listEntry) {
+            LIST_FOREACH(dsr, &rg->readers, listEntry) {
+                for(size_t i = 0; i < dsr->targetsSize; i++) {
+                    UA_DataSetReaderTarget *t = &dsr->targets[i];
+                    if(!t->node || !UA_NodeId_equal(&t->node->head.nodeId, nodeId))
+                        continue;
+                    UA_NODESTORE_RELEASE(server, (const UA_Node*)t->node);
+                    UA_free(t->range.dimensions);
+                    memset(t, 0, sizeof(UA_DataSetReaderTarget));
+                    server->pubSubManager.boundTargetsSize--;
+                }
+            }
+        }
+    }
+}
+
 UA_StatusCode
 UA_DataSetReader_create(UA_Server *server, UA_NodeId readerGroupIdentifier,
                         const UA_DataSetReaderConfig *dataSetReaderConfig,
@@ -186,6 +324,10 @@ UA_DataSetReader_create(UA_Server *server, UA_NodeId readerGroupIdentifier,
     /* Add the new reader to the group */
     LIST_INSERT_HEAD(&readerGroup->readers, newDataSetReader, listEntry);
     readerGroup->readersCount++;
+    UA_PubSubManager_addIndex(&server->pubSubManager, &newDataSetReader->indexEntry,
+                              UA_PUBSUBINDEX_DATASETREADER, &newDataSetReader->identifier,
+                              newDataSetReader);
+    UA_ReaderGroup_indexReader(readerGroup, newDataSetReader);
 
     if(!UA_String_isEmpty(&newDataSetReader->config.linkedStandaloneSubscribedDataSetName)) {
         // find sds by name
@@ -336,13 +478,17 @@ UA_DataSetReader_remove(UA_Server *server, UA_DataSetReader *dsr) {
         }
     }
 
-    /* Delete DataSetReader config */
-    UA_DataSetReaderConfig_clear(&dsr->config);
+    DataSetReader_clearTargets(server, dsr);
 
     /* Remove DataSetReader from group */
-    LIST_REMOVE(dsr, listEntry);
     UA_ReaderGroup *rg = dsr->linkedReaderGroup;
+    UA_ReaderGroup_unindexReader(rg, dsr);
+    LIST_REMOVE(dsr, listEntry);
     rg->readersCount--;
+    UA_PubSubManager_removeIndex(&server->pubSubManager, &dsr->indexEntry);
+
+    /* Delete DataSetReader config */
+    UA_DataSetReaderConfig_clear(&dsr->config);
 
     /* THe offset buffer is only set when the dsr is frozen
      * UA_NetworkMessageOffsetBuffer_clear(&dsr->bufferedMessage); */
@@ -395,10 +541,13 @@ DataSetReader_updateConfig(UA_Server *server, UA_ReaderGroup *rg, UA_DataSetRead
 
     /* The update functionality will be extended during the next PubSub batches.
      * Currently changes for writerGroupId, dataSetWriterId and TargetVariables are possible. */
-    if(dsr->config.writerGroupId != config->writerGroupId)
+    if(dsr->config.writerGroupId != config->writerGroupId ||
+       dsr->config.dataSetWriterId != config->dataSetWriterId) {
+        UA_ReaderGroup_unindexReader(dsr->linkedReaderGroup, dsr);
         dsr->config.writerGroupId = config->writerGroupId;
-    if(dsr->config.dataSetWriterId != config->dataSetWriterId)
         dsr->config.dataSetWriterId = config->dataSetWriterId;
+        UA_ReaderGroup_indexReader(dsr->linkedReaderGroup, dsr);
+    }
 
     UA_TargetVariables *oldTV = &dsr->config.subscribedDataSet.subscribedDataSetTarget;
     const UA_TargetVariables *newTV = &config->subscribedDataSet.subscribedDataSetTarget;
@@ -581,6 +730,9 @@ UA_DataSetReader_setPubSubState(UA_Server *server, UA_DataSetReader *dsr,
     UA_ReaderGroup *rg = dsr->linkedReaderGroup;
     UA_assert(rg);
 
+    /* Wait for the unlocked processing to leave */
+    UA_PubSubRTLock_stop(&rg->linkedConnection->rtReadLock);
+
     UA_PubSubState oldState = dsr->state;
     dsr->state = targetState;
 
@@ -608,6 +760,15 @@ UA_DataSetReader_setPubSubState(UA_Server *server, UA_DataSetReader *dsr,
         break;
     }
 
+    /* Resolve the TargetVariables when the reader becomes active */
+    if(dsr->state == UA_PUBSUBSTATE_OPERATIONAL ||
+       dsr->state == UA_PUBSUBSTATE_PREOPERATIONAL) {
+        if(!dsr->targetsResolved)
+            DataSetReader_resolveTargets(server, dsr);
+    } else {
+        DataSetReader_clearTargets(server, dsr);
+    }
+
     /* Inform application about state change */
     if(dsr->state != oldState) {
         UA_ServerConfig *config = &server->config;
@@ -673,6 +834,7 @@ DataSetReader_createTargetVariables(UA_Server *server, UA_DataSetReader *dsr,
         return UA_STATUSCODE_BADCONFIGURATIONERROR;
     }
 
+    DataSetReader_clearTargets(server, dsr);
     if(dsr->config.subscribedDataSet.subscribedDataSetTarget.targetVariablesSize > 0)
         UA_TargetVariables_clear(&dsr->config.subscribedDataSet.subscribedDataSetTarget);
 
@@ -795,6 +957,24 @@ UA_Server_DataSetReader_createDataSetMirror(UA_Server *server, UA_String *parent
     return retval;
 }*/
 
+/* Copy a fixed-size value into the external value of the target variable. With
+ * a value buffer, the value is committed as a new snapshot for the
+ * application. */
+static void
+writeExternalValue(UA_FieldTargetVariable *tv, const void *data,
+                   const UA_DataType *type) {
+    UA_PubSubValueBuffer *vb = tv->valueBuffer;
+    if(!vb) {
+        memcpy((**tv->externalDataValue).value.data, data, type->memSize);
+        return;
+    }
+    if(vb->value.value.type->memSize != type->memSize)
+        return;
+    UA_DataValue *dv = UA_PubSubValueBuffer_beginWrite(vb);
+    memcpy(dv->value.data, data, type->memSize);
+    UA_PubSubValueBuffer_commit(vb);
+}
+
 static void
 DataSetReader_processRaw(UA_Server *server, UA_DataSetReader *dsr,
                          UA_DataSetMessage* msg) {
@@ -882,7 +1062,7 @@ else
                                 tv->externalDataValue);
                 (**tv->externalDataValue).value.data = pData;  // restore previous data pointer
             }
-            memcpy((**tv->externalDataValue).value.data, value, type->memSize);
+            writeExternalValue(tv, value, type);
             if(tv->afterWrite)
                 tv->afterWrite(server, &dsr->identifier,
                                 &dsr->linkedReaderGroup->identifier,
@@ -913,43 +1093,193 @@ else
     }
 }
 
+/* Write a field to the external data source of the target variable */
+static void
+DataSetReader_writeFixedSizeField(UA_Server *server, UA_DataSetReader *dsr,
+                                  UA_FieldTargetVariable *tv, UA_DataValue *value) {
+    if(tv->targetVariable.attributeId != UA_ATTRIBUTEID_VALUE)
+        return;
+
+    const UA_DataType *targetType = (tv->valueBuffer) ?
+        tv->valueBuffer->value.value.type : (*tv->externalDataValue)->value.type;
+    if(value->value.type != targetType) {
+        UA_LOG_WARNING_READER(server->config.logging, dsr,
+                              "Mismatching type");
+        return;
+    }
+
+    if (tv->beforeWrite) {
+        UA_DataValue *tmp = value;
+        tv->beforeWrite(server, &dsr->identifier, &dsr->linkedReaderGroup->identifier,
+                        &tv->targetVariable.targetNodeId,
+                        tv->targetVariableContext, &tmp);
+    }
+    if(UA_LIKELY(tv->externalDataValue != NULL || tv->valueBuffer != NULL))
+        writeExternalValue(tv, value->value.data, value->value.type);
+    if(tv->afterWrite)
+        tv->afterWrite(server, &dsr->identifier, &dsr->linkedReaderGroup->identifier,
+                       &tv->targetVariable.targetNodeId,
+                       tv->targetVariableContext, tv->externalDataValue);
+}
+
 static void
 DataSetReader_processFixedSize(UA_Server *server, UA_DataSetReader *dsr,
                                UA_DataSetMessage *msg, size_t fieldCount) {
     for(size_t i = 0; i < fieldCount; i++) {
         if(!msg->data.keyFrameData.dataSetFields[i].hasValue)
             continue;
-
         UA_FieldTargetVariable *tv =
             &dsr->config.subscribedDataSet.subscribedDataSetTarget.targetVariables[i];
-        if(tv->targetVariable.attributeId != UA_ATTRIBUTEID_VALUE)
-            continue;
+        DataSetReader_writeFixedSizeField(server, dsr, tv,
+                                          &msg->data.keyFrameData.dataSetFields[i]);
+    }
+}
 
-        if(msg->data.keyFrameData.dataSetFields[i].value.type !=
-           (*tv->externalDataValue)->value.type) {
-            UA_LOG_WARNING_READER(server->config.logging, dsr,
-                                  "Mismatching type");
-            continue;
-        }
+/* Write the value into the resolved node. Returns false if the value or the
+ * node don't allow this and the Write service has to be used. That is also
+ * the case if the write has side effects (MonitoredItems with a
+ * SamplingInterval of zero, onWrite callback). */
+static UA_Boolean
+DataSetReader_writeDirect(const UA_DataSetReaderTarget *t,
+                          const UA_DataValue *value, UA_StatusCode *res) {
+    UA_VariableNode *node = (UA_VariableNode*)(uintptr_t)t->node;
+    if(node->head.monitoredItems || node->value.data.callback.onWrite ||
+       node->valueSource != UA_VALUESOURCE_DATA ||
+       node->valueBackend.backendType != UA_VALUEBACKENDTYPE_NONE)
+        return false;
+
+    /* The type has been checked against the node when it was resolved */
+    const UA_Variant *v = &value->value;
+    if(v->type != t->type)
+        return false;
+    UA_Boolean scalar = UA_Variant_isScalar(v);
+    if((node->valueRank == UA_VALUERANK_SCALAR && !scalar) ||
+       (node->valueRank == UA_VALUERANK_ONE_DIMENSION && scalar) ||
+       (!scalar && v->arrayDimensionsSize > 1))
+        return false;
+
+    UA_DataValue *dst = &node->value.data.value;
+    if(t->range.dimensionsSize > 0) {
+        /* Write into the range of the existing value (exact type match) */
+        if(!dst->hasValue || dst->value.type != v->type || dst->status != value->status)
+            return false;
+        UA_Variant editable = *v;
+        if(scalar)
+            editable.arrayLength = 1;
+        *res = UA_Variant_setRangeCopy(&dst->value, editable.data,
+                                       editable.arrayLength, t->range);
+        if(*res != UA_STATUSCODE_GOOD)
+            return true;
+    } else if(scalar && dst->hasValue && UA_Variant_isScalar(&dst->value) &&
+              dst->value.type == v->type && v->type->pointerFree &&
+              dst->value.storageType == UA_VARIANT_DATA) {
+        /* Overwrite the scalar in-place without reallocation */
+        memcpy(dst->value.data, v->data, v->type->memSize);
+    } else {
+        UA_Variant tmp;
+        *res = UA_Variant_copy(v, &tmp);
+        if(*res != UA_STATUSCODE_GOOD)
+            return true;
+        UA_Variant_clear(&dst->value);
+        dst->value = tmp;
+    }
+
+    /* Take over status and timestamps. Like in the Write service, the
+     * SourceTimestamp is set only for dynamic variables. */
+    UA_Variant tmpValue = dst->value;
+    *dst = *value;
+    dst->value = tmpValue;
+    dst->hasValue = true;
+    if(!node->isDynamic) {
+        dst->hasSourceTimestamp = false;
+        dst->hasSourcePicoseconds = false;
+    }
+    return true;
+}
+
+/* Write a field (non realtime). Directly into the resolved node when possible,
+ * otherwise via the Write service. */
+static void
+DataSetReader_writeField(UA_Server *server, UA_DataSetReader *dsr,
+                         size_t index, const UA_DataValue *value) {
+    /* Direct write into the resolved target node */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(index < dsr->targetsSize && dsr->targets[index].node &&
+       DataSetReader_writeDirect(&dsr->targets[index], value, &res)) {
+        if(res != UA_STATUSCODE_GOOD)
+            UA_LOG_INFO_READER(server->config.logging, dsr,
+                               "Error writing field %u: %s",
+                               (unsigned)index, UA_StatusCode_name(res));
+        return;
+    }
 
-        if (tv->beforeWrite) {
-            UA_DataValue *tmp = &msg->data.keyFrameData.dataSetFields[i];
-            tv->beforeWrite(server, &dsr->identifier, &dsr->linkedReaderGroup->identifier,
-                            &tv->targetVariable.targetNodeId,
-                            tv->targetVariableContext, &tmp);
+    UA_FieldTargetVariable *tv =
+        &dsr->config.subscribedDataSet.subscribedDataSetTarget.targetVariables[index];
+
+    UA_WriteValue writeVal;
+    UA_WriteValue_init(&writeVal);
+    writeVal.attributeId = tv->targetVariable.attributeId;
+    writeVal.indexRange = tv->targetVariable.receiverIndexRange;
+    writeVal.nodeId = tv->targetVariable.targetNodeId;
+    writeVal.value = *value;
+    Operation_Write(server, &server->adminSession, NULL, &writeVal, &res);
+    if(res != UA_STATUSCODE_GOOD)
+        UA_LOG_INFO_READER(server->config.logging, dsr,
+                           "Error writing field %u: %s",
+                           (unsigned)index, UA_StatusCode_name(res));
+}
+
+/* A DeltaFrame contains only the changed fields with their index in the
+ * DataSet. The other target variables keep their value. */
+static void
+DataSetReader_processDeltaFrame(UA_Server *server, UA_DataSetReader *dsr,
+                                UA_DataSetMessage *msg) {
+    size_t fieldsSize = dsr->config.dataSetMetaData.fieldsSize;
+    if(dsr->config.subscribedDataSet.subscribedDataSetTarget.targetVariablesSize < fieldsSize)
+        fieldsSize = dsr->config.subscribedDataSet.subscribedDataSetTarget.targetVariablesSize;
+
+    UA_Boolean fixedSize =
+        (dsr->linkedReaderGroup->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE);
+    UA_DataSetMessage_DataDeltaFrameData *dfd = &msg->data.deltaFrameData;
+    for(size_t i = 0; i < dfd->fieldCount; i++) {
+        UA_DataSetMessage_DeltaFrameField *dff = &dfd->deltaFrameFields[i];
+        if(dff->fieldIndex >= fieldsSize) {
+            UA_LOG_INFO_READER(server->config.logging, dsr,
+                               "DeltaFrame field index %u out of range",
+                               (unsigned)dff->fieldIndex);
+            continue;
         }
-        if(UA_LIKELY(tv->externalDataValue != NULL)) {
-            memcpy((**tv->externalDataValue).value.data,
-                   msg->data.keyFrameData.dataSetFields[i].value.data,
-                   msg->data.keyFrameData.dataSetFields[i].value.type->memSize);
+        if(!dff->fieldValue.hasValue)
+            continue;
+        if(fixedSize) {
+            UA_FieldTargetVariable *tv = &dsr->config.subscribedDataSet.
+                subscribedDataSetTarget.targetVariables[dff->fieldIndex];
+            DataSetReader_writeFixedSizeField(server, dsr, tv, &dff->fieldValue);
+        } else {
+            DataSetReader_writeField(server, dsr, dff->fieldIndex, &dff->fieldValue);
         }
-        if(tv->afterWrite)
-            tv->afterWrite(server, &dsr->identifier, &dsr->linkedReaderGroup->identifier,
-                           &tv->targetVariable.targetNodeId,
-                           tv->targetVariableContext, tv->externalDataValue);
     }
 }
 
+/* Count the received messages and the gaps in the sequence numbers for the
+ * timing statistics. A backward jump (e.g. after a restart of the publisher)
+ * restarts the detection. */
+static void
+recordSequenceNumber(UA_DataSetReader *dsr, const UA_DataSetMessage *msg) {
+    UA_ReaderGroupTimingStatistics *timing = &dsr->linkedReaderGroup->timing;
+    timing->receivedDataSetMessages++;
+    if(!msg->header.dataSetMessageSequenceNrEnabled)
+        return;
+    UA_UInt16 seq = msg->header.dataSetMessageSequenceNr;
+    if(dsr->hasSequenceNumber) {
+        UA_UInt16 gap = (UA_UInt16)(seq - dsr->lastSequenceNumber - 1);
+        if(gap < 0x8000)
+            timing->lostDataSetMessages += gap;
+    }
+    dsr->hasSequenceNumber = true;
+    dsr->lastSequenceNumber = seq;
+}
+
 void
 UA_DataSetReader_process(UA_Server *server, UA_DataSetReader *dsr,
                          UA_DataSetMessage *msg) {
@@ -961,6 +1291,9 @@ UA_DataSetReader_process(UA_Server *server, UA_DataSetReader *dsr,
     if(dsr->state == UA_PUBSUBSTATE_PREOPERATIONAL)
         UA_DataSetReader_setPubSubState(server, dsr, UA_PUBSUBSTATE_OPERATIONAL);
 
+    if(dsr->linkedReaderGroup->config.timingStatistics)
+        recordSequenceNumber(dsr, msg);
+
     /* Check the metadata, to see if this reader is configured for a heartbeat */
     if(dsr->config.dataSetMetaData.fieldsSize == 0 &&
        dsr->config.dataSetMetaData.configurationVersion.majorVersion == 0 &&
@@ -1003,9 +1336,23 @@ UA_DataSetReader_process(UA_Server *server, UA_DataSetReader *dsr,
         return;
     }
 
+    /* The TargetVariables were changed while the reader is enabled */
+    if(!dsr->targetsResolved)
+        DataSetReader_resolveTargets(server, dsr);
+
+    if(msg->header.dataSetMessageType == UA_DATASETMESSAGE_DATADELTAFRAME &&
+       msg->header.fieldEncoding != UA_FIELDENCODING_RAWDATA) {
+        DataSetReader_processDeltaFrame(server, dsr, msg);
+#ifdef UA_ENABLE_PUBSUB_MONITORING
+        UA_DataSetReader_checkMessageReceiveTimeout(server, dsr);
+#endif
+        return;
+    }
+
     if(msg->header.dataSetMessageType != UA_DATASETMESSAGE_DATAKEYFRAME) {
         UA_LOG_WARNING_READER(server->config.logging, dsr,
-                       "DataSetMessage is discarded: Only keyframes are supported");
+                       "DataSetMessage is discarded: Only keyframes and "
+                       "deltaframes are supported");
         return;
     }
 
@@ -1037,25 +1384,10 @@ UA_DataSetReader_process(UA_Server *server, UA_DataSetReader *dsr,
     }
 
     /* Write the message fields via the write service (non realtime) */
-    UA_StatusCode res = UA_STATUSCODE_GOOD;
     for(size_t i = 0; i < fieldCount; i++) {
         if(!msg->data.keyFrameData.dataSetFields[i].hasValue)
             continue;
-
-        UA_FieldTargetVariable *tv =
-            &dsr->config.subscribedDataSet.subscribedDataSetTarget.targetVariables[i];
-
-        UA_WriteValue writeVal;
-        UA_WriteValue_init(&writeVal);
-        writeVal.attributeId = tv->targetVariable.attributeId;
-        writeVal.indexRange = tv->targetVariable.receiverIndexRange;
-        writeVal.nodeId = tv->targetVariable.targetNodeId;
-        writeVal.value = msg->data.keyFrameData.dataSetFields[i];
-        Operation_Write(server, &server->adminSession, NULL, &writeVal, &res);
-        if(res != UA_STATUSCODE_GOOD)
-            UA_LOG_INFO_READER(server->config.logging, dsr,
-                               "Error writing KeyFrame field %u: %s",
-                               (unsigned)i, UA_StatusCode_name(res));
+        DataSetReader_writeField(server, dsr, i, &msg->data.keyFrameData.dataSetFields[i]);
     }
 
 #ifdef UA_ENABLE_PUBSUB_MONITORING
@@ -1071,6 +1403,11 @@ UA_DataSetReader_checkMessageReceiveTimeout(UA_Server *server,
     UA_assert(server != 0);
     UA_assert(dsr != 0);
 
+    /* Processing without the server lock. Only readers without a
+     * MessageReceiveTimeout are processed that way. */
+    if(UA_PubSubRTLock_isRunning(&dsr->linkedReaderGroup->linkedConnection->rtReadLock))
+        return;
+
     /* If previous reader state was error (because we haven't received messages
      * and ran into timeout) we should set the state back to operational */
     if(dsr->state == UA_PUBSUBSTATE_ERROR) {
@@ -1161,18 +1498,35 @@ UA_DataSetReader_prepareOffsetBuffer(UA_Server *server, UA_DataSetReader *reader
         return rv;
     }
 
+    /* Find the DataSetMessage of the reader */
+    size_t dsmIndex = 0;
+    if(nm->payloadHeaderEnabled) {
+        UA_DataSetPayloadHeader *ph = &nm->payloadHeader.dataSetPayloadHeader;
+        for(; dsmIndex < ph->count; dsmIndex++) {
+            if(ph->dataSetWriterIds[dsmIndex] == reader->config.dataSetWriterId)
+                break;
+        }
+        if(dsmIndex == ph->count) {
+            UA_NetworkMessage_clear(nm);
+            UA_free(nm);
+            return UA_STATUSCODE_BADNOTFOUND;
+        }
+    }
+
     /* Compute and store the offsets necessary to decode */
     size_t nmSize = UA_NetworkMessage_calcSizeBinary(nm, &reader->bufferedMessage);
     if(nmSize == 0) {
+        UA_NetworkMessageOffsetBuffer_clear(&reader->bufferedMessage);
         UA_NetworkMessage_clear(nm);
         UA_free(nm);
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
-    /* Set the offset buffer in the reader */
+    /* Set the offset buffer in the reader. Keep only the offsets of the
+     * headers and of the DataSetMessage for the reader. */
     reader->bufferedMessage.nm = nm;
-
-    return rv;
+    return UA_NetworkMessageOffsetBuffer_selectDataSetMessage(&reader->bufferedMessage,
+                                                              dsmIndex);
 }
 
 void
@@ -1195,8 +1549,21 @@ UA_DataSetReader_decodeAndProcessRT(UA_Server *server, UA_DataSetReader *dsr,
         return;
     }
 
+    /* The offsets assume a fixed message layout. Check that the
+     * DataSetMessage is still at the same position. */
+    UA_NetworkMessage *nm = dsr->bufferedMessage.nm;
+    size_t dsmIndex = dsr->bufferedMessage.dataSetMessageIndex;
+    if(nm->payloadHeaderEnabled &&
+       nm->payloadHeader.dataSetPayloadHeader.dataSetWriterIds[dsmIndex] !=
+       dsr->config.dataSetWriterId) {
+        UA_LOG_INFO_READER(server->config.logging, dsr,
+                           "PubSub decoding failed. The DataSetMessage "
+                           "is not at the position of the fixed layout.");
+        return;
+    }
+
     UA_DataSetReader_process(server, dsr,
-                             dsr->bufferedMessage.nm->payload.dataSetPayload.dataSetMessages);
+                             &nm->payload.dataSetPayload.dataSetMessages[dsmIndex]);
 }
 
 #endif /* UA_ENABLE_PUBSUB */
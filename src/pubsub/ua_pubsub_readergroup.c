@@ -21,31 +21,16 @@
 
 UA_ReaderGroup *
 UA_ReaderGroup_findRGbyId(UA_Server *server, UA_NodeId identifier) {
-    UA_ReaderGroup *rg;
-    UA_PubSubConnection *psc;
-    TAILQ_FOREACH(psc, &server->pubSubManager.connections, listEntry) {
-        LIST_FOREACH(rg, &psc->readerGroups, listEntry) {
-            if(UA_NodeId_equal(&identifier, &rg->identifier))
-                return rg;
-        }
-    }
-    return NULL;
+    return (UA_ReaderGroup*)
+        UA_PubSubManager_findIndex(&server->pubSubManager, UA_PUBSUBINDEX_READERGROUP,
+                                   &identifier);
 }
 
 UA_DataSetReader *
 UA_ReaderGroup_findDSRbyId(UA_Server *server, UA_NodeId identifier) {
-    UA_ReaderGroup *rg;
-    UA_PubSubConnection *psc;
-    UA_DataSetReader *tmpReader;
-    TAILQ_FOREACH(psc, &server->pubSubManager.connections, listEntry) {
-        LIST_FOREACH(rg, &psc->readerGroups, listEntry) {
-            LIST_FOREACH(tmpReader, &rg->readers, listEntry) {
-                if(UA_NodeId_equal(&tmpReader->identifier, &identifier))
-                    return tmpReader;
-            }
-        }
-    }
-    return NULL;
+    return (UA_DataSetReader*)
+        UA_PubSubManager_findIndex(&server->pubSubManager, UA_PUBSUBINDEX_DATASETREADER,
+                                   &identifier);
 }
 
 /* ReaderGroup Config Handling */
@@ -113,6 +98,7 @@ UA_ReaderGroup_create(UA_Server *server, UA_NodeId connectionId,
     }
 
     /* Add to the connection */
+    UA_PubSubRTLock_stop(&connection->rtReadLock);
     LIST_INSERT_HEAD(&connection->readerGroups, newGroup, listEntry);
     connection->readerGroupsSize++;
 
@@ -157,6 +143,9 @@ UA_ReaderGroup_create(UA_Server *server, UA_NodeId connectionId,
     UA_PubSubManager_generateUniqueNodeId(&server->pubSubManager,
                                           &newGroup->identifier);
 #endif
+    UA_PubSubManager_addIndex(&server->pubSubManager, &newGroup->indexEntry,
+                              UA_PUBSUBINDEX_READERGROUP, &newGroup->identifier,
+                              newGroup);
 
     /* Cache the log string */
     UA_String idStr = UA_STRING_NULL;
@@ -180,8 +169,9 @@ UA_ReaderGroup_create(UA_Server *server, UA_NodeId connectionId,
         return retval;
     }
 
-    /* Trigger the connection */
-    UA_PubSubConnection_setPubSubState(server, connection, connection->state);
+    /* Trigger the connection (done once at the end of a bulk apply) */
+    if(!server->pubSubManager.bulkApply)
+        UA_PubSubConnection_setPubSubState(server, connection, connection->state);
 
     /* Copying a numeric NodeId always succeeds */
     if(readerGroupId)
@@ -250,6 +240,7 @@ UA_ReaderGroup_remove(UA_Server *server, UA_ReaderGroup *rg) {
         /* Unlink from the connection */
         LIST_REMOVE(rg, listEntry);
         connection->readerGroupsSize--;
+        UA_PubSubManager_removeIndex(&server->pubSubManager, &rg->indexEntry);
         rg->linkedConnection = NULL;
 
         /* Actually remove the ReaderGroup */
@@ -259,6 +250,10 @@ UA_ReaderGroup_remove(UA_Server *server, UA_ReaderGroup *rg) {
 
         UA_LOG_INFO_READERGROUP(server->config.logging, rg, "ReaderGroup deleted");
 
+        UA_ReaderGroup_clearReaderIndex(rg);
+#ifdef UA_ENABLE_PUBSUB_BUFMALLOC
+        UA_PubSubBufArena_clear(&rg->decodeArena);
+#endif
         UA_ReaderGroupConfig_clear(&rg->config);
         UA_NodeId_clear(&rg->identifier);
         UA_String_clear(&rg->logIdString);
@@ -321,6 +316,53 @@ UA_Server_ReaderGroup_getState(UA_Server *server, UA_NodeId readerGroupIdentifie
     return ret;
 }
 
+UA_StatusCode
+UA_Server_getReaderGroupTimingStatistics(UA_Server *server, const UA_NodeId rgId,
+                                         UA_ReaderGroupTimingStatistics *stats) {
+    UA_LOCK(&server->serviceMutex);
+    UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, rgId);
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(!rg)
+        res = UA_STATUSCODE_BADNOTFOUND;
+    else if(!rg->config.timingStatistics)
+        res = UA_STATUSCODE_BADNOTSUPPORTED;
+    else
+        *stats = rg->timing;
+    UA_UNLOCK(&server->serviceMutex);
+    return res;
+}
+
+UA_StatusCode
+UA_Server_resetReaderGroupTimingStatistics(UA_Server *server, const UA_NodeId rgId) {
+    UA_LOCK(&server->serviceMutex);
+    UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, rgId);
+    if(!rg) {
+        UA_UNLOCK(&server->serviceMutex);
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+    memset(&rg->timing, 0, sizeof(UA_ReaderGroupTimingStatistics));
+    UA_UNLOCK(&server->serviceMutex);
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_DateTime
+UA_ReaderGroup_timingNow(UA_Server *server, UA_ReaderGroup *rg) {
+    if(!rg->config.timingStatistics)
+        return 0;
+    UA_EventLoop *el = UA_PubSubConnection_getEL(server, rg->linkedConnection);
+    return el->dateTime_nowMonotonic(el);
+}
+
+void
+UA_ReaderGroup_recordReceiveLatency(UA_Server *server, UA_ReaderGroup *rg,
+                                    UA_DateTime receiveTime) {
+    if(receiveTime == 0 || !rg->config.timingStatistics)
+        return;
+    UA_EventLoop *el = UA_PubSubConnection_getEL(server, rg->linkedConnection);
+    UA_PubSubHistogram_add(&rg->timing.receiveLatency,
+                           el->dateTime_nowMonotonic(el) - receiveTime);
+}
+
 UA_StatusCode
 UA_ReaderGroup_setPubSubState(UA_Server *server, UA_ReaderGroup *rg,
                               UA_PubSubState targetState) {
@@ -329,6 +371,9 @@ UA_ReaderGroup_setPubSubState(UA_Server *server, UA_ReaderGroup *rg,
     UA_StatusCode ret = UA_STATUSCODE_GOOD;
     UA_PubSubConnection *connection = rg->linkedConnection;
     UA_PubSubState oldState = rg->state;
+
+    /* Wait for the unlocked processing to leave */
+    UA_PubSubRTLock_stop(&connection->rtReadLock);
     rg->state = targetState;
 
     switch(rg->state) {
@@ -490,45 +535,10 @@ UA_Server_setReaderGroupEncryptionKeys(UA_Server *server,
 
 /* Freezing of the configuration */
 
-UA_StatusCode
-UA_ReaderGroup_freezeConfiguration(UA_Server *server, UA_ReaderGroup *rg) {
-    UA_LOCK_ASSERT(&server->serviceMutex, 1);
-    if(rg->configurationFrozen)
-        return UA_STATUSCODE_GOOD;
-
-    /* PubSubConnection freezeCounter++ */
-    UA_PubSubConnection *pubSubConnection = rg->linkedConnection;
-    pubSubConnection->configurationFreezeCounter++;
-
-    /* ReaderGroup freeze */
-    /* TODO: Clarify on the freeze functionality in multiple DSR, multiple
-     * networkMessage conf in a RG */
-    rg->configurationFrozen = true;
-
-    /* DataSetReader freeze */
-    UA_DataSetReader *dsr;
-    UA_UInt16 dsrCount = 0;
-    LIST_FOREACH(dsr, &rg->readers, listEntry){
-        dsr->configurationFrozen = true;
-        dsrCount++;
-        /* TODO: Configuration frozen for subscribedDataSet once
-         * UA_Server_DataSetReader_addTargetVariables API modified to support
-         * adding target variable one by one or in a group stored in a list. */
-    }
-
-    /* Not rt, we don't have to adjust anything */
-    if(rg->config.rtLevel != UA_PUBSUB_RT_FIXED_SIZE)
-        return UA_STATUSCODE_GOOD;
-
-    if(dsrCount > 1) {
-        UA_LOG_WARNING_READERGROUP(server->config.logging, rg,
-                                   "Mutiple DSR in a readerGroup not supported in RT "
-                                   "fixed size configuration");
-        return UA_STATUSCODE_BADNOTIMPLEMENTED;
-    }
-
-    dsr = LIST_FIRST(&rg->readers);
-
+/* Check that the reader can use the RT fast-path and connect the target
+ * variables with their external data sources */
+static UA_StatusCode
+freezeReaderRT(UA_Server *server, UA_DataSetReader *dsr) {
     /* Support only to UADP encoding */
     if(dsr->config.messageSettings.content.decoded.type !=
        &UA_TYPES[UA_TYPES_UADPDATASETREADERMESSAGEDATATYPE]) {
@@ -586,6 +596,44 @@ UA_ReaderGroup_freezeConfiguration(UA_Server *server, UA_ReaderGroup *rg) {
      * settings which headers are present, etc. Until then the ReaderGroup is
      * "PreOperational". */
     UA_NetworkMessageOffsetBuffer_clear(&dsr->bufferedMessage);
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_ReaderGroup_freezeConfiguration(UA_Server *server, UA_ReaderGroup *rg) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    if(rg->configurationFrozen)
+        return UA_STATUSCODE_GOOD;
+
+    /* PubSubConnection freezeCounter++ */
+    UA_PubSubConnection *pubSubConnection = rg->linkedConnection;
+    pubSubConnection->configurationFreezeCounter++;
+
+    /* ReaderGroup freeze */
+    /* TODO: Clarify on the freeze functionality in multiple DSR, multiple
+     * networkMessage conf in a RG */
+    rg->configurationFrozen = true;
+
+    /* DataSetReader freeze */
+    UA_DataSetReader *dsr;
+    LIST_FOREACH(dsr, &rg->readers, listEntry){
+        dsr->configurationFrozen = true;
+        /* TODO: Configuration frozen for subscribedDataSet once
+         * UA_Server_DataSetReader_addTargetVariables API modified to support
+         * adding target variable one by one or in a group stored in a list. */
+    }
+
+    /* Not rt, we don't have to adjust anything */
+    if(rg->config.rtLevel != UA_PUBSUB_RT_FIXED_SIZE)
+        return UA_STATUSCODE_GOOD;
+
+    /* Every reader gets its own offset table for its DataSetMessage. The
+     * readers can receive from the same or from different NetworkMessages. */
+    LIST_FOREACH(dsr, &rg->readers, listEntry) {
+        UA_StatusCode res = freezeReaderRT(server, dsr);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
 
     /* Set the current state again. This can move the state from Operational to
      * PreOperational. */
@@ -616,6 +664,9 @@ UA_ReaderGroup_unfreezeConfiguration(UA_Server *server, UA_ReaderGroup *rg) {
     UA_PubSubConnection *pubSubConnection = rg->linkedConnection;
     pubSubConnection->configurationFreezeCounter--;
 
+    /* Wait for the unlocked processing to leave */
+    UA_PubSubRTLock_stop(&pubSubConnection->rtReadLock);
+
     /* ReaderGroup unfreeze */
     rg->configurationFrozen = false;
 
@@ -641,6 +692,201 @@ UA_Server_unfreezeReaderGroupConfiguration(UA_Server *server,
     return res;
 }
 
+/******************/
+/* Dispatch Index */
+/******************/
+
+#define UA_READERINDEX_MINSIZE 16
+
+static UA_UInt32
+dispatchHash(UA_PublisherIdType idType, UA_UInt64 numericId, const UA_String *stringId,
+             UA_UInt16 writerGroupId, UA_UInt16 dataSetWriterId) {
+    UA_Byte key[13];
+    key[0] = (UA_Byte)idType;
+    memcpy(&key[1], &numericId, sizeof(UA_UInt64));
+    memcpy(&key[9], &writerGroupId, sizeof(UA_UInt16));
+    memcpy(&key[11], &dataSetWriterId, sizeof(UA_UInt16));
+    UA_UInt32 hash = UA_ByteString_hash(0, key, sizeof(key));
+    if(stringId)
+        hash = UA_ByteString_hash(hash, stringId->data, stringId->length);
+    return hash;
+}
+
+/* Readers with a PublisherId of an unsupported type never match a message that
+ * contains a PublisherId. They are not indexed. */
+static UA_Boolean
+readerHash(const UA_DataSetReader *dsr, UA_UInt32 *hash) {
+    const UA_Variant *pid = &dsr->config.publisherId;
+    if(!UA_Variant_isScalar(pid) || !pid->data)
+        return false;
+    UA_PublisherIdType idType;
+    UA_UInt64 numericId = 0;
+    const UA_String *stringId = NULL;
+    if(pid->type == &UA_TYPES[UA_TYPES_BYTE]) {
+        idType = UA_PUBLISHERIDTYPE_BYTE;
+        numericId = *(UA_Byte*)pid->data;
+    } else if(pid->type == &UA_TYPES[UA_TYPES_UINT16]) {
+        idType = UA_PUBLISHERIDTYPE_UINT16;
+        numericId = *(UA_UInt16*)pid->data;
+    } else if(pid->type == &UA_TYPES[UA_TYPES_UINT32]) {
+        idType = UA_PUBLISHERIDTYPE_UINT32;
+        numericId = *(UA_UInt32*)pid->data;
+    } else if(pid->type == &UA_TYPES[UA_TYPES_UINT64]) {
+        idType = UA_PUBLISHERIDTYPE_UINT64;
+        numericId = *(UA_UInt64*)pid->data;
+    } else if(pid->type == &UA_TYPES[UA_TYPES_STRING]) {
+        idType = UA_PUBLISHERIDTYPE_STRING;
+        stringId = (const UA_String*)pid->data;
+    } else {
+        return false;
+    }
+    *hash = dispatchHash(idType, numericId, stringId, dsr->config.writerGroupId,
+                         dsr->config.dataSetWriterId);
+    return true;
+}
+
+static UA_UInt32
+messageHash(const UA_NetworkMessage *nm, UA_UInt16 dataSetWriterId) {
+    UA_UInt64 numericId = 0;
+    const UA_String *stringId = NULL;
+    switch(nm->publisherIdType) {
+    case UA_PUBLISHERIDTYPE_BYTE: numericId = nm->publisherId.byte; break;
+    case UA_PUBLISHERIDTYPE_UINT16: numericId = nm->publisherId.uint16; break;
+    case UA_PUBLISHERIDTYPE_UINT32: numericId = nm->publisherId.uint32; break;
+    case UA_PUBLISHERIDTYPE_UINT64: numericId = nm->publisherId.uint64; break;
+    case UA_PUBLISHERIDTYPE_STRING: stringId = &nm->publisherId.string; break;
+    default: break;
+    }
+    return dispatchHash(nm->publisherIdType, numericId, stringId,
+                        nm->groupHeader.writerGroupId, dataSetWriterId);
+}
+
+static void
+insertReader(UA_ReaderGroup *rg, UA_DataSetReader *dsr) {
+    UA_UInt32 hash;
+    if(!readerHash(dsr, &hash))
+        return;
+    UA_DataSetReader **bucket = &rg->readersIndex[hash & (rg->readersIndexSize - 1)];
+    dsr->indexHash = hash;
+    dsr->indexNext = *bucket;
+    dsr->indexed = true;
+    *bucket = dsr;
+}
+
+void
+UA_ReaderGroup_clearReaderIndex(UA_ReaderGroup *rg) {
+    UA_DataSetReader *dsr;
+    LIST_FOREACH(dsr, &rg->readers, listEntry) {
+        dsr->indexed = false;
+        dsr->indexNext = NULL;
+    }
+    UA_free(rg->readersIndex);
+    rg->readersIndex = NULL;
+    rg->readersIndexSize = 0;
+}
+
+void
+UA_ReaderGroup_indexReader(UA_ReaderGroup *rg, UA_DataSetReader *dsr) {
+    if(rg->readersIndex && rg->readersCount <= rg->readersIndexSize) {
+        insertReader(rg, dsr);
+        return;
+    }
+
+    /* Create or grow the index. Rebuild from the list of readers. If the
+     * allocation fails, the index is disabled and all readers are checked for
+     * every message. */
+    size_t size = UA_READERINDEX_MINSIZE;
+    while(size < (size_t)rg->readersCount * 2)
+        size <<= 1;
+    UA_ReaderGroup_clearReaderIndex(rg);
+    rg->readersIndex = (UA_DataSetReader**)UA_calloc(size, sizeof(UA_DataSetReader*));
+    if(!rg->readersIndex)
+        return;
+    rg->readersIndexSize = size;
+    UA_DataSetReader *r;
+    LIST_FOREACH(r, &rg->readers, listEntry) {
+        insertReader(rg, r);
+    }
+}
+
+void
+UA_ReaderGroup_unindexReader(UA_ReaderGroup *rg, UA_DataSetReader *dsr) {
+    if(!dsr->indexed)
+        return;
+    UA_DataSetReader **pos = &rg->readersIndex[dsr->indexHash & (rg->readersIndexSize - 1)];
+    while(*pos && *pos != dsr)
+        pos = &(*pos)->indexNext;
+    if(*pos)
+        *pos = dsr->indexNext;
+    dsr->indexed = false;
+    dsr->indexNext = NULL;
+}
+
+UA_Boolean
+UA_ReaderGroup_useReaderIndex(const UA_ReaderGroup *rg, const UA_NetworkMessage *nm) {
+    return (rg->readersIndex != NULL &&
+            rg->config.encodingMimeType == UA_PUBSUB_ENCODING_UADP &&
+            nm->publisherIdEnabled && nm->payloadHeaderEnabled &&
+            nm->groupHeaderEnabled && nm->groupHeader.writerGroupIdEnabled);
+}
+
+UA_DataSetReader *
+UA_ReaderGroup_lookupReaders(const UA_ReaderGroup *rg, const UA_NetworkMessage *nm,
+                             UA_UInt16 dataSetWriterId) {
+    UA_UInt32 hash = messageHash(nm, dataSetWriterId);
+    return rg->readersIndex[hash & (rg->readersIndexSize - 1)];
+}
+
+UA_Boolean
+UA_ReaderGroup_hasReaderForMessage(UA_Server *server, UA_ReaderGroup *rg,
+                                   UA_NetworkMessage *nm) {
+    if(UA_ReaderGroup_useReaderIndex(rg, nm)) {
+        UA_DataSetPayloadHeader *ph = &nm->payloadHeader.dataSetPayloadHeader;
+        for(UA_Byte i = 0; i < ph->count; i++) {
+            UA_DataSetReader *dsr =
+                UA_ReaderGroup_lookupReaders(rg, nm, ph->dataSetWriterIds[i]);
+            for(; dsr; dsr = dsr->indexNext) {
+                if(UA_DataSetReader_matchesKey(dsr, nm, ph->dataSetWriterIds[i]))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    UA_DataSetReader *dsr;
+    LIST_FOREACH(dsr, &rg->readers, listEntry) {
+        if(UA_DataSetReader_checkIdentifier(server, nm, dsr, rg->config) ==
+           UA_STATUSCODE_GOOD)
+            return true;
+    }
+    return false;
+}
+
+/* Process the DataSetMessages with the readers from the index */
+static UA_Boolean
+processIndexed(UA_Server *server, UA_ReaderGroup *rg, UA_NetworkMessage *nm) {
+    UA_Boolean processed = false;
+    UA_DataSetPayloadHeader *ph = &nm->payloadHeader.dataSetPayloadHeader;
+    for(UA_Byte i = 0; i < ph->count; i++) {
+        /* The next reader is taken before processing. The current reader
+         * might be deleted in the _setPubSubState callback. */
+        UA_DataSetReader *dsr, *next;
+        dsr = UA_ReaderGroup_lookupReaders(rg, nm, ph->dataSetWriterIds[i]);
+        for(; dsr; dsr = next) {
+            next = dsr->indexNext;
+            if(!UA_DataSetReader_matchesKey(dsr, nm, ph->dataSetWriterIds[i]))
+                continue;
+            if(dsr->state != UA_PUBSUBSTATE_OPERATIONAL &&
+               dsr->state != UA_PUBSUBSTATE_PREOPERATIONAL)
+                continue;
+            processed = true;
+            UA_DataSetReader_process(server, dsr,
+                                     &nm->payload.dataSetPayload.dataSetMessages[i]);
+        }
+    }
+    return processed;
+}
+
 UA_Boolean
 UA_ReaderGroup_process(UA_Server *server, UA_ReaderGroup *readerGroup,
                        UA_NetworkMessage *nm) {
@@ -653,6 +899,10 @@ UA_ReaderGroup_process(UA_Server *server, UA_ReaderGroup *readerGroup,
     if(readerGroup->state == UA_PUBSUBSTATE_PREOPERATIONAL)
         UA_ReaderGroup_setPubSubState(server, readerGroup, UA_PUBSUBSTATE_OPERATIONAL);
 
+    /* Dispatch with the index if the headers contain all identifiers */
+    if(UA_ReaderGroup_useReaderIndex(readerGroup, nm))
+        return processIndexed(server, readerGroup, nm);
+
     /* Safe iteration. The current Reader might be deleted in the ReaderGroup
      * _setPubSubState callback. */
     UA_Boolean processed = false;
@@ -698,6 +948,47 @@ UA_ReaderGroup_process(UA_Server *server, UA_ReaderGroup *readerGroup,
     return processed;
 }
 
+UA_StatusCode
+UA_ReaderGroup_decodeNetworkMessage(UA_Server *server, UA_ReaderGroup *rg,
+                                    UA_ByteString *buf, UA_NetworkMessage *nm) {
+    memset(nm, 0, sizeof(UA_NetworkMessage));
+#ifdef UA_ENABLE_PUBSUB_BUFMALLOC
+    useArenaAlloc(&rg->decodeArena);
+#endif
+    UA_StatusCode res;
+    if(rg->config.encodingMimeType == UA_PUBSUB_ENCODING_UADP) {
+        size_t currentPosition = 0;
+        res = decodeNetworkMessage(server, buf, &currentPosition,
+                                   nm, rg->linkedConnection);
+    } else { /* if(writerGroup->config.encodingMimeType == UA_PUBSUB_ENCODING_JSON) */
+#ifdef UA_ENABLE_JSON_ENCODING
+        res = UA_NetworkMessage_decodeJson(nm, buf);
+#else
+        res = UA_STATUSCODE_BADNOTSUPPORTED;
+#endif
+    }
+#ifdef UA_ENABLE_PUBSUB_BUFMALLOC
+    useNormalAlloc();
+    if(res != UA_STATUSCODE_GOOD)
+        UA_PubSubBufArena_reset(&rg->decodeArena);
+#endif
+    return res;
+}
+
+void
+UA_ReaderGroup_releaseNetworkMessage(UA_ReaderGroup *rg, UA_NetworkMessage *nm) {
+#ifdef UA_ENABLE_PUBSUB_BUFMALLOC
+    /* Memory that did not fit into the arena is freed. The arena grows for the
+     * next message. */
+    useArenaAlloc(&rg->decodeArena);
+    UA_NetworkMessage_clear(nm);
+    useNormalAlloc();
+    UA_PubSubBufArena_reset(&rg->decodeArena);
+#else
+    UA_NetworkMessage_clear(nm);
+#endif
+}
+
 UA_Boolean
 UA_ReaderGroup_decodeAndProcessRT(UA_Server *server, UA_ReaderGroup *rg,
                                   UA_ByteString *buf) {
@@ -712,13 +1003,13 @@ UA_ReaderGroup_decodeAndProcessRT(UA_Server *server, UA_ReaderGroup *rg,
     memset(&currentNetworkMessage, 0, sizeof(UA_NetworkMessage));
 
     /* Decode headers necessary for matching identifiers. This can use malloc.
-     * So enable membufAlloc if you need RT timings. Reset back to the normal
-     * malloc before processing the message. The userland (callbacks) below
-     * might rely on that. It needs to be ensured that the membuf-memory is not
-     * reset (zeroed out) in "useNormalAlloc". So the decoded memory can be used
-     * until the end of this method. */
+     * So enable the arena of the ReaderGroup if you need RT timings. Reset
+     * back to the normal malloc before processing the message. The userland
+     * (callbacks) below might rely on that. The arena is not reset before the
+     * cleanup. So the decoded memory can be used until the end of this
+     * method. */
 #ifdef UA_ENABLE_PUBSUB_BUFMALLOC
-    useMembufAlloc();
+    useArenaAlloc(&rg->decodeArena);
 #endif
     size_t pos = 0;
     UA_StatusCode rv = UA_NetworkMessage_decodeHeaders(buf, &pos, &currentNetworkMessage);
@@ -743,8 +1034,36 @@ UA_ReaderGroup_decodeAndProcessRT(UA_Server *server, UA_ReaderGroup *rg,
     }
 #endif
 
-    /* Process the message for each reader */
+    /* Process the message for each reader. Use the index if the headers
+     * contain all identifiers. Every reader decodes its DataSetMessage from
+     * the buffer. So process a reader only for the first matching
+     * DataSetWriterId. */
     UA_DataSetReader *dsr;
+    if(UA_ReaderGroup_useReaderIndex(rg, &currentNetworkMessage)) {
+        UA_DataSetPayloadHeader *ph =
+            &currentNetworkMessage.payloadHeader.dataSetPayloadHeader;
+        for(UA_Byte i = 0; i < ph->count; i++) {
+            UA_Boolean duplicate = false;
+            for(UA_Byte j = 0; j < i; j++)
+                duplicate |= (ph->dataSetWriterIds[j] == ph->dataSetWriterIds[i]);
+            if(duplicate)
+                continue;
+            dsr = UA_ReaderGroup_lookupReaders(rg, &currentNetworkMessage,
+                                               ph->dataSetWriterIds[i]);
+            for(; dsr; dsr = dsr->indexNext) {
+                if(dsr->state != UA_PUBSUBSTATE_OPERATIONAL &&
+                   dsr->state != UA_PUBSUBSTATE_PREOPERATIONAL)
+                    continue;
+                if(!UA_DataSetReader_matchesKey(dsr, &currentNetworkMessage,
+                                                ph->dataSetWriterIds[i]))
+                    continue;
+                UA_DataSetReader_decodeAndProcessRT(server, dsr, buf);
+                processed = true;
+            }
+        }
+        goto cleanup;
+    }
+
     LIST_FOREACH(dsr, &rg->readers, listEntry) {
         /* Check if the reader is enabled */
         if(dsr->state != UA_PUBSUBSTATE_OPERATIONAL &&
@@ -766,10 +1085,38 @@ UA_ReaderGroup_decodeAndProcessRT(UA_Server *server, UA_ReaderGroup *rg,
     }
 
  cleanup:
-#ifndef UA_ENABLE_PUBSUB_BUFMALLOC
+#ifdef UA_ENABLE_PUBSUB_BUFMALLOC
+    useArenaAlloc(&rg->decodeArena);
+    UA_NetworkMessage_clear(&currentNetworkMessage);
+    useNormalAlloc();
+    UA_PubSubBufArena_reset(&rg->decodeArena);
+#else
     UA_NetworkMessage_clear(&currentNetworkMessage);
 #endif
     return processed;
 }
 
+UA_Boolean
+UA_ReaderGroup_canProcessRT(UA_ReaderGroup *rg) {
+    if(!rg->config.rtThread || !rg->configurationFrozen ||
+       rg->config.rtLevel != UA_PUBSUB_RT_FIXED_SIZE ||
+       rg->config.securityMode > UA_MESSAGESECURITYMODE_NONE ||
+       rg->state != UA_PUBSUBSTATE_OPERATIONAL)
+        return false;
+
+    /* The state transitions, the preparation of the offset buffer and the
+     * monitoring are done with the server lock */
+    UA_DataSetReader *dsr;
+    LIST_FOREACH(dsr, &rg->readers, listEntry) {
+        if(dsr->state != UA_PUBSUBSTATE_OPERATIONAL ||
+           !dsr->bufferedMessage.nm || !dsr->targetsResolved)
+            return false;
+#ifdef UA_ENABLE_PUBSUB_MONITORING
+        if(dsr->config.messageReceiveTimeout > 0.0)
+            return false;
+#endif
+    }
+    return true;
+}
+
 #endif /* UA_ENABLE_PUBSUB */
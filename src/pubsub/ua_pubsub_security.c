@@ -78,6 +78,29 @@ verifyAndDecrypt(const UA_Logger *logger, UA_ByteString *buffer,
                  UA_PubSubSecurityPolicy *securityPolicy) {
     UA_StatusCode rv = UA_STATUSCODE_GOOD;
 
+    /* Authenticated decryption in a single pass */
+    if(securityPolicy->verifyAndDecrypt && doValidate) {
+        const UA_ByteString nonce = {
+            (size_t)nm->securityHeader.messageNonceSize,
+            (UA_Byte*)(uintptr_t)nm->securityHeader.messageNonce
+        };
+        rv = securityPolicy->setMessageNonce(channelContext, &nonce);
+        UA_CHECK_STATUS_WARN(rv, return rv, logger, UA_LOGCATEGORY_SECURITYPOLICY,
+                             "PubSub receive. Faulty Nonce set");
+
+        size_t sigSize = securityPolicy->symmetricModule.cryptoModule.
+            signatureAlgorithm.getLocalSignatureSize(channelContext);
+        if(buffer->length < *currentPosition + sigSize)
+            return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+        size_t sigOffset = buffer->length - sigSize;
+        size_t encOffset = (doDecrypt) ? *currentPosition : sigOffset;
+        rv = securityPolicy->verifyAndDecrypt(channelContext, buffer, encOffset, sigOffset);
+        UA_CHECK_STATUS_WARN(rv, return rv, logger, UA_LOGCATEGORY_SECURITYPOLICY,
+                             "PubSub receive. Authenticated decryption failed");
+        buffer->length -= sigSize;
+        return UA_STATUSCODE_GOOD;
+    }
+
     if(doValidate) {
         size_t sigSize = securityPolicy->symmetricModule.cryptoModule.
             signatureAlgorithm.getLocalSignatureSize(channelContext);
@@ -270,6 +270,9 @@ addSecurityGroup(UA_Server *server, UA_NodeId securityGroupFolderNodeId,
         UA_NodeId_copy(&newSecurityGroup->securityGroupNodeId, securityGroupNodeId);
 
     TAILQ_INSERT_TAIL(&server->pubSubManager.securityGroups, newSecurityGroup, listEntry);
+    UA_PubSubManager_addIndex(&server->pubSubManager, &newSecurityGroup->indexEntry,
+                              UA_PUBSUBINDEX_SECURITYGROUP,
+                              &newSecurityGroup->securityGroupNodeId, newSecurityGroup);
 
     server->pubSubManager.securityGroupsSize++;
     return retval;
@@ -288,12 +291,9 @@ UA_Server_addSecurityGroup(UA_Server *server, UA_NodeId securityGroupFolderNodeI
 
 UA_SecurityGroup *
 UA_SecurityGroup_findSGbyId(UA_Server *server, UA_NodeId identifier) {
-    UA_SecurityGroup *tmpSG;
-    TAILQ_FOREACH(tmpSG, &server->pubSubManager.securityGroups, listEntry) {
-        if(UA_NodeId_equal(&identifier, &tmpSG->securityGroupNodeId))
-            return tmpSG;
-    }
-    return NULL;
+    return (UA_SecurityGroup*)
+        UA_PubSubManager_findIndex(&server->pubSubManager, UA_PUBSUBINDEX_SECURITYGROUP,
+                                   &identifier);
 }
 
 static void
@@ -329,6 +329,7 @@ removeSecurityGroup(UA_Server *server, UA_SecurityGroup *securityGroup) {
     /* Unlink from the server */
     TAILQ_REMOVE(&server->pubSubManager.securityGroups, securityGroup, listEntry);
     server->pubSubManager.securityGroupsSize--;
+    UA_PubSubManager_removeIndex(&server->pubSubManager, &securityGroup->indexEntry);
     if(securityGroup->callbackId > 0)
         removeCallback(server, securityGroup->callbackId);
 
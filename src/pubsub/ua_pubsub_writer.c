@@ -71,19 +71,9 @@ UA_Server_DataSetWriter_getState(UA_Server *server, UA_NodeId dataSetWriterIdent
 
 UA_DataSetWriter *
 UA_DataSetWriter_findDSWbyId(UA_Server *server, UA_NodeId identifier) {
-    UA_PubSubConnection *pubSubConnection;
-    TAILQ_FOREACH(pubSubConnection, &server->pubSubManager.connections, listEntry){
-        UA_WriterGroup *tmpWriterGroup;
-        LIST_FOREACH(tmpWriterGroup, &pubSubConnection->writerGroups, listEntry){
-            UA_DataSetWriter *tmpWriter;
-            LIST_FOREACH(tmpWriter, &tmpWriterGroup->writers, listEntry){
-                if(UA_NodeId_equal(&tmpWriter->identifier, &identifier)){
-                    return tmpWriter;
-                }
-            }
-        }
-    }
-    return NULL;
+    return (UA_DataSetWriter*)
+        UA_PubSubManager_findIndex(&server->pubSubManager, UA_PUBSUBINDEX_DATASETWRITER,
+                                   &identifier);
 }
 
 void
@@ -253,7 +243,11 @@ UA_DataSetWriter_create(UA_Server *server,
             if(currentDataSetContext->fieldSize > 0) {
                 newDataSetWriter->lastSamples = (UA_DataSetWriterSample*)
                     UA_calloc(currentDataSetContext->fieldSize, sizeof(UA_DataSetWriterSample));
-                if(!newDataSetWriter->lastSamples) {
+                newDataSetWriter->deltaSamples = (UA_DataValue*)
+                    UA_calloc(currentDataSetContext->fieldSize, sizeof(UA_DataValue));
+                if(!newDataSetWriter->lastSamples || !newDataSetWriter->deltaSamples) {
+                    UA_free(newDataSetWriter->lastSamples);
+                    UA_free(newDataSetWriter->deltaSamples);
                     UA_DataSetWriterConfig_clear(&newDataSetWriter->config);
                     UA_free(newDataSetWriter);
                     return UA_STATUSCODE_BADOUTOFMEMORY;
@@ -267,11 +261,13 @@ UA_DataSetWriter_create(UA_Server *server,
         }
         /* Connect PublishedDataSet with DataSetWriter */
         newDataSetWriter->connectedDataSet = currentDataSetContext->identifier;
+        newDataSetWriter->connectedPDS = currentDataSetContext;
     } else {
         /* If the dataSet is NULL, we are adding a heartbeat writer */
         newDataSetWriter->connectedDataSetVersion.majorVersion = 0;
         newDataSetWriter->connectedDataSetVersion.minorVersion = 0;
         newDataSetWriter->connectedDataSet = UA_NODEID_NULL;
+        newDataSetWriter->connectedPDS = NULL;
     }
 
     /* Add the new writer to the group */
@@ -285,6 +281,9 @@ UA_DataSetWriter_create(UA_Server *server,
     UA_PubSubManager_generateUniqueNodeId(&server->pubSubManager,
                                           &newDataSetWriter->identifier);
 #endif
+    UA_PubSubManager_addIndex(&server->pubSubManager, &newDataSetWriter->indexEntry,
+                              UA_PUBSUBINDEX_DATASETWRITER, &newDataSetWriter->identifier,
+                              newDataSetWriter);
 
     /* Cache the log string */
     UA_String idStr = UA_STRING_NULL;
@@ -325,8 +324,7 @@ UA_Server_addDataSetWriter(UA_Server *server,
 void
 UA_DataSetWriter_freezeConfiguration(UA_Server *server,
                                      UA_DataSetWriter *dsw) {
-    UA_PublishedDataSet *pds =
-        UA_PublishedDataSet_findPDSbyId(server, dsw->connectedDataSet);
+    UA_PublishedDataSet *pds = dsw->connectedPDS;
     if(pds) { /* Skip for heartbeat writers */
         pds->configurationFreezeCounter++;
         UA_DataSetField *dsf;
@@ -340,8 +338,7 @@ UA_DataSetWriter_freezeConfiguration(UA_Server *server,
 void
 UA_DataSetWriter_unfreezeConfiguration(UA_Server *server,
                                        UA_DataSetWriter *dsw) {
-    UA_PublishedDataSet *pds =
-        UA_PublishedDataSet_findPDSbyId(server, dsw->connectedDataSet);
+    UA_PublishedDataSet *pds = dsw->connectedPDS;
     if(pds) { /* Skip for heartbeat writers */
         pds->configurationFreezeCounter--;
         if(pds->configurationFreezeCounter == 0) {
@@ -359,8 +356,7 @@ UA_DataSetWriter_prepareDataSet(UA_Server *server, UA_DataSetWriter *dsw,
                                 UA_DataSetMessage *dsm) {
     /* Find the dataset */
     UA_StatusCode res = UA_STATUSCODE_GOOD;
-    UA_PublishedDataSet *pds =
-        UA_PublishedDataSet_findPDSbyId(server, dsw->connectedDataSet);
+    UA_PublishedDataSet *pds = dsw->connectedPDS;
     if(!pds) {
         if(!UA_NodeId_isNull(&dsw->connectedDataSet)) {
             UA_LOG_WARNING_WRITER(server->config.logging, dsw,
@@ -422,7 +418,8 @@ UA_DataSetWriter_prepareDataSet(UA_Server *server, UA_DataSetWriter *dsw,
         }
     }
 
-    /* Generate the DSM */
+    /* Generate the DSM. The buffered message is always a KeyFrame. */
+    dsw->deltaFrameCounter = 0;
     res = UA_DataSetWriter_generateDataSetMessage(server, dsm, dsw);
     if(res != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING_WRITER(server->config.logging, dsw,
@@ -453,6 +450,7 @@ UA_DataSetWriter_remove(UA_Server *server, UA_DataSetWriter *dataSetWriter) {
     UA_WriterGroup *linkedWriterGroup = dataSetWriter->linkedWriterGroup;
     LIST_REMOVE(dataSetWriter, listEntry);
     linkedWriterGroup->writersCount--;
+    UA_PubSubManager_removeIndex(&server->pubSubManager, &dataSetWriter->indexEntry);
 
     UA_LOG_INFO_WRITER(server->config.logging, dataSetWriter, "Writer deleted");
 
@@ -466,7 +464,9 @@ UA_DataSetWriter_remove(UA_Server *server, UA_DataSetWriter *dataSetWriter) {
             UA_DataValue_clear(&dataSetWriter->lastSamples[i].value);
         }
         UA_free(dataSetWriter->lastSamples);
+        UA_free(dataSetWriter->deltaSamples);
         dataSetWriter->lastSamples = NULL;
+        dataSetWriter->deltaSamples = NULL;
         dataSetWriter->lastSamplesCount = 0;
     }
 
@@ -549,8 +549,7 @@ static UA_StatusCode
 UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_Server *server,
                                                UA_DataSetMessage *dataSetMessage,
                                                UA_DataSetWriter *dataSetWriter) {
-    UA_PublishedDataSet *currentDataSet =
-        UA_PublishedDataSet_findPDSbyId(server, dataSetWriter->connectedDataSet);
+    UA_PublishedDataSet *currentDataSet = dataSetWriter->connectedPDS;
     if(!currentDataSet)
         return UA_STATUSCODE_BADNOTFOUND;
 
@@ -560,8 +559,8 @@ UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_Server *server,
     dataSetMessage->data.keyFrameData.fieldCount = currentDataSet->fieldSize;
     dataSetMessage->data.keyFrameData.dataSetFields = (UA_DataValue *)
             UA_Array_new(currentDataSet->fieldSize, &UA_TYPES[UA_TYPES_DATAVALUE]);
-    UA_PublishedDataSet *pds = UA_PublishedDataSet_findPDSbyId(server, dataSetWriter->connectedDataSet);
-    dataSetMessage->data.keyFrameData.dataSetMetaDataType = &pds->dataSetMetaData;
+    dataSetMessage->data.keyFrameData.dataSetMetaDataType =
+        &currentDataSet->dataSetMetaData;
     if(!dataSetMessage->data.keyFrameData.dataSetFields)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
@@ -574,6 +573,10 @@ UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_Server *server,
     }
 #endif
 
+    /* Sample all values at once */
+    UA_PublishedDataSet_sampleValues(server, currentDataSet,
+                                     dataSetMessage->data.keyFrameData.dataSetFields);
+
     /* Loop over the fields */
     size_t counter = 0;
     UA_DataSetField *dsf;
@@ -584,9 +587,7 @@ UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_Server *server,
                        &dataSetMessage->data.keyFrameData.fieldNames[counter]);
 #endif
 
-        /* Sample the value */
         UA_DataValue *dfv = &dataSetMessage->data.keyFrameData.dataSetFields[counter];
-        UA_PubSubDataSetField_sampleValue(server, dsf, dfv);
 
         /* Deactivate statuscode? */
         if(((u64)dataSetWriter->config.dataSetFieldContentMask &
@@ -623,8 +624,7 @@ static UA_StatusCode
 UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_Server *server,
                                                  UA_DataSetMessage *dataSetMessage,
                                                  UA_DataSetWriter *dataSetWriter) {
-    UA_PublishedDataSet *currentDataSet =
-        UA_PublishedDataSet_findPDSbyId(server, dataSetWriter->connectedDataSet);
+    UA_PublishedDataSet *currentDataSet = dataSetWriter->connectedPDS;
     if(!currentDataSet)
         return UA_STATUSCODE_BADNOTFOUND;
 
@@ -634,40 +634,45 @@ UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_Server *server,
     if(currentDataSet->fieldSize == 0)
         return UA_STATUSCODE_GOOD;
 
-    UA_DataSetField *dsf;
-    UA_UInt16 counter = 0;
-    TAILQ_FOREACH(dsf, &currentDataSet->fields, listEntry) {
-        /* Sample the value */
-        UA_DataValue value;
-        UA_DataValue_init(&value);
-        UA_PubSubDataSetField_sampleValue(server, dsf, &value);
-
+    /* Sample the values into the preallocated array of the writer. Its
+     * entries are moved into lastSamples or cleared below. */
+    if(!dataSetWriter->deltaSamples ||
+       dataSetWriter->lastSamplesCount < currentDataSet->fieldSize)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    UA_DataValue *values = dataSetWriter->deltaSamples;
+    memset(values, 0, sizeof(UA_DataValue) * currentDataSet->fieldSize);
+    UA_PublishedDataSet_sampleValues(server, currentDataSet, values);
+
+    /* Compare with the last sent values */
+    UA_UInt16 changed = 0;
+    for(size_t i = 0; i < currentDataSet->fieldSize; i++) {
         /* Check if the value has changed */
-        UA_DataSetWriterSample *ls = &dataSetWriter->lastSamples[counter];
-        if(valueChangedVariant(&ls->value.value, &value.value)) {
-            /* increase fieldCount for current delta message */
-            dataSetMessage->data.deltaFrameData.fieldCount++;
+        UA_DataSetWriterSample *ls = &dataSetWriter->lastSamples[i];
+        if(valueChangedVariant(&ls->value.value, &values[i].value)) {
+            changed++;
             ls->valueChanged = true;
 
             /* Update last stored sample */
             UA_DataValue_clear(&ls->value);
-            ls->value = value;
+            ls->value = values[i];
         } else {
-            UA_DataValue_clear(&value);
+            UA_DataValue_clear(&values[i]);
             ls->valueChanged = false;
         }
-
-        counter++;
     }
 
-    /* Allocate DeltaFrameFields */
+    /* No field has changed. Send the DeltaFrame without fields. */
+    if(changed == 0)
+        return UA_STATUSCODE_GOOD;
+
+    /* Allocate DeltaFrameFields for the changed values only */
     UA_DataSetMessage_DeltaFrameField *deltaFields = (UA_DataSetMessage_DeltaFrameField *)
-        UA_calloc(counter, sizeof(UA_DataSetMessage_DeltaFrameField));
+        UA_calloc(changed, sizeof(UA_DataSetMessage_DeltaFrameField));
     if(!deltaFields)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
     dataSetMessage->data.deltaFrameData.deltaFrameFields = deltaFields;
-    dataSetMessage->data.deltaFrameData.fieldCount = counter;
+    dataSetMessage->data.deltaFrameData.fieldCount = changed;
 
     size_t currentDeltaField = 0;
     for(size_t i = 0; i < currentDataSet->fieldSize; i++) {
@@ -693,7 +698,7 @@ UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_Server *server,
             dff->fieldValue.hasSourceTimestamp = false;
         if(((u64)dataSetWriter->config.dataSetFieldContentMask &
             (u64)UA_DATASETFIELDCONTENTMASK_SOURCEPICOSECONDS) == 0)
-            dff->fieldValue.hasServerPicoseconds = false;
+            dff->fieldValue.hasSourcePicoseconds = false;
         if(((u64)dataSetWriter->config.dataSetFieldContentMask &
             (u64)UA_DATASETFIELDCONTENTMASK_SERVERTIMESTAMP) == 0)
             dff->fieldValue.hasServerTimestamp = false;
@@ -717,8 +722,7 @@ UA_DataSetWriter_generateDataSetMessage(UA_Server *server,
     if(UA_NodeId_isNull(&dataSetWriter->connectedDataSet)){
         heartbeat = true;
     } else {
-        currentDataSet =
-            UA_PublishedDataSet_findPDSbyId(server, dataSetWriter->connectedDataSet);
+        currentDataSet = dataSetWriter->connectedPDS;
         if(!currentDataSet){
             return UA_STATUSCODE_BADNOTFOUND;
         }
@@ -888,8 +892,10 @@ UA_DataSetWriter_generateDataSetMessage(UA_Server *server,
      * are currently used. */
     if(dsm && server->config.pubSubConfig.enableDeltaFrames) {
         /* Check if the PublishedDataSet version has changed -> if yes flush the
-         * lastValue store and send a KeyFrame */
-        if(dataSetWriter->connectedDataSetVersion.majorVersion !=
+         * lastValue store and send a KeyFrame. The version has a resolution
+         * of seconds. So also check if the number of fields has changed. */
+        if(dataSetWriter->lastSamplesCount != currentDataSet->fieldSize ||
+           dataSetWriter->connectedDataSetVersion.majorVersion !=
            currentDataSet->dataSetMetaData.configurationVersion.majorVersion ||
            dataSetWriter->connectedDataSetVersion.minorVersion !=
            currentDataSet->dataSetMetaData.configurationVersion.minorVersion) {
@@ -907,6 +913,12 @@ UA_DataSetWriter_generateDataSetMessage(UA_Server *server,
             dataSetWriter->lastSamples = newSamplesArray;
             memset(dataSetWriter->lastSamples, 0,
                    sizeof(UA_DataSetWriterSample) * dataSetWriter->lastSamplesCount);
+            UA_DataValue *newDeltaSamples = (UA_DataValue*)
+                UA_realloc(dataSetWriter->deltaSamples,
+                           sizeof(UA_DataValue) * dataSetWriter->lastSamplesCount);
+            if(!newDeltaSamples)
+                return UA_STATUSCODE_BADOUTOFMEMORY;
+            dataSetWriter->deltaSamples = newDeltaSamples;
 
             dataSetWriter->connectedDataSetVersion =
                 currentDataSet->dataSetMetaData.configurationVersion;
@@ -918,13 +930,15 @@ UA_DataSetWriter_generateDataSetMessage(UA_Server *server,
 
         /* The standard defines: if a PDS contains only one fields no delta messages
          * should be generated because they need more memory than a keyframe with 1
-         * field. */
+         * field. With a KeyFrameCount of N, every N-th message is a KeyFrame and
+         * the messages in between are DeltaFrames. DeltaFrames are not defined
+         * for the RawData field encoding. */
         if(currentDataSet->fieldSize > 1 && dataSetWriter->deltaFrameCounter > 0 &&
-           dataSetWriter->deltaFrameCounter <= dataSetWriter->config.keyFrameCount) {
-            UA_PubSubDataSetWriter_generateDeltaFrameMessage(server, dataSetMessage,
-                                                             dataSetWriter);
+           dataSetWriter->deltaFrameCounter < dataSetWriter->config.keyFrameCount &&
+           dataSetMessage->header.fieldEncoding != UA_FIELDENCODING_RAWDATA) {
             dataSetWriter->deltaFrameCounter++;
-            return UA_STATUSCODE_GOOD;
+            return UA_PubSubDataSetWriter_generateDeltaFrameMessage(server, dataSetMessage,
+                                                                    dataSetWriter);
         }
 
         dataSetWriter->deltaFrameCounter = 1;
@@ -25,6 +25,9 @@
 #define UA_MAX_STACKBUF 128 /* Max size of network messages on the stack */
 
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+static UA_StatusCode
+generateMessageNonce(UA_WriterGroup *wg, UA_NetworkMessage *nm);
+
 static UA_StatusCode
 encryptAndSign(UA_WriterGroup *wg, const UA_NetworkMessage *nm,
                UA_Byte *signStart, UA_Byte *encryptStart,
@@ -61,6 +64,9 @@ UA_WriterGroup_addPublishCallback(UA_Server *server, UA_WriterGroup *wg) {
     if(wg->publishCallbackId != 0)
         return UA_STATUSCODE_GOOD;
 
+    /* Start the jitter statistics with the next cycle */
+    wg->nextPublishTime = 0;
+
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
     if(wg->config.pubsubManagerCallback.addCustomCallback) {
         /* Use configured mechanism for cyclic callbacks */
@@ -174,6 +180,9 @@ UA_WriterGroup_create(UA_Server *server, const UA_NodeId connection,
     UA_PubSubManager_generateUniqueNodeId(&server->pubSubManager,
                                           &newWriterGroup->identifier);
 #endif
+    UA_PubSubManager_addIndex(&server->pubSubManager, &newWriterGroup->indexEntry,
+                              UA_PUBSUBINDEX_WRITERGROUP, &newWriterGroup->identifier,
+                              newWriterGroup);
 
     /* Cache the log string */
     UA_String idStr = UA_STRING_NULL;
@@ -230,9 +239,10 @@ UA_WriterGroup_create(UA_Server *server, const UA_NodeId connection,
 
 #endif
 
-    /* Trigger the connection */
-    UA_PubSubConnection_setPubSubState(server, currentConnectionContext,
-                                       currentConnectionContext->state);
+    /* Trigger the connection (done once at the end of a bulk apply) */
+    if(!server->pubSubManager.bulkApply)
+        UA_PubSubConnection_setPubSubState(server, currentConnectionContext,
+                                           currentConnectionContext->state);
 
     /* Copying a numeric NodeId always succeeds */
     if(writerGroupIdentifier)
@@ -252,6 +262,50 @@ UA_Server_addWriterGroup(UA_Server *server, const UA_NodeId connection,
     return res;
 }
 
+/* Collect the value buffers of the published fields. Their snapshots are
+ * referenced by the bufferedMessage. */
+static UA_StatusCode
+collectRTValueBuffers(UA_Server *server, UA_WriterGroup *wg) {
+    size_t count = 0;
+    UA_DataSetWriter *dsw;
+    UA_DataSetField *dsf;
+    LIST_FOREACH(dsw, &wg->writers, listEntry) {
+        UA_PublishedDataSet *pds = dsw->connectedPDS;
+        if(!pds)
+            continue;
+        TAILQ_FOREACH(dsf, &pds->fields, listEntry) {
+            if(dsf->config.field.variable.rtValueSource.valueBuffer)
+                count++;
+        }
+    }
+    if(count == 0)
+        return UA_STATUSCODE_GOOD;
+
+    wg->rtValueBuffers = (UA_PubSubValueBuffer**)
+        UA_calloc(count, sizeof(UA_PubSubValueBuffer*));
+    if(!wg->rtValueBuffers)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    LIST_FOREACH(dsw, &wg->writers, listEntry) {
+        UA_PublishedDataSet *pds = dsw->connectedPDS;
+        if(!pds)
+            continue;
+        TAILQ_FOREACH(dsf, &pds->fields, listEntry) {
+            UA_PubSubValueBuffer *vb =
+                dsf->config.field.variable.rtValueSource.valueBuffer;
+            if(vb)
+                wg->rtValueBuffers[wg->rtValueBuffersSize++] = vb;
+        }
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+releaseRTValueBuffers(UA_WriterGroup *wg) {
+    UA_free(wg->rtValueBuffers);
+    wg->rtValueBuffers = NULL;
+    wg->rtValueBuffersSize = 0;
+}
+
 UA_StatusCode
 UA_WriterGroup_remove(UA_Server *server, UA_WriterGroup *wg) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
@@ -303,6 +357,7 @@ UA_WriterGroup_remove(UA_Server *server, UA_WriterGroup *wg) {
         /* Unlink from the connection */
         LIST_REMOVE(wg, listEntry);
         connection->writerGroupsSize--;
+        UA_PubSubManager_removeIndex(&server->pubSubManager, &wg->indexEntry);
         wg->linkedConnection = NULL;
 
         /* Actually remove the WriterGroup */
@@ -315,6 +370,7 @@ UA_WriterGroup_remove(UA_Server *server, UA_WriterGroup *wg) {
         UA_WriterGroupConfig_clear(&wg->config);
         UA_NodeId_clear(&wg->identifier);
         UA_String_clear(&wg->logIdString);
+        releaseRTValueBuffers(wg);
         UA_NetworkMessageOffsetBuffer_clear(&wg->bufferedMessage);
         UA_free(wg);
     }
@@ -434,13 +490,17 @@ UA_WriterGroup_freezeConfiguration(UA_Server *server, UA_WriterGroup *wg) {
 
         wg->bufferedMessage.nm = (UA_NetworkMessage *)UA_calloc(1,sizeof(UA_NetworkMessage));
         wg->bufferedMessage.nm->securityHeader = networkMessage.securityHeader;
-        UA_ByteString_allocBuffer(&wg->bufferedMessage.encryptBuffer, msgSize);
     }
 #endif
 
     if(wg->config.securityMode <= UA_MESSAGESECURITYMODE_NONE)
         UA_NetworkMessage_encodeBinary(&networkMessage, &bufPos, bufEnd, NULL);
 
+    /* Replace the encoding of the fixed-size fields with plain copies */
+    res = UA_NetworkMessageOffsetBuffer_compilePatches(&wg->bufferedMessage);
+    if(res == UA_STATUSCODE_GOOD)
+        res = collectRTValueBuffers(server, wg);
+
  cleanup:
     UA_free(networkMessage.payload.dataSetPayload.sizes);
 
@@ -472,6 +532,22 @@ UA_Server_freezeWriterGroupConfiguration(UA_Server *server,
     return res;
 }
 
+/* Return the network buffers of the zero-copy RT publishing to the
+ * ConnectionManager */
+static void
+releaseRTSendBuffers(UA_WriterGroup *wg) {
+    UA_ConnectionManager *cm = wg->linkedConnection->cm;
+    for(size_t i = 0; i < UA_PUBSUB_RT_SENDBUFFERS; i++) {
+        if(!wg->rtSendBuffers[i].data)
+            continue;
+        if(cm)
+            cm->freeNetworkBuffer(cm, wg->rtSendChannel, &wg->rtSendBuffers[i]);
+        UA_ByteString_init(&wg->rtSendBuffers[i]);
+    }
+    wg->rtSendChannel = 0;
+    wg->rtSendBufferIndex = 0;
+}
+
 UA_StatusCode
 UA_WriterGroup_unfreezeConfiguration(UA_Server *server, UA_WriterGroup *wg) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
@@ -483,12 +559,18 @@ UA_WriterGroup_unfreezeConfiguration(UA_Server *server, UA_WriterGroup *wg) {
     UA_PubSubConnection *pubSubConnection =  wg->linkedConnection;
     pubSubConnection->configurationFreezeCounter--;
 
+    /* Wait for the unlocked publishing to leave */
+    UA_PubSubRTLock_stop(&wg->rtLock);
+
     /* DataSetWriter unfreeze */
     UA_DataSetWriter *dsw;
     LIST_FOREACH(dsw, &wg->writers, listEntry) {
         UA_DataSetWriter_unfreezeConfiguration(server, dsw);
     }
 
+    releaseRTSendBuffers(wg);
+    wg->rtZeroCopyDisabled = false;
+    releaseRTValueBuffers(wg);
     UA_NetworkMessageOffsetBuffer_clear(&wg->bufferedMessage);
     wg->configurationFrozen = false;
 
@@ -706,20 +788,47 @@ UA_WriterGroup_lastPublishTimestamp(UA_Server *server, const UA_NodeId writerGro
     return UA_STATUSCODE_BADNOTFOUND;
 }
 
+UA_StatusCode
+UA_Server_getWriterGroupTimingStatistics(UA_Server *server, const UA_NodeId wgId,
+                                         UA_WriterGroupTimingStatistics *stats) {
+    UA_LOCK(&server->serviceMutex);
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, wgId);
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(!wg)
+        res = UA_STATUSCODE_BADNOTFOUND;
+    else if(!wg->config.timingStatistics)
+        res = UA_STATUSCODE_BADNOTSUPPORTED;
+    else
+        *stats = wg->timing;
+    UA_UNLOCK(&server->serviceMutex);
+    return res;
+}
+
+UA_StatusCode
+UA_Server_resetWriterGroupTimingStatistics(UA_Server *server, const UA_NodeId wgId) {
+    UA_LOCK(&server->serviceMutex);
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, wgId);
+    if(!wg) {
+        UA_UNLOCK(&server->serviceMutex);
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+    memset(&wg->timing, 0, sizeof(UA_WriterGroupTimingStatistics));
+    UA_UNLOCK(&server->serviceMutex);
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_WriterGroup *
 UA_WriterGroup_findWGbyId(UA_Server *server, UA_NodeId identifier) {
-    UA_PubSubConnection *tmpConnection;
-    TAILQ_FOREACH(tmpConnection, &server->pubSubManager.connections, listEntry) {
-        UA_WriterGroup *tmpWriterGroup;
-        LIST_FOREACH(tmpWriterGroup, &tmpConnection->writerGroups, listEntry) {
-            if(UA_NodeId_equal(&identifier, &tmpWriterGroup->identifier))
-                return tmpWriterGroup;
-        }
-    }
-    return NULL;
+    return (UA_WriterGroup*)
+        UA_PubSubManager_findIndex(&server->pubSubManager, UA_PUBSUBINDEX_WRITERGROUP,
+                                   &identifier);
 }
 
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+/* Start of the AEAD nonce counter (2024-01-01 UTC, see generateMessageNonce) */
+#define UA_AEAD_NONCE_EPOCH \
+    (UA_DATETIME_UNIX_EPOCH + (UA_DateTime)1704067200 * UA_DATETIME_SEC)
+
 UA_StatusCode
 setWriterGroupEncryptionKeys(UA_Server *server, const UA_NodeId writerGroup,
                              UA_UInt32 securityTokenId,
@@ -747,6 +856,12 @@ setWriterGroupEncryptionKeys(UA_Server *server, const UA_NodeId writerGroup,
         wg->nonceSequenceNumber = 1;
     }
 
+    /* The AEAD nonce counter never goes back (see generateMessageNonce) */
+    UA_UInt64 now = (UA_UInt64)
+        ((UA_DateTime_now() - UA_AEAD_NONCE_EPOCH) / UA_DATETIME_USEC);
+    if(wg->nonceCounter < now)
+        wg->nonceCounter = now;
+
     if(!wg->securityPolicyContext) {
         /* Create a new context */
         res = wg->config.securityPolicy->
@@ -799,6 +914,9 @@ UA_WriterGroup_setPubSubState(UA_Server *server, UA_WriterGroup *wg,
     UA_StatusCode ret = UA_STATUSCODE_GOOD;
     UA_PubSubConnection *connection = wg->linkedConnection;
     UA_PubSubState oldState = wg->state;
+
+    /* Wait for the unlocked publishing to leave */
+    UA_PubSubRTLock_stop(&wg->rtLock);
     wg->state = targetState;
 
     switch(wg->state) {
@@ -877,12 +995,96 @@ UA_WriterGroup_setPubSubState(UA_Server *server, UA_WriterGroup *wg,
 }
 
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+/* Generate the MessageNonce.
+ *
+ * For the policies from Part 14 the eight-byte nonce has four random bytes
+ * followed by a four-byte sequence number.
+ *
+ * A repeated nonce under the same key breaks the AEAD policies. Their
+ * twelve-byte nonce is derived deterministically from a four-byte SenderId
+ * (the PublisherId), the two-byte WriterGroupId and a six-byte counter. The
+ * counter continues from the current time in microseconds since
+ * UA_AEAD_NONCE_EPOCH when the keys are set and increments with every message.
+ * So it does not restart after a reconnect or a restart of the publisher with
+ * the same key. This requires that the PublisherIds sharing a key fit into 32
+ * bit (longer ones are hashed), that the clock does not jump back and that less
+ * than one message per microsecond is sent on average.
+ *
+ * The six-byte counter wraps after 2^48 microseconds (about 8.9 years), that
+ * is in November 2032. A key must not be used across the wrap. The keys of the
+ * SecurityKeyService rotate far more often. Statically configured keys must be
+ * replaced before that date. */
+#define UA_AEAD_MESSAGENONCE_LENGTH 12
+
+static UA_UInt32
+nonceSenderId(const UA_PubSubConnection *c) {
+    const UA_PublisherId *id = &c->config.publisherId;
+    switch(c->config.publisherIdType) {
+    case UA_PUBLISHERIDTYPE_BYTE: return id->byte;
+    case UA_PUBLISHERIDTYPE_UINT16: return id->uint16;
+    case UA_PUBLISHERIDTYPE_UINT32: return id->uint32;
+    case UA_PUBLISHERIDTYPE_UINT64: return (UA_UInt32)(id->uint64 ^ (id->uint64 >> 32));
+    case UA_PUBLISHERIDTYPE_STRING:
+        return UA_ByteString_hash(0, id->string.data, id->string.length);
+    default: return 0;
+    }
+}
+
+static UA_StatusCode
+generateMessageNonce(UA_WriterGroup *wg, UA_NetworkMessage *nm) {
+    UA_Byte *nonceData = nm->securityHeader.messageNonce;
+    UA_Byte *pos = nonceData;
+    UA_StatusCode rv;
+
+    if(wg->config.securityPolicy->encryptAndSign) {
+        UA_UInt32 senderId = nonceSenderId(wg->linkedConnection);
+        UA_UInt64 counter = wg->nonceCounter++;
+        const UA_Byte *end = &nonceData[UA_AEAD_MESSAGENONCE_LENGTH];
+        rv = UA_UInt32_encodeBinary(&senderId, &pos, end);
+        rv |= UA_UInt16_encodeBinary(&wg->config.writerGroupId, &pos, end);
+        for(size_t i = 0; i < 6; i++)
+            *pos++ = (UA_Byte)(counter >> (8 * i));
+        nm->securityHeader.messageNonceSize = UA_AEAD_MESSAGENONCE_LENGTH;
+        return rv;
+    }
+
+    UA_ByteString nonce = {4, nonceData};
+    rv = wg->config.securityPolicy->symmetricModule.
+        generateNonce(wg->config.securityPolicy->policyContext, &nonce);
+    if(rv != UA_STATUSCODE_GOOD)
+        return rv;
+    pos = &nonceData[4];
+    const UA_Byte *end = &nonceData[8];
+    wg->nonceSequenceNumber++;
+    nm->securityHeader.messageNonceSize = 8;
+    return UA_UInt32_encodeBinary(&wg->nonceSequenceNumber, &pos, end);
+}
+
 static UA_StatusCode
 encryptAndSign(UA_WriterGroup *wg, const UA_NetworkMessage *nm,
                UA_Byte *signStart, UA_Byte *encryptStart,
                UA_Byte *msgEnd) {
     UA_StatusCode rv;
     void *channelContext = wg->securityPolicyContext;
+    UA_PubSubSecurityPolicy *sp = wg->config.securityPolicy;
+
+    /* Authenticated encryption in a single pass over the message */
+    if(sp->encryptAndSign && nm->securityHeader.networkMessageSigned) {
+        const UA_ByteString nonce = {
+            (size_t)nm->securityHeader.messageNonceSize,
+            (UA_Byte*)(uintptr_t)nm->securityHeader.messageNonce
+        };
+        rv = sp->setMessageNonce(channelContext, &nonce);
+        UA_CHECK_STATUS(rv, return rv);
+
+        size_t sigSize = sp->symmetricModule.cryptoModule.
+            signatureAlgorithm.getLocalSignatureSize(channelContext);
+        size_t sigOffset = (uintptr_t)msgEnd - (uintptr_t)signStart;
+        size_t encOffset = (nm->securityHeader.networkMessageEncrypted) ?
+            (uintptr_t)encryptStart - (uintptr_t)signStart : sigOffset;
+        UA_ByteString message = {sigOffset + sigSize, signStart};
+        return sp->encryptAndSign(channelContext, &message, encOffset, sigOffset);
+    }
 
     if(nm->securityHeader.networkMessageEncrypted) {
         /* Set the temporary MessageNonce in the SecurityPolicy */
@@ -917,9 +1119,46 @@ encryptAndSign(UA_WriterGroup *wg, const UA_NetworkMessage *nm,
 }
 #endif
 
+/* Timestamp for the timing statistics. Zero if they are not recorded. */
+static UA_DateTime
+timingNow(UA_Server *server, UA_WriterGroup *wg) {
+    if(!wg->config.timingStatistics)
+        return 0;
+    UA_EventLoop *el = UA_PubSubConnection_getEL(server, wg->linkedConnection);
+    return el->dateTime_nowMonotonic(el);
+}
+
+/* Record the duration since *start and restart the measurement */
+static void
+recordDuration(UA_Server *server, UA_WriterGroup *wg,
+               UA_PubSubHistogram *h, UA_DateTime *start) {
+    if(*start == 0)
+        return;
+    UA_DateTime now = timingNow(server, wg);
+    UA_PubSubHistogram_add(h, now - *start);
+    *start = now;
+}
+
+/* Record the deviation of the publish callback from the scheduled time. The
+ * timer reschedules from the current time after a cycle miss. */
+static void
+recordPublishJitter(UA_Server *server, UA_WriterGroup *wg) {
+    UA_DateTime now = timingNow(server, wg);
+    if(now == 0)
+        return;
+    if(wg->nextPublishTime != 0)
+        UA_PubSubHistogram_add(&wg->timing.publishJitter, now - wg->nextPublishTime);
+    UA_DateTime interval = (UA_DateTime)
+        (wg->config.publishingInterval * (UA_Double)UA_DATETIME_MSEC);
+    wg->nextPublishTime += interval;
+    if(wg->nextPublishTime <= now)
+        wg->nextPublishTime = now + interval;
+}
+
 static UA_StatusCode
-encodeNetworkMessage(UA_WriterGroup *wg, UA_NetworkMessage *nm,
+encodeNetworkMessage(UA_Server *server, UA_WriterGroup *wg, UA_NetworkMessage *nm,
                      UA_ByteString *buf) {
+    UA_DateTime start = timingNow(server, wg);
     UA_Byte *bufPos = buf->data;
     UA_Byte *bufEnd = &buf->data[buf->length];
 
@@ -937,36 +1176,74 @@ encodeNetworkMessage(UA_WriterGroup *wg, UA_NetworkMessage *nm,
 
     rv = UA_NetworkMessage_encodeFooters(nm, &bufPos, bufEnd);
     UA_CHECK_STATUS(rv, return rv);
+    recordDuration(server, wg, &wg->timing.encodeDuration, &start);
 
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
     /* Encrypt and Sign the message */
-    UA_Byte *footerEnd = bufPos;
-    rv = encryptAndSign(wg, nm, networkMessageStart, payloadStart, footerEnd);
-    UA_CHECK_STATUS(rv, return rv);
+    if(wg->config.securityMode > UA_MESSAGESECURITYMODE_NONE) {
+        UA_Byte *footerEnd = bufPos;
+        rv = encryptAndSign(wg, nm, networkMessageStart, payloadStart, footerEnd);
+        UA_CHECK_STATUS(rv, return rv);
+        recordDuration(server, wg, &wg->timing.encryptDuration, &start);
+    }
 #endif
 
     return UA_STATUSCODE_GOOD;
 }
 
-static void
-sendNetworkMessageBuffer(UA_Server *server, UA_WriterGroup *wg, 
-                         UA_PubSubConnection *connection, uintptr_t connectionId,
-                         UA_ByteString *buffer) {
+/* Send without changing the PubSubState. Can be used without the server
+ * lock. */
+static UA_StatusCode
+sendNetworkMessageBufferRT(UA_Server *server, UA_WriterGroup *wg,
+                           UA_PubSubConnection *connection, uintptr_t connectionId,
+                           const UA_KeyValueMap *params, UA_ByteString *buffer) {
+    UA_DateTime start = timingNow(server, wg);
     UA_StatusCode res = connection->cm->
-        sendWithConnection(connection->cm, connectionId,
-                           &UA_KEYVALUEMAP_NULL, buffer);
-
-    /* Failure, set the WriterGroup into an error mode */
+        sendWithConnection(connection->cm, connectionId, params, buffer);
+    recordDuration(server, wg, &wg->timing.sendDuration, &start);
+    if(res == UA_STATUSCODE_BADRESOURCEUNAVAILABLE) {
+        UA_LOG_DEBUG_WRITERGROUP(server->config.logging, wg,
+                                 "The transport is congested, "
+                                 "the NetworkMessage is dropped");
+        return res;
+    }
     if(res != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR_WRITERGROUP(server->config.logging, wg,
                                  "Sending NetworkMessage failed");
-        UA_WriterGroup_setPubSubState(server, wg, UA_PUBSUBSTATE_ERROR);
-        UA_PubSubConnection_setPubSubState(server, connection, UA_PUBSUBSTATE_ERROR);
-        return;
+        return res;
     }
 
     /* Sending successful - increase the sequence number */
     wg->sequenceNumber++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* A congested transport (full MQTT QoS window, full tx ring) drops the
+ * NetworkMessage and returns BadResourceUnavailable. Publishing continues with
+ * the next cycle. All other send errors are fatal. */
+static UA_Boolean
+isFatalSendError(UA_StatusCode res) {
+    return (res != UA_STATUSCODE_GOOD &&
+            res != UA_STATUSCODE_BADRESOURCEUNAVAILABLE);
+}
+
+/* Failure, set the WriterGroup into an error mode */
+static void
+setSendErrorState(UA_Server *server, UA_WriterGroup *wg,
+                  UA_PubSubConnection *connection) {
+    UA_WriterGroup_setPubSubState(server, wg, UA_PUBSUBSTATE_ERROR);
+    UA_PubSubConnection_setPubSubState(server, connection, UA_PUBSUBSTATE_ERROR);
+}
+
+static UA_StatusCode
+sendNetworkMessageBuffer(UA_Server *server, UA_WriterGroup *wg, 
+                         UA_PubSubConnection *connection, uintptr_t connectionId,
+                         const UA_KeyValueMap *params, UA_ByteString *buffer) {
+    UA_StatusCode res =
+        sendNetworkMessageBufferRT(server, wg, connection, connectionId, params, buffer);
+    if(isFatalSendError(res))
+        setSendErrorState(server, wg, connection);
+    return res;
 }
 
 #ifdef UA_ENABLE_JSON_ENCODING
@@ -1009,6 +1286,7 @@ sendNetworkMessageJson(UA_Server *server, UA_PubSubConnection *connection, UA_Wr
     UA_CHECK_STATUS(res, return res);
 
     /* Encode the message */
+    UA_DateTime start = timingNow(server, wg);
     UA_Byte *bufPos = buf.data;
     const UA_Byte *bufEnd = &buf.data[msgSize];
     res = UA_NetworkMessage_encodeJson(&nm, &bufPos, &bufEnd, NULL, 0, NULL, 0, true);
@@ -1016,10 +1294,12 @@ sendNetworkMessageJson(UA_Server *server, UA_PubSubConnection *connection, UA_Wr
         cm->freeNetworkBuffer(cm, sendChannel, &buf);
         return res;
     }
+    recordDuration(server, wg, &wg->timing.encodeDuration, &start);
     UA_assert(bufPos == bufEnd);
 
     /* Send the prepared messages */
-    sendNetworkMessageBuffer(server, wg, connection, sendChannel, &buf);
+    sendNetworkMessageBuffer(server, wg, connection, sendChannel,
+                             &UA_KEYVALUEMAP_NULL, &buf);
     return UA_STATUSCODE_GOOD;
 }
 #endif
@@ -1079,17 +1359,9 @@ generateNetworkMessage(UA_PubSubConnection *connection, UA_WriterGroup *wg,
             networkMessage->securityHeader.networkMessageEncrypted = true;
         networkMessage->securityHeader.securityTokenId = wg->securityTokenId;
 
-        /* Generate the MessageNonce. Four random bytes followed by a four-byte
-         * sequence number */
-        UA_ByteString nonce = {4, networkMessage->securityHeader.messageNonce};
-        UA_StatusCode rv = wg->config.securityPolicy->symmetricModule.
-            generateNonce(wg->config.securityPolicy->policyContext, &nonce);
+        UA_StatusCode rv = generateMessageNonce(wg, networkMessage);
         if(rv != UA_STATUSCODE_GOOD)
             return rv;
-        UA_Byte *pos = &networkMessage->securityHeader.messageNonce[4];
-        const UA_Byte *end = &networkMessage->securityHeader.messageNonce[8];
-        UA_UInt32_encodeBinary(&wg->nonceSequenceNumber, &pos, end);
-        networkMessage->securityHeader.messageNonceSize = 8;
     }
 #endif
 
@@ -1168,7 +1440,7 @@ sendNetworkMessageBinary(UA_Server *server, UA_PubSubConnection *connection, UA_
     UA_CHECK_STATUS(rv, return rv);
 
     /* Encode and encrypt the message */
-    rv = encodeNetworkMessage(wg, &nm, &buf);
+    rv = encodeNetworkMessage(server, wg, &nm, &buf);
     if(rv != UA_STATUSCODE_GOOD) {
         cm->freeNetworkBuffer(cm, sendChannel, &buf);
         UA_free(nm.payload.dataSetPayload.sizes);
@@ -1176,57 +1448,105 @@ sendNetworkMessageBinary(UA_Server *server, UA_PubSubConnection *connection, UA_
     }
 
     /* Send out the message */
-    sendNetworkMessageBuffer(server, wg, connection, sendChannel, &buf);
+    sendNetworkMessageBuffer(server, wg, connection, sendChannel,
+                             &UA_KEYVALUEMAP_NULL, &buf);
 
     UA_free(nm.payload.dataSetPayload.sizes);
     return UA_STATUSCODE_GOOD;
 }
 
+static const UA_QualifiedName keepBufferParam = {0, UA_STRING_STATIC("keep-buffer")};
+
+/* Allocate the network buffers for zero-copy publishing on the send channel.
+ * The message template is copied into them once. Afterwards only the fields
+ * at the offsets are patched in every cycle. */
 static void
-publishRT(UA_Server *server, UA_WriterGroup *writerGroup, UA_PubSubConnection *connection) {
-    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+prepareRTSendBuffers(UA_Server *server, UA_WriterGroup *wg,
+                     UA_ConnectionManager *cm, uintptr_t sendChannel) {
+    releaseRTSendBuffers(wg);
+    wg->rtSendChannel = sendChannel;
+    const UA_ByteString *tmpl = &wg->bufferedMessage.buffer;
+    for(size_t i = 0; i < UA_PUBSUB_RT_SENDBUFFERS; i++) {
+        UA_ByteString *buf = &wg->rtSendBuffers[i];
+        UA_StatusCode res = cm->allocNetworkBuffer(cm, sendChannel, buf, tmpl->length);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_ByteString_init(buf);
+            goto disable;
+        }
+        /* The ConnectionManager hands out a static buffer */
+        for(size_t j = 0; j < i; j++) {
+            if(wg->rtSendBuffers[j].data == buf->data)
+                goto disable;
+        }
+        memcpy(buf->data, tmpl->data, tmpl->length);
+    }
+    return;
 
-    UA_StatusCode res =
-        UA_NetworkMessage_updateBufferedMessage(&writerGroup->bufferedMessage);
+ disable:
+    UA_LOG_INFO_WRITERGROUP(server->config.logging, wg,
+                            "The ConnectionManager cannot provide dedicated "
+                            "send buffers. Publish without zero-copy.");
+    releaseRTSendBuffers(wg);
+    wg->rtZeroCopyDisabled = true;
+}
 
+/* Patch the fields directly in a network buffer of the ConnectionManager and
+ * send without copying. The buffer is kept for a later cycle. Returns false if
+ * zero-copy is not possible and the message has to be sent from the template
+ * buffer. The status code of sending is returned in sendRes. */
+static UA_Boolean
+publishRTZeroCopy(UA_Server *server, UA_WriterGroup *wg,
+                  UA_PubSubConnection *connection, uintptr_t sendChannel,
+                  UA_StatusCode *sendRes) {
+    UA_ConnectionManager *cm = connection->cm;
+    if(wg->rtSendChannel != sendChannel) {
+        prepareRTSendBuffers(server, wg, cm, sendChannel);
+        if(wg->rtZeroCopyDisabled)
+            return false;
+    }
+
+    /* The offsets are relative to the buffer start. Temporarily swap the
+     * network buffer into the offset buffer for the update. */
+    UA_ByteString *buf = &wg->rtSendBuffers[wg->rtSendBufferIndex];
+    wg->rtSendBufferIndex = (wg->rtSendBufferIndex + 1) % UA_PUBSUB_RT_SENDBUFFERS;
+    UA_DateTime start = timingNow(server, wg);
+    UA_ByteString tmpl = wg->bufferedMessage.buffer;
+    wg->bufferedMessage.buffer = *buf;
+    UA_StatusCode res = UA_NetworkMessage_updateBufferedMessage(&wg->bufferedMessage);
+    wg->bufferedMessage.buffer = tmpl;
+    recordDuration(server, wg, &wg->timing.encodeDuration, &start);
     if(res != UA_STATUSCODE_GOOD) {
-        UA_LOG_DEBUG_WRITERGROUP(server->config.logging, writerGroup,
+        UA_LOG_DEBUG_WRITERGROUP(server->config.logging, wg,
                                  "PubSub sending. Unknown field type.");
-        return;
+        return true;
     }
 
-    UA_ByteString *buf = &writerGroup->bufferedMessage.buffer;
-
-#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
-    /* Send the encrypted buffered message if PubSub encryption is enabled */
-    if(writerGroup->config.securityMode > UA_MESSAGESECURITYMODE_NONE) {
-        size_t sigSize = writerGroup->config.securityPolicy->symmetricModule.cryptoModule.
-            signatureAlgorithm.getLocalSignatureSize(writerGroup->securityPolicyContext);
+    UA_Boolean keepBuffer = true;
+    UA_KeyValuePair kvp;
+    kvp.key = keepBufferParam;
+    UA_Variant_setScalar(&kvp.value, &keepBuffer, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    UA_KeyValueMap params = {1, &kvp};
+    res = sendNetworkMessageBufferRT(server, wg, connection, sendChannel, &params, buf);
+    *sendRes = res;
 
-        UA_Byte payloadOffset = (UA_Byte)(writerGroup->bufferedMessage.payloadPosition -
-                                          writerGroup->bufferedMessage.buffer.data);
-        memcpy(writerGroup->bufferedMessage.encryptBuffer.data,
-               writerGroup->bufferedMessage.buffer.data,
-               writerGroup->bufferedMessage.buffer.length);
-        res = encryptAndSign(writerGroup, writerGroup->bufferedMessage.nm,
-                             writerGroup->bufferedMessage.encryptBuffer.data,
-                             writerGroup->bufferedMessage.encryptBuffer.data + payloadOffset,
-                             writerGroup->bufferedMessage.encryptBuffer.data +
-                                 writerGroup->bufferedMessage.encryptBuffer.length - sigSize);
-
-        if(res != UA_STATUSCODE_GOOD) {
-            UA_LOG_ERROR_WRITERGROUP(server->config.logging, writerGroup,
-                                     "PubSub Encryption failed");
-            return;
-        }
-
-        buf = &writerGroup->bufferedMessage.encryptBuffer;
+    /* The buffer was released. Allocate new buffers after a send error.
+     * Otherwise the ConnectionManager does not support keeping the buffer. */
+    if(!buf->data) {
+        releaseRTSendBuffers(wg);
+        if(res == UA_STATUSCODE_GOOD)
+            wg->rtZeroCopyDisabled = true;
     }
-#endif
+    return true;
+}
 
+/* Publish the fixed-size message. This is also done without the server lock
+ * for frozen WriterGroups with the rtThread option. So the PubSubState is not
+ * changed here. Returns the status code of sending the message. */
+static UA_StatusCode
+publishRT(UA_Server *server, UA_WriterGroup *writerGroup, UA_PubSubConnection *connection) {
     UA_ConnectionManager *cm = connection->cm;
     if(!cm)
-        return;
+        return UA_STATUSCODE_GOOD;
 
     /* Select the wg sendchannel if configured */
     uintptr_t sendChannel = connection->sendChannel;
@@ -1235,19 +1555,91 @@ publishRT(UA_Server *server, UA_WriterGroup *writerGroup, UA_PubSubConnection *c
     if(sendChannel == 0) {
         UA_LOG_ERROR_WRITERGROUP(server->config.logging, writerGroup,
                                  "Cannot send, no open connection");
-        return;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Take the latest snapshots of the value buffers. The bufferedMessage
+     * points to the snapshots. */
+    for(size_t i = 0; i < writerGroup->rtValueBuffersSize; i++)
+        UA_PubSubValueBuffer_sync(writerGroup->rtValueBuffers[i]);
+
+    /* Send without copying if the message is not encrypted. Encrypted messages
+     * are copied to keep the template in plaintext. */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(!writerGroup->rtZeroCopyDisabled
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+       && writerGroup->config.securityMode <= UA_MESSAGESECURITYMODE_NONE
+#endif
+       ) {
+        if(publishRTZeroCopy(server, writerGroup, connection, sendChannel, &res))
+            return res;
+    }
+
+    UA_DateTime start = timingNow(server, writerGroup);
+    res = UA_NetworkMessage_updateBufferedMessage(&writerGroup->bufferedMessage);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_LOG_DEBUG_WRITERGROUP(server->config.logging, writerGroup,
+                                 "PubSub sending. Unknown field type.");
+        return UA_STATUSCODE_GOOD;
     }
 
     /* Copy into the network buffer */
+    UA_ByteString *buf = &writerGroup->bufferedMessage.buffer;
     UA_ByteString outBuf;
     res = cm->allocNetworkBuffer(cm, sendChannel, &outBuf, buf->length);
     if(res != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR_WRITERGROUP(server->config.logging, writerGroup,
                                  "PubSub message memory allocation failed");
-        return;
+        return UA_STATUSCODE_GOOD;
     }
     memcpy(outBuf.data, buf->data, buf->length);
-    sendNetworkMessageBuffer(server, writerGroup, connection, sendChannel, &outBuf);
+    recordDuration(server, writerGroup, &writerGroup->timing.encodeDuration, &start);
+
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+    /* Encrypt and sign in place in the network buffer. The template buffer
+     * stays in plaintext for the next cycle. */
+    if(writerGroup->config.securityMode > UA_MESSAGESECURITYMODE_NONE) {
+        UA_NetworkMessage *nm = writerGroup->bufferedMessage.nm;
+        size_t sigSize = writerGroup->config.securityPolicy->symmetricModule.cryptoModule.
+            signatureAlgorithm.getLocalSignatureSize(writerGroup->securityPolicyContext);
+        size_t payloadOffset = (uintptr_t)writerGroup->bufferedMessage.payloadPosition -
+            (uintptr_t)buf->data;
+
+        /* Use a fresh MessageNonce for every message. The nonce is encoded
+         * right before the payload (and the optional SecurityFooterSize). */
+        res = generateMessageNonce(writerGroup, nm);
+        if(res == UA_STATUSCODE_GOOD) {
+            size_t nonceOffset = payloadOffset - nm->securityHeader.messageNonceSize;
+            if(nm->securityHeader.securityFooterEnabled)
+                nonceOffset -= 2;
+            memcpy(&outBuf.data[nonceOffset], nm->securityHeader.messageNonce,
+                   nm->securityHeader.messageNonceSize);
+            res = encryptAndSign(writerGroup, nm, outBuf.data,
+                                 outBuf.data + payloadOffset,
+                                 outBuf.data + buf->length - sigSize);
+        }
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_LOG_ERROR_WRITERGROUP(server->config.logging, writerGroup,
+                                     "PubSub Encryption failed");
+            cm->freeNetworkBuffer(cm, sendChannel, &outBuf);
+            return UA_STATUSCODE_GOOD;
+        }
+        recordDuration(server, writerGroup, &writerGroup->timing.encryptDuration, &start);
+    }
+#endif
+
+    return sendNetworkMessageBufferRT(server, writerGroup, connection, sendChannel,
+                                      &UA_KEYVALUEMAP_NULL, &outBuf);
+}
+
+/* Can the WriterGroup be published without the server lock? */
+static UA_Boolean
+canPublishRT(UA_WriterGroup *wg) {
+    return (wg->config.rtThread && wg->configurationFrozen &&
+            wg->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE &&
+            wg->config.securityMode <= UA_MESSAGESECURITYMODE_NONE &&
+            wg->state == UA_PUBSUBSTATE_OPERATIONAL &&
+            wg->writersCount > 0 && wg->linkedConnection);
 }
 
 static void
@@ -1284,9 +1676,21 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
     UA_assert(writerGroup != NULL);
     UA_assert(server != NULL);
 
+    /* Frozen RT WriterGroup in a dedicated thread. Publish without the lock.
+     * After a send error, the next cycle takes the lock to set the error
+     * state. */
+    if(UA_PubSubRTLock_enter(&writerGroup->rtLock)) {
+        recordPublishJitter(server, writerGroup);
+        UA_StatusCode res =
+            publishRT(server, writerGroup, writerGroup->linkedConnection);
+        UA_PubSubRTLock_leave(&writerGroup->rtLock, !isFatalSendError(res));
+        return;
+    }
+
     UA_LOCK(&server->serviceMutex);
 
     UA_LOG_DEBUG_WRITERGROUP(server->config.logging, writerGroup, "Publish Callback");
+    recordPublishJitter(server, writerGroup);
 
     /* Nothing to do? */
     if(writerGroup->writersCount == 0) {
@@ -1306,7 +1710,11 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
 
     /* Realtime path - update the buffer message and send directly */
     if(writerGroup->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
-        publishRT(server, writerGroup, connection);
+        UA_StatusCode res = publishRT(server, writerGroup, connection);
+        if(isFatalSendError(res))
+            setSendErrorState(server, writerGroup, connection);
+        else if(canPublishRT(writerGroup))
+            UA_PubSubRTLock_enable(&writerGroup->rtLock);
         UA_UNLOCK(&server->serviceMutex);
         return;
     }
@@ -1334,8 +1742,7 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
 
         /* Heartbeats are send when no dataset is attached */
         UA_Boolean heartbeat = UA_NodeId_isNull(&dsw->connectedDataSet);
-        UA_PublishedDataSet *pds = (heartbeat) ? NULL :
-            UA_PublishedDataSet_findPDSbyId(server, dsw->connectedDataSet);
+        UA_PublishedDataSet *pds = dsw->connectedPDS;
         if(!heartbeat && !pds) {
             UA_LOG_ERROR_WRITER(server->config.logging, dsw,
                                 "PubSub Publish: PublishedDataSet not found");
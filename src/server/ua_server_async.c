@@ -168,6 +168,40 @@ checkTimeouts(UA_Server *server, void *_) {
     UA_UNLOCK(&server->serviceMutex);
 }
 
+/* Clean up the job of a closed channel. The channel memory was kept alive
+ * while the job was running. */
+static void
+deleteOrphanedCryptoJob(UA_SecureChannelCryptoJob *job) {
+    UA_SecureChannel *channel = job->channel;
+    channel->cryptoJob = NULL;
+    UA_SecureChannelCryptoJob_delete(job);
+    UA_SecureChannel_clear(channel);
+    UA_free(channel); /* The channel is the first member of the list entry */
+}
+
+/* Integrate the finished crypto jobs in the EventLoop thread. The queueLock is
+ * released while a job is finished, as this continues the processing of the
+ * SecureChannel (which can enqueue the next job). */
+static void
+processCryptoResults(void *application, void *context) {
+    UA_Server *server = (UA_Server*)application;
+    UA_AsyncManager *am = &server->asyncManager;
+    UA_SecureChannelCryptoJob *job;
+    UA_LOCK(&am->queueLock);
+    am->cryptoCallbackScheduled = false;
+    while((job = TAILQ_FIRST(&am->cryptoResults))) {
+        TAILQ_REMOVE(&am->cryptoResults, job, pointers);
+        am->cryptoJobsCount--;
+        UA_UNLOCK(&am->queueLock);
+        if(job->orphaned)
+            deleteOrphanedCryptoJob(job);
+        else
+            finishServerCryptoJob(server, job->channel);
+        UA_LOCK(&am->queueLock);
+    }
+    UA_UNLOCK(&am->queueLock);
+}
+
 void
 UA_AsyncManager_init(UA_AsyncManager *am, UA_Server *server) {
     memset(am, 0, sizeof(UA_AsyncManager));
@@ -175,6 +209,10 @@ UA_AsyncManager_init(UA_AsyncManager *am, UA_Server *server) {
     TAILQ_INIT(&am->newQueue);
     TAILQ_INIT(&am->dispatchedQueue);
     TAILQ_INIT(&am->resultQueue);
+    TAILQ_INIT(&am->cryptoQueue);
+    TAILQ_INIT(&am->cryptoResults);
+    am->cryptoCallback.callback = processCryptoResults;
+    am->cryptoCallback.application = server;
     UA_LOCK_INIT(&am->queueLock);
 }
 
@@ -209,6 +247,29 @@ UA_AsyncManager_clear(UA_AsyncManager *am, UA_Server *server) {
         TAILQ_REMOVE(&am->resultQueue, ar, pointers);
         UA_AsyncOperation_delete(ar);
     }
+
+    /* Clean up crypto jobs. The workers must be stopped at this point. */
+    UA_SecureChannelCryptoJob *job, *job_tmp;
+    TAILQ_FOREACH_SAFE(job, &am->cryptoQueue, pointers, job_tmp) {
+        TAILQ_REMOVE(&am->cryptoQueue, job, pointers);
+        job->channel->cryptoJob = NULL;
+        UA_SecureChannelCryptoJob_delete(job);
+    }
+    TAILQ_FOREACH_SAFE(job, &am->cryptoResults, pointers, job_tmp) {
+        TAILQ_REMOVE(&am->cryptoResults, job, pointers);
+        if(job->orphaned) {
+            deleteOrphanedCryptoJob(job);
+        } else {
+            job->channel->cryptoJob = NULL;
+            UA_SecureChannelCryptoJob_delete(job);
+        }
+    }
+    am->cryptoJobsCount = 0;
+    if(am->cryptoCallbackScheduled) {
+        UA_EventLoop *el = server->config.eventLoop;
+        el->removeDelayedCallback(el, &am->cryptoCallback);
+        am->cryptoCallbackScheduled = false;
+    }
     UA_UNLOCK(&am->queueLock);
 
     /* Remove responses */
@@ -385,6 +446,92 @@ UA_Server_setAsyncOperationResult(UA_Server *server,
                  "Set the result from the worker thread");
 }
 
+/****************************/
+/* SecureChannel Crypto Jobs */
+/****************************/
+
+UA_StatusCode
+UA_AsyncManager_addCryptoJob(UA_AsyncManager *am, UA_Server *server,
+                             UA_SecureChannelCryptoJob *job) {
+    if(!server->config.asyncSecureChannelCrypto)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    UA_LOCK(&am->queueLock);
+    if(server->config.maxAsyncOperationQueueSize != 0 &&
+       am->cryptoJobsCount >= server->config.maxAsyncOperationQueueSize) {
+        UA_UNLOCK(&am->queueLock);
+        return UA_STATUSCODE_BADTOOMANYOPERATIONS;
+    }
+    job->state = UA_SECURECHANNELCRYPTOJOBSTATE_QUEUED;
+    job->orphaned = false;
+    TAILQ_INSERT_TAIL(&am->cryptoQueue, job, pointers);
+    am->cryptoJobsCount++;
+    UA_UNLOCK(&am->queueLock);
+
+    if(server->config.asyncOperationNotifyCallback)
+        server->config.asyncOperationNotifyCallback(server);
+
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_Boolean
+UA_AsyncManager_cancelCryptoJob(UA_AsyncManager *am, UA_SecureChannel *channel) {
+    UA_SecureChannelCryptoJob *job = channel->cryptoJob;
+    if(!job)
+        return false;
+
+    UA_LOCK(&am->queueLock);
+    if(job->state == UA_SECURECHANNELCRYPTOJOBSTATE_RUNNING) {
+        job->orphaned = true;
+        UA_UNLOCK(&am->queueLock);
+        return true;
+    }
+    if(job->state == UA_SECURECHANNELCRYPTOJOBSTATE_QUEUED)
+        TAILQ_REMOVE(&am->cryptoQueue, job, pointers);
+    else
+        TAILQ_REMOVE(&am->cryptoResults, job, pointers);
+    am->cryptoJobsCount--;
+    UA_UNLOCK(&am->queueLock);
+
+    channel->cryptoJob = NULL;
+    UA_SecureChannelCryptoJob_delete(job);
+    return false;
+}
+
+UA_Boolean
+UA_Server_runAsyncCryptoJob(UA_Server *server) {
+    UA_AsyncManager *am = &server->asyncManager;
+
+    /* Take the next job */
+    UA_LOCK(&am->queueLock);
+    UA_SecureChannelCryptoJob *job = TAILQ_FIRST(&am->cryptoQueue);
+    if(!job) {
+        UA_UNLOCK(&am->queueLock);
+        return false;
+    }
+    TAILQ_REMOVE(&am->cryptoQueue, job, pointers);
+    job->state = UA_SECURECHANNELCRYPTOJOBSTATE_RUNNING;
+    UA_UNLOCK(&am->queueLock);
+
+    /* Run outside of the lock */
+    UA_SecureChannelCryptoJob_run(job);
+
+    /* Move to the results. Schedule the integration in the EventLoop if that
+     * is not already pending. */
+    UA_LOCK(&am->queueLock);
+    job->state = UA_SECURECHANNELCRYPTOJOBSTATE_DONE;
+    TAILQ_INSERT_TAIL(&am->cryptoResults, job, pointers);
+    UA_Boolean schedule = !am->cryptoCallbackScheduled;
+    am->cryptoCallbackScheduled = true;
+    UA_UNLOCK(&am->queueLock);
+
+    if(schedule) {
+        UA_EventLoop *el = server->config.eventLoop;
+        el->addDelayedCallback(el, &am->cryptoCallback);
+    }
+    return true;
+}
+
 /******************/
 /* Server Methods */
 /******************/
@@ -17,6 +17,7 @@
 #include <open62541/server.h>
 
 #include "open62541_queue.h"
+#include "ua_securechannel.h"
 #include "util/ua_util_internal.h"
 
 _UA_BEGIN_DECLS
@@ -73,6 +74,15 @@ typedef struct {
     UA_AsyncOperationQueue resultQueue;     /* Results to be integrated */
     size_t opsCount; /* How many operations are transient (in one of the three queues)? */
 
+    /* Offloaded asymmetric cryptography of the SecureChannel handshake. Also
+     * protected by the queueLock. The results are integrated in a delayed
+     * callback of the EventLoop. */
+    TAILQ_HEAD(, UA_SecureChannelCryptoJob) cryptoQueue;   /* New jobs */
+    TAILQ_HEAD(, UA_SecureChannelCryptoJob) cryptoResults; /* Finished jobs */
+    size_t cryptoJobsCount; /* Queued and running jobs */
+    UA_DelayedCallback cryptoCallback;
+    UA_Boolean cryptoCallbackScheduled;
+
     UA_UInt64 checkTimeoutCallbackId; /* Registered repeated callbacks */
 } UA_AsyncManager;
 
@@ -104,6 +114,18 @@ UA_AsyncManager_createAsyncOp(UA_AsyncManager *am, UA_Server *server,
 UA_UInt32
 UA_AsyncManager_cancel(UA_Server *server, UA_Session *session, UA_UInt32 requestHandle);
 
+/* Enqueue a crypto job for the workers. Returns an error if offloading is not
+ * enabled or the queue is full. Then the job is run in-line. */
+UA_StatusCode
+UA_AsyncManager_addCryptoJob(UA_AsyncManager *am, UA_Server *server,
+                             UA_SecureChannelCryptoJob *job);
+
+/* Cancel the pending crypto job of the channel. Returns true if the job is
+ * currently running in a worker. Then the channel is orphaned and must not be
+ * cleaned up. It is freed when the worker returns. */
+UA_Boolean
+UA_AsyncManager_cancelCryptoJob(UA_AsyncManager *am, UA_SecureChannel *channel);
+
 typedef void (*UA_AsyncServiceOperation)(UA_Server *server, UA_Session *session,
                                          UA_UInt32 requestId, UA_UInt32 requestHandle,
                                          size_t opIndex, const void *requestOperation,
@@ -143,14 +143,23 @@ static void
 deleteServerSecureChannel(UA_BinaryProtocolManager *bpm,
                           UA_SecureChannel *channel) {
     /* Clean up the SecureChannel. This is the only place where
-     * UA_SecureChannel_clear must be called within the server code-base.
+     * UA_SecureChannel_clear must be called within the server code-base
+     * (except for channels orphaned by a running crypto job).
      *
      * First detach all Sessions from the SecureChannel. This also removes
      * outstanding Publish requests whose RequestId is valid only for the
      * SecureChannel. */
     while(channel->sessions)
         UA_Session_detachFromSecureChannel(channel->sessions);
-    UA_SecureChannel_clear(channel);
+
+    /* Cancel an offloaded crypto job. If the job is currently running in a
+     * worker, the channel is cleaned up and freed when the job returns. */
+    UA_Boolean orphaned = false;
+#if UA_MULTITHREADING >= 100
+    orphaned = UA_AsyncManager_cancelCryptoJob(&bpm->server->asyncManager, channel);
+#endif
+    if(!orphaned)
+        UA_SecureChannel_clear(channel);
 
     /* Detach the channel from the server list */
     TAILQ_REMOVE(&bpm->channels, (channel_entry*)channel, pointers);
@@ -184,7 +193,8 @@ deleteServerSecureChannel(UA_BinaryProtocolManager *bpm,
         break;
     }
 
-    UA_free(channel);
+    if(!orphaned)
+        UA_free(channel);
 }
 
 UA_StatusCode
@@ -341,6 +351,12 @@ processOPN(UA_Server *server, UA_SecureChannel *channel,
     }
     UA_NodeId_clear(&requestType);
 
+    /* Only a new SecureChannel can offload the signing and encryption of the
+     * response. A renewed SecureChannel keeps sending in-line to preserve the
+     * order of the messages. */
+    UA_Boolean issue = (openSecureChannelRequest.requestType ==
+                        UA_SECURITYTOKENREQUESTTYPE_ISSUE);
+
     /* Call the service */
     UA_OpenSecureChannelResponse openScResponse;
     UA_OpenSecureChannelResponse_init(&openScResponse);
@@ -355,8 +371,13 @@ processOPN(UA_Server *server, UA_SecureChannel *channel,
     }
 
     /* Send the response */
-    retval = UA_SecureChannel_sendAsymmetricOPNMessage(channel, requestId, &openScResponse,
-                                                       &UA_TYPES[UA_TYPES_OPENSECURECHANNELRESPONSE]);
+    const UA_DataType *responseType = &UA_TYPES[UA_TYPES_OPENSECURECHANNELRESPONSE];
+    if(issue)
+        retval = UA_SecureChannel_sendAsymmetricOPNMessageAsync(channel, server, requestId,
+                                                                &openScResponse, responseType);
+    else
+        retval = UA_SecureChannel_sendAsymmetricOPNMessage(channel, requestId,
+                                                           &openScResponse, responseType);
     UA_OpenSecureChannelResponse_clear(&openScResponse);
     if(retval != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING_CHANNEL(server->config.logging, channel,
@@ -581,6 +602,51 @@ processSecureChannelMessage(void *application, UA_SecureChannel *channel,
     return retval;
 }
 
+#if UA_MULTITHREADING >= 100
+
+static UA_StatusCode
+offloadServerCrypto(void *application, UA_SecureChannel *channel,
+                    UA_SecureChannelCryptoJob *job) {
+    /* Only the handshake of new SecureChannels is offloaded. A renewal is
+     * processed in-line to keep the message order of the open channel. */
+    if(job->type == UA_SECURECHANNELCRYPTOJOB_DECRYPTOPN &&
+       channel->state != UA_SECURECHANNELSTATE_ACK_SENT)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    /* Nothing to offload for the None SecurityPolicy */
+    if(!channel->securityPolicy ||
+       UA_String_equal(&UA_SECURITY_POLICY_NONE_URI,
+                       &channel->securityPolicy->policyUri))
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    UA_Server *server = (UA_Server*)application;
+    return UA_AsyncManager_addCryptoJob(&server->asyncManager, server, job);
+}
+
+void
+finishServerCryptoJob(UA_Server *server, UA_SecureChannel *channel) {
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_DateTime nowMonotonic = el->dateTime_nowMonotonic(el);
+    UA_StatusCode retval =
+        UA_SecureChannel_finishCryptoJob(channel, server,
+                                         processSecureChannelMessage,
+                                         nowMonotonic);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING_CHANNEL(server->config.logging, channel,
+                               "Processing the message failed with error %s",
+                               UA_StatusCode_name(retval));
+
+        /* Send an ERR message and close the connection */
+        UA_TcpErrorMessage error;
+        error.error = retval;
+        error.reason = UA_STRING_NULL;
+        UA_SecureChannel_sendError(channel, &error);
+        UA_SecureChannel_shutdown(channel, UA_SHUTDOWNREASON_ABORT);
+    }
+}
+
+#endif
+
 /* remove the first channel that has no session attached */
 static UA_Boolean
 purgeFirstChannelWithoutSession(UA_BinaryProtocolManager *bpm) {
@@ -672,6 +738,7 @@ createServerSecureChannel(UA_BinaryProtocolManager *bpm, UA_ConnectionManager *c
     entry->channel.config = connConfig;
     entry->channel.certificateVerification = &config->secureChannelPKI;
     entry->channel.processOPNHeader = configServerSecureChannel;
+    entry->channel.serverSide = true;
     entry->channel.connectionManager = cm;
     entry->channel.connectionId = connectionId;
 
@@ -787,6 +854,13 @@ serverNetworkCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
 
         UA_LOG_INFO_CHANNEL(bpm->logging, channel, "SecureChannel created");
 
+#if UA_MULTITHREADING >= 100
+        /* The handshake can be offloaded to worker threads. Not done for
+         * reverse connections, whose state is tracked after every received
+         * buffer. */
+        channel->offloadCrypto = offloadServerCrypto;
+#endif
+
         /* Set the new channel as the new context for the connection */
         *connectionContext = (void*)channel;
         return;
@@ -366,6 +366,13 @@ UA_StatusCode
 sendResponse(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 requestId,
              UA_Response *response, const UA_DataType *responseType);
 
+#if UA_MULTITHREADING >= 100
+/* Continue processing the SecureChannel after its offloaded crypto job has
+ * returned. Called from the EventLoop thread. */
+void
+finishServerCryptoJob(UA_Server *server, UA_SecureChannel *channel);
+#endif
+
 /* Many services come as an array of operations. This function generalizes the
  * processing of the operations. */
 typedef void (*UA_ServiceOperation)(UA_Server *server, UA_Session *session,
@@ -291,7 +291,8 @@ getDefaultEncryptedSecurityPolicy(UA_Server *server) {
     }
     for(size_t i = server->config.securityPoliciesSize; i > 0; i--) {
         UA_SecurityPolicy *sp = &server->config.securityPolicies[i-1];
-        if(!UA_String_equal(&UA_SECURITY_POLICY_NONE_URI, &sp->policyUri))
+        if(!UA_String_equal(&UA_SECURITY_POLICY_NONE_URI, &sp->policyUri) &&
+           sp->asymmetricModule.cryptoModule.encryptionAlgorithm.encrypt)
             return sp;
     }
     UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_CLIENT,
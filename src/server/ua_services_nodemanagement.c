@@ -1954,6 +1954,14 @@ deleteNodeSet(UA_Server *server, UA_Session *session,
         UA_NODESTORE_RELEASE(server, member);
         if(removeTargetRefs)
             removeIncomingReferences(server, session, &member->head);
+#ifdef UA_ENABLE_PUBSUB
+        /* DataSetReaders can hold a pointer to the node */
+        if(server->pubSubManager.boundTargetsSize > 0)
+            UA_DataSetReader_releaseTargetNode(server, &member->head.nodeId);
+        /* DataSetFields can hold a pointer to their source node */
+        if(server->pubSubManager.boundSourcesSize > 0)
+            UA_PublishedDataSet_releaseSourceNode(server, &member->head.nodeId);
+#endif
         UA_NODESTORE_REMOVE(server, &member->head.nodeId);
     }
 }
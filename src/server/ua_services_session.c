@@ -560,6 +560,10 @@ decryptUserNamePW(UA_Server *server, UA_Session *session,
         return UA_STATUSCODE_GOOD;
     }
 
+    /* The SecurityPolicy cannot decrypt with the certificate keys (ECC) */
+    if(!sp->asymmetricModule.cryptoModule.encryptionAlgorithm.decrypt)
+        return UA_STATUSCODE_BADIDENTITYTOKENINVALID;
+
     /* Test if the correct encryption algorithm is used */
     if(!UA_String_equal(&userToken->encryptionAlgorithm,
                         &sp->asymmetricModule.cryptoModule.encryptionAlgorithm.uri))
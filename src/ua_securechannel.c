@@ -136,6 +136,67 @@ deleteChunks(UA_ChunkQueue *queue) {
     }
 }
 
+/* Copy the chunk bytes if they still point into the network buffer */
+static UA_StatusCode
+persistChunk(UA_Chunk *chunk) {
+    if(chunk->copied)
+        return UA_STATUSCODE_GOOD;
+    UA_ByteString copy;
+    UA_StatusCode res = UA_ByteString_copy(&chunk->bytes, &copy);
+    UA_CHECK_STATUS(res, return res);
+    chunk->bytes = copy;
+    chunk->copied = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Use only the payload after the offset. If the chunk has its own memory, the
+ * payload is moved to the front so that the memory can be freed later on. */
+static void
+hideChunkHeader(UA_Chunk *chunk, size_t offset) {
+    chunk->bytes.length -= offset;
+    if(chunk->copied)
+        memmove(chunk->bytes.data, &chunk->bytes.data[offset], chunk->bytes.length);
+    else
+        chunk->bytes.data += offset;
+}
+
+void
+UA_SecureChannelCryptoJob_delete(UA_SecureChannelCryptoJob *job) {
+    if(job->chunk)
+        UA_Chunk_delete(job->chunk);
+    UA_ByteString_clear(&job->buf);
+    UA_free(job);
+}
+
+void
+UA_SecureChannelCryptoJob_run(UA_SecureChannelCryptoJob *job) {
+    UA_SecureChannel *channel = job->channel;
+    if(job->type == UA_SECURECHANNELCRYPTOJOB_DECRYPTOPN) {
+        job->result = decryptAndVerifyChunk(channel, &channel->securityPolicy->
+                                            asymmetricModule.cryptoModule,
+                                            job->chunk->messageType,
+                                            &job->chunk->bytes, job->offset);
+    } else {
+        job->result = signAndEncryptAsym(channel, job->preSigLength, &job->buf,
+                                         job->securityHeaderLength,
+                                         job->totalLength);
+    }
+}
+
+/* Hand the job to the offloadCrypto callback. Returns UA_STATUSCODE_GOOD if the
+ * job is now pending. */
+static UA_StatusCode
+offloadCryptoJob(UA_SecureChannel *channel, void *application,
+                 UA_SecureChannelCryptoJob *job) {
+    UA_assert(channel->offloadCrypto);
+    UA_assert(channel->cryptoJob == NULL);
+    channel->cryptoJob = job;
+    UA_StatusCode res = channel->offloadCrypto(application, channel, job);
+    if(res != UA_STATUSCODE_GOOD)
+        channel->cryptoJob = NULL;
+    return res;
+}
+
 void
 UA_SecureChannel_deleteBuffered(UA_SecureChannel *channel) {
     deleteChunks(&channel->completeChunks);
@@ -164,6 +225,9 @@ UA_SecureChannel_clear(UA_SecureChannel *channel) {
     /* No sessions must be attached to this any longer */
     UA_assert(channel->sessions == NULL);
 
+    /* No offloaded cryptography must be pending */
+    UA_assert(channel->cryptoJob == NULL);
+
     /* Delete the channel context for the security policy */
     if(channel->securityPolicy) {
         channel->securityPolicy->channelModule.deleteContext(channel->channelContext);
@@ -231,76 +295,148 @@ UA_SecureChannel_processHELACK(UA_SecureChannel *channel,
     return UA_STATUSCODE_GOOD;
 }
 
-/* Sends an OPN message using asymmetric encryption if defined */
-UA_StatusCode
-UA_SecureChannel_sendAsymmetricOPNMessage(UA_SecureChannel *channel,
-                                          UA_UInt32 requestId, const void *content,
-                                          const UA_DataType *contentType) {
-    UA_CHECK(channel->securityMode != UA_MESSAGESECURITYMODE_INVALID,
-             return UA_STATUSCODE_BADSECURITYMODEREJECTED);
-
-    /* Can we use the connection manager? */
-    UA_ConnectionManager *cm = channel->connectionManager;
-    if(!UA_SecureChannel_isConnected(channel))
-        return UA_STATUSCODE_BADCONNECTIONCLOSED;
-
+/* Encode the OPN message into the buffer of the job. The job is then ready for
+ * signing and encryption. */
+static UA_StatusCode
+encodeAsymmetricOPNMessage(UA_SecureChannel *channel, UA_UInt32 requestId,
+                           const void *content, const UA_DataType *contentType,
+                           UA_SecureChannelCryptoJob *job) {
     const UA_SecurityPolicy *sp = channel->securityPolicy;
     UA_CHECK_MEM(sp, return UA_STATUSCODE_BADINTERNALERROR);
 
-    /* Allocate the message buffer */
-    UA_ByteString buf = UA_BYTESTRING_NULL;
-    UA_StatusCode res = cm->allocNetworkBuffer(cm, channel->connectionId, &buf,
-                                               channel->config.sendBufferSize);
-    UA_CHECK_STATUS(res, return res);
-
     /* Restrict buffer to the available space for the payload */
-    UA_Byte *buf_pos = buf.data;
-    const UA_Byte *buf_end = &buf.data[buf.length];
+    UA_ByteString *buf = &job->buf;
+    UA_Byte *buf_pos = buf->data;
+    const UA_Byte *buf_end = &buf->data[buf->length];
     hideBytesAsym(channel, &buf_pos, &buf_end);
 
-    /* Define variables here to pacify some compilers wrt goto */
-    size_t securityHeaderLength, pre_sig_length, total_length, encryptedLength;
-
     /* Encode the message type and content */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
     res |= UA_NodeId_encodeBinary(&contentType->binaryEncodingId, &buf_pos, buf_end);
     res |= UA_encodeBinaryInternal(content, contentType, &buf_pos, &buf_end, NULL, NULL);
-    UA_CHECK_STATUS(res, goto error);
+    UA_CHECK_STATUS(res, return res);
 
     /* Compute the header length */
-    securityHeaderLength = calculateAsymAlgSecurityHeaderLength(channel);
+    job->securityHeaderLength = calculateAsymAlgSecurityHeaderLength(channel);
 
     /* Add padding to the chunk. Also pad if the securityMode is SIGN_ONLY,
      * since we are using asymmetric communication to exchange keys and thus
      * need to encrypt. */
-    if(channel->securityMode != UA_MESSAGESECURITYMODE_NONE)
+    if(UA_SecureChannel_isOPNEncrypted(channel))
         padChunk(channel, &channel->securityPolicy->asymmetricModule.cryptoModule,
-                 &buf.data[UA_SECURECHANNEL_CHANNELHEADER_LENGTH + securityHeaderLength],
+                 &buf->data[UA_SECURECHANNEL_CHANNELHEADER_LENGTH +
+                            job->securityHeaderLength],
                  &buf_pos);
 
     /* The total message length */
-    pre_sig_length = (uintptr_t)buf_pos - (uintptr_t)buf.data;
-    total_length = pre_sig_length;
+    job->preSigLength = (uintptr_t)buf_pos - (uintptr_t)buf->data;
+    job->totalLength = job->preSigLength;
     if(channel->securityMode == UA_MESSAGESECURITYMODE_SIGN ||
        channel->securityMode == UA_MESSAGESECURITYMODE_SIGNANDENCRYPT)
-        total_length += sp->asymmetricModule.cryptoModule.signatureAlgorithm.
+        job->totalLength += sp->asymmetricModule.cryptoModule.signatureAlgorithm.
             getLocalSignatureSize(channel->channelContext);
 
     /* The total message length is known here which is why we encode the headers
      * at this step and not earlier. */
-    res = prependHeadersAsym(channel, buf.data, buf_end, total_length,
-                             securityHeaderLength, requestId, &encryptedLength);
+    return prependHeadersAsym(channel, buf->data, buf_end, job->totalLength,
+                              job->securityHeaderLength, requestId,
+                              &job->encryptedLength);
+}
+
+/* Sends an OPN message using asymmetric encryption if defined */
+UA_StatusCode
+UA_SecureChannel_sendAsymmetricOPNMessage(UA_SecureChannel *channel,
+                                          UA_UInt32 requestId, const void *content,
+                                          const UA_DataType *contentType) {
+    UA_CHECK(channel->securityMode != UA_MESSAGESECURITYMODE_INVALID,
+             return UA_STATUSCODE_BADSECURITYMODEREJECTED);
+
+    /* Can we use the connection manager? */
+    UA_ConnectionManager *cm = channel->connectionManager;
+    if(!UA_SecureChannel_isConnected(channel))
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+
+    /* Encode directly into the network buffer */
+    UA_SecureChannelCryptoJob job;
+    memset(&job, 0, sizeof(UA_SecureChannelCryptoJob));
+    job.channel = channel;
+    job.type = UA_SECURECHANNELCRYPTOJOB_SIGNOPN;
+    UA_StatusCode res = cm->allocNetworkBuffer(cm, channel->connectionId, &job.buf,
+                                               channel->config.sendBufferSize);
+    UA_CHECK_STATUS(res, return res);
+
+    res = encodeAsymmetricOPNMessage(channel, requestId, content, contentType, &job);
     UA_CHECK_STATUS(res, goto error);
 
-    res = signAndEncryptAsym(channel, pre_sig_length, &buf,
-                             securityHeaderLength, total_length);
+    UA_SecureChannelCryptoJob_run(&job);
+    res = job.result;
     UA_CHECK_STATUS(res, goto error);
 
     /* Send the message, the buffer is freed in the network layer */
-    buf.length = encryptedLength;
-    return cm->sendWithConnection(cm, channel->connectionId, &UA_KEYVALUEMAP_NULL, &buf);
+    job.buf.length = job.encryptedLength;
+    return cm->sendWithConnection(cm, channel->connectionId,
+                                  &UA_KEYVALUEMAP_NULL, &job.buf);
 
  error:
-    cm->freeNetworkBuffer(cm, channel->connectionId, &buf);
+    cm->freeNetworkBuffer(cm, channel->connectionId, &job.buf);
+    return res;
+}
+
+/* Send the signed and encrypted message of the job. The job buffer is not a
+ * network buffer. So it can outlive the send-buffer of the connection. */
+static UA_StatusCode
+sendCryptoJobMessage(UA_SecureChannel *channel, UA_SecureChannelCryptoJob *job) {
+    UA_ConnectionManager *cm = channel->connectionManager;
+    if(!UA_SecureChannel_isConnected(channel))
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+
+    UA_ByteString buf = UA_BYTESTRING_NULL;
+    UA_StatusCode res = cm->allocNetworkBuffer(cm, channel->connectionId, &buf,
+                                               job->encryptedLength);
+    UA_CHECK_STATUS(res, return res);
+    memcpy(buf.data, job->buf.data, job->encryptedLength);
+    buf.length = job->encryptedLength;
+    return cm->sendWithConnection(cm, channel->connectionId, &UA_KEYVALUEMAP_NULL, &buf);
+}
+
+UA_StatusCode
+UA_SecureChannel_sendAsymmetricOPNMessageAsync(UA_SecureChannel *channel,
+                                               void *application, UA_UInt32 requestId,
+                                               const void *content,
+                                               const UA_DataType *contentType) {
+    if(!channel->offloadCrypto)
+        return UA_SecureChannel_sendAsymmetricOPNMessage(channel, requestId,
+                                                         content, contentType);
+
+    UA_CHECK(channel->securityMode != UA_MESSAGESECURITYMODE_INVALID,
+             return UA_STATUSCODE_BADSECURITYMODEREJECTED);
+    if(!UA_SecureChannel_isConnected(channel))
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+
+    UA_SecureChannelCryptoJob *job = (UA_SecureChannelCryptoJob*)
+        UA_calloc(1, sizeof(UA_SecureChannelCryptoJob));
+    UA_CHECK_MEM(job, return UA_STATUSCODE_BADOUTOFMEMORY);
+    job->channel = channel;
+    job->type = UA_SECURECHANNELCRYPTOJOB_SIGNOPN;
+
+    UA_StatusCode res =
+        UA_ByteString_allocBuffer(&job->buf, channel->config.sendBufferSize);
+    UA_CHECK_STATUS(res, goto cleanup);
+    res = encodeAsymmetricOPNMessage(channel, requestId, content, contentType, job);
+    UA_CHECK_STATUS(res, goto cleanup);
+
+    /* Offload the signing and encryption */
+    if(offloadCryptoJob(channel, application, job) == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOOD;
+
+    /* Not taken, do it in-line */
+    UA_SecureChannelCryptoJob_run(job);
+    res = job->result;
+    if(res == UA_STATUSCODE_GOOD)
+        res = sendCryptoJobMessage(channel, job);
+
+ cleanup:
+    UA_SecureChannelCryptoJob_delete(job);
     return res;
 }
 
@@ -566,6 +702,24 @@ processSequenceNumberSym(UA_SecureChannel *channel, UA_UInt32 sequenceNumber) {
 }
 #endif
 
+/* Decode the SequenceHeader of the decrypted OPN chunk */
+static UA_StatusCode
+unpackDecryptedOPN(UA_SecureChannel *channel, UA_Chunk *chunk, size_t offset) {
+    UA_SequenceHeader sequenceHeader;
+    UA_StatusCode res =
+        UA_decodeBinaryInternal(&chunk->bytes, &offset, &sequenceHeader,
+                                &UA_TRANSPORT[UA_TRANSPORT_SEQUENCEHEADER], NULL);
+    UA_CHECK_STATUS(res, return res);
+
+    /* Set the sequence number for the channel from which to count up */
+    channel->receiveSequenceNumber = sequenceHeader.sequenceNumber;
+    chunk->requestId = sequenceHeader.requestId; /* Set the RequestId of the chunk */
+
+    /* Use only the payload */
+    hideChunkHeader(chunk, offset);
+    return UA_STATUSCODE_GOOD;
+}
+
 static UA_StatusCode
 unpackPayloadOPN(UA_SecureChannel *channel, UA_Chunk *chunk, void *application) {
     UA_assert(chunk->bytes.length >= UA_SECURECHANNEL_MESSAGE_MIN_LENGTH);
@@ -621,26 +775,30 @@ unpackPayloadOPN(UA_SecureChannel *channel, UA_Chunk *chunk, void *application)
     UA_AsymmetricAlgorithmSecurityHeader_clear(&asymHeader);
     UA_CHECK_STATUS(res, return res);
 
+    /* Offload the decryption. The chunk is persisted, as the network buffer is
+     * released before the job returns. */
+    if(channel->offloadCrypto) {
+        res = persistChunk(chunk);
+        UA_CHECK_STATUS(res, return res);
+        UA_SecureChannelCryptoJob *job = (UA_SecureChannelCryptoJob*)
+            UA_calloc(1, sizeof(UA_SecureChannelCryptoJob));
+        UA_CHECK_MEM(job, return UA_STATUSCODE_BADOUTOFMEMORY);
+        job->channel = channel;
+        job->type = UA_SECURECHANNELCRYPTOJOB_DECRYPTOPN;
+        job->chunk = chunk;
+        job->offset = offset;
+        if(offloadCryptoJob(channel, application, job) == UA_STATUSCODE_GOOD)
+            return UA_STATUSCODE_GOODCOMPLETESASYNCHRONOUSLY;
+        UA_free(job); /* Not taken, do it in-line */
+    }
+
     /* Decrypt the chunk payload */
     res = decryptAndVerifyChunk(channel,
                                 &channel->securityPolicy->asymmetricModule.cryptoModule,
                                 chunk->messageType, &chunk->bytes, offset);
     UA_CHECK_STATUS(res, return res);
 
-    /* Decode the SequenceHeader */
-    UA_SequenceHeader sequenceHeader;
-    res = UA_decodeBinaryInternal(&chunk->bytes, &offset, &sequenceHeader,
-                                  &UA_TRANSPORT[UA_TRANSPORT_SEQUENCEHEADER], NULL);
-    UA_CHECK_STATUS(res, return res);
-
-    /* Set the sequence number for the channel from which to count up */
-    channel->receiveSequenceNumber = sequenceHeader.sequenceNumber;
-    chunk->requestId = sequenceHeader.requestId; /* Set the RequestId of the chunk */
-
-    /* Use only the payload */
-    chunk->bytes.data += offset;
-    chunk->bytes.length -= offset;
-    return UA_STATUSCODE_GOOD;
+    return unpackDecryptedOPN(channel, chunk, offset);
 
 error:
     UA_AsymmetricAlgorithmSecurityHeader_clear(&asymHeader);
@@ -691,8 +849,7 @@ unpackPayloadMSG(UA_SecureChannel *channel, UA_Chunk *chunk,
     chunk->requestId = sequenceHeader.requestId; /* Set the RequestId of the chunk */
 
     /* Use only the payload */
-    chunk->bytes.data += offset;
-    chunk->bytes.length -= offset;
+    hideChunkHeader(chunk, offset);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -761,13 +918,8 @@ static UA_StatusCode
 persistCompleteChunks(UA_ChunkQueue *queue) {
     UA_Chunk *chunk;
     SIMPLEQ_FOREACH(chunk, queue, pointers) {
-        if(chunk->copied)
-            continue;
-        UA_ByteString copy;
-        UA_StatusCode res = UA_ByteString_copy(&chunk->bytes, &copy);
+        UA_StatusCode res = persistChunk(chunk);
         UA_CHECK_STATUS(res, return res);
-        chunk->bytes = copy;
-        chunk->copied = true;
     }
     return UA_STATUSCODE_GOOD;
 }
@@ -784,16 +936,58 @@ persistIncompleteChunk(UA_SecureChannel *channel, const UA_ByteString *buffer,
     return UA_STATUSCODE_GOOD;
 }
 
-/* Processes chunks and puts them into the payloads queue. Once a final chunk is
- * put into the queue, the message is assembled and the callback is called. The
+/* Put the unpacked chunk into the decrypted queue. Once a final chunk is put
+ * into the queue, the message is assembled and the callback is called. The
  * queue will be cleared for the next message. */
 static UA_StatusCode
+processDecryptedChunk(UA_SecureChannel *channel, void *application,
+                      UA_ProcessMessageCallback callback, UA_Chunk *chunk) {
+    /* Add to the decrypted-chunk queue */
+    SIMPLEQ_INSERT_TAIL(&channel->decryptedChunks, chunk, pointers);
+
+    /* Check the resource limits */
+    channel->decryptedChunksCount++;
+    channel->decryptedChunksLength += chunk->bytes.length;
+    if((channel->config.localMaxChunkCount != 0 &&
+        channel->decryptedChunksCount > channel->config.localMaxChunkCount) ||
+       (channel->config.localMaxMessageSize != 0 &&
+        channel->decryptedChunksLength > channel->config.localMaxMessageSize)) {
+        return UA_STATUSCODE_BADTCPMESSAGETOOLARGE;
+    }
+
+    /* Waiting for additional chunks */
+    if(chunk->chunkType == UA_CHUNKTYPE_INTERMEDIATE)
+        return UA_STATUSCODE_GOOD;
+
+    /* Final chunk or abort. Reset the counters. */
+    channel->decryptedChunksCount = 0;
+    channel->decryptedChunksLength = 0;
+
+    /* Abort the message, remove all decrypted chunks
+     * TODO: Log a warning with the error code */
+    if(chunk->chunkType == UA_CHUNKTYPE_ABORT) {
+        while((chunk = SIMPLEQ_FIRST(&channel->decryptedChunks))) {
+            SIMPLEQ_REMOVE_HEAD(&channel->decryptedChunks, pointers);
+            UA_Chunk_delete(chunk);
+        }
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* The decrypted queue contains a full message. Process it. */
+    UA_assert(chunk->chunkType == UA_CHUNKTYPE_FINAL);
+    return assembleProcessMessage(channel, application, callback);
+}
+
+/* Processes chunks in order. Stops when a crypto job was offloaded. The
+ * processing is then resumed in UA_SecureChannel_finishCryptoJob. */
+static UA_StatusCode
 processChunks(UA_SecureChannel *channel, void *application,
               UA_ProcessMessageCallback callback,
               UA_DateTime nowMonotonic) {
     UA_Chunk *chunk;
     UA_StatusCode res = UA_STATUSCODE_GOOD;
-    while((chunk = SIMPLEQ_FIRST(&channel->completeChunks))) {
+    while(!channel->cryptoJob &&
+          (chunk = SIMPLEQ_FIRST(&channel->completeChunks))) {
         /* Remove from the complete-chunk queue */
         SIMPLEQ_REMOVE_HEAD(&channel->completeChunks, pointers);
 
@@ -812,55 +1006,55 @@ processChunks(UA_SecureChannel *channel, void *application,
             else
                 res = unpackPayloadMSG(channel, chunk, nowMonotonic);
         } else {
-            chunk->bytes.data += UA_SECURECHANNEL_MESSAGEHEADER_LENGTH;
-            chunk->bytes.length -= UA_SECURECHANNEL_MESSAGEHEADER_LENGTH;
+            hideChunkHeader(chunk, UA_SECURECHANNEL_MESSAGEHEADER_LENGTH);
         }
 
+        /* The chunk is now owned by the offloaded crypto job */
+        if(res == UA_STATUSCODE_GOODCOMPLETESASYNCHRONOUSLY)
+            return UA_STATUSCODE_GOOD;
+
         if(res != UA_STATUSCODE_GOOD) {
             UA_Chunk_delete(chunk);
             return res;
         }
 
-        /* Add to the decrypted-chunk queue */
-        SIMPLEQ_INSERT_TAIL(&channel->decryptedChunks, chunk, pointers);
-
-        /* Check the resource limits */
-        channel->decryptedChunksCount++;
-        channel->decryptedChunksLength += chunk->bytes.length;
-        if((channel->config.localMaxChunkCount != 0 &&
-            channel->decryptedChunksCount > channel->config.localMaxChunkCount) ||
-           (channel->config.localMaxMessageSize != 0 &&
-            channel->decryptedChunksLength > channel->config.localMaxMessageSize)) {
-            return UA_STATUSCODE_BADTCPMESSAGETOOLARGE;
-        }
-
-        /* Waiting for additional chunks */
-        if(chunk->chunkType == UA_CHUNKTYPE_INTERMEDIATE)
-            continue;
-
-        /* Final chunk or abort. Reset the counters. */
-        channel->decryptedChunksCount = 0;
-        channel->decryptedChunksLength = 0;
-
-        /* Abort the message, remove all decrypted chunks
-         * TODO: Log a warning with the error code */
-        if(chunk->chunkType == UA_CHUNKTYPE_ABORT) {
-            while((chunk = SIMPLEQ_FIRST(&channel->decryptedChunks))) {
-                SIMPLEQ_REMOVE_HEAD(&channel->decryptedChunks, pointers);
-                UA_Chunk_delete(chunk);
-            }
-            continue;
-        }
-
-        /* The decrypted queue contains a full message. Process it. */
-        UA_assert(chunk->chunkType == UA_CHUNKTYPE_FINAL);
-        res = assembleProcessMessage(channel, application, callback);
+        res = processDecryptedChunk(channel, application, callback, chunk);
         UA_CHECK_STATUS(res, return res);
     }
 
     return UA_STATUSCODE_GOOD;
 }
 
+UA_StatusCode
+UA_SecureChannel_finishCryptoJob(UA_SecureChannel *channel, void *application,
+                                 UA_ProcessMessageCallback callback,
+                                 UA_DateTime nowMonotonic) {
+    UA_SecureChannelCryptoJob *job = channel->cryptoJob;
+    UA_CHECK_MEM(job, return UA_STATUSCODE_BADINTERNALERROR);
+    channel->cryptoJob = NULL;
+
+    UA_StatusCode res = job->result;
+    if(job->type == UA_SECURECHANNELCRYPTOJOB_DECRYPTOPN) {
+        /* Take the chunk from the job */
+        UA_Chunk *chunk = job->chunk;
+        job->chunk = NULL;
+        if(res == UA_STATUSCODE_GOOD)
+            res = unpackDecryptedOPN(channel, chunk, job->offset);
+        if(res == UA_STATUSCODE_GOOD)
+            res = processDecryptedChunk(channel, application, callback, chunk);
+        else
+            UA_Chunk_delete(chunk);
+    } else {
+        if(res == UA_STATUSCODE_GOOD)
+            res = sendCryptoJobMessage(channel, job);
+    }
+    UA_SecureChannelCryptoJob_delete(job);
+    UA_CHECK_STATUS(res, return res);
+
+    /* Resume with the chunks received in the meantime */
+    return processChunks(channel, application, callback, nowMonotonic);
+}
+
 static UA_StatusCode
 extractCompleteChunk(UA_SecureChannel *channel, const UA_ByteString *buffer,
                      size_t *offset, UA_Boolean *done) {
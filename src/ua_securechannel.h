@@ -91,6 +91,48 @@ typedef enum {
     UA_SECURECHANNELRENEWSTATE_NEWTOKEN_CLIENT
 } UA_SecureChannelRenewState;
 
+/* The asymmetric cryptography of the OPN handshake can be offloaded to a worker
+ * thread. While a job is pending, the processing of received chunks is
+ * suspended. The worker only accesses the job and the SecurityPolicy (context)
+ * of the channel. */
+typedef enum {
+    UA_SECURECHANNELCRYPTOJOB_DECRYPTOPN, /* Decrypt and verify a received OPN chunk */
+    UA_SECURECHANNELCRYPTOJOB_SIGNOPN     /* Sign and encrypt an OPN message */
+} UA_SecureChannelCryptoJobType;
+
+typedef enum {
+    UA_SECURECHANNELCRYPTOJOBSTATE_QUEUED,
+    UA_SECURECHANNELCRYPTOJOBSTATE_RUNNING,
+    UA_SECURECHANNELCRYPTOJOBSTATE_DONE
+} UA_SecureChannelCryptoJobState;
+
+typedef struct UA_SecureChannelCryptoJob {
+    TAILQ_ENTRY(UA_SecureChannelCryptoJob) pointers; /* Queue of the workers */
+    UA_SecureChannel *channel;
+    UA_SecureChannelCryptoJobType type;
+    UA_SecureChannelCryptoJobState state;
+    UA_Boolean orphaned; /* The channel was closed while the job was running */
+    UA_StatusCode result;
+
+    /* DECRYPTOPN */
+    UA_Chunk *chunk;     /* Owned by the job. The chunk bytes are persisted. */
+    size_t offset;       /* Start of the encrypted part (SequenceHeader) */
+
+    /* SIGNOPN */
+    UA_ByteString buf;   /* The encoded message (not a network buffer) */
+    size_t preSigLength;
+    size_t securityHeaderLength;
+    size_t totalLength;
+    size_t encryptedLength;
+} UA_SecureChannelCryptoJob;
+
+/* Run the cryptography of the job. Can be called from a worker thread. */
+void
+UA_SecureChannelCryptoJob_run(UA_SecureChannelCryptoJob *job);
+
+void
+UA_SecureChannelCryptoJob_delete(UA_SecureChannelCryptoJob *job);
+
 struct UA_SecureChannel {
     UA_SecureChannelState state;
     UA_SecureChannelRenewState renewState;
@@ -131,6 +173,9 @@ struct UA_SecureChannel {
      * overlap with a RenewSecureChannel. */
     UA_ByteString remoteNonce;
     UA_ByteString localNonce;
+    UA_Boolean serverSide; /* Is the local side the server? Required to tell
+                            * the client and server nonce apart for the key
+                            * derivation of the ECC policies. */
 
     UA_UInt32 receiveSequenceNumber;
     UA_UInt32 sendSequenceNumber;
@@ -155,6 +200,14 @@ struct UA_SecureChannel {
     UA_CertificateGroup *certificateVerification;
     UA_StatusCode (*processOPNHeader)(void *application, UA_SecureChannel *channel,
                                       const UA_AsymmetricAlgorithmSecurityHeader *asymHeader);
+
+    /* Offload the asymmetric cryptography of the OPN handshake. Returns
+     * UA_STATUSCODE_GOOD if the job was taken. Then the job is completed with
+     * UA_SecureChannel_finishCryptoJob. Otherwise the cryptography is done
+     * in-line. */
+    UA_StatusCode (*offloadCrypto)(void *application, UA_SecureChannel *channel,
+                                   UA_SecureChannelCryptoJob *job);
+    UA_SecureChannelCryptoJob *cryptoJob; /* The pending job (or NULL) */
 };
 
 void UA_SecureChannel_init(UA_SecureChannel *channel);
@@ -219,6 +272,15 @@ UA_StatusCode
 UA_SecureChannel_sendAsymmetricOPNMessage(UA_SecureChannel *channel, UA_UInt32 requestId,
                                           const void *content, const UA_DataType *contentType);
 
+/* Same as above. But the signing and encryption is offloaded if the channel has
+ * the offloadCrypto callback set. The message is then sent when the job is
+ * finished. */
+UA_StatusCode
+UA_SecureChannel_sendAsymmetricOPNMessageAsync(UA_SecureChannel *channel,
+                                               void *application, UA_UInt32 requestId,
+                                               const void *content,
+                                               const UA_DataType *contentType);
+
 UA_StatusCode
 UA_SecureChannel_sendSymmetricMessage(UA_SecureChannel *channel, UA_UInt32 requestId,
                                       UA_MessageType messageType, void *payload,
@@ -286,8 +348,27 @@ UA_SecureChannel_processBuffer(UA_SecureChannel *channel, void *application,
                                const UA_ByteString *buffer,
                                UA_DateTime nowMonotonic);
 
+/* Complete the pending crypto job after it was run in a worker. Sends the
+ * signed OPN message or processes the decrypted OPN chunk. Then the processing
+ * of the received chunks is resumed. Must be called from the thread that
+ * processes the buffers of the channel. */
+UA_StatusCode
+UA_SecureChannel_finishCryptoJob(UA_SecureChannel *channel, void *application,
+                                 UA_ProcessMessageCallback callback,
+                                 UA_DateTime nowMonotonic);
+
 /* Internal methods in ua_securechannel_crypto.h */
 
+/* The OPN messages are encrypted with the certificate keys if the
+ * SecurityMode is not None. Except for policies that have no asymmetric
+ * encryption (ECC). Then the OPN messages are only signed. */
+static UA_INLINE UA_Boolean
+UA_SecureChannel_isOPNEncrypted(const UA_SecureChannel *channel) {
+    return (channel->securityMode != UA_MESSAGESECURITYMODE_NONE &&
+            channel->securityPolicy->asymmetricModule.cryptoModule.
+            encryptionAlgorithm.encrypt != NULL);
+}
+
 void
 hideBytesAsym(const UA_SecureChannel *channel, UA_Byte **buf_start,
               const UA_Byte **buf_end);
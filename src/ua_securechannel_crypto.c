@@ -31,9 +31,59 @@ UA_SecureChannel_generateLocalNonce(UA_SecureChannel *channel) {
     }
 
     /* Generate the nonce */
+    if(sp->symmetricModule.generateChannelNonce)
+        return sp->symmetricModule.
+            generateChannelNonce(channel->channelContext, &channel->localNonce);
     return sp->symmetricModule.generateNonce(sp->policyContext, &channel->localNonce);
 }
 
+/* Derive the key material for the local or the remote side. Without the
+ * channel-specific key derivation, the keys are generated from the nonces
+ * only. The secret is the nonce of the other side. */
+static UA_StatusCode
+generateKeyMaterial(const UA_SecureChannel *channel, UA_Boolean local,
+                    UA_ByteString *out) {
+    const UA_SecurityPolicy *sp = channel->securityPolicy;
+    const UA_SecurityPolicySymmetricModule *sm = &sp->symmetricModule;
+    if(!sm->generateChannelKey) {
+        if(local)
+            return sm->generateKey(sp->policyContext, &channel->remoteNonce,
+                                   &channel->localNonce, out);
+        return sm->generateKey(sp->policyContext, &channel->localNonce,
+                               &channel->remoteNonce, out);
+    }
+
+    const UA_ByteString *clientNonce = (channel->serverSide) ?
+        &channel->remoteNonce : &channel->localNonce;
+    const UA_ByteString *serverNonce = (channel->serverSide) ?
+        &channel->localNonce : &channel->remoteNonce;
+    UA_Boolean clientKeys = (local != channel->serverSide);
+    return sm->generateChannelKey(channel->channelContext, clientNonce,
+                                  serverNonce, clientKeys, out);
+}
+
+/* The key material (signing key, encrypting key and IV) is only needed until
+ * it is set in the channel context. Use a buffer on the stack unless the
+ * SecurityPolicy needs unusually long keys. */
+#define UA_SECURECHANNEL_KEYMATERIAL_STACKBUF 128
+
+static UA_StatusCode
+allocKeyMaterial(UA_ByteString *buf, UA_Byte *stackBuf, size_t length) {
+    if(length <= UA_SECURECHANNEL_KEYMATERIAL_STACKBUF) {
+        buf->data = stackBuf;
+        buf->length = length;
+        return UA_STATUSCODE_GOOD;
+    }
+    return UA_ByteString_allocBuffer(buf, length);
+}
+
+static void
+clearKeyMaterial(UA_ByteString *buf, UA_Byte *stackBuf) {
+    UA_ByteString_memZero(buf);
+    if(buf->data != stackBuf)
+        UA_ByteString_clear(buf);
+}
+
 UA_StatusCode
 UA_SecureChannel_generateLocalKeys(const UA_SecureChannel *channel) {
     const UA_SecurityPolicy *sp = channel->securityPolicy;
@@ -54,15 +104,15 @@ UA_SecureChannel_generateLocalKeys(const UA_SecureChannel *channel) {
     if(encrBS + signKL + encrKL == 0)
         return UA_STATUSCODE_GOOD; /* No keys to generate */
 
-    UA_StatusCode retval = UA_ByteString_allocBuffer(&buf, encrBS + signKL + encrKL);
+    UA_Byte stackBuf[UA_SECURECHANNEL_KEYMATERIAL_STACKBUF];
+    UA_StatusCode retval = allocKeyMaterial(&buf, stackBuf, encrBS + signKL + encrKL);
     UA_CHECK_STATUS(retval, return retval);
     UA_ByteString localSigningKey = {signKL, buf.data};
     UA_ByteString localEncryptingKey = {encrKL, &buf.data[signKL]};
     UA_ByteString localIv = {encrBS, &buf.data[signKL + encrKL]};
 
     /* Generate key */
-    retval = sm->generateKey(sp->policyContext, &channel->remoteNonce,
-                             &channel->localNonce, &buf);
+    retval = generateKeyMaterial(channel, true, &buf);
     UA_CHECK_STATUS(retval, goto error);
 
     /* Set the channel context */
@@ -74,7 +124,7 @@ UA_SecureChannel_generateLocalKeys(const UA_SecureChannel *channel) {
     UA_CHECK_STATUS(retval, UA_LOG_WARNING_CHANNEL(sp->logger, channel,
                             "Could not generate local keys (statuscode: %s)",
                             UA_StatusCode_name(retval)));
-    UA_ByteString_clear(&buf);
+    clearKeyMaterial(&buf, stackBuf);
     return retval;
 }
 
@@ -97,15 +147,15 @@ generateRemoteKeys(const UA_SecureChannel *channel) {
     if(encrBS + signKL + encrKL == 0)
         return UA_STATUSCODE_GOOD; /* No keys to generate */
 
-    UA_StatusCode retval = UA_ByteString_allocBuffer(&buf, encrBS + signKL + encrKL);
+    UA_Byte stackBuf[UA_SECURECHANNEL_KEYMATERIAL_STACKBUF];
+    UA_StatusCode retval = allocKeyMaterial(&buf, stackBuf, encrBS + signKL + encrKL);
     UA_CHECK_STATUS(retval, return retval);
     UA_ByteString remoteSigningKey = {signKL, buf.data};
     UA_ByteString remoteEncryptingKey = {encrKL, &buf.data[signKL]};
     UA_ByteString remoteIv = {encrBS, &buf.data[signKL + encrKL]};
 
     /* Generate key */
-    retval = sm->generateKey(sp->policyContext, &channel->localNonce,
-                             &channel->remoteNonce, &buf);
+    retval = generateKeyMaterial(channel, false, &buf);
     UA_CHECK_STATUS(retval, goto error);
 
     /* Set the channel context */
@@ -117,7 +167,7 @@ generateRemoteKeys(const UA_SecureChannel *channel) {
     UA_CHECK_STATUS(retval, UA_LOG_WARNING_CHANNEL(sp->logger, channel,
                             "Could not generate remote keys (statuscode: %s)",
                             UA_StatusCode_name(retval)));
-    UA_ByteString_clear(&buf);
+    clearKeyMaterial(&buf, stackBuf);
     return retval;
 }
 
@@ -152,7 +202,7 @@ prependHeadersAsym(UA_SecureChannel *const channel, UA_Byte *header_pos,
     const UA_SecurityPolicy *sp = channel->securityPolicy;
     UA_CHECK_MEM(sp, return UA_STATUSCODE_BADINTERNALERROR);
 
-    if(channel->securityMode == UA_MESSAGESECURITYMODE_NONE) {
+    if(!UA_SecureChannel_isOPNEncrypted(channel)) {
         *encryptedLength = totalLength;
     } else {
         size_t dataToEncryptLength = totalLength -
@@ -220,6 +270,10 @@ hideBytesAsym(const UA_SecureChannel *channel, UA_Byte **buf_start,
     *buf_end -= sp->asymmetricModule.cryptoModule.signatureAlgorithm.
         getLocalSignatureSize(channel->channelContext);
 
+    /* No padding if the message is only signed */
+    if(!UA_SecureChannel_isOPNEncrypted(channel))
+        return;
+
     /* Block sizes depend on the remote key (certificate) */
     size_t plainTextBlockSize = sp->asymmetricModule.cryptoModule.
         encryptionAlgorithm.getRemotePlainTextBlockSize(channel->channelContext);
@@ -295,7 +349,9 @@ signAndEncryptAsym(UA_SecureChannel *channel, size_t preSignLength,
 
     /* Specification part 6, 6.7.4: The OpenSecureChannel Messages are
      * signed and encrypted if the SecurityMode is not None (even if the
-     * SecurityMode is SignOnly). */
+     * SecurityMode is SignOnly). The ECC policies only sign. */
+    if(!UA_SecureChannel_isOPNEncrypted(channel))
+        return UA_STATUSCODE_GOOD;
     size_t unencrypted_length =
         UA_SECURECHANNEL_CHANNELHEADER_LENGTH + securityHeaderLength;
     UA_ByteString dataToEncrypt = {totalLength - unencrypted_length,
@@ -315,8 +371,20 @@ signAndEncryptSym(UA_MessageContext *messageContext,
     if(channel->securityMode == UA_MESSAGESECURITYMODE_NONE)
         return UA_STATUSCODE_GOOD;
 
-    /* Sign */
     const UA_SecurityPolicy *sp = channel->securityPolicy;
+
+    /* Use the fused sign-and-encrypt if the SecurityPolicy provides it */
+    if(channel->securityMode == UA_MESSAGESECURITYMODE_SIGNANDENCRYPT &&
+       sp->symmetricModule.signAndEncrypt) {
+        UA_ByteString chunk = {totalLength, messageContext->messageBuffer.data};
+        return sp->symmetricModule.
+            signAndEncrypt(channel->channelContext, &chunk,
+                           UA_SECURECHANNEL_CHANNELHEADER_LENGTH +
+                           UA_SECURECHANNEL_SYMMETRIC_SECURITYHEADER_LENGTH,
+                           preSigLength);
+    }
+
+    /* Sign */
     UA_ByteString dataToSign = messageContext->messageBuffer;
     dataToSign.length = preSigLength;
     UA_ByteString signature;
@@ -430,10 +498,13 @@ decryptAndVerifyChunk(const UA_SecureChannel *channel,
                       const UA_SecurityPolicyCryptoModule *cryptoModule,
                       UA_MessageType messageType, UA_ByteString *chunk,
                       size_t offset) {
-    /* Decrypt the chunk */
+    /* Decrypt the chunk. OPN messages are decrypted unless the policy has no
+     * asymmetric encryption. */
     UA_StatusCode res = UA_STATUSCODE_GOOD;
-    if(channel->securityMode == UA_MESSAGESECURITYMODE_SIGNANDENCRYPT ||
-       messageType == UA_MESSAGETYPE_OPN) {
+    UA_Boolean encrypted = (messageType == UA_MESSAGETYPE_OPN) ?
+        (cryptoModule->encryptionAlgorithm.decrypt != NULL) :
+        (channel->securityMode == UA_MESSAGESECURITYMODE_SIGNANDENCRYPT);
+    if(encrypted) {
         UA_ByteString cipher = {chunk->length - offset, chunk->data + offset};
         res = cryptoModule->encryptionAlgorithm.decrypt(channel->channelContext, &cipher);
         UA_CHECK_STATUS(res, return res);
@@ -456,9 +527,10 @@ decryptAndVerifyChunk(const UA_SecureChannel *channel,
 
     /* Compute the padding if the payload as encrypted */
     size_t padSize = 0;
-    if(channel->securityMode == UA_MESSAGESECURITYMODE_SIGNANDENCRYPT ||
-       (messageType == UA_MESSAGETYPE_OPN &&
-        cryptoModule->encryptionAlgorithm.uri.length > 0)) {
+    if(encrypted &&
+       (channel->securityMode == UA_MESSAGESECURITYMODE_SIGNANDENCRYPT ||
+        (messageType == UA_MESSAGETYPE_OPN &&
+         cryptoModule->encryptionAlgorithm.uri.length > 0))) {
         padSize = decodePadding(channel, cryptoModule, chunk, sigsize);
         UA_LOG_TRACE_CHANNEL(channel->securityPolicy->logger, channel,
                              "Calculated padding size to be %lu",
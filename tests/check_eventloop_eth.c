@@ -16,6 +16,7 @@ static UA_EventLoop *el;
 static char *testMsg = "open62541";
 static uintptr_t clientId;
 static UA_Boolean received;
+static size_t receivedCount;
 
 #define ETHERNET_INTERFACE "lo" /* use the loopback interface for testing */
 #define MULTICAST_MAC_ADDRESS "00-00-00-00-00-00"
@@ -63,6 +64,7 @@ connectionCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
         UA_ByteString rcv = UA_BYTESTRING(testMsg);
         ck_assert(UA_String_equal(&msg, &rcv));
         received = true;
+        receivedCount++;
     }
 }
 
@@ -197,11 +199,188 @@ START_TEST(connectETH) {
     el = NULL;
 } END_TEST
 
+/* Send and receive through the AF_XDP sockets. The listen and the send
+ * connection share the socket for the interface queue. The SKB mode works
+ * also for the loopback interface. */
+START_TEST(connectETHXDP) {
+    UA_ConnectionManager *cm = UA_ConnectionManager_new_POSIX_Ethernet(UA_STRING("ethCM"));
+    el = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    el->registerEventSource(el, &cm->eventSource);
+    el->start(el);
+
+    UA_String interface = UA_STRING(ETHERNET_INTERFACE);
+    UA_String address = UA_STRING(MULTICAST_MAC_ADDRESS);
+    UA_Boolean listen = true;
+    UA_UInt16 etherType = 0xb62c; /* OPC UA PubSub EtherType */
+    UA_Boolean xdp = true;
+    UA_UInt32 xdpFlags = 2; /* XDP_FLAGS_SKB_MODE */
+
+    UA_KeyValuePair params[6];
+    params[0].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[0].value, &address, &UA_TYPES[UA_TYPES_STRING]);
+    params[1].key = UA_QUALIFIEDNAME(0, "interface");
+    UA_Variant_setScalar(&params[1].value, &interface, &UA_TYPES[UA_TYPES_STRING]);
+    params[2].key = UA_QUALIFIEDNAME(0, "ethertype");
+    UA_Variant_setScalar(&params[2].value, &etherType, &UA_TYPES[UA_TYPES_UINT16]);
+    params[3].key = UA_QUALIFIEDNAME(0, "xdp-enable");
+    UA_Variant_setScalar(&params[3].value, &xdp, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    params[4].key = UA_QUALIFIEDNAME(0, "xdp-flags");
+    UA_Variant_setScalar(&params[4].value, &xdpFlags, &UA_TYPES[UA_TYPES_UINT32]);
+    params[5].key = UA_QUALIFIEDNAME(0, "listen");
+    UA_Variant_setScalar(&params[5].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
+
+    TestContext testContext;
+    testContext.connCount = 0;
+
+    /* Don't use the address parameter for listening */
+    UA_KeyValueMap kvm = {5, &params[1]};
+    UA_StatusCode retval =
+        cm->openConnection(cm, &kvm, NULL, &testContext, connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(testContext.connCount, 1);
+    uintptr_t listenId = clientId;
+
+    /* Open a send connection on the same queue */
+    kvm.map = params;
+    clientId = 0;
+    retval = cm->openConnection(cm, &kvm, NULL, &testContext, connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(clientId != 0);
+    ck_assert(clientId != listenId);
+    ck_assert_uint_eq(testContext.connCount, 2);
+
+    /* Send more messages than there are frames in the rings */
+    for(size_t i = 0; i < 1024; i++) {
+        received = false;
+        UA_ByteString snd;
+        retval = cm->allocNetworkBuffer(cm, clientId, &snd, strlen(testMsg));
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        memcpy(snd.data, testMsg, strlen(testMsg));
+        retval = cm->sendWithConnection(cm, clientId, NULL, &snd);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        for(size_t j = 0; j < 100 && !received; j++)
+            el->run(el, 1);
+        ck_assert(received);
+    }
+
+    /* Close the send connection. The listen connection keeps the socket. */
+    retval = cm->closeConnection(cm, clientId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 2; i++)
+        el->run(el, 1);
+    ck_assert_uint_eq(testContext.connCount, 1);
+
+    /* Stop the EventLoop */
+    int max_stop_iteration_count = 10;
+    int iteration = 0;
+    el->stop(el);
+    while(el->state != UA_EVENTLOOPSTATE_STOPPED &&
+          iteration < max_stop_iteration_count) {
+        el->run(el, 1);
+        iteration++;
+    }
+    ck_assert(el->state == UA_EVENTLOOPSTATE_STOPPED);
+    ck_assert_uint_eq(testContext.connCount, 0);
+    el->free(el);
+    el = NULL;
+} END_TEST
+
+/* Send bursts of frames through the tx ring. The bursts wrap around the end
+ * of the ring. The frames are received in batches from the rx ring. */
+START_TEST(connectETHRing) {
+    UA_ConnectionManager *cm = UA_ConnectionManager_new_POSIX_Ethernet(UA_STRING("ethCM"));
+    el = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    el->registerEventSource(el, &cm->eventSource);
+    el->start(el);
+
+    UA_String interface = UA_STRING(ETHERNET_INTERFACE);
+    UA_String address = UA_STRING(MULTICAST_MAC_ADDRESS);
+    UA_Boolean listen = true;
+    UA_UInt16 etherType = 0xb62c; /* OPC UA PubSub EtherType */
+    UA_Boolean ring = true;
+
+    UA_KeyValuePair params[5];
+    params[0].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[0].value, &address, &UA_TYPES[UA_TYPES_STRING]);
+    params[1].key = UA_QUALIFIEDNAME(0, "interface");
+    UA_Variant_setScalar(&params[1].value, &interface, &UA_TYPES[UA_TYPES_STRING]);
+    params[2].key = UA_QUALIFIEDNAME(0, "ethertype");
+    UA_Variant_setScalar(&params[2].value, &etherType, &UA_TYPES[UA_TYPES_UINT16]);
+    params[3].key = UA_QUALIFIEDNAME(0, "packet-ring");
+    UA_Variant_setScalar(&params[3].value, &ring, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    params[4].key = UA_QUALIFIEDNAME(0, "listen");
+    UA_Variant_setScalar(&params[4].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
+
+    TestContext testContext;
+    testContext.connCount = 0;
+
+    /* Don't use the address parameter for listening */
+    UA_KeyValueMap kvm = {4, &params[1]};
+    UA_StatusCode retval =
+        cm->openConnection(cm, &kvm, NULL, &testContext, connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(testContext.connCount, 1);
+
+    kvm.map = params;
+    clientId = 0;
+    retval = cm->openConnection(cm, &kvm, NULL, &testContext, connectionCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(clientId != 0);
+    ck_assert_uint_eq(testContext.connCount, 2);
+
+    /* The frames are sent out at the end of the EventLoop iteration */
+    for(size_t round = 0; round < 3; round++) {
+        receivedCount = 0;
+        for(size_t i = 0; i < 300; i++) {
+            UA_ByteString snd;
+            retval = cm->allocNetworkBuffer(cm, clientId, &snd, strlen(testMsg));
+            ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+            memcpy(snd.data, testMsg, strlen(testMsg));
+            retval = cm->sendWithConnection(cm, clientId, NULL, &snd);
+            ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        }
+        for(size_t j = 0; j < 100 && receivedCount < 300; j++)
+            el->run(el, 10);
+        ck_assert_uint_eq(receivedCount, 300);
+    }
+
+    /* Close the send connection with pending frames in the ring */
+    receivedCount = 0;
+    UA_ByteString snd;
+    retval = cm->allocNetworkBuffer(cm, clientId, &snd, strlen(testMsg));
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    memcpy(snd.data, testMsg, strlen(testMsg));
+    retval = cm->sendWithConnection(cm, clientId, NULL, &snd);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = cm->closeConnection(cm, clientId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t j = 0; j < 100 && receivedCount < 1; j++)
+        el->run(el, 10);
+    ck_assert_uint_eq(receivedCount, 1);
+    ck_assert_uint_eq(testContext.connCount, 1);
+
+    /* Stop the EventLoop */
+    int max_stop_iteration_count = 10;
+    int iteration = 0;
+    el->stop(el);
+    while(el->state != UA_EVENTLOOPSTATE_STOPPED &&
+          iteration < max_stop_iteration_count) {
+        el->run(el, 1);
+        iteration++;
+    }
+    ck_assert(el->state == UA_EVENTLOOPSTATE_STOPPED);
+    ck_assert_uint_eq(testContext.connCount, 0);
+    el->free(el);
+    el = NULL;
+} END_TEST
+
 int main(void) {
     Suite *s  = suite_create("Test ETH EventLoop");
     TCase *tc = tcase_create("test cases");
     tcase_add_test(tc, listenETH);
     tcase_add_test(tc, connectETH);
+    tcase_add_test(tc, connectETHXDP);
+    tcase_add_test(tc, connectETHRing);
     suite_add_tcase(s, tc);
 
     SRunner *sr = srunner_create(s);
@@ -107,10 +107,195 @@ START_TEST(connectSubscribePublish) {
     el = NULL;
 } END_TEST
 
+/* Subscribe with wildcard topic filters */
+START_TEST(subscribeWildcard) {
+    messageCount = 0;
+    UA_ConnectionManager *cm = UA_ConnectionManager_new_POSIX_TCP(UA_STRING("tcpCM"));
+    UA_ConnectionManager *mcm = UA_ConnectionManager_new_MQTT(UA_STRING("mqttCM"));
+    UA_EventLoop *el = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    el->registerEventSource(el, &cm->eventSource);
+    el->registerEventSource(el, &mcm->eventSource);
+    el->start(el);
+
+    UA_UInt16 port = 1883;
+    UA_String hostname = UA_STRING("localhost");
+    UA_String topic = UA_STRING("open62541/+/value");
+    UA_Boolean subscribe = true;
+
+    UA_KeyValuePair params[4];
+    params[0].key = UA_QUALIFIEDNAME(0, "port");
+    UA_Variant_setScalar(&params[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
+    params[1].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[1].value, &hostname, &UA_TYPES[UA_TYPES_STRING]);
+    params[2].key = UA_QUALIFIEDNAME(0, "topic");
+    UA_Variant_setScalar(&params[2].value, &topic, &UA_TYPES[UA_TYPES_STRING]);
+    params[3].key = UA_QUALIFIEDNAME(0, "subscribe");
+    UA_Variant_setScalar(&params[3].value, &subscribe, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    UA_KeyValueMap kvm = {4, params};
+
+    uintptr_t singleLevelConnectionId = 0;
+    UA_StatusCode res = mcm->openConnection(mcm, &kvm, NULL,
+                                            &singleLevelConnectionId, connectionCallback);
+    ck_assert(res == UA_STATUSCODE_GOOD);
+
+    topic = UA_STRING("open62541/#");
+    uintptr_t multiLevelConnectionId = 0;
+    res = mcm->openConnection(mcm, &kvm, NULL,
+                              &multiLevelConnectionId, connectionCallback);
+    ck_assert(res == UA_STATUSCODE_GOOD);
+
+    /* Wildcards are not allowed for publishing or within a level */
+    uintptr_t invalidConnectionId = 0;
+    topic = UA_STRING("open62541/a#");
+    res = mcm->openConnection(mcm, &kvm, NULL,
+                              &invalidConnectionId, connectionCallback);
+    ck_assert(res != UA_STATUSCODE_GOOD);
+    subscribe = false;
+    topic = UA_STRING("open62541/+/value");
+    res = mcm->openConnection(mcm, &kvm, NULL,
+                              &invalidConnectionId, connectionCallback);
+    ck_assert(res != UA_STATUSCODE_GOOD);
+
+    topic = UA_STRING("open62541/sensor/value");
+    uintptr_t publishConnectionId = 0;
+    res = mcm->openConnection(mcm, &kvm, NULL,
+                              &publishConnectionId, connectionCallback);
+    ck_assert(res == UA_STATUSCODE_GOOD);
+
+    /* Iterate to open the connection */
+    el->run(el, 100);
+
+    /* The message is received by both wildcard subscriptions */
+    UA_ByteString msg = UA_BYTESTRING_ALLOC("open62541-msg");
+    res = mcm->sendWithConnection(mcm, publishConnectionId,
+                                  &UA_KEYVALUEMAP_NULL, &msg);
+    ck_assert(res == UA_STATUSCODE_GOOD);
+    while(messageCount < 2)
+        el->run(el, 100);
+    ck_assert_uint_eq(messageCount, 2);
+
+    /* Stop the EventLoop */
+    int max_stop_iteration_count = 10;
+    int iteration = 0;
+    el->stop(el);
+    while(el->state != UA_EVENTLOOPSTATE_STOPPED && iteration < max_stop_iteration_count) {
+        UA_DateTime next = el->run(el, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+        iteration++;
+    }
+    ck_assert(el->state == UA_EVENTLOOPSTATE_STOPPED);
+    el->free(el);
+    el = NULL;
+} END_TEST
+
+/* Publish many messages in batches per EventLoop iteration. The messages of a
+ * batch are sent out with a single TCP send. Prints the throughput. */
+#define THROUGHPUT_MESSAGES 10000
+#define THROUGHPUT_BATCH 100
+
+static void
+publishBatches(UA_EventLoop *el, UA_ConnectionManager *mcm,
+               uintptr_t publishConnectionId, size_t batchSize) {
+    size_t sent = 0;
+    UA_DateTime start = UA_DateTime_nowMonotonic();
+    while(sent < THROUGHPUT_MESSAGES) {
+        for(size_t i = 0; i < batchSize && sent < THROUGHPUT_MESSAGES; i++) {
+            UA_ByteString msg = UA_BYTESTRING_ALLOC("open62541-throughput-msg");
+            UA_StatusCode res = mcm->sendWithConnection(mcm, publishConnectionId,
+                                                        &UA_KEYVALUEMAP_NULL, &msg);
+            /* The window for QoS 1/2 messages in flight is full */
+            if(res == UA_STATUSCODE_BADRESOURCEUNAVAILABLE)
+                break;
+            ck_assert(res == UA_STATUSCODE_GOOD);
+            sent++;
+        }
+        el->run(el, 0);
+    }
+    while(messageCount < THROUGHPUT_MESSAGES)
+        el->run(el, 100);
+    UA_DateTime duration = UA_DateTime_nowMonotonic() - start;
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND,
+                "Received %u messages in %.2f ms (%.0f messages/s)",
+                (unsigned)messageCount, (double)duration / UA_DATETIME_MSEC,
+                (double)messageCount * UA_DATETIME_SEC / (double)duration);
+    ck_assert_uint_eq(messageCount, THROUGHPUT_MESSAGES);
+}
+
+START_TEST(publishThroughput) {
+    UA_ConnectionManager *cm = UA_ConnectionManager_new_POSIX_TCP(UA_STRING("tcpCM"));
+    UA_ConnectionManager *mcm = UA_ConnectionManager_new_MQTT(UA_STRING("mqttCM"));
+    UA_EventLoop *el = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    el->registerEventSource(el, &cm->eventSource);
+    el->registerEventSource(el, &mcm->eventSource);
+    el->start(el);
+
+    UA_UInt16 port = 1883;
+    UA_String hostname = UA_STRING("localhost");
+    UA_String topic = UA_STRING("open62541/throughput");
+    UA_Boolean subscribe = true;
+    UA_Byte qos = 0;
+
+    UA_KeyValuePair params[5];
+    params[0].key = UA_QUALIFIEDNAME(0, "port");
+    UA_Variant_setScalar(&params[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
+    params[1].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[1].value, &hostname, &UA_TYPES[UA_TYPES_STRING]);
+    params[2].key = UA_QUALIFIEDNAME(0, "topic");
+    UA_Variant_setScalar(&params[2].value, &topic, &UA_TYPES[UA_TYPES_STRING]);
+    params[3].key = UA_QUALIFIEDNAME(0, "subscribe");
+    UA_Variant_setScalar(&params[3].value, &subscribe, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    params[4].key = UA_QUALIFIEDNAME(0, "qos");
+    UA_Variant_setScalar(&params[4].value, &qos, &UA_TYPES[UA_TYPES_BYTE]);
+    UA_KeyValueMap kvm = {5, params};
+
+    uintptr_t subscribeConnectionId = 0;
+    UA_StatusCode res = mcm->openConnection(mcm, &kvm, NULL,
+                                            &subscribeConnectionId, connectionCallback);
+    ck_assert(res == UA_STATUSCODE_GOOD);
+
+    subscribe = false;
+    uintptr_t publishConnectionId = 0;
+    res = mcm->openConnection(mcm, &kvm, NULL,
+                              &publishConnectionId, connectionCallback);
+    ck_assert(res == UA_STATUSCODE_GOOD);
+
+    qos = 1;
+    uintptr_t publishQoSConnectionId = 0;
+    res = mcm->openConnection(mcm, &kvm, NULL,
+                              &publishQoSConnectionId, connectionCallback);
+    ck_assert(res == UA_STATUSCODE_GOOD);
+
+    /* Iterate to open the connection */
+    el->run(el, 100);
+
+    /* QoS 0 */
+    messageCount = 0;
+    publishBatches(el, mcm, publishConnectionId, THROUGHPUT_BATCH);
+
+    /* QoS 1 with the default window of messages in flight */
+    messageCount = 0;
+    publishBatches(el, mcm, publishQoSConnectionId, THROUGHPUT_BATCH);
+
+    /* Stop the EventLoop */
+    int max_stop_iteration_count = 10;
+    int iteration = 0;
+    el->stop(el);
+    while(el->state != UA_EVENTLOOPSTATE_STOPPED && iteration < max_stop_iteration_count) {
+        UA_DateTime next = el->run(el, 1);
+        UA_fakeSleep((UA_UInt32)((next - UA_DateTime_now()) / UA_DATETIME_MSEC));
+        iteration++;
+    }
+    ck_assert(el->state == UA_EVENTLOOPSTATE_STOPPED);
+    el->free(el);
+    el = NULL;
+} END_TEST
+
 int main(void) {
     Suite *s  = suite_create("Test MQTT TCP EventLoop");
     TCase *tc = tcase_create("test cases");
     tcase_add_test(tc, connectSubscribePublish);
+    tcase_add_test(tc, subscribeWildcard);
+    tcase_add_test(tc, publishThroughput);
     suite_add_tcase(s, tc);
 
     SRunner *sr = srunner_create(s);
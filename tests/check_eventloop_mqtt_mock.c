@@ -0,0 +1,491 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/plugin/eventloop.h>
+#include <open62541/plugin/log_stdout.h>
+#include "open62541/types.h"
+#include "open62541/types_generated.h"
+
+/* The MQTT ConnectionManager runs on top of a mocked TCP ConnectionManager.
+ * The packets of the broker are injected and the sent packets are recorded.
+ * So no broker is required. */
+
+#include <stdlib.h>
+#include <check.h>
+
+typedef struct {
+    UA_ConnectionManager cm;
+
+    /* The single TCP connection to the "broker" */
+    UA_ConnectionManager_connectionCallback callback;
+    void *application;
+    void *context;
+    UA_ConnectionState state;
+    UA_DelayedCallback dc;
+
+    /* Recorded sends */
+    size_t sendCount;
+    UA_ByteString sent;
+} MockTCP;
+
+static UA_StatusCode
+mockStart(UA_EventSource *es) {
+    es->state = UA_EVENTSOURCESTATE_STARTED;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+mockStop(UA_EventSource *es) {
+    MockTCP *m = (MockTCP*)es;
+    es->state = (m->state == UA_CONNECTIONSTATE_CLOSED) ?
+        UA_EVENTSOURCESTATE_STOPPED : UA_EVENTSOURCESTATE_STOPPING;
+}
+
+static UA_StatusCode
+mockFree(UA_EventSource *es) {
+    MockTCP *m = (MockTCP*)es;
+    UA_ByteString_clear(&m->sent);
+    UA_String_clear(&es->name);
+    UA_free(m);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+mockOpenConnection(UA_ConnectionManager *cm, const UA_KeyValueMap *params,
+                   void *application, void *context,
+                   UA_ConnectionManager_connectionCallback connectionCallback) {
+    MockTCP *m = (MockTCP*)cm;
+    const UA_Boolean *validate = (const UA_Boolean*)
+        UA_KeyValueMap_getScalar(params, UA_QUALIFIEDNAME(0, "validate"),
+                                 &UA_TYPES[UA_TYPES_BOOLEAN]);
+    if(validate && *validate)
+        return UA_STATUSCODE_GOOD;
+    ck_assert(m->state == UA_CONNECTIONSTATE_CLOSED);
+    m->callback = connectionCallback;
+    m->application = application;
+    m->context = context;
+    m->state = UA_CONNECTIONSTATE_OPENING;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+mockSendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
+                       const UA_KeyValueMap *params, UA_ByteString *buf) {
+    MockTCP *m = (MockTCP*)cm;
+    ck_assert(m->state == UA_CONNECTIONSTATE_ESTABLISHED);
+    UA_Byte *sent = (UA_Byte*)UA_realloc(m->sent.data, m->sent.length + buf->length);
+    ck_assert(sent != NULL);
+    memcpy(&sent[m->sent.length], buf->data, buf->length);
+    m->sent.data = sent;
+    m->sent.length += buf->length;
+    m->sendCount++;
+    UA_ByteString_clear(buf);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+mockAllocNetworkBuffer(UA_ConnectionManager *cm, uintptr_t connectionId,
+                       UA_ByteString *buf, size_t bufSize) {
+    return UA_ByteString_allocBuffer(buf, bufSize);
+}
+
+static void
+mockFreeNetworkBuffer(UA_ConnectionManager *cm, uintptr_t connectionId,
+                      UA_ByteString *buf) {
+    UA_ByteString_clear(buf);
+}
+
+static void
+mockCloseDelayed(void *application, void *context) {
+    MockTCP *m = (MockTCP*)context;
+    m->state = UA_CONNECTIONSTATE_CLOSED;
+    m->callback(&m->cm, 1, m->application, &m->context,
+                UA_CONNECTIONSTATE_CLOSED, &UA_KEYVALUEMAP_NULL, UA_BYTESTRING_NULL);
+    if(m->cm.eventSource.state == UA_EVENTSOURCESTATE_STOPPING)
+        m->cm.eventSource.state = UA_EVENTSOURCESTATE_STOPPED;
+}
+
+static UA_StatusCode
+mockCloseConnection(UA_ConnectionManager *cm, uintptr_t connectionId) {
+    MockTCP *m = (MockTCP*)cm;
+    if(m->state == UA_CONNECTIONSTATE_CLOSING ||
+       m->state == UA_CONNECTIONSTATE_CLOSED)
+        return UA_STATUSCODE_GOOD;
+    m->state = UA_CONNECTIONSTATE_CLOSING;
+    m->dc.callback = mockCloseDelayed;
+    m->dc.application = NULL;
+    m->dc.context = m;
+    UA_EventLoop *el = cm->eventSource.eventLoop;
+    el->addDelayedCallback(el, &m->dc);
+    return UA_STATUSCODE_GOOD;
+}
+
+static MockTCP *
+newMockTCP(void) {
+    MockTCP *m = (MockTCP*)UA_calloc(1, sizeof(MockTCP));
+    ck_assert(m != NULL);
+    m->cm.eventSource.eventSourceType = UA_EVENTSOURCETYPE_CONNECTIONMANAGER;
+    m->cm.eventSource.name = UA_STRING_ALLOC("tcpMock");
+    m->cm.eventSource.start = mockStart;
+    m->cm.eventSource.stop = mockStop;
+    m->cm.eventSource.free = mockFree;
+    m->cm.protocol = UA_STRING("tcp");
+    m->cm.openConnection = mockOpenConnection;
+    m->cm.sendWithConnection = mockSendWithConnection;
+    m->cm.allocNetworkBuffer = mockAllocNetworkBuffer;
+    m->cm.freeNetworkBuffer = mockFreeNetworkBuffer;
+    m->cm.closeConnection = mockCloseConnection;
+    m->state = UA_CONNECTIONSTATE_CLOSED;
+    return m;
+}
+
+/* Inject a packet received from the broker */
+static void
+mockReceive(MockTCP *m, const UA_Byte *data, size_t length) {
+    UA_ByteString msg = {length, (UA_Byte*)(uintptr_t)data};
+    m->callback(&m->cm, 1, m->application, &m->context,
+                UA_CONNECTIONSTATE_ESTABLISHED, &UA_KEYVALUEMAP_NULL, msg);
+}
+
+/* Inject an acknowledgement (PUBACK, PUBREC, PUBCOMP, ...) of the broker */
+static void
+mockReceiveAck(MockTCP *m, UA_Byte type, UA_UInt16 packetId) {
+    UA_Byte packet[4] = {(UA_Byte)(type << 4), 2,
+                         (UA_Byte)(packetId >> 8), (UA_Byte)packetId};
+    mockReceive(m, packet, 4);
+}
+
+/* The TCP connection to the broker opens and the broker accepts the CONNECT
+ * packet */
+static void
+mockEstablish(MockTCP *m) {
+    m->state = UA_CONNECTIONSTATE_ESTABLISHED;
+    m->callback(&m->cm, 1, m->application, &m->context,
+                UA_CONNECTIONSTATE_ESTABLISHED, &UA_KEYVALUEMAP_NULL,
+                UA_BYTESTRING_NULL);
+    mockReceiveAck(m, 2, 0); /* CONNACK */
+}
+
+/* Inject a QoS 0 PUBLISH packet of the broker */
+static void
+mockReceivePublish(MockTCP *m, const char *topic, const char *payload) {
+    size_t topicLen = strlen(topic);
+    size_t payloadLen = strlen(payload);
+    size_t remaining = 2 + topicLen + payloadLen;
+    ck_assert_uint_lt(remaining, 128); /* One byte for the remaining length */
+    UA_Byte packet[130];
+    packet[0] = 0x30;
+    packet[1] = (UA_Byte)remaining;
+    packet[2] = (UA_Byte)(topicLen >> 8);
+    packet[3] = (UA_Byte)topicLen;
+    memcpy(&packet[4], topic, topicLen);
+    memcpy(&packet[4 + topicLen], payload, payloadLen);
+    mockReceive(m, packet, 2 + remaining);
+}
+
+/* Count the sent packets of a control packet type. The packet ids of the
+ * matching packets are written into ids (if not NULL). */
+static size_t
+countSentPackets(const MockTCP *m, UA_Byte type, UA_UInt16 *ids, size_t idsSize) {
+    size_t count = 0;
+    size_t pos = 0;
+    while(pos < m->sent.length) {
+        const UA_Byte *p = &m->sent.data[pos];
+        size_t remaining = 0;
+        size_t shift = 0;
+        size_t i = 1;
+        do {
+            remaining += (size_t)(p[i] & 0x7f) << shift;
+            shift += 7;
+        } while(p[i++] & 0x80);
+        if((p[0] >> 4) == type) {
+            /* The packet id follows the topic of PUBLISH packets (QoS > 0)
+             * and starts the variable header of the other packets */
+            size_t idPos = i;
+            if(type == 3)
+                idPos += 2 + (size_t)((p[i] << 8) | p[i+1]);
+            if(ids && count < idsSize)
+                ids[count] = (UA_UInt16)((p[idPos] << 8) | p[idPos+1]);
+            count++;
+        }
+        pos += i + remaining;
+    }
+    return count;
+}
+
+typedef struct {
+    uintptr_t connectionId;
+    size_t received;
+    UA_Boolean closed;
+} TopicContext;
+
+static void
+connectionCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
+                   void *application, void **connectionContext,
+                   UA_ConnectionState status,
+                   const UA_KeyValueMap *params,
+                   UA_ByteString msg) {
+    TopicContext *ctx = *(TopicContext**)connectionContext;
+    ctx->connectionId = connectionId;
+    if(status == UA_CONNECTIONSTATE_CLOSING)
+        ctx->closed = true;
+    else if(msg.length > 0)
+        ctx->received++;
+}
+
+static UA_StatusCode
+openTopicConnection(UA_ConnectionManager *mcm, const char *topic,
+                    UA_Boolean subscribe, UA_Byte qos, UA_UInt16 maxInflight,
+                    TopicContext *ctx) {
+    UA_String address = UA_STRING("localhost");
+    UA_String topicStr = UA_STRING((char*)(uintptr_t)topic);
+    UA_KeyValuePair params[5];
+    params[0].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[0].value, &address, &UA_TYPES[UA_TYPES_STRING]);
+    params[1].key = UA_QUALIFIEDNAME(0, "topic");
+    UA_Variant_setScalar(&params[1].value, &topicStr, &UA_TYPES[UA_TYPES_STRING]);
+    params[2].key = UA_QUALIFIEDNAME(0, "subscribe");
+    UA_Variant_setScalar(&params[2].value, &subscribe, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    params[3].key = UA_QUALIFIEDNAME(0, "qos");
+    UA_Variant_setScalar(&params[3].value, &qos, &UA_TYPES[UA_TYPES_BYTE]);
+    params[4].key = UA_QUALIFIEDNAME(0, "max-inflight");
+    UA_Variant_setScalar(&params[4].value, &maxInflight, &UA_TYPES[UA_TYPES_UINT16]);
+    UA_KeyValueMap kvm = {5, params};
+    memset(ctx, 0, sizeof(TopicContext));
+    return mcm->openConnection(mcm, &kvm, NULL, ctx, connectionCallback);
+}
+
+#define TOPIC_FILTERS 8
+
+static UA_EventLoop *el;
+static MockTCP *tcp;
+static UA_ConnectionManager *mcm;
+
+/* The contexts are used until the connections are closed in the teardown */
+static TopicContext ctx[TOPIC_FILTERS];
+
+static void
+setup(void) {
+    el = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    tcp = newMockTCP();
+    mcm = UA_ConnectionManager_new_MQTT(UA_STRING("mqttCM"));
+    el->registerEventSource(el, &tcp->cm.eventSource);
+    el->registerEventSource(el, &mcm->eventSource);
+    el->start(el);
+}
+
+static void
+teardown(void) {
+    el->stop(el);
+    for(size_t i = 0; i < 10 && el->state != UA_EVENTLOOPSTATE_STOPPED; i++)
+        el->run(el, 1);
+    ck_assert(el->state == UA_EVENTLOOPSTATE_STOPPED);
+    el->free(el);
+    el = NULL;
+}
+
+/* Dispatch received messages through the trie of topic filters */
+START_TEST(topicFilterMatching) {
+    const char *filters[TOPIC_FILTERS] = {
+        "a/b/c", "a/+/c", "a/#", "#", "+/b/c", "a/b/c/#", "$SYS/#", "+/+"
+    };
+
+    /* Subscribe before and after the broker connection is established */
+    for(size_t i = 0; i < 4; i++) {
+        UA_StatusCode res = openTopicConnection(mcm, filters[i], true, 0, 0, &ctx[i]);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+    mockEstablish(tcp);
+    for(size_t i = 4; i < TOPIC_FILTERS; i++) {
+        UA_StatusCode res = openTopicConnection(mcm, filters[i], true, 0, 0, &ctx[i]);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+    el->run(el, 0);
+    ck_assert_uint_eq(countSentPackets(tcp, 1, NULL, 0), 1); /* CONNECT */
+    ck_assert_uint_eq(countSentPackets(tcp, 8, NULL, 0), TOPIC_FILTERS); /* SUBSCRIBE */
+
+    /* The topic and the subscriptions that receive the message */
+    const struct {
+        const char *topic;
+        const char *receivers;
+    } cases[] = {
+        {"a/b/c", "a/b/c a/+/c a/# # +/b/c a/b/c/#"},
+        {"a/x/c", "a/+/c a/# #"},
+        {"a", "a/# #"},              /* '#' also matches the parent level */
+        {"a/b", "a/# # +/+"},
+        {"a/b/c/d/e", "a/# # a/b/c/#"},
+        {"b/b/c", "# +/b/c"},
+        {"$SYS/x", "$SYS/#"},        /* No root wildcards for '$' topics */
+        {"$SYS", "$SYS/#"},
+        {"x/$SYS", "# +/+"}          /* '$' only matters on the first level */
+    };
+
+    for(size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        size_t before[TOPIC_FILTERS];
+        for(size_t i = 0; i < TOPIC_FILTERS; i++)
+            before[i] = ctx[i].received;
+        mockReceivePublish(tcp, cases[c].topic, "payload");
+        for(size_t i = 0; i < TOPIC_FILTERS; i++) {
+            /* Look up the filter as a whole word in the receivers */
+            size_t len = strlen(filters[i]);
+            const char *r = cases[c].receivers;
+            UA_Boolean expected = false;
+            while((r = strstr(r, filters[i]))) {
+                if((r == cases[c].receivers || r[-1] == ' ') &&
+                   (r[len] == ' ' || r[len] == 0)) {
+                    expected = true;
+                    break;
+                }
+                r++;
+            }
+            ck_assert_msg(ctx[i].received - before[i] == (expected ? 1 : 0),
+                          "Topic \"%s\" on filter \"%s\"",
+                          cases[c].topic, filters[i]);
+        }
+    }
+
+    /* Removing a subscription prunes the trie. The other subscriptions are
+     * not affected. */
+    mcm->closeConnection(mcm, ctx[2].connectionId);   /* a/# */
+    mcm->closeConnection(mcm, ctx[5].connectionId);   /* a/b/c/# */
+    el->run(el, 0);
+    ck_assert(ctx[2].closed && ctx[5].closed);
+    ck_assert_uint_eq(countSentPackets(tcp, 10, NULL, 0), 2); /* UNSUBSCRIBE */
+    size_t received[TOPIC_FILTERS];
+    for(size_t i = 0; i < TOPIC_FILTERS; i++)
+        received[i] = ctx[i].received;
+    mockReceivePublish(tcp, "a/b/c/d", "payload");
+    mockReceivePublish(tcp, "a/b/c", "payload");
+    ck_assert_uint_eq(ctx[0].received, received[0] + 1); /* a/b/c */
+    ck_assert_uint_eq(ctx[1].received, received[1] + 1); /* a/+/c */
+    ck_assert_uint_eq(ctx[2].received, received[2]);
+    ck_assert_uint_eq(ctx[3].received, received[3] + 2); /* # */
+    ck_assert_uint_eq(ctx[5].received, received[5]);
+} END_TEST
+
+/* Invalid topic filters are rejected before anything is sent */
+START_TEST(invalidTopicFilters) {
+    UA_StatusCode res = openTopicConnection(mcm, "keep/open", true, 0, 0, &ctx[0]);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    mockEstablish(tcp);
+
+    const char *invalid[] = {"a/b#", "a/#/b", "a+/b", "", "++"};
+    for(size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        res = openTopicConnection(mcm, invalid[i], true, 0, 0, &ctx[1]);
+        ck_assert_uint_ne(res, UA_STATUSCODE_GOOD);
+    }
+
+    /* No wildcards for publishing */
+    res = openTopicConnection(mcm, "a/+", false, 0, 0, &ctx[1]);
+    ck_assert_uint_ne(res, UA_STATUSCODE_GOOD);
+
+    el->run(el, 0);
+    ck_assert_uint_eq(countSentPackets(tcp, 8, NULL, 0), 1);
+} END_TEST
+
+static UA_StatusCode
+publish(uintptr_t connectionId) {
+    UA_ByteString msg = UA_BYTESTRING_ALLOC("open62541-msg");
+    return mcm->sendWithConnection(mcm, connectionId, &UA_KEYVALUEMAP_NULL, &msg);
+}
+
+#define BATCH_MESSAGES 50
+
+/* The messages published during an EventLoop iteration are sent out together
+ * with a single TCP send */
+START_TEST(publishBatching) {
+    UA_StatusCode res = openTopicConnection(mcm, "batch", false, 0, 0, &ctx[0]);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    mockEstablish(tcp);
+    el->run(el, 0);
+    size_t sendCount = tcp->sendCount;
+
+    for(size_t round = 1; round <= 3; round++) {
+        for(size_t i = 0; i < BATCH_MESSAGES; i++)
+            ck_assert_uint_eq(publish(ctx[0].connectionId), UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(tcp->sendCount, sendCount + round - 1); /* Not yet sent */
+        el->run(el, 0);
+        ck_assert_uint_eq(tcp->sendCount, sendCount + round);
+        ck_assert_uint_eq(countSentPackets(tcp, 3, NULL, 0), BATCH_MESSAGES * round);
+    }
+} END_TEST
+
+#define INFLIGHT_WINDOW 4
+
+/* QoS 1/2 messages are dropped while the window of unacknowledged messages is
+ * full. The connection remains open and publishing continues once the broker
+ * acknowledges. Runs for QoS 1 and QoS 2. */
+START_TEST(publishQoSWindow) {
+    UA_Byte qos = (UA_Byte)(_i + 1);
+    UA_StatusCode res =
+        openTopicConnection(mcm, "qos", false, qos, INFLIGHT_WINDOW, &ctx[0]);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = openTopicConnection(mcm, "qos0", false, 0, 0, &ctx[1]);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    mockEstablish(tcp);
+    el->run(el, 0);
+
+    for(size_t i = 0; i < INFLIGHT_WINDOW; i++)
+        ck_assert_uint_eq(publish(ctx[0].connectionId), UA_STATUSCODE_GOOD);
+    el->run(el, 0);
+
+    /* The window is full. The message is dropped, QoS 0 is not affected. */
+    ck_assert_uint_eq(publish(ctx[0].connectionId),
+                      UA_STATUSCODE_BADRESOURCEUNAVAILABLE);
+    el->run(el, 0);
+    ck_assert(!ctx[0].closed);
+    ck_assert_uint_eq(tcp->state, UA_CONNECTIONSTATE_ESTABLISHED);
+
+    /* Acknowledge the PUBLISH packets as they are sent out. Only one QoS 2
+     * message is sent at a time. QoS 2 needs PUBREC and (after the PUBREL of
+     * the client) PUBCOMP. */
+    UA_UInt16 ids[INFLIGHT_WINDOW];
+    size_t acked = 0;
+    while(acked < INFLIGHT_WINDOW) {
+        size_t sent = countSentPackets(tcp, 3, ids, INFLIGHT_WINDOW);
+        ck_assert_uint_gt(sent, acked);
+        ck_assert_uint_le(sent, INFLIGHT_WINDOW);
+        for(; acked < sent; acked++) {
+            mockReceiveAck(tcp, (qos == 1) ? 4 : 5, ids[acked]);
+            if(qos == 2) {
+                UA_UInt16 relIds[INFLIGHT_WINDOW];
+                size_t rel = countSentPackets(tcp, 6, relIds, INFLIGHT_WINDOW);
+                ck_assert_uint_eq(rel, acked + 1); /* PUBREL */
+                mockReceiveAck(tcp, 7, relIds[acked]);
+            }
+        }
+        el->run(el, 0);
+    }
+    ck_assert_uint_eq(countSentPackets(tcp, 3, NULL, 0), INFLIGHT_WINDOW);
+
+    /* The window is open again */
+    ck_assert_uint_eq(publish(ctx[0].connectionId), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(publish(ctx[1].connectionId), UA_STATUSCODE_GOOD);
+    el->run(el, 0);
+    ck_assert_uint_eq(countSentPackets(tcp, 3, NULL, 0), INFLIGHT_WINDOW + 2);
+    ck_assert(!ctx[0].closed && !ctx[1].closed);
+} END_TEST
+
+int main(void) {
+    Suite *s  = suite_create("Test MQTT EventLoop with a mocked TCP connection");
+    TCase *tc = tcase_create("Topic filters");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, topicFilterMatching);
+    tcase_add_test(tc, invalidTopicFilters);
+    suite_add_tcase(s, tc);
+
+    TCase *tc_publish = tcase_create("Publishing");
+    tcase_add_checked_fixture(tc_publish, setup, teardown);
+    tcase_add_test(tc_publish, publishBatching);
+    tcase_add_loop_test(tc_publish, publishQoSWindow, 0, 2);
+    suite_add_tcase(s, tc_publish);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all (sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,273 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/certificategroup_default.h>
+#include <open62541/plugin/create_certificate.h>
+#include <open62541/plugin/log_stdout.h>
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "test_helpers.h"
+#include "testing_clock.h"
+
+static char baseFolder[] = "/tmp/open62541_certfoldersXXXXXX";
+static char trustFolder[256];
+static char issuerFolder[256];
+static char revocationFolder[256];
+#ifdef UA_ENABLE_CERT_REJECTED_DIR
+static char rejectedFolder[256];
+#endif
+
+static UA_ByteString certA;
+static UA_ByteString certB;
+static UA_CertificateGroup certGroup;
+
+/* Count the verifications answered from the cache */
+static size_t cacheHits;
+
+static void
+countingLog(void *context, UA_LogLevel level, UA_LogCategory category,
+            const char *msg, va_list args) {
+    if(strstr(msg, "cached certificate verification") != NULL)
+        cacheHits++;
+}
+
+static UA_Logger countingLogger = {countingLog, NULL, NULL};
+
+static void
+createCertificate(const char *cn, UA_ByteString *cert) {
+    UA_String subject[2] = {UA_STRING_STATIC("O=open62541"), UA_STRING(NULL)};
+    char cnBuf[64];
+    snprintf(cnBuf, sizeof(cnBuf), "CN=%s", cn);
+    subject[1] = UA_STRING(cnBuf);
+    UA_String subjectAltName[1] = {UA_STRING_STATIC("URI:urn:open62541.unit.test")};
+    UA_KeyValueMap *kvm = UA_KeyValueMap_new();
+    UA_UInt16 keyLength = 2048;
+    UA_KeyValueMap_setScalar(kvm, UA_QUALIFIEDNAME(0, "key-size-bits"),
+                             (void *)&keyLength, &UA_TYPES[UA_TYPES_UINT16]);
+    UA_ByteString key = UA_BYTESTRING_NULL;
+    UA_StatusCode res =
+        UA_CreateCertificate(UA_Log_Stdout, subject, 2, subjectAltName, 1,
+                             UA_CERTIFICATEFORMAT_DER, kvm, &key, cert);
+    UA_KeyValueMap_delete(kvm);
+    UA_ByteString_clear(&key);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void
+writeFile(const char *folder, const char *name, const UA_ByteString *data) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", folder, name);
+    FILE *f = fopen(path, "wb");
+    ck_assert(f != NULL);
+    ck_assert_uint_eq(fwrite(data->data, 1, data->length, f), data->length);
+    fclose(f);
+}
+
+static void
+removeFile(const char *folder, const char *name) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", folder, name);
+    ck_assert_int_eq(unlink(path), 0);
+}
+
+static void setup(void) {
+    ck_assert(mkdtemp(baseFolder) != NULL);
+    snprintf(trustFolder, sizeof(trustFolder), "%s/trusted", baseFolder);
+    snprintf(issuerFolder, sizeof(issuerFolder), "%s/issuer", baseFolder);
+    snprintf(revocationFolder, sizeof(revocationFolder), "%s/crl", baseFolder);
+    ck_assert_int_eq(mkdir(trustFolder, 0700), 0);
+    ck_assert_int_eq(mkdir(issuerFolder, 0700), 0);
+    ck_assert_int_eq(mkdir(revocationFolder, 0700), 0);
+
+    createCertificate("A", &certA);
+    createCertificate("B", &certB);
+    writeFile(trustFolder, "a.der", &certA);
+
+    memset(&certGroup, 0, sizeof(UA_CertificateGroup));
+    certGroup.logging = &countingLogger;
+    cacheHits = 0;
+#ifdef UA_ENABLE_CERT_REJECTED_DIR
+    snprintf(rejectedFolder, sizeof(rejectedFolder), "%s/rejected", baseFolder);
+    ck_assert_int_eq(mkdir(rejectedFolder, 0700), 0);
+    UA_StatusCode res =
+        UA_CertificateVerification_CertFolders(&certGroup, trustFolder, issuerFolder,
+                                               revocationFolder, rejectedFolder);
+#else
+    UA_StatusCode res =
+        UA_CertificateVerification_CertFolders(&certGroup, trustFolder, issuerFolder,
+                                               revocationFolder);
+#endif
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void teardown(void) {
+    certGroup.clear(&certGroup);
+    UA_ByteString_clear(&certA);
+    UA_ByteString_clear(&certB);
+    char cmd[512];
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", baseFolder);
+    ck_assert_int_eq(system(cmd), 0);
+    memcpy(baseFolder + strlen(baseFolder) - 6, "XXXXXX", 6);
+}
+
+START_TEST(reloadOnFolderChange) {
+    ck_assert_uint_eq(certGroup.verifyCertificate(&certGroup, &certA),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_ne(certGroup.verifyCertificate(&certGroup, &certB),
+                      UA_STATUSCODE_GOOD);
+
+    /* Trust B */
+    writeFile(trustFolder, "b.der", &certB);
+    ck_assert_uint_eq(certGroup.verifyCertificate(&certGroup, &certB),
+                      UA_STATUSCODE_GOOD);
+
+    /* Remove A from the trust list */
+    removeFile(trustFolder, "a.der");
+    ck_assert_uint_ne(certGroup.verifyCertificate(&certGroup, &certA),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(certGroup.verifyCertificate(&certGroup, &certB),
+                      UA_STATUSCODE_GOOD);
+} END_TEST
+
+START_TEST(keepListsOnFailedReload) {
+    ck_assert_uint_eq(certGroup.verifyCertificate(&certGroup, &certA),
+                      UA_STATUSCODE_GOOD);
+
+    /* The trust folder cannot be read. The reload fails and is retried. */
+    char cmd[512];
+    snprintf(cmd, sizeof(cmd), "mv %s %s.tmp", trustFolder, trustFolder);
+    ck_assert_int_eq(system(cmd), 0);
+    ck_assert_uint_ne(certGroup.verifyCertificate(&certGroup, &certB),
+                      UA_STATUSCODE_GOOD);
+
+    /* The folder is back. The certificates are reloaded although the content
+     * has not changed since the last successful load. */
+    snprintf(cmd, sizeof(cmd), "mv %s.tmp %s", trustFolder, trustFolder);
+    ck_assert_int_eq(system(cmd), 0);
+    ck_assert_uint_eq(certGroup.verifyCertificate(&certGroup, &certA),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_ne(certGroup.verifyCertificate(&certGroup, &certB),
+                      UA_STATUSCODE_GOOD);
+} END_TEST
+
+START_TEST(folderCheckInterval) {
+    ck_assert_uint_eq(UA_CertificateVerification_setFolderCheckInterval(&certGroup,
+                                                                         3600000.0),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_ne(certGroup.verifyCertificate(&certGroup, &certB),
+                      UA_STATUSCODE_GOOD);
+
+    /* The change is not picked up before the interval has passed */
+    writeFile(trustFolder, "b.der", &certB);
+    ck_assert_uint_ne(certGroup.verifyCertificate(&certGroup, &certB),
+                      UA_STATUSCODE_GOOD);
+
+    ck_assert_uint_eq(UA_CertificateVerification_setFolderCheckInterval(&certGroup,
+                                                                         0.0),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(certGroup.verifyCertificate(&certGroup, &certB),
+                      UA_STATUSCODE_GOOD);
+} END_TEST
+
+START_TEST(cacheDisabledByDefault) {
+    ck_assert_uint_eq(certGroup.verifyCertificate(&certGroup, &certA),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(certGroup.verifyCertificate(&certGroup, &certA),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(cacheHits, 0);
+} END_TEST
+
+START_TEST(cacheHit) {
+    ck_assert_uint_eq(UA_CertificateVerification_setVerificationCacheMaxAge(&certGroup,
+                                                                             60000.0),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(certGroup.verifyCertificate(&certGroup, &certA),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(cacheHits, 0);
+    ck_assert_uint_eq(certGroup.verifyCertificate(&certGroup, &certA),
+                      UA_STATUSCODE_GOOD);
+#if UA_LOGLEVEL <= 200 /* The cache hits are logged at debug level */
+    ck_assert_uint_eq(cacheHits, 1);
+#endif
+} END_TEST
+
+START_TEST(cacheNoFailures) {
+    ck_assert_uint_eq(UA_CertificateVerification_setVerificationCacheMaxAge(&certGroup,
+                                                                             60000.0),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_ne(certGroup.verifyCertificate(&certGroup, &certB),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_ne(certGroup.verifyCertificate(&certGroup, &certB),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(cacheHits, 0);
+
+    /* Trusted right away */
+    writeFile(trustFolder, "b.der", &certB);
+    ck_assert_uint_eq(certGroup.verifyCertificate(&certGroup, &certB),
+                      UA_STATUSCODE_GOOD);
+} END_TEST
+
+START_TEST(cacheExpiry) {
+    ck_assert_uint_eq(UA_CertificateVerification_setVerificationCacheMaxAge(&certGroup,
+                                                                             20.0),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(certGroup.verifyCertificate(&certGroup, &certA),
+                      UA_STATUSCODE_GOOD);
+    UA_realSleep(50);
+    ck_assert_uint_eq(certGroup.verifyCertificate(&certGroup, &certA),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(cacheHits, 0);
+} END_TEST
+
+START_TEST(cacheInvalidatedOnReload) {
+    ck_assert_uint_eq(UA_CertificateVerification_setVerificationCacheMaxAge(&certGroup,
+                                                                             60000.0),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(certGroup.verifyCertificate(&certGroup, &certA),
+                      UA_STATUSCODE_GOOD);
+
+    /* A is no longer trusted after the reload */
+    writeFile(trustFolder, "b.der", &certB);
+    removeFile(trustFolder, "a.der");
+    ck_assert_uint_ne(certGroup.verifyCertificate(&certGroup, &certA),
+                      UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(cacheHits, 0);
+} END_TEST
+
+static Suite *testSuite_certificategroup_folders(void) {
+    TCase *tc = tcase_create("Certificate folders");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, reloadOnFolderChange);
+    tcase_add_test(tc, keepListsOnFailedReload);
+    tcase_add_test(tc, folderCheckInterval);
+
+    TCase *tc_cache = tcase_create("Verification cache");
+    tcase_add_checked_fixture(tc_cache, setup, teardown);
+    tcase_add_test(tc_cache, cacheDisabledByDefault);
+    tcase_add_test(tc_cache, cacheHit);
+    tcase_add_test(tc_cache, cacheNoFailures);
+    tcase_add_test(tc_cache, cacheExpiry);
+    tcase_add_test(tc_cache, cacheInvalidatedOnReload);
+
+    Suite *s = suite_create("Certificate group folders");
+    suite_add_tcase(s, tc);
+    suite_add_tcase(s, tc_cache);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_certificategroup_folders();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,215 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/client.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <open62541/plugin/certificategroup_default.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+#include "certificates.h"
+#include "check.h"
+#include "testing_clock.h"
+#include "thread_wrapper.h"
+
+#define WORKERS 2
+#define CLIENTS 5
+
+UA_Server *server;
+UA_Boolean running;
+THREAD_HANDLE server_thread;
+THREAD_HANDLE workers[WORKERS];
+MUTEX_HANDLE jobsMutex;
+size_t jobsDone;
+
+THREAD_CALLBACK(serverloop) {
+    while(running)
+        UA_Server_run_iterate(server, true);
+    return 0;
+}
+
+THREAD_CALLBACK(workerloop) {
+    while(running) {
+        if(UA_Server_runAsyncCryptoJob(server)) {
+            MUTEX_LOCK(jobsMutex);
+            jobsDone++;
+            MUTEX_UNLOCK(jobsMutex);
+            continue;
+        }
+        UA_realSleep(1);
+    }
+    return 0;
+}
+
+static void setup(void) {
+    running = true;
+    jobsDone = 0;
+    MUTEX_INIT(jobsMutex);
+
+    UA_ByteString certificate;
+    certificate.length = CERT_DER_LENGTH;
+    certificate.data = CERT_DER_DATA;
+
+    UA_ByteString privateKey;
+    privateKey.length = KEY_DER_LENGTH;
+    privateKey.data = KEY_DER_DATA;
+
+    server = UA_Server_newForUnitTestWithSecurityPolicies(4840, &certificate, &privateKey,
+                                                          NULL, 0, NULL, 0, NULL, 0);
+    ck_assert(server != NULL);
+
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_CertificateVerification_AcceptAll(&config->secureChannelPKI);
+    UA_CertificateVerification_AcceptAll(&config->sessionPKI);
+    config->asyncSecureChannelCrypto = true;
+
+    /* Set the ApplicationUri used in the certificate */
+    UA_String_clear(&config->applicationDescription.applicationUri);
+    config->applicationDescription.applicationUri =
+        UA_STRING_ALLOC("urn:unconfigured:application");
+
+    UA_Server_run_startup(server);
+    THREAD_CREATE(server_thread, serverloop);
+    for(size_t i = 0; i < WORKERS; i++)
+        THREAD_CREATE(workers[i], workerloop);
+}
+
+static void teardown(void) {
+    running = false;
+    for(size_t i = 0; i < WORKERS; i++)
+        THREAD_JOIN(workers[i]);
+    THREAD_JOIN(server_thread);
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+    MUTEX_DESTROY(jobsMutex);
+}
+
+static UA_Client *
+newEncryptedClient(const char *policyUri) {
+    UA_ByteString certificate;
+    certificate.length = CERT_DER_LENGTH;
+    certificate.data = CERT_DER_DATA;
+
+    UA_ByteString privateKey;
+    privateKey.length = KEY_DER_LENGTH;
+    privateKey.data = KEY_DER_DATA;
+
+    UA_Client *client = UA_Client_newForUnitTest();
+    ck_assert(client != NULL);
+    UA_ClientConfig *cc = UA_Client_getConfig(client);
+    UA_ClientConfig_setDefaultEncryption(cc, certificate, privateKey,
+                                         NULL, 0, NULL, 0);
+    cc->certificateVerification.clear(&cc->certificateVerification);
+    UA_CertificateVerification_AcceptAll(&cc->certificateVerification);
+    cc->securityPolicyUri = UA_STRING_ALLOC(policyUri);
+    cc->securityMode = UA_MESSAGESECURITYMODE_SIGNANDENCRYPT;
+    return client;
+}
+
+static void
+readState(UA_Client *client) {
+    UA_Variant val;
+    UA_Variant_init(&val);
+    UA_NodeId nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_STATE);
+    UA_StatusCode retval = UA_Client_readValueAttribute(client, nodeId, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Variant_clear(&val);
+}
+
+START_TEST(asyncCrypto_connect) {
+    for(size_t i = 0; i < CLIENTS; i++) {
+        UA_Client *client =
+            newEncryptedClient("http://opcfoundation.org/UA/SecurityPolicy#Basic256Sha256");
+        UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        readState(client);
+        UA_Client_disconnect(client);
+        UA_Client_delete(client);
+    }
+
+    /* Decrypting the request and encrypting the response for every channel */
+    MUTEX_LOCK(jobsMutex);
+    ck_assert_uint_eq(jobsDone, 2 * CLIENTS);
+    MUTEX_UNLOCK(jobsMutex);
+} END_TEST
+
+START_TEST(asyncCrypto_connectParallel) {
+    UA_Client *clients[CLIENTS];
+    for(size_t i = 0; i < CLIENTS; i++) {
+        clients[i] =
+            newEncryptedClient("http://opcfoundation.org/UA/SecurityPolicy#Aes256_Sha256_RsaPss");
+        UA_StatusCode retval = UA_Client_connectAsync(clients[i], "opc.tcp://localhost:4840");
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    /* Drive the clients until all sessions are activated */
+    UA_Boolean done = false;
+    for(size_t round = 0; round < 1000 && !done; round++) {
+        done = true;
+        for(size_t i = 0; i < CLIENTS; i++) {
+            UA_SessionState ss;
+            UA_StatusCode status;
+            UA_Client_run_iterate(clients[i], 1);
+            UA_Client_getState(clients[i], NULL, &ss, &status);
+            ck_assert_uint_eq(status, UA_STATUSCODE_GOOD);
+            if(ss != UA_SESSIONSTATE_ACTIVATED)
+                done = false;
+        }
+    }
+    ck_assert(done);
+
+    for(size_t i = 0; i < CLIENTS; i++) {
+        readState(clients[i]);
+        UA_Client_disconnect(clients[i]);
+        UA_Client_delete(clients[i]);
+    }
+} END_TEST
+
+START_TEST(asyncCrypto_renew) {
+    UA_Client *client =
+        newEncryptedClient("http://opcfoundation.org/UA/SecurityPolicy#Basic256Sha256");
+    UA_ClientConfig *cc = UA_Client_getConfig(client);
+    cc->secureChannelLifeTime = 1000; /* Renew after 750ms */
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* The renewal is processed in the server thread */
+    for(size_t i = 0; i < 5; i++) {
+        UA_fakeSleep(300);
+        readState(client);
+    }
+
+    MUTEX_LOCK(jobsMutex);
+    ck_assert_uint_eq(jobsDone, 2);
+    MUTEX_UNLOCK(jobsMutex);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
+static Suite* testSuite_asyncCrypto(void) {
+    Suite *s = suite_create("Async SecureChannel Crypto");
+    TCase *tc = tcase_create("Offload to workers");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, asyncCrypto_connect);
+    tcase_add_test(tc, asyncCrypto_connectParallel);
+    tcase_add_test(tc, asyncCrypto_renew);
+    suite_add_tcase(s,tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_asyncCrypto();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,288 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/client.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <open62541/plugin/accesscontrol_default.h>
+#include <open62541/plugin/certificategroup_default.h>
+#include <open62541/plugin/create_certificate.h>
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/plugin/securitypolicy.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+
+#include "client/ua_client_internal.h"
+#include "ua_server_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "certificates.h"
+#include "test_helpers.h"
+#include "check.h"
+#include "testing_clock.h"
+#include "thread_wrapper.h"
+
+#define ECC_POLICY_URI "http://opcfoundation.org/UA/SecurityPolicy#ECC_nistP256"
+#define RSA_POLICY_URI "http://opcfoundation.org/UA/SecurityPolicy#Basic256Sha256"
+
+UA_Server *server;
+UA_Boolean running;
+THREAD_HANDLE server_thread;
+
+/* Certificate with a key on the NIST P-256 curve. Used by server and client. */
+UA_ByteString certificate;
+UA_ByteString privateKey;
+
+static UA_UsernamePasswordLogin usernamePasswords[1] = {
+    {UA_STRING_STATIC("user1"), UA_STRING_STATIC("password")}};
+
+THREAD_CALLBACK(serverloop) {
+    while(running)
+        UA_Server_run_iterate(server, true);
+    return 0;
+}
+
+static void
+createEccCertificate(void) {
+    UA_String subject[2] = {UA_STRING_STATIC("C=DE"),
+                            UA_STRING_STATIC("CN=open62541@localhost")};
+    UA_String subjectAltName[2] = {UA_STRING_STATIC("DNS:localhost"),
+                                   UA_STRING_STATIC("URI:urn:unconfigured:application")};
+    UA_String keyType = UA_STRING_STATIC("ecc-nistp256");
+    UA_KeyValueMap *kvm = UA_KeyValueMap_new();
+    UA_KeyValueMap_setScalar(kvm, UA_QUALIFIEDNAME(0, "key-type"),
+                             &keyType, &UA_TYPES[UA_TYPES_STRING]);
+    UA_StatusCode res =
+        UA_CreateCertificate(UA_Log_Stdout, subject, 2, subjectAltName, 2,
+                             UA_CERTIFICATEFORMAT_DER, kvm, &privateKey, &certificate);
+    UA_KeyValueMap_delete(kvm);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void setup(void) {
+    running = true;
+    createEccCertificate();
+
+    server = UA_Server_newForUnitTestWithSecurityPolicies(4840, &certificate, &privateKey,
+                                                          NULL, 0, NULL, 0, NULL, 0);
+    ck_assert(server != NULL);
+
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_CertificateVerification_AcceptAll(&config->secureChannelPKI);
+    UA_CertificateVerification_AcceptAll(&config->sessionPKI);
+    UA_AccessControl_default(config, true, NULL, 1, usernamePasswords);
+
+    /* Set the ApplicationUri used in the certificate */
+    UA_String_clear(&config->applicationDescription.applicationUri);
+    config->applicationDescription.applicationUri =
+        UA_STRING_ALLOC("urn:unconfigured:application");
+
+    UA_Server_run_startup(server);
+    THREAD_CREATE(server_thread, serverloop);
+}
+
+/* The RSA policies are added alongside with a separate RSA certificate */
+static void setupWithRsa(void) {
+    running = true;
+    createEccCertificate();
+
+    server = UA_Server_newForUnitTestWithSecurityPolicies(4840, &certificate, &privateKey,
+                                                          NULL, 0, NULL, 0, NULL, 0);
+    ck_assert(server != NULL);
+
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_CertificateVerification_AcceptAll(&config->secureChannelPKI);
+    UA_CertificateVerification_AcceptAll(&config->sessionPKI);
+
+    UA_ByteString rsaCertificate = {CERT_DER_LENGTH, CERT_DER_DATA};
+    UA_ByteString rsaPrivateKey = {KEY_DER_LENGTH, KEY_DER_DATA};
+    UA_StatusCode res =
+        UA_ServerConfig_addSecurityPolicyBasic256Sha256(config, &rsaCertificate,
+                                                        &rsaPrivateKey);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_ServerConfig_addEndpoint(config, UA_STRING(RSA_POLICY_URI),
+                                      UA_MESSAGESECURITYMODE_SIGNANDENCRYPT);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_AccessControl_default(config, true, NULL, 1, usernamePasswords);
+
+    UA_String_clear(&config->applicationDescription.applicationUri);
+    config->applicationDescription.applicationUri =
+        UA_STRING_ALLOC("urn:unconfigured:application");
+
+    UA_Server_run_startup(server);
+    THREAD_CREATE(server_thread, serverloop);
+}
+
+static void teardown(void) {
+    running = false;
+    THREAD_JOIN(server_thread);
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+    UA_ByteString_clear(&certificate);
+    UA_ByteString_clear(&privateKey);
+}
+
+static UA_Client *
+newEccClient(UA_MessageSecurityMode mode) {
+    UA_Client *client = UA_Client_newForUnitTest();
+    ck_assert(client != NULL);
+    UA_ClientConfig *cc = UA_Client_getConfig(client);
+    UA_ClientConfig_setDefaultEncryption(cc, certificate, privateKey,
+                                         NULL, 0, NULL, 0);
+    cc->certificateVerification.clear(&cc->certificateVerification);
+    UA_CertificateVerification_AcceptAll(&cc->certificateVerification);
+    cc->securityPolicyUri = UA_STRING_ALLOC(ECC_POLICY_URI);
+    cc->securityMode = mode;
+    return client;
+}
+
+static void
+readState(UA_Client *client) {
+    UA_Variant val;
+    UA_Variant_init(&val);
+    UA_NodeId nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_STATE);
+    UA_StatusCode retval = UA_Client_readValueAttribute(client, nodeId, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Variant_clear(&val);
+}
+
+START_TEST(ecc_policies) {
+    /* Only the ECC policy (and None) is added for an ECC certificate */
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_String eccUri = UA_STRING(ECC_POLICY_URI);
+    UA_Boolean found = false;
+    for(size_t i = 0; i < config->securityPoliciesSize; i++) {
+        UA_SecurityPolicy *sp = &config->securityPolicies[i];
+        if(UA_String_equal(&sp->policyUri, &eccUri)) {
+            found = true;
+            /* The OPN is only signed */
+            ck_assert(sp->asymmetricModule.cryptoModule.encryptionAlgorithm.encrypt == NULL);
+            continue;
+        }
+        ck_assert(UA_String_equal(&sp->policyUri, &UA_SECURITY_POLICY_NONE_URI));
+    }
+    ck_assert(found);
+}
+END_TEST
+
+START_TEST(ecc_connect_signandencrypt) {
+    UA_Client *client = newEccClient(UA_MESSAGESECURITYMODE_SIGNANDENCRYPT);
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(client->channel.securityMode, UA_MESSAGESECURITYMODE_SIGNANDENCRYPT);
+    readState(client);
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+
+START_TEST(ecc_connect_sign) {
+    UA_Client *client = newEccClient(UA_MESSAGESECURITYMODE_SIGN);
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(client->channel.securityMode, UA_MESSAGESECURITYMODE_SIGN);
+    readState(client);
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+
+/* The renewed SecurityToken uses new ephemeral keys on both sides */
+START_TEST(ecc_renew) {
+    UA_Client *client = newEccClient(UA_MESSAGESECURITYMODE_SIGNANDENCRYPT);
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_UInt32 channelId = client->channel.securityToken.channelId;
+    UA_UInt32 tokenId = client->channel.securityToken.tokenId;
+    UA_ByteString oldNonce;
+    UA_ByteString_copy(&client->channel.localNonce, &oldNonce);
+
+    UA_fakeSleep((UA_UInt32)(client->channel.securityToken.revisedLifetime * 0.8));
+    for(size_t i = 0; i < 10 && tokenId == client->channel.securityToken.tokenId; i++)
+        UA_Client_run_iterate(client, 50);
+
+    ck_assert_uint_eq(channelId, client->channel.securityToken.channelId);
+    ck_assert_uint_ne(tokenId, client->channel.securityToken.tokenId);
+    ck_assert(!UA_ByteString_equal(&oldNonce, &client->channel.localNonce));
+    UA_ByteString_clear(&oldNonce);
+
+    /* Messages are exchanged with the new keys */
+    readState(client);
+    readState(client);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+
+/* UserName tokens are encrypted with the asymmetric algorithm. This is not
+ * available for the ECC policy (EccEncryptedSecret is not supported). */
+START_TEST(ecc_username_rejected) {
+    UA_Client *client = newEccClient(UA_MESSAGESECURITYMODE_SIGNANDENCRYPT);
+    UA_ClientConfig *cc = UA_Client_getConfig(client);
+    UA_ClientConfig_setAuthenticationUsername(cc, "user1", "password");
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_ne(retval, UA_STATUSCODE_GOOD);
+    UA_Client_delete(client);
+}
+END_TEST
+
+START_TEST(ecc_with_rsa_connect) {
+    UA_Client *client = newEccClient(UA_MESSAGESECURITYMODE_SIGNANDENCRYPT);
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    readState(client);
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+
+    /* A client with an RSA certificate uses the RSA policy */
+    client = UA_Client_newForUnitTest();
+    ck_assert(client != NULL);
+    UA_ClientConfig *cc = UA_Client_getConfig(client);
+    UA_ByteString rsaCertificate = {CERT_DER_LENGTH, CERT_DER_DATA};
+    UA_ByteString rsaPrivateKey = {KEY_DER_LENGTH, KEY_DER_DATA};
+    UA_ClientConfig_setDefaultEncryption(cc, rsaCertificate, rsaPrivateKey,
+                                         NULL, 0, NULL, 0);
+    cc->certificateVerification.clear(&cc->certificateVerification);
+    UA_CertificateVerification_AcceptAll(&cc->certificateVerification);
+    cc->securityPolicyUri = UA_STRING_ALLOC(RSA_POLICY_URI);
+    cc->securityMode = UA_MESSAGESECURITYMODE_SIGNANDENCRYPT;
+    retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    readState(client);
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+
+static Suite* testSuite_encryption(void) {
+    Suite *s = suite_create("Encryption");
+    TCase *tc_encryption = tcase_create("Encryption EccNistP256 security policy");
+    tcase_add_checked_fixture(tc_encryption, setup, teardown);
+    tcase_add_test(tc_encryption, ecc_policies);
+    tcase_add_test(tc_encryption, ecc_connect_signandencrypt);
+    tcase_add_test(tc_encryption, ecc_connect_sign);
+    tcase_add_test(tc_encryption, ecc_renew);
+    tcase_add_test(tc_encryption, ecc_username_rejected);
+    suite_add_tcase(s,tc_encryption);
+    TCase *tc_rsa = tcase_create("Encryption EccNistP256 with RSA policies");
+    tcase_add_checked_fixture(tc_rsa, setupWithRsa, teardown);
+    tcase_add_test(tc_rsa, ecc_with_rsa_connect);
+    suite_add_tcase(s,tc_rsa);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_encryption();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
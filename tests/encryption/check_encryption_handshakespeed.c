@@ -0,0 +1,171 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* This test is just to see how fast the SecureChannel and Session handshake is
+ * for the RSA and ECC SecurityPolicies. Every connect runs the OPN exchange
+ * (asymmetric crypto and key derivation) followed by CreateSession and
+ * ActivateSession. The wall time includes both sides, the CPU time is for the
+ * entire process. */
+
+#include <open62541/client.h>
+#include <open62541/client_config_default.h>
+#include <open62541/plugin/certificategroup_default.h>
+#include <open62541/plugin/create_certificate.h>
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdio.h>
+
+#include "test_helpers.h"
+#include "certificates.h"
+#include "thread_wrapper.h"
+
+#define HANDSHAKES 20 /* Number of connects per SecurityPolicy */
+
+UA_Server *server;
+UA_Boolean running;
+THREAD_HANDLE server_thread;
+
+THREAD_CALLBACK(serverloop) {
+    while(running)
+        UA_Server_run_iterate(server, true);
+    return 0;
+}
+
+static void
+startServer(const UA_ByteString *certificate, const UA_ByteString *privateKey) {
+    running = true;
+    server = UA_Server_newForUnitTestWithSecurityPolicies(4840, certificate, privateKey,
+                                                          NULL, 0, NULL, 0, NULL, 0);
+    ck_assert(server != NULL);
+
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_CertificateVerification_AcceptAll(&config->secureChannelPKI);
+    UA_CertificateVerification_AcceptAll(&config->sessionPKI);
+
+    /* Set the ApplicationUri used in the certificate */
+    UA_String_clear(&config->applicationDescription.applicationUri);
+    config->applicationDescription.applicationUri =
+        UA_STRING_ALLOC("urn:unconfigured:application");
+
+    UA_Server_run_startup(server);
+    THREAD_CREATE(server_thread, serverloop);
+}
+
+static void
+stopServer(void) {
+    running = false;
+    THREAD_JOIN(server_thread);
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+static void
+handshakeSpeed(const char *policyUri, const UA_ByteString *certificate,
+               const UA_ByteString *privateKey) {
+    startServer(certificate, privateKey);
+
+    UA_Client *client = UA_Client_newForUnitTest();
+    ck_assert(client != NULL);
+    UA_ClientConfig *cc = UA_Client_getConfig(client);
+    UA_ClientConfig_setDefaultEncryption(cc, *certificate, *privateKey,
+                                         NULL, 0, NULL, 0);
+    cc->certificateVerification.clear(&cc->certificateVerification);
+    UA_CertificateVerification_AcceptAll(&cc->certificateVerification);
+    cc->securityPolicyUri = UA_STRING_ALLOC(policyUri);
+    cc->securityMode = UA_MESSAGESECURITYMODE_SIGNANDENCRYPT;
+
+    /* Warm up. Also fetches the endpoints once. */
+    UA_StatusCode res = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_Client_disconnect(client);
+
+    clock_t begin = clock();
+    UA_DateTime wallBegin = UA_DateTime_nowMonotonic();
+
+    for(size_t i = 0; i < HANDSHAKES; i++) {
+        res |= UA_Client_connect(client, "opc.tcp://localhost:4840");
+        UA_Client_disconnect(client);
+    }
+
+    UA_DateTime wallFinish = UA_DateTime_nowMonotonic();
+    clock_t finish = clock();
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    double cpu = (double)(finish - begin) / CLOCKS_PER_SEC;
+    double wall = (double)(wallFinish - wallBegin) / UA_DATETIME_SEC;
+    printf("%s: %u handshakes, %f ms wall and %f ms cpu per handshake\n",
+           policyUri, (unsigned)HANDSHAKES, wall * 1000.0 / HANDSHAKES,
+           cpu * 1000.0 / HANDSHAKES);
+
+    UA_Client_delete(client);
+    stopServer();
+}
+
+START_TEST(handshakeSpeed_basic256sha256) {
+    UA_ByteString certificate = {CERT_DER_LENGTH, CERT_DER_DATA};
+    UA_ByteString privateKey = {KEY_DER_LENGTH, KEY_DER_DATA};
+    handshakeSpeed("http://opcfoundation.org/UA/SecurityPolicy#Basic256Sha256",
+                   &certificate, &privateKey);
+}
+END_TEST
+
+START_TEST(handshakeSpeed_aes256sha256rsapss) {
+    UA_ByteString certificate = {CERT_DER_LENGTH, CERT_DER_DATA};
+    UA_ByteString privateKey = {KEY_DER_LENGTH, KEY_DER_DATA};
+    handshakeSpeed("http://opcfoundation.org/UA/SecurityPolicy#Aes256_Sha256_RsaPss",
+                   &certificate, &privateKey);
+}
+END_TEST
+
+START_TEST(handshakeSpeed_eccnistp256) {
+    UA_String subject[1] = {UA_STRING_STATIC("CN=open62541@localhost")};
+    UA_String subjectAltName[2] = {UA_STRING_STATIC("DNS:localhost"),
+                                   UA_STRING_STATIC("URI:urn:unconfigured:application")};
+    UA_String keyType = UA_STRING_STATIC("ecc-nistp256");
+    UA_KeyValueMap *kvm = UA_KeyValueMap_new();
+    UA_KeyValueMap_setScalar(kvm, UA_QUALIFIEDNAME(0, "key-type"),
+                             &keyType, &UA_TYPES[UA_TYPES_STRING]);
+    UA_ByteString certificate, privateKey;
+    UA_StatusCode res =
+        UA_CreateCertificate(UA_Log_Stdout, subject, 1, subjectAltName, 2,
+                             UA_CERTIFICATEFORMAT_DER, kvm, &privateKey, &certificate);
+    UA_KeyValueMap_delete(kvm);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    handshakeSpeed("http://opcfoundation.org/UA/SecurityPolicy#ECC_nistP256",
+                   &certificate, &privateKey);
+
+    UA_ByteString_clear(&certificate);
+    UA_ByteString_clear(&privateKey);
+}
+END_TEST
+
+static Suite * handshakespeed_suite (void) {
+    Suite *s = suite_create ("SecureChannel Handshake Speed");
+
+    TCase* tc_handshake = tcase_create ("Connect");
+    tcase_set_timeout(tc_handshake, 60);
+    tcase_add_test (tc_handshake, handshakeSpeed_basic256sha256);
+    tcase_add_test (tc_handshake, handshakeSpeed_aes256sha256rsapss);
+    tcase_add_test (tc_handshake, handshakeSpeed_eccnistp256);
+    suite_add_tcase (s, tc_handshake);
+
+    return s;
+}
+
+int main (void) {
+    int number_failed = 0;
+    Suite *s = handshakespeed_suite();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr,CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed += srunner_ntests_failed (sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,142 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/plugin/securitypolicy_default.h>
+#include <open62541/types.h>
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "certificates.h"
+
+#define DERIVATIONS 100000 /* Number of key derivations for the speed test */
+
+/* P_SHA256 and P_SHA1 test vectors for the TLS 1.2 PRF (without the label
+ * handling). The secret and seed are from the IETF TLS working group. */
+static const UA_Byte secretData[16] = {
+    0x9b, 0xbe, 0x43, 0x6b, 0xa9, 0x40, 0xf0, 0x17,
+    0xb1, 0x76, 0x52, 0x84, 0x9a, 0x71, 0xdb, 0x35};
+
+static const UA_Byte seedData[26] = {
+    't', 'e', 's', 't', ' ', 'l', 'a', 'b', 'e', 'l',
+    0xa0, 0xba, 0x9f, 0x93, 0x6c, 0xda, 0x31, 0x18,
+    0x27, 0xa6, 0xf7, 0x96, 0xff, 0xd5, 0x19, 0x8c};
+
+static const UA_Byte psha256Expected[100] = {
+    0xe3, 0xf2, 0x29, 0xba, 0x72, 0x7b, 0xe1, 0x7b, 0x8d, 0x12, 0x26, 0x20,
+    0x55, 0x7c, 0xd4, 0x53, 0xc2, 0xaa, 0xb2, 0x1d, 0x07, 0xc3, 0xd4, 0x95,
+    0x32, 0x9b, 0x52, 0xd4, 0xe6, 0x1e, 0xdb, 0x5a, 0x6b, 0x30, 0x17, 0x91,
+    0xe9, 0x0d, 0x35, 0xc9, 0xc9, 0xa4, 0x6b, 0x4e, 0x14, 0xba, 0xf9, 0xaf,
+    0x0f, 0xa0, 0x22, 0xf7, 0x07, 0x7d, 0xef, 0x17, 0xab, 0xfd, 0x37, 0x97,
+    0xc0, 0x56, 0x4b, 0xab, 0x4f, 0xbc, 0x91, 0x66, 0x6e, 0x9d, 0xef, 0x9b,
+    0x97, 0xfc, 0xe3, 0x4f, 0x79, 0x67, 0x89, 0xba, 0xa4, 0x80, 0x82, 0xd1,
+    0x22, 0xee, 0x42, 0xc5, 0xa7, 0x2e, 0x5a, 0x51, 0x10, 0xff, 0xf7, 0x01,
+    0x87, 0x34, 0x7b, 0x66};
+
+static const UA_Byte psha1Expected[50] = {
+    0x81, 0x14, 0x29, 0xc0, 0x7b, 0xa1, 0xf6, 0xae, 0xe5, 0x05, 0x9e, 0x60,
+    0x71, 0xff, 0x3e, 0x69, 0xde, 0x62, 0xe7, 0xcd, 0x76, 0x7f, 0xd5, 0x57,
+    0x00, 0x04, 0x2e, 0xc2, 0xfc, 0xd7, 0xdb, 0x6c, 0xa3, 0x14, 0x3c, 0xf3,
+    0xc7, 0x8b, 0xb9, 0x29, 0xc1, 0xae, 0x51, 0xf5, 0x1c, 0xdd, 0x38, 0x04,
+    0xa3, 0xbd};
+
+typedef UA_StatusCode
+(*PolicyConstructor)(UA_SecurityPolicy *policy, const UA_ByteString localCertificate,
+                     const UA_ByteString localPrivateKey, const UA_Logger *logger);
+
+/* Derive keys of different lengths. Also lengths that are not a multiple of
+ * the hash length (the last block is truncated). */
+static void
+checkDerivation(PolicyConstructor ctor, const UA_Byte *expected, size_t expectedLen) {
+    UA_ByteString certificate = {CERT_DER_LENGTH, CERT_DER_DATA};
+    UA_ByteString privateKey = {KEY_DER_LENGTH, KEY_DER_DATA};
+    UA_SecurityPolicy policy;
+    UA_StatusCode res = ctor(&policy, certificate, privateKey, UA_Log_Stdout);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_ByteString secret = {sizeof(secretData), (UA_Byte*)(uintptr_t)secretData};
+    UA_ByteString seed = {sizeof(seedData), (UA_Byte*)(uintptr_t)seedData};
+    size_t lengths[6] = {1, 19, 20, 32, 33, expectedLen};
+    for(size_t i = 0; i < 6; i++) {
+        UA_Byte out[100];
+        memset(out, 0xee, sizeof(out));
+        UA_ByteString outBuf = {lengths[i], out};
+        res = policy.symmetricModule.generateKey(policy.policyContext,
+                                                 &secret, &seed, &outBuf);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert(memcmp(out, expected, lengths[i]) == 0);
+        /* Nothing is written beyond the requested length */
+        if(lengths[i] < sizeof(out))
+            ck_assert_uint_eq(out[lengths[i]], 0xee);
+    }
+
+    policy.clear(&policy);
+}
+
+START_TEST(keyDerivation_psha256) {
+    checkDerivation(UA_SecurityPolicy_Basic256Sha256, psha256Expected,
+                    sizeof(psha256Expected));
+} END_TEST
+
+START_TEST(keyDerivation_psha1) {
+    checkDerivation(UA_SecurityPolicy_Basic256, psha1Expected,
+                    sizeof(psha1Expected));
+} END_TEST
+
+/* Derive the key material of a channel (signing key, encrypting key and IV
+ * for Basic256Sha256) from two 32-byte nonces. This is done for both sides on
+ * every OPN and token renewal. */
+START_TEST(keyDerivation_speed) {
+    UA_ByteString certificate = {CERT_DER_LENGTH, CERT_DER_DATA};
+    UA_ByteString privateKey = {KEY_DER_LENGTH, KEY_DER_DATA};
+    UA_SecurityPolicy policy;
+    UA_StatusCode res = UA_SecurityPolicy_Basic256Sha256(&policy, certificate,
+                                                         privateKey, UA_Log_Stdout);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_Byte localNonce[32], remoteNonce[32], keys[32 + 32 + 16];
+    memset(localNonce, 1, sizeof(localNonce));
+    memset(remoteNonce, 2, sizeof(remoteNonce));
+    UA_ByteString secret = {sizeof(remoteNonce), remoteNonce};
+    UA_ByteString seed = {sizeof(localNonce), localNonce};
+    UA_ByteString out = {sizeof(keys), keys};
+
+    clock_t begin = clock();
+    for(size_t i = 0; i < DERIVATIONS; i++)
+        res |= policy.symmetricModule.generateKey(policy.policyContext,
+                                                  &secret, &seed, &out);
+    clock_t finish = clock();
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    double us = (double)(finish - begin) * 1e6 / CLOCKS_PER_SEC / DERIVATIONS;
+    printf("Basic256Sha256 key derivation: %f us per %u byte key material\n",
+           us, (unsigned)sizeof(keys));
+
+    policy.clear(&policy);
+} END_TEST
+
+static Suite *testSuite_keyderivation(void) {
+    Suite *s = suite_create("Key Derivation");
+    TCase *tc_derive = tcase_create("P_SHA key derivation");
+    tcase_add_test(tc_derive, keyDerivation_psha256);
+    tcase_add_test(tc_derive, keyDerivation_psha1);
+    tcase_add_test(tc_derive, keyDerivation_speed);
+    suite_add_tcase(s, tc_derive);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_keyderivation();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,178 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* This test is just to see how fast the symmetric sign-and-encrypt of the
+ * SecureChannel chunks is. The chunks are processed through the generic
+ * SecurityPolicy interface. */
+
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/plugin/securitypolicy_default.h>
+
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdio.h>
+
+#include "certificates.h"
+
+#define CHUNKSIZE 8192 /* Multiple of the AES block size */
+#define CHUNKS 10000   /* Number of chunks to sign and encrypt */
+
+typedef UA_StatusCode
+(*SecurityPolicyConstructor)(UA_SecurityPolicy *policy,
+                             const UA_ByteString localCertificate,
+                             const UA_ByteString localPrivateKey,
+                             const UA_Logger *logger);
+
+static void
+setKeys(UA_SecurityPolicy *sp, void *cc) {
+    const UA_SecurityPolicyCryptoModule *cm = &sp->symmetricModule.cryptoModule;
+    size_t encKeyLen = cm->encryptionAlgorithm.getLocalKeyLength(cc);
+    size_t sigKeyLen = cm->signatureAlgorithm.getLocalKeyLength(cc);
+    size_t ivLen = cm->encryptionAlgorithm.getRemoteBlockSize(cc);
+
+    UA_Byte buf[64];
+    for(size_t i = 0; i < sizeof(buf); i++)
+        buf[i] = (UA_Byte)i;
+    UA_ByteString encKey = {encKeyLen, buf};
+    UA_ByteString sigKey = {sigKeyLen, buf};
+    UA_ByteString iv = {ivLen, buf};
+
+    UA_StatusCode res = sp->channelModule.setLocalSymEncryptingKey(cc, &encKey);
+    res |= sp->channelModule.setLocalSymSigningKey(cc, &sigKey);
+    res |= sp->channelModule.setLocalSymIv(cc, &iv);
+    res |= sp->channelModule.setRemoteSymEncryptingKey(cc, &encKey);
+    res |= sp->channelModule.setRemoteSymSigningKey(cc, &sigKey);
+    res |= sp->channelModule.setRemoteSymIv(cc, &iv);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void
+symSpeed(SecurityPolicyConstructor constructor) {
+    UA_ByteString certificate = {CERT_DER_LENGTH, CERT_DER_DATA};
+    UA_ByteString privateKey = {KEY_DER_LENGTH, KEY_DER_DATA};
+
+    UA_SecurityPolicy sp;
+    memset(&sp, 0, sizeof(UA_SecurityPolicy));
+    UA_StatusCode res = constructor(&sp, certificate, privateKey, UA_Log_Stdout);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    void *cc = NULL;
+    res = sp.channelModule.newContext(&sp, &certificate, &cc);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    setKeys(&sp, cc);
+
+    const UA_SecurityPolicyCryptoModule *cm = &sp.symmetricModule.cryptoModule;
+    size_t sigLen = cm->signatureAlgorithm.getLocalSignatureSize(cc);
+
+    UA_ByteString chunk;
+    res = UA_ByteString_allocBuffer(&chunk, CHUNKSIZE + sigLen);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    memset(chunk.data, 0xab, chunk.length);
+
+    /* Sign the message and encrypt it in place. In the SecureChannel the
+     * signature is encrypted as well after padding. Here only the message
+     * part is encrypted. */
+    UA_ByteString msg = {CHUNKSIZE, chunk.data};
+    UA_ByteString sig = {sigLen, &chunk.data[CHUNKSIZE]};
+
+    clock_t begin, finish;
+    begin = clock();
+
+    for(size_t i = 0; i < CHUNKS; i++) {
+        sig.length = sigLen;
+        res |= cm->signatureAlgorithm.sign(cc, &msg, &sig);
+        msg.length = CHUNKSIZE;
+        res |= cm->encryptionAlgorithm.encrypt(cc, &msg);
+    }
+
+    finish = clock();
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    double time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+    printf("%.*s: %u chunks of %u bytes signed and encrypted in %f s\n",
+           (int)sp.policyUri.length, (char*)sp.policyUri.data,
+           (unsigned)CHUNKS, (unsigned)CHUNKSIZE, time_spent);
+
+    /* Fused sign-and-encrypt if the SecurityPolicy provides it. The chunk
+     * starts with an unencrypted header of 16 bytes. */
+    if(sp.symmetricModule.signAndEncrypt) {
+        UA_ByteString fused = {CHUNKSIZE + sigLen, chunk.data};
+        begin = clock();
+
+        for(size_t i = 0; i < CHUNKS; i++)
+            res |= sp.symmetricModule.signAndEncrypt(cc, &fused, 16, CHUNKSIZE);
+
+        finish = clock();
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+        time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+        printf("%.*s: %u chunks of %u bytes signed and encrypted (fused) in %f s\n",
+               (int)sp.policyUri.length, (char*)sp.policyUri.data,
+               (unsigned)CHUNKS, (unsigned)CHUNKSIZE, time_spent);
+
+        /* The fused result equals the separate signing and encryption */
+        UA_ByteString separate;
+        res = UA_ByteString_copy(&fused, &separate);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        res = sp.symmetricModule.signAndEncrypt(cc, &fused, 16, CHUNKSIZE);
+        UA_ByteString toSign = {CHUNKSIZE, separate.data};
+        UA_ByteString sepSig = {sigLen, &separate.data[CHUNKSIZE]};
+        UA_ByteString toEncrypt = {separate.length - 16, &separate.data[16]};
+        res |= cm->signatureAlgorithm.sign(cc, &toSign, &sepSig);
+        res |= cm->encryptionAlgorithm.encrypt(cc, &toEncrypt);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert(UA_ByteString_equal(&fused, &separate));
+        UA_ByteString_clear(&separate);
+    }
+
+    /* Roundtrip of a single chunk. The same keys and IV are used for both
+     * directions. */
+    memset(chunk.data, 0xab, CHUNKSIZE);
+    sig.length = sigLen;
+    res = cm->signatureAlgorithm.sign(cc, &msg, &sig);
+    res |= cm->encryptionAlgorithm.encrypt(cc, &msg);
+    res |= cm->encryptionAlgorithm.decrypt(cc, &msg);
+    res |= cm->signatureAlgorithm.verify(cc, &msg, &sig);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(msg.length, CHUNKSIZE);
+    ck_assert_uint_eq(chunk.data[0], 0xab);
+    ck_assert_uint_eq(chunk.data[CHUNKSIZE-1], 0xab);
+
+    UA_ByteString_clear(&chunk);
+    sp.channelModule.deleteContext(cc);
+    sp.clear(&sp);
+}
+
+START_TEST(symSpeed_basic256sha256) {
+    symSpeed(UA_SecurityPolicy_Basic256Sha256);
+}
+END_TEST
+
+START_TEST(symSpeed_aes256sha256rsapss) {
+    symSpeed(UA_SecurityPolicy_Aes256Sha256RsaPss);
+}
+END_TEST
+
+static Suite * symspeed_suite (void) {
+    Suite *s = suite_create ("Symmetric Encryption Speed");
+
+    TCase* tc_sym = tcase_create ("Sign and Encrypt");
+    tcase_add_test (tc_sym, symSpeed_basic256sha256);
+    tcase_add_test (tc_sym, symSpeed_aes256sha256rsapss);
+    suite_add_tcase (s, tc_sym);
+
+    return s;
+}
+
+int main (void) {
+    int number_failed = 0;
+    Suite *s = symspeed_suite();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr,CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed += srunner_ntests_failed (sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,236 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/server.h>
+#include <open62541/server_pubsub.h>
+
+#include "ua_pubsub.h"
+#include <server/ua_server_internal.h>
+
+#include "test_helpers.h"
+
+#include <check.h>
+#include <stdlib.h>
+
+UA_Server *server = NULL;
+UA_NodeId connectionIdentifier, publishedDataSetIdent, dataSetFieldIdent,
+    writerGroupIdent, dataSetWriterIdent, readerGroupIdent, dataSetReaderIdent;
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_Server_run_startup(server);
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(connectionConfig));
+    connectionConfig.name = UA_STRING("UDP-UADP Connection 1");
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL , UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    UA_StatusCode retVal =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionIdentifier);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("PublishedDataSet 1");
+    UA_AddPublishedDataSetResult pdsRes =
+        UA_Server_addPublishedDataSet(server, &pdsConfig, &publishedDataSetIdent);
+    ck_assert_int_eq(pdsRes.addResult, UA_STATUSCODE_GOOD);
+
+    UA_DataSetFieldConfig fieldConfig;
+    memset(&fieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+    fieldConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+    fieldConfig.field.variable.fieldNameAlias = UA_STRING("Server localtime");
+    fieldConfig.field.variable.publishParameters.publishedVariable =
+        UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME);
+    fieldConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_DataSetFieldResult fieldRes =
+        UA_Server_addDataSetField(server, publishedDataSetIdent,
+                                  &fieldConfig, &dataSetFieldIdent);
+    ck_assert_int_eq(fieldRes.result, UA_STATUSCODE_GOOD);
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("WriterGroup 1");
+    writerGroupConfig.publishingInterval = 10;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    retVal = UA_Server_addWriterGroup(server, connectionIdentifier,
+                                      &writerGroupConfig, &writerGroupIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("DataSetWriter 1");
+    retVal = UA_Server_addDataSetWriter(server, writerGroupIdent, publishedDataSetIdent,
+                                        &dataSetWriterConfig, &dataSetWriterIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup 1");
+    retVal = UA_Server_addReaderGroup(server, connectionIdentifier,
+                                      &readerGroupConfig, &readerGroupIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("DataSetReader 1");
+    UA_UInt16 publisherId = 2234;
+    UA_Variant_setScalar(&readerConfig.publisherId, &publisherId,
+                         &UA_TYPES[UA_TYPES_UINT16]);
+    readerConfig.writerGroupId = 100;
+    readerConfig.dataSetWriterId = 62541;
+    retVal = UA_Server_addDataSetReader(server, readerGroupIdent, &readerConfig,
+                                        &dataSetReaderIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+START_TEST(FindAllComponentTypes) {
+    UA_LOCK(&server->serviceMutex);
+    UA_PubSubConnection *c =
+        UA_PubSubConnection_findConnectionbyId(server, connectionIdentifier);
+    ck_assert(c != NULL);
+    ck_assert(UA_NodeId_equal(&c->identifier, &connectionIdentifier));
+
+    UA_PublishedDataSet *pds = UA_PublishedDataSet_findPDSbyId(server, publishedDataSetIdent);
+    ck_assert(pds != NULL);
+    ck_assert(UA_NodeId_equal(&pds->identifier, &publishedDataSetIdent));
+
+    UA_DataSetField *dsf = UA_DataSetField_findDSFbyId(server, dataSetFieldIdent);
+    ck_assert(dsf != NULL);
+    ck_assert(UA_NodeId_equal(&dsf->identifier, &dataSetFieldIdent));
+
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupIdent);
+    ck_assert(wg != NULL);
+    ck_assert_ptr_eq(wg->linkedConnection, c);
+
+    UA_DataSetWriter *dsw = UA_DataSetWriter_findDSWbyId(server, dataSetWriterIdent);
+    ck_assert(dsw != NULL);
+    ck_assert_ptr_eq(dsw->linkedWriterGroup, wg);
+
+    UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, readerGroupIdent);
+    ck_assert(rg != NULL);
+    ck_assert(UA_NodeId_equal(&rg->identifier, &readerGroupIdent));
+
+    UA_DataSetReader *dsr = UA_ReaderGroup_findDSRbyId(server, dataSetReaderIdent);
+    ck_assert(dsr != NULL);
+    ck_assert_ptr_eq(dsr->linkedReaderGroup, rg);
+    UA_UNLOCK(&server->serviceMutex);
+} END_TEST
+
+/* The lookup of an identifier with the wrong component type fails */
+START_TEST(FindWithWrongType) {
+    UA_LOCK(&server->serviceMutex);
+    ck_assert(UA_WriterGroup_findWGbyId(server, connectionIdentifier) == NULL);
+    ck_assert(UA_DataSetWriter_findDSWbyId(server, writerGroupIdent) == NULL);
+    ck_assert(UA_ReaderGroup_findRGbyId(server, dataSetReaderIdent) == NULL);
+    ck_assert(UA_ReaderGroup_findDSRbyId(server, readerGroupIdent) == NULL);
+    ck_assert(UA_PublishedDataSet_findPDSbyId(server, dataSetFieldIdent) == NULL);
+    ck_assert(UA_DataSetField_findDSFbyId(server, publishedDataSetIdent) == NULL);
+    ck_assert(UA_PubSubConnection_findConnectionbyId(server,
+                                                     UA_NODEID_NUMERIC(1, 424242)) == NULL);
+    UA_UNLOCK(&server->serviceMutex);
+} END_TEST
+
+/* Removed components are no longer found. Also for the children that are
+ * removed together with their parent. */
+START_TEST(RemovedComponentsAreNotFound) {
+    UA_StatusCode retVal = UA_Server_removeDataSetReader(server, dataSetReaderIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    retVal = UA_Server_removeDataSetField(server, dataSetFieldIdent).result;
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_LOCK(&server->serviceMutex);
+    ck_assert(UA_ReaderGroup_findDSRbyId(server, dataSetReaderIdent) == NULL);
+    ck_assert(UA_DataSetField_findDSFbyId(server, dataSetFieldIdent) == NULL);
+    ck_assert(UA_ReaderGroup_findRGbyId(server, readerGroupIdent) != NULL);
+    UA_UNLOCK(&server->serviceMutex);
+
+    retVal = UA_Server_removePubSubConnection(server, connectionIdentifier);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    UA_Server_run_iterate(server, false); /* Delayed deletion */
+
+    UA_LOCK(&server->serviceMutex);
+    ck_assert(UA_PubSubConnection_findConnectionbyId(server, connectionIdentifier) == NULL);
+    ck_assert(UA_WriterGroup_findWGbyId(server, writerGroupIdent) == NULL);
+    ck_assert(UA_DataSetWriter_findDSWbyId(server, dataSetWriterIdent) == NULL);
+    ck_assert(UA_ReaderGroup_findRGbyId(server, readerGroupIdent) == NULL);
+    ck_assert(UA_PublishedDataSet_findPDSbyId(server, publishedDataSetIdent) != NULL);
+    UA_UNLOCK(&server->serviceMutex);
+
+    retVal = UA_Server_removePublishedDataSet(server, publishedDataSetIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    UA_LOCK(&server->serviceMutex);
+    ck_assert(UA_PublishedDataSet_findPDSbyId(server, publishedDataSetIdent) == NULL);
+    ck_assert(ZIP_ROOT(&server->pubSubManager.componentIndex) == NULL);
+    UA_UNLOCK(&server->serviceMutex);
+} END_TEST
+
+#define MANY_WRITERGROUPS 200
+
+START_TEST(FindAmongManyComponents) {
+    UA_NodeId wgIds[MANY_WRITERGROUPS];
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("WriterGroup");
+    writerGroupConfig.publishingInterval = 10;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    for(size_t i = 0; i < MANY_WRITERGROUPS; i++) {
+        writerGroupConfig.writerGroupId = (UA_UInt16)(i + 1);
+        UA_StatusCode retVal =
+            UA_Server_addWriterGroup(server, connectionIdentifier,
+                                     &writerGroupConfig, &wgIds[i]);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    }
+
+    /* Remove every second WriterGroup */
+    for(size_t i = 0; i < MANY_WRITERGROUPS; i += 2) {
+        UA_StatusCode retVal = UA_Server_removeWriterGroup(server, wgIds[i]);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    }
+    UA_Server_run_iterate(server, false);
+
+    UA_LOCK(&server->serviceMutex);
+    for(size_t i = 0; i < MANY_WRITERGROUPS; i++) {
+        UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, wgIds[i]);
+        if(i % 2 == 0) {
+            ck_assert(wg == NULL);
+        } else {
+            ck_assert(wg != NULL);
+            ck_assert_uint_eq(wg->config.writerGroupId, i + 1);
+        }
+    }
+    ck_assert(UA_WriterGroup_findWGbyId(server, writerGroupIdent) != NULL);
+    UA_UNLOCK(&server->serviceMutex);
+} END_TEST
+
+int main(void) {
+    TCase *tc_index = tcase_create("PubSub component index");
+    tcase_add_checked_fixture(tc_index, setup, teardown);
+    tcase_add_test(tc_index, FindAllComponentTypes);
+    tcase_add_test(tc_index, FindWithWrongType);
+    tcase_add_test(tc_index, RemovedComponentsAreNotFound);
+    tcase_add_test(tc_index, FindAmongManyComponents);
+
+    Suite *s = suite_create("PubSub component index");
+    suite_add_tcase(s, tc_index);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -14,6 +14,7 @@
 #include "ua_server_internal.h"
 
 #include <check.h>
+#include <stdio.h>
 
 UA_Server *server = NULL;
 
@@ -28,6 +29,90 @@ static void teardown(void) {
     UA_Server_delete(server);
 }
 
+#ifdef UA_ENABLE_PUBSUB_INFORMATIONMODEL
+static UA_Boolean
+nodeExists(const UA_NodeId *nodeId) {
+    const UA_Node *node = UA_NODESTORE_GET(server, nodeId);
+    if(!node)
+        return false;
+    UA_NODESTORE_RELEASE(server, node);
+    return true;
+}
+#endif
+
+/* Encode a configuration with one WriterGroup per PublishedDataSet. The
+ * DataSetWriters reference the PublishedDataSets in reverse order. */
+static UA_ByteString
+encodeBulkConfiguration(size_t count, UA_Boolean duplicateName) {
+    UA_PubSubConfigurationDataType config;
+    UA_PubSubConfigurationDataType_init(&config);
+    config.publishedDataSets = (UA_PublishedDataSetDataType*)
+        UA_Array_new(count, &UA_TYPES[UA_TYPES_PUBLISHEDDATASETDATATYPE]);
+    config.publishedDataSetsSize = count;
+    char name[32];
+    for(size_t i = 0; i < count; i++) {
+        UA_PublishedDataSetDataType *pds = &config.publishedDataSets[i];
+        snprintf(name, sizeof(name), "PDS %u", (unsigned)i);
+        if(duplicateName && i == count - 1)
+            snprintf(name, sizeof(name), "PDS 0");
+        pds->name = UA_STRING_ALLOC(name);
+        UA_ExtensionObject_setValue(&pds->dataSetSource,
+                                    UA_PublishedDataItemsDataType_new(),
+                                    &UA_TYPES[UA_TYPES_PUBLISHEDDATAITEMSDATATYPE]);
+    }
+
+    UA_PubSubConnectionDataType *connection = UA_PubSubConnectionDataType_new();
+    config.connections = connection;
+    config.connectionsSize = 1;
+    connection->name = UA_STRING_ALLOC("UADP Connection 1");
+    connection->enabled = true;
+    connection->transportProfileUri =
+        UA_STRING_ALLOC("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    UA_UInt16 publisherId = 2234;
+    UA_Variant_setScalarCopy(&connection->publisherId, &publisherId,
+                             &UA_TYPES[UA_TYPES_UINT16]);
+    UA_NetworkAddressUrlDataType *address = UA_NetworkAddressUrlDataType_new();
+    address->url = UA_STRING_ALLOC("opc.udp://224.0.0.22:4840/");
+    UA_ExtensionObject_setValue(&connection->address, address,
+                                &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+
+    connection->writerGroups = (UA_WriterGroupDataType*)
+        UA_Array_new(count, &UA_TYPES[UA_TYPES_WRITERGROUPDATATYPE]);
+    connection->writerGroupsSize = count;
+    for(size_t i = 0; i < count; i++) {
+        UA_WriterGroupDataType *wg = &connection->writerGroups[i];
+        snprintf(name, sizeof(name), "WriterGroup %u", (unsigned)i);
+        wg->name = UA_STRING_ALLOC(name);
+        wg->enabled = true;
+        wg->writerGroupId = (UA_UInt16)(i + 1);
+        wg->publishingInterval = 100;
+        UA_ExtensionObject_setValue(&wg->messageSettings,
+                                    UA_UadpWriterGroupMessageDataType_new(),
+                                    &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE]);
+        wg->dataSetWriters = UA_DataSetWriterDataType_new();
+        wg->dataSetWritersSize = 1;
+        snprintf(name, sizeof(name), "DataSetWriter %u", (unsigned)i);
+        wg->dataSetWriters->name = UA_STRING_ALLOC(name);
+        wg->dataSetWriters->dataSetWriterId = (UA_UInt16)(i + 1);
+        snprintf(name, sizeof(name), "PDS %u", (unsigned)(count - 1 - i));
+        wg->dataSetWriters->dataSetName = UA_STRING_ALLOC(name);
+    }
+
+    UA_UABinaryFileDataType binFile;
+    UA_UABinaryFileDataType_init(&binFile);
+    UA_Variant_setScalar(&binFile.body, &config,
+                         &UA_TYPES[UA_TYPES_PUBSUBCONFIGURATIONDATATYPE]);
+    UA_ExtensionObject container;
+    UA_ExtensionObject_setValue(&container, &binFile,
+                                &UA_TYPES[UA_TYPES_UABINARYFILEDATATYPE]);
+    UA_ByteString encoded = UA_BYTESTRING_NULL;
+    UA_StatusCode res = UA_encodeBinary(&container, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT],
+                                        &encoded);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_PubSubConfigurationDataType_clear(&config);
+    return encoded;
+}
+
 START_TEST(AddPublisherUsingBinaryFile) {
     UA_ByteString publisherConfiguration = loadFile("../../tests/pubsub/check_publisher_configuration.bin");
     ck_assert(publisherConfiguration.length > 0);
@@ -98,11 +183,106 @@ START_TEST(AddSubscriberUsingBinaryFile) {
     UA_ByteString_clear(&subscriberConfiguration);
 } END_TEST
 
+START_TEST(AddManyWriterGroupsInBulk) {
+    const size_t count = 50;
+    UA_ByteString configuration = encodeBulkConfiguration(count, false);
+    UA_LOCK(&server->serviceMutex);
+    UA_StatusCode retVal =
+        UA_PubSubManager_loadPubSubConfigFromByteString(server, configuration);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    ck_assert(!server->pubSubManager.bulkApply);
+    ck_assert_uint_eq(server->pubSubManager.publishedDataSetsSize, count);
+
+    UA_PubSubConnection *connection =
+        TAILQ_FIRST(&server->pubSubManager.connections);
+    ck_assert(connection != NULL);
+    size_t writerGroupCount = 0;
+    UA_WriterGroup *writerGroup;
+    LIST_FOREACH(writerGroup, &connection->writerGroups, listEntry) {
+        writerGroupCount++;
+        ck_assert_int_eq(writerGroup->state, UA_PUBSUBSTATE_OPERATIONAL);
+        UA_DataSetWriter *dataSetWriter = LIST_FIRST(&writerGroup->writers);
+        ck_assert(dataSetWriter != NULL);
+        UA_PublishedDataSet *pds =
+            UA_PublishedDataSet_findPDSbyId(server, dataSetWriter->connectedDataSet);
+        ck_assert(pds != NULL);
+        /* "WriterGroup i" uses "PDS count-1-i" */
+        unsigned wgIndex = 0, pdsIndex = 0;
+        ck_assert_int_eq(sscanf((const char*)writerGroup->config.name.data,
+                                "WriterGroup %u", &wgIndex), 1);
+        ck_assert_int_eq(sscanf((const char*)pds->config.name.data,
+                                "PDS %u", &pdsIndex), 1);
+        ck_assert_uint_eq(pdsIndex, count - 1 - wgIndex);
+#ifdef UA_ENABLE_PUBSUB_INFORMATIONMODEL
+        /* The information model representation is added after the bulk apply */
+        ck_assert(nodeExists(&writerGroup->identifier));
+        ck_assert(nodeExists(&dataSetWriter->identifier));
+        ck_assert(nodeExists(&pds->identifier));
+#endif
+    }
+    ck_assert_uint_eq(writerGroupCount, count);
+    UA_UNLOCK(&server->serviceMutex);
+    UA_ByteString_clear(&configuration);
+} END_TEST
+
+START_TEST(RejectDuplicatePublishedDataSetNames) {
+    UA_ByteString configuration = encodeBulkConfiguration(3, true);
+    UA_LOCK(&server->serviceMutex);
+    UA_StatusCode retVal =
+        UA_PubSubManager_loadPubSubConfigFromByteString(server, configuration);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_BADBROWSENAMEDUPLICATED);
+    ck_assert(!server->pubSubManager.bulkApply);
+    ck_assert_uint_eq(server->pubSubManager.publishedDataSetsSize, 0);
+    ck_assert(TAILQ_EMPTY(&server->pubSubManager.connections));
+    UA_UNLOCK(&server->serviceMutex);
+    UA_ByteString_clear(&configuration);
+} END_TEST
+
+#ifdef UA_ENABLE_PUBSUB_INFORMATIONMODEL
+/* The representation of the PublishedDataSets cannot be added without their
+ * parent folder. The PublishedDataSets and the DataSetWriters connected to them
+ * are removed again. The other components remain. */
+START_TEST(RollBackFailedRepresentation) {
+    UA_StatusCode retVal =
+        UA_Server_deleteNode(server, UA_NODEID_NUMERIC(0, UA_NS0ID_PUBLISHSUBSCRIBE_PUBLISHEDDATASETS),
+                             true);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    const size_t count = 3;
+    UA_ByteString configuration = encodeBulkConfiguration(count, false);
+    UA_LOCK(&server->serviceMutex);
+    retVal = UA_PubSubManager_loadPubSubConfigFromByteString(server, configuration);
+    ck_assert_int_ne(retVal, UA_STATUSCODE_GOOD);
+    ck_assert(!server->pubSubManager.bulkApply);
+    ck_assert_uint_eq(server->pubSubManager.publishedDataSetsSize, 0);
+
+    UA_PubSubConnection *connection =
+        TAILQ_FIRST(&server->pubSubManager.connections);
+    ck_assert(connection != NULL);
+    ck_assert(nodeExists(&connection->identifier));
+    size_t writerGroupCount = 0;
+    UA_WriterGroup *writerGroup;
+    LIST_FOREACH(writerGroup, &connection->writerGroups, listEntry) {
+        writerGroupCount++;
+        ck_assert(nodeExists(&writerGroup->identifier));
+        ck_assert(LIST_EMPTY(&writerGroup->writers));
+    }
+    ck_assert_uint_eq(writerGroupCount, count);
+    UA_UNLOCK(&server->serviceMutex);
+    UA_ByteString_clear(&configuration);
+} END_TEST
+#endif
+
 int main(void) {
     TCase *tc_pubsub_file_configuration = tcase_create("File Configuration");
     tcase_add_checked_fixture(tc_pubsub_file_configuration, setup, teardown);
     tcase_add_test(tc_pubsub_file_configuration, AddPublisherUsingBinaryFile);
     tcase_add_test(tc_pubsub_file_configuration, AddSubscriberUsingBinaryFile);
+    tcase_add_test(tc_pubsub_file_configuration, AddManyWriterGroupsInBulk);
+    tcase_add_test(tc_pubsub_file_configuration, RejectDuplicatePublishedDataSetNames);
+#ifdef UA_ENABLE_PUBSUB_INFORMATIONMODEL
+    tcase_add_test(tc_pubsub_file_configuration, RollBackFailedRepresentation);
+#endif
 
     Suite *s = suite_create("PubSub file configuration");
     suite_add_tcase(s, tc_pubsub_file_configuration);
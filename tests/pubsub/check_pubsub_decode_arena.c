@@ -0,0 +1,263 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/server.h>
+#include <open62541/server_pubsub.h>
+
+#include "ua_pubsub.h"
+#include "ua_pubsub_bufmalloc.h"
+#include "ua_pubsub_networkmessage.h"
+#include <server/ua_server_internal.h>
+
+#include "test_helpers.h"
+
+#include <check.h>
+#include <stdlib.h>
+
+UA_Server *server = NULL;
+UA_NodeId connectionIdentifier, readerGroupIdentifier;
+UA_ByteString encodedMessage;
+
+/* Count the heap allocations during the decoding */
+static size_t heapAllocations;
+
+static void *
+countingMalloc(size_t size) {
+    heapAllocations++;
+    return malloc(size);
+}
+
+static void *
+countingCalloc(size_t nelem, size_t elsize) {
+    heapAllocations++;
+    return calloc(nelem, elsize);
+}
+
+static void *
+countingRealloc(void *ptr, size_t size) {
+    heapAllocations++;
+    return realloc(ptr, size);
+}
+
+static void
+useCountingAlloc(void) {
+    heapAllocations = 0;
+    UA_mallocSingleton = countingMalloc;
+    UA_callocSingleton = countingCalloc;
+    UA_reallocSingleton = countingRealloc;
+}
+
+static void
+useDefaultAlloc(void) {
+    UA_mallocSingleton = malloc;
+    UA_callocSingleton = calloc;
+    UA_reallocSingleton = realloc;
+}
+
+/* Encode a NetworkMessage with strings and arrays that need allocations */
+static void
+encodeMessage(void) {
+    UA_NetworkMessage m;
+    memset(&m, 0, sizeof(UA_NetworkMessage));
+    m.version = 1;
+    m.networkMessageType = UA_NETWORKMESSAGE_DATASET;
+    m.publisherIdEnabled = true;
+    m.publisherIdType = UA_PUBLISHERIDTYPE_UINT16;
+    m.publisherId.uint16 = 2234;
+
+    UA_DataSetMessage dsm;
+    memset(&dsm, 0, sizeof(UA_DataSetMessage));
+    dsm.header.dataSetMessageValid = true;
+    dsm.header.fieldEncoding = UA_FIELDENCODING_VARIANT;
+    dsm.header.dataSetMessageType = UA_DATASETMESSAGE_DATAKEYFRAME;
+    UA_DataValue fields[3];
+    dsm.data.keyFrameData.fieldCount = 3;
+    dsm.data.keyFrameData.dataSetFields = fields;
+    for(size_t i = 0; i < 3; i++)
+        UA_DataValue_init(&fields[i]);
+    UA_String str = UA_STRING("A string that is decoded into the arena");
+    UA_Variant_setScalar(&fields[0].value, &str, &UA_TYPES[UA_TYPES_STRING]);
+    UA_UInt32 arr[4] = {1, 2, 3, 4};
+    UA_Variant_setArray(&fields[1].value, arr, 4, &UA_TYPES[UA_TYPES_UINT32]);
+    UA_Double d = 4.2;
+    UA_Variant_setScalar(&fields[2].value, &d, &UA_TYPES[UA_TYPES_DOUBLE]);
+    for(size_t i = 0; i < 3; i++)
+        fields[i].hasValue = true;
+    m.payload.dataSetPayload.dataSetMessages = &dsm;
+
+    size_t msgSize = UA_NetworkMessage_calcSizeBinary(&m, NULL);
+    UA_StatusCode rv = UA_ByteString_allocBuffer(&encodedMessage, msgSize);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    UA_Byte *bufPos = encodedMessage.data;
+    const UA_Byte *bufEnd = &encodedMessage.data[encodedMessage.length];
+    rv = UA_NetworkMessage_encodeBinary(&m, &bufPos, bufEnd, NULL);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+}
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_Server_run_startup(server);
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(connectionConfig));
+    connectionConfig.name = UA_STRING("UDP-UADP Connection 1");
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL , UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    UA_StatusCode retVal =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionIdentifier);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup Test");
+    retVal = UA_Server_addReaderGroup(server, connectionIdentifier,
+                                      &readerGroupConfig, &readerGroupIdentifier);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    encodeMessage();
+}
+
+static void teardown(void) {
+    UA_ByteString_clear(&encodedMessage);
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+static void
+checkDecodedMessage(const UA_NetworkMessage *nm) {
+    ck_assert_uint_eq(nm->publisherId.uint16, 2234);
+    const UA_DataSetMessage *dsm = nm->payload.dataSetPayload.dataSetMessages;
+    ck_assert_uint_eq(dsm->data.keyFrameData.fieldCount, 3);
+    const UA_DataValue *fields = dsm->data.keyFrameData.dataSetFields;
+    UA_String str = UA_STRING("A string that is decoded into the arena");
+    ck_assert(UA_String_equal((UA_String*)fields[0].value.data, &str));
+    ck_assert_uint_eq(fields[1].value.arrayLength, 4);
+    ck_assert_uint_eq(((UA_UInt32*)fields[1].value.data)[3], 4);
+    ck_assert(*(UA_Double*)fields[2].value.data == 4.2);
+}
+
+/* The first message is decoded on the heap. Then the arena has grown and the
+ * following messages are decoded without heap allocations. */
+START_TEST(DecodeWithoutHeapAllocation) {
+    UA_LOCK(&server->serviceMutex);
+    UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, readerGroupIdentifier);
+    ck_assert(rg != NULL);
+
+    for(size_t i = 0; i < 5; i++) {
+        UA_NetworkMessage nm;
+        useCountingAlloc();
+        UA_StatusCode res =
+            UA_ReaderGroup_decodeNetworkMessage(server, rg, &encodedMessage, &nm);
+        size_t decodeAllocations = heapAllocations;
+        useDefaultAlloc();
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+        checkDecodedMessage(&nm);
+        UA_ReaderGroup_releaseNetworkMessage(rg, &nm);
+        if(i == 0)
+            ck_assert_uint_gt(decodeAllocations, 0);
+        else
+            ck_assert_uint_eq(decodeAllocations, 0);
+    }
+    UA_UNLOCK(&server->serviceMutex);
+} END_TEST
+
+/* A message that does not fit into the arena is decoded with heap allocations
+ * for the overflow. They are released correctly. */
+START_TEST(DecodeWithArenaOverflow) {
+    UA_LOCK(&server->serviceMutex);
+    UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, readerGroupIdentifier);
+    ck_assert(rg != NULL);
+
+    /* Size the arena with a first message */
+    UA_NetworkMessage nm;
+    UA_StatusCode res =
+        UA_ReaderGroup_decodeNetworkMessage(server, rg, &encodedMessage, &nm);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_ReaderGroup_releaseNetworkMessage(rg, &nm);
+    size_t arenaSize = rg->decodeArena.size;
+    ck_assert_uint_gt(arenaSize, 0);
+
+    /* Shrink the arena to force the fallback */
+    rg->decodeArena.size = arenaSize / 2;
+    res = UA_ReaderGroup_decodeNetworkMessage(server, rg, &encodedMessage, &nm);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    checkDecodedMessage(&nm);
+    UA_ReaderGroup_releaseNetworkMessage(rg, &nm);
+    ck_assert_uint_ge(rg->decodeArena.size, arenaSize);
+
+    /* Decoding a broken message resets the arena */
+    UA_ByteString broken = {encodedMessage.length / 2, encodedMessage.data};
+    res = UA_ReaderGroup_decodeNetworkMessage(server, rg, &broken, &nm);
+    ck_assert_int_ne(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(rg->decodeArena.pos, 0);
+    UA_UNLOCK(&server->serviceMutex);
+} END_TEST
+
+static size_t fallbackAllocations;
+
+static void *
+failingMalloc(size_t size) {
+    (void)size;
+    fallbackAllocations++;
+    return NULL;
+}
+
+static void *
+failingCalloc(size_t nelem, size_t elsize) {
+    (void)nelem;
+    (void)elsize;
+    fallbackAllocations++;
+    return NULL;
+}
+
+/* Overflowing sizes are forwarded to the previous allocator */
+START_TEST(ArenaAllocOverflow) {
+    UA_PubSubBufArena arena;
+    memset(&arena, 0, sizeof(UA_PubSubBufArena));
+    arena.mem = (UA_Byte*)malloc(256);
+    arena.size = 256;
+
+    fallbackAllocations = 0;
+    UA_mallocSingleton = failingMalloc;
+    UA_callocSingleton = failingCalloc;
+    useArenaAlloc(&arena);
+    void *a = UA_calloc((SIZE_MAX / 8) + 2, 8);
+    void *b = UA_malloc(SIZE_MAX - 4);
+    void *c = UA_calloc(4, 8);
+    useNormalAlloc();
+    useDefaultAlloc();
+
+    ck_assert_uint_eq(fallbackAllocations, 2);
+    ck_assert_ptr_eq(a, NULL);
+    ck_assert_ptr_eq(b, NULL);
+    ck_assert_ptr_ne(c, NULL);
+    ck_assert(((UA_Byte*)c >= arena.mem) && ((UA_Byte*)c < &arena.mem[arena.size]));
+    ck_assert_uint_le(arena.required, arena.size); /* Only c was counted */
+
+    UA_PubSubBufArena_clear(&arena);
+} END_TEST
+
+int main(void) {
+    TCase *tc_arena = tcase_create("PubSub decode arena");
+    tcase_add_checked_fixture(tc_arena, setup, teardown);
+    tcase_add_test(tc_arena, DecodeWithoutHeapAllocation);
+    tcase_add_test(tc_arena, DecodeWithArenaOverflow);
+    tcase_add_test(tc_arena, ArenaAllocOverflow);
+
+    Suite *s = suite_create("PubSub decode arena");
+    suite_add_tcase(s, tc_arena);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
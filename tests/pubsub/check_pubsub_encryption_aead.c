@@ -0,0 +1,475 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/plugin/securitypolicy_default.h>
+#include <open62541/server_pubsub.h>
+#include <open62541/types.h>
+
+#include "ua_pubsub.h"
+#include "test_helpers.h"
+#include "testing_clock.h"
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define AEAD_KEYNONCE_LENGTH 4
+#define AEAD_MESSAGENONCE_LENGTH 12
+#define AEAD_TAG_LENGTH 16
+#define HEADER_LENGTH 24 /* NetworkMessage headers incl. the SecurityHeader */
+
+#define BENCH_MESSAGES 100000
+#define BENCH_PAYLOAD 256 /* Typical RT payload of a few dozen fields */
+
+typedef UA_StatusCode
+(*PolicyConstructor)(UA_PubSubSecurityPolicy *policy, const UA_Logger *logger);
+
+static UA_Byte key[32 + AEAD_KEYNONCE_LENGTH];
+static UA_Byte signingKey[32];
+static UA_Byte messageNonce[AEAD_MESSAGENONCE_LENGTH] = {1, 2, 3, 4, 0, 0, 0, 0, 0, 0, 0, 1};
+
+/* Set up the policy and a channel context with the (constant) test keys */
+static void *
+newPolicyContext(UA_PubSubSecurityPolicy *policy, PolicyConstructor ctor) {
+    UA_StatusCode res = ctor(policy, UA_Log_Stdout);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < sizeof(key); i++)
+        key[i] = (UA_Byte)i;
+
+    UA_SecurityPolicyCryptoModule *cm = &policy->symmetricModule.cryptoModule;
+    size_t sigKeyLen = cm->signatureAlgorithm.getLocalKeyLength(NULL);
+    size_t encKeyLen = cm->encryptionAlgorithm.getLocalKeyLength(NULL);
+    UA_ByteString sk = {sigKeyLen, signingKey};
+    UA_ByteString ek = {encKeyLen, key};
+    UA_ByteString kn = {AEAD_KEYNONCE_LENGTH, &key[encKeyLen]};
+
+    void *ctx = NULL;
+    res = policy->newContext(policy->policyContext, &sk, &ek, &kn, &ctx);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_ByteString nonce = {AEAD_MESSAGENONCE_LENGTH, messageNonce};
+    if(!policy->encryptAndSign)
+        nonce.length = 8; /* Part 14 policies */
+    res = policy->setMessageNonce(ctx, &nonce);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    return ctx;
+}
+
+static void
+deletePolicyContext(UA_PubSubSecurityPolicy *policy, void *ctx) {
+    policy->deleteContext(ctx);
+    policy->clear(policy);
+}
+
+static void
+roundtrip(PolicyConstructor ctor) {
+    UA_PubSubSecurityPolicy policy;
+    void *ctx = newPolicyContext(&policy, ctor);
+    ck_assert(policy.encryptAndSign != NULL);
+    ck_assert(policy.verifyAndDecrypt != NULL);
+
+    UA_Byte data[HEADER_LENGTH + BENCH_PAYLOAD + AEAD_TAG_LENGTH];
+    UA_Byte plain[HEADER_LENGTH + BENCH_PAYLOAD];
+    for(size_t i = 0; i < sizeof(plain); i++)
+        plain[i] = (UA_Byte)(i * 7);
+    memcpy(data, plain, sizeof(plain));
+
+    /* Encrypt in place. The headers remain in plaintext. */
+    UA_ByteString msg = {sizeof(data), data};
+    size_t sigOffset = HEADER_LENGTH + BENCH_PAYLOAD;
+    UA_StatusCode res = policy.encryptAndSign(ctx, &msg, HEADER_LENGTH, sigOffset);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(memcmp(data, plain, HEADER_LENGTH) == 0);
+    ck_assert(memcmp(&data[HEADER_LENGTH], &plain[HEADER_LENGTH], BENCH_PAYLOAD) != 0);
+
+    /* Decrypt in place */
+    UA_Byte copy[sizeof(data)];
+    memcpy(copy, data, sizeof(data));
+    res = policy.verifyAndDecrypt(ctx, &msg, HEADER_LENGTH, sigOffset);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(memcmp(data, plain, sizeof(plain)) == 0);
+
+    /* A modified header is detected */
+    memcpy(data, copy, sizeof(data));
+    data[2] ^= 0x01;
+    res = policy.verifyAndDecrypt(ctx, &msg, HEADER_LENGTH, sigOffset);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADSECURITYCHECKSFAILED);
+
+    /* A modified payload is detected */
+    memcpy(data, copy, sizeof(data));
+    data[HEADER_LENGTH + 10] ^= 0x80;
+    res = policy.verifyAndDecrypt(ctx, &msg, HEADER_LENGTH, sigOffset);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADSECURITYCHECKSFAILED);
+
+    /* A different MessageNonce is detected. Also if only the SenderId
+     * differs. */
+    memcpy(data, copy, sizeof(data));
+    UA_Byte otherNonce[AEAD_MESSAGENONCE_LENGTH] = {1, 2, 3, 4, 0, 0, 0, 0, 0, 0, 0, 2};
+    UA_ByteString nonce = {AEAD_MESSAGENONCE_LENGTH, otherNonce};
+    res = policy.setMessageNonce(ctx, &nonce);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = policy.verifyAndDecrypt(ctx, &msg, HEADER_LENGTH, sigOffset);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADSECURITYCHECKSFAILED);
+
+    memcpy(data, copy, sizeof(data));
+    otherNonce[0] = 2;
+    otherNonce[11] = 1;
+    res = policy.setMessageNonce(ctx, &nonce);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = policy.verifyAndDecrypt(ctx, &msg, HEADER_LENGTH, sigOffset);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADSECURITYCHECKSFAILED);
+
+    /* The eight-byte nonce of the Part 14 policies is rejected */
+    nonce.length = 8;
+    res = policy.setMessageNonce(ctx, &nonce);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADSECURITYCHECKSFAILED);
+
+    /* Sign mode. The tag equals the separate signature. */
+    memcpy(data, plain, sizeof(plain));
+    res = policy.encryptAndSign(ctx, &msg, sigOffset, sigOffset);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(memcmp(data, plain, sizeof(plain)) == 0);
+    UA_ByteString toBeVerified = {sigOffset, data};
+    UA_ByteString signature = {AEAD_TAG_LENGTH, &data[sigOffset]};
+    res = policy.symmetricModule.cryptoModule.signatureAlgorithm.
+        verify(ctx, &toBeVerified, &signature);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    deletePolicyContext(&policy, ctx);
+}
+
+START_TEST(Aes128GcmRoundtrip) {
+    roundtrip(UA_PubSubSecurityPolicy_Aes128Gcm);
+} END_TEST
+
+START_TEST(Aes256GcmRoundtrip) {
+    roundtrip(UA_PubSubSecurityPolicy_Aes256Gcm);
+} END_TEST
+
+START_TEST(ChaCha20Poly1305Roundtrip) {
+    UA_PubSubSecurityPolicy policy;
+    UA_StatusCode res = UA_PubSubSecurityPolicy_ChaCha20Poly1305(&policy, UA_Log_Stdout);
+    if(res == UA_STATUSCODE_BADNOTSUPPORTED)
+        return; /* Not enabled in mbedTLS */
+    policy.clear(&policy);
+    roundtrip(UA_PubSubSecurityPolicy_ChaCha20Poly1305);
+} END_TEST
+
+/* Throughput of the message security in the publish loop. The CTR policy
+ * encrypts the payload and computes a HMAC over the message in two passes. The
+ * AEAD policies do both in one pass. The CPU share is reported for a
+ * WriterGroup publishing at 1 kHz and 10 kHz. */
+static void
+publishLoopSpeed(const char *name, PolicyConstructor ctor) {
+    UA_PubSubSecurityPolicy policy;
+    UA_StatusCode res = ctor(&policy, UA_Log_Stdout);
+    if(res == UA_STATUSCODE_BADNOTSUPPORTED)
+        return;
+    policy.clear(&policy);
+    void *ctx = newPolicyContext(&policy, ctor);
+
+    UA_SecurityPolicyCryptoModule *cm = &policy.symmetricModule.cryptoModule;
+    size_t sigSize = cm->signatureAlgorithm.getLocalSignatureSize(ctx);
+    size_t sigOffset = HEADER_LENGTH + BENCH_PAYLOAD;
+    UA_Byte data[HEADER_LENGTH + BENCH_PAYLOAD + 32];
+    memset(data, 0x5a, sizeof(data));
+    UA_ByteString msg = {sigOffset + sigSize, data};
+
+    clock_t begin = clock();
+    for(UA_UInt32 i = 0; i < BENCH_MESSAGES; i++) {
+        /* Fresh MessageNonce for every message (like publishRT) */
+        UA_ByteString nonce = {AEAD_MESSAGENONCE_LENGTH, messageNonce};
+        if(!policy.encryptAndSign)
+            nonce.length = 8;
+        memcpy(&messageNonce[nonce.length - 4], &i, sizeof(UA_UInt32));
+        res |= policy.setMessageNonce(ctx, &nonce);
+        if(policy.encryptAndSign) {
+            res |= policy.encryptAndSign(ctx, &msg, HEADER_LENGTH, sigOffset);
+        } else {
+            UA_ByteString toBeEncrypted = {BENCH_PAYLOAD, &data[HEADER_LENGTH]};
+            res |= cm->encryptionAlgorithm.encrypt(ctx, &toBeEncrypted);
+            UA_ByteString toBeSigned = {sigOffset, data};
+            UA_ByteString signature = {sigSize, &data[sigOffset]};
+            res |= cm->signatureAlgorithm.sign(ctx, &toBeSigned, &signature);
+        }
+    }
+    clock_t finish = clock();
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    double usPerMsg = (double)(finish - begin) * 1e6 / CLOCKS_PER_SEC / BENCH_MESSAGES;
+    printf("%s: %f us per %u byte message, %.3f%% CPU at 1 kHz, %.3f%% CPU at 10 kHz\n",
+           name, usPerMsg, (unsigned)BENCH_PAYLOAD,
+           usPerMsg / 1000.0 * 100.0, usPerMsg / 100.0 * 100.0);
+
+    deletePolicyContext(&policy, ctx);
+}
+
+START_TEST(PublishLoopSpeed) {
+    publishLoopSpeed("Aes128Ctr (HMAC-SHA256)", UA_PubSubSecurityPolicy_Aes128Ctr);
+    publishLoopSpeed("Aes128Gcm", UA_PubSubSecurityPolicy_Aes128Gcm);
+    publishLoopSpeed("Aes256Gcm", UA_PubSubSecurityPolicy_Aes256Gcm);
+    publishLoopSpeed("ChaCha20Poly1305", UA_PubSubSecurityPolicy_ChaCha20Poly1305);
+} END_TEST
+
+/* A frozen RT WriterGroup is encrypted in place in the network buffer by
+ * publishRT. The subscriber decrypts every message and the MessageNonce
+ * continues after the WriterGroup is recreated with the same key. */
+#define PUBLISHER_ID 2234
+#define WRITER_GROUP_ID 100
+#define DATASET_WRITER_ID 62541
+
+static UA_Server *server;
+static UA_NodeId connectionId, publishedDataSetId, writerGroupId, readerGroupId;
+static UA_NodeId subscribedNodeId;
+static UA_Byte encryptingKey[16];
+static UA_Byte keyNonce[AEAD_KEYNONCE_LENGTH] = {9, 8, 7, 6};
+
+static void
+setupServer(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    config->pubSubConfig.securityPolicies = (UA_PubSubSecurityPolicy*)
+        UA_malloc(sizeof(UA_PubSubSecurityPolicy));
+    config->pubSubConfig.securityPoliciesSize = 1;
+    UA_StatusCode res =
+        UA_PubSubSecurityPolicy_Aes128Gcm(&config->pubSubConfig.securityPolicies[0],
+                                          config->logging);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_Server_run_startup(server);
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(connectionConfig));
+    connectionConfig.name = UA_STRING("UDP-UADP Connection");
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    connectionConfig.enabled = true;
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL, UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.publisherIdType = UA_PUBLISHERIDTYPE_UINT16;
+    connectionConfig.publisherId.uint16 = PUBLISHER_ID;
+    res = UA_Server_addPubSubConnection(server, &connectionConfig, &connectionId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("PDS");
+    res = UA_Server_addPublishedDataSet(server, &pdsConfig, &publishedDataSetId).addResult;
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void
+teardownServer(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+static void
+addWriterGroup(void) {
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_WriterGroupConfig wgConfig;
+    memset(&wgConfig, 0, sizeof(UA_WriterGroupConfig));
+    wgConfig.name = UA_STRING("WriterGroup");
+    wgConfig.publishingInterval = 100;
+    wgConfig.writerGroupId = WRITER_GROUP_ID;
+    wgConfig.rtLevel = UA_PUBSUB_RT_FIXED_SIZE;
+    wgConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    wgConfig.securityMode = UA_MESSAGESECURITYMODE_SIGNANDENCRYPT;
+    wgConfig.securityPolicy = &config->pubSubConfig.securityPolicies[0];
+    UA_UadpWriterGroupMessageDataType wgm;
+    UA_UadpWriterGroupMessageDataType_init(&wgm);
+    wgm.networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    UA_ExtensionObject_setValue(&wgConfig.messageSettings, &wgm,
+                                &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE]);
+    UA_StatusCode res =
+        UA_Server_addWriterGroup(server, connectionId, &wgConfig, &writerGroupId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_ByteString ek = {sizeof(encryptingKey), encryptingKey};
+    UA_ByteString kn = {sizeof(keyNonce), keyNonce};
+    res = UA_Server_setWriterGroupEncryptionKeys(server, writerGroupId, 1,
+                                                 UA_BYTESTRING_NULL, ek, kn);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_DataSetWriterConfig dswConfig;
+    memset(&dswConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dswConfig.name = UA_STRING("DataSetWriter");
+    dswConfig.dataSetWriterId = DATASET_WRITER_ID;
+    UA_NodeId dswId;
+    res = UA_Server_addDataSetWriter(server, writerGroupId, publishedDataSetId,
+                                     &dswConfig, &dswId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_freezeWriterGroupConfiguration(server, writerGroupId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_enableWriterGroup(server, writerGroupId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void
+addReaderGroup(void) {
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_ReaderGroupConfig rgConfig;
+    memset(&rgConfig, 0, sizeof(UA_ReaderGroupConfig));
+    rgConfig.name = UA_STRING("ReaderGroup");
+    rgConfig.securityMode = UA_MESSAGESECURITYMODE_SIGNANDENCRYPT;
+    rgConfig.securityPolicy = &config->pubSubConfig.securityPolicies[0];
+    UA_StatusCode res =
+        UA_Server_addReaderGroup(server, connectionId, &rgConfig, &readerGroupId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_ByteString ek = {sizeof(encryptingKey), encryptingKey};
+    UA_ByteString kn = {sizeof(keyNonce), keyNonce};
+    res = UA_Server_setReaderGroupEncryptionKeys(server, readerGroupId, 1,
+                                                 UA_BYTESTRING_NULL, ek, kn);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+    vAttr.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    res = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, 50002),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                    UA_QUALIFIEDNAME(1, "Subscribed UInt32"),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                    vAttr, NULL, &subscribedNodeId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("DataSetReader");
+    UA_UInt16 publisherId = PUBLISHER_ID;
+    readerConfig.publisherId.type = &UA_TYPES[UA_TYPES_UINT16];
+    readerConfig.publisherId.data = &publisherId;
+    readerConfig.writerGroupId = WRITER_GROUP_ID;
+    readerConfig.dataSetWriterId = DATASET_WRITER_ID;
+    UA_FieldMetaData field;
+    UA_FieldMetaData_init(&field);
+    field.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    field.builtInType = UA_NS0ID_UINT32;
+    field.valueRank = -1;
+    readerConfig.dataSetMetaData.name = UA_STRING("DataSet");
+    readerConfig.dataSetMetaData.fieldsSize = 1;
+    readerConfig.dataSetMetaData.fields = &field;
+    UA_FieldTargetVariable target;
+    memset(&target, 0, sizeof(UA_FieldTargetVariable));
+    target.targetVariable.attributeId = UA_ATTRIBUTEID_VALUE;
+    target.targetVariable.targetNodeId = subscribedNodeId;
+    readerConfig.subscribedDataSet.subscribedDataSetTarget.targetVariablesSize = 1;
+    readerConfig.subscribedDataSet.subscribedDataSetTarget.targetVariables = &target;
+    UA_NodeId readerId;
+    res = UA_Server_addDataSetReader(server, readerGroupId, &readerConfig, &readerId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_enableReaderGroup(server, readerGroupId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static UA_Boolean
+receiveValue(UA_UInt32 expected) {
+    for(size_t i = 0; i < 100; i++) {
+        UA_fakeSleep(50);
+        UA_Server_run_iterate(server, false);
+        UA_Variant value;
+        UA_StatusCode res = UA_Server_readValue(server, subscribedNodeId, &value);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        UA_Boolean eq = (UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_UINT32]) &&
+                         *(UA_UInt32*)value.data == expected);
+        UA_Variant_clear(&value);
+        if(eq)
+            return true;
+    }
+    return false;
+}
+
+/* The counter of the last sent MessageNonce */
+static UA_UInt64
+lastNonceCounter(void) {
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupId);
+    ck_assert(wg != NULL);
+    const UA_NetworkMessage *nm = wg->bufferedMessage.nm;
+    ck_assert_uint_eq(nm->securityHeader.messageNonceSize, AEAD_MESSAGENONCE_LENGTH);
+    const UA_Byte *nonce = nm->securityHeader.messageNonce;
+    /* SenderId (PublisherId) and WriterGroupId */
+    ck_assert_uint_eq(nonce[0] | (nonce[1] << 8), PUBLISHER_ID);
+    ck_assert_uint_eq(nonce[2] | nonce[3], 0);
+    ck_assert_uint_eq(nonce[4] | (nonce[5] << 8), WRITER_GROUP_ID);
+    UA_UInt64 counter = 0;
+    for(size_t i = 0; i < 6; i++)
+        counter |= (UA_UInt64)nonce[6 + i] << (8 * i);
+    return counter;
+}
+
+START_TEST(PublishRTInPlace) {
+    setupServer();
+
+    UA_UInt32 *intValue = UA_UInt32_new();
+    *intValue = 1000;
+    UA_DataValue *dataValue = UA_DataValue_new();
+    UA_Variant_setScalar(&dataValue->value, intValue, &UA_TYPES[UA_TYPES_UINT32]);
+    UA_DataSetFieldConfig dsfConfig;
+    memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+    dsfConfig.field.variable.fieldNameAlias = UA_STRING("Published UInt32");
+    dsfConfig.field.variable.rtValueSource.rtFieldSourceEnabled = true;
+    dsfConfig.field.variable.rtValueSource.staticValueSource = &dataValue;
+    dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_NodeId dsfId;
+    UA_StatusCode res =
+        UA_Server_addDataSetField(server, publishedDataSetId, &dsfConfig, &dsfId).result;
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    addReaderGroup();
+    addWriterGroup();
+
+    /* The template buffer stays in plaintext for the next message */
+    ck_assert(receiveValue(1000));
+    UA_UInt64 counter = lastNonceCounter();
+    *intValue = 2000;
+    ck_assert(receiveValue(2000));
+    UA_UInt64 counter2 = lastNonceCounter();
+    ck_assert(counter2 > counter);
+
+    /* Recreate the WriterGroup with the same key. The nonce counter does not
+     * restart. */
+    res = UA_Server_unfreezeWriterGroupConfiguration(server, writerGroupId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_removeWriterGroup(server, writerGroupId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    addWriterGroup();
+    *intValue = 3000;
+    ck_assert(receiveValue(3000));
+    ck_assert(lastNonceCounter() > counter2);
+
+    teardownServer();
+    UA_DataValue_delete(dataValue);
+} END_TEST
+
+int main(void) {
+    TCase *tc_aead = tcase_create("PubSub AEAD SecurityPolicies");
+    tcase_add_test(tc_aead, Aes128GcmRoundtrip);
+    tcase_add_test(tc_aead, Aes256GcmRoundtrip);
+    tcase_add_test(tc_aead, ChaCha20Poly1305Roundtrip);
+    tcase_add_test(tc_aead, PublishRTInPlace);
+
+    TCase *tc_speed = tcase_create("PubSub message security speed");
+    tcase_set_timeout(tc_speed, 60);
+    tcase_add_test(tc_speed, PublishLoopSpeed);
+
+    Suite *s = suite_create("PubSub AEAD encryption");
+    suite_add_tcase(s, tc_aead);
+    suite_add_tcase(s, tc_speed);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -407,6 +407,99 @@ externalDataWriteCallback(UA_Server *s, const UA_NodeId *sessionId,
     return UA_STATUSCODE_GOOD;
 }
 
+/* The fixed-size message is patched directly in the network buffers of the
+ * ConnectionManager. They are kept between the publish cycles. */
+START_TEST(PublishFixedOffsetsZeroCopy) {
+    ck_assert(addMinimalPubSubConfiguration() == UA_STATUSCODE_GOOD);
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("Demo WriterGroup");
+    writerGroupConfig.publishingInterval = PUBLISH_INTERVAL;
+    writerGroupConfig.enabled = UA_FALSE;
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.rtLevel = UA_PUBSUB_RT_FIXED_SIZE;
+    UA_UadpWriterGroupMessageDataType *wgm = UA_UadpWriterGroupMessageDataType_new();
+    wgm->networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        (UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_SEQUENCENUMBER);
+    writerGroupConfig.messageSettings.content.decoded.data = wgm;
+    writerGroupConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    writerGroupConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    ck_assert(UA_Server_addWriterGroup(server, connectionIdentifier, &writerGroupConfig,
+                                       &writerGroupIdent) == UA_STATUSCODE_GOOD);
+    ck_assert(UA_Server_enableWriterGroup(server, writerGroupIdent) == UA_STATUSCODE_GOOD);
+    UA_UadpWriterGroupMessageDataType_delete(wgm);
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("Test DataSetWriter");
+    dataSetWriterConfig.dataSetWriterId = 62541;
+    UA_DataSetFieldConfig dsfConfig;
+    memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+    UA_UInt32 *intValue = UA_UInt32_new();
+    *intValue = 1000;
+    staticSource1 = UA_DataValue_new();
+    UA_Variant_setScalar(&staticSource1->value, intValue, &UA_TYPES[UA_TYPES_UINT32]);
+    dsfConfig.field.variable.rtValueSource.rtFieldSourceEnabled = UA_TRUE;
+    dsfConfig.field.variable.rtValueSource.staticValueSource = &staticSource1;
+    dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    ck_assert(UA_Server_addDataSetField(server, publishedDataSetIdent, &dsfConfig,
+                                        &dataSetFieldIdent).result == UA_STATUSCODE_GOOD);
+    ck_assert(UA_Server_addDataSetWriter(server, writerGroupIdent, publishedDataSetIdent,
+                                         &dataSetWriterConfig,
+                                         &dataSetWriterIdent) == UA_STATUSCODE_GOOD);
+    ck_assert(UA_Server_freezeWriterGroupConfiguration(server, writerGroupIdent) ==
+              UA_STATUSCODE_GOOD);
+
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupIdent);
+    ck_assert(wg != NULL);
+    UA_Byte *sendBuffers[UA_PUBSUB_RT_SENDBUFFERS];
+    for(size_t i = 0; i < 4; i++) {
+        *intValue = (UA_UInt32)(1000 + i);
+        UA_UInt16 seq = wg->sequenceNumber;
+        while(wg->sequenceNumber == seq)
+            rtEventLoop->run(rtEventLoop, PUBLISH_INTERVAL);
+        ck_assert(!wg->rtZeroCopyDisabled);
+        ck_assert(wg->rtSendChannel != 0);
+
+        /* The buffers are allocated once and reused */
+        for(size_t j = 0; j < UA_PUBSUB_RT_SENDBUFFERS; j++) {
+            ck_assert(wg->rtSendBuffers[j].data != NULL);
+            ck_assert_uint_eq(wg->rtSendBuffers[j].length,
+                              wg->bufferedMessage.buffer.length);
+            if(i == 0)
+                sendBuffers[j] = wg->rtSendBuffers[j].data;
+            ck_assert(sendBuffers[j] == wg->rtSendBuffers[j].data);
+        }
+    }
+
+    /* The last sent buffer contains the current value. The template buffer is
+     * not touched. */
+    size_t last = (wg->rtSendBufferIndex + UA_PUBSUB_RT_SENDBUFFERS - 1) %
+        UA_PUBSUB_RT_SENDBUFFERS;
+    UA_ByteString *sent = &wg->rtSendBuffers[last];
+    UA_UInt32 expected = 1003;
+    size_t valueOffset = 0;
+    for(size_t i = 0; i < wg->bufferedMessage.offsetsSize; i++) {
+        /* Skip the encoding byte of the variant */
+        if(wg->bufferedMessage.offsets[i].contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT)
+            valueOffset = wg->bufferedMessage.offsets[i].offset + 1;
+    }
+    ck_assert_uint_ne(valueOffset, 0);
+    ck_assert(memcmp(&sent->data[valueOffset], &expected, sizeof(UA_UInt32)) == 0);
+    ck_assert(memcmp(&wg->bufferedMessage.buffer.data[valueOffset],
+                     &expected, sizeof(UA_UInt32)) != 0);
+
+    /* The buffers are released when the configuration is unfrozen */
+    ck_assert(UA_Server_unfreezeWriterGroupConfiguration(server, writerGroupIdent) ==
+              UA_STATUSCODE_GOOD);
+    ck_assert(wg->rtSendChannel == 0);
+    for(size_t j = 0; j < UA_PUBSUB_RT_SENDBUFFERS; j++)
+        ck_assert(wg->rtSendBuffers[j].data == NULL);
+} END_TEST
+
 START_TEST(PubSubConfigWithInformationModelRTVariable) {
         ck_assert(addMinimalPubSubConfiguration() == UA_STATUSCODE_GOOD);
         //add a new variable to the information model
@@ -558,6 +651,7 @@ int main(void) {
     tcase_add_test(tc_pubsub_rt_fixed_offsets, PublishSingleFieldWithFixedOffsets);
     tcase_add_test(tc_pubsub_rt_fixed_offsets, PublishPDSWithMultipleFieldsAndFixedOffset);
     tcase_add_test(tc_pubsub_rt_fixed_offsets, PublishSingleFieldInCustomCallback);
+    tcase_add_test(tc_pubsub_rt_fixed_offsets, PublishFixedOffsetsZeroCopy);
 
     Suite *s = suite_create("PubSub RT configuration levels");
     suite_add_tcase(s, tc_pubsub_rt_static_value_source);
@@ -0,0 +1,325 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/server.h>
+#include <open62541/server_pubsub.h>
+
+#include "ua_pubsub.h"
+#include <server/ua_server_internal.h>
+
+#include "test_helpers.h"
+
+#include <check.h>
+#include <stdlib.h>
+
+UA_Server *server = NULL;
+UA_NodeId connectionIdentifier, publishedDataSetIdent, writerGroupIdent,
+    dataSetWriterIdent, variableIdent;
+
+static void
+addUInt32Variable(UA_UInt32 numericId, UA_UInt32 value) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_UINT32]);
+    attr.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_StatusCode retVal =
+        UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, numericId),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "Source"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, NULL);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+}
+
+static void
+addField(UA_UInt32 numericId) {
+    UA_DataSetFieldConfig fieldConfig;
+    memset(&fieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+    fieldConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+    fieldConfig.field.variable.fieldNameAlias = UA_STRING("Source");
+    fieldConfig.field.variable.publishParameters.publishedVariable =
+        UA_NODEID_NUMERIC(1, numericId);
+    fieldConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_DataSetFieldResult res =
+        UA_Server_addDataSetField(server, publishedDataSetIdent, &fieldConfig, NULL);
+    ck_assert_int_eq(res.result, UA_STATUSCODE_GOOD);
+}
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_Server_run_startup(server);
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(connectionConfig));
+    connectionConfig.name = UA_STRING("UDP-UADP Connection 1");
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL , UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    UA_StatusCode retVal =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionIdentifier);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("PublishedDataSet 1");
+    UA_AddPublishedDataSetResult pdsRes =
+        UA_Server_addPublishedDataSet(server, &pdsConfig, &publishedDataSetIdent);
+    ck_assert_int_eq(pdsRes.addResult, UA_STATUSCODE_GOOD);
+
+    addUInt32Variable(1000, 42);
+    variableIdent = UA_NODEID_NUMERIC(1, 1000);
+    addField(1000);
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("WriterGroup 1");
+    writerGroupConfig.publishingInterval = 10;
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    retVal = UA_Server_addWriterGroup(server, connectionIdentifier,
+                                      &writerGroupConfig, &writerGroupIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("DataSetWriter 1");
+    dataSetWriterConfig.dataSetWriterId = 1;
+    dataSetWriterConfig.keyFrameCount = 1;
+    retVal = UA_Server_addDataSetWriter(server, writerGroupIdent, publishedDataSetIdent,
+                                        &dataSetWriterConfig, &dataSetWriterIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+/* Generate a KeyFrame and return the sampled value of the first field */
+static UA_DataValue
+sampleFirstField(void) {
+    UA_DataSetWriter *dsw = UA_DataSetWriter_findDSWbyId(server, dataSetWriterIdent);
+    ck_assert(dsw != NULL);
+    UA_DataSetMessage dsm;
+    UA_StatusCode res = UA_DataSetWriter_generateDataSetMessage(server, &dsm, dsw);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_ge(dsm.data.keyFrameData.fieldCount, 1);
+    UA_DataValue dv;
+    UA_DataValue_copy(&dsm.data.keyFrameData.dataSetFields[0], &dv);
+    UA_DataSetMessage_clear(&dsm);
+    return dv;
+}
+
+START_TEST(WriterConnectedToPublishedDataSet) {
+    UA_LOCK(&server->serviceMutex);
+    UA_DataSetWriter *dsw = UA_DataSetWriter_findDSWbyId(server, dataSetWriterIdent);
+    UA_PublishedDataSet *pds = UA_PublishedDataSet_findPDSbyId(server, publishedDataSetIdent);
+    ck_assert(dsw != NULL);
+    ck_assert_ptr_eq(dsw->connectedPDS, pds);
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* The writer is removed together with the PublishedDataSet */
+    UA_StatusCode res = UA_Server_removePublishedDataSet(server, publishedDataSetIdent);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_LOCK(&server->serviceMutex);
+    ck_assert(UA_DataSetWriter_findDSWbyId(server, dataSetWriterIdent) == NULL);
+    UA_UNLOCK(&server->serviceMutex);
+} END_TEST
+
+START_TEST(SampleResolvedSourceNode) {
+    UA_LOCK(&server->serviceMutex);
+    UA_PublishedDataSet *pds = UA_PublishedDataSet_findPDSbyId(server, publishedDataSetIdent);
+    ck_assert(!pds->sourcesResolved);
+
+    /* The source node is resolved with the first sample */
+    UA_DataValue dv = sampleFirstField();
+    ck_assert(pds->sourcesResolved);
+    ck_assert_uint_eq(server->pubSubManager.boundSourcesSize, 1);
+    ck_assert(TAILQ_FIRST(&pds->fields)->sourceNode != NULL);
+    ck_assert(dv.hasValue);
+    ck_assert_uint_eq(*(UA_UInt32*)dv.value.data, 42);
+    UA_DataValue_clear(&dv);
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* Written values are sampled from the resolved node */
+    UA_UInt32 value = 43;
+    UA_Variant var;
+    UA_Variant_setScalar(&var, &value, &UA_TYPES[UA_TYPES_UINT32]);
+    UA_StatusCode res = UA_Server_writeValue(server, variableIdent, var);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_LOCK(&server->serviceMutex);
+    dv = sampleFirstField();
+    ck_assert_uint_eq(*(UA_UInt32*)dv.value.data, 43);
+    UA_DataValue_clear(&dv);
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* Removing the PublishedDataSet releases the node */
+    res = UA_Server_removePublishedDataSet(server, publishedDataSetIdent);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(server->pubSubManager.boundSourcesSize, 0);
+} END_TEST
+
+START_TEST(InvalidateOnFieldChange) {
+    UA_LOCK(&server->serviceMutex);
+    UA_PublishedDataSet *pds = UA_PublishedDataSet_findPDSbyId(server, publishedDataSetIdent);
+    UA_DataValue dv = sampleFirstField();
+    UA_DataValue_clear(&dv);
+    ck_assert(pds->sourcesResolved);
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* Adding a field releases the resolved nodes */
+    addUInt32Variable(1001, 7);
+    addField(1001);
+    ck_assert(!pds->sourcesResolved);
+    ck_assert_uint_eq(server->pubSubManager.boundSourcesSize, 0);
+
+    /* Both fields are resolved for the next sample */
+    UA_LOCK(&server->serviceMutex);
+    UA_DataValue values[2];
+    memset(values, 0, sizeof(values));
+    UA_PublishedDataSet_sampleValues(server, pds, values);
+    ck_assert_uint_eq(server->pubSubManager.boundSourcesSize, 2);
+    ck_assert_uint_eq(*(UA_UInt32*)values[0].value.data, 42);
+    ck_assert_uint_eq(*(UA_UInt32*)values[1].value.data, 7);
+    UA_DataValue_clear(&values[0]);
+    UA_DataValue_clear(&values[1]);
+    UA_UNLOCK(&server->serviceMutex);
+} END_TEST
+
+START_TEST(ReleaseDeletedSourceNode) {
+    UA_LOCK(&server->serviceMutex);
+    UA_DataValue dv = sampleFirstField();
+    UA_DataValue_clear(&dv);
+    ck_assert_uint_eq(server->pubSubManager.boundSourcesSize, 1);
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* Deleting the node releases the pointer */
+    UA_StatusCode res = UA_Server_deleteNode(server, variableIdent, true);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(server->pubSubManager.boundSourcesSize, 0);
+
+    /* The field falls back to the Read service */
+    UA_LOCK(&server->serviceMutex);
+    UA_PublishedDataSet *pds = UA_PublishedDataSet_findPDSbyId(server, publishedDataSetIdent);
+    UA_PublishedDataSet_sampleValues(server, pds, &dv);
+    ck_assert(dv.hasStatus);
+    ck_assert_uint_eq(dv.status, UA_STATUSCODE_BADNODEIDUNKNOWN);
+    UA_DataValue_clear(&dv);
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* A re-added node is found again */
+    addUInt32Variable(1000, 5);
+    UA_LOCK(&server->serviceMutex);
+    dv = sampleFirstField();
+    ck_assert(dv.hasValue);
+    ck_assert_uint_eq(*(UA_UInt32*)dv.value.data, 5);
+    UA_DataValue_clear(&dv);
+    UA_UNLOCK(&server->serviceMutex);
+} END_TEST
+
+START_TEST(SampleDeltaFrames) {
+    /* DeltaFrames are only sent for more than one field */
+    addUInt32Variable(1001, 7);
+    addField(1001);
+
+    server->config.pubSubConfig.enableDeltaFrames = true;
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("DataSetWriter 2");
+    dataSetWriterConfig.dataSetWriterId = 2;
+    dataSetWriterConfig.keyFrameCount = 10;
+    UA_NodeId deltaWriterIdent;
+    UA_StatusCode res =
+        UA_Server_addDataSetWriter(server, writerGroupIdent, publishedDataSetIdent,
+                                   &dataSetWriterConfig, &deltaWriterIdent);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    /* The first message is a KeyFrame */
+    UA_LOCK(&server->serviceMutex);
+    UA_DataSetWriter *dsw = UA_DataSetWriter_findDSWbyId(server, deltaWriterIdent);
+    UA_DataSetMessage dsm;
+    res = UA_DataSetWriter_generateDataSetMessage(server, &dsm, dsw);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(dsm.header.dataSetMessageType, UA_DATASETMESSAGE_DATAKEYFRAME);
+    ck_assert_uint_eq(dsm.data.keyFrameData.fieldCount, 2);
+    UA_DataSetMessage_clear(&dsm);
+
+    /* Unchanged values are not sent */
+    res = UA_DataSetWriter_generateDataSetMessage(server, &dsm, dsw);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(dsm.header.dataSetMessageType, UA_DATASETMESSAGE_DATADELTAFRAME);
+    ck_assert_uint_eq(dsm.data.deltaFrameData.fieldCount, 0);
+    UA_DataSetMessage_clear(&dsm);
+    UA_UNLOCK(&server->serviceMutex);
+
+    UA_UInt32 value = 44;
+    UA_Variant var;
+    UA_Variant_setScalar(&var, &value, &UA_TYPES[UA_TYPES_UINT32]);
+    res = UA_Server_writeValue(server, variableIdent, var);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    /* The changed value is sent */
+    UA_LOCK(&server->serviceMutex);
+    res = UA_DataSetWriter_generateDataSetMessage(server, &dsm, dsw);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(dsm.header.dataSetMessageType, UA_DATASETMESSAGE_DATADELTAFRAME);
+    ck_assert_uint_eq(dsm.data.deltaFrameData.fieldCount, 1);
+    ck_assert_uint_eq(dsm.data.deltaFrameData.deltaFrameFields[0].fieldIndex, 0);
+    ck_assert_uint_eq(*(UA_UInt32*)dsm.data.deltaFrameData.deltaFrameFields[0].
+                      fieldValue.value.data, 44);
+    UA_DataSetMessage_clear(&dsm);
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* A new field changes the version. The sample arrays of the writer grow
+     * and a KeyFrame is sent. */
+    addUInt32Variable(1002, 8);
+    addField(1002);
+    UA_LOCK(&server->serviceMutex);
+    res = UA_DataSetWriter_generateDataSetMessage(server, &dsm, dsw);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(dsm.header.dataSetMessageType, UA_DATASETMESSAGE_DATAKEYFRAME);
+    ck_assert_uint_eq(dsm.data.keyFrameData.fieldCount, 3);
+    UA_DataSetMessage_clear(&dsm);
+
+    /* The KeyFrame after the version change restarts the KeyFrame counter */
+    res = UA_DataSetWriter_generateDataSetMessage(server, &dsm, dsw);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(dsm.header.dataSetMessageType, UA_DATASETMESSAGE_DATAKEYFRAME);
+    UA_DataSetMessage_clear(&dsm);
+
+    res = UA_DataSetWriter_generateDataSetMessage(server, &dsm, dsw);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(dsm.header.dataSetMessageType, UA_DATASETMESSAGE_DATADELTAFRAME);
+    ck_assert_uint_eq(dsm.data.deltaFrameData.fieldCount, 0);
+    UA_DataSetMessage_clear(&dsm);
+    UA_UNLOCK(&server->serviceMutex);
+} END_TEST
+
+int main(void) {
+    TCase *tc_sources = tcase_create("PubSub publish sources");
+    tcase_add_checked_fixture(tc_sources, setup, teardown);
+    tcase_add_test(tc_sources, WriterConnectedToPublishedDataSet);
+    tcase_add_test(tc_sources, SampleResolvedSourceNode);
+    tcase_add_test(tc_sources, InvalidateOnFieldChange);
+    tcase_add_test(tc_sources, ReleaseDeletedSourceNode);
+    tcase_add_test(tc_sources, SampleDeltaFrames);
+
+    Suite *s = suite_create("PubSub publish sources");
+    suite_add_tcase(s, tc_sources);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
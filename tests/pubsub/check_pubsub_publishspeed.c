@@ -10,6 +10,7 @@
 
 #include "test_helpers.h"
 #include "ua_server_internal.h"
+#include "ua_pubsub_networkmessage.h"
 
 #include <check.h>
 #include <stdio.h>
@@ -83,10 +84,133 @@ START_TEST(PublishSpeedTest) {
 
 } END_TEST
 
+/* Per-cycle cost of updating the fields of a fixed-size message. The field
+ * values are adjacent in memory. So the raw fields are merged into a single
+ * copy. */
+static double
+measureUpdate(UA_NetworkMessageOffsetBuffer *nmob, size_t cycles) {
+    clock_t begin = clock();
+    for(size_t i = 0; i < cycles; i++)
+        UA_NetworkMessage_updateBufferedMessage(nmob);
+    clock_t finish = clock();
+    return (double)(finish - begin) / CLOCKS_PER_SEC * 1e9 / (double)cycles;
+}
+
+static void
+benchmarkOffsetUpdate(size_t fieldCount, UA_Boolean raw) {
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("Benchmark PDS");
+    UA_NodeId pdsId;
+    UA_StatusCode retval =
+        UA_Server_addPublishedDataSet(server, &pdsConfig, &pdsId).addResult;
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Int32 *values = (UA_Int32*)UA_calloc(fieldCount, sizeof(UA_Int32));
+    UA_DataValue *sources = (UA_DataValue*)UA_calloc(fieldCount, sizeof(UA_DataValue));
+    UA_DataValue **sourcePtrs = (UA_DataValue**)UA_calloc(fieldCount, sizeof(UA_DataValue*));
+    ck_assert(values && sources && sourcePtrs);
+    for(size_t i = 0; i < fieldCount; i++) {
+        UA_Variant_setScalar(&sources[i].value, &values[i], &UA_TYPES[UA_TYPES_INT32]);
+        sources[i].value.storageType = UA_VARIANT_DATA_NODELETE;
+        sources[i].hasValue = true;
+        sourcePtrs[i] = &sources[i];
+
+        UA_DataSetFieldConfig dsfConfig;
+        memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+        dsfConfig.field.variable.rtValueSource.rtFieldSourceEnabled = true;
+        dsfConfig.field.variable.rtValueSource.staticValueSource = &sourcePtrs[i];
+        dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+        retval = UA_Server_addDataSetField(server, pdsId, &dsfConfig, NULL).result;
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(writerGroupConfig));
+    writerGroupConfig.name = UA_STRING("Benchmark WriterGroup");
+    writerGroupConfig.publishingInterval = 10;
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.rtLevel = UA_PUBSUB_RT_FIXED_SIZE;
+    UA_UadpWriterGroupMessageDataType *wgm = UA_UadpWriterGroupMessageDataType_new();
+    wgm->networkMessageContentMask = UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER;
+    writerGroupConfig.messageSettings.content.decoded.data = wgm;
+    writerGroupConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    writerGroupConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    UA_NodeId wgId;
+    retval = UA_Server_addWriterGroup(server, connection1, &writerGroupConfig, &wgId);
+    UA_UadpWriterGroupMessageDataType_delete(wgm);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("Benchmark DataSetWriter");
+    dataSetWriterConfig.dataSetWriterId = 62541;
+    if(raw)
+        dataSetWriterConfig.dataSetFieldContentMask = UA_DATASETFIELDCONTENTMASK_RAWDATA;
+    retval = UA_Server_addDataSetWriter(server, wgId, pdsId, &dataSetWriterConfig, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_freezeWriterGroupConfiguration(server, wgId);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* All fields are patched */
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, wgId);
+    UA_NetworkMessageOffsetBuffer *nmob = &wg->bufferedMessage;
+    ck_assert_uint_gt(nmob->patchesSize, 0);
+    ck_assert_uint_eq(nmob->offsetsSize - nmob->dynamicOffsetsSize, fieldCount);
+    if(raw && UA_TYPES[UA_TYPES_INT32].overlayable)
+        ck_assert_uint_eq(nmob->patchesSize, 1);
+
+    /* The current values are found in the buffer */
+    for(size_t i = 0; i < fieldCount; i++)
+        values[i] = (UA_Int32)i;
+    UA_NetworkMessage_updateBufferedMessage(nmob);
+    for(size_t i = 0; i < nmob->patchesSize; i++) {
+        UA_NetworkMessagePatch *p = &nmob->patches[i];
+        if(p->swapSize == 0)
+            ck_assert(memcmp(&nmob->buffer.data[p->offset],
+                             p->source, p->length) == 0);
+    }
+
+    size_t cycles = 1000000 / fieldCount;
+    double patched = measureUpdate(nmob, cycles);
+
+    /* Encode every field for comparison */
+    size_t patchesSize = nmob->patchesSize;
+    nmob->patchesSize = 0;
+    double encoded = measureUpdate(nmob, cycles);
+    nmob->patchesSize = patchesSize;
+
+    printf("%s encoding, %lu fields: %.0f ns per cycle patched, "
+           "%.0f ns per cycle encoded\n", raw ? "raw" : "variant",
+           (unsigned long)fieldCount, patched, encoded);
+
+    retval = UA_Server_unfreezeWriterGroupConfiguration(server, wgId);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_removeWriterGroup(server, wgId);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_removePublishedDataSet(server, pdsId);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_free(sourcePtrs);
+    UA_free(sources);
+    UA_free(values);
+}
+
+START_TEST(OffsetUpdateSpeedTest) {
+    size_t fieldCounts[3] = {100, 1000, 10000};
+    for(size_t i = 0; i < 3; i++) {
+        benchmarkOffsetUpdate(fieldCounts[i], false);
+        benchmarkOffsetUpdate(fieldCounts[i], true);
+    }
+} END_TEST
+
 int main(void) {
     TCase *tc_publishspeed = tcase_create("Speed of the publisher");
     tcase_add_checked_fixture(tc_publishspeed, setup, teardown);
     tcase_add_test(tc_publishspeed, PublishSpeedTest);
+    tcase_add_test(tc_publishspeed, OffsetUpdateSpeedTest);
 
     Suite *s = suite_create("PubSub Speed Test");
     suite_add_tcase(s, tc_publishspeed);
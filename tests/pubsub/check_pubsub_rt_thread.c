@@ -0,0 +1,326 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/server.h>
+#include <open62541/server_pubsub.h>
+#include <open62541/server_config_default.h>
+
+#include "ua_pubsub.h"
+#include <server/ua_server_internal.h>
+
+#include "testing_clock.h"
+#include "test_helpers.h"
+#include "thread_wrapper.h"
+
+#include <check.h>
+
+UA_EventLoop *rtEventLoop = NULL;
+UA_Server *server = NULL;
+UA_NodeId connectionIdentifier, publishedDataSetIdent, writerGroupIdent,
+    readerGroupIdent, pubNodeId, subNodeId;
+UA_DataValue *pubDataValue, *subDataValue;
+
+/* The EventLoop of the PubSubConnection runs in a dedicated thread */
+THREAD_HANDLE rtThread;
+volatile UA_Boolean rtThreadRunning;
+
+THREAD_CALLBACK(rtLoop) {
+    while(rtThreadRunning)
+        rtEventLoop->run(rtEventLoop, 1);
+    return 0;
+}
+
+/* Run the EventLoop (with the real clock) until the subscribed value arrives.
+ * Only wait if the EventLoop runs in the RT thread. */
+static UA_Boolean
+waitForValue(UA_UInt32 expected, UA_Boolean inThread) {
+    UA_DateTime timeout = UA_DateTime_nowMonotonic() + UA_DATETIME_SEC;
+    while(UA_DateTime_nowMonotonic() < timeout) {
+        if(*(volatile UA_UInt32*)subDataValue->value.data == expected)
+            return true;
+        if(inThread)
+            UA_realSleep(1);
+        else
+            rtEventLoop->run(rtEventLoop, 1);
+    }
+    return false;
+}
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_Server_run_startup(server);
+
+    rtEventLoop = UA_EventLoop_new_POSIX(server->config.logging);
+    UA_ConnectionManager *udpCM =
+        UA_ConnectionManager_new_POSIX_UDP(UA_STRING("udp connection manager"));
+    rtEventLoop->registerEventSource(rtEventLoop, (UA_EventSource *)udpCM);
+    rtEventLoop->start(rtEventLoop);
+
+    /* Variables with external value backends for publisher and subscriber */
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_ValueBackend valueBackend;
+    memset(&valueBackend, 0, sizeof(valueBackend));
+    valueBackend.backendType = UA_VALUEBACKENDTYPE_EXTERNAL;
+
+    pubDataValue = UA_DataValue_new();
+    UA_Variant_setScalar(&pubDataValue->value, UA_UInt32_new(),
+                         &UA_TYPES[UA_TYPES_UINT32]);
+    UA_StatusCode retVal =
+        UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, 51000),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "Published UInt32"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, &pubNodeId);
+    valueBackend.backend.external.value = &pubDataValue;
+    retVal |= UA_Server_setVariableNode_valueBackend(server, pubNodeId, valueBackend);
+
+    subDataValue = UA_DataValue_new();
+    UA_Variant_setScalar(&subDataValue->value, UA_UInt32_new(),
+                         &UA_TYPES[UA_TYPES_UINT32]);
+    retVal |= UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, 52000),
+                                        UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                        UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                        UA_QUALIFIEDNAME(1, "Subscribed UInt32"),
+                                        UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                        attr, NULL, &subNodeId);
+    valueBackend.backend.external.value = &subDataValue;
+    retVal |= UA_Server_setVariableNode_valueBackend(server, subNodeId, valueBackend);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+
+    if(rtEventLoop->state != UA_EVENTLOOPSTATE_FRESH &&
+       rtEventLoop->state != UA_EVENTLOOPSTATE_STOPPED) {
+        rtEventLoop->stop(rtEventLoop);
+        while(rtEventLoop->state != UA_EVENTLOOPSTATE_STOPPED) {
+            rtEventLoop->run(rtEventLoop, 100);
+        }
+    }
+
+    UA_Server_delete(server);
+    rtEventLoop->logger = NULL; /* Don't access the logger that was removed with
+                                   the server */
+    rtEventLoop->free(rtEventLoop);
+    rtEventLoop = NULL;
+    server = NULL;
+
+    UA_DataValue_delete(pubDataValue);
+    UA_DataValue_delete(subDataValue);
+}
+
+static void
+addRTPubSubConfiguration(UA_Boolean useRtThread) {
+    /* PubSubConnection with its own EventLoop */
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(connectionConfig));
+    connectionConfig.name = UA_STRING("UDP-UADP Connection 1");
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    connectionConfig.enabled = UA_TRUE;
+    connectionConfig.eventLoop = rtEventLoop;
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL , UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.publisherIdType = UA_PUBLISHERIDTYPE_UINT16;
+    connectionConfig.publisherId.uint16 = 2234;
+    UA_StatusCode retVal =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionIdentifier);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* PublishedDataSet with one field */
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("Demo PDS");
+    retVal = UA_Server_addPublishedDataSet(server, &pdsConfig,
+                                           &publishedDataSetIdent).addResult;
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_DataSetFieldConfig dsfConfig;
+    memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+    dsfConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+    dsfConfig.field.variable.publishParameters.publishedVariable = pubNodeId;
+    dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    dsfConfig.field.variable.rtValueSource.rtInformationModelNode = UA_TRUE;
+    retVal = UA_Server_addDataSetField(server, publishedDataSetIdent,
+                                       &dsfConfig, NULL).result;
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* WriterGroup */
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(writerGroupConfig));
+    writerGroupConfig.name = UA_STRING("WriterGroup Test");
+    writerGroupConfig.rtLevel = UA_PUBSUB_RT_FIXED_SIZE;
+    writerGroupConfig.rtThread = useRtThread;
+    writerGroupConfig.publishingInterval = 2;
+    writerGroupConfig.writerGroupId = 1;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    writerGroupConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    UA_UadpWriterGroupMessageDataType *wgm = UA_UadpWriterGroupMessageDataType_new();
+    wgm->networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    writerGroupConfig.messageSettings.content.decoded.data = wgm;
+    retVal = UA_Server_addWriterGroup(server, connectionIdentifier,
+                                      &writerGroupConfig, &writerGroupIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(dataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("DataSetWriter Test");
+    dataSetWriterConfig.dataSetWriterId = 1;
+    dataSetWriterConfig.keyFrameCount = 10;
+    retVal = UA_Server_addDataSetWriter(server, writerGroupIdent, publishedDataSetIdent,
+                                        &dataSetWriterConfig, NULL);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* ReaderGroup */
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup Test");
+    readerGroupConfig.rtLevel = UA_PUBSUB_RT_FIXED_SIZE;
+    readerGroupConfig.rtThread = useRtThread;
+    retVal = UA_Server_addReaderGroup(server, connectionIdentifier,
+                                      &readerGroupConfig, &readerGroupIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_UadpDataSetReaderMessageDataType *drm = UA_UadpDataSetReaderMessageDataType_new();
+    drm->networkMessageContentMask = wgm->networkMessageContentMask;
+    drm->publishingInterval = writerGroupConfig.publishingInterval;
+    UA_UInt16 publisherIdentifier = 2234;
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("DataSetReader Test");
+    readerConfig.publisherId.type = &UA_TYPES[UA_TYPES_UINT16];
+    readerConfig.publisherId.data = &publisherIdentifier;
+    readerConfig.writerGroupId = 1;
+    readerConfig.dataSetWriterId = 1;
+    readerConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    readerConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPDATASETREADERMESSAGEDATATYPE];
+    readerConfig.messageSettings.content.decoded.data = drm;
+
+    UA_FieldMetaData field;
+    UA_FieldMetaData_init(&field);
+    field.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    field.builtInType = UA_NS0ID_UINT32;
+    field.valueRank = -1; /* scalar */
+    readerConfig.dataSetMetaData.name = UA_STRING("DataSet Test");
+    readerConfig.dataSetMetaData.fieldsSize = 1;
+    readerConfig.dataSetMetaData.fields = &field;
+
+    UA_NodeId readerId;
+    retVal = UA_Server_addDataSetReader(server, readerGroupIdent, &readerConfig, &readerId);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    UA_UadpWriterGroupMessageDataType_delete(wgm);
+    UA_UadpDataSetReaderMessageDataType_delete(drm);
+
+    UA_FieldTargetVariable targetVar;
+    memset(&targetVar, 0, sizeof(targetVar));
+    targetVar.targetVariable.attributeId = UA_ATTRIBUTEID_VALUE;
+    targetVar.targetVariable.targetNodeId = subNodeId;
+    retVal = UA_Server_DataSetReader_createTargetVariables(server, readerId, 1, &targetVar);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    retVal = UA_Server_freezeReaderGroupConfiguration(server, readerGroupIdent);
+    retVal |= UA_Server_freezeWriterGroupConfiguration(server, writerGroupIdent);
+    retVal |= UA_Server_enableWriterGroup(server, writerGroupIdent);
+    retVal |= UA_Server_enableReaderGroup(server, readerGroupIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+}
+
+static void
+removeRTPubSubConfiguration(void) {
+    UA_StatusCode retVal = UA_Server_setWriterGroupDisabled(server, writerGroupIdent);
+    retVal |= UA_Server_setReaderGroupDisabled(server, readerGroupIdent);
+    retVal |= UA_Server_unfreezeWriterGroupConfiguration(server, writerGroupIdent);
+    retVal |= UA_Server_unfreezeReaderGroupConfiguration(server, readerGroupIdent);
+    retVal |= UA_Server_removePubSubConnection(server, connectionIdentifier);
+    retVal |= UA_Server_removePublishedDataSet(server, publishedDataSetIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+}
+
+/* Publishing and receiving continue in the RT thread while the server lock is
+ * held by another thread */
+START_TEST(PublishSubscribeWithoutServerLock) {
+    addRTPubSubConfiguration(true);
+
+    /* The first messages are processed with the lock. They prepare the offset
+     * buffers and move the components to operational. */
+    *(UA_UInt32*)pubDataValue->value.data = 1;
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupIdent);
+    ck_assert(waitForValue(1, false));
+    *(UA_UInt32*)pubDataValue->value.data = 2;
+    ck_assert(waitForValue(2, false));
+
+    ck_assert(wg != NULL);
+    ck_assert(wg->rtLock != NULL);
+    ck_assert(wg->linkedConnection->rtReadLock != NULL);
+
+    rtThreadRunning = true;
+    THREAD_CREATE(rtThread, rtLoop);
+
+    UA_LOCK(&server->serviceMutex);
+    for(UA_UInt32 i = 3; i < 10; i++) {
+        *(volatile UA_UInt32*)pubDataValue->value.data = i;
+        ck_assert(waitForValue(i, true));
+    }
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* Changing the state stops the unlocked processing */
+    ck_assert_int_eq(UA_STATUSCODE_GOOD,
+                     UA_Server_setWriterGroupDisabled(server, writerGroupIdent));
+    ck_assert(wg->rtLock == NULL);
+
+    rtThreadRunning = false;
+    THREAD_JOIN(rtThread);
+
+    removeRTPubSubConfiguration();
+} END_TEST
+
+/* Without the option, the RT callbacks always take the server lock */
+START_TEST(PublishSubscribeWithServerLock) {
+    addRTPubSubConfiguration(false);
+
+    *(UA_UInt32*)pubDataValue->value.data = 1;
+    ck_assert(waitForValue(1, false));
+    *(UA_UInt32*)pubDataValue->value.data = 2;
+    ck_assert(waitForValue(2, false));
+
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupIdent);
+    ck_assert(wg != NULL);
+    ck_assert(wg->rtLock == NULL);
+    ck_assert(wg->linkedConnection->rtReadLock == NULL);
+
+    removeRTPubSubConfiguration();
+} END_TEST
+
+int main(void) {
+    TCase *tc_rt_thread = tcase_create("PubSub RT processing without the server lock");
+    tcase_add_checked_fixture(tc_rt_thread, setup, teardown);
+    tcase_add_test(tc_rt_thread, PublishSubscribeWithoutServerLock);
+    tcase_add_test(tc_rt_thread, PublishSubscribeWithServerLock);
+
+    Suite *s = suite_create("PubSub RT thread");
+    suite_add_tcase(s, tc_rt_thread);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
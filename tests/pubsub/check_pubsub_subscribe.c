@@ -1995,6 +1995,185 @@ START_TEST(MultiPublishSubscribeInt32) {
     UA_Variant_clear(&publishedNodeData);
 } END_TEST
 
+/* The writer sends a keyframe followed by DeltaFrames that only contain the
+ * changed fields. The reader applies the DeltaFrames to the target variables
+ * of the changed fields only. */
+START_TEST(SinglePublishSubscribeDeltaFrame) {
+    UA_StatusCode retVal = UA_STATUSCODE_GOOD;
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("PublishedDataSet Test");
+    retVal = UA_Server_addPublishedDataSet(server, &pdsConfig, &publishedDataSetId).addResult;
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* Two published and two subscribed Int32 variables */
+    UA_NodeId pubNodes[2];
+    UA_NodeId subNodes[2];
+    for(UA_UInt32 i = 0; i < 2; i++) {
+        UA_VariableAttributes attr = UA_VariableAttributes_default;
+        attr.displayName = UA_LOCALIZEDTEXT("en-US", "Int32");
+        attr.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+        UA_Int32 publisherData = 42;
+        UA_Variant_setScalar(&attr.value, &publisherData, &UA_TYPES[UA_TYPES_INT32]);
+        retVal = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, PUBLISHVARIABLE_NODEID + 10 + i),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                           UA_QUALIFIEDNAME(1, "Published Int32"),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                           attr, NULL, &pubNodes[i]);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        publisherData = 0;
+        retVal = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, SUBSCRIBEVARIABLE_NODEID + 10 + i),
+                                           folderId, UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                           UA_QUALIFIEDNAME(1, "Subscribed Int32"),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                           attr, NULL, &subNodes[i]);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        UA_DataSetFieldConfig dataSetFieldConfig;
+        memset(&dataSetFieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+        dataSetFieldConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+        dataSetFieldConfig.field.variable.fieldNameAlias = UA_STRING(i == 0 ? "Field 1" : "Field 2");
+        dataSetFieldConfig.field.variable.publishParameters.publishedVariable = pubNodes[i];
+        dataSetFieldConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+        UA_DataSetFieldResult fr =
+            UA_Server_addDataSetField(server, publishedDataSetId, &dataSetFieldConfig, NULL);
+        ck_assert_int_eq(fr.result, UA_STATUSCODE_GOOD);
+    }
+
+    /* Writer group */
+    UA_NodeId writerGroup;
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(writerGroupConfig));
+    writerGroupConfig.name               = UA_STRING("WriterGroup Test");
+    writerGroupConfig.publishingInterval = PUBLISH_INTERVAL;
+    writerGroupConfig.writerGroupId      = WRITER_GROUP_ID;
+    writerGroupConfig.encodingMimeType   = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.messageSettings.encoding             = UA_EXTENSIONOBJECT_DECODED;
+    writerGroupConfig.messageSettings.content.decoded.type = &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    UA_UadpWriterGroupMessageDataType *writerGroupMessage  = UA_UadpWriterGroupMessageDataType_new();
+    writerGroupMessage->networkMessageContentMask =
+        (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+        (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+        (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+        (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER;
+    writerGroupConfig.messageSettings.content.decoded.data = writerGroupMessage;
+    retVal = UA_Server_addWriterGroup(server, connectionId, &writerGroupConfig, &writerGroup);
+    UA_UadpWriterGroupMessageDataType_delete(writerGroupMessage);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* Only the first message is a keyframe during the test */
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(dataSetWriterConfig));
+    dataSetWriterConfig.name            = UA_STRING("DataSetWriter Test");
+    dataSetWriterConfig.dataSetWriterId = DATASET_WRITER_ID;
+    dataSetWriterConfig.keyFrameCount   = 1000;
+    retVal = UA_Server_addDataSetWriter(server, writerGroup, publishedDataSetId,
+                                        &dataSetWriterConfig, NULL);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* Reader Group and Reader */
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup Test");
+    retVal = UA_Server_addReaderGroup(server, connectionId, &readerGroupConfig, &readerGroupId);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name             = UA_STRING("DataSetReader Test");
+    UA_UInt16 publisherIdentifier = PUBLISHER_ID;
+    readerConfig.publisherId.type = &UA_TYPES[UA_TYPES_UINT16];
+    readerConfig.publisherId.data = &publisherIdentifier;
+    readerConfig.writerGroupId    = WRITER_GROUP_ID;
+    readerConfig.dataSetWriterId  = DATASET_WRITER_ID;
+    UA_DataSetMetaDataType *pMetaData = &readerConfig.dataSetMetaData;
+    UA_DataSetMetaDataType_init(pMetaData);
+    pMetaData->name = UA_STRING("DataSet Test");
+    pMetaData->fieldsSize = 2;
+    pMetaData->fields = (UA_FieldMetaData*)
+        UA_Array_new(pMetaData->fieldsSize, &UA_TYPES[UA_TYPES_FIELDMETADATA]);
+    for(size_t i = 0; i < 2; i++) {
+        pMetaData->fields[i].dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+        pMetaData->fields[i].builtInType = UA_NS0ID_INT32;
+        pMetaData->fields[i].valueRank = -1; /* scalar */
+    }
+    UA_NodeId readerIdentifier;
+    retVal = UA_Server_addDataSetReader(server, readerGroupId, &readerConfig,
+                                        &readerIdentifier);
+    UA_free(pMetaData->fields);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_FieldTargetVariable targetVars[2];
+    memset(targetVars, 0, sizeof(targetVars));
+    for(size_t i = 0; i < 2; i++) {
+        targetVars[i].targetVariable.attributeId  = UA_ATTRIBUTEID_VALUE;
+        targetVars[i].targetVariable.targetNodeId = subNodes[i];
+    }
+    retVal = UA_Server_DataSetReader_createTargetVariables(server, readerIdentifier,
+                                                           2, targetVars);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    retVal = UA_Server_enableWriterGroup(server, writerGroup);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    retVal = UA_Server_enableReaderGroup(server, readerGroupId);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* Receive the keyframe */
+    UA_Variant v;
+    for(size_t i = 0; i < 10; i++) {
+        UA_fakeSleep(PUBLISH_INTERVAL + 1);
+        UA_Server_run_iterate(server, false);
+    }
+    for(size_t i = 0; i < 2; i++) {
+        retVal = UA_Server_readValue(server, subNodes[i], &v);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        ck_assert_int_eq(*(UA_Int32*)v.data, 42);
+        UA_Variant_clear(&v);
+    }
+
+    /* Overwrite the first subscribed variable locally. It is not touched by
+     * the DeltaFrames as long as the first published field does not change. */
+    UA_Int32 val = -1;
+    UA_Variant_setScalar(&v, &val, &UA_TYPES[UA_TYPES_INT32]);
+    retVal = UA_Server_writeValue(server, subNodes[0], v);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    for(UA_Int32 round = 1; round <= 3; round++) {
+        val = 100 + round;
+        UA_Variant_setScalar(&v, &val, &UA_TYPES[UA_TYPES_INT32]);
+        retVal = UA_Server_writeValue(server, pubNodes[1], v);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        for(size_t i = 0; i < 10; i++) {
+            UA_fakeSleep(PUBLISH_INTERVAL + 1);
+            UA_Server_run_iterate(server, false);
+        }
+        retVal = UA_Server_readValue(server, subNodes[1], &v);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        ck_assert_int_eq(*(UA_Int32*)v.data, 100 + round);
+        UA_Variant_clear(&v);
+        retVal = UA_Server_readValue(server, subNodes[0], &v);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        ck_assert_int_eq(*(UA_Int32*)v.data, -1);
+        UA_Variant_clear(&v);
+    }
+
+    /* A change of the first field is sent as a DeltaFrame as well */
+    val = 7;
+    UA_Variant_setScalar(&v, &val, &UA_TYPES[UA_TYPES_INT32]);
+    retVal = UA_Server_writeValue(server, pubNodes[0], v);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 10; i++) {
+        UA_fakeSleep(PUBLISH_INTERVAL + 1);
+        UA_Server_run_iterate(server, false);
+    }
+    retVal = UA_Server_readValue(server, subNodes[0], &v);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(*(UA_Int32*)v.data, 7);
+    UA_Variant_clear(&v);
+} END_TEST
+
 static void
 addTargetVariable(void) {
     UA_StatusCode retVal = UA_STATUSCODE_GOOD;
@@ -2630,6 +2809,7 @@ int main(void) {
     tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishSubscribeHeartbeat);
     tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishSubscribeWithoutPayloadHeader);
     tcase_add_test(tc_pubsub_publish_subscribe, MultiPublishSubscribeInt32);
+    tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishSubscribeDeltaFrame);
     tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishOnDemand);
 
 
@@ -0,0 +1,241 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/server_config_default.h>
+#include <open62541/server_pubsub.h>
+
+#include "test_helpers.h"
+#include "ua_pubsub.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Many readers on one ReaderGroup. The DataSetWriterIds repeat for every
+ * publisher, so the PublisherId is needed to find the reader. */
+#define READERS 2000
+#define PUBLISHERS 20
+#define WRITER_GROUP_ID 100
+#define DISPATCH_ROUNDS 200
+#define LINEAR_ROUNDS 5 /* Checking every reader is slow */
+
+UA_Server *server = NULL;
+UA_NodeId connectionId;
+UA_NodeId readerGroupId;
+UA_NodeId readerIds[READERS];
+
+static UA_UInt16 readerPublisherId(size_t i) { return (UA_UInt16)(1000 + i % PUBLISHERS); }
+static UA_UInt16 readerWriterId(size_t i) { return (UA_UInt16)(1 + i / PUBLISHERS); }
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_Server_run_startup(server);
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(UA_PubSubConnectionConfig));
+    connectionConfig.name = UA_STRING("UADP Connection");
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL, UA_STRING("opc.udp://224.0.0.22:4801/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    UA_StatusCode res = UA_Server_addPubSubConnection(server, &connectionConfig, &connectionId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(readerGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup");
+    res = UA_Server_addReaderGroup(server, connectionId, &readerGroupConfig, &readerGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    for(size_t i = 0; i < READERS; i++) {
+        UA_DataSetReaderConfig readerConfig;
+        memset(&readerConfig, 0, sizeof(readerConfig));
+        readerConfig.name = UA_STRING("DataSetReader");
+        UA_UInt16 publisherId = readerPublisherId(i);
+        UA_Variant_setScalar(&readerConfig.publisherId, &publisherId,
+                             &UA_TYPES[UA_TYPES_UINT16]);
+        readerConfig.writerGroupId = WRITER_GROUP_ID;
+        readerConfig.dataSetWriterId = readerWriterId(i);
+        res = UA_Server_addDataSetReader(server, readerGroupId, &readerConfig,
+                                         &readerIds[i]);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+/* NetworkMessage headers with a single DataSetMessage */
+static void
+initMessage(UA_NetworkMessage *nm, UA_UInt16 *writerId,
+            UA_UInt16 publisherId, UA_UInt16 dataSetWriterId) {
+    memset(nm, 0, sizeof(UA_NetworkMessage));
+    nm->publisherIdEnabled = true;
+    nm->publisherIdType = UA_PUBLISHERIDTYPE_UINT16;
+    nm->publisherId.uint16 = publisherId;
+    nm->groupHeaderEnabled = true;
+    nm->groupHeader.writerGroupIdEnabled = true;
+    nm->groupHeader.writerGroupId = WRITER_GROUP_ID;
+    nm->payloadHeaderEnabled = true;
+    nm->payloadHeader.dataSetPayloadHeader.count = 1;
+    *writerId = dataSetWriterId;
+    nm->payloadHeader.dataSetPayloadHeader.dataSetWriterIds = writerId;
+}
+
+/* Returns the number of matching readers from the index */
+static size_t
+countIndexed(UA_ReaderGroup *rg, UA_NetworkMessage *nm, UA_UInt16 dataSetWriterId,
+             UA_DataSetReader **found) {
+    size_t count = 0;
+    UA_DataSetReader *dsr = UA_ReaderGroup_lookupReaders(rg, nm, dataSetWriterId);
+    for(; dsr; dsr = dsr->indexNext) {
+        if(!UA_DataSetReader_matchesKey(dsr, nm, dataSetWriterId))
+            continue;
+        *found = dsr;
+        count++;
+    }
+    return count;
+}
+
+START_TEST(DispatchFindsEveryReader) {
+    UA_LOCK(&server->serviceMutex);
+    UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, readerGroupId);
+    ck_assert(rg != NULL);
+    ck_assert(rg->readersIndex != NULL);
+    ck_assert_uint_ge(rg->readersIndexSize, READERS);
+
+    UA_NetworkMessage nm;
+    UA_UInt16 writerId;
+    for(size_t i = 0; i < READERS; i++) {
+        initMessage(&nm, &writerId, readerPublisherId(i), readerWriterId(i));
+        ck_assert(UA_ReaderGroup_useReaderIndex(rg, &nm));
+        UA_DataSetReader *found = NULL;
+        ck_assert_uint_eq(countIndexed(rg, &nm, writerId, &found), 1);
+        ck_assert(UA_NodeId_equal(&found->identifier, &readerIds[i]));
+        ck_assert(UA_ReaderGroup_hasReaderForMessage(server, rg, &nm));
+    }
+
+    /* Unknown PublisherId, WriterGroupId or DataSetWriterId */
+    initMessage(&nm, &writerId, 999, 1);
+    ck_assert(!UA_ReaderGroup_hasReaderForMessage(server, rg, &nm));
+    initMessage(&nm, &writerId, readerPublisherId(0), 60000);
+    ck_assert(!UA_ReaderGroup_hasReaderForMessage(server, rg, &nm));
+    initMessage(&nm, &writerId, readerPublisherId(0), readerWriterId(0));
+    nm.groupHeader.writerGroupId = WRITER_GROUP_ID + 1;
+    ck_assert(!UA_ReaderGroup_hasReaderForMessage(server, rg, &nm));
+
+    /* A different PublisherId type does not match */
+    initMessage(&nm, &writerId, readerPublisherId(0), readerWriterId(0));
+    nm.publisherIdType = UA_PUBLISHERIDTYPE_UINT32;
+    nm.publisherId.uint32 = readerPublisherId(0);
+    ck_assert(!UA_ReaderGroup_hasReaderForMessage(server, rg, &nm));
+
+    /* Without the WriterGroupId the index is not used. All readers of the
+     * publisher with the DataSetWriterId match. */
+    initMessage(&nm, &writerId, readerPublisherId(0), readerWriterId(0));
+    nm.groupHeader.writerGroupIdEnabled = false;
+    ck_assert(!UA_ReaderGroup_useReaderIndex(rg, &nm));
+    ck_assert(UA_ReaderGroup_hasReaderForMessage(server, rg, &nm));
+    UA_UNLOCK(&server->serviceMutex);
+} END_TEST
+
+START_TEST(DispatchAfterRemoveAndUpdate) {
+    /* Remove every second reader */
+    for(size_t i = 0; i < READERS; i += 2) {
+        UA_StatusCode res = UA_Server_removeDataSetReader(server, readerIds[i]);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    /* Change the DataSetWriterId of reader 1 */
+    UA_DataSetReaderConfig readerConfig;
+    UA_StatusCode res = UA_Server_DataSetReader_getConfig(server, readerIds[1], &readerConfig);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    readerConfig.dataSetWriterId = 50000;
+    res = UA_Server_DataSetReader_updateConfig(server, readerIds[1], readerGroupId,
+                                               &readerConfig);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_DataSetReaderConfig_clear(&readerConfig);
+
+    UA_LOCK(&server->serviceMutex);
+    UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, readerGroupId);
+    UA_NetworkMessage nm;
+    UA_UInt16 writerId;
+    for(size_t i = 2; i < READERS; i++) {
+        initMessage(&nm, &writerId, readerPublisherId(i), readerWriterId(i));
+        ck_assert(UA_ReaderGroup_hasReaderForMessage(server, rg, &nm) == (i % 2 == 1));
+    }
+    initMessage(&nm, &writerId, readerPublisherId(1), readerWriterId(1));
+    ck_assert(!UA_ReaderGroup_hasReaderForMessage(server, rg, &nm));
+    initMessage(&nm, &writerId, readerPublisherId(1), 50000);
+    ck_assert(UA_ReaderGroup_hasReaderForMessage(server, rg, &nm));
+    UA_UNLOCK(&server->serviceMutex);
+} END_TEST
+
+/* Compare the dispatch with the index to checking every reader */
+START_TEST(DispatchSpeed) {
+    UA_LOCK(&server->serviceMutex);
+    UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, readerGroupId);
+    UA_NetworkMessage nm;
+    UA_UInt16 writerId;
+    size_t found = 0;
+    size_t foundLinear = 0;
+
+    clock_t begin = clock();
+    for(size_t r = 0; r < DISPATCH_ROUNDS; r++) {
+        for(size_t i = 0; i < READERS; i++) {
+            initMessage(&nm, &writerId, readerPublisherId(i), readerWriterId(i));
+            UA_DataSetReader *dsr = UA_ReaderGroup_lookupReaders(rg, &nm, writerId);
+            for(; dsr; dsr = dsr->indexNext)
+                found += UA_DataSetReader_matchesKey(dsr, &nm, writerId);
+        }
+    }
+    clock_t indexed = clock() - begin;
+
+    begin = clock();
+    for(size_t r = 0; r < LINEAR_ROUNDS; r++) {
+        for(size_t i = 0; i < READERS; i++) {
+            initMessage(&nm, &writerId, readerPublisherId(i), readerWriterId(i));
+            UA_DataSetReader *dsr;
+            LIST_FOREACH(dsr, &rg->readers, listEntry) {
+                foundLinear += (UA_DataSetReader_checkIdentifier(server, &nm, dsr, rg->config)
+                          == UA_STATUSCODE_GOOD);
+            }
+        }
+    }
+    clock_t linear = clock() - begin;
+    UA_UNLOCK(&server->serviceMutex);
+
+    ck_assert_uint_eq(found, DISPATCH_ROUNDS * READERS);
+    ck_assert_uint_eq(foundLinear, LINEAR_ROUNDS * READERS);
+    printf("Dispatch with %u readers: %f us per message with the index, "
+           "%f us per message checking every reader\n", (unsigned)READERS,
+           (double)indexed * 1e6 / CLOCKS_PER_SEC / (DISPATCH_ROUNDS * READERS),
+           (double)linear * 1e6 / CLOCKS_PER_SEC / (LINEAR_ROUNDS * READERS));
+} END_TEST
+
+int main(void) {
+    TCase *tc_dispatch = tcase_create("DataSetReader dispatch index");
+    tcase_add_checked_fixture(tc_dispatch, setup, teardown);
+    tcase_set_timeout(tc_dispatch, 60);
+    tcase_add_test(tc_dispatch, DispatchFindsEveryReader);
+    tcase_add_test(tc_dispatch, DispatchAfterRemoveAndUpdate);
+    tcase_add_test(tc_dispatch, DispatchSpeed);
+
+    Suite *s = suite_create("PubSub subscriber dispatch");
+    suite_add_tcase(s, tc_dispatch);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
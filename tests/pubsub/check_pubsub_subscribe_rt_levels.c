@@ -410,7 +410,7 @@ START_TEST(SetupInvalidPubSubConfigReader) {
         UA_free(readerConfig.dataSetMetaData.fields);
         // UA_Variant_clear(&variant);
 
-        ck_assert(UA_Server_freezeReaderGroupConfiguration(server, readerGroupIdentifier) == UA_STATUSCODE_BADNOTIMPLEMENTED); // Multiple DSR not supported
+        ck_assert(UA_Server_freezeReaderGroupConfiguration(server, readerGroupIdentifier) == UA_STATUSCODE_BADNOTSUPPORTED); // DateTime not supported (also with multiple DSR)
 
         ck_assert(UA_Server_unfreezeReaderGroupConfiguration(server, readerGroupIdentifier) == UA_STATUSCODE_GOOD);
         retVal = UA_Server_removeDataSetReader(server, readerIdentifier2);
@@ -806,6 +806,209 @@ START_TEST(PublishSubscribeWithWriteCallback) {
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "PublishSubscribeWithWriteCallback() test end");
 } END_TEST
 
+/* Several DataSetWriters in one RT WriterGroup. The NetworkMessage contains one
+ * DataSetMessage per writer. Every reader of the RT ReaderGroup decodes its own
+ * DataSetMessage with fixed offsets. */
+#define NUMREADERS 3
+static UA_DataValue *sMultiPubDataValue[NUMREADERS];
+static UA_DataValue *sMultiSubDataValue[NUMREADERS];
+
+static void
+PublishSubscribeMultipleReaders_Helper(UA_Boolean useRawEncoding) {
+    UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND,
+                "PublishSubscribeMultipleReaders_Helper(): useRawEncoding = %s",
+                (useRawEncoding == UA_TRUE) ? "true" : "false");
+
+    UA_StatusCode retVal = UA_STATUSCODE_GOOD;
+    ck_assert(addMinimalPubSubConfiguration() == UA_STATUSCODE_GOOD);
+
+    /* Variables with external value backends for publisher and subscriber */
+    UA_NodeId pubNodes[NUMREADERS];
+    UA_NodeId subNodes[NUMREADERS];
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_ValueBackend valueBackend;
+    memset(&valueBackend, 0, sizeof(valueBackend));
+    valueBackend.backendType = UA_VALUEBACKENDTYPE_EXTERNAL;
+    for(size_t i = 0; i < NUMREADERS; i++) {
+        sMultiPubDataValue[i] = UA_DataValue_new();
+        UA_Variant_setScalar(&sMultiPubDataValue[i]->value, UA_UInt32_new(),
+                             &UA_TYPES[UA_TYPES_UINT32]);
+        sMultiSubDataValue[i] = UA_DataValue_new();
+        UA_Variant_setScalar(&sMultiSubDataValue[i]->value, UA_UInt32_new(),
+                             &UA_TYPES[UA_TYPES_UINT32]);
+
+        retVal |= UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, (UA_UInt32)(51000 + i)),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                            UA_QUALIFIEDNAME(1, "Published UInt32"),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                            attr, NULL, &pubNodes[i]);
+        valueBackend.backend.external.value = &sMultiPubDataValue[i];
+        retVal |= UA_Server_setVariableNode_valueBackend(server, pubNodes[i], valueBackend);
+
+        retVal |= UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, (UA_UInt32)(52000 + i)),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                            UA_QUALIFIEDNAME(1, "Subscribed UInt32"),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                            attr, NULL, &subNodes[i]);
+        valueBackend.backend.external.value = &sMultiSubDataValue[i];
+        retVal |= UA_Server_setVariableNode_valueBackend(server, subNodes[i], valueBackend);
+    }
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* Writer group */
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(writerGroupConfig));
+    writerGroupConfig.name               = UA_STRING("WriterGroup Test");
+    writerGroupConfig.rtLevel            = UA_PUBSUB_RT_FIXED_SIZE;
+    writerGroupConfig.publishingInterval = 2;
+    writerGroupConfig.enabled            = UA_FALSE;
+    writerGroupConfig.writerGroupId      = 1;
+    writerGroupConfig.encodingMimeType   = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.messageSettings.encoding             = UA_EXTENSIONOBJECT_DECODED;
+    writerGroupConfig.messageSettings.content.decoded.type = &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    UA_UadpWriterGroupMessageDataType *writerGroupMessage  = UA_UadpWriterGroupMessageDataType_new();
+    writerGroupMessage->networkMessageContentMask          = (UA_UadpNetworkMessageContentMask)(UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+                                                                (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+                                                                (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+                                                                (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    writerGroupConfig.messageSettings.content.decoded.data = writerGroupMessage;
+    retVal = UA_Server_addWriterGroup(server, connectionIdentifier, &writerGroupConfig, &writerGroupIdent);
+    UA_UadpWriterGroupMessageDataType_delete(writerGroupMessage);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* One PublishedDataSet with a single field and one DataSetWriter per
+     * reader. The first PDS comes from addMinimalPubSubConfiguration. */
+    UA_NodeId pdsIdents[NUMREADERS];
+    pdsIdents[0] = publishedDataSetIdent;
+    for(size_t i = 0; i < NUMREADERS; i++) {
+        if(i > 0) {
+            UA_PublishedDataSetConfig pdsConfig;
+            memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+            pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+            char pdsName[32];
+            snprintf(pdsName, sizeof(pdsName), "Demo PDS %u", (unsigned)i);
+            pdsConfig.name = UA_STRING(pdsName);
+            retVal = UA_Server_addPublishedDataSet(server, &pdsConfig, &pdsIdents[i]).addResult;
+            ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        }
+
+        UA_DataSetFieldConfig dataSetFieldConfig;
+        memset(&dataSetFieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+        dataSetFieldConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+        dataSetFieldConfig.field.variable.publishParameters.publishedVariable = pubNodes[i];
+        dataSetFieldConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+        dataSetFieldConfig.field.variable.rtValueSource.rtInformationModelNode = UA_TRUE;
+        retVal = UA_Server_addDataSetField(server, pdsIdents[i], &dataSetFieldConfig, NULL).result;
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        UA_DataSetWriterConfig dataSetWriterConfig;
+        memset(&dataSetWriterConfig, 0, sizeof(dataSetWriterConfig));
+        dataSetWriterConfig.name            = UA_STRING("DataSetWriter Test");
+        dataSetWriterConfig.dataSetWriterId = (UA_UInt16)(i + 1);
+        dataSetWriterConfig.keyFrameCount   = 10;
+        dataSetWriterConfig.dataSetFieldContentMask = useRawEncoding ?
+            UA_DATASETFIELDCONTENTMASK_RAWDATA : UA_DATASETFIELDCONTENTMASK_NONE;
+        retVal = UA_Server_addDataSetWriter(server, writerGroupIdent, pdsIdents[i],
+                                            &dataSetWriterConfig, NULL);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    }
+
+    /* Reader Group */
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset (&readerGroupConfig, 0, sizeof (UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING ("ReaderGroup Test");
+    readerGroupConfig.rtLevel = UA_PUBSUB_RT_FIXED_SIZE;
+    retVal = UA_Server_addReaderGroup(server, connectionIdentifier, &readerGroupConfig, &readerGroupIdentifier);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* The readers are added in reverse order of the DataSetMessages */
+    UA_UadpDataSetReaderMessageDataType *dsReaderMessage = UA_UadpDataSetReaderMessageDataType_new();
+    dsReaderMessage->networkMessageContentMask =    (UA_UadpNetworkMessageContentMask)(UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+                                                    (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+                                                    (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+                                                    (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    dsReaderMessage->publishingInterval = writerGroupConfig.publishingInterval;
+    UA_UInt16 publisherIdentifier = 2234;
+    for(size_t j = 0; j < NUMREADERS; j++) {
+        size_t i = NUMREADERS - 1 - j;
+        UA_DataSetReaderConfig readerConfig;
+        memset (&readerConfig, 0, sizeof (UA_DataSetReaderConfig));
+        readerConfig.name             = UA_STRING ("DataSetReader Test");
+        readerConfig.publisherId.type = &UA_TYPES[UA_TYPES_UINT16];
+        readerConfig.publisherId.data = &publisherIdentifier;
+        readerConfig.writerGroupId    = 1;
+        readerConfig.dataSetWriterId  = (UA_UInt16)(i + 1);
+        readerConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+        readerConfig.messageSettings.content.decoded.type = &UA_TYPES[UA_TYPES_UADPDATASETREADERMESSAGEDATATYPE];
+        readerConfig.messageSettings.content.decoded.data = dsReaderMessage;
+        readerConfig.expectedEncoding = useRawEncoding ? UA_PUBSUB_RT_RAW : UA_PUBSUB_RT_UNKNOWN;
+        readerConfig.dataSetFieldContentMask = useRawEncoding ?
+            UA_DATASETFIELDCONTENTMASK_RAWDATA : UA_DATASETFIELDCONTENTMASK_NONE;
+
+        UA_FieldMetaData field;
+        UA_FieldMetaData_init(&field);
+        field.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+        field.builtInType = UA_NS0ID_UINT32;
+        field.valueRank = -1; /* scalar */
+        readerConfig.dataSetMetaData.name = UA_STRING("DataSet Test");
+        readerConfig.dataSetMetaData.fieldsSize = 1;
+        readerConfig.dataSetMetaData.fields = &field;
+
+        UA_NodeId readerId;
+        retVal = UA_Server_addDataSetReader(server, readerGroupIdentifier, &readerConfig, &readerId);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        UA_FieldTargetVariable targetVar;
+        memset(&targetVar, 0, sizeof(targetVar));
+        targetVar.targetVariable.attributeId  = UA_ATTRIBUTEID_VALUE;
+        targetVar.targetVariable.targetNodeId = subNodes[i];
+        retVal = UA_Server_DataSetReader_createTargetVariables(server, readerId, 1, &targetVar);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    }
+    UA_UadpDataSetReaderMessageDataType_delete(dsReaderMessage);
+
+    ck_assert_int_eq(UA_STATUSCODE_GOOD, UA_Server_freezeReaderGroupConfiguration(server, readerGroupIdentifier));
+    ck_assert_int_eq(UA_STATUSCODE_GOOD, UA_Server_freezeWriterGroupConfiguration(server, writerGroupIdent));
+    ck_assert(UA_Server_enableWriterGroup(server, writerGroupIdent) == UA_STATUSCODE_GOOD);
+    ck_assert(UA_Server_enableReaderGroup(server, readerGroupIdentifier) == UA_STATUSCODE_GOOD);
+
+    /* The first message prepares the offset tables. The following messages
+     * are decoded with the offsets. */
+    for(UA_UInt32 round = 0; round < 3; round++) {
+        for(size_t i = 0; i < NUMREADERS; i++) {
+            *(UA_UInt32*)sMultiPubDataValue[i]->value.data = 100 * (round + 1) + (UA_UInt32)i;
+            *(UA_UInt32*)sMultiSubDataValue[i]->value.data = 0;
+        }
+        ServerDoProcess((UA_UInt32) writerGroupConfig.publishingInterval, 3);
+        for(size_t i = 0; i < NUMREADERS; i++) {
+            ck_assert_uint_eq(*(UA_UInt32*)sMultiSubDataValue[i]->value.data,
+                              100 * (round + 1) + (UA_UInt32)i);
+        }
+    }
+
+    ck_assert_int_eq(UA_STATUSCODE_GOOD, UA_Server_setWriterGroupDisabled(server, writerGroupIdent));
+    ck_assert_int_eq(UA_STATUSCODE_GOOD, UA_Server_setReaderGroupDisabled(server, readerGroupIdentifier));
+    ck_assert_int_eq(UA_STATUSCODE_GOOD, UA_Server_unfreezeWriterGroupConfiguration(server, writerGroupIdent));
+    ck_assert_int_eq(UA_STATUSCODE_GOOD, UA_Server_unfreezeReaderGroupConfiguration(server, readerGroupIdentifier));
+    ck_assert_int_eq(UA_STATUSCODE_GOOD, UA_Server_removePubSubConnection(server, connectionIdentifier));
+    for(size_t i = 0; i < NUMREADERS; i++) {
+        ck_assert_int_eq(UA_STATUSCODE_GOOD, UA_Server_removePublishedDataSet(server, pdsIdents[i]));
+        ck_assert_int_eq(UA_STATUSCODE_GOOD, UA_Server_deleteNode(server, pubNodes[i], true));
+        ck_assert_int_eq(UA_STATUSCODE_GOOD, UA_Server_deleteNode(server, subNodes[i], true));
+        UA_DataValue_delete(sMultiPubDataValue[i]);
+        UA_DataValue_delete(sMultiSubDataValue[i]);
+    }
+}
+
+START_TEST(PublishSubscribeMultipleReaders) {
+    PublishSubscribeMultipleReaders_Helper(UA_FALSE);
+    PublishSubscribeMultipleReaders_Helper(UA_TRUE);
+} END_TEST
+
 
 int main(void) {
     TCase *tc_pubsub_subscribe_rt = tcase_create("PubSub RT subscribe with fixed offsets");
@@ -814,6 +1017,7 @@ int main(void) {
     tcase_add_test(tc_pubsub_subscribe_rt, SetupInvalidPubSubConfigReader);
     tcase_add_test(tc_pubsub_subscribe_rt, SubscribeSingleFieldWithFixedOffsets);
     tcase_add_test(tc_pubsub_subscribe_rt, PublishSubscribeWithWriteCallback);
+    tcase_add_test(tc_pubsub_subscribe_rt, PublishSubscribeMultipleReaders);
 
     Suite *s = suite_create("PubSub RT configuration levels");
     suite_add_tcase(s, tc_pubsub_subscribe_rt);
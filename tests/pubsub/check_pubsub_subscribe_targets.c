@@ -0,0 +1,286 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/server_config_default.h>
+#include <open62541/server_pubsub.h>
+
+#include "test_helpers.h"
+#include "ua_pubsub.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdio.h>
+#include <time.h>
+
+/* A non-RT reader with many fields that are written to TargetVariables */
+#define FIELDS 100
+#define ROUNDS 2000
+
+UA_Server *server = NULL;
+UA_NodeId connectionId;
+UA_NodeId readerGroupId;
+UA_NodeId readerId;
+UA_NodeId targetIds[FIELDS];
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_Server_run_startup(server);
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(UA_PubSubConnectionConfig));
+    connectionConfig.name = UA_STRING("UADP Connection");
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL, UA_STRING("opc.udp://224.0.0.22:4801/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    UA_StatusCode res = UA_Server_addPubSubConnection(server, &connectionConfig, &connectionId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(readerGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup");
+    res = UA_Server_addReaderGroup(server, connectionId, &readerGroupConfig, &readerGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(readerConfig));
+    readerConfig.name = UA_STRING("DataSetReader");
+    UA_UInt16 publisherId = 1000;
+    UA_Variant_setScalar(&readerConfig.publisherId, &publisherId,
+                         &UA_TYPES[UA_TYPES_UINT16]);
+    readerConfig.writerGroupId = 100;
+    readerConfig.dataSetWriterId = 1;
+    UA_DataSetMetaDataType *pMetaData = &readerConfig.dataSetMetaData;
+    pMetaData->name = UA_STRING("DataSet");
+    pMetaData->fieldsSize = FIELDS;
+    pMetaData->fields = (UA_FieldMetaData*)
+        UA_Array_new(FIELDS, &UA_TYPES[UA_TYPES_FIELDMETADATA]);
+    for(size_t i = 0; i < FIELDS; i++) {
+        pMetaData->fields[i].dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+        pMetaData->fields[i].builtInType = UA_NS0ID_INT32;
+        pMetaData->fields[i].valueRank = -1; /* scalar */
+    }
+    res = UA_Server_addDataSetReader(server, readerGroupId, &readerConfig, &readerId);
+    UA_free(pMetaData->fields);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_FieldTargetVariable targetVars[FIELDS];
+    memset(targetVars, 0, sizeof(targetVars));
+    for(UA_UInt32 i = 0; i < FIELDS; i++) {
+        UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+        vAttr.displayName = UA_LOCALIZEDTEXT("en-US", "Subscribed Int32");
+        vAttr.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+        vAttr.valueRank = UA_VALUERANK_SCALAR;
+        UA_Int32 initial = -1;
+        UA_Variant_setScalar(&vAttr.value, &initial, &UA_TYPES[UA_TYPES_INT32]);
+        res = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, 50000 + i),
+                                        UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                        UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                        UA_QUALIFIEDNAME(1, "Subscribed Int32"),
+                                        UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                        vAttr, NULL, &targetIds[i]);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+        targetVars[i].targetVariable.attributeId = UA_ATTRIBUTEID_VALUE;
+        targetVars[i].targetVariable.targetNodeId = targetIds[i];
+    }
+    res = UA_Server_DataSetReader_createTargetVariables(server, readerId, FIELDS, targetVars);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    res = UA_Server_enableReaderGroup(server, readerGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+/* KeyFrame with Int32 fields set to base + index */
+static void
+initMessage(UA_DataSetMessage *dsm, UA_DataValue *fields, UA_Int32 *values,
+            UA_Int32 base) {
+    memset(dsm, 0, sizeof(UA_DataSetMessage));
+    dsm->header.dataSetMessageValid = true;
+    dsm->header.fieldEncoding = UA_FIELDENCODING_DATAVALUE;
+    dsm->header.dataSetMessageType = UA_DATASETMESSAGE_DATAKEYFRAME;
+    dsm->data.keyFrameData.fieldCount = FIELDS;
+    dsm->data.keyFrameData.dataSetFields = fields;
+    for(size_t i = 0; i < FIELDS; i++) {
+        values[i] = base + (UA_Int32)i;
+        UA_DataValue_init(&fields[i]);
+        UA_Variant_setScalar(&fields[i].value, &values[i], &UA_TYPES[UA_TYPES_INT32]);
+        fields[i].hasValue = true;
+    }
+}
+
+static void
+checkTargets(UA_Int32 base) {
+    for(size_t i = 0; i < FIELDS; i++) {
+        UA_Variant v;
+        UA_StatusCode res = UA_Server_readValue(server, targetIds[i], &v);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert(v.type == &UA_TYPES[UA_TYPES_INT32]);
+        ck_assert_int_eq(*(UA_Int32*)v.data, base + (UA_Int32)i);
+        UA_Variant_clear(&v);
+    }
+}
+
+static void
+processMessage(UA_Int32 base) {
+    UA_DataSetMessage dsm;
+    UA_DataValue fields[FIELDS];
+    UA_Int32 values[FIELDS];
+    initMessage(&dsm, fields, values, base);
+    UA_LOCK(&server->serviceMutex);
+    UA_DataSetReader *dsr = UA_ReaderGroup_findDSRbyId(server, readerId);
+    UA_DataSetReader_process(server, dsr, &dsm);
+    UA_UNLOCK(&server->serviceMutex);
+}
+
+START_TEST(ResolveTargetsOnEnable) {
+    UA_LOCK(&server->serviceMutex);
+    UA_DataSetReader *dsr = UA_ReaderGroup_findDSRbyId(server, readerId);
+    ck_assert(dsr->targetsResolved);
+    ck_assert_uint_eq(dsr->targetsSize, FIELDS);
+    for(size_t i = 0; i < FIELDS; i++)
+        ck_assert(dsr->targets[i].node != NULL);
+    ck_assert_uint_eq(server->pubSubManager.boundTargetsSize, FIELDS);
+    UA_UNLOCK(&server->serviceMutex);
+
+    processMessage(10);
+    checkTargets(10);
+    processMessage(20);
+    checkTargets(20);
+
+    /* Disabling releases the nodes */
+    UA_StatusCode res = UA_Server_disableReaderGroup(server, readerGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_LOCK(&server->serviceMutex);
+    dsr = UA_ReaderGroup_findDSRbyId(server, readerId);
+    ck_assert(!dsr->targetsResolved);
+    ck_assert_uint_eq(server->pubSubManager.boundTargetsSize, 0);
+    UA_UNLOCK(&server->serviceMutex);
+} END_TEST
+
+START_TEST(FallbackToWriteService) {
+    /* Mismatching type. The Write service rejects the value. */
+    UA_DataSetMessage dsm;
+    UA_DataValue fields[FIELDS];
+    UA_Int32 values[FIELDS];
+    initMessage(&dsm, fields, values, 30);
+    UA_Double d = 1.5;
+    UA_Variant_setScalar(&fields[0].value, &d, &UA_TYPES[UA_TYPES_DOUBLE]);
+    UA_LOCK(&server->serviceMutex);
+    UA_DataSetReader *dsr = UA_ReaderGroup_findDSRbyId(server, readerId);
+    UA_DataSetReader_process(server, dsr, &dsm);
+    UA_UNLOCK(&server->serviceMutex);
+    UA_Variant v;
+    UA_StatusCode res = UA_Server_readValue(server, targetIds[0], &v);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(*(UA_Int32*)v.data, -1);
+    UA_Variant_clear(&v);
+    res = UA_Server_readValue(server, targetIds[1], &v);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(*(UA_Int32*)v.data, 31);
+    UA_Variant_clear(&v);
+
+    /* A deleted target node is released by the reader */
+    res = UA_Server_deleteNode(server, targetIds[FIELDS - 1], true);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_LOCK(&server->serviceMutex);
+    dsr = UA_ReaderGroup_findDSRbyId(server, readerId);
+    ck_assert(dsr->targets[FIELDS - 1].node == NULL);
+    ck_assert_uint_eq(server->pubSubManager.boundTargetsSize, FIELDS - 1);
+    UA_UNLOCK(&server->serviceMutex);
+    processMessage(40);
+
+    /* New TargetVariables are resolved with the next message */
+    UA_FieldTargetVariable targetVars[FIELDS];
+    memset(targetVars, 0, sizeof(targetVars));
+    for(size_t i = 0; i < FIELDS; i++) {
+        targetVars[i].targetVariable.attributeId = UA_ATTRIBUTEID_VALUE;
+        targetVars[i].targetVariable.targetNodeId = targetIds[i % (FIELDS - 1)];
+    }
+    res = UA_Server_DataSetReader_createTargetVariables(server, readerId, FIELDS, targetVars);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    processMessage(50);
+    UA_LOCK(&server->serviceMutex);
+    dsr = UA_ReaderGroup_findDSRbyId(server, readerId);
+    ck_assert(dsr->targetsResolved);
+    ck_assert(dsr->targets[FIELDS - 1].node != NULL);
+    UA_UNLOCK(&server->serviceMutex);
+    res = UA_Server_readValue(server, targetIds[0], &v);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(*(UA_Int32*)v.data, 50 + FIELDS - 1); /* Written twice */
+    UA_Variant_clear(&v);
+} END_TEST
+
+/* Compare the direct write into the resolved targets with the Write service
+ * for every field */
+START_TEST(TargetWriteSpeed) {
+    UA_DataSetMessage dsm;
+    UA_DataValue fields[FIELDS];
+    UA_Int32 values[FIELDS];
+    initMessage(&dsm, fields, values, 0);
+
+    UA_LOCK(&server->serviceMutex);
+    UA_DataSetReader *dsr = UA_ReaderGroup_findDSRbyId(server, readerId);
+    clock_t begin = clock();
+    for(UA_Int32 r = 0; r < ROUNDS; r++) {
+        values[0] = r;
+        UA_DataSetReader_process(server, dsr, &dsm);
+    }
+    clock_t direct = clock() - begin;
+
+    /* Use the Write service for all fields */
+    UA_DataSetReaderTarget *targets = dsr->targets;
+    size_t targetsSize = dsr->targetsSize;
+    dsr->targets = NULL;
+    dsr->targetsSize = 0;
+    begin = clock();
+    for(UA_Int32 r = 0; r < ROUNDS; r++) {
+        values[0] = r;
+        UA_DataSetReader_process(server, dsr, &dsm);
+    }
+    clock_t service = clock() - begin;
+    dsr->targets = targets;
+    dsr->targetsSize = targetsSize;
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* Both paths wrote the values */
+    UA_Variant v;
+    UA_StatusCode res = UA_Server_readValue(server, targetIds[0], &v);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(*(UA_Int32*)v.data, ROUNDS - 1);
+    UA_Variant_clear(&v);
+    processMessage(0);
+    checkTargets(0);
+    printf("Reader with %u fields: %f us per message with direct writes, "
+           "%f us per message with the Write service\n", (unsigned)FIELDS,
+           (double)direct * 1e6 / CLOCKS_PER_SEC / ROUNDS,
+           (double)service * 1e6 / CLOCKS_PER_SEC / ROUNDS);
+} END_TEST
+
+int main(void) {
+    TCase *tc_targets = tcase_create("DataSetReader resolved TargetVariables");
+    tcase_add_checked_fixture(tc_targets, setup, teardown);
+    tcase_set_timeout(tc_targets, 60);
+    tcase_add_test(tc_targets, ResolveTargetsOnEnable);
+    tcase_add_test(tc_targets, FallbackToWriteService);
+    tcase_add_test(tc_targets, TargetWriteSpeed);
+
+    Suite *s = suite_create("PubSub subscriber TargetVariables");
+    suite_add_tcase(s, tc_targets);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,326 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/server.h>
+#include <open62541/server_pubsub.h>
+
+#include "ua_pubsub.h"
+#include <server/ua_server_internal.h>
+
+#include "testing_clock.h"
+#include "test_helpers.h"
+
+#include <check.h>
+
+UA_Server *server = NULL;
+UA_NodeId connectionIdentifier, publishedDataSetIdent, writerGroupIdent,
+    dataSetWriterIdent, readerGroupIdent, pubNodeId, subNodeId;
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_Server_run_startup(server);
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+    server = NULL;
+}
+
+static void
+addUInt32Variable(UA_UInt32 id, char *name, UA_NodeId *outId) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_UInt32 initial = 0;
+    UA_Variant_setScalar(&attr.value, &initial, &UA_TYPES[UA_TYPES_UINT32]);
+    UA_StatusCode retVal =
+        UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, id),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, name),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, outId);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+}
+
+static void
+addPubSubConfiguration(UA_Boolean timingStatistics) {
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(connectionConfig));
+    connectionConfig.name = UA_STRING("UDP-UADP Connection 1");
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    connectionConfig.enabled = UA_TRUE;
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL , UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.publisherIdType = UA_PUBLISHERIDTYPE_UINT16;
+    connectionConfig.publisherId.uint16 = 2234;
+    UA_StatusCode retVal =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionIdentifier);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    addUInt32Variable(50000, "Published UInt32", &pubNodeId);
+    addUInt32Variable(50001, "Subscribed UInt32", &subNodeId);
+
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("Demo PDS");
+    retVal = UA_Server_addPublishedDataSet(server, &pdsConfig,
+                                           &publishedDataSetIdent).addResult;
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_DataSetFieldConfig dsfConfig;
+    memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+    dsfConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+    dsfConfig.field.variable.fieldNameAlias = UA_STRING("Published UInt32");
+    dsfConfig.field.variable.publishParameters.publishedVariable = pubNodeId;
+    dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    retVal = UA_Server_addDataSetField(server, publishedDataSetIdent,
+                                       &dsfConfig, NULL).result;
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(writerGroupConfig));
+    writerGroupConfig.name = UA_STRING("WriterGroup Test");
+    writerGroupConfig.publishingInterval = 10;
+    writerGroupConfig.writerGroupId = 1;
+    writerGroupConfig.timingStatistics = timingStatistics;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    writerGroupConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    UA_UadpWriterGroupMessageDataType *wgm = UA_UadpWriterGroupMessageDataType_new();
+    wgm->networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    writerGroupConfig.messageSettings.content.decoded.data = wgm;
+    retVal = UA_Server_addWriterGroup(server, connectionIdentifier,
+                                      &writerGroupConfig, &writerGroupIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* Send the DataSetMessage SequenceNumber to detect lost messages */
+    UA_UadpDataSetWriterMessageDataType dswm;
+    UA_UadpDataSetWriterMessageDataType_init(&dswm);
+    dswm.dataSetMessageContentMask = UA_UADPDATASETMESSAGECONTENTMASK_SEQUENCENUMBER;
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(dataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("DataSetWriter Test");
+    dataSetWriterConfig.dataSetWriterId = 1;
+    dataSetWriterConfig.keyFrameCount = 10;
+    UA_ExtensionObject_setValue(&dataSetWriterConfig.messageSettings, &dswm,
+                                &UA_TYPES[UA_TYPES_UADPDATASETWRITERMESSAGEDATATYPE]);
+    retVal = UA_Server_addDataSetWriter(server, writerGroupIdent, publishedDataSetIdent,
+                                        &dataSetWriterConfig, &dataSetWriterIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup Test");
+    readerGroupConfig.timingStatistics = timingStatistics;
+    retVal = UA_Server_addReaderGroup(server, connectionIdentifier,
+                                      &readerGroupConfig, &readerGroupIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_UadpDataSetReaderMessageDataType *drm = UA_UadpDataSetReaderMessageDataType_new();
+    drm->networkMessageContentMask = wgm->networkMessageContentMask;
+    drm->dataSetMessageContentMask = dswm.dataSetMessageContentMask;
+    UA_UInt16 publisherIdentifier = 2234;
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("DataSetReader Test");
+    readerConfig.publisherId.type = &UA_TYPES[UA_TYPES_UINT16];
+    readerConfig.publisherId.data = &publisherIdentifier;
+    readerConfig.writerGroupId = 1;
+    readerConfig.dataSetWriterId = 1;
+    readerConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    readerConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPDATASETREADERMESSAGEDATATYPE];
+    readerConfig.messageSettings.content.decoded.data = drm;
+
+    UA_FieldMetaData field;
+    UA_FieldMetaData_init(&field);
+    field.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    field.builtInType = UA_NS0ID_UINT32;
+    field.valueRank = -1; /* scalar */
+    readerConfig.dataSetMetaData.name = UA_STRING("DataSet Test");
+    readerConfig.dataSetMetaData.fieldsSize = 1;
+    readerConfig.dataSetMetaData.fields = &field;
+
+    UA_NodeId readerId;
+    retVal = UA_Server_addDataSetReader(server, readerGroupIdent, &readerConfig, &readerId);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    UA_UadpWriterGroupMessageDataType_delete(wgm);
+    UA_UadpDataSetReaderMessageDataType_delete(drm);
+
+    UA_FieldTargetVariable targetVar;
+    memset(&targetVar, 0, sizeof(targetVar));
+    targetVar.targetVariable.attributeId = UA_ATTRIBUTEID_VALUE;
+    targetVar.targetVariable.targetNodeId = subNodeId;
+    retVal = UA_Server_DataSetReader_createTargetVariables(server, readerId, 1, &targetVar);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    retVal = UA_Server_enableWriterGroup(server, writerGroupIdent);
+    retVal |= UA_Server_enableReaderGroup(server, readerGroupIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+}
+
+static void
+iterate(size_t cycles, UA_UInt32 sleep) {
+    for(size_t i = 0; i < cycles; i++) {
+        UA_fakeSleep(sleep);
+        UA_Server_run_iterate(server, false);
+    }
+}
+
+static UA_UInt64
+histogramTotal(const UA_PubSubHistogram *h) {
+    UA_UInt64 total = 0;
+    for(size_t i = 0; i < UA_PUBSUB_HISTOGRAM_BUCKETS; i++)
+        total += h->buckets[i];
+    return total;
+}
+
+static UA_UInt64
+readCounterNode(const char *name) {
+    UA_QualifiedName path[2] = {UA_QUALIFIEDNAME(0, "TimingStatistics"),
+                                UA_QUALIFIEDNAME(0, (char*)(uintptr_t)name)};
+    UA_BrowsePathResult bpr =
+        UA_Server_browseSimplifiedBrowsePath(server, readerGroupIdent, 2, path);
+    ck_assert_int_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(bpr.targetsSize, 1);
+    UA_Variant value;
+    UA_Variant_init(&value);
+    UA_StatusCode retVal =
+        UA_Server_readValue(server, bpr.targets[0].targetId.nodeId, &value);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_UINT64]));
+    UA_UInt64 counter = *(UA_UInt64*)value.data;
+    UA_Variant_clear(&value);
+    UA_BrowsePathResult_clear(&bpr);
+    return counter;
+}
+
+START_TEST(HistogramBuckets) {
+    ck_assert_int_eq(UA_PubSubHistogram_bucketLimit(0), UA_DATETIME_USEC);
+    ck_assert_int_eq(UA_PubSubHistogram_bucketLimit(3), 8 * UA_DATETIME_USEC);
+    ck_assert_int_eq(UA_PubSubHistogram_bucketLimit(UA_PUBSUB_HISTOGRAM_BUCKETS - 1),
+                     UA_INT64_MAX);
+
+    UA_PubSubHistogram h;
+    memset(&h, 0, sizeof(UA_PubSubHistogram));
+    UA_PubSubHistogram_add(&h, 0);
+    UA_PubSubHistogram_add(&h, UA_DATETIME_USEC - 1);
+    UA_PubSubHistogram_add(&h, UA_DATETIME_USEC);
+    UA_PubSubHistogram_add(&h, -5 * UA_DATETIME_USEC); /* Absolute deviation */
+    UA_PubSubHistogram_add(&h, UA_DATETIME_SEC * 3600);
+    ck_assert_uint_eq(h.count, 5);
+    ck_assert_uint_eq(h.buckets[0], 2);
+    ck_assert_uint_eq(h.buckets[1], 1);
+    ck_assert_uint_eq(h.buckets[3], 1);
+    ck_assert_uint_eq(h.buckets[UA_PUBSUB_HISTOGRAM_BUCKETS - 1], 1);
+    ck_assert_int_eq(h.min, 0);
+    ck_assert_int_eq(h.max, UA_DATETIME_SEC * 3600);
+} END_TEST
+
+START_TEST(TimingStatisticsDisabled) {
+    addPubSubConfiguration(false);
+    iterate(5, 10);
+
+    UA_WriterGroupTimingStatistics wgStats;
+    ck_assert_int_eq(UA_Server_getWriterGroupTimingStatistics(server, writerGroupIdent,
+                                                              &wgStats),
+                     UA_STATUSCODE_BADNOTSUPPORTED);
+    UA_ReaderGroupTimingStatistics rgStats;
+    ck_assert_int_eq(UA_Server_getReaderGroupTimingStatistics(server, readerGroupIdent,
+                                                              &rgStats),
+                     UA_STATUSCODE_BADNOTSUPPORTED);
+    ck_assert_int_eq(UA_Server_getWriterGroupTimingStatistics(server, UA_NODEID_NUMERIC(1, 1),
+                                                              &wgStats),
+                     UA_STATUSCODE_BADNOTFOUND);
+} END_TEST
+
+START_TEST(PublishSubscribeTimingStatistics) {
+    addPubSubConfiguration(true);
+    iterate(20, 10);
+
+    UA_WriterGroupTimingStatistics wgStats;
+    UA_StatusCode retVal =
+        UA_Server_getWriterGroupTimingStatistics(server, writerGroupIdent, &wgStats);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    ck_assert_uint_gt(wgStats.sendDuration.count, 0);
+    ck_assert_uint_eq(wgStats.encodeDuration.count, wgStats.sendDuration.count);
+    ck_assert_uint_eq(wgStats.encryptDuration.count, 0);
+    ck_assert_uint_eq(histogramTotal(&wgStats.sendDuration), wgStats.sendDuration.count);
+    /* The first callback has no scheduled time */
+    ck_assert_uint_eq(wgStats.publishJitter.count + 1, wgStats.sendDuration.count);
+
+    UA_ReaderGroupTimingStatistics rgStats;
+    retVal = UA_Server_getReaderGroupTimingStatistics(server, readerGroupIdent, &rgStats);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    ck_assert_uint_gt(rgStats.receivedDataSetMessages, 0);
+    ck_assert_uint_eq(rgStats.receiveLatency.count, rgStats.receivedDataSetMessages);
+    ck_assert_uint_eq(rgStats.lostDataSetMessages, 0);
+
+    /* A late publish callback shows up as jitter */
+    UA_Server_resetWriterGroupTimingStatistics(server, writerGroupIdent);
+    iterate(1, 13);
+    iterate(5, 10);
+    retVal = UA_Server_getWriterGroupTimingStatistics(server, writerGroupIdent, &wgStats);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    ck_assert_int_ge(wgStats.publishJitter.max, 3 * UA_DATETIME_MSEC);
+
+    /* Skip sequence numbers in the publisher. The subscriber counts them as
+     * lost messages. */
+    UA_LOCK(&server->serviceMutex);
+    UA_DataSetWriter *dsw = UA_DataSetWriter_findDSWbyId(server, dataSetWriterIdent);
+    ck_assert(dsw != NULL);
+    dsw->actualDataSetMessageSequenceCount += 5;
+    UA_UNLOCK(&server->serviceMutex);
+    iterate(5, 10);
+    retVal = UA_Server_getReaderGroupTimingStatistics(server, readerGroupIdent, &rgStats);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(rgStats.lostDataSetMessages, 5);
+
+    /* The information model shows the same counters */
+    ck_assert_uint_eq(readCounterNode("LostDataSetMessages"), 5);
+    ck_assert_uint_eq(readCounterNode("ReceivedDataSetMessages"),
+                      rgStats.receivedDataSetMessages);
+
+    /* Reset the statistics */
+    retVal = UA_Server_resetReaderGroupTimingStatistics(server, readerGroupIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    retVal = UA_Server_getReaderGroupTimingStatistics(server, readerGroupIdent, &rgStats);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(rgStats.receivedDataSetMessages, 0);
+    ck_assert_uint_eq(rgStats.receiveLatency.count, 0);
+} END_TEST
+
+int main(void) {
+    TCase *tc_histogram = tcase_create("PubSub timing histogram");
+    tcase_add_test(tc_histogram, HistogramBuckets);
+
+    TCase *tc_timing = tcase_create("PubSub timing statistics");
+    tcase_add_checked_fixture(tc_timing, setup, teardown);
+    tcase_add_test(tc_timing, TimingStatisticsDisabled);
+    tcase_add_test(tc_timing, PublishSubscribeTimingStatistics);
+
+    Suite *s = suite_create("PubSub timing statistics");
+    suite_add_tcase(s, tc_histogram);
+    suite_add_tcase(s, tc_timing);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
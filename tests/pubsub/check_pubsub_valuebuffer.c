@@ -0,0 +1,386 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/server.h>
+#include <open62541/server_pubsub.h>
+#include <open62541/server_config_default.h>
+
+#include "testing_clock.h"
+#include "test_helpers.h"
+#if UA_MULTITHREADING >= 100
+#include "thread_wrapper.h"
+#endif
+
+#include <check.h>
+
+UA_Server *server = NULL;
+UA_NodeId connectionIdentifier, publishedDataSetIdent, writerGroupIdent,
+    readerGroupIdent, subNodeId;
+UA_PubSubValueBuffer pubBuffer, subBuffer;
+
+static void
+initUInt32Buffer(UA_PubSubValueBuffer *vb, UA_UInt32 initial) {
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    UA_Variant_setScalar(&dv.value, &initial, &UA_TYPES[UA_TYPES_UINT32]);
+    dv.hasValue = true;
+    ck_assert_int_eq(UA_PubSubValueBuffer_init(vb, &dv), UA_STATUSCODE_GOOD);
+}
+
+static void
+writeUInt32(UA_PubSubValueBuffer *vb, UA_UInt32 value) {
+    UA_DataValue *dv = UA_PubSubValueBuffer_beginWrite(vb);
+    *(UA_UInt32*)dv->value.data = value;
+    UA_PubSubValueBuffer_commit(vb);
+}
+
+static UA_UInt32
+readUInt32(UA_PubSubValueBuffer *vb) {
+    return *(const UA_UInt32*)UA_PubSubValueBuffer_read(vb)->value.data;
+}
+
+START_TEST(ValueBufferInit) {
+    UA_String str = UA_STRING("test");
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    UA_Variant_setScalar(&dv.value, &str, &UA_TYPES[UA_TYPES_STRING]);
+    UA_PubSubValueBuffer vb;
+    ck_assert_int_eq(UA_PubSubValueBuffer_init(&vb, &dv), UA_STATUSCODE_BADNOTSUPPORTED);
+
+    UA_UInt32 arr[2] = {1, 2};
+    UA_Variant_setArray(&dv.value, arr, 2, &UA_TYPES[UA_TYPES_UINT32]);
+    ck_assert_int_eq(UA_PubSubValueBuffer_init(&vb, &dv), UA_STATUSCODE_BADNOTSUPPORTED);
+
+    initUInt32Buffer(&vb, 7);
+    ck_assert_ptr_eq(vb.valuePtr, &vb.value);
+    ck_assert(!UA_PubSubValueBuffer_sync(&vb));
+    ck_assert_uint_eq(readUInt32(&vb), 7);
+    UA_PubSubValueBuffer_clear(&vb);
+} END_TEST
+
+START_TEST(ValueBufferLatestValue) {
+    UA_PubSubValueBuffer vb;
+    initUInt32Buffer(&vb, 0);
+    const void *snapshotData = vb.value.value.data;
+
+    writeUInt32(&vb, 1);
+    ck_assert(UA_PubSubValueBuffer_sync(&vb));
+    ck_assert(!UA_PubSubValueBuffer_sync(&vb));
+    ck_assert_uint_eq(*(UA_UInt32*)vb.value.value.data, 1);
+
+    /* Only the latest of several commits is seen */
+    for(UA_UInt32 i = 2; i < 10; i++)
+        writeUInt32(&vb, i);
+    ck_assert_uint_eq(readUInt32(&vb), 9);
+
+    /* The producer never writes into the slot held by the consumer */
+    UA_DataValue *back = UA_PubSubValueBuffer_beginWrite(&vb);
+    ck_assert_ptr_ne(back, &vb.value);
+    writeUInt32(&vb, 10);
+    writeUInt32(&vb, 11);
+    ck_assert_uint_eq(readUInt32(&vb), 11);
+
+    /* The snapshot memory does not move */
+    ck_assert_ptr_eq(vb.value.value.data, snapshotData);
+    UA_PubSubValueBuffer_clear(&vb);
+} END_TEST
+
+#if UA_MULTITHREADING >= 100
+
+/* The producer writes Guids where all parts carry the same counter. A torn
+ * read shows up as a Guid with mismatching parts. */
+#define CONCURRENT_WRITES 200000
+
+UA_PubSubValueBuffer guidBuffer;
+THREAD_HANDLE producerThread;
+
+static void
+setGuid(UA_Guid *g, UA_UInt32 c) {
+    g->data1 = c;
+    g->data2 = (UA_UInt16)c;
+    g->data3 = (UA_UInt16)c;
+    for(size_t i = 0; i < 8; i++)
+        g->data4[i] = (UA_Byte)c;
+}
+
+static UA_Boolean
+isConsistentGuid(const UA_Guid *g) {
+    UA_Guid expected;
+    setGuid(&expected, g->data1);
+    return UA_Guid_equal(g, &expected);
+}
+
+THREAD_CALLBACK(produceGuids) {
+    for(UA_UInt32 c = 1; c <= CONCURRENT_WRITES; c++) {
+        UA_DataValue *dv = UA_PubSubValueBuffer_beginWrite(&guidBuffer);
+        setGuid((UA_Guid*)dv->value.data, c);
+        dv->sourceTimestamp = (UA_DateTime)c;
+        UA_PubSubValueBuffer_commit(&guidBuffer);
+    }
+    return 0;
+}
+
+START_TEST(ValueBufferConcurrent) {
+    UA_Guid initial;
+    setGuid(&initial, 0);
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    UA_Variant_setScalar(&dv.value, &initial, &UA_TYPES[UA_TYPES_GUID]);
+    dv.hasSourceTimestamp = true;
+    ck_assert_int_eq(UA_PubSubValueBuffer_init(&guidBuffer, &dv), UA_STATUSCODE_GOOD);
+
+    THREAD_CREATE(producerThread, produceGuids);
+    UA_UInt32 last = 0;
+    while(last < CONCURRENT_WRITES) {
+        const UA_DataValue *snapshot = UA_PubSubValueBuffer_read(&guidBuffer);
+        const UA_Guid *g = (const UA_Guid*)snapshot->value.data;
+        ck_assert(isConsistentGuid(g));
+        ck_assert_int_eq(snapshot->sourceTimestamp, (UA_DateTime)g->data1);
+        ck_assert_uint_ge(g->data1, last); /* Values never go back in time */
+        last = g->data1;
+    }
+    THREAD_JOIN(producerThread);
+    UA_PubSubValueBuffer_clear(&guidBuffer);
+} END_TEST
+
+#endif
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_Server_run_startup(server);
+    initUInt32Buffer(&pubBuffer, 0);
+    initUInt32Buffer(&subBuffer, 0);
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+    server = NULL;
+    UA_PubSubValueBuffer_clear(&pubBuffer);
+    UA_PubSubValueBuffer_clear(&subBuffer);
+}
+
+/* The server reads the snapshot of the value buffer. The application and the
+ * server read from the same thread here. So both share the consumer side. */
+static UA_StatusCode
+syncBeforeRead(UA_Server *serverLocal, const UA_NodeId *sessionId,
+               void *sessionContext, const UA_NodeId *nodeid,
+               void *nodeContext, const UA_NumericRange *range) {
+    UA_PubSubValueBuffer_sync(&subBuffer);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+addPubSubConfiguration(void) {
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(connectionConfig));
+    connectionConfig.name = UA_STRING("UDP-UADP Connection 1");
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    connectionConfig.enabled = UA_TRUE;
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL , UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.publisherIdType = UA_PUBLISHERIDTYPE_UINT16;
+    connectionConfig.publisherId.uint16 = 2234;
+    UA_StatusCode retVal =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionIdentifier);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* PublishedDataSet with one field taken from the value buffer */
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("Demo PDS");
+    retVal = UA_Server_addPublishedDataSet(server, &pdsConfig,
+                                           &publishedDataSetIdent).addResult;
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_DataSetFieldConfig dsfConfig;
+    memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+    dsfConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+    dsfConfig.field.variable.fieldNameAlias = UA_STRING("Published UInt32");
+    dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    dsfConfig.field.variable.rtValueSource.valueBuffer = &pubBuffer;
+    retVal = UA_Server_addDataSetField(server, publishedDataSetIdent,
+                                       &dsfConfig, NULL).result;
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* WriterGroup */
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(writerGroupConfig));
+    writerGroupConfig.name = UA_STRING("WriterGroup Test");
+    writerGroupConfig.rtLevel = UA_PUBSUB_RT_FIXED_SIZE;
+    writerGroupConfig.publishingInterval = 10;
+    writerGroupConfig.writerGroupId = 1;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    writerGroupConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    UA_UadpWriterGroupMessageDataType *wgm = UA_UadpWriterGroupMessageDataType_new();
+    wgm->networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    writerGroupConfig.messageSettings.content.decoded.data = wgm;
+    retVal = UA_Server_addWriterGroup(server, connectionIdentifier,
+                                      &writerGroupConfig, &writerGroupIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(dataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("DataSetWriter Test");
+    dataSetWriterConfig.dataSetWriterId = 1;
+    dataSetWriterConfig.keyFrameCount = 10;
+    retVal = UA_Server_addDataSetWriter(server, writerGroupIdent, publishedDataSetIdent,
+                                        &dataSetWriterConfig, NULL);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* Subscribed variable that shows the snapshot of the value buffer */
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    retVal = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, 52000),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                       UA_QUALIFIEDNAME(1, "Subscribed UInt32"),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                       attr, NULL, &subNodeId);
+    UA_ValueBackend valueBackend;
+    memset(&valueBackend, 0, sizeof(valueBackend));
+    valueBackend.backendType = UA_VALUEBACKENDTYPE_EXTERNAL;
+    valueBackend.backend.external.value = &subBuffer.valuePtr;
+    valueBackend.backend.external.callback.notificationRead = syncBeforeRead;
+    retVal |= UA_Server_setVariableNode_valueBackend(server, subNodeId, valueBackend);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    /* ReaderGroup */
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup Test");
+    readerGroupConfig.rtLevel = UA_PUBSUB_RT_FIXED_SIZE;
+    retVal = UA_Server_addReaderGroup(server, connectionIdentifier,
+                                      &readerGroupConfig, &readerGroupIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    UA_UadpDataSetReaderMessageDataType *drm = UA_UadpDataSetReaderMessageDataType_new();
+    drm->networkMessageContentMask = wgm->networkMessageContentMask;
+    UA_UInt16 publisherIdentifier = 2234;
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("DataSetReader Test");
+    readerConfig.publisherId.type = &UA_TYPES[UA_TYPES_UINT16];
+    readerConfig.publisherId.data = &publisherIdentifier;
+    readerConfig.writerGroupId = 1;
+    readerConfig.dataSetWriterId = 1;
+    readerConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    readerConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPDATASETREADERMESSAGEDATATYPE];
+    readerConfig.messageSettings.content.decoded.data = drm;
+
+    UA_FieldMetaData field;
+    UA_FieldMetaData_init(&field);
+    field.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    field.builtInType = UA_NS0ID_UINT32;
+    field.valueRank = -1; /* scalar */
+    readerConfig.dataSetMetaData.name = UA_STRING("DataSet Test");
+    readerConfig.dataSetMetaData.fieldsSize = 1;
+    readerConfig.dataSetMetaData.fields = &field;
+
+    UA_NodeId readerId;
+    retVal = UA_Server_addDataSetReader(server, readerGroupIdent, &readerConfig, &readerId);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+    UA_UadpWriterGroupMessageDataType_delete(wgm);
+    UA_UadpDataSetReaderMessageDataType_delete(drm);
+
+    UA_FieldTargetVariable targetVar;
+    memset(&targetVar, 0, sizeof(targetVar));
+    targetVar.targetVariable.attributeId = UA_ATTRIBUTEID_VALUE;
+    targetVar.targetVariable.targetNodeId = subNodeId;
+    targetVar.valueBuffer = &subBuffer;
+    retVal = UA_Server_DataSetReader_createTargetVariables(server, readerId, 1, &targetVar);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+    retVal = UA_Server_freezeReaderGroupConfiguration(server, readerGroupIdent);
+    retVal |= UA_Server_freezeWriterGroupConfiguration(server, writerGroupIdent);
+    retVal |= UA_Server_enableWriterGroup(server, writerGroupIdent);
+    retVal |= UA_Server_enableReaderGroup(server, readerGroupIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+}
+
+static void
+removePubSubConfiguration(void) {
+    UA_StatusCode retVal = UA_Server_setWriterGroupDisabled(server, writerGroupIdent);
+    retVal |= UA_Server_setReaderGroupDisabled(server, readerGroupIdent);
+    retVal |= UA_Server_unfreezeWriterGroupConfiguration(server, writerGroupIdent);
+    retVal |= UA_Server_unfreezeReaderGroupConfiguration(server, readerGroupIdent);
+    retVal |= UA_Server_removePubSubConnection(server, connectionIdentifier);
+    retVal |= UA_Server_removePublishedDataSet(server, publishedDataSetIdent);
+    ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+}
+
+/* Iterate the server until the subscriber commits the expected value */
+static UA_Boolean
+waitForValue(UA_UInt32 expected) {
+    for(size_t i = 0; i < 100; i++) {
+        if(readUInt32(&subBuffer) == expected)
+            return true;
+        UA_fakeSleep(10);
+        UA_Server_run_iterate(server, false);
+    }
+    return false;
+}
+
+START_TEST(PublishSubscribeWithValueBuffers) {
+    writeUInt32(&pubBuffer, 1000);
+    addPubSubConfiguration();
+    ck_assert(waitForValue(1000));
+
+    /* Values committed by the application after the freeze are published */
+    for(UA_UInt32 i = 1; i <= 5; i++) {
+        writeUInt32(&pubBuffer, 1000 + i);
+        ck_assert(waitForValue(1000 + i));
+    }
+
+    /* The information model shows the snapshot of the subscriber */
+    writeUInt32(&pubBuffer, 2000);
+    for(size_t i = 0; i < 10; i++) {
+        UA_fakeSleep(10);
+        UA_Server_run_iterate(server, false);
+    }
+    UA_Variant value;
+    UA_Variant_init(&value);
+    ck_assert_int_eq(UA_Server_readValue(server, subNodeId, &value), UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(*(UA_UInt32*)value.data, 2000);
+    UA_Variant_clear(&value);
+
+    removePubSubConfiguration();
+} END_TEST
+
+int main(void) {
+    TCase *tc_valuebuffer = tcase_create("PubSub value buffer");
+    tcase_add_test(tc_valuebuffer, ValueBufferInit);
+    tcase_add_test(tc_valuebuffer, ValueBufferLatestValue);
+#if UA_MULTITHREADING >= 100
+    tcase_add_test(tc_valuebuffer, ValueBufferConcurrent);
+#endif
+
+    TCase *tc_pubsub = tcase_create("PubSub RT with value buffers");
+    tcase_add_checked_fixture(tc_pubsub, setup, teardown);
+    tcase_add_test(tc_pubsub, PublishSubscribeWithValueBuffers);
+
+    Suite *s = suite_create("PubSub value buffers");
+    suite_add_tcase(s, tc_valuebuffer);
+    suite_add_tcase(s, tc_pubsub);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -377,6 +377,9 @@ TestingPolicy(UA_SecurityPolicy *policy, UA_ByteString localCertificate,
     sym_encryptionAlgorithm->getRemoteKeyLength = sym_getRemoteEncryptionKeyLength_testing;
     sym_encryptionAlgorithm->getRemoteBlockSize = sym_getEncryptionBlockSize_testing;
     sym_encryptionAlgorithm->getRemotePlainTextBlockSize = sym_getPlainTextBlockSize_testing;
+    policy->symmetricModule.signAndEncrypt = NULL;
+    policy->symmetricModule.generateChannelNonce = NULL;
+    policy->symmetricModule.generateChannelKey = NULL;
 
     policy->channelModule.newContext = newContext_testing;
     policy->channelModule.deleteContext = deleteContext_testing;